@@ -75,7 +75,13 @@ HEADERS = \
     src/pluginconfigs.h \
     src/clioptions.h \
     src/recording.h \
-    src/updates.h
+    src/updates.h \
+    src/pipelinemetrics.h \
+    src/metricsexporter.h \
+    src/performancegovernor.h \
+    src/pipelinerunner.h \
+    src/pipelinesession.h \
+    src/sessionsnapshot.h
 
 INCLUDEPATH += \
     ../libAvKys/Lib/src
@@ -87,7 +93,13 @@ OTHER_FILES = \
     share/effects.xml
 unix: OTHER_FILES += $${MANPAGESOURCES}
 
-QT += qml quick opengl widgets svg
+QT += qml quick opengl widgets svg network
+
+# Compile the shipped QML ahead of time when the Qt Quick Compiler is
+# available, so cold starts skip parsing and compiling qml.qrc. Without the
+# compiler the flag is ignored and the QML disk cache set up in main() still
+# shortens warm starts.
+CONFIG += qtquickcompiler
 
 RESOURCES += \
     Webcamoid.qrc \
@@ -105,7 +117,13 @@ SOURCES = \
     src/pluginconfigs.cpp \
     src/clioptions.cpp \
     src/recording.cpp \
-    src/updates.cpp
+    src/updates.cpp \
+    src/pipelinemetrics.cpp \
+    src/metricsexporter.cpp \
+    src/performancegovernor.cpp \
+    src/pipelinerunner.cpp \
+    src/pipelinesession.cpp \
+    src/sessionsnapshot.cpp
 
 lupdate_only {
     SOURCES += $$files(share/qml/*.qml)
@@ -17,17 +17,23 @@
  * Web-Site: http://webcamoid.github.io/
  */
 
+#include <limits>
 #include <QMutex>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
 #include <QAbstractEventDispatcher>
 #include <QSettings>
 #include <QQuickItem>
 #include <QQmlContext>
 #include <QQmlProperty>
 #include <QQmlApplicationEngine>
+#include <cmath>
 #include <akcaps.h>
 #include <akaudiocaps.h>
+#include <akmetrics.h>
 #include <akpacket.h>
 
 #include "audiolayer.h"
@@ -36,6 +42,11 @@
 #define EXTERNAL_MEDIA_INPUT ":externalinput:"
 #define MAX_SAMPLE_RATE 512e3
 
+// Length of the crossfade between the old and the new output device on a
+// warm switch. Long enough to mask the transition, short enough that the
+// old device is released almost immediately.
+#define CROSSFADE_DURATION_MS 80
+
 class AudioLayerPrivate
 {
     public:
@@ -54,14 +65,251 @@ class AudioLayerPrivate
         AkElementPtr m_audioSwitch;
         QMutex m_mutex;
         QVector<int> m_commonSampleRates;
+        QByteArray m_silence;
+        qreal m_outputGain;
+        // Old output device draining during a warm switch crossfade.
+        AkElementPtr m_fadeOut;
+        QElapsedTimer m_fadeTimer;
+        QThreadPool m_releaseThreadPool;
 
         AudioLayerPrivate():
             m_engine(nullptr),
-            m_inputState(AkElement::ElementStateNull)
+            m_inputState(AkElement::ElementStateNull),
+            m_outputGain(1.0)
         {
         }
+
+        inline AkPacket applyGain(const AkPacket &packet, qreal gain);
+        inline void connectOutputSignals(AudioLayer *q);
+        inline void measureLevels(const AkPacket &packet);
 };
 
+/* The gain touches every sample of the buffer, so the interleaved and planar
+ * layouts share the same tight loops and the compiler is free to vectorize
+ * them. Unity gain returns the packet untouched, and zero gain reuses a
+ * shared silence buffer instead of multiplying.
+ */
+AkPacket AudioLayerPrivate::applyGain(const AkPacket &packet, qreal gain)
+{
+    if (qFuzzyCompare(gain, 1.0))
+        return packet;
+
+    AkAudioCaps caps(packet.caps());
+    AkPacket oPacket(packet);
+
+    if (gain <= 0.) {
+        char silence = caps.format() == AkAudioCaps::SampleFormat_u8
+                       || caps.format() == AkAudioCaps::SampleFormat_u8p?
+                           char(0x80): char(0);
+
+        if (this->m_silence.size() != packet.buffer().size()
+            || (!this->m_silence.isEmpty() && this->m_silence[0] != silence))
+            this->m_silence = QByteArray(packet.buffer().size(), silence);
+
+        oPacket.setBuffer(this->m_silence);
+
+        return oPacket;
+    }
+
+    QByteArray buffer(packet.buffer());
+
+    switch (caps.format()) {
+    case AkAudioCaps::SampleFormat_u8:
+    case AkAudioCaps::SampleFormat_u8p: {
+        auto buff = reinterpret_cast<quint8 *>(buffer.data());
+        int samples = buffer.size();
+        auto igain = qint32(qRound(256. * gain));
+
+        for (int i = 0; i < samples; i++)
+            buff[i] = quint8(qBound<qint32>(0,
+                                            (((buff[i] - 128) * igain) >> 8) + 128,
+                                            255));
+
+        break;
+    }
+    case AkAudioCaps::SampleFormat_s16:
+    case AkAudioCaps::SampleFormat_s16p: {
+        auto buff = reinterpret_cast<qint16 *>(buffer.data());
+        int samples = buffer.size() / int(sizeof(qint16));
+        auto igain = qint32(qRound(256. * gain));
+
+        for (int i = 0; i < samples; i++)
+            buff[i] = qint16(qBound<qint32>(-32768,
+                                            (buff[i] * igain) >> 8,
+                                            32767));
+
+        break;
+    }
+    case AkAudioCaps::SampleFormat_s32:
+    case AkAudioCaps::SampleFormat_s32p: {
+        auto buff = reinterpret_cast<qint32 *>(buffer.data());
+        int samples = buffer.size() / int(sizeof(qint32));
+
+        for (int i = 0; i < samples; i++)
+            buff[i] = qint32(qBound<qreal>(qreal(std::numeric_limits<qint32>::min()),
+                                           buff[i] * gain,
+                                           qreal(std::numeric_limits<qint32>::max())));
+
+        break;
+    }
+    case AkAudioCaps::SampleFormat_flt:
+    case AkAudioCaps::SampleFormat_fltp: {
+        auto buff = reinterpret_cast<float *>(buffer.data());
+        int samples = buffer.size() / int(sizeof(float));
+        auto fgain = float(gain);
+
+        for (int i = 0; i < samples; i++)
+            buff[i] *= fgain;
+
+        break;
+    }
+    case AkAudioCaps::SampleFormat_dbl:
+    case AkAudioCaps::SampleFormat_dblp: {
+        auto buff = reinterpret_cast<double *>(buffer.data());
+        int samples = buffer.size() / int(sizeof(double));
+        auto dgain = double(gain);
+
+        for (int i = 0; i < samples; i++)
+            buff[i] *= dgain;
+
+        break;
+    }
+    default:
+        return packet;
+    }
+
+    oPacket.setBuffer(buffer);
+
+    return oPacket;
+}
+
+/* Peak/RMS metering over the packet, normalized to full scale. One pass
+ * per sample format in the same kind of plain loops as applyGain(), so
+ * the compiler can vectorize them; planar and interleaved layouts meter
+ * identically since every sample weighs the same. Only called with
+ * metrics collection enabled, the packet path pays a single branch when
+ * it is off.
+ */
+void AudioLayerPrivate::measureLevels(const AkPacket &packet)
+{
+    AkAudioCaps caps(packet.caps());
+    auto buffer = packet.buffer();
+    qreal peak = 0.;
+    qreal sumSq = 0.;
+    int samples = 0;
+
+    switch (caps.format()) {
+    case AkAudioCaps::SampleFormat_u8:
+    case AkAudioCaps::SampleFormat_u8p: {
+        auto buff = reinterpret_cast<const quint8 *>(buffer.constData());
+        samples = buffer.size();
+
+        for (int i = 0; i < samples; i++) {
+            qreal value = (buff[i] - 128) / 128.;
+            sumSq += value * value;
+            peak = qMax(peak, qAbs(value));
+        }
+
+        break;
+    }
+    case AkAudioCaps::SampleFormat_s16:
+    case AkAudioCaps::SampleFormat_s16p: {
+        auto buff = reinterpret_cast<const qint16 *>(buffer.constData());
+        samples = buffer.size() / int(sizeof(qint16));
+
+        for (int i = 0; i < samples; i++) {
+            qreal value = buff[i] / 32768.;
+            sumSq += value * value;
+            peak = qMax(peak, qAbs(value));
+        }
+
+        break;
+    }
+    case AkAudioCaps::SampleFormat_s32:
+    case AkAudioCaps::SampleFormat_s32p: {
+        auto buff = reinterpret_cast<const qint32 *>(buffer.constData());
+        samples = buffer.size() / int(sizeof(qint32));
+
+        for (int i = 0; i < samples; i++) {
+            qreal value = buff[i] / 2147483648.;
+            sumSq += value * value;
+            peak = qMax(peak, qAbs(value));
+        }
+
+        break;
+    }
+    case AkAudioCaps::SampleFormat_flt:
+    case AkAudioCaps::SampleFormat_fltp: {
+        auto buff = reinterpret_cast<const float *>(buffer.constData());
+        samples = buffer.size() / int(sizeof(float));
+
+        for (int i = 0; i < samples; i++) {
+            qreal value = buff[i];
+            sumSq += value * value;
+            peak = qMax(peak, qAbs(value));
+        }
+
+        break;
+    }
+    case AkAudioCaps::SampleFormat_dbl:
+    case AkAudioCaps::SampleFormat_dblp: {
+        auto buff = reinterpret_cast<const double *>(buffer.constData());
+        samples = buffer.size() / int(sizeof(double));
+
+        for (int i = 0; i < samples; i++) {
+            qreal value = buff[i];
+            sumSq += value * value;
+            peak = qMax(peak, qAbs(value));
+        }
+
+        break;
+    }
+    default:
+        return;
+    }
+
+    if (samples < 1)
+        return;
+
+    qreal rms = std::sqrt(sumSq / samples);
+    // -100 dBFS stands in for digital silence.
+    auto toDb = [] (qreal value) -> qreal {
+        return value > 0.? 20. * std::log10(value): -100.;
+    };
+    AkMetrics::instance()->setLevels("AudioLayer",
+                                     {{"peak"  , peak      },
+                                      {"peakDb", toDb(peak)},
+                                      {"rms"   , rms       },
+                                      {"rmsDb" , toDb(rms) }});
+}
+
+/* m_audioOut is replaced by a prerolled standby element on a warm output
+ * switch, so the signal wiring lives here and follows the element.
+ */
+void AudioLayerPrivate::connectOutputSignals(AudioLayer *q)
+{
+    QObject::connect(this->m_audioOut.data(),
+                     SIGNAL(deviceChanged(const QString &)),
+                     q,
+                     SIGNAL(audioOutputChanged(const QString &)));
+    QObject::connect(this->m_audioOut.data(),
+                     SIGNAL(capsChanged(const AkCaps &)),
+                     q,
+                     SIGNAL(outputDeviceCapsChanged(const AkCaps &)));
+    QObject::connect(this->m_audioOut.data(),
+                     SIGNAL(outputsChanged(const QStringList &)),
+                     q,
+                     SIGNAL(outputsChanged(const QStringList &)));
+    QObject::connect(this->m_audioOut.data(),
+                     SIGNAL(stateChanged(AkElement::ElementState)),
+                     q,
+                     SIGNAL(outputStateChanged(AkElement::ElementState)));
+    QObject::connect(this->m_audioOut.data(),
+                     SIGNAL(audioLibChanged(const QString &)),
+                     q,
+                     SLOT(saveAudioDeviceAudioLib(const QString &)));
+}
+
 AudioLayer::AudioLayer(QQmlApplicationEngine *engine, QObject *parent):
     QObject(parent)
 {
@@ -119,23 +367,7 @@ AudioLayer::AudioLayer(QQmlApplicationEngine *engine, QObject *parent):
     if (this->d->m_audioOut) {
         QString device = this->d->m_audioOut->property("defaultOutput").toString();
         this->d->m_audioOut->setProperty("device", device);
-
-        QObject::connect(this->d->m_audioOut.data(),
-                         SIGNAL(deviceChanged(const QString &)),
-                         this,
-                         SIGNAL(audioOutputChanged(const QString &)));
-        QObject::connect(this->d->m_audioOut.data(),
-                         SIGNAL(capsChanged(const AkCaps &)),
-                         this,
-                         SIGNAL(outputDeviceCapsChanged(const AkCaps &)));
-        QObject::connect(this->d->m_audioOut.data(),
-                         SIGNAL(outputsChanged(const QStringList &)),
-                         this,
-                         SIGNAL(outputsChanged(const QStringList &)));
-        QObject::connect(this->d->m_audioOut.data(),
-                         SIGNAL(stateChanged(AkElement::ElementState)),
-                         this,
-                         SIGNAL(outputStateChanged(AkElement::ElementState)));
+        this->d->connectOutputSignals(this);
     }
 
     if (this->d->m_audioIn) {
@@ -151,12 +383,7 @@ AudioLayer::AudioLayer(QQmlApplicationEngine *engine, QObject *parent):
                          SLOT(privInputsChanged(const QStringList &)));
     }
 
-    if (this->d->m_audioOut) {
-        QObject::connect(this->d->m_audioOut.data(),
-                         SIGNAL(audioLibChanged(const QString &)),
-                         this,
-                         SLOT(saveAudioDeviceAudioLib(const QString &)));
-    } else if (this->d->m_audioIn) {
+    if (!this->d->m_audioOut && this->d->m_audioIn) {
         QObject::connect(this->d->m_audioIn.data(),
                          SIGNAL(audioLibChanged(const QString &)),
                          this,
@@ -200,6 +427,10 @@ AudioLayer::AudioLayer(QQmlApplicationEngine *engine, QObject *parent):
                      &AudioLayer::audioOutputChanged,
                      this,
                      &AudioLayer::saveAudioOutput);
+    QObject::connect(this,
+                     &AudioLayer::outputGainChanged,
+                     this,
+                     &AudioLayer::saveOutputGain);
 
     this->loadProperties();
 }
@@ -212,9 +443,11 @@ AudioLayer::~AudioLayer()
 
     this->d->m_mutex.lock();
     this->d->m_audioOut.clear();
+    this->d->m_fadeOut.clear();
     this->d->m_audioSwitch.clear();
     this->d->m_mutex.unlock();
 
+    // The pool destructor waits for any pending device release.
     delete this->d;
 }
 
@@ -329,6 +562,11 @@ AkElement::ElementState AudioLayer::outputState() const
     return AkElement::ElementStateNull;
 }
 
+qreal AudioLayer::outputGain() const
+{
+    return this->d->m_outputGain;
+}
+
 AkAudioCaps AudioLayer::preferredFormat(const QString &device)
 {
     if (device == DUMMY_INPUT_DEVICE) {
@@ -460,27 +698,84 @@ void AudioLayer::setAudioInput(const QStringList &audioInput)
 
 void AudioLayer::setAudioOutput(const QString &audioOutput)
 {
-    if (this->d->m_audioOut) {
-        while (!this->d->m_mutex.tryLock()) {
-            auto eventDispatcher = QThread::currentThread()->eventDispatcher();
+    if (!this->d->m_audioOut)
+        return;
 
-            if (eventDispatcher)
-                eventDispatcher->processEvents(QEventLoop::AllEvents);
+    /* Warm standby switch: while packets are flowing, bring the new
+     * device up prerolled before touching the old one, crossfade between
+     * them in iStream() and release the old device in background. The
+     * cold stop/switch/start sequence below closes the device first and
+     * renegotiates with audio still arriving, which glitches the monitor
+     * mix and on ALSA can take seconds.
+     */
+    if (this->d->m_audioOut->property("state").value<AkElement::ElementState>()
+            == AkElement::ElementStatePlaying
+        && this->d->m_audioOut->property("device").toString() != audioOutput) {
+        auto standby = AkElement::create("AudioDevice");
+
+        if (standby) {
+            standby->setProperty("audioLib",
+                                 this->d->m_audioOut->property("audioLib"));
+            standby->setProperty("device", audioOutput);
+            standby->setProperty("state", AkElement::ElementStatePlaying);
         }
 
-        auto state = this->d->m_audioOut->property("state");
-        this->d->m_audioOut->setProperty("state", AkElement::ElementStateNull);
-        this->d->m_audioOut->setProperty("device", audioOutput);
-        this->d->m_audioOut->setProperty("state", state);
-
-        if (this->d->m_audioOut->property("state") != state) {
-            this->d->m_audioOut->setProperty("state", AkElement::ElementStateNull);
-            this->d->m_audioOut->setProperty("device", ":dummyout:");
-            this->d->m_audioOut->setProperty("state", state);
+        if (standby
+            && standby->property("state").value<AkElement::ElementState>()
+                == AkElement::ElementStatePlaying) {
+            while (!this->d->m_mutex.tryLock()) {
+                auto eventDispatcher = QThread::currentThread()->eventDispatcher();
+
+                if (eventDispatcher)
+                    eventDispatcher->processEvents(QEventLoop::AllEvents);
+            }
+
+            // A switch during a pending crossfade retires the fading
+            // device right away.
+            auto fadeOut = this->d->m_fadeOut;
+            this->d->m_fadeOut = this->d->m_audioOut;
+            this->d->m_audioOut = standby;
+            this->d->m_fadeTimer.restart();
+            this->d->m_mutex.unlock();
+
+            if (fadeOut)
+                QtConcurrent::run(&this->d->m_releaseThreadPool,
+                                  [fadeOut] () mutable {
+                    fadeOut->setState(AkElement::ElementStateNull);
+                    fadeOut.clear();
+                });
+
+            QObject::disconnect(this->d->m_fadeOut.data(), nullptr,
+                                this, nullptr);
+            this->d->connectOutputSignals(this);
+            emit this->audioOutputChanged(audioOutput);
+
+            return;
         }
 
-        this->d->m_mutex.unlock();
+        // The new device would not open, fall through to the old switch
+        // sequence and its dummy output escape.
     }
+
+    while (!this->d->m_mutex.tryLock()) {
+        auto eventDispatcher = QThread::currentThread()->eventDispatcher();
+
+        if (eventDispatcher)
+            eventDispatcher->processEvents(QEventLoop::AllEvents);
+    }
+
+    auto state = this->d->m_audioOut->property("state");
+    this->d->m_audioOut->setProperty("state", AkElement::ElementStateNull);
+    this->d->m_audioOut->setProperty("device", audioOutput);
+    this->d->m_audioOut->setProperty("state", state);
+
+    if (this->d->m_audioOut->property("state") != state) {
+        this->d->m_audioOut->setProperty("state", AkElement::ElementStateNull);
+        this->d->m_audioOut->setProperty("device", ":dummyout:");
+        this->d->m_audioOut->setProperty("state", state);
+    }
+
+    this->d->m_mutex.unlock();
 }
 
 void AudioLayer::setInputCaps(const AkCaps &inputCaps)
@@ -567,6 +862,17 @@ bool AudioLayer::setOutputState(AkElement::ElementState outputState)
     return false;
 }
 
+void AudioLayer::setOutputGain(qreal outputGain)
+{
+    if (qFuzzyCompare(this->d->m_outputGain, outputGain))
+        return;
+
+    this->d->m_mutex.lock();
+    this->d->m_outputGain = outputGain;
+    this->d->m_mutex.unlock();
+    emit this->outputGainChanged(outputGain);
+}
+
 void AudioLayer::resetAudioInput()
 {
     QStringList devices;
@@ -624,19 +930,54 @@ void AudioLayer::resetOutputState()
     this->setOutputState(AkElement::ElementStateNull);
 }
 
+void AudioLayer::resetOutputGain()
+{
+    this->setOutputGain(1.0);
+}
+
 AkPacket AudioLayer::iStream(const AkPacket &packet)
 {
     if (packet.caps().mimeType() != "audio/x-raw")
         return AkPacket();
 
-    this->d->m_mutex.lock();
+    if (AkMetrics::instance()->enabled())
+        this->d->measureLevels(packet);
 
-    if (this->d->m_audioOut)
-        (*this->d->m_audioOut)(packet);
+    this->d->m_mutex.lock();
+    auto oPacket = this->d->applyGain(packet, this->d->m_outputGain);
+
+    if (this->d->m_fadeOut) {
+        /* Crossfade of a warm output switch: the prerolled device ramps
+         * in while the old one ramps out, then the old device is closed
+         * off the audio thread, a driver drain there would stall every
+         * stream.
+         */
+        qreal k = qreal(this->d->m_fadeTimer.elapsed())
+                  / CROSSFADE_DURATION_MS;
+
+        if (k < 1.0) {
+            if (this->d->m_audioOut)
+                (*this->d->m_audioOut)(this->d->applyGain(oPacket, k));
+
+            (*this->d->m_fadeOut)(this->d->applyGain(oPacket, 1.0 - k));
+        } else {
+            if (this->d->m_audioOut)
+                (*this->d->m_audioOut)(oPacket);
+
+            auto fadeOut = this->d->m_fadeOut;
+            this->d->m_fadeOut.clear();
+            QtConcurrent::run(&this->d->m_releaseThreadPool,
+                              [fadeOut] () mutable {
+                fadeOut->setState(AkElement::ElementStateNull);
+                fadeOut.clear();
+            });
+        }
+    } else if (this->d->m_audioOut)
+        (*this->d->m_audioOut)(oPacket);
 
     if (this->d->m_audioSwitch
         && this->d->m_audioInput.contains(EXTERNAL_MEDIA_INPUT)) {
-        (*this->d->m_audioSwitch)(packet);
+        (*this->d->m_audioSwitch)(oPacket);
     }
 
     this->d->m_mutex.unlock();
@@ -699,6 +1040,13 @@ void AudioLayer::updateOutputState()
         emit this->outputCapsChanged(outputCaps);
     }
 
+    /* During a warm standby switch the new device is already running and
+     * prerolled; restarting it here would cause the very glitch the
+     * standby avoids.
+     */
+    if (this->d->m_fadeOut)
+        return;
+
     AkElement::ElementState state = this->outputState();
     this->setOutputState(AkElement::ElementStateNull);
     this->setOutputState(state);
@@ -735,6 +1083,8 @@ void AudioLayer::loadProperties()
     if (this->outputs().contains(confOutput))
         this->setAudioOutput(confOutput);
 
+    this->setOutputGain(config.value("outputGain", 1.0).toReal());
+
     config.endGroup();
 }
 
@@ -762,6 +1112,14 @@ void AudioLayer::saveAudioDeviceAudioLib(const QString &audioLib)
     config.endGroup();
 }
 
+void AudioLayer::saveOutputGain(qreal outputGain)
+{
+    QSettings config;
+    config.beginGroup("AudioConfigs");
+    config.setValue("outputGain", outputGain);
+    config.endGroup();
+}
+
 void AudioLayer::saveAudioConvertConvertLib(const QString &convertLib)
 {
     QSettings config;
@@ -776,6 +1134,7 @@ void AudioLayer::saveProperties()
     config.beginGroup("AudioConfigs");
     config.setValue("audioInput", this->audioInput().value(0));
     config.setValue("audioOutput", this->audioOutput());
+    config.setValue("outputGain", this->outputGain());
     config.endGroup();
 
     config.beginGroup("Libraries");
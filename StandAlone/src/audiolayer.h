@@ -82,6 +82,12 @@ class AudioLayer: public QObject
                WRITE setInputState
                RESET resetInputState
                NOTIFY inputStateChanged)
+    // Gain applied to the audio sent to the output device.
+    Q_PROPERTY(qreal outputGain
+               READ outputGain
+               WRITE setOutputGain
+               RESET resetOutputGain
+               NOTIFY outputGainChanged)
 
     public:
         explicit AudioLayer(QQmlApplicationEngine *engine=nullptr,
@@ -100,6 +106,7 @@ class AudioLayer: public QObject
         Q_INVOKABLE QString description(const QString &device) const;
         Q_INVOKABLE AkElement::ElementState inputState() const;
         Q_INVOKABLE AkElement::ElementState outputState() const;
+        Q_INVOKABLE qreal outputGain() const;
         Q_INVOKABLE AkAudioCaps preferredFormat(const QString &device);
         Q_INVOKABLE QStringList supportedFormats(const QString &device);
         Q_INVOKABLE QList<int> supportedChannels(const QString &device);
@@ -120,6 +127,7 @@ class AudioLayer: public QObject
         void inputDescriptionChanged(const QString &inputDescription);
         void inputStateChanged(AkElement::ElementState inputState);
         void outputStateChanged(AkElement::ElementState outputState);
+        void outputGainChanged(qreal outputGain);
         void oStream(const AkPacket &packet);
 
     public slots:
@@ -131,6 +139,7 @@ class AudioLayer: public QObject
         void setInputDescription(const QString &inputDescription);
         void setInputState(AkElement::ElementState inputState);
         bool setOutputState(AkElement::ElementState outputState);
+        void setOutputGain(qreal outputGain);
         void resetAudioInput();
         void resetAudioOutput();
         void resetInputCaps();
@@ -139,6 +148,7 @@ class AudioLayer: public QObject
         void resetInputDescription();
         void resetInputState();
         void resetOutputState();
+        void resetOutputGain();
         AkPacket iStream(const AkPacket &packet);
         void setQmlEngine(QQmlApplicationEngine *engine=nullptr);
 
@@ -151,6 +161,7 @@ class AudioLayer: public QObject
         void saveAudioOutput(const QString &audioOutput);
         void saveAudioDeviceAudioLib(const QString &audioLib);
         void saveAudioConvertConvertLib(const QString &convertLib);
+        void saveOutputGain(qreal outputGain);
         void saveProperties();
 };
 
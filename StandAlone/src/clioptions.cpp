@@ -74,6 +74,42 @@ CliOptions::CliOptions():
                                    "PATH", "");
     this->addOption(*this->m_vcamPathOpt);
 
+    this->m_metricsPortOpt =
+            new QCommandLineOption(QString("metrics-port"),
+                                   QObject::tr("Expose pipeline metrics in "
+                                               "Prometheus text format on "
+                                               "this TCP port."),
+                                   "PORT", "0");
+    this->addOption(*this->m_metricsPortOpt);
+
+    this->m_headlessOpt =
+            new QCommandLineOption(QString("headless"),
+                                   QObject::tr("Run the pipeline without the "
+                                               "graphical interface."));
+    this->addOption(*this->m_headlessOpt);
+
+    this->m_streamOpt =
+            new QCommandLineOption(QString("stream"),
+                                   QObject::tr("Input stream to play in "
+                                               "headless mode."),
+                                   "STREAM");
+    this->addOption(*this->m_streamOpt);
+
+    this->m_effectsOpt =
+            new QCommandLineOption(QString("effects"),
+                                   QObject::tr("Semi-colon separated list of "
+                                               "effects to apply in headless "
+                                               "mode."),
+                                   "EFFECT1;EFFECT2;EFFECT3;...");
+    this->addOption(*this->m_effectsOpt);
+
+    this->m_recordOpt =
+            new QCommandLineOption(QString("record"),
+                                   QObject::tr("Record the output stream to "
+                                               "FILE in headless mode."),
+                                   "FILE");
+    this->addOption(*this->m_recordOpt);
+
     this->process(*QCoreApplication::instance());
 
     // Set path for loading user settings.
@@ -100,6 +136,11 @@ CliOptions::~CliOptions()
     delete this->m_pluginPathsOpt;
     delete this->m_blackListOpt;
     delete this->m_vcamPathOpt;
+    delete this->m_metricsPortOpt;
+    delete this->m_headlessOpt;
+    delete this->m_streamOpt;
+    delete this->m_effectsOpt;
+    delete this->m_recordOpt;
 }
 
 QCommandLineOption CliOptions::configPathOpt() const
@@ -132,6 +173,31 @@ QCommandLineOption CliOptions::vcamPathOpt() const
     return *this->m_vcamPathOpt;
 }
 
+QCommandLineOption CliOptions::metricsPortOpt() const
+{
+    return *this->m_metricsPortOpt;
+}
+
+QCommandLineOption CliOptions::headlessOpt() const
+{
+    return *this->m_headlessOpt;
+}
+
+QCommandLineOption CliOptions::streamOpt() const
+{
+    return *this->m_streamOpt;
+}
+
+QCommandLineOption CliOptions::effectsOpt() const
+{
+    return *this->m_effectsOpt;
+}
+
+QCommandLineOption CliOptions::recordOpt() const
+{
+    return *this->m_recordOpt;
+}
+
 QString CliOptions::convertToAbsolute(const QString &path) const
 {
     if (!QDir::isRelativePath(path))
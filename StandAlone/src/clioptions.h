@@ -34,6 +34,11 @@ class CliOptions: public QCommandLineParser
         QCommandLineOption pluginPathsOpt() const;
         QCommandLineOption blackListOpt() const;
         QCommandLineOption vcamPathOpt() const;
+        QCommandLineOption metricsPortOpt() const;
+        QCommandLineOption headlessOpt() const;
+        QCommandLineOption streamOpt() const;
+        QCommandLineOption effectsOpt() const;
+        QCommandLineOption recordOpt() const;
 
     private:
         QCommandLineOption *m_configPathOpt;
@@ -42,6 +47,11 @@ class CliOptions: public QCommandLineParser
         QCommandLineOption *m_pluginPathsOpt;
         QCommandLineOption *m_blackListOpt;
         QCommandLineOption *m_vcamPathOpt;
+        QCommandLineOption *m_metricsPortOpt;
+        QCommandLineOption *m_headlessOpt;
+        QCommandLineOption *m_streamOpt;
+        QCommandLineOption *m_effectsOpt;
+        QCommandLineOption *m_recordOpt;
 
         QString convertToAbsolute(const QString &path) const;
 };
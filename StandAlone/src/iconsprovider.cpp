@@ -22,9 +22,16 @@
 #include <QIcon>
 #include <QSettings>
 #include <QtMath>
+#include <QDir>
+#include <QFile>
+#include <QDataStream>
+#include <QStandardPaths>
 
 #include "iconsprovider.h"
 
+// Bump when the stream layout changes, stale atlases are just discarded.
+#define ICONS_ATLAS_VERSION 1
+
 inline bool operator <(const QSize &a, const QSize &b)
 {
     return a.width() * a.width() + a.height() * a.height()
@@ -32,8 +39,30 @@ inline bool operator <(const QSize &a, const QSize &b)
 }
 
 IconsProvider::IconsProvider():
-    QQuickImageProvider(QQuickImageProvider::Pixmap)
+    QQuickImageProvider(QQuickImageProvider::Pixmap),
+    m_atlasDirty(false)
 {
+    auto cachePath =
+            QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    QDir().mkpath(cachePath);
+    this->m_atlasPath = cachePath + "/iconatlas";
+
+    QFile atlasFile(this->m_atlasPath);
+
+    if (atlasFile.open(QIODevice::ReadOnly)) {
+        QDataStream stream(&atlasFile);
+        int version = 0;
+        stream >> version;
+
+        if (version == ICONS_ATLAS_VERSION)
+            stream >> this->m_atlas;
+
+        if (stream.status() != QDataStream::Ok)
+            this->m_atlas.clear();
+
+        atlasFile.close();
+    }
+
     QSettings theme(":/icons/hicolor/index.theme", QSettings::IniFormat);
     theme.beginGroup("Icon Theme");
 
@@ -55,8 +84,34 @@ IconsProvider::IconsProvider():
     theme.endGroup();
 }
 
+IconsProvider::~IconsProvider()
+{
+    if (!this->m_atlasDirty)
+        return;
+
+    QFile atlasFile(this->m_atlasPath);
+
+    if (atlasFile.open(QIODevice::WriteOnly)) {
+        QDataStream stream(&atlasFile);
+        stream << int(ICONS_ATLAS_VERSION);
+        stream << this->m_atlas;
+        atlasFile.close();
+    }
+}
+
 QPixmap IconsProvider::requestPixmap(const QString &id, QSize *size, const QSize &requestedSize)
 {
+    auto key = this->atlasKey(id, requestedSize);
+
+    if (this->m_atlas.contains(key)) {
+        auto pixmap = this->m_atlas.value(key);
+        *size = pixmap.size();
+
+        return pixmap;
+    }
+
+    QPixmap pixmap;
+
     if (!QIcon::hasThemeIcon(id)) {
         // Force icon detection.
         auto iconSize = this->nearestSize(requestedSize);
@@ -65,23 +120,24 @@ QPixmap IconsProvider::requestPixmap(const QString &id, QSize *size, const QSize
         if (iconSize.isEmpty())
             return QPixmap();
 
-        QPixmap icon(QString(":/icons/hicolor/%1x%2/%3.png")
-                     .arg(iconSize.width()).arg(iconSize.height()).arg(id));
+        pixmap = QPixmap(QString(":/icons/hicolor/%1x%2/%3.png")
+                         .arg(iconSize.width()).arg(iconSize.height()).arg(id));
+    } else {
+        QIcon icon = QIcon::fromTheme(id);
+        QList<QSize> availableSizes = icon.availableSizes();
+        QSize nearestSize;
 
-        return icon;
-    }
+        if (requestedSize.isEmpty())
+            nearestSize = *std::max_element(availableSizes.begin(), availableSizes.end());
+        else
+            nearestSize = this->nearestSize(availableSizes, requestedSize);
 
-    QIcon icon = QIcon::fromTheme(id);
-    QList<QSize> availableSizes = icon.availableSizes();
-    QSize nearestSize;
-
-    if (requestedSize.isEmpty())
-        nearestSize = *std::max_element(availableSizes.begin(), availableSizes.end());
-    else
-        nearestSize = this->nearestSize(availableSizes, requestedSize);
+        pixmap = icon.pixmap(nearestSize);
+    }
 
-    QPixmap pixmap = icon.pixmap(nearestSize);
     *size = pixmap.size();
+    this->m_atlas[key] = pixmap;
+    this->m_atlasDirty = true;
 
     return pixmap;
 }
@@ -109,3 +165,11 @@ QSize IconsProvider::nearestSize(const QList<QSize> &availableSizes, const QSize
 
     return nearestSize;
 }
+
+QString IconsProvider::atlasKey(const QString &id, const QSize &size) const
+{
+    return QString("%1/%2x%3")
+            .arg(id)
+            .arg(size.width())
+            .arg(size.height());
+}
@@ -26,14 +26,27 @@ class IconsProvider: public QQuickImageProvider
 {
     public:
         IconsProvider();
+        ~IconsProvider();
         QPixmap requestPixmap(const QString &id, QSize *size, const QSize &requestedSize);
 
     private:
         QList<QSize> m_availableSizes;
 
+        /* Binary icon atlas, resolved by id and size.
+         *
+         * Icons rendered once are kept in the atlas and the atlas persists
+         * across runs, so after the first start the window comes up from a
+         * single file read instead of re-running theme lookup and
+         * rasterization for every icon.
+         */
+        QHash<QString, QPixmap> m_atlas;
+        QString m_atlasPath;
+        bool m_atlasDirty;
+
         QSize nearestSize(const QSize &requestedSize);
         QSize nearestSize(const QList<QSize> &availableSizes,
                           const QSize &requestedSize);
+        QString atlasKey(const QString &id, const QSize &size) const;
 };
 
 #endif // ICONSPROVIDER_H
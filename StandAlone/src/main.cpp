@@ -21,11 +21,70 @@
 #include <QTranslator>
 #include <QPalette>
 #include <QIcon>
+#include <QDir>
+#include <QStandardPaths>
+#include <cstring>
+
+#include <akelementworker.h>
 
 #include "mediatools.h"
+#include "pipelinerunner.h"
+#include "clioptions.h"
 
 int main(int argc, char *argv[])
 {
+    /* Worker mode: this process hosts a single plugin element on behalf
+     * of an AkRemoteElement in the main process. Checked by hand for the
+     * same reason as the headless flag below, it must never instantiate
+     * QApplication.
+     */
+    for (int i = 1; i < argc - 3; i++)
+        if (strcmp(argv[i], "--element-worker") == 0) {
+            QCoreApplication app(argc, argv);
+            QCoreApplication::setApplicationName(COMMONS_APPNAME);
+            QCoreApplication::setApplicationVersion(COMMONS_VERSION);
+            QCoreApplication::setOrganizationName(COMMONS_APPNAME);
+            QCoreApplication::setOrganizationDomain(QString("%1.com").arg(COMMONS_APPNAME));
+
+            AkElementWorker worker(argv[i + 1], argv[i + 2], argv[i + 3]);
+
+            if (!worker.start())
+                return -1;
+
+            return app.exec();
+        }
+
+    /* The application type must be chosen before the command line can be
+     * parsed, so the headless flag is detected by hand. Headless mode runs
+     * on boxes without a display server, where instantiating QApplication
+     * would fail.
+     */
+    bool headless = false;
+
+    for (int i = 1; i < argc; i++)
+        if (strcmp(argv[i], "--headless") == 0)
+            headless = true;
+
+    if (headless) {
+        QCoreApplication app(argc, argv);
+        QCoreApplication::setApplicationName(COMMONS_APPNAME);
+        QCoreApplication::setApplicationVersion(COMMONS_VERSION);
+        QCoreApplication::setOrganizationName(COMMONS_APPNAME);
+        QCoreApplication::setOrganizationDomain(QString("%1.com").arg(COMMONS_APPNAME));
+
+        QTranslator translator;
+        translator.load(QLocale::system().name(), ":/Webcamoid/share/ts");
+        QCoreApplication::installTranslator(&translator);
+
+        CliOptions cliOptions;
+        PipelineRunner runner(cliOptions);
+
+        if (!runner.run())
+            return -1;
+
+        return app.exec();
+    }
+
     QApplication app(argc, argv);
 
 #if 0
@@ -72,6 +131,16 @@ int main(int argc, char *argv[])
         qputenv("QML_DISABLE_DISTANCEFIELD", "1");
 #endif
 
+    // Keep the compiled QML across runs, it considerably shortens warm
+    // starts on devices that get power-cycled often.
+    if (qgetenv("QML_DISK_CACHE_PATH").isEmpty()) {
+        auto cachePath =
+                QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+                + "/qmlcache";
+        QDir().mkpath(cachePath);
+        qputenv("QML_DISK_CACHE_PATH", cachePath.toUtf8());
+    }
+
     MediaTools mediaTools;
     mediaTools.show();
 
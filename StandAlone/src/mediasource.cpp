@@ -41,6 +41,10 @@ class MediaSourcePrivate
         AkCaps m_videoCaps;
         AkElement::ElementState m_inputState;
         bool m_playOnStart;
+        bool m_standby;
+        bool m_saveConfigs;
+        QString m_standbyStream;
+        AkElementPtr m_activeSource;
         AkElementPtr m_pipeline;
         AkElementPtr m_cameraCapture;
         AkElementPtr m_desktopCapture;
@@ -49,7 +53,9 @@ class MediaSourcePrivate
         MediaSourcePrivate():
             m_engine(nullptr),
             m_inputState(AkElement::ElementStateNull),
-            m_playOnStart(false)
+            m_playOnStart(false),
+            m_standby(true),
+            m_saveConfigs(true)
         {
         }
 
@@ -107,6 +113,10 @@ MediaSource::MediaSource(QQmlApplicationEngine *engine, QObject *parent):
                      &MediaSource::playOnStartChanged,
                      this,
                      &MediaSource::savePlayOnStart);
+    QObject::connect(this,
+                     &MediaSource::standbyChanged,
+                     this,
+                     &MediaSource::saveStandby);
 
     if (this->d->m_cameraCapture) {
         QObject::connect(this->d->m_cameraCapture.data(),
@@ -249,6 +259,62 @@ bool MediaSource::playOnStart() const
     return this->d->m_playOnStart;
 }
 
+bool MediaSource::standby() const
+{
+    return this->d->m_standby;
+}
+
+bool MediaSource::saveConfigs() const
+{
+    return this->d->m_saveConfigs;
+}
+
+bool MediaSource::prepareStream(const QString &stream)
+{
+    if (!this->d->m_standby || stream == this->d->m_stream)
+        return false;
+
+    auto source = this->d->sourceElement(stream);
+
+    /* Only a stream living in another element can warm up, the active
+     * element can't serve two medias at once. */
+    if (!source || source == this->d->m_activeSource)
+        return false;
+
+    /* Open the device now and let the bounded queues preroll paused, the
+     * switch later only flips this element to playing. */
+    source->setProperty("media", stream);
+
+    if (!source->setState(AkElement::ElementStatePaused))
+        return false;
+
+    this->d->m_standbyStream = stream;
+
+    return true;
+}
+
+bool MediaSource::restoreStream(const QString &stream,
+                                const AkCaps &audioCaps,
+                                const AkCaps &videoCaps)
+{
+    auto source = this->d->sourceElement(stream);
+
+    if (!source)
+        return false;
+
+    /* Session snapshot fast path: adopt what the last session already
+     * negotiated without probing the stream, caps() opens the device on
+     * some capture backends. If the device changed in between, the next
+     * stream selection re-probes as usual. */
+    this->d->m_stream = stream;
+    source->setProperty("media", stream);
+    this->setAudioCaps(audioCaps);
+    this->setVideoCaps(videoCaps);
+    emit this->streamChanged(stream);
+
+    return true;
+}
+
 QString MediaSource::description(const QString &stream) const
 {
     return this->d->m_descriptions.value(stream);
@@ -345,39 +411,32 @@ void MediaSource::setUris(const QVariantMap &uris)
 
 void MediaSource::setState(AkElement::ElementState state)
 {
-    if (this->d->m_inputState == state)
-        return;
-
-    AkElementPtr source;
+    auto source = this->d->sourceElement(this->d->m_stream);
 
-    if (this->d->m_cameras.contains(this->d->m_stream)) {
-        if (this->d->m_desktopCapture)
-            this->d->m_desktopCapture->setState(AkElement::ElementStateNull);
-
-        if (this->d->m_uriCapture)
-            this->d->m_uriCapture->setState(AkElement::ElementStateNull);
+    // Re-dispatch when the stream moved to another element, even if the
+    // state itself didn't change.
+    if (this->d->m_inputState == state
+        && source == this->d->m_activeSource)
+        return;
 
-        source = this->d->m_cameraCapture;
-    } else if (this->d->m_desktops.contains(this->d->m_stream)) {
-        if (this->d->m_cameraCapture)
-            this->d->m_cameraCapture->setState(AkElement::ElementStateNull);
+    /* Make before break: start the selected source before stopping the
+     * others, so the previous one keeps delivering frames while the new
+     * device opens instead of showing a black gap. */
+    bool changed = false;
 
-        if (this->d->m_uriCapture)
-            this->d->m_uriCapture->setState(AkElement::ElementStateNull);
+    if (source)
+        changed = source->setState(state);
 
-        source = this->d->m_desktopCapture;
-    } else if (this->d->m_uris.contains(this->d->m_stream)) {
-        if (this->d->m_cameraCapture)
-            this->d->m_cameraCapture->setState(AkElement::ElementStateNull);
+    for (const AkElementPtr &element: {this->d->m_cameraCapture,
+                                       this->d->m_desktopCapture,
+                                       this->d->m_uriCapture})
+        if (element && element != source)
+            element->setState(AkElement::ElementStateNull);
 
-        if (this->d->m_desktopCapture)
-            this->d->m_desktopCapture->setState(AkElement::ElementStateNull);
-
-        source = this->d->m_uriCapture;
-    }
+    this->d->m_activeSource = source;
 
     if (source) {
-        if (source->setState(state) || source->state() != this->d->m_inputState) {
+        if (changed || source->state() != this->d->m_inputState) {
             auto state = source->state();
             this->d->m_inputState = state;
             emit this->stateChanged(state);
@@ -414,11 +473,60 @@ void MediaSource::resetState()
     this->setState(AkElement::ElementStateNull);
 }
 
+void MediaSource::setStandby(bool standby)
+{
+    if (this->d->m_standby == standby)
+        return;
+
+    this->d->m_standby = standby;
+
+    // Drop any source that was left warming up.
+    if (!standby && !this->d->m_standbyStream.isEmpty()) {
+        auto source = this->d->sourceElement(this->d->m_standbyStream);
+
+        if (source && source != this->d->m_activeSource)
+            source->setState(AkElement::ElementStateNull);
+
+        this->d->m_standbyStream.clear();
+    }
+
+    emit this->standbyChanged(standby);
+}
+
+void MediaSource::setSaveConfigs(bool saveConfigs)
+{
+    if (this->d->m_saveConfigs == saveConfigs)
+        return;
+
+    this->d->m_saveConfigs = saveConfigs;
+    emit this->saveConfigsChanged(saveConfigs);
+}
+
 void MediaSource::resetPlayOnStart()
 {
     this->setPlayOnStart(false);
 }
 
+void MediaSource::resetStandby()
+{
+    this->setStandby(true);
+}
+
+void MediaSource::resetSaveConfigs()
+{
+    this->setSaveConfigs(true);
+}
+
+void MediaSource::setVideoOutputFormats(const QVariantList &formats)
+{
+    /* AkVideoCaps::PixelFormat ints every downstream consumer accepts
+     * as is. The camera source then skips the RGB conversion when the
+     * device already delivers one of them; desktop and URI sources
+     * always decode, so only the camera element is told. */
+    if (this->d->m_cameraCapture)
+        this->d->m_cameraCapture->setProperty("outputPixelFormats", formats);
+}
+
 void MediaSource::setQmlEngine(QQmlApplicationEngine *engine)
 {
     if (this->d->m_engine == engine)
@@ -433,9 +541,14 @@ void MediaSource::setQmlEngine(QQmlApplicationEngine *engine)
 void MediaSource::streamUpdated(const QString &stream)
 {
     auto state = this->state();
-    this->setState(AkElement::ElementStateNull);
     auto source = this->d->sourceElement(stream);
 
+    /* With standby enabled the previous source keeps running while the
+     * new one is configured and probed, setState() below then swaps them
+     * make before break. */
+    if (!this->d->m_standby || !source)
+        this->setState(AkElement::ElementStateNull);
+
     if (!source) {
         this->setAudioCaps(AkCaps());
         this->setVideoCaps(AkCaps());
@@ -506,6 +619,9 @@ void MediaSource::streamUpdated(const QString &stream)
     }
 
     this->setState(state);
+
+    if (stream == this->d->m_standbyStream)
+        this->d->m_standbyStream.clear();
 }
 
 void MediaSource::updateStreams()
@@ -647,6 +763,7 @@ void MediaSource::loadProperties()
     config.beginGroup("StreamConfigs");
     auto stream = config.value("stream").toString();
     this->setPlayOnStart(config.value("playOnStart", true).toBool());
+    this->setStandby(config.value("standby", true).toBool());
 
     QVariantMap uris;
     int size = config.beginReadArray("uris");
@@ -670,6 +787,9 @@ void MediaSource::loadProperties()
 
 void MediaSource::saveStream(const QString &stream)
 {
+    if (!this->d->m_saveConfigs)
+        return;
+
     QSettings config;
     config.beginGroup("StreamConfigs");
     config.setValue("stream", stream);
@@ -678,6 +798,9 @@ void MediaSource::saveStream(const QString &stream)
 
 void MediaSource::saveUris(const QVariantMap &uris)
 {
+    if (!this->d->m_saveConfigs)
+        return;
+
     QSettings config;
     config.beginGroup("StreamConfigs");
     config.beginWriteArray("uris");
@@ -697,12 +820,26 @@ void MediaSource::saveUris(const QVariantMap &uris)
 
 void MediaSource::savePlayOnStart(bool playOnStart)
 {
+    if (!this->d->m_saveConfigs)
+        return;
+
     QSettings config;
     config.beginGroup("StreamConfigs");
     config.setValue("playOnStart", playOnStart);
     config.endGroup();
 }
 
+void MediaSource::saveStandby(bool standby)
+{
+    if (!this->d->m_saveConfigs)
+        return;
+
+    QSettings config;
+    config.beginGroup("StreamConfigs");
+    config.setValue("standby", standby);
+    config.endGroup();
+}
+
 void MediaSource::saveVideoCaptureCodecLib(const QString &codecLib)
 {
     QSettings config;
@@ -737,10 +874,14 @@ void MediaSource::saveMultiSrcCodecLib(const QString &codecLib)
 
 void MediaSource::saveProperties()
 {
+    if (!this->d->m_saveConfigs)
+        return;
+
     QSettings config;
     config.beginGroup("StreamConfigs");
     config.setValue("stream", this->d->m_stream);
     config.setValue("playOnStart", this->d->m_playOnStart);
+    config.setValue("standby", this->d->m_standby);
     config.beginWriteArray("uris");
 
     int i = 0;
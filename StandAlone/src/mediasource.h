@@ -67,6 +67,22 @@ class MediaSource: public QObject
                WRITE setPlayOnStart
                RESET resetPlayOnStart
                NOTIFY playOnStartChanged)
+    /* Switch sources make before break: the next source can warm up
+     * pre-opened in paused state, and the previous one keeps delivering
+     * frames until the new one started, so no black gap shows. */
+    Q_PROPERTY(bool standby
+               READ standby
+               WRITE setStandby
+               RESET resetStandby
+               NOTIFY standbyChanged)
+    /* Persist stream, uris, playOnStart and standby to the settings when
+     * they change. Secondary capture pipelines disable this so they don't
+     * overwrite the configuration of the session the interface controls. */
+    Q_PROPERTY(bool saveConfigs
+               READ saveConfigs
+               WRITE setSaveConfigs
+               RESET resetSaveConfigs
+               NOTIFY saveConfigsChanged)
 
     public:
         explicit MediaSource(QQmlApplicationEngine *engine=nullptr,
@@ -82,6 +98,12 @@ class MediaSource: public QObject
         Q_INVOKABLE AkCaps videoCaps() const;
         Q_INVOKABLE AkElement::ElementState state() const;
         Q_INVOKABLE bool playOnStart() const;
+        Q_INVOKABLE bool standby() const;
+        Q_INVOKABLE bool saveConfigs() const;
+        Q_INVOKABLE bool prepareStream(const QString &stream);
+        Q_INVOKABLE bool restoreStream(const QString &stream,
+                                       const AkCaps &audioCaps,
+                                       const AkCaps &videoCaps);
         Q_INVOKABLE QString description(const QString &stream) const;
         Q_INVOKABLE bool embedControls(const QString &where,
                                        const QString &stream,
@@ -101,6 +123,8 @@ class MediaSource: public QObject
         void videoCapsChanged(const AkCaps &videoCaps);
         void stateChanged(AkElement::ElementState state);
         void playOnStartChanged(bool playOnStart);
+        void standbyChanged(bool standby);
+        void saveConfigsChanged(bool saveConfigs);
         void oStream(const AkPacket &packet);
         void error(const QString &message);
 
@@ -109,10 +133,15 @@ class MediaSource: public QObject
         void setUris(const QVariantMap &uris);
         void setState(AkElement::ElementState state);
         void setPlayOnStart(bool playOnStart);
+        void setStandby(bool standby);
+        void setSaveConfigs(bool saveConfigs);
         void resetStream();
         void resetUris();
         void resetState();
         void resetPlayOnStart();
+        void resetStandby();
+        void resetSaveConfigs();
+        void setVideoOutputFormats(const QVariantList &formats);
         void setQmlEngine(QQmlApplicationEngine *engine=nullptr);
 
     private slots:
@@ -127,6 +156,7 @@ class MediaSource: public QObject
         void saveStream(const QString &stream);
         void saveUris(const QVariantMap &uris);
         void savePlayOnStart(bool playOnStart);
+        void saveStandby(bool standby);
         void saveVideoCaptureCodecLib(const QString &codecLib);
         void saveVideoCaptureCaptureLib(const QString &captureLib);
         void saveDesktopCaptureCaptureLib(const QString &captureLib);
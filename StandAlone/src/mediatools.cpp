@@ -19,6 +19,7 @@
 
 #include <QSize>
 #include <QMutex>
+#include <QTimer>
 #include <QQmlContext>
 #include <QQuickItem>
 #include <QQmlProperty>
@@ -43,7 +44,12 @@
 #include "audiolayer.h"
 #include "videoeffects.h"
 #include "recording.h"
+#include "pipelinesession.h"
+#include "sessionsnapshot.h"
 #include "updates.h"
+#include "pipelinemetrics.h"
+#include "metricsexporter.h"
+#include "performancegovernor.h"
 #include "clioptions.h"
 
 #define COMMONS_PROJECT_URL "https://webcamoid.github.io/"
@@ -61,19 +67,31 @@ class MediaToolsPrivate
         AudioLayerPtr m_audioLayer;
         VideoEffectsPtr m_videoEffects;
         RecordingPtr m_recording;
+        SessionSnapshotPtr m_sessionSnapshot;
         UpdatesPtr m_updates;
+        PipelineMetricsPtr m_pipelineMetrics;
+        MetricsExporterPtr m_metricsExporter;
+        PerformanceGovernorPtr m_performanceGovernor;
+        QMap<QString, PipelineSessionPtr> m_pipelines;
+        VideoDisplay *m_videoDisplay;
         int m_windowWidth;
         int m_windowHeight;
         bool m_enableVirtualCamera;
+        bool m_governorOverloadControl;
+        bool m_savedOverloadControl;
         AkElementPtr m_virtualCamera;
         QSystemTrayIcon *m_trayIcon;
         CliOptions m_cliOptions;
+        QVariantList m_displayPixelFormats;
 
         MediaToolsPrivate():
             m_engine(nullptr),
+            m_videoDisplay(nullptr),
             m_windowWidth(0),
             m_windowHeight(0),
             m_enableVirtualCamera(false),
+            m_governorOverloadControl(false),
+            m_savedOverloadControl(false),
             m_trayIcon(nullptr)
         {
         }
@@ -101,7 +119,23 @@ MediaTools::MediaTools(QObject *parent):
     this->d->m_audioLayer = AudioLayerPtr(new AudioLayer(this->d->m_engine));
     this->d->m_videoEffects = VideoEffectsPtr(new VideoEffects(this->d->m_engine));
     this->d->m_recording = RecordingPtr(new Recording(this->d->m_engine));
+    this->d->m_sessionSnapshot = SessionSnapshotPtr(new SessionSnapshot);
     this->d->m_updates = UpdatesPtr(new Updates(this->d->m_engine));
+    this->d->m_pipelineMetrics =
+            PipelineMetricsPtr(new PipelineMetrics(this->d->m_engine));
+    this->d->m_performanceGovernor =
+            PerformanceGovernorPtr(new PerformanceGovernor(this->d->m_engine));
+    QObject::connect(this->d->m_performanceGovernor.data(),
+                     &PerformanceGovernor::levelChanged,
+                     this,
+                     &MediaTools::applyPerformanceLevel);
+
+    if (this->d->m_cliOptions.isSet(this->d->m_cliOptions.metricsPortOpt())) {
+        this->d->m_metricsExporter = MetricsExporterPtr(new MetricsExporter);
+        auto port = this->d->m_cliOptions
+                        .value(this->d->m_cliOptions.metricsPortOpt()).toInt();
+        this->d->m_metricsExporter->setPort(port);
+    }
     this->d->m_virtualCamera = AkElement::create("VirtualCamera");
 
     if (this->d->m_virtualCamera) {
@@ -188,14 +222,41 @@ MediaTools::MediaTools(QObject *parent):
                      &MediaSource::videoCapsChanged,
                      this->d->m_recording.data(),
                      &Recording::setVideoCaps);
+    QObject::connect(this->d->m_videoEffects.data(),
+                     &VideoEffects::effectsChanged,
+                     this,
+                     &MediaTools::updateOutputFormats);
+    QObject::connect(this->d->m_recording.data(),
+                     &Recording::stateChanged,
+                     this,
+                     &MediaTools::updateOutputFormats);
+    QObject::connect(this,
+                     &MediaTools::virtualCameraStateChanged,
+                     this,
+                     &MediaTools::updateOutputFormats);
     QObject::connect(qApp,
                      &QCoreApplication::aboutToQuit,
                      [this] () {
+                        for (const PipelineSessionPtr &pipeline: this->d->m_pipelines)
+                            pipeline->setState(AkElement::ElementStateNull);
+
                         this->d->m_mediaSource->setState(AkElement::ElementStateNull);
                      });
 
     this->loadConfigs();
-    this->updateVCamCaps(this->d->m_mediaSource->videoCaps());
+
+    /* Replay what the last session already resolved, selected stream,
+     * negotiated caps and effect chain, skipping the per-key reads and
+     * the caps probing of the QSettings path. A missing or unreadable
+     * snapshot just leaves the settings state in place. */
+    this->d->m_sessionSnapshot->restore(this->d->m_mediaSource.data(),
+                                        this->d->m_videoEffects.data());
+
+    // Setting up the virtual camera streams can touch the driver, leave it
+    // for when the event loop is running and the interface is up.
+    QTimer::singleShot(0, this, [this] () {
+        this->updateVCamCaps(this->d->m_mediaSource->videoCaps());
+    });
     this->d->m_recording->setVideoCaps(this->d->m_mediaSource->videoCaps());
     this->d->m_recording->setAudioCaps(this->d->m_audioLayer->outputCaps());
     this->d->m_audioLayer->setInputCaps(this->d->m_mediaSource->audioCaps());
@@ -204,6 +265,8 @@ MediaTools::MediaTools(QObject *parent):
 
 MediaTools::~MediaTools()
 {
+    this->d->m_sessionSnapshot->capture(this->d->m_mediaSource.data(),
+                                        this->d->m_videoEffects.data());
     this->saveConfigs();
     delete this->d->m_engine;
     delete this->d;
@@ -391,6 +454,43 @@ void MediaTools::removeInterface(const QString &where,
     }
 }
 
+QStringList MediaTools::pipelines() const
+{
+    return this->d->m_pipelines.keys();
+}
+
+QObject *MediaTools::pipeline(const QString &name) const
+{
+    return this->d->m_pipelines.value(name).data();
+}
+
+bool MediaTools::createPipeline(const QString &name)
+{
+    if (name.isEmpty() || this->d->m_pipelines.contains(name))
+        return false;
+
+    auto session = PipelineSessionPtr(new PipelineSession);
+    QObject::connect(session.data(),
+                     &PipelineSession::error,
+                     this,
+                     &MediaTools::error);
+    this->d->m_pipelines[name] = session;
+    emit this->pipelinesChanged(this->pipelines());
+
+    return true;
+}
+
+bool MediaTools::removePipeline(const QString &name)
+{
+    // Dropping the last reference stops the recorder and the source.
+    if (!this->d->m_pipelines.remove(name))
+        return false;
+
+    emit this->pipelinesChanged(this->pipelines());
+
+    return true;
+}
+
 QString MediaTools::convertToAbsolute(const QString &path)
 {
     if (!QDir::isRelativePath(path))
@@ -521,6 +621,8 @@ void MediaTools::loadConfigs()
     QSize windowSize = config.value("windowSize", QSize(1024, 600)).toSize();
     this->d->m_windowWidth = windowSize.width();
     this->d->m_windowHeight = windowSize.height();
+    this->d->m_performanceGovernor
+            ->setEnabled(config.value("enablePowerGovernor", false).toBool());
 
     if (this->d->m_virtualCamera) {
         QString driverPath;
@@ -573,6 +675,8 @@ void MediaTools::saveConfigs()
     config.beginGroup("GeneralConfigs");
     config.setValue("windowSize", QSize(this->d->m_windowWidth,
                                         this->d->m_windowHeight));
+    config.setValue("enablePowerGovernor",
+                    this->d->m_performanceGovernor->enabled());
 
     if (this->d->m_virtualCamera) {
         auto driverPath = this->d->m_virtualCamera->property("driverPath").toString();
@@ -620,9 +724,14 @@ void MediaTools::show()
         AkElement::link(this->d->m_videoEffects.data(),
                         videoDisplay,
                         Qt::DirectConnection);
+        this->d->m_videoDisplay = videoDisplay;
+        this->d->m_displayPixelFormats = videoDisplay->preferredPixelFormats();
         break;
     }
 
+    this->updateOutputFormats();
+    this->applyPerformanceLevel();
+
     emit this->interfaceLoaded();
 }
 
@@ -639,6 +748,64 @@ void MediaTools::updateVCamCaps(const AkCaps &videoCaps)
                               Q_ARG(AkCaps, videoCaps));
 }
 
+void MediaTools::updateOutputFormats()
+{
+    /* The camera source can hand YUV frames straight to the display, but
+     * only while nothing else taps the stream: the effects, the recorder
+     * and the virtual camera all work on the decoded RGB frames. */
+    QVariantList formats;
+
+    if (this->d->m_videoEffects->effects().isEmpty()
+        && this->d->m_recording->state() == AkElement::ElementStateNull
+        && this->virtualCameraState() == AkElement::ElementStateNull)
+        formats = this->d->m_displayPixelFormats;
+
+    this->d->m_mediaSource->setVideoOutputFormats(formats);
+}
+
+void MediaTools::applyPerformanceLevel()
+{
+    auto level = this->d->m_performanceGovernor->level();
+
+    if (this->d->m_videoDisplay)
+        this->d->m_videoDisplay
+                ->setMaxFps(this->d->m_performanceGovernor->previewFpsCap());
+
+    /* Quality aware effects degrade to cheaper approximations before any
+     * of them has to be dropped from the chain, so the image softens
+     * gradually instead of losing an effect outright. */
+    switch (level) {
+    case PerformanceGovernor::PerformanceLevelBalanced:
+        this->d->m_videoEffects->setQuality(AkElement::QualityBalanced);
+        break;
+
+    case PerformanceGovernor::PerformanceLevelPowerSaver:
+    case PerformanceGovernor::PerformanceLevelCritical:
+        this->d->m_videoEffects->setQuality(AkElement::QualityFast);
+        break;
+
+    default:
+        this->d->m_videoEffects->resetQuality();
+        break;
+    }
+
+    /* From power saver up the effects chain is allowed to drop frames
+     * under load; the user's own overload setting comes back once the
+     * pressure is gone. */
+    if (level >= PerformanceGovernor::PerformanceLevelPowerSaver) {
+        if (!this->d->m_governorOverloadControl) {
+            this->d->m_savedOverloadControl =
+                    this->d->m_videoEffects->overloadControl();
+            this->d->m_governorOverloadControl = true;
+            this->d->m_videoEffects->setOverloadControl(true);
+        }
+    } else if (this->d->m_governorOverloadControl) {
+        this->d->m_governorOverloadControl = false;
+        this->d->m_videoEffects
+                ->setOverloadControl(this->d->m_savedOverloadControl);
+    }
+}
+
 void MediaTools::updateVCamState()
 {
     if (!this->d->m_virtualCamera)
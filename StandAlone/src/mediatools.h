@@ -81,6 +81,16 @@ class MediaTools: public QObject
                                                     const QString &name="");
         Q_INVOKABLE void removeInterface(const QString &where,
                                          QQmlApplicationEngine *engine=nullptr);
+        /* Extra capture pipelines running alongside the one the interface
+         * shows, so several cameras share one process instead of one each.
+         * Each is a full source-effects-recording graph; the plugin cache,
+         * the buffer pools and the metrics registry are shared. The
+         * interface switches between them by picking which session object
+         * it binds to. */
+        Q_INVOKABLE QStringList pipelines() const;
+        Q_INVOKABLE QObject *pipeline(const QString &name) const;
+        Q_INVOKABLE bool createPipeline(const QString &name);
+        Q_INVOKABLE bool removePipeline(const QString &name);
         static QString convertToAbsolute(const QString &path);
 
     private:
@@ -93,6 +103,7 @@ class MediaTools: public QObject
         void virtualCameraStateChanged(AkElement::ElementState virtualCameraState);
         void error(const QString &message);
         void interfaceLoaded();
+        void pipelinesChanged(const QStringList &pipelines);
 
     public slots:
         void setWindowWidth(int windowWidth);
@@ -113,6 +124,8 @@ class MediaTools: public QObject
     private slots:
         void updateVCamCaps(const AkCaps &videoCaps);
         void updateVCamState();
+        void updateOutputFormats();
+        void applyPerformanceLevel();
 };
 
 #endif // MEDIATOOLS_H
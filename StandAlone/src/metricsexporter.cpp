@@ -0,0 +1,251 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QDebug>
+#include <QMutex>
+#include <QThread>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QVariantList>
+#include <akelement.h>
+
+#include "metricsexporter.h"
+
+class MetricsExporterPrivate
+{
+    public:
+        QThread m_thread;
+        QTcpServer *m_server;
+        mutable QMutex m_mutex;
+        int m_port;
+
+        MetricsExporterPrivate():
+            m_server(nullptr),
+            m_port(0)
+        {
+        }
+};
+
+inline QString escapeLabel(QString label)
+{
+    return label.replace("\\", "\\\\").replace("\"", "\\\"");
+}
+
+/* Render one snapshot of the aggregated stats in Prometheus text format
+ * (version 0.0.4). The log2 latency histogram maps directly to a Prometheus
+ * histogram with power of two buckets. */
+inline QByteArray renderMetrics()
+{
+    auto metrics = AkElement::metrics();
+    QByteArray body;
+    body += "# HELP webcamoid_stage_frames_total "
+            "Frames processed by the stage.\n"
+            "# TYPE webcamoid_stage_frames_total counter\n"
+            "# HELP webcamoid_stage_dropped_frames_total "
+            "Frames dropped by the stage.\n"
+            "# TYPE webcamoid_stage_dropped_frames_total counter\n"
+            "# HELP webcamoid_stage_cpu_seconds_total "
+            "Thread CPU time spent in the stage.\n"
+            "# TYPE webcamoid_stage_cpu_seconds_total counter\n"
+            "# HELP webcamoid_stage_pool_bytes "
+            "Bytes the stage holds from the buffer pools.\n"
+            "# TYPE webcamoid_stage_pool_bytes gauge\n"
+            "# HELP webcamoid_stage_latency_seconds "
+            "Per frame latency of the stage.\n"
+            "# TYPE webcamoid_stage_latency_seconds histogram\n";
+
+    for (auto it = metrics.constBegin(); it != metrics.constEnd(); it++) {
+        auto stage = it.value().toMap();
+        auto label = QString("{stage=\"%1\"}").arg(escapeLabel(it.key()));
+        qint64 count = stage["count"].toLongLong();
+        body += QString("webcamoid_stage_frames_total%1 %2\n")
+                    .arg(label).arg(count).toUtf8();
+        body += QString("webcamoid_stage_dropped_frames_total%1 %2\n")
+                    .arg(label).arg(stage["drops"].toLongLong()).toUtf8();
+        body += QString("webcamoid_stage_cpu_seconds_total%1 %2\n")
+                    .arg(label)
+                    .arg(stage["cpuNs"].toLongLong() / 1e9).toUtf8();
+        body += QString("webcamoid_stage_pool_bytes%1 %2\n")
+                    .arg(label).arg(stage["poolBytes"].toLongLong()).toUtf8();
+
+        auto histogram = stage["histogram"].toList();
+        qint64 cumulative = 0;
+
+        for (int i = 0; i < histogram.size() - 1; i++) {
+            cumulative += histogram[i].toLongLong();
+            qreal le = 1e-6 * (qint64(1) << i);
+            body += QString("webcamoid_stage_latency_seconds_bucket"
+                            "{stage=\"%1\",le=\"%2\"} %3\n")
+                        .arg(escapeLabel(it.key()))
+                        .arg(le)
+                        .arg(cumulative).toUtf8();
+        }
+
+        body += QString("webcamoid_stage_latency_seconds_bucket"
+                        "{stage=\"%1\",le=\"+Inf\"} %2\n")
+                    .arg(escapeLabel(it.key())).arg(count).toUtf8();
+        body += QString("webcamoid_stage_latency_seconds_sum%1 %2\n")
+                    .arg(label)
+                    .arg(count * stage["avgNs"].toLongLong() / 1e9).toUtf8();
+        body += QString("webcamoid_stage_latency_seconds_count%1 %2\n")
+                    .arg(label).arg(count).toUtf8();
+    }
+
+    return body;
+}
+
+MetricsExporter::MetricsExporter(QObject *parent):
+    QObject(parent)
+{
+    this->d = new MetricsExporterPrivate;
+
+    /* The exporter runs in its own thread. A scrape only reads aggregated
+     * snapshots there, so it never blocks the GUI or a frame thread. */
+    this->d->m_thread.start();
+    this->moveToThread(&this->d->m_thread);
+}
+
+MetricsExporter::~MetricsExporter()
+{
+    QMetaObject::invokeMethod(this,
+                              "stopServer",
+                              Qt::BlockingQueuedConnection);
+    this->d->m_thread.quit();
+    this->d->m_thread.wait();
+    delete this->d;
+}
+
+int MetricsExporter::port() const
+{
+    QMutexLocker locker(&this->d->m_mutex);
+
+    return this->d->m_port;
+}
+
+void MetricsExporter::setPort(int port)
+{
+    this->d->m_mutex.lock();
+
+    if (this->d->m_port == port) {
+        this->d->m_mutex.unlock();
+
+        return;
+    }
+
+    this->d->m_port = port;
+    this->d->m_mutex.unlock();
+
+    // The server itself is (re)created in the exporter thread.
+    QMetaObject::invokeMethod(this, "applyPort", Qt::QueuedConnection);
+    emit this->portChanged(port);
+}
+
+void MetricsExporter::resetPort()
+{
+    this->setPort(0);
+}
+
+void MetricsExporter::applyPort()
+{
+    this->stopServer();
+    this->d->m_mutex.lock();
+    int port = this->d->m_port;
+    this->d->m_mutex.unlock();
+
+    if (port < 1)
+        return;
+
+    this->d->m_server = new QTcpServer(this);
+    QObject::connect(this->d->m_server,
+                     &QTcpServer::newConnection,
+                     this,
+                     &MetricsExporter::handleConnections);
+
+    if (!this->d->m_server->listen(QHostAddress::Any, quint16(port))) {
+        qWarning() << "Can't export metrics on port"
+                   << port << ":"
+                   << this->d->m_server->errorString();
+        delete this->d->m_server;
+        this->d->m_server = nullptr;
+
+        return;
+    }
+
+    // Serving metrics implies collecting them.
+    AkElement::setMetricsEnabled(true);
+}
+
+void MetricsExporter::stopServer()
+{
+    if (!this->d->m_server)
+        return;
+
+    this->d->m_server->close();
+    delete this->d->m_server;
+    this->d->m_server = nullptr;
+}
+
+void MetricsExporter::handleConnections()
+{
+    while (auto socket = this->d->m_server->nextPendingConnection()) {
+        QObject::connect(socket,
+                         &QTcpSocket::disconnected,
+                         socket,
+                         &QTcpSocket::deleteLater);
+        QObject::connect(socket,
+                         &QTcpSocket::readyRead,
+                         [socket] () {
+            auto request = socket->property("request").toByteArray()
+                           + socket->readAll();
+
+            if (!request.contains("\r\n\r\n")) {
+                socket->setProperty("request", request);
+
+                return;
+            }
+
+            auto requestLine = request.split('\r').first().split(' ');
+            auto path = requestLine.size() > 1? requestLine[1]: QByteArray();
+            QByteArray response;
+
+            if (requestLine.first() == "GET"
+                && (path == "/metrics" || path == "/")) {
+                auto body = renderMetrics();
+                response = "HTTP/1.1 200 OK\r\n"
+                           "Content-Type: text/plain; version=0.0.4\r\n"
+                           "Content-Length: "
+                           + QByteArray::number(body.size())
+                           + "\r\n"
+                             "Connection: close\r\n"
+                             "\r\n"
+                           + body;
+            } else {
+                response = "HTTP/1.1 404 Not Found\r\n"
+                           "Content-Length: 0\r\n"
+                           "Connection: close\r\n"
+                           "\r\n";
+            }
+
+            socket->write(response);
+            socket->disconnectFromHost();
+        });
+    }
+}
+
+#include "moc_metricsexporter.cpp"
@@ -0,0 +1,69 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef METRICSEXPORTER_H
+#define METRICSEXPORTER_H
+
+#include <QObject>
+
+class MetricsExporterPrivate;
+class MetricsExporter;
+
+typedef QSharedPointer<MetricsExporter> MetricsExporterPtr;
+
+/* Prometheus text format exporter for the pipeline metrics.
+ *
+ * Listens on a TCP port and answers HTTP GET /metrics with the per stage
+ * statistics (frames processed and dropped, latency histograms, CPU time
+ * and pool bytes). The exporter lives in its own thread and only reads
+ * aggregated snapshots, so scraping never touches the frame path. A port
+ * of 0 keeps the exporter off.
+ */
+class MetricsExporter: public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int port
+               READ port
+               WRITE setPort
+               RESET resetPort
+               NOTIFY portChanged)
+
+    public:
+        explicit MetricsExporter(QObject *parent=nullptr);
+        ~MetricsExporter();
+
+        Q_INVOKABLE int port() const;
+
+    private:
+        MetricsExporterPrivate *d;
+
+    signals:
+        void portChanged(int port);
+
+    public slots:
+        void setPort(int port);
+        void resetPort();
+
+    private slots:
+        void applyPort();
+        void stopServer();
+        void handleConnections();
+};
+
+#endif // METRICSEXPORTER_H
@@ -0,0 +1,270 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QDir>
+#include <QFile>
+#include <QQmlApplicationEngine>
+#include <QQmlContext>
+#include <QTimer>
+
+#include "performancegovernor.h"
+
+#define DEFAULT_UPDATE_INTERVAL 5000
+
+/* Entering power saver above 80 degrees but only leaving it below 72 keeps
+ * the level stable while the die temperature oscillates around a threshold,
+ * which it does constantly under a periodic load like a video pipeline.
+ */
+#define TEMP_POWERSAVER_ENTER 80.0
+#define TEMP_POWERSAVER_EXIT  72.0
+#define TEMP_CRITICAL_ENTER   90.0
+#define TEMP_CRITICAL_EXIT    82.0
+
+// Indexed by PerformanceLevel, 0 means uncapped.
+static const int previewFpsCaps[] = {0, 30, 15, 5};
+
+class PerformanceGovernorPrivate
+{
+    public:
+        QQmlApplicationEngine *m_engine;
+        QTimer m_timer;
+        PerformanceGovernor::PerformanceLevel m_level;
+        bool m_enabled;
+        bool m_onBattery;
+        qreal m_temperature;
+
+        PerformanceGovernorPrivate():
+            m_engine(nullptr),
+            m_level(PerformanceGovernor::PerformanceLevelFull),
+            m_enabled(false),
+            m_onBattery(false),
+            m_temperature(0.0)
+        {
+        }
+
+        bool readOnBattery() const;
+        qreal readTemperature() const;
+};
+
+PerformanceGovernor::PerformanceGovernor(QQmlApplicationEngine *engine,
+                                         QObject *parent):
+    QObject(parent)
+{
+    this->d = new PerformanceGovernorPrivate;
+    this->setQmlEngine(engine);
+    this->d->m_timer.setInterval(DEFAULT_UPDATE_INTERVAL);
+
+    QObject::connect(&this->d->m_timer,
+                     &QTimer::timeout,
+                     this,
+                     &PerformanceGovernor::updateState);
+}
+
+PerformanceGovernor::~PerformanceGovernor()
+{
+    delete this->d;
+}
+
+bool PerformanceGovernor::enabled() const
+{
+    return this->d->m_enabled;
+}
+
+PerformanceGovernor::PerformanceLevel PerformanceGovernor::level() const
+{
+    return this->d->m_level;
+}
+
+bool PerformanceGovernor::onBattery() const
+{
+    return this->d->m_onBattery;
+}
+
+qreal PerformanceGovernor::temperature() const
+{
+    return this->d->m_temperature;
+}
+
+int PerformanceGovernor::updateInterval() const
+{
+    return this->d->m_timer.interval();
+}
+
+int PerformanceGovernor::previewFpsCap() const
+{
+    return previewFpsCaps[this->d->m_level];
+}
+
+bool PerformanceGovernorPrivate::readOnBattery() const
+{
+#ifdef Q_OS_LINUX
+    QDir powerSupplyDir("/sys/class/power_supply");
+    bool haveBattery = false;
+
+    for (const QString &supply: powerSupplyDir.entryList(QDir::Dirs
+                                                         | QDir::NoDotAndDotDot)) {
+        QFile typeFile(powerSupplyDir.filePath(supply + "/type"));
+
+        if (!typeFile.open(QIODevice::ReadOnly | QIODevice::Text))
+            continue;
+
+        QString type = QString(typeFile.readAll()).trimmed();
+        typeFile.close();
+
+        if (type == "Mains") {
+            QFile onlineFile(powerSupplyDir.filePath(supply + "/online"));
+
+            if (onlineFile.open(QIODevice::ReadOnly | QIODevice::Text)
+                && QString(onlineFile.readAll()).trimmed() == "1")
+                return false;
+        } else if (type == "Battery") {
+            haveBattery = true;
+        }
+    }
+
+    return haveBattery;
+#else
+    return false;
+#endif
+}
+
+qreal PerformanceGovernorPrivate::readTemperature() const
+{
+    qreal temperature = 0.0;
+
+#ifdef Q_OS_LINUX
+    QDir thermalDir("/sys/class/thermal");
+
+    for (const QString &zone: thermalDir.entryList({"thermal_zone*"},
+                                                   QDir::Dirs
+                                                   | QDir::NoDotAndDotDot)) {
+        QFile tempFile(thermalDir.filePath(zone + "/temp"));
+
+        if (!tempFile.open(QIODevice::ReadOnly | QIODevice::Text))
+            continue;
+
+        // The kernel reports millidegrees Celsius.
+        qreal zoneTemp = QString(tempFile.readAll()).trimmed().toDouble()
+                         / 1000.0;
+        tempFile.close();
+        temperature = qMax(temperature, zoneTemp);
+    }
+#endif
+
+    return temperature;
+}
+
+void PerformanceGovernor::setEnabled(bool enabled)
+{
+    if (this->d->m_enabled == enabled)
+        return;
+
+    this->d->m_enabled = enabled;
+
+    if (enabled) {
+        this->updateState();
+        this->d->m_timer.start();
+    } else {
+        this->d->m_timer.stop();
+
+        if (this->d->m_level != PerformanceLevelFull) {
+            this->d->m_level = PerformanceLevelFull;
+            emit this->levelChanged(this->d->m_level);
+        }
+    }
+
+    emit this->enabledChanged(enabled);
+}
+
+void PerformanceGovernor::setUpdateInterval(int updateInterval)
+{
+    if (this->d->m_timer.interval() == updateInterval)
+        return;
+
+    this->d->m_timer.setInterval(updateInterval);
+    emit this->updateIntervalChanged(updateInterval);
+}
+
+void PerformanceGovernor::resetEnabled()
+{
+    this->setEnabled(false);
+}
+
+void PerformanceGovernor::resetUpdateInterval()
+{
+    this->setUpdateInterval(DEFAULT_UPDATE_INTERVAL);
+}
+
+void PerformanceGovernor::setQmlEngine(QQmlApplicationEngine *engine)
+{
+    if (this->d->m_engine == engine)
+        return;
+
+    this->d->m_engine = engine;
+
+    if (engine)
+        engine->rootContext()->setContextProperty("PerformanceGovernor",
+                                                  this);
+}
+
+void PerformanceGovernor::updateState()
+{
+    bool onBattery = this->d->readOnBattery();
+    qreal temperature = this->d->readTemperature();
+
+    /* The thermal level only moves one way per check: up as soon as an
+     * enter threshold is crossed, down only after cooling below the exit
+     * threshold of the level being left. */
+    auto level = this->d->m_level;
+
+    if (temperature >= TEMP_CRITICAL_ENTER)
+        level = PerformanceLevelCritical;
+    else if (temperature >= TEMP_POWERSAVER_ENTER)
+        level = qMax(level, PerformanceLevelPowerSaver);
+    else if (level == PerformanceLevelCritical
+             && temperature < TEMP_CRITICAL_EXIT)
+        level = PerformanceLevelPowerSaver;
+
+    if (level == PerformanceLevelPowerSaver
+        && temperature < TEMP_POWERSAVER_EXIT)
+        level = PerformanceLevelFull;
+
+    // Running from the battery costs at least one level.
+    if (onBattery)
+        level = qMax(level, PerformanceLevelBalanced);
+    else if (level == PerformanceLevelBalanced)
+        level = PerformanceLevelFull;
+
+    if (onBattery != this->d->m_onBattery) {
+        this->d->m_onBattery = onBattery;
+        emit this->onBatteryChanged(onBattery);
+    }
+
+    if (!qFuzzyCompare(temperature, this->d->m_temperature)) {
+        this->d->m_temperature = temperature;
+        emit this->temperatureChanged(temperature);
+    }
+
+    if (level != this->d->m_level) {
+        this->d->m_level = level;
+        emit this->levelChanged(level);
+    }
+}
+
+#include "moc_performancegovernor.cpp"
@@ -0,0 +1,116 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef PERFORMANCEGOVERNOR_H
+#define PERFORMANCEGOVERNOR_H
+
+#include <QObject>
+
+class PerformanceGovernorPrivate;
+class PerformanceGovernor;
+class QQmlApplicationEngine;
+
+typedef QSharedPointer<PerformanceGovernor> PerformanceGovernorPtr;
+
+/* Watches the power source and the CPU temperature, and condenses them
+ * into a single performance level the pipeline can degrade against, so
+ * quality goes down in predictable steps instead of whatever the thermal
+ * throttling of the moment produces.
+ *
+ * The thermal thresholds have a few degrees of hysteresis: the level only
+ * steps up after crossing the enter threshold and only steps back after
+ * cooling below the lower exit threshold, so the pipeline doesn't flap
+ * between qualities around a single temperature.
+ *
+ * The governor itself only senses and decides; MediaTools wires the
+ * responses (preview fps cap, effects overload control) and the QML side
+ * can react to the level for anything else.
+ */
+class PerformanceGovernor: public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool enabled
+               READ enabled
+               WRITE setEnabled
+               RESET resetEnabled
+               NOTIFY enabledChanged)
+    Q_PROPERTY(PerformanceLevel level
+               READ level
+               NOTIFY levelChanged)
+    Q_PROPERTY(bool onBattery
+               READ onBattery
+               NOTIFY onBatteryChanged)
+    Q_PROPERTY(qreal temperature
+               READ temperature
+               NOTIFY temperatureChanged)
+    Q_PROPERTY(int updateInterval
+               READ updateInterval
+               WRITE setUpdateInterval
+               RESET resetUpdateInterval
+               NOTIFY updateIntervalChanged)
+
+    public:
+        enum PerformanceLevel
+        {
+            PerformanceLevelFull,
+            PerformanceLevelBalanced,
+            PerformanceLevelPowerSaver,
+            PerformanceLevelCritical
+        };
+        Q_ENUM(PerformanceLevel)
+
+        explicit PerformanceGovernor(QQmlApplicationEngine *engine=nullptr,
+                                     QObject *parent=nullptr);
+        ~PerformanceGovernor();
+
+        Q_INVOKABLE bool enabled() const;
+        Q_INVOKABLE PerformanceLevel level() const;
+        Q_INVOKABLE bool onBattery() const;
+
+        // Hottest thermal zone in Celsius, or 0 when unreadable.
+        Q_INVOKABLE qreal temperature() const;
+        Q_INVOKABLE int updateInterval() const;
+
+        // Preview update cap for the current level, 0 means uncapped.
+        Q_INVOKABLE int previewFpsCap() const;
+
+    private:
+        PerformanceGovernorPrivate *d;
+
+    signals:
+        void enabledChanged(bool enabled);
+        void levelChanged(PerformanceGovernor::PerformanceLevel level);
+        void onBatteryChanged(bool onBattery);
+        void temperatureChanged(qreal temperature);
+        void updateIntervalChanged(int updateInterval);
+
+    public slots:
+        void setEnabled(bool enabled);
+        void setUpdateInterval(int updateInterval);
+        void resetEnabled();
+        void resetUpdateInterval();
+        void setQmlEngine(QQmlApplicationEngine *engine=nullptr);
+
+    private slots:
+        void updateState();
+};
+
+Q_DECLARE_METATYPE(PerformanceGovernor::PerformanceLevel)
+
+#endif // PERFORMANCEGOVERNOR_H
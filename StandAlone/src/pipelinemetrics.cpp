@@ -0,0 +1,144 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QTimer>
+#include <QQmlContext>
+#include <QQmlApplicationEngine>
+#include <akelement.h>
+
+#include "pipelinemetrics.h"
+
+#define DEFAULT_UPDATE_INTERVAL 1000
+
+class PipelineMetricsPrivate
+{
+    public:
+        QQmlApplicationEngine *m_engine;
+        QTimer m_timer;
+        QVariantList m_stages;
+
+        PipelineMetricsPrivate():
+            m_engine(nullptr)
+        {
+        }
+};
+
+PipelineMetrics::PipelineMetrics(QQmlApplicationEngine *engine,
+                                 QObject *parent):
+    QObject(parent)
+{
+    this->d = new PipelineMetricsPrivate;
+    this->setQmlEngine(engine);
+    this->d->m_timer.setInterval(DEFAULT_UPDATE_INTERVAL);
+
+    QObject::connect(&this->d->m_timer,
+                     &QTimer::timeout,
+                     this,
+                     &PipelineMetrics::updateStages);
+}
+
+PipelineMetrics::~PipelineMetrics()
+{
+    delete this->d;
+}
+
+bool PipelineMetrics::enabled() const
+{
+    return AkElement::metricsEnabled();
+}
+
+QVariantList PipelineMetrics::stages() const
+{
+    return this->d->m_stages;
+}
+
+int PipelineMetrics::updateInterval() const
+{
+    return this->d->m_timer.interval();
+}
+
+void PipelineMetrics::setEnabled(bool enabled)
+{
+    if (AkElement::metricsEnabled() == enabled)
+        return;
+
+    AkElement::setMetricsEnabled(enabled);
+
+    if (enabled) {
+        this->d->m_timer.start();
+    } else {
+        this->d->m_timer.stop();
+        this->d->m_stages.clear();
+        emit this->stagesChanged(this->d->m_stages);
+    }
+
+    emit this->enabledChanged(enabled);
+}
+
+void PipelineMetrics::setUpdateInterval(int updateInterval)
+{
+    if (this->d->m_timer.interval() == updateInterval)
+        return;
+
+    this->d->m_timer.setInterval(updateInterval);
+    emit this->updateIntervalChanged(updateInterval);
+}
+
+void PipelineMetrics::resetEnabled()
+{
+    this->setEnabled(false);
+}
+
+void PipelineMetrics::resetUpdateInterval()
+{
+    this->setUpdateInterval(DEFAULT_UPDATE_INTERVAL);
+}
+
+void PipelineMetrics::setQmlEngine(QQmlApplicationEngine *engine)
+{
+    if (this->d->m_engine == engine)
+        return;
+
+    this->d->m_engine = engine;
+
+    if (engine)
+        engine->rootContext()->setContextProperty("PipelineMetrics", this);
+}
+
+void PipelineMetrics::updateStages()
+{
+    auto metrics = AkElement::metrics();
+    QVariantList stages;
+
+    // QVariantMap iterates in key order, so the list comes out sorted by
+    // stage name.
+    for (auto it = metrics.constBegin(); it != metrics.constEnd(); it++) {
+        auto stage = it.value().toMap();
+        stage["stage"] = it.key();
+        stages << stage;
+    }
+
+    if (this->d->m_stages == stages)
+        return;
+
+    this->d->m_stages = stages;
+    emit this->stagesChanged(stages);
+}
+
+#include "moc_pipelinemetrics.cpp"
@@ -0,0 +1,84 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef PIPELINEMETRICS_H
+#define PIPELINEMETRICS_H
+
+#include <QObject>
+#include <QVariantList>
+
+class PipelineMetricsPrivate;
+class PipelineMetrics;
+class QQmlApplicationEngine;
+
+typedef QSharedPointer<PipelineMetrics> PipelineMetricsPtr;
+
+/* QML facing view over the per-element pipeline accounting.
+ *
+ * While enabled, the stage statistics collected by the library (frames
+ * processed and dropped, per frame latency, thread CPU time and pool bytes
+ * held) are polled periodically and exposed as a list ready to feed a QML
+ * list view, one entry per stage.
+ */
+class PipelineMetrics: public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool enabled
+               READ enabled
+               WRITE setEnabled
+               RESET resetEnabled
+               NOTIFY enabledChanged)
+    Q_PROPERTY(QVariantList stages
+               READ stages
+               NOTIFY stagesChanged)
+    Q_PROPERTY(int updateInterval
+               READ updateInterval
+               WRITE setUpdateInterval
+               RESET resetUpdateInterval
+               NOTIFY updateIntervalChanged)
+
+    public:
+        explicit PipelineMetrics(QQmlApplicationEngine *engine=nullptr,
+                                 QObject *parent=nullptr);
+        ~PipelineMetrics();
+
+        Q_INVOKABLE bool enabled() const;
+        Q_INVOKABLE QVariantList stages() const;
+        Q_INVOKABLE int updateInterval() const;
+
+    private:
+        PipelineMetricsPrivate *d;
+
+    signals:
+        void enabledChanged(bool enabled);
+        void stagesChanged(const QVariantList &stages);
+        void updateIntervalChanged(int updateInterval);
+
+    public slots:
+        void setEnabled(bool enabled);
+        void setUpdateInterval(int updateInterval);
+        void resetEnabled();
+        void resetUpdateInterval();
+        void setQmlEngine(QQmlApplicationEngine *engine=nullptr);
+
+    private slots:
+        void updateStages();
+};
+
+#endif // PIPELINEMETRICS_H
@@ -0,0 +1,183 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QCoreApplication>
+#include <QDebug>
+
+#include "pipelinerunner.h"
+#include "pluginconfigs.h"
+#include "mediasource.h"
+#include "audiolayer.h"
+#include "videoeffects.h"
+#include "recording.h"
+#include "metricsexporter.h"
+#include "clioptions.h"
+
+class PipelineRunnerPrivate
+{
+    public:
+        const CliOptions *m_cliOptions;
+        PluginConfigsPtr m_pluginConfigs;
+        MediaSourcePtr m_mediaSource;
+        AudioLayerPtr m_audioLayer;
+        VideoEffectsPtr m_videoEffects;
+        RecordingPtr m_recording;
+        MetricsExporterPtr m_metricsExporter;
+
+        PipelineRunnerPrivate():
+            m_cliOptions(nullptr)
+        {
+        }
+};
+
+PipelineRunner::PipelineRunner(const CliOptions &cliOptions, QObject *parent):
+    QObject(parent)
+{
+    this->d = new PipelineRunnerPrivate;
+    this->d->m_cliOptions = &cliOptions;
+
+    // Same graph the interface builds, minus the QML engine, the display and
+    // the virtual camera.
+    this->d->m_pluginConfigs =
+            PluginConfigsPtr(new PluginConfigs(cliOptions));
+    this->d->m_mediaSource = MediaSourcePtr(new MediaSource);
+    this->d->m_audioLayer = AudioLayerPtr(new AudioLayer);
+    this->d->m_videoEffects = VideoEffectsPtr(new VideoEffects);
+    this->d->m_recording = RecordingPtr(new Recording);
+
+    if (cliOptions.isSet(cliOptions.metricsPortOpt())) {
+        this->d->m_metricsExporter = MetricsExporterPtr(new MetricsExporter);
+        auto port = cliOptions.value(cliOptions.metricsPortOpt()).toInt();
+        this->d->m_metricsExporter->setPort(port);
+    }
+
+    AkElement::link(this->d->m_mediaSource.data(),
+                    this->d->m_videoEffects.data(),
+                    Qt::DirectConnection);
+    AkElement::link(this->d->m_mediaSource.data(),
+                    this->d->m_audioLayer.data(),
+                    Qt::DirectConnection);
+    AkElement::link(this->d->m_videoEffects.data(),
+                    this->d->m_recording.data(),
+                    Qt::DirectConnection);
+    AkElement::link(this->d->m_audioLayer.data(),
+                    this->d->m_recording.data(),
+                    Qt::DirectConnection);
+    QObject::connect(this->d->m_mediaSource.data(),
+                     &MediaSource::error,
+                     this,
+                     &PipelineRunner::handleError);
+    QObject::connect(this->d->m_mediaSource.data(),
+                     &MediaSource::stateChanged,
+                     this->d->m_videoEffects.data(),
+                     &VideoEffects::setState);
+    QObject::connect(this->d->m_mediaSource.data(),
+                     &MediaSource::stateChanged,
+                     this->d->m_audioLayer.data(),
+                     &AudioLayer::setOutputState);
+    QObject::connect(this->d->m_recording.data(),
+                     &Recording::stateChanged,
+                     this->d->m_audioLayer.data(),
+                     &AudioLayer::setInputState);
+    QObject::connect(this->d->m_mediaSource.data(),
+                     &MediaSource::audioCapsChanged,
+                     this->d->m_audioLayer.data(),
+                     &AudioLayer::setInputCaps);
+    QObject::connect(this->d->m_mediaSource.data(),
+                     &MediaSource::streamChanged,
+                     [this] (const QString &stream)
+                     {
+                         this->d->m_audioLayer->setInputDescription(this->d->m_mediaSource->description(stream));
+                     });
+    QObject::connect(this->d->m_audioLayer.data(),
+                     &AudioLayer::outputCapsChanged,
+                     this->d->m_recording.data(),
+                     &Recording::setAudioCaps);
+    QObject::connect(this->d->m_mediaSource.data(),
+                     &MediaSource::videoCapsChanged,
+                     this->d->m_recording.data(),
+                     &Recording::setVideoCaps);
+    QObject::connect(qApp,
+                     &QCoreApplication::aboutToQuit,
+                     [this] () {
+                        this->d->m_recording->setState(AkElement::ElementStateNull);
+                        this->d->m_mediaSource->setState(AkElement::ElementStateNull);
+                     });
+
+    this->d->m_recording->setVideoCaps(this->d->m_mediaSource->videoCaps());
+    this->d->m_recording->setAudioCaps(this->d->m_audioLayer->outputCaps());
+    this->d->m_audioLayer->setInputCaps(this->d->m_mediaSource->audioCaps());
+    this->d->m_audioLayer->setInputDescription(this->d->m_mediaSource->description(this->d->m_mediaSource->stream()));
+}
+
+PipelineRunner::~PipelineRunner()
+{
+    delete this->d;
+}
+
+bool PipelineRunner::run()
+{
+    auto cliOptions = this->d->m_cliOptions;
+    auto stream = cliOptions->value(cliOptions->streamOpt());
+
+    if (stream.isEmpty()) {
+        qWarning() << "No input stream specified, pass one with --stream";
+
+        return false;
+    }
+
+    // Anything that is not a known camera or desktop is treated as an URI.
+    if (!this->d->m_mediaSource->streams().contains(stream))
+        this->d->m_mediaSource->setUris({{stream, stream}});
+
+    this->d->m_mediaSource->setStream(stream);
+
+    auto effects =
+            cliOptions->value(cliOptions->effectsOpt())
+                .split(';', QString::SkipEmptyParts);
+
+    for (const QString &effect: effects)
+        if (!this->d->m_videoEffects->appendEffect(effect.trimmed()))
+            qWarning() << "Can't load effect" << effect.trimmed();
+
+    auto record = cliOptions->value(cliOptions->recordOpt());
+
+    if (!record.isEmpty())
+        this->d->m_recording->setVideoFileName(record);
+
+    this->d->m_mediaSource->setState(AkElement::ElementStatePlaying);
+
+    if (this->d->m_mediaSource->state() != AkElement::ElementStatePlaying) {
+        qWarning() << "Can't start stream" << stream;
+
+        return false;
+    }
+
+    if (!record.isEmpty())
+        this->d->m_recording->setState(AkElement::ElementStatePlaying);
+
+    return true;
+}
+
+void PipelineRunner::handleError(const QString &message)
+{
+    qWarning() << message;
+}
+
+#include "moc_pipelinerunner.cpp"
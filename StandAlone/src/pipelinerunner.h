@@ -0,0 +1,54 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef PIPELINERUNNER_H
+#define PIPELINERUNNER_H
+
+#include <QObject>
+
+class PipelineRunnerPrivate;
+class CliOptions;
+
+/* Headless pipeline driver.
+ *
+ * Wires MediaSource, AudioLayer, VideoEffects and Recording from the command
+ * line options alone, without a QML engine or a render window, so a capture
+ * or transcode job can run on a box with no display server.
+ */
+class PipelineRunner: public QObject
+{
+    Q_OBJECT
+
+    public:
+        explicit PipelineRunner(const CliOptions &cliOptions,
+                                QObject *parent=nullptr);
+        ~PipelineRunner();
+
+        // Configure and start the pipeline. Returns false on a configuration
+        // error, with the reason already printed.
+        bool run();
+
+    private:
+        PipelineRunnerPrivate *d;
+
+    private slots:
+        void handleError(const QString &message);
+};
+
+#endif // PIPELINERUNNER_H
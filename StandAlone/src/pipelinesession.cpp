@@ -0,0 +1,193 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QDebug>
+
+#include "pipelinesession.h"
+#include "mediasource.h"
+#include "audiolayer.h"
+#include "videoeffects.h"
+#include "recording.h"
+
+class PipelineSessionPrivate
+{
+    public:
+        MediaSourcePtr m_mediaSource;
+        AudioLayerPtr m_audioLayer;
+        VideoEffectsPtr m_videoEffects;
+        RecordingPtr m_recording;
+};
+
+PipelineSession::PipelineSession(QObject *parent):
+    QObject(parent)
+{
+    this->d = new PipelineSessionPrivate;
+
+    // Same graph the interface builds, minus the QML engine, the display
+    // and the virtual camera.
+    this->d->m_mediaSource = MediaSourcePtr(new MediaSource);
+    this->d->m_audioLayer = AudioLayerPtr(new AudioLayer);
+    this->d->m_videoEffects = VideoEffectsPtr(new VideoEffects);
+    this->d->m_recording = RecordingPtr(new Recording);
+
+    /* The interface session owns the saved configuration and the loaded
+     * effect chain; a background session starts clean and never writes
+     * through to the settings. */
+    this->d->m_mediaSource->setSaveConfigs(false);
+    this->d->m_videoEffects->setEffects({}, false);
+
+    AkElement::link(this->d->m_mediaSource.data(),
+                    this->d->m_videoEffects.data(),
+                    Qt::DirectConnection);
+    AkElement::link(this->d->m_mediaSource.data(),
+                    this->d->m_audioLayer.data(),
+                    Qt::DirectConnection);
+    AkElement::link(this->d->m_videoEffects.data(),
+                    this->d->m_recording.data(),
+                    Qt::DirectConnection);
+    AkElement::link(this->d->m_audioLayer.data(),
+                    this->d->m_recording.data(),
+                    Qt::DirectConnection);
+    QObject::connect(this->d->m_mediaSource.data(),
+                     &MediaSource::error,
+                     this,
+                     &PipelineSession::error);
+    QObject::connect(this->d->m_mediaSource.data(),
+                     &MediaSource::stateChanged,
+                     this,
+                     &PipelineSession::stateChanged);
+    QObject::connect(this->d->m_mediaSource.data(),
+                     &MediaSource::streamChanged,
+                     this,
+                     &PipelineSession::streamChanged);
+    QObject::connect(this->d->m_videoEffects.data(),
+                     &VideoEffects::effectsChanged,
+                     this,
+                     &PipelineSession::effectsChanged);
+    QObject::connect(this->d->m_recording.data(),
+                     &Recording::videoFileNameChanged,
+                     this,
+                     &PipelineSession::videoFileNameChanged);
+    QObject::connect(this->d->m_mediaSource.data(),
+                     &MediaSource::stateChanged,
+                     this->d->m_videoEffects.data(),
+                     &VideoEffects::setState);
+    /* No MediaSource::stateChanged -> AudioLayer::setOutputState connect:
+     * only the session the interface shows monitors audio to the speakers,
+     * background sessions just capture and record. */
+    QObject::connect(this->d->m_recording.data(),
+                     &Recording::stateChanged,
+                     this->d->m_audioLayer.data(),
+                     &AudioLayer::setInputState);
+    QObject::connect(this->d->m_mediaSource.data(),
+                     &MediaSource::audioCapsChanged,
+                     this->d->m_audioLayer.data(),
+                     &AudioLayer::setInputCaps);
+    QObject::connect(this->d->m_mediaSource.data(),
+                     &MediaSource::streamChanged,
+                     [this] (const QString &stream)
+                     {
+                         this->d->m_audioLayer->setInputDescription(this->d->m_mediaSource->description(stream));
+                     });
+    QObject::connect(this->d->m_audioLayer.data(),
+                     &AudioLayer::outputCapsChanged,
+                     this->d->m_recording.data(),
+                     &Recording::setAudioCaps);
+    QObject::connect(this->d->m_mediaSource.data(),
+                     &MediaSource::videoCapsChanged,
+                     this->d->m_recording.data(),
+                     &Recording::setVideoCaps);
+
+    this->d->m_recording->setVideoCaps(this->d->m_mediaSource->videoCaps());
+    this->d->m_recording->setAudioCaps(this->d->m_audioLayer->outputCaps());
+    this->d->m_audioLayer->setInputCaps(this->d->m_mediaSource->audioCaps());
+    this->d->m_audioLayer->setInputDescription(this->d->m_mediaSource->description(this->d->m_mediaSource->stream()));
+}
+
+PipelineSession::~PipelineSession()
+{
+    this->d->m_recording->setState(AkElement::ElementStateNull);
+    this->d->m_mediaSource->setState(AkElement::ElementStateNull);
+    delete this->d;
+}
+
+QString PipelineSession::stream() const
+{
+    return this->d->m_mediaSource->stream();
+}
+
+QStringList PipelineSession::effects() const
+{
+    return this->d->m_videoEffects->effects();
+}
+
+QString PipelineSession::videoFileName() const
+{
+    return this->d->m_recording->videoFileName();
+}
+
+AkElement::ElementState PipelineSession::state() const
+{
+    return this->d->m_mediaSource->state();
+}
+
+void PipelineSession::setStream(const QString &stream)
+{
+    // Anything that is not a known camera or desktop is treated as an URI.
+    if (!this->d->m_mediaSource->streams().contains(stream)) {
+        auto uris = this->d->m_mediaSource->uris();
+        uris[stream] = stream;
+        this->d->m_mediaSource->setUris(uris);
+    }
+
+    this->d->m_mediaSource->setStream(stream);
+}
+
+void PipelineSession::setEffects(const QStringList &effects)
+{
+    this->d->m_videoEffects->setEffects(effects);
+}
+
+void PipelineSession::setVideoFileName(const QString &videoFileName)
+{
+    this->d->m_recording->setVideoFileName(videoFileName);
+}
+
+void PipelineSession::setState(AkElement::ElementState state)
+{
+    // Stop the recorder first so the file is closed before the source
+    // stops delivering, start it last so no frame is dropped at the head.
+    if (state == AkElement::ElementStatePlaying) {
+        this->d->m_mediaSource->setState(state);
+
+        if (this->d->m_mediaSource->state() == AkElement::ElementStatePlaying
+            && !this->d->m_recording->videoFileName().isEmpty())
+            this->d->m_recording->setState(AkElement::ElementStatePlaying);
+    } else {
+        this->d->m_recording->setState(AkElement::ElementStateNull);
+        this->d->m_mediaSource->setState(state);
+    }
+}
+
+void PipelineSession::resetState()
+{
+    this->setState(AkElement::ElementStateNull);
+}
+
+#include "moc_pipelinesession.cpp"
@@ -0,0 +1,91 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef PIPELINESESSION_H
+#define PIPELINESESSION_H
+
+#include <akelement.h>
+
+class PipelineSession;
+class PipelineSessionPrivate;
+
+typedef QSharedPointer<PipelineSession> PipelineSessionPtr;
+
+/* One capture graph, MediaSource through Recording, wired the same way
+ * MediaTools wires the pipeline behind the interface.
+ *
+ * MediaTools keeps a list of these so several cameras can run in one
+ * process instead of one process each. The plugin cache, the frame buffer
+ * pools and the metrics registry are per process singletons, so extra
+ * sessions reuse them instead of loading their own copies. Sessions don't
+ * monitor audio to the speakers and don't write their configuration to the
+ * settings; both belong to the session the interface controls.
+ */
+class PipelineSession: public QObject
+{
+    Q_OBJECT
+    // Stream to capture from. Anything not a known camera or desktop is
+    // treated as an URI.
+    Q_PROPERTY(QString stream
+               READ stream
+               WRITE setStream
+               NOTIFY streamChanged)
+    Q_PROPERTY(QStringList effects
+               READ effects
+               WRITE setEffects
+               NOTIFY effectsChanged)
+    // File to record to. Recording starts with the session only when set.
+    Q_PROPERTY(QString videoFileName
+               READ videoFileName
+               WRITE setVideoFileName
+               NOTIFY videoFileNameChanged)
+    Q_PROPERTY(AkElement::ElementState state
+               READ state
+               WRITE setState
+               RESET resetState
+               NOTIFY stateChanged)
+
+    public:
+        explicit PipelineSession(QObject *parent=nullptr);
+        ~PipelineSession();
+
+        Q_INVOKABLE QString stream() const;
+        Q_INVOKABLE QStringList effects() const;
+        Q_INVOKABLE QString videoFileName() const;
+        Q_INVOKABLE AkElement::ElementState state() const;
+
+    private:
+        PipelineSessionPrivate *d;
+
+    signals:
+        void streamChanged(const QString &stream);
+        void effectsChanged(const QStringList &effects);
+        void videoFileNameChanged(const QString &videoFileName);
+        void stateChanged(AkElement::ElementState state);
+        void error(const QString &message);
+
+    public slots:
+        void setStream(const QString &stream);
+        void setEffects(const QStringList &effects);
+        void setVideoFileName(const QString &videoFileName);
+        void setState(AkElement::ElementState state);
+        void resetState();
+};
+
+#endif // PIPELINESESSION_H
@@ -19,6 +19,9 @@
 
 #include <QImage>
 #include <QMutex>
+#include <QElapsedTimer>
+#include <QtConcurrent>
+#include <QThreadPool>
 #include <QFile>
 #include <QSettings>
 #include <QQmlContext>
@@ -34,6 +37,11 @@
 #define DEFAULT_RECORD_AUDIO true
 #define AUDIO_RECORDING_KEY "Enable audio recording"
 
+// Drift estimator smoothing factor, and how fast the correction is allowed
+// to move, in seconds of correction per second of audio.
+#define DRIFT_ALPHA 0.01
+#define DRIFT_SLEW 0.002
+
 class RecordingPrivate
 {
     public:
@@ -47,16 +55,42 @@ class RecordingPrivate
         AkElementPtr m_record;
         QMutex m_mutex;
         AkPacket m_curPacket;
-        QImage m_photo;
+        AkPacket m_photoPacket;
+        QThreadPool m_photoThreadPool;
+
+        /* A/V drift correction state, guarded by m_driftMutex. The camera
+         * and the sound card run on independent clocks that drift apart
+         * over hours, so each stream's media time is compared against a
+         * common wall clock, the difference is smoothed, and the audio
+         * timestamps are slewed a couple of milliseconds per second at
+         * most towards the video clock. There is no periodic catch-up
+         * jump and nothing is buffered. */
+        QMutex m_driftMutex;
+        QElapsedTimer m_driftClock;
+        qreal m_audioBase;
+        qreal m_videoBase;
+        qreal m_audioOffset;
+        qreal m_videoOffset;
+        qreal m_appliedDrift;
+        qreal m_lastAudioTime;
+        bool m_audioBaseValid;
+        bool m_videoBaseValid;
+        bool m_audioOffsetValid;
+        bool m_videoOffsetValid;
 
         RecordingPrivate():
             m_engine(nullptr),
             m_recordAudio(true),
             m_state(AkElement::ElementStateNull)
         {
+            // Photos are encoded one at a time, in shutter order.
+            this->m_photoThreadPool.setMaxThreadCount(1);
+            this->resetDrift();
         }
 
         inline QStringList recordingFormats() const;
+        inline void resetDrift();
+        inline AkPacket correctDrift(const AkPacket &packet);
 };
 
 Recording::Recording(QQmlApplicationEngine *engine, QObject *parent):
@@ -326,6 +360,94 @@ QStringList RecordingPrivate::recordingFormats() const
     return formats;
 }
 
+void RecordingPrivate::resetDrift()
+{
+    QMutexLocker locker(&this->m_driftMutex);
+    this->m_audioBase = 0.0;
+    this->m_videoBase = 0.0;
+    this->m_audioOffset = 0.0;
+    this->m_videoOffset = 0.0;
+    this->m_appliedDrift = 0.0;
+    this->m_lastAudioTime = 0.0;
+    this->m_audioBaseValid = false;
+    this->m_videoBaseValid = false;
+    this->m_audioOffsetValid = false;
+    this->m_videoOffsetValid = false;
+    this->m_driftClock.restart();
+}
+
+AkPacket RecordingPrivate::correctDrift(const AkPacket &packet)
+{
+    auto timeBase = packet.timeBase().value();
+
+    if (timeBase <= 0.0)
+        return packet;
+
+    bool isAudio = packet.caps().mimeType() == "audio/x-raw";
+    qreal time = packet.pts() * timeBase;
+    qreal wall = this->m_driftClock.elapsed() / 1.e3;
+    QMutexLocker locker(&this->m_driftMutex);
+
+    // Offset of the stream clock against the wall clock, relative to the
+    // first packet. A constant offset is just pipeline latency, drift is
+    // the part that keeps growing.
+    if (isAudio) {
+        if (!this->m_audioBaseValid) {
+            this->m_audioBase = time - wall;
+            this->m_audioBaseValid = true;
+            this->m_lastAudioTime = time;
+        }
+
+        qreal offset = time - wall - this->m_audioBase;
+
+        if (this->m_audioOffsetValid)
+            this->m_audioOffset += DRIFT_ALPHA
+                                   * (offset - this->m_audioOffset);
+        else {
+            this->m_audioOffset = offset;
+            this->m_audioOffsetValid = true;
+        }
+    } else {
+        if (!this->m_videoBaseValid) {
+            this->m_videoBase = time - wall;
+            this->m_videoBaseValid = true;
+        }
+
+        qreal offset = time - wall - this->m_videoBase;
+
+        if (this->m_videoOffsetValid)
+            this->m_videoOffset += DRIFT_ALPHA
+                                   * (offset - this->m_videoOffset);
+        else {
+            this->m_videoOffset = offset;
+            this->m_videoOffsetValid = true;
+        }
+    }
+
+    if (!isAudio
+        || !this->m_audioOffsetValid
+        || !this->m_videoOffsetValid)
+        return packet;
+
+    // Slew the applied correction towards the estimated drift, bounded so
+    // the adjustment itself stays inaudible.
+    qreal target = this->m_audioOffset - this->m_videoOffset;
+    qreal step = DRIFT_SLEW * qMax(time - this->m_lastAudioTime, 0.0);
+    this->m_lastAudioTime = time;
+    this->m_appliedDrift = qBound(this->m_appliedDrift - step,
+                                  target,
+                                  this->m_appliedDrift + step);
+
+    if (qFuzzyIsNull(this->m_appliedDrift))
+        return packet;
+
+    AkPacket corrected(packet);
+    corrected.setPts(packet.pts()
+                     - qRound64(this->m_appliedDrift / timeBase));
+
+    return corrected;
+}
+
 void Recording::setFormat(const QString &format)
 {
     if (this->d->m_record)
@@ -376,6 +498,9 @@ void Recording::setState(AkElement::ElementState state)
     if (this->d->m_state == state)
         return;
 
+    if (state == AkElement::ElementStatePlaying)
+        this->d->resetDrift();
+
     this->d->m_record->setState(state);
     this->d->m_state = state;
     emit this->stateChanged(state);
@@ -420,8 +545,10 @@ void Recording::resetState()
 
 void Recording::takePhoto()
 {
+    // Just take a reference to the current frame, the conversion and the
+    // encoding happen off the delivery thread when the photo is saved.
     this->d->m_mutex.lock();
-    this->d->m_photo = AkUtils::packetToImage(this->d->m_curPacket).copy();
+    this->d->m_photoPacket = this->d->m_curPacket;
     this->d->m_mutex.unlock();
 }
 
@@ -433,7 +560,20 @@ void Recording::savePhoto(const QString &fileName)
     if (path.isEmpty())
         return;
 
-    this->d->m_photo.save(path);
+    this->d->m_mutex.lock();
+    auto photoPacket = this->d->m_photoPacket;
+    this->d->m_mutex.unlock();
+
+    if (!photoPacket)
+        return;
+
+    /* Encode and write the photo on a background worker. The pool runs a
+     * single thread, so burst shots queue up in shutter order instead of
+     * blocking the caller or the pipeline.
+     */
+    QtConcurrent::run(&this->d->m_photoThreadPool, [photoPacket, path] {
+        AkUtils::packetToImage(photoPacket).save(path);
+    });
 }
 
 AkPacket Recording::iStream(const AkPacket &packet)
@@ -445,7 +585,7 @@ AkPacket Recording::iStream(const AkPacket &packet)
     }
 
     if (this->d->m_state == AkElement::ElementStatePlaying)
-        (*this->d->m_record)(packet);
+        (*this->d->m_record)(this->d->correctDrift(packet));
 
     return AkPacket();
 }
@@ -0,0 +1,120 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <akcaps.h>
+
+#include "sessionsnapshot.h"
+#include "mediasource.h"
+#include "videoeffects.h"
+
+#define SNAPSHOT_MAGIC quint32(0x414B5353) // "AKSS"
+#define SNAPSHOT_VERSION quint16(1)
+
+class SessionSnapshotPrivate
+{
+    public:
+        QString m_path;
+};
+
+SessionSnapshot::SessionSnapshot(QObject *parent):
+    QObject(parent)
+{
+    this->d = new SessionSnapshotPrivate;
+    auto configDir =
+            QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation);
+    this->d->m_path = configDir + "/session.snapshot";
+}
+
+SessionSnapshot::~SessionSnapshot()
+{
+    delete this->d;
+}
+
+QString SessionSnapshot::snapshotPath() const
+{
+    return this->d->m_path;
+}
+
+bool SessionSnapshot::capture(MediaSource *mediaSource,
+                              VideoEffects *videoEffects)
+{
+    if (!mediaSource || !videoEffects)
+        return false;
+
+    QDir().mkpath(QFileInfo(this->d->m_path).path());
+    QFile file(this->d->m_path);
+
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << SNAPSHOT_MAGIC
+        << SNAPSHOT_VERSION
+        << mediaSource->stream()
+        << mediaSource->audioCaps()
+        << mediaSource->videoCaps()
+        << videoEffects->effectsState();
+
+    return file.error() == QFile::NoError;
+}
+
+bool SessionSnapshot::restore(MediaSource *mediaSource,
+                              VideoEffects *videoEffects)
+{
+    if (!mediaSource || !videoEffects)
+        return false;
+
+    QFile file(this->d->m_path);
+
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+    quint32 magic = 0;
+    quint16 version = 0;
+    in >> magic >> version;
+
+    if (magic != SNAPSHOT_MAGIC || version != SNAPSHOT_VERSION)
+        return false;
+
+    QString stream;
+    AkCaps audioCaps;
+    AkCaps videoCaps;
+    QVariantList effectsState;
+    in >> stream >> audioCaps >> videoCaps >> effectsState;
+
+    if (in.status() != QDataStream::Ok)
+        return false;
+
+    videoEffects->setEffectsState(effectsState);
+
+    if (stream.isEmpty())
+        return true;
+
+    return mediaSource->restoreStream(stream, audioCaps, videoCaps);
+}
+
+#include "moc_sessionsnapshot.cpp"
@@ -0,0 +1,64 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef SESSIONSNAPSHOT_H
+#define SESSIONSNAPSHOT_H
+
+#include <QObject>
+
+class SessionSnapshotPrivate;
+class SessionSnapshot;
+class MediaSource;
+class VideoEffects;
+
+typedef QSharedPointer<SessionSnapshot> SessionSnapshotPtr;
+
+/* Binary snapshot of the resolved session for instant resume.
+ *
+ * Restoring from QSettings rebuilds the session from scratch: every
+ * effect property is a separate keyed read, and selecting the stream
+ * probes its caps, which opens the device on some backends. The snapshot
+ * keeps what the last session already resolved, the selected stream, its
+ * negotiated caps and the effect chain with its parameter blocks, in one
+ * sequential blob. A restore replays it without re-negotiation and only
+ * the device opening is deferred to the first play, so a watchdog restart
+ * comes back in a fraction of the cold start time.
+ *
+ * The blob is an acceleration, not the source of truth: QSettings keeps
+ * being written as before, and an unreadable or stale snapshot just falls
+ * back to the settings path.
+ */
+class SessionSnapshot: public QObject
+{
+    Q_OBJECT
+
+    public:
+        explicit SessionSnapshot(QObject *parent=nullptr);
+        ~SessionSnapshot();
+
+        Q_INVOKABLE QString snapshotPath() const;
+
+        bool capture(MediaSource *mediaSource, VideoEffects *videoEffects);
+        bool restore(MediaSource *mediaSource, VideoEffects *videoEffects);
+
+    private:
+        SessionSnapshotPrivate *d;
+};
+
+#endif // SESSIONSNAPSHOT_H
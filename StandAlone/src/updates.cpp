@@ -25,6 +25,8 @@
 #include <QQmlContext>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QtConcurrent>
+#include <QThreadPool>
 #include <QNetworkAccessManager>
 #include <QNetworkRequest>
 #include <QNetworkReply>
@@ -33,6 +35,10 @@
 
 #define UPDATES_URL "https://api.github.com/repos/webcamoid/webcamoid/releases/latest"
 
+/* Spread the requests over a random window so a fleet of instances powered
+ * on together doesn't hit the update endpoint at the same instant. */
+#define CHECK_JITTER_MSECS (int(1e3 * 60 * 5))
+
 class UpdatesPrivate
 {
     public:
@@ -44,14 +50,20 @@ class UpdatesPrivate
         int m_checkInterval;
         QDateTime m_lastUpdate;
         QTimer m_timer;
+        QThreadPool m_threadPool;
+        QByteArray m_etag;
+        QByteArray m_lastModified;
+        bool m_fetching;
 
         UpdatesPrivate():
             m_engine(nullptr),
             m_notifyNewVersion(false),
             m_versionType(Updates::VersionTypeCurrent),
             m_latestVersion(COMMONS_VERSION),
-            m_checkInterval(0)
+            m_checkInterval(0),
+            m_fetching(false)
         {
+            this->m_threadPool.setMaxThreadCount(1);
         }
 
         inline QVariantList vectorize(const QString &version) const;
@@ -128,6 +140,7 @@ Updates::Updates(QQmlApplicationEngine *engine, QObject *parent):
 
 Updates::~Updates()
 {
+    this->d->m_threadPool.waitForDone();
     this->saveProperties();
     delete this->d;
 }
@@ -234,10 +247,16 @@ void UpdatesPrivate::normalize(QVariantList &vector1,
 
 void Updates::checkUpdates()
 {
+    if (this->d->m_fetching)
+        return;
+
     if (this->d->m_checkInterval > 0
         &&(this->d->m_lastUpdate.isNull()
            || this->d->m_lastUpdate.daysTo(QDateTime::currentDateTime()) >= this->d->m_checkInterval)) {
-        this->d->m_manager.get(QNetworkRequest(QUrl(UPDATES_URL)));
+        this->d->m_fetching = true;
+        QTimer::singleShot(qrand() % CHECK_JITTER_MSECS,
+                           this,
+                           &Updates::fetchLatestVersion);
     }
 }
 
@@ -309,10 +328,34 @@ void Updates::setLastUpdate(const QDateTime &lastUpdate)
     emit this->lastUpdateChanged(lastUpdate);
 }
 
+void Updates::fetchLatestVersion()
+{
+    QNetworkRequest request(QUrl(UPDATES_URL));
+
+    /* Replay the validators from the last response so an unchanged release
+     * feed answers with an empty 304 instead of the full body. */
+    if (!this->d->m_etag.isEmpty())
+        request.setRawHeader("If-None-Match", this->d->m_etag);
+
+    if (!this->d->m_lastModified.isEmpty())
+        request.setRawHeader("If-Modified-Since", this->d->m_lastModified);
+
+    this->d->m_manager.get(request);
+}
+
+void Updates::applyLatestVersion(const QString &version, int versionType)
+{
+    this->setLatestVersion(version);
+    this->setVersionType(VersionType(versionType));
+    this->setLastUpdate(QDateTime::currentDateTime());
+}
+
 void Updates::replyFinished(QNetworkReply *reply)
 {
+    this->d->m_fetching = false;
+
     if (!reply || reply->error() != QNetworkReply::NoError) {
-        if (!reply)
+        if (reply)
             qDebug() << "Error requesting latest version:" << reply->errorString();
         else
             qDebug() << "Error requesting latest version: No response";
@@ -320,41 +363,63 @@ void Updates::replyFinished(QNetworkReply *reply)
         return;
     }
 
-    QString html = reply->readAll();
-    QJsonParseError error;
-    auto json = QJsonDocument::fromJson(html.toUtf8(), &error);
+    auto statusCode =
+            reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
 
-    if (error.error != QJsonParseError::NoError) {
-        qDebug() << "Error requesting latest version:" << error.errorString();
+    if (statusCode == 304) {
+        // Nothing changed upstream, the persisted result is still valid.
+        this->setLastUpdate(QDateTime::currentDateTime());
 
         return;
     }
 
-    if (!json.isObject())
-        return;
+    this->d->m_etag = reply->rawHeader("ETag");
+    this->d->m_lastModified = reply->rawHeader("Last-Modified");
+    this->saveCacheValidators();
 
-    auto jsonObj = json.object();
+    auto html = reply->readAll();
+    auto d = this->d;
 
-    if (!jsonObj.contains("tag_name"))
-        return;
+    /* The GitHub payload carries the full release description, parse it
+     * away from the interface thread. */
+    QtConcurrent::run(&this->d->m_threadPool, [this, d, html] {
+        QJsonParseError error;
+        auto json = QJsonDocument::fromJson(html, &error);
 
-    auto version = jsonObj.value("tag_name").toString(COMMONS_VERSION);
+        if (error.error != QJsonParseError::NoError) {
+            qDebug() << "Error requesting latest version:" << error.errorString();
 
-    auto isOldVersion =
-            this->d->compare(version, COMMONS_VERSION,
-                             [] (const QVariant &a, const QVariant &b) {
-                                   return a > b;
-                             });
+            return;
+        }
 
-    VersionType versionType = isOldVersion?
-                                  VersionTypeOld:
-                              version == COMMONS_VERSION?
-                                   VersionTypeCurrent:
-                                   VersionTypeDevelopment;
+        if (!json.isObject())
+            return;
 
-    this->setLatestVersion(version);
-    this->setVersionType(versionType);
-    this->setLastUpdate(QDateTime::currentDateTime());
+        auto jsonObj = json.object();
+
+        if (!jsonObj.contains("tag_name"))
+            return;
+
+        auto version = jsonObj.value("tag_name").toString(COMMONS_VERSION);
+
+        auto isOldVersion =
+                d->compare(version, COMMONS_VERSION,
+                           [] (const QVariant &a, const QVariant &b) {
+                                 return a > b;
+                           });
+
+        VersionType versionType = isOldVersion?
+                                      VersionTypeOld:
+                                  version == COMMONS_VERSION?
+                                       VersionTypeCurrent:
+                                       VersionTypeDevelopment;
+
+        QMetaObject::invokeMethod(this,
+                                  "applyLatestVersion",
+                                  Qt::QueuedConnection,
+                                  Q_ARG(QString, version),
+                                  Q_ARG(int, int(versionType)));
+    });
 }
 
 void Updates::loadProperties()
@@ -366,11 +431,16 @@ void Updates::loadProperties()
     this->setNotifyNewVersion(config.value("notify", true).toBool());
     this->setCheckInterval(config.value("checkInterval", 1).toInt());
     this->setLatestVersion(config.value("latestVersion", COMMONS_VERSION).toString());
+    this->d->m_etag = config.value("etag").toByteArray();
+    this->d->m_lastModified = config.value("lastModified").toByteArray();
     config.endGroup();
 
    if (this->d->m_checkInterval > 0) {
        this->d->m_timer.start();
-       this->checkUpdates();
+
+       // Delay the startup check so the request doesn't contend with the
+       // interface load.
+       QTimer::singleShot(10000, this, &Updates::checkUpdates);
    } else
        this->d->m_timer.stop();
 
@@ -416,6 +486,16 @@ void Updates::saveCheckInterval(int checkInterval)
     config.endGroup();
 }
 
+void Updates::saveCacheValidators()
+{
+    QSettings config;
+
+    config.beginGroup("Updates");
+    config.setValue("etag", this->d->m_etag);
+    config.setValue("lastModified", this->d->m_lastModified);
+    config.endGroup();
+}
+
 void Updates::saveLastUpdate(const QDateTime &lastUpdate)
 {
     QSettings config;
@@ -439,6 +519,8 @@ void Updates::saveProperties()
     config.setValue("notify", this->d->m_notifyNewVersion);
     config.setValue("checkInterval", this->d->m_checkInterval);
     config.setValue("latestVersion", this->d->m_latestVersion);
+    config.setValue("etag", this->d->m_etag);
+    config.setValue("lastModified", this->d->m_lastModified);
     config.endGroup();
 }
 
@@ -92,7 +92,10 @@ class Updates: public QObject
         void setVersionType(VersionType versionType);
         void setLatestVersion(const QString &latestVersion);
         void setLastUpdate(const QDateTime &lastUpdate);
+        void fetchLatestVersion();
+        void applyLatestVersion(const QString &version, int versionType);
         void replyFinished(QNetworkReply *reply);
+        void saveCacheValidators();
         void loadProperties();
         void saveNotifyNewVersion(bool notifyNewVersion);
         void saveLatestVersion(const QString &latestVersion);
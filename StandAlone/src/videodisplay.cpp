@@ -17,23 +17,365 @@
  * Web-Site: http://webcamoid.github.io/
  */
 
+#include <QElapsedTimer>
 #include <QMutex>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
 #include <QQuickWindow>
+#include <QSGGeometryNode>
+#include <QSGMaterial>
+#include <QSGMaterialShader>
 #include <QSGSimpleTextureNode>
+#include <QVector2D>
 #include <akutils.h>
+#include <akvideopacket.h>
 
 #include "videodisplay.h"
 
+/* YUV frames are uploaded plane by plane into persistent textures and
+ * converted to RGB in the fragment shader, so the render thread never
+ * touches the pixels with the CPU. Everything else falls back to the
+ * QImage path below.
+ */
+class VideoFrameMaterial: public QSGMaterial
+{
+    public:
+        AkVideoCaps::PixelFormat m_format;
+        QSize m_frameSize;
+        GLuint m_textures[3];
+
+        VideoFrameMaterial():
+            m_format(AkVideoCaps::Format_none)
+        {
+            memset(this->m_textures, 0, sizeof(this->m_textures));
+            this->setFlag(Blending, false);
+        }
+
+        ~VideoFrameMaterial()
+        {
+            if (this->m_textures[0] && QOpenGLContext::currentContext())
+                QOpenGLContext::currentContext()
+                        ->functions()->glDeleteTextures(3, this->m_textures);
+        }
+
+        QSGMaterialType *type() const;
+        QSGMaterialShader *createShader() const;
+
+        int compare(const QSGMaterial *other) const
+        {
+            auto material = static_cast<const VideoFrameMaterial *>(other);
+
+            return int(this->m_textures[0]) - int(material->m_textures[0]);
+        }
+
+        inline void uploadPlane(QOpenGLFunctions *functions,
+                                int plane,
+                                GLenum format,
+                                int width,
+                                int height,
+                                const quint8 *data,
+                                bool resized)
+        {
+            functions->glBindTexture(GL_TEXTURE_2D, this->m_textures[plane]);
+
+            if (resized) {
+                functions->glTexParameteri(GL_TEXTURE_2D,
+                                           GL_TEXTURE_MIN_FILTER,
+                                           GL_LINEAR);
+                functions->glTexParameteri(GL_TEXTURE_2D,
+                                           GL_TEXTURE_MAG_FILTER,
+                                           GL_LINEAR);
+                functions->glTexParameteri(GL_TEXTURE_2D,
+                                           GL_TEXTURE_WRAP_S,
+                                           GL_CLAMP_TO_EDGE);
+                functions->glTexParameteri(GL_TEXTURE_2D,
+                                           GL_TEXTURE_WRAP_T,
+                                           GL_CLAMP_TO_EDGE);
+                functions->glTexImage2D(GL_TEXTURE_2D,
+                                        0,
+                                        GLint(format),
+                                        width,
+                                        height,
+                                        0,
+                                        format,
+                                        GL_UNSIGNED_BYTE,
+                                        data);
+            } else {
+                functions->glTexSubImage2D(GL_TEXTURE_2D,
+                                           0,
+                                           0,
+                                           0,
+                                           width,
+                                           height,
+                                           format,
+                                           GL_UNSIGNED_BYTE,
+                                           data);
+            }
+        }
+
+        // Must be called with the render thread's GL context current.
+        void uploadFrame(const AkVideoPacket &packet)
+        {
+            auto functions = QOpenGLContext::currentContext()->functions();
+            auto caps = packet.caps();
+            int width = caps.width();
+            int height = caps.height();
+            /* constData() reads the frame buffer in place; buffer() would
+             * materialize a temporary copy that dies before the upload. */
+            auto data = reinterpret_cast<const quint8 *>(packet.constData());
+
+            if (!this->m_textures[0])
+                functions->glGenTextures(3, this->m_textures);
+
+            bool resized = this->m_frameSize != QSize(width, height)
+                           || this->m_format != caps.format();
+            functions->glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+            if (caps.format() == AkVideoCaps::Format_nv12) {
+                auto chroma = data + size_t(width) * size_t(height);
+                this->uploadPlane(functions,
+                                  0,
+                                  GL_LUMINANCE,
+                                  width,
+                                  height,
+                                  data,
+                                  resized);
+                this->uploadPlane(functions,
+                                  1,
+                                  GL_LUMINANCE_ALPHA,
+                                  width / 2,
+                                  height / 2,
+                                  chroma,
+                                  resized);
+                this->uploadPlane(functions,
+                                  2,
+                                  GL_LUMINANCE_ALPHA,
+                                  width / 2,
+                                  height / 2,
+                                  chroma,
+                                  resized);
+            } else {
+                auto uPlane = data + size_t(width) * size_t(height);
+                auto vPlane = uPlane
+                              + size_t(width / 2) * size_t(height / 2);
+                this->uploadPlane(functions,
+                                  0,
+                                  GL_LUMINANCE,
+                                  width,
+                                  height,
+                                  data,
+                                  resized);
+                this->uploadPlane(functions,
+                                  1,
+                                  GL_LUMINANCE,
+                                  width / 2,
+                                  height / 2,
+                                  uPlane,
+                                  resized);
+                this->uploadPlane(functions,
+                                  2,
+                                  GL_LUMINANCE,
+                                  width / 2,
+                                  height / 2,
+                                  vPlane,
+                                  resized);
+            }
+
+            this->m_frameSize = QSize(width, height);
+            this->m_format = caps.format();
+        }
+
+        static bool canUpload(const AkVideoCaps &caps)
+        {
+            if (caps.format() != AkVideoCaps::Format_yuv420p
+                && caps.format() != AkVideoCaps::Format_nv12)
+                return false;
+
+            return !(caps.width() & 1) && !(caps.height() & 1);
+        }
+};
+
+class VideoFrameShader: public QSGMaterialShader
+{
+    public:
+        int m_matrixId;
+        int m_opacityId;
+        int m_vSelectId;
+
+        VideoFrameShader():
+            m_matrixId(-1),
+            m_opacityId(-1),
+            m_vSelectId(-1)
+        {
+        }
+
+        const char *vertexShader() const
+        {
+            return "attribute highp vec4 qt_VertexPosition;"
+                   "attribute highp vec2 qt_VertexTexCoord;"
+                   "uniform highp mat4 qt_Matrix;"
+                   "varying highp vec2 texCoord;"
+                   ""
+                   "void main()"
+                   "{"
+                   "    gl_Position = qt_Matrix * qt_VertexPosition;"
+                   "    texCoord = qt_VertexTexCoord;"
+                   "}";
+        }
+
+        /* BT.601 limited range, the same coefficients the software
+         * converters in AkVideoConvert use. 'vSelect' picks where the V
+         * sample lives: the red channel for planar YUV, the alpha channel
+         * of the interleaved chroma plane for NV12.
+         */
+        const char *fragmentShader() const
+        {
+            return "uniform sampler2D yTexture;"
+                   "uniform sampler2D uTexture;"
+                   "uniform sampler2D vTexture;"
+                   "uniform lowp vec2 vSelect;"
+                   "uniform lowp float opacity;"
+                   "varying highp vec2 texCoord;"
+                   ""
+                   "void main()"
+                   "{"
+                   "    highp float y = 1.164 * (texture2D(yTexture, texCoord).r - 0.0625);"
+                   "    highp float u = texture2D(uTexture, texCoord).r - 0.5;"
+                   "    highp float v = dot(texture2D(vTexture, texCoord).ra, vSelect) - 0.5;"
+                   "    highp vec3 color = vec3(y + 1.596 * v,"
+                   "                            y - 0.391 * u - 0.813 * v,"
+                   "                            y + 2.018 * u);"
+                   "    gl_FragColor = vec4(clamp(color, 0.0, 1.0), 1.0) * opacity;"
+                   "}";
+        }
+
+        char const *const *attributeNames() const
+        {
+            static const char *const attributes[] = {
+                "qt_VertexPosition",
+                "qt_VertexTexCoord",
+                nullptr
+            };
+
+            return attributes;
+        }
+
+        void initialize()
+        {
+            QSGMaterialShader::initialize();
+            this->m_matrixId = this->program()->uniformLocation("qt_Matrix");
+            this->m_opacityId = this->program()->uniformLocation("opacity");
+            this->m_vSelectId = this->program()->uniformLocation("vSelect");
+            this->program()->setUniformValue("yTexture", 0);
+            this->program()->setUniformValue("uTexture", 1);
+            this->program()->setUniformValue("vTexture", 2);
+        }
+
+        void updateState(const RenderState &state,
+                         QSGMaterial *newMaterial,
+                         QSGMaterial *oldMaterial)
+        {
+            Q_UNUSED(oldMaterial)
+
+            auto material = static_cast<VideoFrameMaterial *>(newMaterial);
+            auto functions = QOpenGLContext::currentContext()->functions();
+
+            for (int plane = 2; plane >= 0; plane--) {
+                functions->glActiveTexture(GLenum(GL_TEXTURE0 + plane));
+                functions->glBindTexture(GL_TEXTURE_2D,
+                                         material->m_textures[plane]);
+            }
+
+            if (material->m_format == AkVideoCaps::Format_nv12)
+                this->program()->setUniformValue(this->m_vSelectId,
+                                                 QVector2D(0.0, 1.0));
+            else
+                this->program()->setUniformValue(this->m_vSelectId,
+                                                 QVector2D(1.0, 0.0));
+
+            if (state.isMatrixDirty())
+                this->program()->setUniformValue(this->m_matrixId,
+                                                 state.combinedMatrix());
+
+            if (state.isOpacityDirty())
+                this->program()->setUniformValue(this->m_opacityId,
+                                                 state.opacity());
+        }
+};
+
+QSGMaterialType *VideoFrameMaterial::type() const
+{
+    static QSGMaterialType materialType;
+
+    return &materialType;
+}
+
+QSGMaterialShader *VideoFrameMaterial::createShader() const
+{
+    return new VideoFrameShader;
+}
+
+class VideoFrameNode: public QSGGeometryNode
+{
+    public:
+        QSGGeometry m_geometry;
+        QRectF m_rect;
+
+        VideoFrameNode():
+            m_geometry(QSGGeometry::defaultAttributes_TexturedPoint2D(), 4)
+        {
+            this->setGeometry(&this->m_geometry);
+            this->setMaterial(new VideoFrameMaterial);
+            this->setFlag(OwnsMaterial, true);
+        }
+
+        VideoFrameMaterial *videoMaterial() const
+        {
+            return static_cast<VideoFrameMaterial *>(this->material());
+        }
+
+        void setRect(const QRectF &rect)
+        {
+            if (this->m_rect == rect)
+                return;
+
+            QSGGeometry::updateTexturedRectGeometry(&this->m_geometry,
+                                                    rect,
+                                                    QRectF(0.0, 0.0,
+                                                           1.0, 1.0));
+            this->m_rect = rect;
+            this->markDirty(DirtyGeometry);
+        }
+};
+
 class VideoDisplayPrivate
 {
     public:
-        QImage m_frame;
+        AkPacket m_packet;
         QMutex m_mutex;
         bool m_fillDisplay;
+        bool m_glNode;
+        bool m_displaying;
+        bool m_frameDirty;
+        bool m_updatePending;
+        int m_maxFps;
+        QElapsedTimer m_clock;
+        qint64 m_lastUpdate;
+        quint64 m_frameId;
+        quint64 m_renderedFrameId;
 
         VideoDisplayPrivate():
-            m_fillDisplay(false)
+            m_fillDisplay(false),
+            m_glNode(false),
+            m_displaying(false),
+            m_frameDirty(false),
+            m_updatePending(false),
+            m_maxFps(0),
+            m_lastUpdate(0),
+            m_frameId(0),
+            m_renderedFrameId(0)
         {
+            this->m_clock.start();
         }
 };
 
@@ -54,23 +396,93 @@ bool VideoDisplay::fillDisplay() const
     return this->d->m_fillDisplay;
 }
 
+bool VideoDisplay::displaying() const
+{
+    QMutexLocker locker(&this->d->m_mutex);
+
+    return this->d->m_displaying;
+}
+
+int VideoDisplay::maxFps() const
+{
+    QMutexLocker locker(&this->d->m_mutex);
+
+    return this->d->m_maxFps;
+}
+
+QVariantList VideoDisplay::preferredPixelFormats() const
+{
+    // Keep in sync with VideoFrameMaterial::canUpload().
+    return {int(AkVideoCaps::Format_yuv420p),
+            int(AkVideoCaps::Format_nv12)};
+}
+
 QSGNode *VideoDisplay::updatePaintNode(QSGNode *oldNode,
                                        QQuickItem::UpdatePaintNodeData *updatePaintNodeData)
 {
     Q_UNUSED(updatePaintNodeData)
 
     this->d->m_mutex.lock();
+    auto packet = this->d->m_packet;
+    bool newFrame = this->d->m_frameId != this->d->m_renderedFrameId;
+    this->d->m_renderedFrameId = this->d->m_frameId;
+    this->d->m_updatePending = false;
+    this->d->m_mutex.unlock();
 
-    if (this->d->m_frame.isNull()) {
-        this->d->m_mutex.unlock();
+    AkVideoPacket videoPacket(packet);
 
-        return nullptr;
+    if (!videoPacket.caps())
+        return oldNode;
+
+    bool useGl = true;
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 8, 0)
+    useGl = this->window()->rendererInterface()->graphicsApi()
+            == QSGRendererInterface::OpenGL;
+#endif
+
+    if (useGl && VideoFrameMaterial::canUpload(videoPacket.caps())) {
+        VideoFrameNode *node = nullptr;
+
+        if (oldNode && this->d->m_glNode) {
+            node = static_cast<VideoFrameNode *>(oldNode);
+        } else {
+            if (oldNode)
+                delete oldNode;
+
+            node = new VideoFrameNode();
+        }
+
+        // Repaints triggered by geometry changes reuse the textures.
+        if (newFrame || node != oldNode) {
+            node->videoMaterial()->uploadFrame(videoPacket);
+            node->markDirty(QSGNode::DirtyMaterial);
+        }
+
+        if (this->d->m_fillDisplay) {
+            node->setRect(this->boundingRect());
+        } else {
+            QSizeF size(videoPacket.caps().width(),
+                        videoPacket.caps().height());
+            size.scale(this->boundingRect().size(), Qt::KeepAspectRatio);
+            QRectF rect(QPointF(), size);
+            rect.moveCenter(this->boundingRect().center());
+
+            node->setRect(rect);
+        }
+
+        this->d->m_glNode = true;
+
+        return node;
     }
 
-    auto frame = this->d->m_frame.format() == QImage::Format_ARGB32?
-                     this->d->m_frame.copy():
-                     this->d->m_frame.convertToFormat(QImage::Format_ARGB32);
-    this->d->m_mutex.unlock();
+    auto frame = AkUtils::packetToImage(packet);
+
+    if (frame.isNull())
+        return oldNode;
+
+    if (frame.format() != QImage::Format_ARGB32)
+        frame = frame.convertToFormat(QImage::Format_ARGB32);
 
 #if QT_VERSION >= QT_VERSION_CHECK(5, 8, 0)
     if (this->window()->rendererInterface()->graphicsApi() == QSGRendererInterface::Software) {
@@ -93,15 +505,21 @@ QSGNode *VideoDisplay::updatePaintNode(QSGNode *oldNode,
         if (videoFrame)
             delete videoFrame;
 
+        this->d->m_glNode = false;
+
         return nullptr;
     }
 
     QSGSimpleTextureNode *node = nullptr;
 
-    if (oldNode)
+    if (oldNode && !this->d->m_glNode) {
         node = static_cast<QSGSimpleTextureNode *>(oldNode);
-    else
+    } else {
+        if (oldNode)
+            delete oldNode;
+
         node = new QSGSimpleTextureNode();
+    }
 
     node->setOwnsTexture(true);
     node->setFiltering(QSGTexture::Linear);
@@ -118,17 +536,76 @@ QSGNode *VideoDisplay::updatePaintNode(QSGNode *oldNode,
     }
 
     node->setTexture(videoFrame);
+    this->d->m_glNode = false;
 
     return node;
 }
 
+void VideoDisplay::itemChange(QQuickItem::ItemChange change,
+                              const QQuickItem::ItemChangeData &value)
+{
+    switch (change) {
+    case ItemSceneChange:
+        if (value.window)
+            QObject::connect(value.window,
+                             &QWindow::visibilityChanged,
+                             this,
+                             &VideoDisplay::updateDisplaying);
+
+        this->updateDisplaying();
+
+        break;
+
+    case ItemVisibleHasChanged:
+        this->updateDisplaying();
+
+        break;
+
+    default:
+        break;
+    }
+
+    QQuickItem::itemChange(change, value);
+}
+
 void VideoDisplay::iStream(const AkPacket &packet)
 {
+    /* While off screen, keep only the packet reference so the last frame
+     * shows up again the moment the item is back, but skip the conversion
+     * and upload nobody can see. */
     this->d->m_mutex.lock();
-    this->d->m_frame = AkUtils::packetToImage(packet);
+
+    /* Latest frame wins: the slot holds a single pending packet and
+     * replacing it releases the previous one right here, so a pipeline
+     * burst can't queue frames nobody will see. */
+    this->d->m_packet = packet;
+    this->d->m_frameId++;
+    bool schedule = this->d->m_displaying;
+
+    if (schedule && this->d->m_maxFps > 0) {
+        qint64 now = this->d->m_clock.elapsed();
+
+        if (now - this->d->m_lastUpdate < 1000 / this->d->m_maxFps)
+            schedule = false;
+        else
+            this->d->m_lastUpdate = now;
+    }
+
+    /* One scene graph update in flight at most, the render then paints
+     * whatever is the latest frame on the next refresh, so the preview
+     * stays at most one vsync behind the pipeline. */
+    if (schedule) {
+        if (this->d->m_updatePending)
+            schedule = false;
+        else
+            this->d->m_updatePending = true;
+    }
+
+    this->d->m_frameDirty = !this->d->m_displaying;
     this->d->m_mutex.unlock();
 
-    QMetaObject::invokeMethod(this, "update");
+    if (schedule)
+        QMetaObject::invokeMethod(this, "update");
 }
 
 void VideoDisplay::setFillDisplay(bool fillDisplay)
@@ -140,9 +617,57 @@ void VideoDisplay::setFillDisplay(bool fillDisplay)
     emit this->fillDisplayChanged();
 }
 
+void VideoDisplay::setMaxFps(int maxFps)
+{
+    this->d->m_mutex.lock();
+    bool changed = this->d->m_maxFps != maxFps;
+    this->d->m_maxFps = maxFps;
+    this->d->m_mutex.unlock();
+
+    if (changed)
+        emit this->maxFpsChanged(maxFps);
+}
+
 void VideoDisplay::resetFillDisplay()
 {
     this->setFillDisplay(false);
 }
 
+void VideoDisplay::resetMaxFps()
+{
+    this->setMaxFps(0);
+}
+
+void VideoDisplay::updateDisplaying()
+{
+    auto window = this->window();
+    bool displaying = this->isVisible()
+                      && window
+                      && window->visibility() != QWindow::Hidden
+                      && window->visibility() != QWindow::Minimized;
+
+    this->d->m_mutex.lock();
+    bool changed = this->d->m_displaying != displaying;
+    this->d->m_displaying = displaying;
+    bool redisplay = displaying && this->d->m_frameDirty;
+
+    if (redisplay) {
+        this->d->m_frameDirty = false;
+        this->d->m_updatePending = true;
+    }
+
+    // A pending update won't be painted off screen, don't let it block
+    // the first frame after the item is back.
+    if (!displaying)
+        this->d->m_updatePending = false;
+
+    this->d->m_mutex.unlock();
+
+    if (redisplay)
+        this->update();
+
+    if (changed)
+        emit this->displayingChanged(displaying);
+}
+
 #include "moc_videodisplay.cpp"
@@ -35,6 +35,14 @@ class VideoDisplay: public QQuickItem
                WRITE setFillDisplay
                RESET resetFillDisplay
                NOTIFY fillDisplayChanged)
+    Q_PROPERTY(bool displaying
+               READ displaying
+               NOTIFY displayingChanged)
+    Q_PROPERTY(int maxFps
+               READ maxFps
+               WRITE setMaxFps
+               RESET resetMaxFps
+               NOTIFY maxFpsChanged)
 
     public:
         VideoDisplay(QQuickItem *parent=nullptr);
@@ -42,20 +50,46 @@ class VideoDisplay: public QQuickItem
 
         Q_INVOKABLE bool fillDisplay() const;
 
+        /* True while the item and its window are both on screen. When it
+         * goes false, incoming frames are only retained, not converted or
+         * uploaded, and preview-only branches feeding this display can be
+         * paused from QML. */
+        Q_INVOKABLE bool displaying() const;
+
+        /* Upper bound on scene graph updates per second, 0 leaves the
+         * display at the source rate. Frames above the cap are retained
+         * but not converted or uploaded, so capping the preview saves the
+         * whole render cost of the skipped frames. */
+        Q_INVOKABLE int maxFps() const;
+
+        /* Pixel formats the display can draw without a CPU conversion, in
+         * preference order, as AkVideoCaps::PixelFormat ints. They mirror
+         * what the GL upload path accepts, so a source negotiated to one
+         * of them feeds the textures directly. */
+        Q_INVOKABLE QVariantList preferredPixelFormats() const;
+
     private:
         VideoDisplayPrivate *d;
 
     protected:
         QSGNode *updatePaintNode(QSGNode *oldNode,
                                  UpdatePaintNodeData *updatePaintNodeData);
+        void itemChange(ItemChange change, const ItemChangeData &value);
 
     signals:
         void fillDisplayChanged();
+        void displayingChanged(bool displaying);
+        void maxFpsChanged(int maxFps);
 
     public slots:
         void iStream(const AkPacket &packet);
         void setFillDisplay(bool fillDisplay);
+        void setMaxFps(int maxFps);
         void resetFillDisplay();
+        void resetMaxFps();
+
+    private slots:
+        void updateDisplaying();
 };
 
 #endif // VIDEODISPLAY_H
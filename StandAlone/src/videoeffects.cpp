@@ -18,15 +18,28 @@
  */
 
 #include <QMutex>
+#include <QThread>
+#include <QQueue>
+#include <QImage>
 #include <QSettings>
+#include <QElapsedTimer>
 #include <QQuickItem>
 #include <QQmlContext>
 #include <QQmlProperty>
 #include <QQmlApplicationEngine>
+#include <akutils.h>
+#include <akfrac.h>
 #include <akpacket.h>
+#include <akvideocaps.h>
 
 #include "videoeffects.h"
 
+/* A tracked frame older than this never left the chain: a retiming
+ * effect swallowed it. Its in-flight slot is reclaimed at the entry
+ * point so the pipelining window can't leak shut.
+ */
+#define STALE_FRAME_TIMEOUT 500
+
 class VideoEffectsPrivate
 {
     public:
@@ -34,16 +47,95 @@ class VideoEffectsPrivate
         QStringList m_availableEffects;
         AkElement::ElementState m_state;
         bool m_advancedMode;
+        bool m_pipelined;
+        bool m_overloadControl;
+        bool m_downscaled;
+        AkElement::QualityLevel m_quality;
+        qreal m_lagAvg;
         QList<AkElementPtr> m_effects;
         QStringList m_effectsId;
         AkElementPtr m_videoMux;
+        QHash<AkElement *, QThread *> m_threads;
+        QQueue<QPair<qint64, bool>> m_inFlightInfo;
+        QElapsedTimer m_clock;
+        QMutex m_flightMutex;
         QMutex m_mutex;
 
         VideoEffectsPrivate():
             m_engine(nullptr),
             m_state(AkElement::ElementStateNull),
-            m_advancedMode(false)
+            m_advancedMode(false),
+            m_pipelined(false),
+            m_overloadControl(false),
+            m_downscaled(false),
+            m_quality(AkElement::QualityFull),
+            m_lagAvg(0.0)
+        {
+            this->m_clock.start();
+        }
+
+        inline qreal framePeriod(const AkPacket &packet) const
+        {
+            auto fps = AkVideoCaps(packet.caps()).fps();
+
+            return fps.num() > 0? 1e3 * fps.den() / fps.num(): 33.0;
+        }
+
+        inline void trackFrame(bool downscaled)
+        {
+            QMutexLocker locker(&this->m_flightMutex);
+            this->m_inFlightInfo << qMakePair(this->m_clock.elapsed(),
+                                              downscaled);
+        }
+
+        inline void resetFlightStats()
+        {
+            QMutexLocker locker(&this->m_flightMutex);
+            this->m_inFlightInfo.clear();
+            this->m_lagAvg = 0.0;
+            this->m_downscaled = false;
+        }
+
+        inline Qt::ConnectionType linkType() const
         {
+            return this->m_pipelined?
+                        Qt::QueuedConnection: Qt::DirectConnection;
+        }
+
+        // In pipelined mode every effect runs its own event loop, so
+        // consecutive stages process consecutive frames concurrently.
+        inline void threadEffect(const AkElementPtr &effect)
+        {
+            if (!this->m_pipelined)
+                return;
+
+            auto thread = new QThread;
+            effect->moveToThread(thread);
+            thread->start();
+            this->m_threads[effect.data()] = thread;
+        }
+
+        inline void unthreadEffect(AkElement *effect)
+        {
+            auto thread = this->m_threads.take(effect);
+
+            if (!thread)
+                return;
+
+            thread->quit();
+            thread->wait();
+            delete thread;
+        }
+
+        inline void stopAllThreads()
+        {
+            for (auto thread: this->m_threads) {
+                thread->quit();
+                thread->wait();
+                delete thread;
+            }
+
+            this->m_threads.clear();
         }
 };
 
@@ -58,21 +150,30 @@ VideoEffects::VideoEffects(QQmlApplicationEngine *engine, QObject *parent):
         this->d->m_videoMux->setProperty("caps", "video/x-raw");
         this->d->m_videoMux->setProperty("outputIndex", 0);
 
+        // Frames leaving the chain pass through outputStream(), which
+        // accounts for them and undoes any temporary downscaling before
+        // re-emitting. Direct, so it runs in the emitting thread as the
+        // plain signal forward did.
         QObject::connect(this->d->m_videoMux.data(),
                          SIGNAL(oStream(const AkPacket &)),
                          this,
-                         SIGNAL(oStream(const AkPacket &)));
+                         SLOT(outputStream(const AkPacket &)),
+                         Qt::DirectConnection);
     }
 
     this->d->m_availableEffects = AkElement::listPlugins("VideoFilter");
 
+    // Read each description once instead of once per comparison.
+    QHash<QString, QString> descriptions;
+
+    for (const QString &pluginId: this->d->m_availableEffects)
+        descriptions[pluginId] = this->effectDescription(pluginId);
+
     std::sort(this->d->m_availableEffects.begin(),
               this->d->m_availableEffects.end(),
-              [this] (const QString &pluginId1, const QString &pluginId2) {
-        auto desc1 = this->effectDescription(pluginId1);
-        auto desc2 = this->effectDescription(pluginId2);
-
-        return desc1 < desc2;
+              [&descriptions] (const QString &pluginId1,
+                               const QString &pluginId2) {
+        return descriptions.value(pluginId1) < descriptions.value(pluginId2);
     });
 
     QObject::connect(this,
@@ -87,6 +188,14 @@ VideoEffects::VideoEffects(QQmlApplicationEngine *engine, QObject *parent):
                      &VideoEffects::advancedModeChanged,
                      this,
                      &VideoEffects::saveAdvancedMode);
+    QObject::connect(this,
+                     &VideoEffects::pipelinedChanged,
+                     this,
+                     &VideoEffects::savePipelined);
+    QObject::connect(this,
+                     &VideoEffects::overloadControlChanged,
+                     this,
+                     &VideoEffects::saveOverloadControl);
 
     this->loadProperties();
 }
@@ -95,6 +204,7 @@ VideoEffects::~VideoEffects()
 {
     this->saveProperties();
     this->setState(AkElement::ElementStateNull);
+    this->d->stopAllThreads();
     delete this->d;
 }
 
@@ -134,6 +244,36 @@ QString VideoEffects::effectDescription(const QString &effectId) const
                                           ["description"].toString();
 }
 
+QVariantList VideoEffects::effectsState() const
+{
+    QVariantList state;
+
+    for (const AkElementPtr &effect: this->d->m_effects) {
+        if (effect->property("preview").toBool())
+            continue;
+
+        QVariantMap properties;
+
+        for (int property = 0;
+             property < effect->metaObject()->propertyCount();
+             property++) {
+            auto metaProperty = effect->metaObject()->property(property);
+
+            if (metaProperty.isWritable()) {
+                auto propertyName = metaProperty.name();
+                properties[propertyName] = effect->property(propertyName);
+            }
+        }
+
+        QVariantMap entry;
+        entry["effect"] = effect->pluginId();
+        entry["properties"] = properties;
+        state << entry;
+    }
+
+    return state;
+}
+
 AkElement::ElementState VideoEffects::state() const
 {
     return this->d->m_state;
@@ -144,6 +284,21 @@ bool VideoEffects::advancedMode() const
     return this->d->m_advancedMode;
 }
 
+bool VideoEffects::pipelined() const
+{
+    return this->d->m_pipelined;
+}
+
+bool VideoEffects::overloadControl() const
+{
+    return this->d->m_overloadControl;
+}
+
+AkElement::QualityLevel VideoEffects::quality() const
+{
+    return this->d->m_quality;
+}
+
 bool VideoEffects::embedControls(const QString &where,
                                  int effectIndex,
                                  const QString &name) const
@@ -208,46 +363,119 @@ void VideoEffects::setEffects(const QStringList &effects, bool emitSignal)
     if (this->d->m_effectsId == effects)
         return;
 
-    auto state = this->state();
+    this->d->m_mutex.lock();
 
-    if (state != AkElement::ElementStateNull)
-        this->setState(AkElement::ElementStatePaused);
+    /* Update the chain incrementally: instances whose id survives the edit
+     * are reused, keeping their internal state and warmed caches, and only
+     * the links that actually change are rewired. The entry mutex keeps
+     * frames out while the links are swapped, so the chain never runs half
+     * rewired, and unchanged effects keep playing without a state bounce.
+     * Previews are dropped, as before. */
+    auto reusable = this->d->m_effects;
+    QList<AkElementPtr> newEffects;
+    QStringList curEffects;
 
-    this->d->m_mutex.lock();
+    for (const QString &effectId: effects) {
+        AkElementPtr effect;
 
-    if (!this->d->m_effects.isEmpty()) {
-        if (this->d->m_videoMux)
-            this->d->m_effects.last()->unlink(this->d->m_videoMux);
+        for (int i = 0; i < reusable.size(); i++)
+            if (reusable[i]->pluginId() == effectId
+                && !reusable[i]->property("preview").toBool()) {
+                effect = reusable.takeAt(i);
 
-        this->d->m_effects.clear();
-        this->d->m_effectsId.clear();
-    }
+                break;
+            }
 
-    QStringList curEffects;
-    AkElementPtr prevEffect;
+        if (!effect) {
+            effect = AkElement::create(effectId);
+
+            if (!effect)
+                continue;
+
+            this->d->threadEffect(effect);
+            effect->setState(this->d->m_state);
+            effect->setQuality(this->d->m_quality);
+        }
+
+        newEffects << effect;
+        curEffects << effectId;
+    }
 
-    for (const QString &effectId: effects)
-        if (auto effect = AkElement::create(effectId)) {
-            this->d->m_effects << effect;
-            this->d->m_effectsId << effectId;
-            curEffects << effectId;
+    auto chainLinks = [this] (const QList<AkElementPtr> &effects) {
+        QVector<QPair<AkElementPtr, AkElementPtr>> links;
+        AkElementPtr prevEffect;
 
+        for (const AkElementPtr &effect: effects) {
             if (prevEffect)
-                prevEffect->link(effect, Qt::DirectConnection);
-            else
-                prevEffect = effect;
+                links << qMakePair(prevEffect, effect);
+
+            prevEffect = effect;
         }
 
-    if (!this->d->m_effects.isEmpty() && this->d->m_videoMux)
-        this->d->m_effects.last()->link(this->d->m_videoMux, Qt::DirectConnection);
+        if (prevEffect && this->d->m_videoMux)
+            links << qMakePair(prevEffect, this->d->m_videoMux);
+
+        return links;
+    };
+
+    auto oldLinks = chainLinks(this->d->m_effects);
+    auto newLinks = chainLinks(newEffects);
 
+    for (const auto &link: oldLinks)
+        if (!newLinks.contains(link))
+            link.first->unlink(link.second);
+
+    for (const auto &link: newLinks)
+        if (!oldLinks.contains(link))
+            link.first->link(link.second, this->d->linkType());
+
+    // Whatever was not reused leaves the chain.
+    for (const AkElementPtr &effect: reusable)
+        this->d->unthreadEffect(effect.data());
+
+    this->d->m_effects = newEffects;
+    this->d->m_effectsId = curEffects;
+    this->d->resetFlightStats();
     this->d->m_mutex.unlock();
-    this->setState(state);
 
     if (emitSignal)
         emit this->effectsChanged(curEffects);
 }
 
+void VideoEffects::setEffectsState(const QVariantList &state)
+{
+    QStringList effects;
+
+    for (const QVariant &entry: state)
+        effects << entry.toMap().value("effect").toString();
+
+    this->setEffects(effects, false);
+
+    /* Apply the recorded parameter blocks in chain order. Entries whose
+     * plugin failed to load were skipped by setEffects, skip them here
+     * too. */
+    int i = 0;
+
+    for (const QVariant &entry: state) {
+        auto map = entry.toMap();
+
+        if (i >= this->d->m_effects.size())
+            break;
+
+        auto effect = this->d->m_effects[i];
+
+        if (effect->pluginId() != map.value("effect").toString())
+            continue;
+
+        auto properties = map.value("properties").toMap();
+
+        for (auto it = properties.begin(); it != properties.end(); it++)
+            effect->setProperty(it.key().toStdString().c_str(), it.value());
+
+        i++;
+    }
+}
+
 void VideoEffects::setState(AkElement::ElementState state)
 {
     if (this->d->m_state == state)
@@ -278,6 +506,73 @@ void VideoEffects::setAdvancedMode(bool advancedMode)
     emit this->advancedModeChanged(advancedMode);
 }
 
+void VideoEffects::setPipelined(bool pipelined)
+{
+    if (this->d->m_pipelined == pipelined)
+        return;
+
+    auto state = this->state();
+
+    if (state != AkElement::ElementStateNull)
+        this->setState(AkElement::ElementStatePaused);
+
+    this->d->m_mutex.lock();
+
+    // Effects can't be pulled back from their worker threads, so the chain
+    // is rebuilt with fresh instances, carrying the properties over.
+    QList<AkElementPtr> effects;
+
+    for (const AkElementPtr &oldEffect: this->d->m_effects) {
+        auto effect = AkElement::create(oldEffect->pluginId());
+
+        if (!effect)
+            continue;
+
+        for (int property = 0;
+             property < oldEffect->metaObject()->propertyCount();
+             property++) {
+            auto metaProperty = oldEffect->metaObject()->property(property);
+
+            if (metaProperty.isWritable()) {
+                auto propertyName = metaProperty.name();
+                effect->setProperty(propertyName,
+                                    oldEffect->property(propertyName));
+            }
+        }
+
+        effects << effect;
+    }
+
+    if (!this->d->m_effects.isEmpty() && this->d->m_videoMux)
+        this->d->m_effects.last()->unlink(this->d->m_videoMux);
+
+    this->d->stopAllThreads();
+    this->d->m_effects.clear();
+    this->d->m_pipelined = pipelined;
+
+    AkElementPtr prevEffect;
+
+    for (const AkElementPtr &effect: effects) {
+        this->d->m_effects << effect;
+        this->d->threadEffect(effect);
+
+        if (prevEffect)
+            prevEffect->link(effect, this->d->linkType());
+
+        prevEffect = effect;
+    }
+
+    if (!this->d->m_effects.isEmpty() && this->d->m_videoMux)
+        this->d->m_effects.last()->link(this->d->m_videoMux,
+                                        this->d->linkType());
+
+    this->d->resetFlightStats();
+    this->d->m_mutex.unlock();
+
+    this->setState(state);
+    emit this->pipelinedChanged(pipelined);
+}
+
 void VideoEffects::resetEffects()
 {
     this->setEffects({});
@@ -293,6 +588,64 @@ void VideoEffects::resetAdvancedMode()
     this->setAdvancedMode(false);
 }
 
+void VideoEffects::resetPipelined()
+{
+    this->setPipelined(false);
+}
+
+void VideoEffects::setOverloadControl(bool overloadControl)
+{
+    if (this->d->m_overloadControl == overloadControl)
+        return;
+
+    this->d->m_overloadControl = overloadControl;
+
+    if (!overloadControl) {
+        this->d->m_flightMutex.lock();
+
+        // In pipelined mode the queue also accounts the in-flight
+        // window, so it keeps running; only the regulator state resets.
+        if (!this->d->m_pipelined)
+            this->d->m_inFlightInfo.clear();
+
+        this->d->m_lagAvg = 0.0;
+        this->d->m_downscaled = false;
+        this->d->m_flightMutex.unlock();
+    }
+
+    emit this->overloadControlChanged(overloadControl);
+}
+
+void VideoEffects::resetOverloadControl()
+{
+    this->setOverloadControl(false);
+}
+
+void VideoEffects::setQuality(AkElement::QualityLevel quality)
+{
+    if (this->d->m_quality == quality)
+        return;
+
+    this->d->m_quality = quality;
+
+    /* Quality aware effects switch to a cheaper approximation, the rest
+     * just keep rendering at full quality. Effects joining the chain
+     * later pick the current level up on creation. */
+    this->d->m_mutex.lock();
+
+    for (const AkElementPtr &effect: this->d->m_effects)
+        effect->setQuality(quality);
+
+    this->d->m_mutex.unlock();
+
+    emit this->qualityChanged(quality);
+}
+
+void VideoEffects::resetQuality()
+{
+    this->setQuality(AkElement::QualityFull);
+}
+
 AkElementPtr VideoEffects::appendEffect(const QString &effectId, bool preview)
 {
     auto effect = AkElement::create(effectId);
@@ -303,6 +656,8 @@ AkElementPtr VideoEffects::appendEffect(const QString &effectId, bool preview)
     if (preview)
         effect->setProperty("preview", preview);
 
+    effect->setQuality(this->d->m_quality);
+
     auto state = this->state();
 
     if (state != AkElement::ElementStateNull)
@@ -310,17 +665,19 @@ AkElementPtr VideoEffects::appendEffect(const QString &effectId, bool preview)
 
     this->d->m_mutex.lock();
 
+    this->d->threadEffect(effect);
+
     if (!this->d->m_effects.isEmpty()) {
         auto prevEffect = this->d->m_effects.last();
 
         if (this->d->m_videoMux)
             prevEffect->unlink(this->d->m_videoMux);
 
-        prevEffect->link(effect, Qt::DirectConnection);
+        prevEffect->link(effect, this->d->linkType());
     }
 
     if (this->d->m_videoMux)
-        effect->link(this->d->m_videoMux, Qt::DirectConnection);
+        effect->link(this->d->m_videoMux, this->d->linkType());
 
     this->d->m_effects << effect;
 
@@ -389,7 +746,7 @@ void VideoEffects::moveEffect(int from, int to)
 
     if (prev) {
         prev->unlink(effect);
-        prev->link(next, Qt::DirectConnection);
+        prev->link(next, this->d->linkType());
     }
 
     effect->unlink(next);
@@ -403,10 +760,10 @@ void VideoEffects::moveEffect(int from, int to)
 
     if (prev) {
         prev->unlink(next);
-        prev->link(effect, Qt::DirectConnection);
+        prev->link(effect, this->d->linkType());
     }
 
-    effect->link(next, Qt::DirectConnection);
+    effect->link(next, this->d->linkType());
 
     // Move the effect in the list.
     this->d->m_effects.move(from, to);
@@ -441,9 +798,10 @@ void VideoEffects::removeEffect(int index)
 
         if (prev) {
             prev->unlink(effect);
-            prev->link(next, Qt::DirectConnection);
+            prev->link(next, this->d->linkType());
         }
 
+        this->d->unthreadEffect(effect.data());
         this->d->m_effects.removeAt(index);
         this->d->m_effectsId.removeAt(index);
     }
@@ -489,10 +847,11 @@ void VideoEffects::removeAllPreviews()
 
             if (prev) {
                 prev->unlink(effect);
-                prev->link(next, Qt::DirectConnection);
+                prev->link(next, this->d->linkType());
             }
 
             effect->unlink(next);
+            this->d->unthreadEffect(effect.data());
             this->d->m_effects.removeAt(i);
             i--;
         }
@@ -527,8 +886,112 @@ AkPacket VideoEffects::iStream(const AkPacket &packet)
         if (this->d->m_effects.isEmpty()) {
             if (this->d->m_videoMux)
                 (*this->d->m_videoMux)(packet);
-        } else
-            (*this->d->m_effects.first())(packet);
+
+            this->d->m_mutex.unlock();
+
+            return AkPacket();
+        }
+
+        /* With 5 ms audio periods, hundreds of audio packets per second
+         * would pay delivery plus a caps rejection in the first effect,
+         * and in pipelined mode each would consume an in-flight slot it
+         * never releases. Only video enters the chain. */
+        if (packet.caps().mimeType() != "video/x-raw") {
+            this->d->m_mutex.unlock();
+
+            return AkPacket();
+        }
+
+        AkPacket inPacket = packet;
+        bool track = false;
+        bool downscaled = false;
+
+        if (this->d->m_overloadControl) {
+            qreal period = this->d->framePeriod(packet);
+
+            this->d->m_flightMutex.lock();
+            qreal lagAvg = this->d->m_lagAvg;
+
+            /* Over two frame periods of lag the chain is hopelessly
+             * behind, drop at the entry point. Decaying the average here
+             * lets the regulator recover once the backlog drains.
+             */
+            if (lagAvg > 2.0 * period) {
+                this->d->m_lagAvg = 0.9 * lagAvg;
+                this->d->m_flightMutex.unlock();
+                this->d->m_mutex.unlock();
+
+                return AkPacket();
+            }
+
+            this->d->m_flightMutex.unlock();
+
+            // Step the resolution down at 1.5 periods of lag and back up
+            // below 0.75; the gap avoids oscillating between the two.
+            if (lagAvg > 1.5 * period)
+                this->d->m_downscaled = true;
+            else if (lagAvg < 0.75 * period)
+                this->d->m_downscaled = false;
+
+            if (this->d->m_downscaled) {
+                auto frame = AkUtils::packetToImage(packet);
+
+                if (!frame.isNull()) {
+                    frame = frame.scaled(frame.width() / 2,
+                                         frame.height() / 2,
+                                         Qt::IgnoreAspectRatio,
+                                         Qt::FastTransformation);
+                    inPacket = AkUtils::imageToPacket(frame, packet);
+                    downscaled = true;
+                }
+            }
+
+            track = true;
+        }
+
+        if (!this->d->m_pipelined) {
+            if (track)
+                this->d->trackFrame(downscaled);
+
+            (*this->d->m_effects.first())(inPacket);
+        } else {
+            /* Keep at most chain depth + 2 frames in flight. Beyond that
+             * every stage is already busy and queueing more frames would
+             * only add latency, so the excess is dropped here at the
+             * entry point.
+             *
+             * The tracking queue itself is the window accounting: one
+             * entry per admitted frame, one dequeue per frame leaving
+             * the chain. A plain counter can't survive retiming effects
+             * like FpsConvert, which drop and duplicate frames by
+             * design: entries older than the timeout belong to frames
+             * swallowed inside the chain and give their slots back
+             * here, and a duplicated output finds the queue empty and
+             * leaves the count alone instead of driving it negative.
+             */
+            int maxInFlight = this->d->m_effects.size() + 2;
+
+            this->d->m_flightMutex.lock();
+            auto now = this->d->m_clock.elapsed();
+
+            while (!this->d->m_inFlightInfo.isEmpty()
+                   && now - this->d->m_inFlightInfo.head().first
+                      > STALE_FRAME_TIMEOUT)
+                this->d->m_inFlightInfo.dequeue();
+
+            bool admitted = this->d->m_inFlightInfo.size() < maxInFlight;
+
+            if (admitted)
+                this->d->m_inFlightInfo << qMakePair(now, downscaled);
+
+            this->d->m_flightMutex.unlock();
+
+            if (admitted)
+                QMetaObject::invokeMethod(this->d->m_effects.first().data(),
+                                          "iStream",
+                                          Qt::QueuedConnection,
+                                          Q_ARG(AkPacket, inPacket));
+        }
     }
 
     this->d->m_mutex.unlock();
@@ -547,6 +1010,41 @@ void VideoEffects::setQmlEngine(QQmlApplicationEngine *engine)
         engine->rootContext()->setContextProperty("VideoEffects", this);
 }
 
+void VideoEffects::outputStream(const AkPacket &packet)
+{
+    bool downscaled = false;
+
+    this->d->m_flightMutex.lock();
+
+    if (!this->d->m_inFlightInfo.isEmpty()) {
+        auto info = this->d->m_inFlightInfo.dequeue();
+        qreal lag = qreal(this->d->m_clock.elapsed() - info.first);
+
+        // Smooth over roughly 16 frames so a single slow frame doesn't
+        // trigger the regulator.
+        this->d->m_lagAvg += (lag - this->d->m_lagAvg) / 16.0;
+        downscaled = info.second;
+    }
+
+    this->d->m_flightMutex.unlock();
+
+    if (downscaled) {
+        auto frame = AkUtils::packetToImage(packet);
+
+        if (!frame.isNull()) {
+            frame = frame.scaled(2 * frame.width(),
+                                 2 * frame.height(),
+                                 Qt::IgnoreAspectRatio,
+                                 Qt::FastTransformation);
+            emit this->oStream(AkUtils::imageToPacket(frame, packet));
+
+            return;
+        }
+    }
+
+    emit this->oStream(packet);
+}
+
 void VideoEffects::advancedModeUpdated(bool advancedMode)
 {
     if (advancedMode || this->d->m_effects.size() < 1)
@@ -561,6 +1059,11 @@ void VideoEffects::advancedModeUpdated(bool advancedMode)
         this->setState(AkElement::ElementStatePaused);
 
     this->d->m_mutex.lock();
+
+    for (AkElementPtr &droppedEffect: this->d->m_effects)
+        if (droppedEffect != effect)
+            this->d->unthreadEffect(droppedEffect.data());
+
     this->d->m_effects = {effect};
     this->d->m_effectsId = QStringList {effect->pluginId()};
     this->d->m_mutex.unlock();
@@ -575,6 +1078,8 @@ void VideoEffects::loadProperties()
 
     config.beginGroup("VideoEffects");
     this->setAdvancedMode(config.value("advancedMode").toBool());
+    this->setPipelined(config.value("pipelined").toBool());
+    this->setOverloadControl(config.value("overloadControl").toBool());
 
     int size = config.beginReadArray("effects");
     QStringList effects;
@@ -647,12 +1152,32 @@ void VideoEffects::saveAdvancedMode(bool advancedMode)
     config.endGroup();
 }
 
+void VideoEffects::savePipelined(bool pipelined)
+{
+    QSettings config;
+
+    config.beginGroup("VideoEffects");
+    config.setValue("pipelined", pipelined);
+    config.endGroup();
+}
+
+void VideoEffects::saveOverloadControl(bool overloadControl)
+{
+    QSettings config;
+
+    config.beginGroup("VideoEffects");
+    config.setValue("overloadControl", overloadControl);
+    config.endGroup();
+}
+
 void VideoEffects::saveProperties()
 {
     QSettings config;
 
     config.beginGroup("VideoEffects");
     config.setValue("advancedMode", this->advancedMode());
+    config.setValue("pipelined", this->pipelined());
+    config.setValue("overloadControl", this->overloadControl());
 
     config.beginWriteArray("effects");
 
@@ -49,6 +49,16 @@ class VideoEffects: public QObject
                WRITE setAdvancedMode
                RESET resetAdvancedMode
                NOTIFY advancedModeChanged)
+    Q_PROPERTY(bool pipelined
+               READ pipelined
+               WRITE setPipelined
+               RESET resetPipelined
+               NOTIFY pipelinedChanged)
+    Q_PROPERTY(bool overloadControl
+               READ overloadControl
+               WRITE setOverloadControl
+               RESET resetOverloadControl
+               NOTIFY overloadControlChanged)
 
     public:
         explicit VideoEffects(QQmlApplicationEngine *engine=nullptr,
@@ -61,6 +71,14 @@ class VideoEffects: public QObject
         Q_INVOKABLE QString effectDescription(const QString &effectId) const;
         Q_INVOKABLE AkElement::ElementState state() const;
         Q_INVOKABLE bool advancedMode() const;
+        Q_INVOKABLE bool pipelined() const;
+        Q_INVOKABLE bool overloadControl() const;
+        /* Quality level every effect in the chain runs at, see
+         * AkElement::QualityLevel. */
+        Q_INVOKABLE AkElement::QualityLevel quality() const;
+        /* Session snapshot support: the non-preview chain with every
+         * effect's writable properties, ready to be replayed. */
+        Q_INVOKABLE QVariantList effectsState() const;
         Q_INVOKABLE bool embedControls(const QString &where,
                                        int effectIndex,
                                        const QString &name="") const;
@@ -75,14 +93,24 @@ class VideoEffects: public QObject
         void oStream(const AkPacket &packet);
         void stateChanged(AkElement::ElementState state);
         void advancedModeChanged(bool advancedMode);
+        void pipelinedChanged(bool pipelined);
+        void overloadControlChanged(bool overloadControl);
+        void qualityChanged(AkElement::QualityLevel quality);
 
     public slots:
         void setEffects(const QStringList &effects, bool emitSignal=true);
+        void setEffectsState(const QVariantList &state);
         void setState(AkElement::ElementState state);
         void setAdvancedMode(bool advancedMode);
+        void setPipelined(bool pipelined);
+        void setOverloadControl(bool overloadControl);
+        void setQuality(AkElement::QualityLevel quality);
         void resetEffects();
         void resetState();
         void resetAdvancedMode();
+        void resetPipelined();
+        void resetOverloadControl();
+        void resetQuality();
         AkElementPtr appendEffect(const QString &effectId, bool preview=false);
         void showPreview(const QString &effectId);
         void setAsPreview(int index, bool preview=false);
@@ -95,9 +123,12 @@ class VideoEffects: public QObject
 
     private slots:
         void advancedModeUpdated(bool advancedMode);
+        void outputStream(const AkPacket &packet);
         void loadProperties();
         void saveEffects(const QStringList &effects);
         void saveAdvancedMode(bool advancedMode);
+        void savePipelined(bool pipelined);
+        void saveOverloadControl(bool overloadControl);
         void saveProperties();
 };
 
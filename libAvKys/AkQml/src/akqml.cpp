@@ -171,4 +171,30 @@ QVariant AkQml::varCaps(AkCaps *caps) const
     return QVariant::fromValue(*caps);
 }
 
+qreal AkQml::fracValue(const QVariant &frac) const
+{
+    if (frac.canConvert<AkFrac>())
+        return frac.value<AkFrac>().value();
+
+    return AkFrac(frac.toString()).value();
+}
+
+QString AkQml::fracString(qint64 num, qint64 den) const
+{
+    return AkFrac(num, den).toString();
+}
+
+QVariantMap AkQml::capsMap(const QVariant &caps) const
+{
+    if (caps.canConvert<AkCaps>())
+        return caps.value<AkCaps>().toMap();
+
+    return AkCaps(caps.toString()).toMap();
+}
+
+QString AkQml::capsString(const QVariantMap &caps) const
+{
+    return AkCaps(caps).toString();
+}
+
 #include "moc_akqml.cpp"
@@ -72,6 +72,15 @@ class AkQml: public QQuickItem
 
         Q_INVOKABLE QVariant varCaps(QObject *caps) const;
         Q_INVOKABLE QVariant varCaps(AkCaps *caps) const;
+
+        /* Typed accessors. These return the requested value directly,
+         * without allocating a wrapper object per binding evaluation
+         * like the new* factories do. Prefer them in bindings that
+         * re-evaluate often. */
+        Q_INVOKABLE qreal fracValue(const QVariant &frac) const;
+        Q_INVOKABLE QString fracString(qint64 num, qint64 den) const;
+        Q_INVOKABLE QVariantMap capsMap(const QVariant &caps) const;
+        Q_INVOKABLE QString capsString(const QVariantMap &caps) const;
 };
 
 #endif // AKQML_H
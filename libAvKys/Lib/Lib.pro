@@ -36,15 +36,36 @@ DEFINES += \
 
 HEADERS = \
     src/ak.h \
+    src/akbuffer.h \
+    src/akbufferpool.h \
+    src/akframeclock.h \
+    src/aklog.h \
+    src/akmemorybudget.h \
+    src/akmetrics.h \
+    src/akthreadpriority.h \
+    src/aktrace.h \
+    src/akwatchdog.h \
     src/akutils.h \
     src/akcaps.h \
+    src/akclocksync.h \
+    src/akcolorlut.h \
+    src/akdisplacementmap.h \
+    src/akframering.h \
     src/akcommons.h \
     src/akelement.h \
+    src/akelementworker.h \
     src/akfrac.h \
     src/akpacket.h \
+    src/akpacketstream.h \
     src/akplugin.h \
+    src/akremoteelement.h \
+    src/akshmchannel.h \
     src/akmultimediasourceelement.h \
     src/akvideocaps.h \
+    src/akvideoconvert.h \
+    src/akvideofilterrunner.h \
+    src/akvideoshaderchain.h \
+    src/akvideokernel.h \
     src/akaudiocaps.h \
     src/akvideopacket.h \
     src/akaudiopacket.h
@@ -53,14 +74,35 @@ QT += qml
 
 SOURCES = \
     src/ak.cpp \
+    src/akbuffer.cpp \
+    src/akbufferpool.cpp \
+    src/akframeclock.cpp \
+    src/aklog.cpp \
+    src/akmemorybudget.cpp \
+    src/akmetrics.cpp \
+    src/akthreadpriority.cpp \
+    src/aktrace.cpp \
+    src/akwatchdog.cpp \
     src/akutils.cpp \
     src/akcaps.cpp \
+    src/akclocksync.cpp \
+    src/akcolorlut.cpp \
+    src/akdisplacementmap.cpp \
+    src/akframering.cpp \
     src/akelement.cpp \
+    src/akelementworker.cpp \
     src/akfrac.cpp \
     src/akpacket.cpp \
+    src/akpacketstream.cpp \
     src/akplugin.cpp \
+    src/akremoteelement.cpp \
+    src/akshmchannel.cpp \
     src/akmultimediasourceelement.cpp \
     src/akvideocaps.cpp \
+    src/akvideoconvert.cpp \
+    src/akvideofilterrunner.cpp \
+    src/akvideoshaderchain.cpp \
+    src/akvideokernel.cpp \
     src/akaudiocaps.cpp \
     src/akvideopacket.cpp \
     src/akaudiopacket.cpp
@@ -28,6 +28,7 @@
 #endif
 
 #include "ak.h"
+#include "akbuffer.h"
 #include "akcaps.h"
 #include "akelement.h"
 #include "akaudiocaps.h"
@@ -66,9 +67,12 @@ class AkPrivate
             qRegisterMetaType<AkVideoCaps::PixelFormat>("PixelFormat");
             qRegisterMetaType<AkElement::ElementState>("AkElement::ElementState");
             qRegisterMetaType<AkElement::ElementState>("ElementState");
+            qRegisterMetaType<AkElement::QualityLevel>("AkElement::QualityLevel");
+            qRegisterMetaType<AkElement::QualityLevel>("QualityLevel");
             qRegisterMetaTypeStreamOperators<AkElement::ElementState>("AkElement::ElementState");
             qRegisterMetaType<AkFrac>("AkFrac");
             qRegisterMetaTypeStreamOperators<AkFrac>("AkFrac");
+            qRegisterMetaType<AkBuffer>("AkBuffer");
             qRegisterMetaType<AkPacket>("AkPacket");
             qRegisterMetaType<AkElementPtr>("AkElementPtr");
 
@@ -34,170 +34,185 @@ class SampleFormats
         int endianness;
         bool planar;
 
-        static inline const QVector<SampleFormats> &formats()
-        {
-            static const QVector<SampleFormats> sampleFormats = {
-                {AkAudioCaps::SampleFormat_none , AkAudioCaps::SampleType_unknown,  0, Q_BYTE_ORDER   , false},
-                {AkAudioCaps::SampleFormat_s8   , AkAudioCaps::SampleType_int    ,  8, Q_BYTE_ORDER   , false},
-                {AkAudioCaps::SampleFormat_u8   , AkAudioCaps::SampleType_uint   ,  8, Q_BYTE_ORDER   , false},
-                {AkAudioCaps::SampleFormat_s16  , AkAudioCaps::SampleType_int    , 16, Q_BYTE_ORDER   , false},
-                {AkAudioCaps::SampleFormat_s16le, AkAudioCaps::SampleType_int    , 16, Q_LITTLE_ENDIAN, false},
-                {AkAudioCaps::SampleFormat_s16be, AkAudioCaps::SampleType_int    , 16, Q_BIG_ENDIAN   , false},
-                {AkAudioCaps::SampleFormat_u16  , AkAudioCaps::SampleType_uint   , 16, Q_BYTE_ORDER   , false},
-                {AkAudioCaps::SampleFormat_u16le, AkAudioCaps::SampleType_uint   , 16, Q_LITTLE_ENDIAN, false},
-                {AkAudioCaps::SampleFormat_u16be, AkAudioCaps::SampleType_uint   , 16, Q_BIG_ENDIAN   , false},
-                {AkAudioCaps::SampleFormat_s24  , AkAudioCaps::SampleType_int    , 24, Q_BYTE_ORDER   , false},
-                {AkAudioCaps::SampleFormat_s24le, AkAudioCaps::SampleType_int    , 24, Q_LITTLE_ENDIAN, false},
-                {AkAudioCaps::SampleFormat_s24be, AkAudioCaps::SampleType_int    , 24, Q_BIG_ENDIAN   , false},
-                {AkAudioCaps::SampleFormat_u24  , AkAudioCaps::SampleType_uint   , 24, Q_BYTE_ORDER   , false},
-                {AkAudioCaps::SampleFormat_u24le, AkAudioCaps::SampleType_uint   , 24, Q_LITTLE_ENDIAN, false},
-                {AkAudioCaps::SampleFormat_u24be, AkAudioCaps::SampleType_uint   , 24, Q_BIG_ENDIAN   , false},
-                {AkAudioCaps::SampleFormat_s32  , AkAudioCaps::SampleType_int    , 32, Q_BYTE_ORDER   , false},
-                {AkAudioCaps::SampleFormat_s32le, AkAudioCaps::SampleType_int    , 32, Q_LITTLE_ENDIAN, false},
-                {AkAudioCaps::SampleFormat_s32be, AkAudioCaps::SampleType_int    , 32, Q_BIG_ENDIAN   , false},
-                {AkAudioCaps::SampleFormat_u32  , AkAudioCaps::SampleType_uint   , 32, Q_BYTE_ORDER   , false},
-                {AkAudioCaps::SampleFormat_u32le, AkAudioCaps::SampleType_uint   , 32, Q_LITTLE_ENDIAN, false},
-                {AkAudioCaps::SampleFormat_u32be, AkAudioCaps::SampleType_uint   , 32, Q_BIG_ENDIAN   , false},
-                {AkAudioCaps::SampleFormat_s64  , AkAudioCaps::SampleType_int    , 64, Q_BYTE_ORDER   , false},
-                {AkAudioCaps::SampleFormat_s64le, AkAudioCaps::SampleType_int    , 64, Q_LITTLE_ENDIAN, false},
-                {AkAudioCaps::SampleFormat_s64be, AkAudioCaps::SampleType_int    , 64, Q_BIG_ENDIAN   , false},
-                {AkAudioCaps::SampleFormat_u64  , AkAudioCaps::SampleType_uint   , 64, Q_BYTE_ORDER   , false},
-                {AkAudioCaps::SampleFormat_u64le, AkAudioCaps::SampleType_uint   , 64, Q_LITTLE_ENDIAN, false},
-                {AkAudioCaps::SampleFormat_u64be, AkAudioCaps::SampleType_uint   , 64, Q_BIG_ENDIAN   , false},
-                {AkAudioCaps::SampleFormat_flt  , AkAudioCaps::SampleType_float  , 32, Q_BYTE_ORDER   , false},
-                {AkAudioCaps::SampleFormat_fltle, AkAudioCaps::SampleType_float  , 32, Q_LITTLE_ENDIAN, false},
-                {AkAudioCaps::SampleFormat_fltbe, AkAudioCaps::SampleType_float  , 32, Q_BIG_ENDIAN   , false},
-                {AkAudioCaps::SampleFormat_dbl  , AkAudioCaps::SampleType_float  , 64, Q_BYTE_ORDER   , false},
-                {AkAudioCaps::SampleFormat_dblle, AkAudioCaps::SampleType_float  , 64, Q_LITTLE_ENDIAN, false},
-                {AkAudioCaps::SampleFormat_dblbe, AkAudioCaps::SampleType_float  , 64, Q_BIG_ENDIAN   , false},
-                {AkAudioCaps::SampleFormat_u8p  , AkAudioCaps::SampleType_uint   ,  8, Q_BYTE_ORDER   ,  true},
-                {AkAudioCaps::SampleFormat_s16p , AkAudioCaps::SampleType_int    , 16, Q_BYTE_ORDER   ,  true},
-                {AkAudioCaps::SampleFormat_s32p , AkAudioCaps::SampleType_int    , 32, Q_BYTE_ORDER   ,  true},
-                {AkAudioCaps::SampleFormat_s64p , AkAudioCaps::SampleType_int    , 64, Q_BYTE_ORDER   ,  true},
-                {AkAudioCaps::SampleFormat_fltp , AkAudioCaps::SampleType_float  , 32, Q_BYTE_ORDER   ,  true},
-                {AkAudioCaps::SampleFormat_dblp , AkAudioCaps::SampleType_float  , 64, Q_BYTE_ORDER   ,  true},
-            };
-
-            return sampleFormats;
-        }
+        static inline const SampleFormats *byFormat(AkAudioCaps::SampleFormat format);
+        static inline const SampleFormats *byType(AkAudioCaps::SampleType type);
+        static inline const SampleFormats *byBps(int bps);
+        static inline const SampleFormats *byEndianness(int endianness);
+        static inline const SampleFormats *byPlanar(bool planar);
+};
 
-        static inline const SampleFormats *byFormat(AkAudioCaps::SampleFormat format)
-        {
-            for (int i = 0; i < formats().size(); i++)
-                if (formats()[i].format == format)
-                    return &formats()[i];
+/* One row per sample format, in enumeration order with SampleFormat_none
+ * first, so the per packet property queries (bps, planar-ness, sample type)
+ * resolve with a plain array load instead of walking a runtime container.
+ */
+static const SampleFormats akAudioCapsFormats[] = {
+    {AkAudioCaps::SampleFormat_none , AkAudioCaps::SampleType_unknown,  0, Q_BYTE_ORDER   , false},
+    {AkAudioCaps::SampleFormat_s8   , AkAudioCaps::SampleType_int    ,  8, Q_BYTE_ORDER   , false},
+    {AkAudioCaps::SampleFormat_u8   , AkAudioCaps::SampleType_uint   ,  8, Q_BYTE_ORDER   , false},
+    {AkAudioCaps::SampleFormat_s16  , AkAudioCaps::SampleType_int    , 16, Q_BYTE_ORDER   , false},
+    {AkAudioCaps::SampleFormat_s16le, AkAudioCaps::SampleType_int    , 16, Q_LITTLE_ENDIAN, false},
+    {AkAudioCaps::SampleFormat_s16be, AkAudioCaps::SampleType_int    , 16, Q_BIG_ENDIAN   , false},
+    {AkAudioCaps::SampleFormat_u16  , AkAudioCaps::SampleType_uint   , 16, Q_BYTE_ORDER   , false},
+    {AkAudioCaps::SampleFormat_u16le, AkAudioCaps::SampleType_uint   , 16, Q_LITTLE_ENDIAN, false},
+    {AkAudioCaps::SampleFormat_u16be, AkAudioCaps::SampleType_uint   , 16, Q_BIG_ENDIAN   , false},
+    {AkAudioCaps::SampleFormat_s24  , AkAudioCaps::SampleType_int    , 24, Q_BYTE_ORDER   , false},
+    {AkAudioCaps::SampleFormat_s24le, AkAudioCaps::SampleType_int    , 24, Q_LITTLE_ENDIAN, false},
+    {AkAudioCaps::SampleFormat_s24be, AkAudioCaps::SampleType_int    , 24, Q_BIG_ENDIAN   , false},
+    {AkAudioCaps::SampleFormat_u24  , AkAudioCaps::SampleType_uint   , 24, Q_BYTE_ORDER   , false},
+    {AkAudioCaps::SampleFormat_u24le, AkAudioCaps::SampleType_uint   , 24, Q_LITTLE_ENDIAN, false},
+    {AkAudioCaps::SampleFormat_u24be, AkAudioCaps::SampleType_uint   , 24, Q_BIG_ENDIAN   , false},
+    {AkAudioCaps::SampleFormat_s32  , AkAudioCaps::SampleType_int    , 32, Q_BYTE_ORDER   , false},
+    {AkAudioCaps::SampleFormat_s32le, AkAudioCaps::SampleType_int    , 32, Q_LITTLE_ENDIAN, false},
+    {AkAudioCaps::SampleFormat_s32be, AkAudioCaps::SampleType_int    , 32, Q_BIG_ENDIAN   , false},
+    {AkAudioCaps::SampleFormat_u32  , AkAudioCaps::SampleType_uint   , 32, Q_BYTE_ORDER   , false},
+    {AkAudioCaps::SampleFormat_u32le, AkAudioCaps::SampleType_uint   , 32, Q_LITTLE_ENDIAN, false},
+    {AkAudioCaps::SampleFormat_u32be, AkAudioCaps::SampleType_uint   , 32, Q_BIG_ENDIAN   , false},
+    {AkAudioCaps::SampleFormat_s64  , AkAudioCaps::SampleType_int    , 64, Q_BYTE_ORDER   , false},
+    {AkAudioCaps::SampleFormat_s64le, AkAudioCaps::SampleType_int    , 64, Q_LITTLE_ENDIAN, false},
+    {AkAudioCaps::SampleFormat_s64be, AkAudioCaps::SampleType_int    , 64, Q_BIG_ENDIAN   , false},
+    {AkAudioCaps::SampleFormat_u64  , AkAudioCaps::SampleType_uint   , 64, Q_BYTE_ORDER   , false},
+    {AkAudioCaps::SampleFormat_u64le, AkAudioCaps::SampleType_uint   , 64, Q_LITTLE_ENDIAN, false},
+    {AkAudioCaps::SampleFormat_u64be, AkAudioCaps::SampleType_uint   , 64, Q_BIG_ENDIAN   , false},
+    {AkAudioCaps::SampleFormat_flt  , AkAudioCaps::SampleType_float  , 32, Q_BYTE_ORDER   , false},
+    {AkAudioCaps::SampleFormat_fltle, AkAudioCaps::SampleType_float  , 32, Q_LITTLE_ENDIAN, false},
+    {AkAudioCaps::SampleFormat_fltbe, AkAudioCaps::SampleType_float  , 32, Q_BIG_ENDIAN   , false},
+    {AkAudioCaps::SampleFormat_dbl  , AkAudioCaps::SampleType_float  , 64, Q_BYTE_ORDER   , false},
+    {AkAudioCaps::SampleFormat_dblle, AkAudioCaps::SampleType_float  , 64, Q_LITTLE_ENDIAN, false},
+    {AkAudioCaps::SampleFormat_dblbe, AkAudioCaps::SampleType_float  , 64, Q_BIG_ENDIAN   , false},
+    {AkAudioCaps::SampleFormat_u8p  , AkAudioCaps::SampleType_uint   ,  8, Q_BYTE_ORDER   ,  true},
+    {AkAudioCaps::SampleFormat_s16p , AkAudioCaps::SampleType_int    , 16, Q_BYTE_ORDER   ,  true},
+    {AkAudioCaps::SampleFormat_s32p , AkAudioCaps::SampleType_int    , 32, Q_BYTE_ORDER   ,  true},
+    {AkAudioCaps::SampleFormat_s64p , AkAudioCaps::SampleType_int    , 64, Q_BYTE_ORDER   ,  true},
+    {AkAudioCaps::SampleFormat_fltp , AkAudioCaps::SampleType_float  , 32, Q_BYTE_ORDER   ,  true},
+    {AkAudioCaps::SampleFormat_dblp , AkAudioCaps::SampleType_float  , 64, Q_BYTE_ORDER   ,  true},
+};
 
-            return &formats()[0];
-        }
+static const int akAudioCapsNFormats =
+        sizeof(akAudioCapsFormats) / sizeof(SampleFormats);
 
-        static inline const SampleFormats *byType(AkAudioCaps::SampleType type)
-        {
-            for (int i = 0; i < formats().size(); i++)
-                if (formats()[i].type == type)
-                    return &formats()[i];
+const SampleFormats *SampleFormats::byFormat(AkAudioCaps::SampleFormat format)
+{
+    int i = int(format) + 1;
 
-            return &formats()[0];
-        }
+    if (i < 0 || i >= akAudioCapsNFormats)
+        i = 0;
 
-        static inline const SampleFormats *byBps(int bps)
-        {
-            for (int i = 0; i < formats().size(); i++)
-                if (formats()[i].bps == bps)
-                    return &formats()[i];
+    return akAudioCapsFormats + i;
+}
 
-            return &formats()[0];
-        }
+const SampleFormats *SampleFormats::byType(AkAudioCaps::SampleType type)
+{
+    for (int i = 0; i < akAudioCapsNFormats; i++)
+        if (akAudioCapsFormats[i].type == type)
+            return akAudioCapsFormats + i;
 
-        static inline const SampleFormats *byEndianness(int endianness)
-        {
-            for (int i = 0; i < formats().size(); i++)
-                if (formats()[i].endianness == endianness)
-                    return &formats()[i];
+    return akAudioCapsFormats;
+}
 
-            return &formats()[0];
-        }
+const SampleFormats *SampleFormats::byBps(int bps)
+{
+    for (int i = 0; i < akAudioCapsNFormats; i++)
+        if (akAudioCapsFormats[i].bps == bps)
+            return akAudioCapsFormats + i;
 
-        static inline const SampleFormats *byPlanar(bool planar)
-        {
-            for (int i = 0; i < formats().size(); i++)
-                if (formats()[i].planar == planar)
-                    return &formats()[i];
+    return akAudioCapsFormats;
+}
 
-            return &formats()[0];
-        }
-};
+const SampleFormats *SampleFormats::byEndianness(int endianness)
+{
+    for (int i = 0; i < akAudioCapsNFormats; i++)
+        if (akAudioCapsFormats[i].endianness == endianness)
+            return akAudioCapsFormats + i;
+
+    return akAudioCapsFormats;
+}
+
+const SampleFormats *SampleFormats::byPlanar(bool planar)
+{
+    for (int i = 0; i < akAudioCapsNFormats; i++)
+        if (akAudioCapsFormats[i].planar == planar)
+            return akAudioCapsFormats + i;
+
+    return akAudioCapsFormats;
+}
 
 class ChannelLayouts
 {
     public:
         AkAudioCaps::ChannelLayout layout;
         int channels;
-        QString description;
-
-        static inline const QVector<ChannelLayouts> &layouts()
-        {
-            static const QVector<ChannelLayouts> channelLayouts = {
-                {AkAudioCaps::Layout_none         ,  0, "none"          },
-                {AkAudioCaps::Layout_mono         ,  1, "mono"          },
-                {AkAudioCaps::Layout_stereo       ,  2, "stereo"        },
-                {AkAudioCaps::Layout_2p1          ,  3, "2.1"           },
-                {AkAudioCaps::Layout_3p0          ,  3, "3.0"           },
-                {AkAudioCaps::Layout_3p0_back     ,  3, "3.0(back)"     },
-                {AkAudioCaps::Layout_3p1          ,  4, "3.1"           },
-                {AkAudioCaps::Layout_4p0          ,  4, "4.0"           },
-                {AkAudioCaps::Layout_quad         ,  4, "quad"          },
-                {AkAudioCaps::Layout_quad_side    ,  4, "quad(side)"    },
-                {AkAudioCaps::Layout_4p1          ,  5, "4.1"           },
-                {AkAudioCaps::Layout_5p0          ,  5, "5.0"           },
-                {AkAudioCaps::Layout_5p0_side     ,  5, "5.0(side)"     },
-                {AkAudioCaps::Layout_5p1          ,  6, "5.1"           },
-                {AkAudioCaps::Layout_5p1_side     ,  6, "5.1(side)"     },
-                {AkAudioCaps::Layout_6p0          ,  6, "6.0"           },
-                {AkAudioCaps::Layout_6p0_front    ,  6, "6.0(front)"    },
-                {AkAudioCaps::Layout_hexagonal    ,  6, "hexagonal"     },
-                {AkAudioCaps::Layout_6p1          ,  7, "6.1"           },
-                {AkAudioCaps::Layout_6p1_front    ,  7, "6.1(back)"     },
-                {AkAudioCaps::Layout_6p1_front    ,  7, "6.1(front)"    },
-                {AkAudioCaps::Layout_7p0          ,  7, "7.0"           },
-                {AkAudioCaps::Layout_7p0_front    ,  7, "7.0(front)"    },
-                {AkAudioCaps::Layout_7p1          ,  8, "7.1"           },
-                {AkAudioCaps::Layout_7p1_wide     ,  8, "7.1(wide)"     },
-                {AkAudioCaps::Layout_7p1_wide_side,  8, "7.1(wide-side)"},
-                {AkAudioCaps::Layout_octagonal    ,  8, "octagonal"     },
-                {AkAudioCaps::Layout_hexadecagonal, 16, "hexadecagonal" },
-                {AkAudioCaps::Layout_downmix      ,  2, "downmix"       },
-            };
-
-            return channelLayouts;
-        }
+        const char *description;
 
-        static inline const ChannelLayouts *byLayout(AkAudioCaps::ChannelLayout layout)
-        {
-            for (int i = 0; i < layouts().size(); i++)
-                if (layouts()[i].layout == layout)
-                    return &layouts()[i];
+        static inline const ChannelLayouts *byLayout(AkAudioCaps::ChannelLayout layout);
+        static inline const ChannelLayouts *byChannels(int channels);
+        static inline const ChannelLayouts *byDescription(const QString &description);
+};
 
-            return &layouts()[0];
-        }
+/* The layout values are position bitmasks, so this table can't be indexed
+ * directly; the descriptions are plain string literals so building the
+ * table costs nothing at load time.
+ */
+static const ChannelLayouts akAudioCapsLayouts[] = {
+    {AkAudioCaps::Layout_none         ,  0, "none"          },
+    {AkAudioCaps::Layout_mono         ,  1, "mono"          },
+    {AkAudioCaps::Layout_stereo       ,  2, "stereo"        },
+    {AkAudioCaps::Layout_2p1          ,  3, "2.1"           },
+    {AkAudioCaps::Layout_3p0          ,  3, "3.0"           },
+    {AkAudioCaps::Layout_3p0_back     ,  3, "3.0(back)"     },
+    {AkAudioCaps::Layout_3p1          ,  4, "3.1"           },
+    {AkAudioCaps::Layout_4p0          ,  4, "4.0"           },
+    {AkAudioCaps::Layout_quad         ,  4, "quad"          },
+    {AkAudioCaps::Layout_quad_side    ,  4, "quad(side)"    },
+    {AkAudioCaps::Layout_4p1          ,  5, "4.1"           },
+    {AkAudioCaps::Layout_5p0          ,  5, "5.0"           },
+    {AkAudioCaps::Layout_5p0_side     ,  5, "5.0(side)"     },
+    {AkAudioCaps::Layout_5p1          ,  6, "5.1"           },
+    {AkAudioCaps::Layout_5p1_side     ,  6, "5.1(side)"     },
+    {AkAudioCaps::Layout_6p0          ,  6, "6.0"           },
+    {AkAudioCaps::Layout_6p0_front    ,  6, "6.0(front)"    },
+    {AkAudioCaps::Layout_hexagonal    ,  6, "hexagonal"     },
+    {AkAudioCaps::Layout_6p1          ,  7, "6.1"           },
+    {AkAudioCaps::Layout_6p1_front    ,  7, "6.1(back)"     },
+    {AkAudioCaps::Layout_6p1_front    ,  7, "6.1(front)"    },
+    {AkAudioCaps::Layout_7p0          ,  7, "7.0"           },
+    {AkAudioCaps::Layout_7p0_front    ,  7, "7.0(front)"    },
+    {AkAudioCaps::Layout_7p1          ,  8, "7.1"           },
+    {AkAudioCaps::Layout_7p1_wide     ,  8, "7.1(wide)"     },
+    {AkAudioCaps::Layout_7p1_wide_side,  8, "7.1(wide-side)"},
+    {AkAudioCaps::Layout_octagonal    ,  8, "octagonal"     },
+    {AkAudioCaps::Layout_hexadecagonal, 16, "hexadecagonal" },
+    {AkAudioCaps::Layout_downmix      ,  2, "downmix"       },
+};
 
-        static inline const ChannelLayouts *byChannels(int channels)
-        {
-            for (int i = 0; i < layouts().size(); i++)
-                if (layouts()[i].channels == channels)
-                    return &layouts()[i];
+static const int akAudioCapsNLayouts =
+        sizeof(akAudioCapsLayouts) / sizeof(ChannelLayouts);
 
-            return &layouts()[0];
-        }
+const ChannelLayouts *ChannelLayouts::byLayout(AkAudioCaps::ChannelLayout layout)
+{
+    for (int i = 0; i < akAudioCapsNLayouts; i++)
+        if (akAudioCapsLayouts[i].layout == layout)
+            return akAudioCapsLayouts + i;
 
-        static inline const ChannelLayouts *byDescription(const QString &description)
-        {
-            for (int i = 0; i < layouts().size(); i++)
-                if (layouts()[i].description == description)
-                    return &layouts()[i];
+    return akAudioCapsLayouts;
+}
 
-            return &layouts()[0];
-        }
-};
+const ChannelLayouts *ChannelLayouts::byChannels(int channels)
+{
+    for (int i = 0; i < akAudioCapsNLayouts; i++)
+        if (akAudioCapsLayouts[i].channels == channels)
+            return akAudioCapsLayouts + i;
+
+    return akAudioCapsLayouts;
+}
+
+const ChannelLayouts *ChannelLayouts::byDescription(const QString &description)
+{
+    for (int i = 0; i < akAudioCapsNLayouts; i++)
+        if (description == akAudioCapsLayouts[i].description)
+            return akAudioCapsLayouts + i;
+
+    return akAudioCapsLayouts;
+}
 
 class AkAudioCapsPrivate
 {
@@ -602,7 +617,7 @@ AkAudioCaps::SampleFormat AkAudioCaps::sampleFormatFromProperties(AkAudioCaps::S
                                                                   int endianness,
                                                                   bool planar)
 {
-    for (const SampleFormats &sampleFormat: SampleFormats::formats())
+    for (const SampleFormats &sampleFormat: akAudioCapsFormats)
         if (sampleFormat.type == type
             && sampleFormat.bps == bps
             && sampleFormat.endianness == endianness
@@ -17,19 +17,60 @@
  * Web-Site: http://webcamoid.github.io/
  */
 
+#include <cstring>
+#include <utility>
 #include <QDebug>
 #include <QVariant>
 
 #include "akaudiopacket.h"
 #include "akaudiocaps.h"
+#include "akbuffer.h"
 #include "akcaps.h"
+#include "akfrac.h"
 
 class AkAudioPacketPrivate
 {
     public:
         AkAudioCaps m_caps;
+        int m_planeCount;
+        size_t m_planeSize;
+        size_t m_sampleSize;
+
+        AkAudioPacketPrivate():
+            m_planeCount(0),
+            m_planeSize(0),
+            m_sampleSize(0)
+        {
+        }
+
+        inline void updatePlanes();
 };
 
+void AkAudioPacketPrivate::updatePlanes()
+{
+    if (!this->m_caps) {
+        this->m_planeCount = 0;
+        this->m_planeSize = 0;
+        this->m_sampleSize = 0;
+
+        return;
+    }
+
+    auto format = this->m_caps.format();
+    this->m_sampleSize = size_t(AkAudioCaps::bitsPerSample(format)) / 8;
+
+    if (AkAudioCaps::isPlanar(format)) {
+        this->m_planeCount = this->m_caps.channels();
+        this->m_planeSize = this->m_sampleSize
+                            * size_t(this->m_caps.samples());
+    } else {
+        this->m_planeCount = 1;
+        this->m_planeSize = this->m_sampleSize
+                            * size_t(this->m_caps.channels())
+                            * size_t(this->m_caps.samples());
+    }
+}
+
 AkAudioPacket::AkAudioPacket(QObject *parent):
     AkPacket(parent)
 {
@@ -45,6 +86,7 @@ AkAudioPacket::AkAudioPacket(const AkAudioCaps &caps,
 {
     this->d = new AkAudioPacketPrivate();
     this->d->m_caps = caps;
+    this->d->updatePlanes();
     this->buffer() = buffer;
     this->pts() = pts;
     this->timeBase() = timeBase;
@@ -52,29 +94,28 @@ AkAudioPacket::AkAudioPacket(const AkAudioCaps &caps,
     this->id() = id;
 }
 
-AkAudioPacket::AkAudioPacket(const AkPacket &other)
+AkAudioPacket::AkAudioPacket(const AkPacket &other):
+    AkPacket(other)
 {
+    // The base copy shares the buffers, only the caps change representation.
     this->d = new AkAudioPacketPrivate();
     this->d->m_caps = other.caps();
-    this->data() = other.data();
-    this->buffer() = other.buffer();
-    this->pts() = other.pts();
-    this->timeBase() = other.timeBase();
-    this->index() = other.index();
-    this->id() = other.id();
+    this->d->updatePlanes();
 }
 
 AkAudioPacket::AkAudioPacket(const AkAudioPacket &other):
-    AkPacket()
+    AkPacket(other)
 {
     this->d = new AkAudioPacketPrivate();
     this->d->m_caps = other.d->m_caps;
-    this->data() = other.data();
-    this->buffer() = other.buffer();
-    this->pts() = other.pts();
-    this->timeBase() = other.timeBase();
-    this->index() = other.index();
-    this->id() = other.id();
+    this->d->updatePlanes();
+}
+
+AkAudioPacket::AkAudioPacket(AkAudioPacket &&other):
+    AkPacket(std::move(other))
+{
+    this->d = other.d;
+    other.d = new AkAudioPacketPrivate();
 }
 
 AkAudioPacket::~AkAudioPacket()
@@ -84,13 +125,9 @@ AkAudioPacket::~AkAudioPacket()
 
 AkAudioPacket &AkAudioPacket::operator =(const AkPacket &other)
 {
+    this->AkPacket::operator =(other);
     this->d->m_caps = other.caps();
-    this->data() = other.data();
-    this->buffer() = other.buffer();
-    this->pts() = other.pts();
-    this->timeBase() = other.timeBase();
-    this->index() = other.index();
-    this->id() = other.id();
+    this->d->updatePlanes();
 
     return *this;
 }
@@ -98,18 +135,22 @@ AkAudioPacket &AkAudioPacket::operator =(const AkPacket &other)
 AkAudioPacket &AkAudioPacket::operator =(const AkAudioPacket &other)
 {
     if (this != &other) {
+        this->AkPacket::operator =(other);
         this->d->m_caps = other.d->m_caps;
-        this->data() = other.data();
-        this->buffer() = other.buffer();
-        this->pts() = other.pts();
-        this->timeBase() = other.timeBase();
-        this->index() = other.index();
-        this->id() = other.id();
+        this->d->updatePlanes();
     }
 
     return *this;
 }
 
+AkAudioPacket &AkAudioPacket::operator =(AkAudioPacket &&other)
+{
+    this->AkPacket::operator =(std::move(other));
+    qSwap(this->d, other.d);
+
+    return *this;
+}
+
 AkAudioPacket::operator bool() const
 {
     return this->d->m_caps.isValid();
@@ -125,6 +166,183 @@ AkAudioCaps &AkAudioPacket::caps()
     return this->d->m_caps;
 }
 
+int AkAudioPacket::planeCount() const
+{
+    return this->d->m_planeCount;
+}
+
+int AkAudioPacket::planeSize() const
+{
+    return int(this->d->m_planeSize);
+}
+
+const quint8 *AkAudioPacket::constPlane(int plane) const
+{
+    if (plane < 0 || plane >= this->d->m_planeCount)
+        return nullptr;
+
+    return reinterpret_cast<const quint8 *>(this->constData())
+           + size_t(plane) * this->d->m_planeSize;
+}
+
+quint8 *AkAudioPacket::plane(int plane)
+{
+    if (plane < 0 || plane >= this->d->m_planeCount)
+        return nullptr;
+
+    /* Mirror constData(): frame buffer backed packets travel with an
+     * empty legacy buffer, so write access goes through the frame
+     * buffer, detaching shared storage before handing out the pointer. */
+    quint8 *data = nullptr;
+
+    if (this->buffer().isEmpty() && this->frameBuffer())
+        data = this->frameBuffer().writableData();
+    else
+        data = reinterpret_cast<quint8 *>(this->buffer().data());
+
+    return data + size_t(plane) * this->d->m_planeSize;
+}
+
+const quint8 *AkAudioPacket::constSample(int channel, int sample) const
+{
+    if (channel < 0 || channel >= this->d->m_caps.channels()
+        || sample < 0 || sample >= this->d->m_caps.samples())
+        return nullptr;
+
+    auto data = reinterpret_cast<const quint8 *>(this->constData());
+
+    /* Planar mono degenerates to the interleaved formula with a single
+     * channel, so only true multiplane packets take the first branch. */
+    if (this->d->m_planeCount > 1)
+        return data + size_t(channel) * this->d->m_planeSize
+               + size_t(sample) * this->d->m_sampleSize;
+
+    return data + (size_t(sample) * size_t(this->d->m_caps.channels())
+                   + size_t(channel)) * this->d->m_sampleSize;
+}
+
+quint8 *AkAudioPacket::sample(int channel, int sample)
+{
+    if (channel < 0 || channel >= this->d->m_caps.channels()
+        || sample < 0 || sample >= this->d->m_caps.samples())
+        return nullptr;
+
+    // Same dual-buffer branch as plane() above.
+    quint8 *data = nullptr;
+
+    if (this->buffer().isEmpty() && this->frameBuffer())
+        data = this->frameBuffer().writableData();
+    else
+        data = reinterpret_cast<quint8 *>(this->buffer().data());
+
+    if (this->d->m_planeCount > 1)
+        return data + size_t(channel) * this->d->m_planeSize
+               + size_t(sample) * this->d->m_sampleSize;
+
+    return data + (size_t(sample) * size_t(this->d->m_caps.channels())
+                   + size_t(channel)) * this->d->m_sampleSize;
+}
+
+AkAudioPacket AkAudioPacket::slice(int sample, int samples) const
+{
+    if (!this->d->m_caps)
+        return AkAudioPacket();
+
+    sample = qBound(0, sample, this->d->m_caps.samples());
+    samples = qBound(0, samples, this->d->m_caps.samples() - sample);
+
+    AkAudioPacket packet(*this);
+    packet.d->m_caps.samples() = samples;
+    packet.d->updatePlanes();
+
+    auto rate = this->d->m_caps.rate();
+
+    if (rate > 0 && this->timeBase().value() > 0.0)
+        packet.pts() = this->pts()
+                       + qRound64(sample / (rate * this->timeBase().value()));
+
+    if (this->d->m_planeCount > 1) {
+        /* The plane stride changes with the sample count, so a planar
+         * slice has to gather the channel ranges into fresh storage. */
+        AkBuffer buffer(packet.d->m_planeSize
+                        * size_t(packet.d->m_planeCount));
+        auto dst = buffer.writableData();
+
+        for (int channel = 0; channel < this->d->m_planeCount; channel++)
+            memcpy(dst + size_t(channel) * packet.d->m_planeSize,
+                   this->constPlane(channel)
+                   + size_t(sample) * this->d->m_sampleSize,
+                   packet.d->m_planeSize);
+
+        packet.frameBuffer() = buffer;
+        packet.buffer() = QByteArray();
+
+        return packet;
+    }
+
+    /* Interleaved ranges are contiguous, so the slice is a view over this
+     * packet's storage; the capture keeps the parent payload referenced
+     * until the last view goes away. */
+    auto offset = size_t(sample)
+                  * size_t(this->d->m_caps.channels())
+                  * this->d->m_sampleSize;
+    AkPacket parent(*this);
+    auto data = const_cast<quint8 *>(reinterpret_cast<const quint8 *>(this->constData()));
+    packet.frameBuffer() = AkBuffer::fromRawData(data + offset,
+                                                 packet.d->m_planeSize,
+                                                 [parent] () {});
+    packet.buffer() = QByteArray();
+
+    return packet;
+}
+
+AkAudioPacket AkAudioPacket::concat(const AkAudioPacket &other) const
+{
+    if (!this->d->m_caps)
+        return other;
+
+    if (!other.d->m_caps)
+        return *this;
+
+    auto caps = this->d->m_caps;
+    auto otherCaps = other.d->m_caps;
+
+    if (caps.format() != otherCaps.format()
+        || caps.layout() != otherCaps.layout()
+        || caps.channels() != otherCaps.channels()
+        || caps.rate() != otherCaps.rate())
+        return AkAudioPacket();
+
+    AkAudioPacket packet(*this);
+    packet.d->m_caps.samples() = caps.samples() + otherCaps.samples();
+    packet.d->updatePlanes();
+
+    AkBuffer buffer(packet.d->m_planeSize * size_t(packet.d->m_planeCount));
+    auto dst = buffer.writableData();
+
+    if (this->d->m_planeCount > 1) {
+        for (int channel = 0; channel < this->d->m_planeCount; channel++) {
+            auto plane = dst + size_t(channel) * packet.d->m_planeSize;
+            memcpy(plane,
+                   this->constPlane(channel),
+                   this->d->m_planeSize);
+            memcpy(plane + this->d->m_planeSize,
+                   other.constPlane(channel),
+                   other.d->m_planeSize);
+        }
+    } else {
+        memcpy(dst, this->constData(), this->d->m_planeSize);
+        memcpy(dst + this->d->m_planeSize,
+               other.constData(),
+               other.d->m_planeSize);
+    }
+
+    packet.frameBuffer() = buffer;
+    packet.buffer() = QByteArray();
+
+    return packet;
+}
+
 QString AkAudioPacket::toString() const
 {
     QString packetInfo;
@@ -164,13 +382,9 @@ QString AkAudioPacket::toString() const
 
 AkPacket AkAudioPacket::toPacket() const
 {
-    AkPacket packet;
-    packet.caps() =  this->d->m_caps.toCaps();
-    packet.buffer() = this->buffer();
-    packet.pts() = this->pts();
-    packet.timeBase() = this->timeBase();
-    packet.index() = this->index();
-    packet.id() = this->id();
+    // Share the buffers with the new packet instead of copying them.
+    AkPacket packet(*this);
+    packet.caps() = this->d->m_caps.toCaps();
 
     return packet;
 }
@@ -181,6 +395,7 @@ void AkAudioPacket::setCaps(const AkAudioCaps &caps)
         return;
 
     this->d->m_caps = caps;
+    this->d->updatePlanes();
     emit this->capsChanged(caps);
 }
 
@@ -44,14 +44,40 @@ class AKCOMMONS_EXPORT AkAudioPacket: public AkPacket
                       qint64 id=-1);
         AkAudioPacket(const AkPacket &other);
         AkAudioPacket(const AkAudioPacket &other);
+        AkAudioPacket(AkAudioPacket &&other);
         ~AkAudioPacket();
         AkAudioPacket &operator =(const AkPacket &other);
         AkAudioPacket &operator =(const AkAudioPacket &other);
+        AkAudioPacket &operator =(AkAudioPacket &&other);
         operator bool() const;
 
         Q_INVOKABLE AkAudioCaps caps() const;
         Q_INVOKABLE AkAudioCaps &caps();
 
+        /* The sample layout is derived from the caps set through the
+         * constructor: planar formats carry one plane per channel,
+         * interleaved formats a single plane with the channels woven per
+         * sample. The offsets are computed when the caps are set, so
+         * reading a sample is pointer math over the shared storage. */
+        Q_INVOKABLE int planeCount() const;
+        Q_INVOKABLE int planeSize() const;
+        const quint8 *constPlane(int plane) const;
+        quint8 *plane(int plane);
+        const quint8 *constSample(int channel, int sample) const;
+        quint8 *sample(int channel, int sample);
+
+        /* Returns a packet over the given sample range. Interleaved and
+         * mono slices reference this packet's storage without copying;
+         * multichannel planar slices gather the per channel ranges into a
+         * single new buffer, since the plane stride changes with the
+         * sample count. */
+        Q_INVOKABLE AkAudioPacket slice(int sample, int samples) const;
+
+        /* Returns a packet carrying this packet's samples followed by the
+         * other packet's, in a single buffer allocated once. Both packets
+         * must share the same format, layout and rate. */
+        Q_INVOKABLE AkAudioPacket concat(const AkAudioPacket &other) const;
+
         Q_INVOKABLE QString toString() const;
         Q_INVOKABLE AkPacket toPacket() const;
 
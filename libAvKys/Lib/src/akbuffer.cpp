@@ -0,0 +1,335 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QDebug>
+#include <QSharedData>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef Q_OS_LINUX
+#include <sys/mman.h>
+#endif
+
+#include "akbuffer.h"
+
+#define AK_HUGE_PAGE_SIZE (size_t(2) * 1024 * 1024)
+
+/* Buffers of two megabytes or more can be backed by transparent huge
+ * pages, which cuts the TLB pressure of walking 4K frames. Opt-in with
+ * AK_BUFFER_HUGEPAGES=1 since the kernel may have to compact memory to
+ * satisfy the advice. */
+static bool akBufferHugePagesEnabled()
+{
+    static const bool enabled = qgetenv("AK_BUFFER_HUGEPAGES") == "1";
+
+    return enabled;
+}
+
+class AkBufferStorage: public QSharedData
+{
+    public:
+        quint8 *m_data;
+        quint8 *m_alignedData;
+        quint8 *m_mapData;
+        size_t m_mapSize;
+        size_t m_size;
+        size_t m_align;
+        std::function<void ()> m_release;
+
+        AkBufferStorage(size_t size, size_t align):
+            m_size(size),
+            m_align(align)
+        {
+            this->allocate(size, align);
+        }
+
+        AkBufferStorage(const AkBufferStorage &other):
+            QSharedData(other),
+            m_size(other.m_size),
+            m_align(other.m_align)
+        {
+            this->allocate(other.m_size, other.m_align);
+            memcpy(this->m_alignedData, other.m_alignedData, other.m_size);
+        }
+
+        // Wraps memory owned by someone else, nothing is freed here but
+        // 'release' notifies the owner when the payload is no longer used.
+        AkBufferStorage(quint8 *data,
+                        size_t size,
+                        const std::function<void ()> &release):
+            m_data(nullptr),
+            m_alignedData(data),
+            m_mapData(nullptr),
+            m_mapSize(0),
+            m_size(size),
+            m_align(1),
+            m_release(release)
+        {
+        }
+
+        ~AkBufferStorage()
+        {
+            if (this->m_release)
+                this->m_release();
+
+#ifdef Q_OS_LINUX
+            if (this->m_mapData)
+                munmap(this->m_mapData, this->m_mapSize);
+#endif
+
+            delete [] this->m_data;
+        }
+
+    private:
+        void allocate(size_t size, size_t align)
+        {
+            this->m_data = nullptr;
+            this->m_mapData = nullptr;
+            this->m_mapSize = 0;
+            quint8 *base = nullptr;
+
+#ifdef Q_OS_LINUX
+            if (akBufferHugePagesEnabled()
+                && size + align >= AK_HUGE_PAGE_SIZE) {
+                size_t mapSize = (size + align + AK_HUGE_PAGE_SIZE - 1)
+                                 & ~(AK_HUGE_PAGE_SIZE - 1);
+                auto map = mmap(nullptr,
+                                mapSize,
+                                PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS,
+                                -1,
+                                0);
+
+                if (map != MAP_FAILED) {
+                    madvise(map, mapSize, MADV_HUGEPAGE);
+                    this->m_mapData = static_cast<quint8 *>(map);
+                    this->m_mapSize = mapSize;
+                    base = this->m_mapData;
+                }
+            }
+#endif
+
+            // Over-allocate so the payload can start at an aligned address
+            // regardless of what the system allocator returns.
+            if (!base) {
+                this->m_data = new quint8[size + align];
+                base = this->m_data;
+            }
+
+            auto ptr = quintptr(base);
+            this->m_alignedData = base + ((align - (ptr % align)) % align);
+        }
+};
+
+class AkBufferPrivate
+{
+    public:
+        QExplicitlySharedDataPointer<AkBufferStorage> m_storage;
+};
+
+AkBuffer::AkBuffer(QObject *parent):
+    QObject(parent)
+{
+    this->d = new AkBufferPrivate();
+}
+
+AkBuffer::AkBuffer(size_t size, size_t align)
+{
+    this->d = new AkBufferPrivate();
+
+    if (size > 0)
+        this->d->m_storage = new AkBufferStorage(size, qMax<size_t>(align, 1));
+}
+
+AkBuffer::AkBuffer(const QByteArray &buffer, size_t align)
+{
+    this->d = new AkBufferPrivate();
+
+    if (!buffer.isEmpty()) {
+        this->d->m_storage = new AkBufferStorage(size_t(buffer.size()),
+                                                 qMax<size_t>(align, 1));
+        memcpy(this->d->m_storage->m_alignedData,
+               buffer.constData(),
+               size_t(buffer.size()));
+    }
+}
+
+AkBuffer::AkBuffer(const AkBuffer &other):
+    QObject()
+{
+    this->d = new AkBufferPrivate();
+    this->d->m_storage = other.d->m_storage;
+}
+
+AkBuffer::~AkBuffer()
+{
+    delete this->d;
+}
+
+AkBuffer &AkBuffer::operator =(const AkBuffer &other)
+{
+    if (this != &other)
+        this->d->m_storage = other.d->m_storage;
+
+    return *this;
+}
+
+AkBuffer::operator bool() const
+{
+    return this->d->m_storage.constData() != nullptr;
+}
+
+size_t AkBuffer::size() const
+{
+    return this->d->m_storage? this->d->m_storage->m_size: 0;
+}
+
+size_t AkBuffer::align() const
+{
+    return this->d->m_storage? this->d->m_storage->m_align: 0;
+}
+
+bool AkBuffer::isEmpty() const
+{
+    return this->size() < 1;
+}
+
+bool AkBuffer::isDetached() const
+{
+    return !this->d->m_storage
+            || this->d->m_storage->ref.load() == 1;
+}
+
+const quint8 *AkBuffer::constData() const
+{
+    return this->d->m_storage?
+                this->d->m_storage->m_alignedData: nullptr;
+}
+
+const quint8 *AkBuffer::data() const
+{
+    return this->constData();
+}
+
+quint8 *AkBuffer::writableData()
+{
+    if (!this->d->m_storage)
+        return nullptr;
+
+    this->detach();
+
+    return this->d->m_storage->m_alignedData;
+}
+
+const quint8 *AkBuffer::constPlane(size_t offset) const
+{
+    if (!this->d->m_storage
+        || offset >= this->d->m_storage->m_size)
+        return nullptr;
+
+    return this->d->m_storage->m_alignedData + offset;
+}
+
+const quint8 *AkBuffer::constLine(size_t offset,
+                                  int y,
+                                  size_t bytesPerLine) const
+{
+    return this->constPlane(offset + size_t(y) * bytesPerLine);
+}
+
+quint8 *AkBuffer::writablePlane(size_t offset)
+{
+    if (!this->d->m_storage
+        || offset >= this->d->m_storage->m_size)
+        return nullptr;
+
+    this->detach();
+
+    return this->d->m_storage->m_alignedData + offset;
+}
+
+quint8 *AkBuffer::writableLine(size_t offset, int y, size_t bytesPerLine)
+{
+    return this->writablePlane(offset + size_t(y) * bytesPerLine);
+}
+
+QByteArray AkBuffer::toByteArray() const
+{
+    if (!this->d->m_storage)
+        return QByteArray();
+
+    return QByteArray(reinterpret_cast<const char *>(this->d->m_storage->m_alignedData),
+                      int(this->d->m_storage->m_size));
+}
+
+AkBuffer AkBuffer::fromByteArray(const QByteArray &buffer, size_t align)
+{
+    return AkBuffer(buffer, align);
+}
+
+size_t AkBuffer::padStride(size_t bytesPerLine)
+{
+    size_t stride = (bytesPerLine + 63) & ~size_t(63);
+
+    // A stride that is an exact multiple of the page size maps every
+    // line onto the same cache sets; one extra cache line breaks the
+    // pattern.
+    if (stride > 0 && !(stride % 4096))
+        stride += 64;
+
+    return stride;
+}
+
+AkBuffer AkBuffer::fromRawData(quint8 *data,
+                               size_t size,
+                               const std::function<void ()> &release)
+{
+    AkBuffer buffer;
+
+    if (data && size > 0)
+        buffer.d->m_storage = new AkBufferStorage(data, size, release);
+    else if (release)
+        release();
+
+    return buffer;
+}
+
+void AkBuffer::detach()
+{
+    if (this->d->m_storage)
+        this->d->m_storage.detach();
+}
+
+void AkBuffer::clear()
+{
+    this->d->m_storage.reset();
+}
+
+QDebug operator <<(QDebug debug, const AkBuffer &buffer)
+{
+    debug.nospace() << "AkBuffer(size="
+                    << buffer.size()
+                    << ",align="
+                    << buffer.align()
+                    << ")";
+
+    return debug.space();
+}
+
+#include "moc_akbuffer.cpp"
@@ -0,0 +1,101 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef AKBUFFER_H
+#define AKBUFFER_H
+
+#include <QObject>
+#include <functional>
+
+#include "akcommons.h"
+
+class AkBufferPrivate;
+
+/* Reference counted, alignment aware frame buffer.
+ *
+ * Unlike QByteArray, reading through data() never detaches the storage, so
+ * a frame can be shared by every element in the pipeline without paying for
+ * deep copies. Writers must call detach() (or use writableData()) to get
+ * exclusive, copy-on-write access to the payload.
+ */
+class AKCOMMONS_EXPORT AkBuffer: public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(size_t size
+               READ size)
+    Q_PROPERTY(size_t align
+               READ align)
+
+    public:
+        explicit AkBuffer(QObject *parent=nullptr);
+        AkBuffer(size_t size, size_t align=64);
+        AkBuffer(const QByteArray &buffer, size_t align=64);
+        AkBuffer(const AkBuffer &other);
+        virtual ~AkBuffer();
+        AkBuffer &operator =(const AkBuffer &other);
+        operator bool() const;
+
+        Q_INVOKABLE size_t size() const;
+        Q_INVOKABLE size_t align() const;
+        Q_INVOKABLE bool isEmpty() const;
+        Q_INVOKABLE bool isDetached() const;
+
+        const quint8 *constData() const;
+        const quint8 *data() const;
+        quint8 *writableData();
+
+        // Stride aware plane view.
+        const quint8 *constPlane(size_t offset) const;
+        const quint8 *constLine(size_t offset, int y, size_t bytesPerLine) const;
+        quint8 *writablePlane(size_t offset);
+        quint8 *writableLine(size_t offset, int y, size_t bytesPerLine);
+
+        Q_INVOKABLE QByteArray toByteArray() const;
+        Q_INVOKABLE static AkBuffer fromByteArray(const QByteArray &buffer,
+                                                  size_t align=64);
+
+        /* Pads a line length to a whole number of cache lines, and nudges
+         * strides that are an exact multiple of the page size so
+         * consecutive lines of a tall plane do not alias into the same
+         * cache sets.
+         */
+        Q_INVOKABLE static size_t padStride(size_t bytesPerLine);
+
+        /* Wraps externally owned memory without copying it. 'release' is
+         * called once the last reference to the payload drops, so the owner
+         * can recycle the memory. Writers still detach into an owned copy
+         * before touching the data.
+         */
+        static AkBuffer fromRawData(quint8 *data,
+                                    size_t size,
+                                    const std::function<void ()> &release=std::function<void ()>());
+
+    private:
+        AkBufferPrivate *d;
+
+    public Q_SLOTS:
+        void detach();
+        void clear();
+};
+
+QDebug operator <<(QDebug debug, const AkBuffer &buffer);
+
+Q_DECLARE_METATYPE(AkBuffer)
+
+#endif // AKBUFFER_H
@@ -0,0 +1,201 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QMap>
+#include <QMutex>
+#include <QVector>
+
+#include "akbufferpool.h"
+#include "akmemorybudget.h"
+
+#define DEFAULT_MAX_BUFFERS_PER_BUCKET 8
+
+class AkBufferPoolPrivate
+{
+    public:
+        mutable QMutex m_mutex;
+        QMap<size_t, QVector<AkBuffer>> m_buckets;
+        int m_maxBuffersPerBucket;
+        qint64 m_idleBytes;
+
+        AkBufferPoolPrivate():
+            m_maxBuffersPerBucket(DEFAULT_MAX_BUFFERS_PER_BUCKET),
+            m_idleBytes(0)
+        {
+        }
+
+        inline static size_t bucketFor(size_t size)
+        {
+            // Round up to the next power of two so a handful of buckets
+            // covers every frame geometry in flight.
+            size_t bucket = 1;
+
+            while (bucket < size)
+                bucket <<= 1;
+
+            return bucket;
+        }
+};
+
+AkBufferPool::AkBufferPool(QObject *parent):
+    QObject(parent)
+{
+    this->d = new AkBufferPoolPrivate();
+}
+
+AkBufferPool::~AkBufferPool()
+{
+    delete this->d;
+}
+
+AkBuffer AkBufferPool::acquire(size_t size, size_t align)
+{
+    if (size < 1)
+        return AkBuffer();
+
+    size_t bucket = AkBufferPoolPrivate::bucketFor(size);
+
+    this->d->m_mutex.lock();
+    auto &buffers = this->d->m_buckets[bucket];
+
+    for (int i = 0; i < buffers.size(); i++)
+        // A buffer still referenced by a downstream element is not
+        // reusable yet, skip it.
+        if (buffers[i].isDetached()
+            && buffers[i].align() >= align) {
+            auto buffer = buffers[i];
+            buffers.remove(i);
+            this->d->m_idleBytes -= qint64(buffer.size());
+            this->d->m_mutex.unlock();
+            this->reportUsage();
+
+            return buffer;
+        }
+
+    this->d->m_mutex.unlock();
+
+    return AkBuffer(bucket, align);
+}
+
+void AkBufferPool::release(const AkBuffer &buffer)
+{
+    if (buffer.isEmpty())
+        return;
+
+    size_t bucket = AkBufferPoolPrivate::bucketFor(buffer.size());
+
+    this->d->m_mutex.lock();
+    auto &buffers = this->d->m_buckets[bucket];
+
+    if (buffers.size() < this->d->m_maxBuffersPerBucket) {
+        buffers << buffer;
+        this->d->m_idleBytes += qint64(buffer.size());
+    }
+
+    this->d->m_mutex.unlock();
+    this->reportUsage();
+}
+
+int AkBufferPool::maxBuffersPerBucket() const
+{
+    return this->d->m_maxBuffersPerBucket;
+}
+
+qint64 AkBufferPool::idleBytes() const
+{
+    QMutexLocker locker(&this->d->m_mutex);
+
+    return this->d->m_idleBytes;
+}
+
+qint64 AkBufferPool::trimIdle(qint64 bytes)
+{
+    this->d->m_mutex.lock();
+    qint64 freed = 0;
+
+    for (auto &buffers: this->d->m_buckets) {
+        while (!buffers.isEmpty() && freed < bytes) {
+            freed += qint64(buffers.last().size());
+            buffers.removeLast();
+        }
+
+        if (freed >= bytes)
+            break;
+    }
+
+    this->d->m_idleBytes -= freed;
+    this->d->m_mutex.unlock();
+    this->reportUsage();
+
+    return freed;
+}
+
+Q_GLOBAL_STATIC(AkBufferPool, akGlobalBufferPool)
+
+AkBufferPool *AkBufferPool::globalPool()
+{
+    static QAtomicInt registered;
+
+    // Idle pool buffers are pure cache, register them with the lowest
+    // priority so they are the first thing the budget manager trims.
+    if (registered.testAndSetAcquire(0, 1))
+        AkMemoryBudget::instance()
+                ->registerSubsystem("bufferPool",
+                                    0,
+                                    [] (qint64 bytes) -> qint64 {
+                                        return AkBufferPool::globalPool()
+                                                ->trimIdle(bytes);
+                                    });
+
+    return akGlobalBufferPool;
+}
+
+void AkBufferPool::setMaxBuffersPerBucket(int maxBuffersPerBucket)
+{
+    if (this->d->m_maxBuffersPerBucket == maxBuffersPerBucket)
+        return;
+
+    this->d->m_maxBuffersPerBucket = maxBuffersPerBucket;
+    emit this->maxBuffersPerBucketChanged(maxBuffersPerBucket);
+}
+
+void AkBufferPool::resetMaxBuffersPerBucket()
+{
+    this->setMaxBuffersPerBucket(DEFAULT_MAX_BUFFERS_PER_BUCKET);
+}
+
+void AkBufferPool::clear()
+{
+    this->d->m_mutex.lock();
+    this->d->m_buckets.clear();
+    this->d->m_idleBytes = 0;
+    this->d->m_mutex.unlock();
+    this->reportUsage();
+}
+
+void AkBufferPool::reportUsage() const
+{
+    // Only the shared pool is registered with the budget manager.
+    if (this != AkBufferPool::globalPool())
+        return;
+
+    AkMemoryBudget::instance()->setBytes("bufferPool", this->idleBytes());
+}
+
+#include "moc_akbufferpool.cpp"
@@ -0,0 +1,77 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef AKBUFFERPOOL_H
+#define AKBUFFERPOOL_H
+
+#include "akbuffer.h"
+
+class AkBufferPoolPrivate;
+
+/* Size bucketed recycler for frame sized allocations.
+ *
+ * Video pipelines allocate the same handful of frame sizes at 30-60 Hz per
+ * stream. The pool rounds each request up to a bucket and hands back a
+ * previously released buffer of that bucket when one is free, so the steady
+ * state does no heap allocations per frame.
+ */
+class AKCOMMONS_EXPORT AkBufferPool: public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int maxBuffersPerBucket
+               READ maxBuffersPerBucket
+               WRITE setMaxBuffersPerBucket
+               RESET resetMaxBuffersPerBucket
+               NOTIFY maxBuffersPerBucketChanged)
+
+    public:
+        explicit AkBufferPool(QObject *parent=nullptr);
+        ~AkBufferPool();
+
+        Q_INVOKABLE AkBuffer acquire(size_t size, size_t align=64);
+        Q_INVOKABLE void release(const AkBuffer &buffer);
+        Q_INVOKABLE int maxBuffersPerBucket() const;
+
+        // Bytes currently parked in the buckets waiting for reuse.
+        Q_INVOKABLE qint64 idleBytes() const;
+
+        /* Drop parked buffers until 'bytes' are freed or the buckets are
+         * empty, returns the bytes actually freed. */
+        Q_INVOKABLE qint64 trimIdle(qint64 bytes);
+
+        /* Process wide pool shared by every pipeline. Registered with
+         * AkMemoryBudget, its idle buffers are pure cache and go first
+         * when the process is over budget. */
+        static AkBufferPool *globalPool();
+
+    private:
+        AkBufferPoolPrivate *d;
+
+        void reportUsage() const;
+
+    Q_SIGNALS:
+        void maxBuffersPerBucketChanged(int maxBuffersPerBucket);
+
+    public Q_SLOTS:
+        void setMaxBuffersPerBucket(int maxBuffersPerBucket);
+        void resetMaxBuffersPerBucket();
+        void clear();
+};
+
+#endif // AKBUFFERPOOL_H
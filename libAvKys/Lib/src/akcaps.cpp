@@ -19,6 +19,9 @@
 
 #include <QDataStream>
 #include <QDebug>
+#include <QEvent>
+#include <QHash>
+#include <QMutex>
 #include <QRegExp>
 #include <QStringList>
 #include <QVariant>
@@ -30,8 +33,45 @@ class AkCapsPrivate
     public:
         QString m_mimeType;
         bool m_isValid;
+        // Interned id of the string form, -1 when it must be recomputed.
+        qint64 m_compiledId;
+
+        AkCapsPrivate():
+            m_isValid(false),
+            m_compiledId(-1)
+        {
+        }
 };
 
+class AkCapsInternTable
+{
+    public:
+        QMutex m_mutex;
+        QHash<QString, qint64> m_ids;
+        qint64 m_nextId;
+
+        AkCapsInternTable():
+            m_nextId(0)
+        {
+        }
+
+        inline qint64 idFor(const QString &caps)
+        {
+            QMutexLocker locker(&this->m_mutex);
+            auto it = this->m_ids.find(caps);
+
+            if (it != this->m_ids.end())
+                return it.value();
+
+            qint64 id = this->m_nextId++;
+            this->m_ids[caps] = id;
+
+            return id;
+        }
+};
+
+Q_GLOBAL_STATIC(AkCapsInternTable, akCapsInternTable)
+
 AkCaps::AkCaps(QObject *parent): QObject(parent)
 {
     this->d = new AkCapsPrivate();
@@ -59,6 +99,7 @@ AkCaps::AkCaps(const AkCaps &other):
     this->d->m_isValid = other.d->m_isValid;
     this->d->m_mimeType = other.d->m_mimeType;
     this->update(other);
+    this->d->m_compiledId = other.d->m_compiledId;
 }
 
 AkCaps::~AkCaps()
@@ -73,6 +114,7 @@ AkCaps &AkCaps::operator =(const AkCaps &other)
         this->d->m_isValid = other.d->m_isValid;
         this->d->m_mimeType = other.d->m_mimeType;
         this->update(other);
+        this->d->m_compiledId = other.d->m_compiledId;
     }
 
     return *this;
@@ -85,7 +127,7 @@ AkCaps &AkCaps::operator =(const QString &other)
 
 bool AkCaps::operator ==(const AkCaps &other) const
 {
-    return this->toString() == other.toString();
+    return this->compiledId() == other.compiledId();
 }
 
 bool AkCaps::operator ==(const QString &caps) const
@@ -123,6 +165,28 @@ QString AkCaps::mimeType() const
     return this->d->m_mimeType;
 }
 
+AkCaps::CapsType AkCaps::type() const
+{
+    if (this->d->m_mimeType == "audio/x-raw")
+        return CapsAudio;
+
+    if (this->d->m_mimeType == "video/x-raw")
+        return CapsVideo;
+
+    if (this->d->m_mimeType == "text/x-raw")
+        return CapsSubtitle;
+
+    return CapsUnknown;
+}
+
+qint64 AkCaps::compiledId() const
+{
+    if (this->d->m_compiledId < 0)
+        this->d->m_compiledId = akCapsInternTable->idFor(this->toString());
+
+    return this->d->m_compiledId;
+}
+
 AkCaps &AkCaps::fromMap(const QVariantMap &caps)
 {
     QList<QByteArray> properties = this->dynamicPropertyNames();
@@ -253,6 +317,7 @@ void AkCaps::setMimeType(const QString &mimeType)
         return;
 
     this->d->m_mimeType = _mimeType;
+    this->d->m_compiledId = -1;
     emit this->mimeTypeChanged(this->d->m_mimeType);
 }
 
@@ -261,10 +326,21 @@ void AkCaps::resetMimeType()
     this->setMimeType("");
 }
 
+bool AkCaps::event(QEvent *event)
+{
+    // Dynamic property writes are the only mutation path that does not go
+    // through a member function, catch them to invalidate the interned id.
+    if (event->type() == QEvent::DynamicPropertyChange)
+        this->d->m_compiledId = -1;
+
+    return QObject::event(event);
+}
+
 void AkCaps::clear()
 {
     this->d->m_mimeType.clear();
     this->d->m_isValid = false;
+    this->d->m_compiledId = -1;
 
     QList<QByteArray> properties = this->dynamicPropertyNames();
 
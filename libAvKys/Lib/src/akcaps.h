@@ -64,6 +64,14 @@ class AKCOMMONS_EXPORT AkCaps: public QObject
         Q_INVOKABLE virtual bool isValid() const;
         Q_INVOKABLE virtual bool &isValid();
         Q_INVOKABLE virtual QString mimeType() const;
+        Q_INVOKABLE CapsType type() const;
+
+        /* Interned identifier for the compiled form of this caps.
+         *
+         * The string form is built and interned once, after that equal caps
+         * compare as plain integers. Any mutation invalidates the id.
+         */
+        Q_INVOKABLE qint64 compiledId() const;
         Q_INVOKABLE AkCaps &fromMap(const QVariantMap &caps);
         Q_INVOKABLE AkCaps &fromString(const QString &caps);
         Q_INVOKABLE QVariantMap toMap() const;
@@ -75,6 +83,9 @@ class AKCOMMONS_EXPORT AkCaps: public QObject
     private:
         AkCapsPrivate *d;
 
+    protected:
+        virtual bool event(QEvent *event);
+
     Q_SIGNALS:
         void mimeTypeChanged(const QString &mimeType);
 
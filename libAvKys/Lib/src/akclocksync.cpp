@@ -0,0 +1,102 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QVector>
+
+#include "akclocksync.h"
+
+class AkClockSyncSource
+{
+    public:
+        QByteArray name;
+        // Timeline minus device clock, in nanoseconds.
+        qint64 offset;
+        bool primed;
+
+        AkClockSyncSource():
+            offset(0),
+            primed(false)
+        {
+        }
+};
+
+class AkClockSyncGlobal
+{
+    public:
+        QMutex m_mutex;
+        QElapsedTimer m_clock;
+        QVector<AkClockSyncSource> m_sources;
+
+        AkClockSyncGlobal()
+        {
+            this->m_clock.start();
+        }
+};
+
+Q_GLOBAL_STATIC(AkClockSyncGlobal, akClockSyncGlobal)
+
+qint64 AkClockSync::now()
+{
+    return akClockSyncGlobal->m_clock.nsecsElapsed();
+}
+
+int AkClockSync::registerSource(const QByteArray &name)
+{
+    QMutexLocker locker(&akClockSyncGlobal->m_mutex);
+
+    for (int i = 0; i < akClockSyncGlobal->m_sources.size(); i++)
+        if (akClockSyncGlobal->m_sources[i].name == name)
+            return i;
+
+    AkClockSyncSource source;
+    source.name = name;
+    akClockSyncGlobal->m_sources << source;
+
+    return akClockSyncGlobal->m_sources.size() - 1;
+}
+
+qint64 AkClockSync::map(int source, qint64 deviceTimeNs)
+{
+    auto arrival = AkClockSync::now();
+    QMutexLocker locker(&akClockSyncGlobal->m_mutex);
+
+    if (source < 0 || source >= akClockSyncGlobal->m_sources.size())
+        return arrival;
+
+    auto &sync = akClockSyncGlobal->m_sources[source];
+    auto offset = arrival - deviceTimeNs;
+
+    /* The arrival time is the device stamp plus the true clock offset
+     * plus whatever delay the frame picked up in the driver queue and
+     * the scheduler, so the smallest observed offset is the closest to
+     * the truth. Larger samples only pull the estimate up slowly, enough
+     * to follow clock drift but not the jitter of a late dequeue. */
+    if (!sync.primed || offset < sync.offset) {
+        sync.offset = offset;
+        sync.primed = true;
+    } else {
+        sync.offset += (offset - sync.offset) / 512;
+    }
+
+    return deviceTimeNs + sync.offset;
+}
+
+#include "moc_akclocksync.cpp"
@@ -0,0 +1,62 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef AKCLOCKSYNC_H
+#define AKCLOCKSYNC_H
+
+#include <QObject>
+
+#include "akcommons.h"
+
+/* Shared monotonic timeline for multi-source synchronization.
+ *
+ * Every capture driver stamps its buffers against its own clock: V4L2
+ * uses the kernel monotonic clock, a DirectShow graph counts from zero
+ * when it starts running, CoreMedia uses the host clock. Frames from
+ * different devices can only be aligned once those stamps live on one
+ * common axis, and aligning by arrival time instead wanders by the
+ * scheduling jitter of each dequeue loop.
+ *
+ * map() translates a device timestamp onto the process-wide monotonic
+ * timeline that now() reads. The offset between the two clocks is
+ * estimated from the arrival time of each frame: the frame that was
+ * dequeued with the least delay carries the truest offset, so the
+ * estimator keeps the minimum observed and only drifts slowly upward to
+ * follow clock skew without absorbing queueing jitter.
+ */
+class AKCOMMONS_EXPORT AkClockSync: public QObject
+{
+    Q_OBJECT
+
+    public:
+        // Nanoseconds on the shared timeline. Monotonic, starts near zero.
+        Q_INVOKABLE static qint64 now();
+
+        /* Give the device clock a slot in the offset table. Idempotent,
+         * the same name always maps to the same id, so re-opening a
+         * device resumes its previous offset estimate. */
+        static int registerSource(const QByteArray &name);
+
+        /* Translate a timestamp from the source's device clock to the
+         * shared timeline, refining the offset estimate with the current
+         * arrival time. */
+        static qint64 map(int source, qint64 deviceTimeNs);
+};
+
+#endif // AKCLOCKSYNC_H
@@ -0,0 +1,323 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QtMath>
+
+#include "akcolorlut.h"
+#include "akvideofilterrunner.h"
+
+// 16.16 fixed point scale of the additive affine tables.
+#define LUT_SCALE 16
+
+enum LutMode
+{
+    LutModeNone,
+    LutModeChannels,
+    LutModeAffine,
+    LutModeHslAffine,
+    LutModeGray
+};
+
+class AkColorLutPrivate
+{
+    public:
+        LutMode m_mode;
+
+        // Clamped per-channel maps.
+        quint8 m_channels[3][256];
+
+        /* Additive tables, one per (output, input) pair, bias folded into
+         * the first input. The hue input ranges -1..359 and is stored
+         * offset by one, the other inputs use the first 256 entries.
+         */
+        int m_affine[3][3][361];
+
+        // Gray-indexed palette.
+        QRgb m_gray[256];
+
+        AkColorLutPrivate():
+            m_mode(LutModeNone)
+        {
+        }
+};
+
+/* RGB <-> HSL conversions with the same ranges as QColor: hue 0..359 with
+ * -1 for achromatic colors, saturation and lightness 0..255.
+ */
+inline void rgbToHsl(QRgb pixel, int *h, int *s, int *l)
+{
+    qreal r = qRed(pixel) / 255.0;
+    qreal g = qGreen(pixel) / 255.0;
+    qreal b = qBlue(pixel) / 255.0;
+    qreal max = qMax(r, qMax(g, b));
+    qreal min = qMin(r, qMin(g, b));
+    qreal delta = max - min;
+    qreal lightness = (max + min) / 2;
+
+    if (qFuzzyIsNull(delta)) {
+        *h = -1;
+        *s = 0;
+    } else {
+        qreal hue;
+
+        if (qFuzzyCompare(max, r))
+            hue = (g - b) / delta;
+        else if (qFuzzyCompare(max, g))
+            hue = (b - r) / delta + 2;
+        else
+            hue = (r - g) / delta + 4;
+
+        hue *= 60;
+
+        if (hue < 0)
+            hue += 360;
+
+        *h = qRound(hue) % 360;
+        *s = qRound(255 * delta / (1 - qAbs(2 * lightness - 1)));
+    }
+
+    *l = qRound(255 * lightness);
+}
+
+inline QRgb hslToRgb(int h, int s, int l, int a)
+{
+    qreal saturation = s / 255.0;
+    qreal lightness = l / 255.0;
+    qreal c = (1 - qAbs(2 * lightness - 1)) * saturation;
+    qreal hue = qMax(h, 0) / 60.0;
+    qreal x = c * (1 - qAbs(fmod(hue, 2) - 1));
+    qreal r = 0;
+    qreal g = 0;
+    qreal b = 0;
+
+    switch (int(hue)) {
+    case 0: r = c; g = x;        break;
+    case 1: r = x; g = c;        break;
+    case 2:        g = c; b = x; break;
+    case 3:        g = x; b = c; break;
+    case 4: r = x;        b = c; break;
+    default: r = c;       b = x; break;
+    }
+
+    qreal m = lightness - c / 2;
+
+    return qRgba(qBound(0, qRound(255 * (r + m)), 255),
+                 qBound(0, qRound(255 * (g + m)), 255),
+                 qBound(0, qRound(255 * (b + m)), 255),
+                 a);
+}
+
+AkColorLut::AkColorLut()
+{
+    this->d = new AkColorLutPrivate;
+}
+
+AkColorLut::AkColorLut(const AkColorLut &other)
+{
+    this->d = new AkColorLutPrivate(*other.d);
+}
+
+AkColorLut::~AkColorLut()
+{
+    delete this->d;
+}
+
+AkColorLut &AkColorLut::operator =(const AkColorLut &other)
+{
+    if (this != &other)
+        *this->d = *other.d;
+
+    return *this;
+}
+
+bool AkColorLut::isValid() const
+{
+    return this->d->m_mode != LutModeNone;
+}
+
+void AkColorLut::clear()
+{
+    this->d->m_mode = LutModeNone;
+}
+
+void AkColorLut::setGains(qreal kr, qreal kg, qreal kb)
+{
+    for (int i = 0; i < 256; i++) {
+        this->d->m_channels[0][i] = quint8(qBound(0, int(kr * i), 255));
+        this->d->m_channels[1][i] = quint8(qBound(0, int(kg * i), 255));
+        this->d->m_channels[2][i] = quint8(qBound(0, int(kb * i), 255));
+    }
+
+    this->d->m_mode = LutModeChannels;
+}
+
+void AkColorLut::setKernel(const QVector<qreal> &kernel)
+{
+    if (kernel.size() < 12) {
+        this->clear();
+
+        return;
+    }
+
+    for (int o = 0; o < 3; o++)
+        for (int i = 0; i < 3; i++) {
+            int bias = i == 0? qRound(kernel[4 * o + 3] * (1 << LUT_SCALE)): 0;
+
+            for (int v = 0; v < 256; v++)
+                this->d->m_affine[o][i][v] =
+                        qRound(kernel[4 * o + i] * v * (1 << LUT_SCALE)) + bias;
+        }
+
+    this->d->m_mode = LutModeAffine;
+}
+
+void AkColorLut::setHslKernel(const QVector<qreal> &kernel)
+{
+    if (kernel.size() < 12) {
+        this->clear();
+
+        return;
+    }
+
+    for (int o = 0; o < 3; o++)
+        for (int i = 0; i < 3; i++) {
+            int bias = i == 0? qRound(kernel[4 * o + 3] * (1 << LUT_SCALE)): 0;
+            int size = i == 0? 361: 256;
+
+            for (int v = 0; v < size; v++) {
+                int value = i == 0? v - 1: v;
+                this->d->m_affine[o][i][v] =
+                        qRound(kernel[4 * o + i] * value * (1 << LUT_SCALE))
+                        + bias;
+            }
+        }
+
+    this->d->m_mode = LutModeHslAffine;
+}
+
+void AkColorLut::setGrayTable(const QVector<QRgb> &table)
+{
+    if (table.size() < 256) {
+        this->clear();
+
+        return;
+    }
+
+    memcpy(this->d->m_gray, table.constData(), 256 * sizeof(QRgb));
+    this->d->m_mode = LutModeGray;
+}
+
+void AkColorLut::apply(const QImage &src, QImage &dst) const
+{
+    LutMode mode = this->d->m_mode;
+    int width = src.width();
+
+    AkVideoFilterRunner::globalRunner()->run(src.height(),
+                                             [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            auto srcLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
+            auto dstLine = reinterpret_cast<QRgb *>(dst.scanLine(y));
+
+            switch (mode) {
+            case LutModeChannels:
+                for (int x = 0; x < width; x++) {
+                    QRgb pixel = srcLine[x];
+                    dstLine[x] = qRgba(this->d->m_channels[0][qRed(pixel)],
+                                       this->d->m_channels[1][qGreen(pixel)],
+                                       this->d->m_channels[2][qBlue(pixel)],
+                                       qAlpha(pixel));
+                }
+
+                break;
+            case LutModeAffine:
+                for (int x = 0; x < width; x++) {
+                    QRgb pixel = srcLine[x];
+                    int r = qRed(pixel);
+                    int g = qGreen(pixel);
+                    int b = qBlue(pixel);
+
+                    int rt = (this->d->m_affine[0][0][r]
+                              + this->d->m_affine[0][1][g]
+                              + this->d->m_affine[0][2][b]) >> LUT_SCALE;
+                    int gt = (this->d->m_affine[1][0][r]
+                              + this->d->m_affine[1][1][g]
+                              + this->d->m_affine[1][2][b]) >> LUT_SCALE;
+                    int bt = (this->d->m_affine[2][0][r]
+                              + this->d->m_affine[2][1][g]
+                              + this->d->m_affine[2][2][b]) >> LUT_SCALE;
+
+                    dstLine[x] = qRgba(qBound(0, rt, 255),
+                                       qBound(0, gt, 255),
+                                       qBound(0, bt, 255),
+                                       qAlpha(pixel));
+                }
+
+                break;
+            case LutModeHslAffine:
+                for (int x = 0; x < width; x++) {
+                    QRgb pixel = srcLine[x];
+                    int h;
+                    int s;
+                    int l;
+                    rgbToHsl(pixel, &h, &s, &l);
+
+                    int ht = (this->d->m_affine[0][0][h + 1]
+                              + this->d->m_affine[0][1][s]
+                              + this->d->m_affine[0][2][l]) >> LUT_SCALE;
+                    int st = (this->d->m_affine[1][0][h + 1]
+                              + this->d->m_affine[1][1][s]
+                              + this->d->m_affine[1][2][l]) >> LUT_SCALE;
+                    int lt = (this->d->m_affine[2][0][h + 1]
+                              + this->d->m_affine[2][1][s]
+                              + this->d->m_affine[2][2][l]) >> LUT_SCALE;
+
+                    dstLine[x] = hslToRgb(qBound(0, ht, 359),
+                                          qBound(0, st, 255),
+                                          qBound(0, lt, 255),
+                                          qAlpha(pixel));
+                }
+
+                break;
+            default:
+                memcpy(dstLine, srcLine, size_t(width) * sizeof(QRgb));
+
+                break;
+            }
+        }
+    });
+}
+
+void AkColorLut::applyGray(const QImage &src, QImage &dst) const
+{
+    if (this->d->m_mode != LutModeGray)
+        return;
+
+    int width = src.width();
+
+    AkVideoFilterRunner::globalRunner()->run(src.height(),
+                                             [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            const quint8 *srcLine = src.constScanLine(y);
+            auto dstLine = reinterpret_cast<QRgb *>(dst.scanLine(y));
+
+            for (int x = 0; x < width; x++)
+                dstLine[x] = this->d->m_gray[srcLine[x]];
+        }
+    });
+}
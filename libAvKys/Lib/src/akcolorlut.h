@@ -0,0 +1,68 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef AKCOLORLUT_H
+#define AKCOLORLUT_H
+
+#include <QImage>
+#include <QVector>
+
+#include "akcommons.h"
+
+class AkColorLutPrivate;
+
+/* Compiled lookup tables for the color-mapping effects.
+ *
+ * These effects apply a transform that only depends on the input color and
+ * on fixed parameters, so the parameters compile once into small tables and
+ * every frame reduces to lookups. Affine kernels become three additive
+ * fixed point tables per output channel, clamped after the sum, so a full
+ * 3D table never gets materialized. The mapping passes run in parallel row
+ * bands.
+ */
+class AKCOMMONS_EXPORT AkColorLut
+{
+    public:
+        AkColorLut();
+        AkColorLut(const AkColorLut &other);
+        ~AkColorLut();
+        AkColorLut &operator =(const AkColorLut &other);
+
+        bool isValid() const;
+        void clear();
+
+        // Per-channel multiplicative gains, as in white balancing.
+        void setGains(qreal kr, qreal kg, qreal kb);
+        // 12-term affine kernel over the RGB channels.
+        void setKernel(const QVector<qreal> &kernel);
+        // 12-term affine kernel over the HSL components.
+        void setHslKernel(const QVector<qreal> &kernel);
+        // Gray-indexed palette of 256 colors.
+        void setGrayTable(const QVector<QRgb> &table);
+
+        // 'src' and 'dst' must be ARGB32 frames of the same size.
+        void apply(const QImage &src, QImage &dst) const;
+        // 'src' must be a Grayscale8 frame, 'dst' an ARGB32 frame.
+        void applyGray(const QImage &src, QImage &dst) const;
+
+    private:
+        AkColorLutPrivate *d;
+};
+
+#endif // AKCOLORLUT_H
@@ -0,0 +1,112 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QSize>
+#include <QVector>
+
+#include "akdisplacementmap.h"
+#include "akvideofilterrunner.h"
+
+class AkDisplacementMapPrivate
+{
+    public:
+        QSize m_size;
+
+        // Source pixel index for every output pixel.
+        QVector<int> m_map;
+};
+
+AkDisplacementMap::AkDisplacementMap()
+{
+    this->d = new AkDisplacementMapPrivate;
+}
+
+AkDisplacementMap::AkDisplacementMap(const AkDisplacementMap &other)
+{
+    this->d = new AkDisplacementMapPrivate(*other.d);
+}
+
+AkDisplacementMap::~AkDisplacementMap()
+{
+    delete this->d;
+}
+
+AkDisplacementMap &AkDisplacementMap::operator =(const AkDisplacementMap &other)
+{
+    if (this != &other)
+        *this->d = *other.d;
+
+    return *this;
+}
+
+bool AkDisplacementMap::isValid(const QSize &size) const
+{
+    return size == this->d->m_size && !this->d->m_map.isEmpty();
+}
+
+void AkDisplacementMap::clear()
+{
+    this->d->m_size = QSize();
+    this->d->m_map.clear();
+}
+
+void AkDisplacementMap::setMap(const QSize &size, const MapFunction &mapTo)
+{
+    int width = size.width();
+    int height = size.height();
+    this->d->m_map.resize(width * height);
+    int *map = this->d->m_map.data();
+
+    AkVideoFilterRunner::globalRunner()->run(height, [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            int *mapLine = map + y * width;
+
+            for (int x = 0; x < width; x++) {
+                QPoint source = mapTo(x, y);
+                mapLine[x] = source.x() + source.y() * width;
+            }
+        }
+    });
+
+    this->d->m_size = size;
+}
+
+void AkDisplacementMap::apply(const QImage &src, QImage &dst) const
+{
+    if (src.size() != this->d->m_size) {
+        dst = src;
+
+        return;
+    }
+
+    int width = this->d->m_size.width();
+    auto srcBits = reinterpret_cast<const QRgb *>(src.constBits());
+    const int *map = this->d->m_map.constData();
+
+    AkVideoFilterRunner::globalRunner()->run(this->d->m_size.height(),
+                                             [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            const int *mapLine = map + y * width;
+            auto dstLine = reinterpret_cast<QRgb *>(dst.scanLine(y));
+
+            for (int x = 0; x < width; x++)
+                dstLine[x] = srcBits[mapLine[x]];
+        }
+    });
+}
@@ -0,0 +1,67 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef AKDISPLACEMENTMAP_H
+#define AKDISPLACEMENTMAP_H
+
+#include <QImage>
+#include <QPoint>
+#include <functional>
+
+#include "akcommons.h"
+
+class AkDisplacementMapPrivate;
+
+/* Precomputed (x, y) -> (x', y') mapping for the warp style effects.
+ *
+ * The effects that remap pixels from a displaced source position spend most
+ * of their time on per-pixel trigonometry. When the displacement only
+ * depends on the parameters and the frame geometry, the mapping compiles
+ * once into a table of source pixel indices, and every frame reduces to a
+ * gather. The table build and the gather both run in parallel row bands.
+ *
+ * The caller owns the cache policy: rebuild the map when its parameters or
+ * the frame size change, apply it otherwise.
+ */
+class AKCOMMONS_EXPORT AkDisplacementMap
+{
+    public:
+        typedef std::function<QPoint (int x, int y)> MapFunction;
+
+        AkDisplacementMap();
+        AkDisplacementMap(const AkDisplacementMap &other);
+        ~AkDisplacementMap();
+        AkDisplacementMap &operator =(const AkDisplacementMap &other);
+
+        bool isValid(const QSize &size) const;
+        void clear();
+
+        /* Rebuild the table for 'size' frames. 'mapTo' returns the source
+         * position for every output pixel, and must stay inside the frame.
+         */
+        void setMap(const QSize &size, const MapFunction &mapTo);
+
+        // 'src' and 'dst' must be ARGB32 frames of the mapped size.
+        void apply(const QImage &src, QImage &dst) const;
+
+    private:
+        AkDisplacementMapPrivate *d;
+};
+
+#endif // AKDISPLACEMENTMAP_H
@@ -17,22 +17,34 @@
  * Web-Site: http://webcamoid.github.io/
  */
 
+#include <QAtomicInt>
 #include <QCoreApplication>
 #include <QCryptographicHash>
 #include <QDataStream>
 #include <QDebug>
 #include <QDir>
 #include <QDirIterator>
+#include <QFile>
 #include <QFileInfo>
+#include <QElapsedTimer>
+#include <QHash>
 #include <QMetaMethod>
+#include <QMutex>
 #include <QPluginLoader>
 #include <QQmlComponent>
 #include <QQmlContext>
 #include <QQmlEngine>
 #include <QRegExp>
+#include <QStandardPaths>
 #include <QVector>
+#include <ctime>
+#include <limits>
+#include <memory>
 
 #include "akelement.h"
+#include "akbufferpool.h"
+#include "akmetrics.h"
+#include "akwatchdog.h"
 #include "akplugin.h"
 #include "akcaps.h"
 #include "akpacket.h"
@@ -41,6 +53,10 @@
 
 #define SUBMODULES_PATH "submodules"
 
+#define PLUGINS_CACHE_FILE "akpluginscache.bin"
+#define PLUGINS_CACHE_MAGIC quint32(0x414b5043) // 'AKPC'
+#define PLUGINS_CACHE_VERSION quint32(1)
+
 class AkPluginInfoPrivate
 {
     public:
@@ -50,6 +66,27 @@ class AkPluginInfoPrivate
         bool m_used;
 };
 
+class AkPluginCacheEntry
+{
+    public:
+        qint64 m_size;
+        qint64 m_mtime;
+        QVariantMap m_metaData;
+};
+
+class AkScratchPlane
+{
+    public:
+        QSize m_size;
+        size_t m_bytesPerPixel;
+        AkBuffer m_buffer;
+
+        AkScratchPlane():
+            m_bytesPerPixel(0)
+        {
+        }
+};
+
 class AkElementPrivate
 {
     public:
@@ -60,16 +97,99 @@ class AkElementPrivate
         QStringList m_defaultPluginsSearchPaths;
         QStringList m_pluginsBlackList;
         QList<AkPluginInfoPrivate> m_pluginsList;
+
+        /* Lazy id to list position index for pluginInfo(). The effect
+         * picker asks for the metadata of every plugin each time its
+         * lists rebuild, and a linear search per query turns that into a
+         * quadratic scan over the cached entries. Cleared whenever the
+         * list changes and rebuilt on the next query. */
+        QHash<QString, int> m_pluginIndexOfId;
         QString m_subModulesPath;
         QDir m_applicationDir;
-        AkElement::ElementState m_state;
+        /* The state is read on every frame by the packet threads and
+         * written from the UI thread, so it lives in an atomic instead of
+         * behind a lock; state() is wait-free and never blocks a capture
+         * thread behind a control thread holding a mutex.
+         */
+        QAtomicInt m_state;
+        // Read per frame by quality aware effects, same rules as m_state.
+        QAtomicInt m_quality;
         bool m_recursiveSearchPaths;
         bool m_pluginsScanned;
 
+        /* On-disk plugin index keyed by file size and mtime. A plugin whose
+         * entry is still fresh is never dlopen'ed during the scan, its
+         * cached metadata is trusted and the shared object is loaded lazily
+         * on first instantiation, like any other plugin.
+         */
+        QHash<QString, AkPluginCacheEntry> m_pluginsCache;
+        bool m_pluginsCacheLoaded;
+        bool m_pluginsCacheDirty;
+
+        /* Plugin factories kept loaded for the process lifetime, keyed by
+         * shared object path. Once a plugin has been instantiated, creating
+         * it again is a hash lookup plus a constructor call, the shared
+         * object is never re-resolved.
+         */
+        QMutex m_pluginFactoriesMutex;
+        QHash<QString, AkPlugin *> m_pluginFactories;
+
+        /* Same thread sinks resolved at link() time, called directly from
+         * send() without going through the meta-object system. The mask
+         * holds one bit per AkCaps::CapsType the sink consumes, so a
+         * typed sink never sees packets of other media types.
+         */
+        struct FastSink
+        {
+            AkElement *element;
+            quint32 typeMask;
+        };
+        QMutex m_fastSinksMutex;
+        QVector<FastSink> m_fastSinks;
+
+        inline static quint32 typeMask(const QList<AkCaps::CapsType> &types)
+        {
+            // An untyped element takes everything, as before.
+            if (types.isEmpty())
+                return std::numeric_limits<quint32>::max();
+
+            quint32 mask = 0;
+
+            // Shifted by one so CapsUnknown lands on bit zero.
+            for (auto &type: types)
+                mask |= 1 << (type + 1);
+
+            return mask;
+        }
+
+        // Geometry keyed scratch planes, see AkElement::scratchPlane().
+        QMutex m_scratchMutex;
+        QHash<QString, AkScratchPlane> m_scratchPlanes;
+
+        /* Current parameter block, see AkElement::publishParameters(). The
+         * block itself is immutable, writers replace the whole pointer
+         * atomically. */
+        std::shared_ptr<const QVariantMap> m_parameters;
+
+        // Watchdog heartbeat, see AkElement::lastActivity().
+        QAtomicInteger<qint64> m_lastActivity;
+
+        inline QString stageName(const AkElement *element) const
+        {
+            if (element->objectName().isEmpty())
+                return this->m_pluginId;
+
+            return QString("%1/%2").arg(this->m_pluginId)
+                                   .arg(element->objectName());
+        }
+
         AkElementPrivate()
         {
+            this->m_lastActivity.storeRelease(-1);
             this->m_recursiveSearchPaths = false;
             this->m_pluginsScanned = false;
+            this->m_pluginsCacheLoaded = false;
+            this->m_pluginsCacheDirty = false;
 
             this->m_defaultPluginsSearchPaths << QString("%1/%2")
                                                  .arg(LIBDIR)
@@ -157,8 +277,130 @@ class AkElementPrivate
             return QDir::cleanPath(absPath);
         }
 
+        inline AkPlugin *pluginFactory(const QString &path)
+        {
+            QMutexLocker locker(&this->m_pluginFactoriesMutex);
+            auto it = this->m_pluginFactories.find(path);
+
+            if (it != this->m_pluginFactories.end())
+                return it.value();
+
+            QPluginLoader pluginLoader(path);
+
+            if (!pluginLoader.load()) {
+                qDebug() << "Error loading plugin"
+                         << path << ":" << pluginLoader.errorString();
+
+                return nullptr;
+            }
+
+            /* The root instance stays alive because the loader is never
+             * unloaded, so the factory pointer remains valid for the whole
+             * process. Failed loads are not cached, a plugin fixed on disk
+             * can be retried. */
+            auto plugin = qobject_cast<AkPlugin *>(pluginLoader.instance());
+
+            if (!plugin)
+                return nullptr;
+
+            this->m_pluginFactories[path] = plugin;
+
+            return plugin;
+        }
+
+        inline QString pluginsCachePath() const
+        {
+            auto cacheDir =
+                    QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+
+            if (cacheDir.isEmpty())
+                return QString();
+
+            return cacheDir + QDir::separator() + PLUGINS_CACHE_FILE;
+        }
+
+        inline void loadPluginsCache()
+        {
+            if (this->m_pluginsCacheLoaded)
+                return;
+
+            this->m_pluginsCacheLoaded = true;
+            auto cachePath = this->pluginsCachePath();
+
+            if (cachePath.isEmpty())
+                return;
+
+            QFile cacheFile(cachePath);
+
+            if (!cacheFile.open(QIODevice::ReadOnly))
+                return;
+
+            QDataStream stream(&cacheFile);
+            quint32 magic = 0;
+            quint32 version = 0;
+            stream >> magic >> version;
+
+            if (magic != PLUGINS_CACHE_MAGIC
+                || version != PLUGINS_CACHE_VERSION)
+                return;
+
+            stream.setVersion(QDataStream::Qt_5_0);
+            quint32 nEntries = 0;
+            stream >> nEntries;
+
+            for (quint32 i = 0; i < nEntries; i++) {
+                QString path;
+                AkPluginCacheEntry entry;
+                stream >> path
+                       >> entry.m_size
+                       >> entry.m_mtime
+                       >> entry.m_metaData;
+
+                if (stream.status() != QDataStream::Ok) {
+                    this->m_pluginsCache.clear();
+
+                    return;
+                }
+
+                this->m_pluginsCache[path] = entry;
+            }
+        }
+
+        inline void savePluginsCache()
+        {
+            if (!this->m_pluginsCacheDirty)
+                return;
+
+            auto cachePath = this->pluginsCachePath();
+
+            if (cachePath.isEmpty())
+                return;
+
+            QDir().mkpath(QFileInfo(cachePath).absolutePath());
+            QFile cacheFile(cachePath);
+
+            if (!cacheFile.open(QIODevice::WriteOnly))
+                return;
+
+            QDataStream stream(&cacheFile);
+            stream << PLUGINS_CACHE_MAGIC << PLUGINS_CACHE_VERSION;
+            stream.setVersion(QDataStream::Qt_5_0);
+            stream << quint32(this->m_pluginsCache.size());
+
+            for (auto it = this->m_pluginsCache.begin();
+                 it != this->m_pluginsCache.end();
+                 it++)
+                stream << it.key()
+                       << it.value().m_size
+                       << it.value().m_mtime
+                       << it.value().m_metaData;
+
+            this->m_pluginsCacheDirty = false;
+        }
+
         inline void listPlugins()
         {
+            this->loadPluginsCache();
             QVector<QStringList *> sPaths {
                 &this->m_pluginsSearchPaths,
                 &this->m_defaultPluginsSearchPaths
@@ -215,29 +457,58 @@ class AkElementPrivate
                         if (found)
                             continue;
 
-                        if (QFileInfo(path).isFile()) {
-                            QString fileName = QFileInfo(path).fileName();
+                        QFileInfo fileInfo(path);
+
+                        if (fileInfo.isFile()) {
+                            QString fileName = fileInfo.fileName();
 
                             if (QRegExp(this->m_pluginFilePattern,
                                         Qt::CaseSensitive,
                                         QRegExp::Wildcard).exactMatch(fileName)) {
-                                QPluginLoader pluginLoader(path);
-
-                                if (pluginLoader.load()) {
-                                    auto metaData = pluginLoader.metaData();
-
-                                    if (metaData["MetaData"].toObject().contains("pluginType")
-                                        && metaData["MetaData"].toObject()["pluginType"] == AK_PLUGIN_TYPE_ELEMENT) {
-                                        this->m_pluginsList <<
-                                            AkPluginInfoPrivate {
-                                                pluginId,
-                                                path,
-                                                metaData.toVariantMap(),
-                                                true
-                                            };
+                                auto cacheIt = this->m_pluginsCache.find(path);
+                                auto mtime =
+                                        fileInfo.lastModified()
+                                                .toMSecsSinceEpoch();
+                                bool fresh =
+                                        cacheIt != this->m_pluginsCache.end()
+                                        && cacheIt->m_size == fileInfo.size()
+                                        && cacheIt->m_mtime == mtime;
+                                QVariantMap metaData;
+
+                                if (fresh) {
+                                    metaData = cacheIt->m_metaData;
+                                } else {
+                                    QPluginLoader pluginLoader(path);
+
+                                    if (pluginLoader.load()) {
+                                        metaData = pluginLoader.metaData()
+                                                               .toVariantMap();
+                                        pluginLoader.unload();
                                     }
 
-                                    pluginLoader.unload();
+                                    // Failed loads are remembered too, so a
+                                    // broken plugin is not dlopen'ed on every
+                                    // start.
+                                    this->m_pluginsCache[path] =
+                                            AkPluginCacheEntry {
+                                                fileInfo.size(),
+                                                mtime,
+                                                metaData
+                                            };
+                                    this->m_pluginsCacheDirty = true;
+                                }
+
+                                auto pluginMetaData = metaData["MetaData"].toMap();
+
+                                if (pluginMetaData.contains("pluginType")
+                                    && pluginMetaData["pluginType"] == AK_PLUGIN_TYPE_ELEMENT) {
+                                    this->m_pluginsList <<
+                                        AkPluginInfoPrivate {
+                                            pluginId,
+                                            path,
+                                            metaData,
+                                            true
+                                        };
                                 }
                             }
                         } else {
@@ -262,6 +533,7 @@ class AkElementPrivate
                     }
                 }
 
+            this->savePluginsCache();
             this->m_pluginsScanned = true;
         }
 };
@@ -272,12 +544,14 @@ AkElement::AkElement(QObject *parent):
     QObject(parent)
 {
     this->d = new AkElementPrivate();
-    this->d->m_state = ElementStateNull;
+    this->d->m_state.storeRelease(ElementStateNull);
+    this->d->m_quality.storeRelease(QualityFull);
 }
 
 AkElement::~AkElement()
 {
     this->setState(AkElement::ElementStateNull);
+    this->clearScratchPlanes();
     delete this->d;
 }
 
@@ -298,7 +572,20 @@ QString AkElement::pluginPath() const
 
 AkElement::ElementState AkElement::state() const
 {
-    return this->d->m_state;
+    /* Lock-free read for the packet path. The acquire pairs with the
+     * release in setState(), so once a thread observes the new state it
+     * also sees everything written before the transition. */
+    return ElementState(this->d->m_state.loadAcquire());
+}
+
+AkElement::QualityLevel AkElement::quality() const
+{
+    return QualityLevel(this->d->m_quality.loadAcquire());
+}
+
+qint64 AkElement::lastActivity() const
+{
+    return this->d->m_lastActivity.loadAcquire();
 }
 
 QObject *AkElement::controlInterface(QQmlEngine *engine,
@@ -366,6 +653,16 @@ bool AkElement::unlink(const AkElementPtr &dstElement) const
     return this->unlink(static_cast<QObject *>(dstElement.data()));
 }
 
+QVariantList AkElement::preferredPixelFormats() const
+{
+    return {};
+}
+
+QList<AkCaps::CapsType> AkElement::acceptedMediaTypes() const
+{
+    return {};
+}
+
 bool AkElement::link(const AkElementPtr &srcElement,
                      const QObject *dstElement,
                      Qt::ConnectionType connectionType)
@@ -387,6 +684,36 @@ bool AkElement::link(const QObject *srcElement,
     if (!srcElement || !dstElement)
         return false;
 
+    // Resolve same thread element to element links to a direct call, a
+    // 10-effect chain at 60 fps pays ten QMetaObject dispatches per frame
+    // otherwise. Cross-thread links keep using queued signal delivery.
+    auto src = qobject_cast<AkElement *>(const_cast<QObject *>(srcElement));
+    auto dst = qobject_cast<AkElement *>(const_cast<QObject *>(dstElement));
+
+    if (src
+        && dst
+        && connectionType == Qt::DirectConnection
+        && srcElement->thread() == dstElement->thread()) {
+        QMutexLocker locker(&src->d->m_fastSinksMutex);
+        bool known = false;
+
+        for (auto &sink: src->d->m_fastSinks)
+            if (sink.element == dst) {
+                known = true;
+
+                break;
+            }
+
+        if (!known)
+            src->d->m_fastSinks
+                    << AkElementPrivate::FastSink {
+                           dst,
+                           AkElementPrivate::typeMask(dst->acceptedMediaTypes())
+                       };
+
+        return true;
+    }
+
     QList<QMetaMethod> signalList = AkElementPrivate::methodsByName(srcElement, "oStream");
     QList<QMetaMethod> slotList = AkElementPrivate::methodsByName(dstElement, "iStream");
 
@@ -417,6 +744,17 @@ bool AkElement::unlink(const QObject *srcElement, const QObject *dstElement)
     if (!srcElement || !dstElement)
         return false;
 
+    auto src = qobject_cast<AkElement *>(const_cast<QObject *>(srcElement));
+    auto dst = qobject_cast<AkElement *>(const_cast<QObject *>(dstElement));
+
+    if (src && dst) {
+        QMutexLocker locker(&src->d->m_fastSinksMutex);
+
+        for (int i = src->d->m_fastSinks.size() - 1; i >= 0; i--)
+            if (src->d->m_fastSinks[i].element == dst)
+                src->d->m_fastSinks.removeAt(i);
+    }
+
     for (const QMetaMethod &signal: AkElementPrivate::methodsByName(srcElement, "oStream"))
         for (const QMetaMethod &slot: AkElementPrivate::methodsByName(dstElement, "iStream"))
             if (AkElementPrivate::methodCompat(signal, slot) &&
@@ -445,21 +783,12 @@ AkElement *AkElement::createPtr(const QString &pluginId, const QString &elementN
     if (filePath.isEmpty())
         return nullptr;
 
-    QPluginLoader pluginLoader(filePath);
-
-    if (!pluginLoader.load()) {
-        qDebug() << "Error loading plugin " << pluginId << ":" << pluginLoader.errorString();
-
-        return nullptr;
-    }
-
-    auto plugin = qobject_cast<AkPlugin *>(pluginLoader.instance());
+    auto plugin = akElementGlobalStuff->pluginFactory(filePath);
 
     if (!plugin)
         return nullptr;
 
     auto element = qobject_cast<AkElement *>(plugin->create(AK_PLUGIN_TYPE_ELEMENT, ""));
-    delete plugin;
 
     if (!element)
         return nullptr;
@@ -581,26 +910,17 @@ QObject *AkElement::loadSubModule(const QString &pluginId,
 
     for (const QString &subModulesPath: subModulesPaths) {
         if (AkElementPrivate::pluginId(subModulesPath) == subModule) {
-            QPluginLoader pluginLoader(subModulesPath);
+            auto plugin = akElementGlobalStuff->pluginFactory(subModulesPath);
 
-            if (!pluginLoader.load()) {
-                qDebug() << QString("Error loading submodule '%1' for '%2' plugin: %3")
+            if (!plugin) {
+                qDebug() << QString("Error loading submodule '%1' for '%2' plugin")
                                 .arg(subModule)
-                                .arg(pluginId)
-                                .arg(pluginLoader.errorString());
+                                .arg(pluginId);
 
                 return nullptr;
             }
 
-            auto plugin = qobject_cast<AkPlugin *>(pluginLoader.instance());
-
-            if (!plugin)
-                return nullptr;
-
-            auto obj = plugin->create(AK_PLUGIN_TYPE_SUBMODULE, "");
-            delete plugin;
-
-            return obj;
+            return plugin->create(AK_PLUGIN_TYPE_SUBMODULE, "");
         }
     }
 
@@ -791,11 +1111,20 @@ QVariantMap AkElement::pluginInfo(const QString &pluginId)
     if (!akElementGlobalStuff->m_pluginsScanned)
         akElementGlobalStuff->listPlugins();
 
-    for (auto &pluginInfo: akElementGlobalStuff->m_pluginsList)
-        if (pluginInfo.m_id == pluginId)
-            return pluginInfo.m_metaData;
+    if (akElementGlobalStuff->m_pluginIndexOfId.isEmpty())
+        for (int i = 0; i < akElementGlobalStuff->m_pluginsList.size(); i++) {
+            auto &id = akElementGlobalStuff->m_pluginsList[i].m_id;
+
+            if (!akElementGlobalStuff->m_pluginIndexOfId.contains(id))
+                akElementGlobalStuff->m_pluginIndexOfId[id] = i;
+        }
+
+    int index = akElementGlobalStuff->m_pluginIndexOfId.value(pluginId, -1);
+
+    if (index < 0)
+        return QVariantMap();
 
-    return QVariantMap();
+    return akElementGlobalStuff->m_pluginsList[index].m_metaData;
 }
 
 void AkElement::setPluginInfo(const QString &path,
@@ -815,11 +1144,13 @@ void AkElement::setPluginInfo(const QString &path,
                    metaData,
                    false
                };
+    akElementGlobalStuff->m_pluginIndexOfId.clear();
 }
 
 void AkElement::clearCache()
 {
     akElementGlobalStuff->m_pluginsList.clear();
+    akElementGlobalStuff->m_pluginIndexOfId.clear();
     akElementGlobalStuff->m_pluginsScanned = false;
 }
 
@@ -838,6 +1169,136 @@ AkPacket AkElement::operator ()(const AkVideoPacket &packet)
     return this->iStream(packet);
 }
 
+/* CPU time of the calling thread. Attributes processor usage to the stage
+ * that actually ran, unlike wall time which also counts waits. */
+inline qint64 akThreadCpuNs()
+{
+#ifdef Q_OS_UNIX
+    struct timespec ts;
+
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0)
+        return qint64(ts.tv_sec) * 1000000000 + qint64(ts.tv_nsec);
+#endif
+
+    return 0;
+}
+
+void AkElement::send(const AkPacket &packet)
+{
+    if (AkWatchdog::instance()->active())
+        this->d->m_lastActivity.storeRelease(AkWatchdog::clockMs());
+
+    this->d->m_fastSinksMutex.lock();
+    auto fastSinks = this->d->m_fastSinks;
+    this->d->m_fastSinksMutex.unlock();
+
+    // Typed sinks only get the media types they declared.
+    quint32 typeBit = 1 << (packet.caps().type() + 1);
+
+    if (AkMetrics::instance()->enabled()) {
+        QElapsedTimer timer;
+
+        for (auto &sink: fastSinks) {
+            if (!(sink.typeMask & typeBit))
+                continue;
+
+            qint64 cpuStart = akThreadCpuNs();
+            timer.restart();
+            sink.element->iStream(packet);
+            AkMetrics::instance()->addSample(sink.element->d->stageName(sink.element),
+                                             timer.nsecsElapsed(),
+                                             akThreadCpuNs() - cpuStart);
+        }
+    } else {
+        for (auto &sink: fastSinks)
+            if (sink.typeMask & typeBit)
+                sink.element->iStream(packet);
+    }
+
+    emit this->oStream(packet);
+}
+
+bool AkElement::metricsEnabled()
+{
+    return AkMetrics::instance()->enabled();
+}
+
+void AkElement::setMetricsEnabled(bool enabled)
+{
+    AkMetrics::instance()->setEnabled(enabled);
+}
+
+QVariantMap AkElement::metrics()
+{
+    return AkMetrics::instance()->query();
+}
+
+quint8 *AkElement::scratchPlane(const QString &id,
+                                const QSize &size,
+                                size_t bytesPerPixel)
+{
+    QMutexLocker locker(&this->d->m_scratchMutex);
+    auto &plane = this->d->m_scratchPlanes[id];
+
+    if (plane.m_size != size || plane.m_bytesPerPixel != bytesPerPixel) {
+        if (plane.m_buffer)
+            AkBufferPool::globalPool()->release(plane.m_buffer);
+
+        size_t bytes = size_t(qMax(size.width(), 0))
+                       * size_t(qMax(size.height(), 0))
+                       * bytesPerPixel;
+        plane.m_buffer = AkBufferPool::globalPool()->acquire(bytes);
+        plane.m_size = size;
+        plane.m_bytesPerPixel = bytesPerPixel;
+
+        // Only touched on reallocation, so the gauge costs nothing in the
+        // steady state.
+        if (AkMetrics::instance()->enabled()) {
+            qint64 poolBytes = 0;
+
+            for (auto &scratchPlane: this->d->m_scratchPlanes)
+                poolBytes += qint64(qMax(scratchPlane.m_size.width(), 0))
+                             * qint64(qMax(scratchPlane.m_size.height(), 0))
+                             * qint64(scratchPlane.m_bytesPerPixel);
+
+            AkMetrics::instance()->setPoolBytes(this->d->stageName(this),
+                                                poolBytes);
+        }
+    }
+
+    return plane.m_buffer.writableData();
+}
+
+void AkElement::clearScratchPlanes()
+{
+    QMutexLocker locker(&this->d->m_scratchMutex);
+
+    for (auto &plane: this->d->m_scratchPlanes)
+        if (plane.m_buffer)
+            AkBufferPool::globalPool()->release(plane.m_buffer);
+
+    this->d->m_scratchPlanes.clear();
+}
+
+void AkElement::publishParameters(const QVariantMap &parameters)
+{
+    /* Build the new block aside and swap it in with a single atomic pointer
+     * exchange. Frames already holding the previous block keep reading it
+     * unharmed, it is released when the last reader drops its reference. */
+    std::atomic_store(&this->d->m_parameters,
+                      std::make_shared<const QVariantMap>(parameters));
+}
+
+QVariantMap AkElement::parametersSnapshot() const
+{
+    auto parameters = std::atomic_load(&this->d->m_parameters);
+
+    /* The returned map shallow-copies the immutable block, so the snapshot
+     * stays valid for the whole frame even if a setter publishes a new block
+     * meanwhile. */
+    return parameters? *parameters: QVariantMap();
+}
+
 QString AkElement::controlInterfaceProvide(const QString &controlId) const
 {
     Q_UNUSED(controlId)
@@ -860,10 +1321,14 @@ void AkElement::stateChange(AkElement::ElementState from, AkElement::ElementStat
 
 AkPacket AkElement::iStream(const AkPacket &packet)
 {
-    if (packet.caps().mimeType() == "audio/x-raw")
+    switch (packet.caps().type()) {
+    case AkCaps::CapsAudio:
         return this->iStream(AkAudioPacket(packet));
-    else if (packet.caps().mimeType() == "video/x-raw")
+    case AkCaps::CapsVideo:
         return this->iStream(AkVideoPacket(packet));
+    default:
+        break;
+    }
 
     return AkPacket();
 }
@@ -884,11 +1349,17 @@ AkPacket AkElement::iStream(const AkVideoPacket &packet)
 
 bool AkElement::setState(AkElement::ElementState state)
 {
-    if (this->d->m_state == state)
+    auto preState = ElementState(this->d->m_state.loadAcquire());
+
+    if (preState == state)
         return false;
 
-    ElementState preState = this->d->m_state;
-    this->d->m_state = state;
+    /* Claim the transition atomically; if another thread raced us here
+     * it already published its state and runs the notifications, and
+     * this call reports no change. The signals below stay out of the
+     * frame path, they only run in the thread driving the transition. */
+    if (!this->d->m_state.testAndSetRelease(preState, state))
+        return false;
 
     switch (preState) {
     case ElementStateNull: {
@@ -957,6 +1428,22 @@ void AkElement::resetState()
     this->setState(ElementStateNull);
 }
 
+void AkElement::setQuality(AkElement::QualityLevel quality)
+{
+    auto preQuality = QualityLevel(this->d->m_quality.loadAcquire());
+
+    if (preQuality == quality)
+        return;
+
+    this->d->m_quality.storeRelease(quality);
+    emit this->qualityChanged(quality);
+}
+
+void AkElement::resetQuality()
+{
+    this->setQuality(QualityFull);
+}
+
 QDataStream &operator >>(QDataStream &istream, AkElement::ElementState &state)
 {
     int stateInt;
@@ -23,10 +23,11 @@
 #include <QObject>
 
 #include "akcommons.h"
+#include "akcaps.h"
 
 #define akSend(packet) { \
     if (packet) \
-        emit this->oStream(packet); \
+        this->send(packet); \
     \
     return packet; \
 }
@@ -39,6 +40,7 @@ class AkVideoPacket;
 class QDataStream;
 class QQmlEngine;
 class QQmlContext;
+class QSize;
 
 typedef QSharedPointer<AkElement> AkElementPtr;
 
@@ -47,6 +49,7 @@ class AKCOMMONS_EXPORT AkElement: public QObject
 {
     Q_OBJECT
     Q_ENUMS(ElementState)
+    Q_ENUMS(QualityLevel)
     Q_PROPERTY(QString pluginId
                READ pluginId)
     Q_PROPERTY(QString pluginPath
@@ -56,6 +59,16 @@ class AKCOMMONS_EXPORT AkElement: public QObject
                WRITE setState
                RESET resetState
                NOTIFY stateChanged)
+    /* Graduated degradation hook for the load governor. Dropping an
+     * effect from the chain to shed load is a visible, binary change;
+     * quality aware effects instead answer the lower levels with a
+     * cheaper approximation of the same look. Elements that implement
+     * no approximation just keep rendering at full quality. */
+    Q_PROPERTY(AkElement::QualityLevel quality
+               READ quality
+               WRITE setQuality
+               RESET resetQuality
+               NOTIFY qualityChanged)
 
     public:
         enum ElementState
@@ -65,13 +78,32 @@ class AKCOMMONS_EXPORT AkElement: public QObject
             ElementStatePlaying
         };
 
+        enum QualityLevel
+        {
+            // The reference output, whatever it costs.
+            QualityFull,
+            // Mild approximations nobody notices on a moving image.
+            QualityBalanced,
+            // Whatever keeps the frame rate, artifacts are acceptable.
+            QualityFast
+        };
+
         explicit AkElement(QObject *parent=nullptr);
         virtual ~AkElement();
 
         Q_INVOKABLE QString pluginId() const;
         Q_INVOKABLE static QString pluginId(const QString &path);
         Q_INVOKABLE QString pluginPath() const;
+        /* Lock-free and safe to call from the packet path; pairs with the
+         * atomic transition in setState(). */
         Q_INVOKABLE virtual AkElement::ElementState state() const;
+        // Lock-free as well, effects read it on every frame.
+        Q_INVOKABLE AkElement::QualityLevel quality() const;
+
+        /* Heartbeat for AkWatchdog: timestamp (AkWatchdog::clockMs()) of the
+         * last packet this element delivered downstream, -1 if none yet.
+         * Only refreshed while the watchdog is active. */
+        Q_INVOKABLE qint64 lastActivity() const;
         Q_INVOKABLE virtual QObject *controlInterface(QQmlEngine *engine,
                                                       const QString &controlId) const;
 
@@ -84,6 +116,21 @@ class AKCOMMONS_EXPORT AkElement: public QObject
         Q_INVOKABLE virtual bool unlink(const QObject *dstElement) const;
         Q_INVOKABLE virtual bool unlink(const AkElementPtr &dstElement) const;
 
+        /* Caps negotiation hook for whoever owns the chain. The returned
+         * list holds the AkVideoCaps::PixelFormat values the element can
+         * consume without a conversion, in preference order. The default
+         * empty list means the element only takes the pipeline's ARGB
+         * frames, so the owner keeps a conversion stage in front of it. */
+        Q_INVOKABLE virtual QVariantList preferredPixelFormats() const;
+
+        /* Typed link negotiation. Elements that only consume one media
+         * type declare it here and the link layer routes packets of any
+         * other type past them, instead of delivering every packet to
+         * every sink and letting each one reject the wrong types per
+         * packet. The default empty list means untyped: the element
+         * receives everything, as before. */
+        Q_INVOKABLE virtual QList<AkCaps::CapsType> acceptedMediaTypes() const;
+
         Q_INVOKABLE static bool link(const AkElementPtr &srcElement,
                                      const QObject *dstElement,
                                      Qt::ConnectionType connectionType=Qt::AutoConnection);
@@ -132,6 +179,13 @@ class AKCOMMONS_EXPORT AkElement: public QObject
                                               const QVariantMap &metaData);
         Q_INVOKABLE static void clearCache();
 
+        /* Pipeline instrumentation. When enabled, per-element frame latency
+         * histograms and drop counts are aggregated by AkMetrics and can be
+         * queried live while the pipeline runs. */
+        Q_INVOKABLE static bool metricsEnabled();
+        Q_INVOKABLE static void setMetricsEnabled(bool enabled);
+        Q_INVOKABLE static QVariantMap metrics();
+
         virtual AkPacket operator ()(const AkPacket &packet);
         virtual AkPacket operator ()(const AkAudioPacket &packet);
         virtual AkPacket operator ()(const AkVideoPacket &packet);
@@ -140,6 +194,41 @@ class AKCOMMONS_EXPORT AkElement: public QObject
         AkElementPrivate *d;
 
     protected:
+        /* Deliver a packet downstream.
+         *
+         * Same thread element to element links resolved by link() are called
+         * directly, skipping the QMetaObject dispatch; every other receiver
+         * is reached through the oStream() signal as before.
+         */
+        void send(const AkPacket &packet);
+
+        /* Geometry keyed scratch planes for per-frame intermediates.
+         *
+         * Effects that need temporary planes (edge maps, integral images,
+         * blur scratch) request them here instead of allocating inside
+         * iStream(). A plane is reused for as long as the same id is
+         * requested with the same geometry, and reallocated transparently
+         * when the stream renegotiates to a new size, so the steady state
+         * does no allocations. Thread-safe; the returned pointer stays
+         * valid until the next request for the same id or
+         * clearScratchPlanes().
+         */
+        quint8 *scratchPlane(const QString &id,
+                             const QSize &size,
+                             size_t bytesPerPixel=1);
+        void clearScratchPlanes();
+
+        /* Lock-free parameter snapshots.
+         *
+         * Property setters publish an immutable copy of the element
+         * parameters with publishParameters(), and iStream() reads one
+         * coherent block per frame with parametersSnapshot(). The block is
+         * swapped in with an atomic pointer exchange, so a frame never sees
+         * a half-updated parameter set and the frame path takes no locks.
+         */
+        void publishParameters(const QVariantMap &parameters);
+        QVariantMap parametersSnapshot() const;
+
         virtual QString controlInterfaceProvide(const QString &controlId) const;
         virtual void controlInterfaceConfigure(QQmlContext *context,
                                                const QString &controlId) const;
@@ -147,6 +236,7 @@ class AKCOMMONS_EXPORT AkElement: public QObject
 
     Q_SIGNALS:
         void stateChanged(AkElement::ElementState state);
+        void qualityChanged(AkElement::QualityLevel quality);
         void oStream(const AkPacket &packet);
 
     public Q_SLOTS:
@@ -155,10 +245,13 @@ class AKCOMMONS_EXPORT AkElement: public QObject
         virtual AkPacket iStream(const AkVideoPacket &packet);
         virtual bool setState(AkElement::ElementState state);
         virtual void resetState();
+        virtual void setQuality(AkElement::QualityLevel quality);
+        void resetQuality();
 };
 
 QDataStream &operator >>(QDataStream &istream, AkElement::ElementState &state);
 QDataStream &operator <<(QDataStream &ostream, AkElement::ElementState state);
 Q_DECLARE_METATYPE(AkElement::ElementState)
+Q_DECLARE_METATYPE(AkElement::QualityLevel)
 
 #endif // AKELEMENT_H
@@ -0,0 +1,178 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QCoreApplication>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+#include <QVariant>
+#include <iostream>
+#include <string>
+
+#include "akelementworker.h"
+#include "akshmchannel.h"
+
+/* Frames read from the input channel run through the hosted element in
+ * this thread, the same way a direct-linked pipeline processes in the
+ * producer's thread.
+ */
+class AkElementWorkerStream: public QThread
+{
+    public:
+        AkElementWorkerStream(AkShmChannel *channel,
+                              const AkElementPtr &element,
+                              QObject *parent=nullptr):
+            QThread(parent),
+            m_channel(channel),
+            m_element(element)
+        {
+        }
+
+        void run()
+        {
+            forever {
+                auto packet = this->m_channel->readPacket();
+
+                if (!packet)
+                    break;
+
+                this->m_element->iStream(packet);
+            }
+        }
+
+    private:
+        AkShmChannel *m_channel;
+        AkElementPtr m_element;
+};
+
+/* Property assignments arrive as JSON lines on standard input; end of
+ * file means the supervisor is gone and the worker exits with it.
+ */
+class AkElementWorkerControl: public QThread
+{
+    public:
+        AkElementWorkerControl(const AkElementPtr &element,
+                               QObject *parent=nullptr):
+            QThread(parent),
+            m_element(element)
+        {
+        }
+
+        void run()
+        {
+            std::string line;
+
+            while (std::getline(std::cin, line)) {
+                auto document =
+                        QJsonDocument::fromJson(QByteArray(line.c_str(),
+                                                           int(line.size())));
+
+                if (!document.isObject())
+                    continue;
+
+                auto object = document.object();
+
+                for (auto it = object.begin(); it != object.end(); it++)
+                    this->m_element->setProperty(it.key().toStdString().c_str(),
+                                                 it.value().toVariant());
+            }
+
+            QCoreApplication::quit();
+        }
+
+    private:
+        AkElementPtr m_element;
+};
+
+class AkElementWorkerPrivate
+{
+    public:
+        QString m_pluginId;
+        AkElementPtr m_element;
+        AkShmChannel *m_inChannel;
+        AkShmChannel *m_outChannel;
+        AkElementWorkerStream *m_stream;
+        AkElementWorkerControl *m_control;
+
+        AkElementWorkerPrivate():
+            m_inChannel(nullptr),
+            m_outChannel(nullptr),
+            m_stream(nullptr),
+            m_control(nullptr)
+        {
+        }
+};
+
+AkElementWorker::AkElementWorker(const QString &pluginId,
+                                 const QString &inChannel,
+                                 const QString &outChannel,
+                                 QObject *parent):
+    QObject(parent)
+{
+    this->d = new AkElementWorkerPrivate;
+    this->d->m_pluginId = pluginId;
+    this->d->m_inChannel = new AkShmChannel(inChannel, this);
+    this->d->m_outChannel = new AkShmChannel(outChannel, this);
+}
+
+AkElementWorker::~AkElementWorker()
+{
+    if (this->d->m_element)
+        this->d->m_element->setState(AkElement::ElementStateNull);
+
+    this->d->m_inChannel->stop();
+
+    if (this->d->m_stream)
+        this->d->m_stream->wait();
+
+    delete this->d;
+}
+
+bool AkElementWorker::start()
+{
+    this->d->m_element = AkElement::create(this->d->m_pluginId);
+
+    if (!this->d->m_element)
+        return false;
+
+    if (!this->d->m_inChannel->attach()
+        || !this->d->m_outChannel->attach())
+        return false;
+
+    auto outChannel = this->d->m_outChannel;
+    QObject::connect(this->d->m_element.data(),
+                     &AkElement::oStream,
+                     this,
+                     [outChannel] (const AkPacket &packet) {
+                         outChannel->writePacket(packet);
+                     },
+                     Qt::DirectConnection);
+
+    this->d->m_element->setState(AkElement::ElementStatePlaying);
+    this->d->m_stream = new AkElementWorkerStream(this->d->m_inChannel,
+                                                  this->d->m_element,
+                                                  this);
+    this->d->m_stream->start();
+    this->d->m_control = new AkElementWorkerControl(this->d->m_element, this);
+    this->d->m_control->start();
+
+    return true;
+}
+
+#include "moc_akelementworker.cpp"
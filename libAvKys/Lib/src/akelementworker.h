@@ -0,0 +1,52 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef AKELEMENTWORKER_H
+#define AKELEMENTWORKER_H
+
+#include "akelement.h"
+
+class AkElementWorkerPrivate;
+
+/* Worker-process side of AkRemoteElement.
+ *
+ * Hosts one plugin element: frames read from the input channel run
+ * through it, its output goes back over the output channel, and property
+ * assignments arrive as JSON lines on standard input. The host exits
+ * when the input channel goes away, the supervising proxy owns the
+ * lifecycle.
+ */
+class AKCOMMONS_EXPORT AkElementWorker: public QObject
+{
+    Q_OBJECT
+
+    public:
+        AkElementWorker(const QString &pluginId,
+                        const QString &inChannel,
+                        const QString &outChannel,
+                        QObject *parent=nullptr);
+        ~AkElementWorker();
+
+        Q_INVOKABLE bool start();
+
+    private:
+        AkElementWorkerPrivate *d;
+};
+
+#endif // AKELEMENTWORKER_H
@@ -19,6 +19,7 @@
 
 #include <QDataStream>
 #include <QDebug>
+#include <qnumeric.h>
 #include <QRegExp>
 #include <QStringList>
 
@@ -29,10 +30,6 @@
 class AkFracPrivate
 {
     public:
-        qint64 m_num;
-        qint64 m_den;
-        bool m_isValid;
-
         static inline qint64 gcd(qint64 num, qint64 den)
         {
             num = qAbs(num);
@@ -59,56 +56,54 @@ class AkFracPrivate
 };
 
 AkFrac::AkFrac(QObject *parent):
-    QObject(parent)
+    QObject(parent),
+    m_num(0),
+    m_den(0),
+    m_value(qQNaN()),
+    m_isValid(false)
 {
-    this->d = new AkFracPrivate();
-    this->d->m_num = 0;
-    this->d->m_den = 0;
-    this->d->m_isValid = false;
 }
 
 AkFrac::AkFrac(qint64 num, qint64 den):
-    QObject(nullptr)
+    QObject(nullptr),
+    m_num(0),
+    m_den(0),
+    m_value(qQNaN()),
+    m_isValid(false)
 {
-    this->d = new AkFracPrivate();
-    this->d->m_num = 0;
-    this->d->m_den = 0;
-    this->d->m_isValid = false;
-
     this->setNumDen(num, den);
 }
 
 AkFrac::AkFrac(const QString &fracString):
-    QObject(nullptr)
+    QObject(nullptr),
+    m_num(0),
+    m_den(0),
+    m_value(qQNaN()),
+    m_isValid(false)
 {
-    this->d = new AkFracPrivate();
-    this->d->m_num = 0;
-    this->d->m_den = 0;
-    this->d->m_isValid = false;
-
     this->setNumDen(fracString);
 }
 
 AkFrac::AkFrac(const AkFrac &other):
-    QObject()
+    QObject(),
+    m_num(other.m_num),
+    m_den(other.m_den),
+    m_value(other.m_value),
+    m_isValid(other.m_isValid)
 {
-    this->d = new AkFracPrivate();
-    this->d->m_num = other.d->m_num;
-    this->d->m_den = other.d->m_den;
-    this->d->m_isValid = other.d->m_isValid;
 }
 
 AkFrac::~AkFrac()
 {
-    delete this->d;
 }
 
 AkFrac &AkFrac::operator =(const AkFrac &other)
 {
     if (this != &other) {
-        this->d->m_num = other.d->m_num;
-        this->d->m_den = other.d->m_den;
-        this->d->m_isValid = other.d->m_isValid;
+        this->m_num = other.m_num;
+        this->m_den = other.m_den;
+        this->m_value = other.m_value;
+        this->m_isValid = other.m_isValid;
     }
 
     return *this;
@@ -116,7 +111,10 @@ AkFrac &AkFrac::operator =(const AkFrac &other)
 
 bool AkFrac::operator ==(const AkFrac &other) const
 {
-    return this->toString() == other.toString();
+    // Both sides are kept reduced with the sign on the numerator, so the
+    // integer comparison is exact.
+    return this->m_num == other.m_num
+           && this->m_den == other.m_den;
 }
 
 bool AkFrac::operator !=(const AkFrac &other) const
@@ -126,46 +124,46 @@ bool AkFrac::operator !=(const AkFrac &other) const
 
 AkFrac AkFrac::operator *(const AkFrac &other) const
 {
-    return AkFrac(this->d->m_num * other.d->m_num,
-                  this->d->m_den * other.d->m_den);
+    return AkFrac(this->m_num * other.m_num,
+                  this->m_den * other.m_den);
 }
 
 qint64 AkFrac::num() const
 {
-    return this->d->m_num;
+    return this->m_num;
 }
 
 qint64 AkFrac::den() const
 {
-    return this->d->m_den;
+    return this->m_den;
 }
 
 qreal AkFrac::value() const
 {
-    return this->d->m_num / qreal(this->d->m_den);
+    return this->m_value;
 }
 
 qint64 AkFrac::fastValue() const
 {
-    return this->d->m_num / this->d->m_den;
+    return this->m_num / this->m_den;
 }
 
 bool AkFrac::isValid() const
 {
-    return this->d->m_isValid;
+    return this->m_isValid;
 }
 
 QString AkFrac::toString() const
 {
     return QString("%1/%2")
-            .arg(this->d->m_num)
-            .arg(this->d->m_den);
+            .arg(this->m_num)
+            .arg(this->m_den);
 }
 
 AkFrac AkFrac::invert() const
 {
-    return AkFrac(this->d->m_den,
-                  this->d->m_num);
+    return AkFrac(this->m_den,
+                  this->m_num);
 }
 
 void AkFrac::setNumDen(qint64 num, qint64 den)
@@ -173,28 +171,30 @@ void AkFrac::setNumDen(qint64 num, qint64 den)
     bool changed = false;
 
     if (!den) {
-        if (this->d->m_num != 0) {
-            this->d->m_num = 0;
+        if (this->m_num != 0) {
+            this->m_num = 0;
             changed = true;
 
             emit this->numChanged();
         }
 
-        if (this->d->m_den != 0) {
-            this->d->m_den = 0;
+        if (this->m_den != 0) {
+            this->m_den = 0;
             changed = true;
 
             emit this->denChanged();
         }
 
-        if (this->d->m_isValid != false) {
-            this->d->m_isValid = false;
+        if (this->m_isValid != false) {
+            this->m_isValid = false;
             changed = true;
 
             emit this->isValidChanged();
         }
 
         if (changed) {
+            this->m_value = qQNaN();
+
             emit this->valueChanged();
             emit this->stringChanged();
         }
@@ -206,28 +206,30 @@ void AkFrac::setNumDen(qint64 num, qint64 den)
     den = qAbs(den);
     AkFracPrivate::reduce(&num, &den);
 
-    if (this->d->m_num != num) {
-        this->d->m_num = num;
+    if (this->m_num != num) {
+        this->m_num = num;
         changed = true;
 
         emit this->numChanged();
     }
 
-    if (this->d->m_den != den) {
-        this->d->m_den = den;
+    if (this->m_den != den) {
+        this->m_den = den;
         changed = true;
 
         emit this->denChanged();
     }
 
-    if (this->d->m_isValid != true) {
-        this->d->m_isValid = true;
+    if (this->m_isValid != true) {
+        this->m_isValid = true;
         changed = true;
 
         emit this->isValidChanged();
     }
 
     if (changed) {
+        this->m_value = num / qreal(den);
+
         emit this->valueChanged();
         emit this->stringChanged();
     }
@@ -256,12 +258,12 @@ void AkFrac::setNumDen(const QString &fracString)
 
 void AkFrac::setNum(qint64 num)
 {
-    this->setNumDen(num, this->d->m_den);
+    this->setNumDen(num, this->m_den);
 }
 
 void AkFrac::setDen(qint64 den)
 {
-    this->setNumDen(this->d->m_num, den);
+    this->setNumDen(this->m_num, den);
 }
 
 void AkFrac::resetNum()
@@ -283,25 +285,26 @@ QDebug operator <<(QDebug debug, const AkFrac &frac)
 
 QDataStream &operator >>(QDataStream &istream, AkFrac &frac)
 {
-    istream >> frac.d->m_num;
-    istream >> frac.d->m_den;
-    istream >> frac.d->m_isValid;
+    istream >> frac.m_num;
+    istream >> frac.m_den;
+    istream >> frac.m_isValid;
+    frac.m_value = frac.m_num / qreal(frac.m_den);
 
     return istream;
 }
 
 QDataStream &operator <<(QDataStream &ostream, const AkFrac &frac)
 {
-    ostream << frac.d->m_num;
-    ostream << frac.d->m_den;
-    ostream << frac.d->m_isValid;
+    ostream << frac.m_num;
+    ostream << frac.m_den;
+    ostream << frac.m_isValid;
 
     return ostream;
 }
 
 AkFrac operator *(int number, const AkFrac &frac)
 {
-    return AkFrac(number * frac.d->m_num, frac.d->m_den);
+    return AkFrac(number * frac.m_num, frac.m_den);
 }
 
 AkFrac operator /(int number, const AkFrac &frac)
@@ -312,22 +315,22 @@ AkFrac operator /(int number, const AkFrac &frac)
 
 AkFrac operator /(const AkFrac &fracNum, const AkFrac &fracDen)
 {
-    return AkFrac(fracNum.d->m_num * fracDen.d->m_den,
-                  fracNum.d->m_den * fracDen.d->m_num);
+    return AkFrac(fracNum.m_num * fracDen.m_den,
+                  fracNum.m_den * fracDen.m_num);
 }
 
 AkFrac operator +(const AkFrac &frac1, const AkFrac &frac2)
 {
-    return AkFrac(frac1.d->m_num * frac2.d->m_den
-                  + frac2.d->m_num * frac1.d->m_den,
-                  frac1.d->m_den * frac2.d->m_den);
+    return AkFrac(frac1.m_num * frac2.m_den
+                  + frac2.m_num * frac1.m_den,
+                  frac1.m_den * frac2.m_den);
 }
 
 AkFrac operator -(const AkFrac &frac1, const AkFrac &frac2)
 {
-    return AkFrac(frac1.d->m_num * frac2.d->m_den
-                  - frac2.d->m_num * frac1.d->m_den,
-                  frac1.d->m_den * frac2.d->m_den);
+    return AkFrac(frac1.m_num * frac2.m_den
+                  - frac2.m_num * frac1.m_den,
+                  frac1.m_den * frac2.m_den);
 }
 
 #include "moc_akfrac.cpp"
@@ -24,7 +24,6 @@
 
 #include "akcommons.h"
 
-class AkFracPrivate;
 class QDataStream;
 
 class AKCOMMONS_EXPORT AkFrac: public QObject
@@ -70,7 +69,12 @@ class AKCOMMONS_EXPORT AkFrac: public QObject
         Q_INVOKABLE AkFrac invert() const;
 
     private:
-        AkFracPrivate *d;
+        // Inline storage, always kept reduced, with the fraction value cached
+        // as double for the per-packet timestamp math.
+        qint64 m_num;
+        qint64 m_den;
+        qreal m_value;
+        bool m_isValid;
 
     Q_SIGNALS:
         void numChanged();
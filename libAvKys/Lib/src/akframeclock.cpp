@@ -0,0 +1,198 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QElapsedTimer>
+#include <QMap>
+#include <QMutex>
+#include <QPointer>
+#include <QTimer>
+#include <QtMath>
+#include <limits>
+
+#include "akframeclock.h"
+#include "akfrac.h"
+
+struct AkFrameClockSubscription
+{
+    QPointer<QObject> receiver;
+    QByteArray member;
+    qreal periodMs {0.0};
+    qreal dueMs {0.0};
+};
+
+class AkFrameClockPrivate
+{
+    public:
+        AkFrameClock *self;
+        QTimer m_timer;
+        QElapsedTimer m_clock;
+        QMutex m_mutex;
+        QMap<qint64, AkFrameClockSubscription> m_subscriptions;
+        qint64 m_nextId {0};
+
+        AkFrameClockPrivate(AkFrameClock *self):
+            self(self)
+        {
+        }
+
+        inline void tick();
+        inline void rearm();
+};
+
+Q_GLOBAL_STATIC(AkFrameClock, akFrameClockGlobal)
+
+AkFrameClock::AkFrameClock(QObject *parent):
+    QObject(parent)
+{
+    this->d = new AkFrameClockPrivate(this);
+    this->d->m_clock.start();
+    this->d->m_timer.setSingleShot(true);
+    this->d->m_timer.setTimerType(Qt::PreciseTimer);
+
+    QObject::connect(&this->d->m_timer,
+                     &QTimer::timeout,
+                     [this] () {
+                         this->d->tick();
+                     });
+}
+
+AkFrameClock::~AkFrameClock()
+{
+    this->d->m_timer.stop();
+    delete this->d;
+}
+
+qint64 AkFrameClock::subscribe(QObject *receiver,
+                               const char *member,
+                               const AkFrac &fps)
+{
+    if (!receiver || fps.value() <= 0.0)
+        return -1;
+
+    QMutexLocker locker(&this->d->m_mutex);
+    AkFrameClockSubscription subscription;
+    subscription.receiver = receiver;
+    subscription.member = member;
+    subscription.periodMs = 1.e3 * fps.invert().value();
+
+    /* Align the first due time to a multiple of the period from the clock
+     * origin, so subscribers at the same rate coincide in one wakeup. */
+    auto now = qreal(this->d->m_clock.nsecsElapsed()) / 1e6;
+    subscription.dueMs = qCeil(now / subscription.periodMs)
+                         * subscription.periodMs;
+
+    auto id = this->d->m_nextId++;
+    this->d->m_subscriptions[id] = subscription;
+    locker.unlock();
+
+    // Rearm from the clock's own thread.
+    QTimer::singleShot(0, &this->d->m_timer, [this] () {
+        this->d->rearm();
+    });
+
+    return id;
+}
+
+void AkFrameClock::setRate(qint64 subscription, const AkFrac &fps)
+{
+    if (fps.value() <= 0.0)
+        return;
+
+    QMutexLocker locker(&this->d->m_mutex);
+
+    if (!this->d->m_subscriptions.contains(subscription))
+        return;
+
+    auto &sub = this->d->m_subscriptions[subscription];
+    sub.periodMs = 1.e3 * fps.invert().value();
+    auto now = qreal(this->d->m_clock.nsecsElapsed()) / 1e6;
+    sub.dueMs = qCeil(now / sub.periodMs) * sub.periodMs;
+    locker.unlock();
+
+    QTimer::singleShot(0, &this->d->m_timer, [this] () {
+        this->d->rearm();
+    });
+}
+
+void AkFrameClock::unsubscribe(qint64 subscription)
+{
+    QMutexLocker locker(&this->d->m_mutex);
+    this->d->m_subscriptions.remove(subscription);
+}
+
+AkFrameClock *AkFrameClock::globalClock()
+{
+    return akFrameClockGlobal;
+}
+
+void AkFrameClockPrivate::tick()
+{
+    QMutexLocker locker(&this->m_mutex);
+    auto now = qreal(this->m_clock.nsecsElapsed()) / 1e6;
+
+    for (auto it = this->m_subscriptions.begin();
+         it != this->m_subscriptions.end();) {
+        if (!it->receiver) {
+            it = this->m_subscriptions.erase(it);
+
+            continue;
+        }
+
+        if (it->dueMs <= now + 0.5) {
+            QMetaObject::invokeMethod(it->receiver,
+                                      it->member.constData(),
+                                      Qt::QueuedConnection);
+
+            /* Next multiple of the period. A subscriber that fell behind
+             * skips the missed periods instead of bursting. */
+            it->dueMs += it->periodMs;
+
+            if (it->dueMs <= now)
+                it->dueMs = (qFloor(now / it->periodMs) + 1)
+                            * it->periodMs;
+        }
+
+        it++;
+    }
+
+    locker.unlock();
+    this->rearm();
+}
+
+void AkFrameClockPrivate::rearm()
+{
+    // One timer armed for the earliest pending subscriber.
+    QMutexLocker locker(&this->m_mutex);
+
+    if (this->m_subscriptions.isEmpty()) {
+        this->m_timer.stop();
+
+        return;
+    }
+
+    auto now = qreal(this->m_clock.nsecsElapsed()) / 1e6;
+    qreal earliest = std::numeric_limits<qreal>::max();
+
+    for (auto &subscription: this->m_subscriptions)
+        earliest = qMin(earliest, subscription.dueMs);
+
+    this->m_timer.start(qMax(0, qCeil(earliest - now)));
+}
+
+#include "moc_akframeclock.cpp"
@@ -0,0 +1,68 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef AKFRAMECLOCK_H
+#define AKFRAMECLOCK_H
+
+#include <QObject>
+
+#include "akcommons.h"
+
+class AkFrameClockPrivate;
+class AkFrac;
+
+/* Shared tick source for everything that runs at frame rate.
+ *
+ * Every capture and generator element used to arm its own QTimer, so an
+ * idle pipeline woke the CPU once per element per period and kept it out
+ * of its sleep states. The frame clock keeps one timer armed for the
+ * earliest pending subscriber; due times are phase-aligned to multiples
+ * of each subscriber's period from a common origin, so subscribers at the
+ * same rate are served by the same wakeup.
+ *
+ * The callback is invoked as a queued slot on the receiver's thread, the
+ * same semantics a QTimer in the receiver's thread had. A subscriber that
+ * falls behind skips to its next period instead of bursting.
+ */
+class AKCOMMONS_EXPORT AkFrameClock: public QObject
+{
+    Q_OBJECT
+
+    public:
+        explicit AkFrameClock(QObject *parent=nullptr);
+        ~AkFrameClock();
+
+        /* Invoke the 'member' slot of 'receiver' at 'fps' until
+         * unsubscribed. The member is the bare slot name, as taken by
+         * QMetaObject::invokeMethod. Returns the subscription id. */
+        qint64 subscribe(QObject *receiver,
+                         const char *member,
+                         const AkFrac &fps);
+        void setRate(qint64 subscription, const AkFrac &fps);
+        void unsubscribe(qint64 subscription);
+
+        static AkFrameClock *globalClock();
+
+    private:
+        AkFrameClockPrivate *d;
+
+        friend class AkFrameClockPrivate;
+};
+
+#endif // AKFRAMECLOCK_H
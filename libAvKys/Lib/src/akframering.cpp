@@ -0,0 +1,126 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QVector>
+#include <cstring>
+
+#include "akframering.h"
+
+class AkFrameRingPrivate
+{
+    public:
+        QVector<QImage> m_slots;
+
+        // Index of the oldest stored frame.
+        int m_start;
+        int m_size;
+
+        AkFrameRingPrivate():
+            m_start(0),
+            m_size(0)
+        {
+        }
+};
+
+AkFrameRing::AkFrameRing()
+{
+    this->d = new AkFrameRingPrivate;
+}
+
+AkFrameRing::AkFrameRing(const AkFrameRing &other)
+{
+    this->d = new AkFrameRingPrivate(*other.d);
+}
+
+AkFrameRing::~AkFrameRing()
+{
+    delete this->d;
+}
+
+AkFrameRing &AkFrameRing::operator =(const AkFrameRing &other)
+{
+    if (this != &other)
+        *this->d = *other.d;
+
+    return *this;
+}
+
+int AkFrameRing::size() const
+{
+    return this->d->m_size;
+}
+
+int AkFrameRing::capacity() const
+{
+    return this->d->m_slots.size();
+}
+
+void AkFrameRing::resize(int capacity,
+                         const QSize &frameSize,
+                         QImage::Format format)
+{
+    capacity = qMax(capacity, 1);
+
+    if (capacity == this->d->m_slots.size()
+        && !this->d->m_slots.isEmpty()
+        && this->d->m_slots.first().size() == frameSize
+        && this->d->m_slots.first().format() == format)
+        return;
+
+    this->d->m_slots.resize(capacity);
+
+    for (int i = 0; i < capacity; i++)
+        this->d->m_slots[i] = QImage(frameSize, format);
+
+    this->d->m_start = 0;
+    this->d->m_size = 0;
+}
+
+void AkFrameRing::push(const QImage &frame)
+{
+    if (this->d->m_slots.isEmpty())
+        return;
+
+    int capacity = this->d->m_slots.size();
+    int slot = (this->d->m_start + this->d->m_size) % capacity;
+
+    if (this->d->m_size == capacity) {
+        slot = this->d->m_start;
+        this->d->m_start = (this->d->m_start + 1) % capacity;
+    } else {
+        this->d->m_size++;
+    }
+
+    QImage &dst = this->d->m_slots[slot];
+    memcpy(dst.bits(),
+           frame.constBits(),
+           size_t(dst.bytesPerLine()) * size_t(dst.height()));
+}
+
+const QImage &AkFrameRing::at(int i) const
+{
+    return this->d->m_slots[(this->d->m_start + i)
+                            % this->d->m_slots.size()];
+}
+
+void AkFrameRing::clear()
+{
+    this->d->m_start = 0;
+    this->d->m_size = 0;
+}
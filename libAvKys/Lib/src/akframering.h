@@ -0,0 +1,62 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef AKFRAMERING_H
+#define AKFRAMERING_H
+
+#include <QImage>
+
+#include "akcommons.h"
+
+class AkFrameRingPrivate;
+
+/* Fixed ring of preallocated frames for the effects that keep a history.
+ *
+ * The history effects used to append copies to a list and pop the front as
+ * frames aged, reallocating full frames at stream rate. The ring allocates
+ * its slots once per (capacity, geometry) combination and pushing a frame
+ * just copies the pixels into the oldest slot, so the steady state does no
+ * heap allocations.
+ */
+class AKCOMMONS_EXPORT AkFrameRing
+{
+    public:
+        AkFrameRing();
+        AkFrameRing(const AkFrameRing &other);
+        ~AkFrameRing();
+        AkFrameRing &operator =(const AkFrameRing &other);
+
+        int size() const;
+        int capacity() const;
+
+        /* Reallocate the slots for 'capacity' frames of the given geometry.
+         * Keeps the stored frames when nothing changed, drops them otherwise.
+         */
+        void resize(int capacity, const QSize &frameSize, QImage::Format format);
+        // Copy 'frame' into the ring, evicting the oldest frame when full.
+        void push(const QImage &frame);
+        // Stored frames from the oldest at 0 to the newest at size() - 1.
+        const QImage &at(int i) const;
+        void clear();
+
+    private:
+        AkFrameRingPrivate *d;
+};
+
+#endif // AKFRAMERING_H
@@ -0,0 +1,349 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QAtomicInteger>
+#include <QAtomicPointer>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QStringList>
+#include <QThread>
+#include <QVector>
+#include <cstdio>
+
+#include "aklog.h"
+
+#define MAX_CATEGORIES 64
+
+// Records per thread. A power of two, the indexes wrap by masking.
+#define RING_SIZE 2048
+
+#define DRAIN_INTERVAL_MSECS 10
+
+struct AkLogRecord
+{
+    qint64 timeNs;
+    const char *format;
+    qint64 args[4];
+    quint16 category;
+    quint8 level;
+};
+
+/* One ring per writing thread, so the hot path never contends. The owning
+ * thread is the only producer and the drain thread the only consumer,
+ * which makes a plain acquire/release ring enough. Rings are linked into
+ * a global list the first time a thread writes and are never unlinked,
+ * the ring of a finished thread just stays empty. */
+struct AkLogRing
+{
+    AkLogRecord records[RING_SIZE];
+    QAtomicInteger<quint32> head;
+    QAtomicInteger<quint32> tail;
+    QAtomicInteger<quint32> dropped;
+    AkLogRing *next {nullptr};
+};
+
+static QAtomicPointer<AkLogRing> akLogRings;
+static thread_local AkLogRing *akLogThreadRing = nullptr;
+
+static QAtomicInt akLogLevels[MAX_CATEGORIES];
+static QElapsedTimer akLogClock;
+static qint64 akLogEpochMs;
+
+class AkLogPrivate
+{
+    public:
+        QMutex m_mutex;
+        QVector<QByteArray> m_categories;
+        FILE *m_output {stderr};
+        bool m_quit {false};
+        QThread *m_drainThread {nullptr};
+
+        inline AkLogRing *acquireRing();
+        inline bool drainRings();
+        inline void printRecord(const AkLogRecord &record, quint32 dropped);
+};
+
+Q_GLOBAL_STATIC(AkLog, akLogGlobal)
+
+class AkLogDrainThread: public QThread
+{
+    public:
+        AkLogDrainThread(AkLogPrivate *d):
+            d(d)
+        {
+        }
+
+        void run()
+        {
+            while (!this->d->m_quit) {
+                this->d->drainRings();
+                QThread::msleep(DRAIN_INTERVAL_MSECS);
+            }
+
+            // Print what the writers managed to record before the stop.
+            this->d->drainRings();
+        }
+
+    private:
+        AkLogPrivate *d;
+};
+
+AkLog::AkLog(QObject *parent):
+    QObject(parent)
+{
+    this->d = new AkLogPrivate;
+    this->d->m_drainThread = new AkLogDrainThread(this->d);
+    this->d->m_drainThread->start();
+}
+
+AkLog::~AkLog()
+{
+    this->d->m_quit = true;
+    this->d->m_drainThread->wait();
+    delete this->d->m_drainThread;
+
+    if (this->d->m_output != stderr)
+        fclose(this->d->m_output);
+
+    delete this->d;
+}
+
+int AkLog::registerCategory(const char *name, Level level)
+{
+    auto self = AkLog::instance();
+    QMutexLocker locker(&self->d->m_mutex);
+
+    if (!akLogClock.isValid()) {
+        akLogEpochMs = QDateTime::currentMSecsSinceEpoch();
+        akLogClock.start();
+    }
+
+    int category = self->d->m_categories.indexOf(name);
+
+    if (category >= 0)
+        return category;
+
+    if (self->d->m_categories.size() >= MAX_CATEGORIES)
+        return -1;
+
+    category = self->d->m_categories.size();
+    self->d->m_categories << QByteArray(name);
+    akLogLevels[category].store(level);
+
+    return category;
+}
+
+bool AkLog::enabled(int category, Level level)
+{
+    return category >= 0
+           && level >= akLogLevels[category].load();
+}
+
+void AkLog::write(int category,
+                  Level level,
+                  const char *format,
+                  qint64 arg0,
+                  qint64 arg1,
+                  qint64 arg2,
+                  qint64 arg3)
+{
+    if (!AkLog::enabled(category, level))
+        return;
+
+    auto ring = akLogThreadRing;
+
+    if (!ring)
+        ring = akLogThreadRing = AkLog::instance()->d->acquireRing();
+
+    auto head = ring->head.load();
+
+    if (head - ring->tail.loadAcquire() >= RING_SIZE) {
+        ring->dropped.ref();
+
+        return;
+    }
+
+    auto &record = ring->records[head & (RING_SIZE - 1)];
+    record.timeNs = akLogClock.nsecsElapsed();
+    record.format = format;
+    record.args[0] = arg0;
+    record.args[1] = arg1;
+    record.args[2] = arg2;
+    record.args[3] = arg3;
+    record.category = quint16(category);
+    record.level = quint8(level);
+    ring->head.storeRelease(head + 1);
+}
+
+QStringList AkLog::categories() const
+{
+    QMutexLocker locker(&this->d->m_mutex);
+    QStringList categories;
+
+    for (auto &category: this->d->m_categories)
+        categories << QString::fromLatin1(category);
+
+    return categories;
+}
+
+int AkLog::categoryLevel(const QString &category) const
+{
+    QMutexLocker locker(&this->d->m_mutex);
+    int index = this->d->m_categories.indexOf(category.toLatin1());
+
+    if (index < 0)
+        return LevelNone;
+
+    return akLogLevels[index].load();
+}
+
+bool AkLog::setOutputFile(const QString &fileName)
+{
+    FILE *output = stderr;
+
+    if (!fileName.isEmpty()) {
+        output = fopen(fileName.toStdString().c_str(), "a");
+
+        if (!output)
+            return false;
+    }
+
+    QMutexLocker locker(&this->d->m_mutex);
+
+    if (this->d->m_output != stderr)
+        fclose(this->d->m_output);
+
+    this->d->m_output = output;
+
+    return true;
+}
+
+void AkLog::flush()
+{
+    for (;;) {
+        bool empty = true;
+
+        for (auto ring = akLogRings.load(); ring; ring = ring->next)
+            if (ring->head.loadAcquire() != ring->tail.load()) {
+                empty = false;
+
+                break;
+            }
+
+        if (empty)
+            break;
+
+        QThread::msleep(1);
+    }
+}
+
+AkLog *AkLog::instance()
+{
+    return akLogGlobal;
+}
+
+void AkLog::setCategoryLevel(const QString &category, int level)
+{
+    QMutexLocker locker(&this->d->m_mutex);
+    int index = this->d->m_categories.indexOf(category.toLatin1());
+
+    if (index >= 0)
+        akLogLevels[index].store(level);
+}
+
+AkLogRing *AkLogPrivate::acquireRing()
+{
+    auto ring = new AkLogRing;
+
+    // Link it in front of the global list.
+    for (;;) {
+        auto first = akLogRings.load();
+        ring->next = first;
+
+        if (akLogRings.testAndSetOrdered(first, ring))
+            break;
+    }
+
+    return ring;
+}
+
+bool AkLogPrivate::drainRings()
+{
+    bool drained = false;
+
+    for (auto ring = akLogRings.load(); ring; ring = ring->next) {
+        auto head = ring->head.loadAcquire();
+
+        for (auto tail = ring->tail.load(); tail != head; tail++) {
+            auto dropped = ring->dropped.fetchAndStoreRelaxed(0);
+            this->printRecord(ring->records[tail & (RING_SIZE - 1)],
+                              quint32(dropped));
+            ring->tail.storeRelease(tail + 1);
+            drained = true;
+        }
+    }
+
+    if (drained)
+        fflush(this->m_output);
+
+    return drained;
+}
+
+void AkLogPrivate::printRecord(const AkLogRecord &record, quint32 dropped)
+{
+    static const char *levelNames[] = {
+        "debug",
+        "info",
+        "warning",
+        "error"
+    };
+
+    char message[256];
+    snprintf(message,
+             sizeof(message),
+             record.format,
+             record.args[0],
+             record.args[1],
+             record.args[2],
+             record.args[3]);
+
+    auto timeMs = akLogEpochMs + record.timeNs / 1000000;
+    auto time = QDateTime::fromMSecsSinceEpoch(timeMs)
+                .toString("hh:mm:ss.zzz");
+
+    QMutexLocker locker(&this->m_mutex);
+    auto category = this->m_categories.value(record.category);
+
+    if (dropped > 0)
+        fprintf(this->m_output,
+                "%s [%s] warning: %u records dropped\n",
+                time.toStdString().c_str(),
+                category.constData(),
+                dropped);
+
+    fprintf(this->m_output,
+            "%s [%s] %s: %s\n",
+            time.toStdString().c_str(),
+            category.constData(),
+            levelNames[record.level],
+            message);
+}
+
+#include "moc_aklog.cpp"
@@ -0,0 +1,98 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef AKLOG_H
+#define AKLOG_H
+
+#include <QObject>
+
+#include "akcommons.h"
+
+class AkLogPrivate;
+
+/* Asynchronous logging for code that runs at stream rate.
+ *
+ * qDebug formats and flushes on the calling thread, so enabling verbose
+ * logs changes the timing of the code being debugged. write() instead
+ * stores a fixed-size binary record (timestamp, category, level, a format
+ * literal and up to four integer arguments) into a lock-free ring owned
+ * by the calling thread, and a drain thread formats and prints the
+ * records later. A disabled category costs one atomic load and a branch,
+ * a recorded message a few stores, so debug logging can stay on in
+ * production.
+ *
+ * The format string must be a literal (only its address is recorded) and
+ * may only use conversions taking a long long, "%lld" and friends. When a
+ * ring overruns, records are dropped and the drop count is reported on
+ * the next drained line of that thread.
+ */
+class AKCOMMONS_EXPORT AkLog: public QObject
+{
+    Q_OBJECT
+
+    public:
+        enum Level
+        {
+            LevelDebug = 0,
+            LevelInfo = 1,
+            LevelWarning = 2,
+            LevelError = 3,
+            // Records nothing.
+            LevelNone = 4
+        };
+
+        explicit AkLog(QObject *parent=nullptr);
+        ~AkLog();
+
+        /* Give the category a slot in the filter table. Safe to call from
+         * static initialization and more than once with the same name, the
+         * same name always maps to the same id. */
+        static int registerCategory(const char *name,
+                                    Level level=LevelWarning);
+
+        // Records at or above the category level are kept.
+        static bool enabled(int category, Level level);
+        static void write(int category,
+                          Level level,
+                          const char *format,
+                          qint64 arg0=0,
+                          qint64 arg1=0,
+                          qint64 arg2=0,
+                          qint64 arg3=0);
+
+        Q_INVOKABLE QStringList categories() const;
+        Q_INVOKABLE int categoryLevel(const QString &category) const;
+
+        /* Lines go to stderr unless a file is set. Pass an empty name to go
+         * back to stderr. */
+        Q_INVOKABLE bool setOutputFile(const QString &fileName);
+
+        // Block until every record written so far has been printed.
+        Q_INVOKABLE void flush();
+
+        static AkLog *instance();
+
+    private:
+        AkLogPrivate *d;
+
+    public Q_SLOTS:
+        void setCategoryLevel(const QString &category, int level);
+};
+
+#endif // AKLOG_H
@@ -0,0 +1,233 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QMap>
+#include <QMutex>
+#include <QVector>
+#include <QPair>
+
+#include "akmemorybudget.h"
+
+class AkMemoryBudgetSubsystem
+{
+    public:
+        int priority;
+        qint64 bytes;
+        AkMemoryBudget::Reclaimer reclaimer;
+
+        AkMemoryBudgetSubsystem():
+            priority(0),
+            bytes(0)
+        {
+        }
+};
+
+class AkMemoryBudgetPrivate
+{
+    public:
+        mutable QMutex m_mutex;
+        QMap<QString, AkMemoryBudgetSubsystem> m_subsystems;
+        qint64 m_limit;
+        bool m_trimming;
+
+        AkMemoryBudgetPrivate():
+            m_limit(0),
+            m_trimming(false)
+        {
+        }
+
+        // The caller holds m_mutex.
+        inline qint64 totalBytes() const
+        {
+            qint64 total = 0;
+
+            for (const auto &subsystem: this->m_subsystems)
+                total += subsystem.bytes;
+
+            return total;
+        }
+};
+
+AkMemoryBudget::AkMemoryBudget(QObject *parent):
+    QObject(parent)
+{
+    this->d = new AkMemoryBudgetPrivate();
+}
+
+AkMemoryBudget::~AkMemoryBudget()
+{
+    delete this->d;
+}
+
+qint64 AkMemoryBudget::limit() const
+{
+    QMutexLocker locker(&this->d->m_mutex);
+
+    return this->d->m_limit;
+}
+
+qint64 AkMemoryBudget::totalBytes() const
+{
+    QMutexLocker locker(&this->d->m_mutex);
+
+    return this->d->totalBytes();
+}
+
+QVariantMap AkMemoryBudget::query() const
+{
+    QMutexLocker locker(&this->d->m_mutex);
+    QVariantMap stats;
+
+    for (auto it = this->d->m_subsystems.constBegin();
+         it != this->d->m_subsystems.constEnd();
+         it++) {
+        QVariantMap entry {
+            {"bytes"      , it.value().bytes              },
+            {"priority"   , it.value().priority           },
+            {"reclaimable", bool(it.value().reclaimer)    }
+        };
+
+        stats[it.key()] = entry;
+    }
+
+    return stats;
+}
+
+void AkMemoryBudget::registerSubsystem(const QString &subsystem,
+                                       int priority,
+                                       const Reclaimer &reclaimer)
+{
+    QMutexLocker locker(&this->d->m_mutex);
+    auto &entry = this->d->m_subsystems[subsystem];
+    entry.priority = priority;
+    entry.reclaimer = reclaimer;
+}
+
+void AkMemoryBudget::unregisterSubsystem(const QString &subsystem)
+{
+    QMutexLocker locker(&this->d->m_mutex);
+    this->d->m_subsystems.remove(subsystem);
+}
+
+void AkMemoryBudget::setBytes(const QString &subsystem, qint64 bytes)
+{
+    this->d->m_mutex.lock();
+    this->d->m_subsystems[subsystem].bytes = qMax(bytes, qint64(0));
+    auto limit = this->d->m_limit;
+    auto total = this->d->totalBytes();
+
+    // Reclaimers report their new usage from inside a trim, don't recurse.
+    bool needTrim = limit > 0
+                    && total > limit
+                    && !this->d->m_trimming;
+    this->d->m_mutex.unlock();
+
+    if (!needTrim)
+        return;
+
+    this->trim(total - limit);
+
+    this->d->m_mutex.lock();
+    total = this->d->totalBytes();
+    bool over = limit > 0 && total > limit;
+    this->d->m_mutex.unlock();
+
+    if (over)
+        emit this->overBudget(total, limit);
+}
+
+Q_GLOBAL_STATIC(AkMemoryBudget, akGlobalMemoryBudget)
+
+AkMemoryBudget *AkMemoryBudget::instance()
+{
+    return akGlobalMemoryBudget;
+}
+
+void AkMemoryBudget::setLimit(qint64 limit)
+{
+    this->d->m_mutex.lock();
+    limit = qMax(limit, qint64(0));
+    bool changed = this->d->m_limit != limit;
+    this->d->m_limit = limit;
+    auto total = this->d->totalBytes();
+    bool needTrim = limit > 0
+                    && total > limit
+                    && !this->d->m_trimming;
+    this->d->m_mutex.unlock();
+
+    if (changed)
+        emit this->limitChanged(limit);
+
+    if (needTrim)
+        this->trim(total - limit);
+}
+
+void AkMemoryBudget::resetLimit()
+{
+    this->setLimit(0);
+}
+
+void AkMemoryBudget::trim(qint64 bytes)
+{
+    if (bytes < 1)
+        return;
+
+    this->d->m_mutex.lock();
+
+    if (this->d->m_trimming) {
+        this->d->m_mutex.unlock();
+
+        return;
+    }
+
+    this->d->m_trimming = true;
+
+    // Snapshot the reclaimers sorted by priority, lowest trimmed first,
+    // and call them with the lock released.
+    QVector<QPair<int, Reclaimer>> plan;
+
+    for (const auto &subsystem: this->d->m_subsystems) {
+        if (!subsystem.reclaimer)
+            continue;
+
+        int i = 0;
+
+        while (i < plan.size() && plan[i].first <= subsystem.priority)
+            i++;
+
+        plan.insert(i, {subsystem.priority, subsystem.reclaimer});
+    }
+
+    this->d->m_mutex.unlock();
+
+    qint64 remaining = bytes;
+
+    for (const auto &entry: plan) {
+        if (remaining < 1)
+            break;
+
+        remaining -= qMax(entry.second(remaining), qint64(0));
+    }
+
+    this->d->m_mutex.lock();
+    this->d->m_trimming = false;
+    this->d->m_mutex.unlock();
+}
+
+#include "moc_akmemorybudget.cpp"
@@ -0,0 +1,95 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef AKMEMORYBUDGET_H
+#define AKMEMORYBUDGET_H
+
+#include <QObject>
+#include <QVariantMap>
+#include <functional>
+
+#include "akcommons.h"
+
+class AkMemoryBudgetPrivate;
+
+/* Process wide arbiter for reclaimable frame memory.
+ *
+ * Frame pools, readahead queues and the history effects each hold frame
+ * sized memory with no view of the total, which can run a small device out
+ * of memory. Subsystems register a reclaimer and report their usage as a
+ * gauge; when the sum crosses the configured limit, the manager asks the
+ * reclaimers to trim, lowest priority first, until the total fits again.
+ * The limit is 0 (unlimited) by default, constrained deployments set it
+ * once at startup.
+ */
+class AKCOMMONS_EXPORT AkMemoryBudget: public QObject
+{
+    Q_OBJECT
+    // Total bytes the registered subsystems may hold, 0 means unlimited.
+    Q_PROPERTY(qint64 limit
+               READ limit
+               WRITE setLimit
+               RESET resetLimit
+               NOTIFY limitChanged)
+
+    public:
+        /* Called with the number of bytes to free, returns how many the
+         * subsystem actually released. Invoked without internal locks
+         * held, so a reclaimer may report its new usage from inside. */
+        using Reclaimer = std::function<qint64 (qint64 bytes)>;
+
+        explicit AkMemoryBudget(QObject *parent=nullptr);
+        ~AkMemoryBudget();
+
+        Q_INVOKABLE qint64 limit() const;
+        Q_INVOKABLE qint64 totalBytes() const;
+
+        // One entry per subsystem with its current bytes and priority.
+        Q_INVOKABLE QVariantMap query() const;
+
+        /* Register a reclaimable subsystem. Lower priority is trimmed
+         * first: idle cache memory should go before history an effect
+         * needs for correct output. */
+        void registerSubsystem(const QString &subsystem,
+                               int priority,
+                               const Reclaimer &reclaimer);
+        void unregisterSubsystem(const QString &subsystem);
+
+        /* Usage gauge, updated whenever the subsystem's allocations
+         * change. Crossing the limit triggers trimming. */
+        void setBytes(const QString &subsystem, qint64 bytes);
+
+        static AkMemoryBudget *instance();
+
+    private:
+        AkMemoryBudgetPrivate *d;
+
+    Q_SIGNALS:
+        void limitChanged(qint64 limit);
+        // Trimming could not bring the total back under the limit.
+        void overBudget(qint64 totalBytes, qint64 limit);
+
+    public Q_SLOTS:
+        void setLimit(qint64 limit);
+        void resetLimit();
+        // Ask the subsystems to free 'bytes' right away.
+        void trim(qint64 bytes);
+};
+
+#endif // AKMEMORYBUDGET_H
@@ -0,0 +1,195 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QHash>
+#include <QMutex>
+#include <QVariantList>
+#include <QVector>
+
+#include "akmetrics.h"
+
+// Buckets cover 1 us .. ~1 s in powers of two.
+#define HISTOGRAM_BUCKETS 21
+
+class AkMetricsStage
+{
+    public:
+        qint64 m_count;
+        qint64 m_drops;
+        qint64 m_totalNs;
+        qint64 m_totalCpuNs;
+        qint64 m_minNs;
+        qint64 m_maxNs;
+        qint64 m_poolBytes;
+        QVector<qint64> m_histogram;
+        QVariantMap m_levels;
+
+        AkMetricsStage():
+            m_count(0),
+            m_drops(0),
+            m_totalNs(0),
+            m_totalCpuNs(0),
+            m_minNs(0),
+            m_maxNs(0),
+            m_poolBytes(0),
+            m_histogram(HISTOGRAM_BUCKETS, 0)
+        {
+        }
+};
+
+class AkMetricsPrivate
+{
+    public:
+        mutable QMutex m_mutex;
+        QHash<QString, AkMetricsStage> m_stages;
+        bool m_enabled;
+
+        AkMetricsPrivate():
+            m_enabled(false)
+        {
+        }
+
+        inline static int bucketFor(qint64 elapsedNs)
+        {
+            int bucket = 0;
+
+            for (qint64 limit = 1000;
+                 elapsedNs > limit && bucket < HISTOGRAM_BUCKETS - 1;
+                 limit <<= 1)
+                bucket++;
+
+            return bucket;
+        }
+};
+
+AkMetrics::AkMetrics(QObject *parent):
+    QObject(parent)
+{
+    this->d = new AkMetricsPrivate();
+}
+
+AkMetrics::~AkMetrics()
+{
+    delete this->d;
+}
+
+bool AkMetrics::enabled() const
+{
+    return this->d->m_enabled;
+}
+
+void AkMetrics::addSample(const QString &stage,
+                          qint64 elapsedNs,
+                          qint64 cpuNs)
+{
+    QMutexLocker locker(&this->d->m_mutex);
+    auto &stats = this->d->m_stages[stage];
+
+    if (stats.m_count == 0 || elapsedNs < stats.m_minNs)
+        stats.m_minNs = elapsedNs;
+
+    if (elapsedNs > stats.m_maxNs)
+        stats.m_maxNs = elapsedNs;
+
+    stats.m_count++;
+    stats.m_totalNs += elapsedNs;
+    stats.m_totalCpuNs += cpuNs;
+    stats.m_histogram[AkMetricsPrivate::bucketFor(elapsedNs)]++;
+}
+
+void AkMetrics::addDrop(const QString &stage)
+{
+    QMutexLocker locker(&this->d->m_mutex);
+    this->d->m_stages[stage].m_drops++;
+}
+
+void AkMetrics::setPoolBytes(const QString &stage, qint64 bytes)
+{
+    QMutexLocker locker(&this->d->m_mutex);
+    this->d->m_stages[stage].m_poolBytes = bytes;
+}
+
+void AkMetrics::setLevels(const QString &stage, const QVariantMap &levels)
+{
+    QMutexLocker locker(&this->d->m_mutex);
+    auto &stats = this->d->m_stages[stage];
+
+    for (auto it = levels.constBegin(); it != levels.constEnd(); it++)
+        stats.m_levels[it.key()] = it.value();
+}
+
+QVariantMap AkMetrics::query() const
+{
+    QMutexLocker locker(&this->d->m_mutex);
+    QVariantMap metrics;
+
+    for (auto it = this->d->m_stages.constBegin();
+         it != this->d->m_stages.constEnd();
+         it++) {
+        QVariantList histogram;
+
+        for (auto &count: it.value().m_histogram)
+            histogram << count;
+
+        QVariantMap stage {
+            {"count"    , it.value().m_count                  },
+            {"drops"    , it.value().m_drops                  },
+            {"minNs"    , it.value().m_minNs                  },
+            {"maxNs"    , it.value().m_maxNs                  },
+            {"avgNs"    , it.value().m_count > 0?
+                              it.value().m_totalNs / it.value().m_count: 0},
+            {"cpuNs"    , it.value().m_totalCpuNs             },
+            {"poolBytes", it.value().m_poolBytes              },
+            {"histogram", histogram                           },
+            {"levels"   , it.value().m_levels                 },
+        };
+        metrics[it.key()] = stage;
+    }
+
+    return metrics;
+}
+
+Q_GLOBAL_STATIC(AkMetrics, akGlobalMetrics)
+
+AkMetrics *AkMetrics::instance()
+{
+    return akGlobalMetrics;
+}
+
+void AkMetrics::setEnabled(bool enabled)
+{
+    if (this->d->m_enabled == enabled)
+        return;
+
+    this->d->m_enabled = enabled;
+    emit this->enabledChanged(enabled);
+}
+
+void AkMetrics::resetEnabled()
+{
+    this->setEnabled(false);
+}
+
+void AkMetrics::clear()
+{
+    QMutexLocker locker(&this->d->m_mutex);
+    this->d->m_stages.clear();
+}
+
+#include "moc_akmetrics.cpp"
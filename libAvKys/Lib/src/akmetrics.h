@@ -0,0 +1,86 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef AKMETRICS_H
+#define AKMETRICS_H
+
+#include <QObject>
+#include <QVariantMap>
+
+#include "akcommons.h"
+
+class AkMetricsPrivate;
+
+/* Per stage latency and throughput accounting for running pipelines.
+ *
+ * Elements report how long each frame spent in their iStream and how many
+ * frames they processed or dropped. Stats are keyed by stage name
+ * (pluginId/objectName), aggregated into log2 latency histograms and can be
+ * queried live while the pipeline runs. Collection is disabled by default
+ * and costs a single branch per frame when off.
+ */
+class AKCOMMONS_EXPORT AkMetrics: public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool enabled
+               READ enabled
+               WRITE setEnabled
+               RESET resetEnabled
+               NOTIFY enabledChanged)
+
+    public:
+        explicit AkMetrics(QObject *parent=nullptr);
+        ~AkMetrics();
+
+        Q_INVOKABLE bool enabled() const;
+
+        void addSample(const QString &stage,
+                       qint64 elapsedNs,
+                       qint64 cpuNs=0);
+        void addDrop(const QString &stage);
+
+        /* Current bytes a stage holds from the buffer pools. A gauge, not a
+         * counter, updated whenever the stage's allocations change. */
+        void setPoolBytes(const QString &stage, qint64 bytes);
+
+        /* Latest signal levels measured by a stage: peak/RMS for audio,
+         * luma statistics for video. Gauges keyed by name, each replaced
+         * on the next update from the same stage. */
+        void setLevels(const QString &stage, const QVariantMap &levels);
+
+        /* One entry per stage with count, drops, min/avg/max latency in
+         * nanoseconds, accumulated thread CPU time, pool bytes held, the
+         * log2 histogram buckets and the last reported signal levels. */
+        Q_INVOKABLE QVariantMap query() const;
+
+        static AkMetrics *instance();
+
+    private:
+        AkMetricsPrivate *d;
+
+    Q_SIGNALS:
+        void enabledChanged(bool enabled);
+
+    public Q_SLOTS:
+        void setEnabled(bool enabled);
+        void resetEnabled();
+        void clear();
+};
+
+#endif // AKMETRICS_H
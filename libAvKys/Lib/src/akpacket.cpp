@@ -29,8 +29,10 @@ class AkPacketPrivate
         AkCaps m_caps;
         QVariant m_data;
         QByteArray m_buffer;
+        AkBuffer m_frameBuffer;
         qint64 m_pts;
         AkFrac m_timeBase;
+        qint64 m_hardwareTimestamp;
         int m_index;
         qint64 m_id;
 };
@@ -40,6 +42,7 @@ AkPacket::AkPacket(QObject *parent):
 {
     this->d = new AkPacketPrivate();
     this->d->m_pts = 0;
+    this->d->m_hardwareTimestamp = -1;
     this->d->m_index = -1;
     this->d->m_id = -1;
 }
@@ -57,6 +60,7 @@ AkPacket::AkPacket(const AkCaps &caps,
     this->d->m_buffer = isValid? buffer: QByteArray();
     this->d->m_pts = isValid? pts: 0;
     this->d->m_timeBase = isValid? timeBase: AkFrac();
+    this->d->m_hardwareTimestamp = -1;
     this->d->m_index = isValid? index: -1;
     this->d->m_id = isValid? id: -1;
 }
@@ -68,12 +72,26 @@ AkPacket::AkPacket(const AkPacket &other):
     this->d->m_caps = other.d->m_caps;
     this->d->m_data = other.d->m_data;
     this->d->m_buffer = other.d->m_buffer;
+    this->d->m_frameBuffer = other.d->m_frameBuffer;
     this->d->m_pts = other.d->m_pts;
     this->d->m_timeBase = other.d->m_timeBase;
+    this->d->m_hardwareTimestamp = other.d->m_hardwareTimestamp;
     this->d->m_index = other.d->m_index;
     this->d->m_id = other.d->m_id;
 }
 
+AkPacket::AkPacket(AkPacket &&other):
+    QObject()
+{
+    // Steal the private data, the source is left as a default packet.
+    this->d = other.d;
+    other.d = new AkPacketPrivate();
+    other.d->m_pts = 0;
+    other.d->m_hardwareTimestamp = -1;
+    other.d->m_index = -1;
+    other.d->m_id = -1;
+}
+
 AkPacket::~AkPacket()
 {
     delete this->d;
@@ -85,8 +103,10 @@ AkPacket &AkPacket::operator =(const AkPacket &other)
         this->d->m_caps = other.d->m_caps;
         this->d->m_data = other.d->m_data;
         this->d->m_buffer = other.d->m_buffer;
+        this->d->m_frameBuffer = other.d->m_frameBuffer;
         this->d->m_pts = other.d->m_pts;
         this->d->m_timeBase = other.d->m_timeBase;
+        this->d->m_hardwareTimestamp = other.d->m_hardwareTimestamp;
         this->d->m_index = other.d->m_index;
         this->d->m_id = other.d->m_id;
     }
@@ -94,6 +114,13 @@ AkPacket &AkPacket::operator =(const AkPacket &other)
     return *this;
 }
 
+AkPacket &AkPacket::operator =(AkPacket &&other)
+{
+    qSwap(this->d, other.d);
+
+    return *this;
+}
+
 AkPacket::operator bool() const
 {
     return this->d->m_caps.isValid();
@@ -158,6 +185,12 @@ QVariant &AkPacket::data()
 
 QByteArray AkPacket::buffer() const
 {
+    // Legacy accessor. When the packet travels with a zero-copy frame buffer
+    // this pays for a deep copy, new code should read frameBuffer() instead.
+    if (this->d->m_buffer.isEmpty()
+        && !this->d->m_frameBuffer.isEmpty())
+        return this->d->m_frameBuffer.toByteArray();
+
     return this->d->m_buffer;
 }
 
@@ -166,6 +199,27 @@ QByteArray &AkPacket::buffer()
     return this->d->m_buffer;
 }
 
+const char *AkPacket::constData() const
+{
+    // Read access to whichever buffer the packet travels with, without the
+    // deep copy that buffer() pays on the zero-copy path.
+    if (this->d->m_buffer.isEmpty()
+        && !this->d->m_frameBuffer.isEmpty())
+        return reinterpret_cast<const char *>(this->d->m_frameBuffer.constData());
+
+    return this->d->m_buffer.constData();
+}
+
+AkBuffer AkPacket::frameBuffer() const
+{
+    return this->d->m_frameBuffer;
+}
+
+AkBuffer &AkPacket::frameBuffer()
+{
+    return this->d->m_frameBuffer;
+}
+
 qint64 AkPacket::id() const
 {
     return this->d->m_id;
@@ -196,6 +250,16 @@ AkFrac &AkPacket::timeBase()
     return this->d->m_timeBase;
 }
 
+qint64 AkPacket::hardwareTimestamp() const
+{
+    return this->d->m_hardwareTimestamp;
+}
+
+qint64 &AkPacket::hardwareTimestamp()
+{
+    return this->d->m_hardwareTimestamp;
+}
+
 int AkPacket::index() const
 {
     return this->d->m_index;
@@ -233,6 +297,15 @@ void AkPacket::setBuffer(const QByteArray &buffer)
     emit this->bufferChanged(buffer);
 }
 
+void AkPacket::setFrameBuffer(const AkBuffer &frameBuffer)
+{
+    if (this->d->m_frameBuffer.constData() == frameBuffer.constData())
+        return;
+
+    this->d->m_frameBuffer = frameBuffer;
+    emit this->frameBufferChanged(frameBuffer);
+}
+
 void AkPacket::setId(qint64 id)
 {
     if (this->d->m_id == id)
@@ -260,6 +333,15 @@ void AkPacket::setTimeBase(const AkFrac &timeBase)
     emit this->timeBaseChanged(timeBase);
 }
 
+void AkPacket::setHardwareTimestamp(qint64 hardwareTimestamp)
+{
+    if (this->d->m_hardwareTimestamp == hardwareTimestamp)
+        return;
+
+    this->d->m_hardwareTimestamp = hardwareTimestamp;
+    emit this->hardwareTimestampChanged(hardwareTimestamp);
+}
+
 void AkPacket::setIndex(int index)
 {
     if (this->d->m_index == index)
@@ -284,6 +366,11 @@ void AkPacket::resetBuffer()
     this->setBuffer(QByteArray());
 }
 
+void AkPacket::resetFrameBuffer()
+{
+    this->setFrameBuffer(AkBuffer());
+}
+
 void AkPacket::resetId()
 {
     this->setId(-1);
@@ -299,6 +386,11 @@ void AkPacket::resetTimeBase()
     this->setTimeBase(AkFrac());
 }
 
+void AkPacket::resetHardwareTimestamp()
+{
+    this->setHardwareTimestamp(-1);
+}
+
 void AkPacket::resetIndex()
 {
     this->setIndex(-1);
@@ -20,6 +20,7 @@
 #ifndef AKPACKET_H
 #define AKPACKET_H
 
+#include "akbuffer.h"
 #include "akfrac.h"
 
 class AkPacketPrivate;
@@ -49,6 +50,11 @@ class AKCOMMONS_EXPORT AkPacket: public QObject
                WRITE setBuffer
                RESET resetBuffer
                NOTIFY bufferChanged)
+    Q_PROPERTY(AkBuffer frameBuffer
+               READ frameBuffer
+               WRITE setFrameBuffer
+               RESET resetFrameBuffer
+               NOTIFY frameBufferChanged)
     Q_PROPERTY(qint64 id
                READ id
                WRITE setId
@@ -64,6 +70,14 @@ class AKCOMMONS_EXPORT AkPacket: public QObject
                WRITE setTimeBase
                RESET resetTimeBase
                NOTIFY timeBaseChanged)
+    /* Capture timestamp in nanoseconds on the shared monotonic timeline
+     * (AkClockSync), taken from the driver's buffer timestamp when the
+     * backend provides one. -1 when the source has no hardware stamp. */
+    Q_PROPERTY(qint64 hardwareTimestamp
+               READ hardwareTimestamp
+               WRITE setHardwareTimestamp
+               RESET resetHardwareTimestamp
+               NOTIFY hardwareTimestampChanged)
     Q_PROPERTY(int index
                READ index
                WRITE setIndex
@@ -79,8 +93,10 @@ class AKCOMMONS_EXPORT AkPacket: public QObject
                  int index=-1,
                  qint64 id=-1);
         AkPacket(const AkPacket &other);
+        AkPacket(AkPacket &&other);
         virtual ~AkPacket();
         AkPacket &operator =(const AkPacket &other);
+        AkPacket &operator =(AkPacket &&other);
         operator bool() const;
 
         Q_INVOKABLE QString toString() const;
@@ -90,12 +106,17 @@ class AKCOMMONS_EXPORT AkPacket: public QObject
         Q_INVOKABLE QVariant &data();
         Q_INVOKABLE QByteArray buffer() const;
         Q_INVOKABLE QByteArray &buffer();
+        const char *constData() const;
+        Q_INVOKABLE AkBuffer frameBuffer() const;
+        Q_INVOKABLE AkBuffer &frameBuffer();
         Q_INVOKABLE qint64 id() const;
         Q_INVOKABLE qint64 &id();
         Q_INVOKABLE qint64 pts() const;
         Q_INVOKABLE qint64 &pts();
         Q_INVOKABLE AkFrac timeBase() const;
         Q_INVOKABLE AkFrac &timeBase();
+        Q_INVOKABLE qint64 hardwareTimestamp() const;
+        Q_INVOKABLE qint64 &hardwareTimestamp();
         Q_INVOKABLE int index() const;
         Q_INVOKABLE int &index();
 
@@ -106,25 +127,31 @@ class AKCOMMONS_EXPORT AkPacket: public QObject
         void capsChanged(const AkCaps &caps);
         void dataChanged(const QVariant &data);
         void bufferChanged(const QByteArray &buffer);
+        void frameBufferChanged(const AkBuffer &frameBuffer);
         void idChanged(qint64 id);
         void ptsChanged(qint64 pts);
         void timeBaseChanged(const AkFrac &timeBase);
+        void hardwareTimestampChanged(qint64 hardwareTimestamp);
         void indexChanged(int index);
 
     public Q_SLOTS:
         void setCaps(const AkCaps &caps);
         void setData(const QVariant &data);
         void setBuffer(const QByteArray &buffer);
+        void setFrameBuffer(const AkBuffer &frameBuffer);
         void setId(qint64 id);
         void setPts(qint64 pts);
         void setTimeBase(const AkFrac &timeBase);
+        void setHardwareTimestamp(qint64 hardwareTimestamp);
         void setIndex(int index);
         void resetCaps();
         void resetData();
         void resetBuffer();
+        void resetFrameBuffer();
         void resetId();
         void resetPts();
         void resetTimeBase();
+        void resetHardwareTimestamp();
         void resetIndex();
 
     friend QDebug operator <<(QDebug debug, const AkPacket &packet);
@@ -0,0 +1,254 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QDataStream>
+#include <QSet>
+
+#include "akpacketstream.h"
+#include "akbuffer.h"
+#include "akfrac.h"
+
+#define AK_PACKET_STREAM_MAGIC 0x416B506B
+#define AK_PACKET_STREAM_VERSION 1
+
+// Header flags.
+#define AK_PACKET_FLAG_CAPS_INLINE 0x1
+#define AK_PACKET_FLAG_PAYLOAD_HANDLE 0x2
+
+class AkPacketStreamPrivate
+{
+    public:
+        // Writer side: caps ids whose definition was already sent.
+        QSet<qint64> m_sentCaps;
+
+        // Reader side: caps definitions seen so far.
+        QHash<qint64, AkCaps> m_knownCaps;
+        QByteArray m_payloadHandle;
+};
+
+AkPacketStream::AkPacketStream(QObject *parent):
+    QObject(parent)
+{
+    this->d = new AkPacketStreamPrivate;
+}
+
+AkPacketStream::~AkPacketStream()
+{
+    delete this->d;
+}
+
+QByteArray AkPacketStream::write(const AkPacket &packet)
+{
+    return this->write(packet, QByteArray());
+}
+
+QByteArray AkPacketStream::write(const AkPacket &packet,
+                                 const QByteArray &payloadHandle)
+{
+    QByteArray data;
+    QDataStream ostream(&data, QIODevice::WriteOnly);
+
+    // The stream version is pinned so both endpoints agree on the
+    // primitive encodings, whatever Qt they were built against.
+    ostream.setVersion(QDataStream::Qt_5_6);
+
+    qint64 capsId = packet.caps().compiledId();
+    quint16 flags = 0;
+
+    if (!this->d->m_sentCaps.contains(capsId))
+        flags |= AK_PACKET_FLAG_CAPS_INLINE;
+
+    if (!payloadHandle.isEmpty())
+        flags |= AK_PACKET_FLAG_PAYLOAD_HANDLE;
+
+    ostream << quint32(AK_PACKET_STREAM_MAGIC)
+            << quint16(AK_PACKET_STREAM_VERSION)
+            << flags
+            << capsId;
+
+    if (flags & AK_PACKET_FLAG_CAPS_INLINE) {
+        ostream << packet.caps().toString();
+        this->d->m_sentCaps << capsId;
+    }
+
+    ostream << packet.id()
+            << packet.pts()
+            << packet.timeBase().num()
+            << packet.timeBase().den()
+            << qint32(packet.index());
+
+    /* Plane descriptors. Packets carry a single flat plane today, the
+     * count keeps the layout open for planar payloads without a version
+     * bump.
+     */
+    auto frameBuffer = packet.frameBuffer();
+    quint64 payloadSize = frameBuffer.isEmpty()?
+                              quint64(packet.buffer().size()):
+                              quint64(frameBuffer.size());
+
+    ostream << quint32(1)
+            << quint64(0)
+            << payloadSize;
+
+    if (flags & AK_PACKET_FLAG_PAYLOAD_HANDLE) {
+        ostream << payloadHandle;
+    } else {
+        ostream << quint32(payloadSize);
+
+        /* The payload goes in raw after its size, not as a QByteArray,
+         * so a reader over mapped memory can reference it in place.
+         */
+        if (frameBuffer.isEmpty())
+            data.append(packet.buffer());
+        else
+            data.append(reinterpret_cast<const char *>(frameBuffer.constData()),
+                        int(frameBuffer.size()));
+    }
+
+    return data;
+}
+
+AkPacket AkPacketStream::read(const QByteArray &data, int *bytesRead)
+{
+    return this->read(reinterpret_cast<const quint8 *>(data.constData()),
+                      data.size(),
+                      bytesRead,
+                      std::function<void ()>());
+}
+
+AkPacket AkPacketStream::read(const quint8 *data,
+                              int size,
+                              int *bytesRead,
+                              const std::function<void ()> &release)
+{
+    if (bytesRead)
+        *bytesRead = 0;
+
+    auto wrapper =
+            QByteArray::fromRawData(reinterpret_cast<const char *>(data),
+                                    size);
+    QDataStream istream(wrapper);
+    istream.setVersion(QDataStream::Qt_5_6);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    quint16 flags = 0;
+    qint64 capsId = -1;
+    istream >> magic >> version >> flags >> capsId;
+
+    if (istream.status() != QDataStream::Ok
+        || magic != AK_PACKET_STREAM_MAGIC
+        || version != AK_PACKET_STREAM_VERSION)
+        return AkPacket();
+
+    AkCaps caps;
+
+    if (flags & AK_PACKET_FLAG_CAPS_INLINE) {
+        QString capsStr;
+        istream >> capsStr;
+        caps = AkCaps(capsStr);
+        this->d->m_knownCaps[capsId] = caps;
+    } else {
+        if (!this->d->m_knownCaps.contains(capsId))
+            return AkPacket();
+
+        caps = this->d->m_knownCaps[capsId];
+    }
+
+    qint64 id = -1;
+    qint64 pts = 0;
+    qint64 tbNum = 0;
+    qint64 tbDen = 0;
+    qint32 index = -1;
+    istream >> id >> pts >> tbNum >> tbDen >> index;
+
+    quint32 planes = 0;
+    istream >> planes;
+
+    if (istream.status() != QDataStream::Ok || planes < 1)
+        return AkPacket();
+
+    quint64 payloadSize = 0;
+
+    for (quint32 i = 0; i < planes; i++) {
+        quint64 offset = 0;
+        quint64 planeSize = 0;
+        istream >> offset >> planeSize;
+        payloadSize = qMax(payloadSize, offset + planeSize);
+    }
+
+    AkPacket packet;
+    packet.caps() = caps;
+    packet.id() = id;
+    packet.pts() = pts;
+    packet.timeBase() = AkFrac(tbNum, tbDen);
+    packet.index() = index;
+    this->d->m_payloadHandle.clear();
+
+    if (flags & AK_PACKET_FLAG_PAYLOAD_HANDLE) {
+        istream >> this->d->m_payloadHandle;
+
+        if (istream.status() != QDataStream::Ok)
+            return AkPacket();
+
+        if (bytesRead)
+            *bytesRead = int(istream.device()->pos());
+
+        return packet;
+    }
+
+    quint32 inlineSize = 0;
+    istream >> inlineSize;
+    int payloadPos = int(istream.device()->pos());
+
+    if (istream.status() != QDataStream::Ok
+        || inlineSize != payloadSize
+        || payloadPos + qint64(inlineSize) > size)
+        return AkPacket();
+
+    if (release)
+        // Zero-copy: the frame buffer references the mapping directly.
+        packet.frameBuffer() =
+                AkBuffer::fromRawData(const_cast<quint8 *>(data) + payloadPos,
+                                      size_t(inlineSize),
+                                      release);
+    else
+        packet.buffer() =
+                QByteArray(reinterpret_cast<const char *>(data) + payloadPos,
+                           int(inlineSize));
+
+    if (bytesRead)
+        *bytesRead = payloadPos + int(inlineSize);
+
+    return packet;
+}
+
+QByteArray AkPacketStream::payloadHandle() const
+{
+    return this->d->m_payloadHandle;
+}
+
+void AkPacketStream::reset()
+{
+    this->d->m_sentCaps.clear();
+    this->d->m_knownCaps.clear();
+    this->d->m_payloadHandle.clear();
+}
+
+#include "moc_akpacketstream.cpp"
@@ -0,0 +1,95 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef AKPACKETSTREAM_H
+#define AKPACKETSTREAM_H
+
+#include <functional>
+
+#include "akpacket.h"
+
+class AkPacketStreamPrivate;
+
+/* Compact binary wire format for packets, meant for IPC.
+ *
+ * Every serialized packet is a fixed header (magic, version, flags),
+ * the interned caps id, the timing fields, the plane descriptors and
+ * the payload. The caps string itself travels only the first time its
+ * id appears on a stream, after that the id alone is enough, so the
+ * per frame overhead stays a few dozen bytes. The serializer is
+ * stateful per direction: one writer instance feeds one reader
+ * instance.
+ *
+ * The payload goes either inline after the header, or as an opaque
+ * handle blob when the frame lives out of band (shared memory, for
+ * instance); the transport that owns the handle resolves it and
+ * attaches the mapped memory to the packet. Reading from mapped memory
+ * is zero-copy: the returned packet's frame buffer references the
+ * mapping directly, and the release callback fires when the last
+ * packet reference drops.
+ */
+class AKCOMMONS_EXPORT AkPacketStream: public QObject
+{
+    Q_OBJECT
+
+    public:
+        explicit AkPacketStream(QObject *parent=nullptr);
+        ~AkPacketStream();
+
+        /* Serializes 'packet' with the payload inline. */
+        Q_INVOKABLE QByteArray write(const AkPacket &packet);
+
+        /* Serializes 'packet' with 'payloadHandle' in place of the
+         * payload bytes. The blob is opaque to the stream.
+         */
+        Q_INVOKABLE QByteArray write(const AkPacket &packet,
+                                     const QByteArray &payloadHandle);
+
+        /* Deserializes one packet from 'data', copying the payload.
+         * Returns a null packet on short or malformed input, and the
+         * number of bytes consumed in 'bytesRead'.
+         */
+        Q_INVOKABLE AkPacket read(const QByteArray &data,
+                                  int *bytesRead=nullptr);
+
+        /* Zero-copy variant for mapped memory: the payload is
+         * referenced in place and 'release' fires when the last
+         * reference to it drops. The mapping must outlive the packet.
+         */
+        AkPacket read(const quint8 *data,
+                      int size,
+                      int *bytesRead,
+                      const std::function<void ()> &release);
+
+        /* Handle blob of the last packet read, empty if the payload
+         * was inline.
+         */
+        Q_INVOKABLE QByteArray payloadHandle() const;
+
+    private:
+        AkPacketStreamPrivate *d;
+
+    public Q_SLOTS:
+        /* Forgets the interned caps, the next write sends the caps
+         * definitions again. Call it when the peer reconnects.
+         */
+        void reset();
+};
+
+#endif // AKPACKETSTREAM_H
@@ -0,0 +1,269 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QCoreApplication>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QThread>
+#include <QTimer>
+#include <functional>
+
+#include "akremoteelement.h"
+#include "akshmchannel.h"
+
+#define RESPAWN_DELAY 1000
+#define CHANNEL_SIZE (16 * 1024 * 1024)
+
+/* Blocking reader for the result channel. The callback runs in the
+ * reader thread, the same way direct-linked elements process in their
+ * caller's thread.
+ */
+class AkRemoteElementReader: public QThread
+{
+    public:
+        AkRemoteElementReader(AkShmChannel *channel,
+                              const std::function<void (const AkPacket &)> &callback,
+                              QObject *parent=nullptr):
+            QThread(parent),
+            m_channel(channel),
+            m_callback(callback)
+        {
+        }
+
+        void run()
+        {
+            forever {
+                auto packet = this->m_channel->readPacket();
+
+                if (!packet)
+                    break;
+
+                this->m_callback(packet);
+            }
+        }
+
+    private:
+        AkShmChannel *m_channel;
+        std::function<void (const AkPacket &)> m_callback;
+};
+
+class AkRemoteElementPrivate
+{
+    public:
+        QString m_pluginId;
+        QProcess *m_process;
+        AkShmChannel *m_inChannel;
+        AkShmChannel *m_outChannel;
+        AkRemoteElementReader *m_reader;
+        QVariantMap m_remoteProperties;
+        quint64 m_channelSeq;
+        bool m_running;
+
+        AkRemoteElementPrivate():
+            m_process(nullptr),
+            m_inChannel(nullptr),
+            m_outChannel(nullptr),
+            m_reader(nullptr),
+            m_channelSeq(0),
+            m_running(false)
+        {
+        }
+};
+
+AkRemoteElement::AkRemoteElement(const QString &pluginId):
+    AkElement()
+{
+    this->d = new AkRemoteElementPrivate;
+    this->d->m_pluginId = pluginId;
+}
+
+AkRemoteElement::~AkRemoteElement()
+{
+    this->stopWorker();
+    delete this->d;
+}
+
+QString AkRemoteElement::pluginId() const
+{
+    return this->d->m_pluginId;
+}
+
+void AkRemoteElement::setRemoteProperty(const QString &name,
+                                        const QVariant &value)
+{
+    this->d->m_remoteProperties[name] = value;
+
+    if (this->d->m_process
+        && this->d->m_process->state() == QProcess::Running) {
+        QJsonObject message;
+        message[name] = QJsonValue::fromVariant(value);
+        this->d->m_process->write(QJsonDocument(message).toJson(QJsonDocument::Compact)
+                                  + "\n");
+    }
+}
+
+void AkRemoteElement::spawnWorker()
+{
+    /* Fresh channel names per spawn: a respawned worker starts with
+     * clean rings and a clean caps interning state.
+     */
+    auto base = QString("akremote-%1-%2")
+                    .arg(QCoreApplication::applicationPid())
+                    .arg(this->d->m_channelSeq++);
+    this->d->m_inChannel = new AkShmChannel(base + "-in", this);
+    this->d->m_outChannel = new AkShmChannel(base + "-out", this);
+
+    if (!this->d->m_inChannel->create(CHANNEL_SIZE)
+        || !this->d->m_outChannel->create(CHANNEL_SIZE)) {
+        this->stopWorker();
+
+        return;
+    }
+
+    this->d->m_reader =
+            new AkRemoteElementReader(this->d->m_outChannel,
+                                      [this] (const AkPacket &packet) {
+                                          /* send() reaches fast-linked
+                                           * sinks too, a raw emit would
+                                           * not. */
+                                          this->send(packet);
+                                      },
+                                      this);
+    this->d->m_reader->start();
+
+    this->d->m_process = new QProcess(this);
+    QObject::connect(this->d->m_process,
+                     static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+                     this,
+                     [this] (int exitCode, QProcess::ExitStatus exitStatus) {
+                         Q_UNUSED(exitCode)
+                         Q_UNUSED(exitStatus)
+
+                         if (!this->d->m_running)
+                             return;
+
+                         // A crashed worker is replaced; the delay keeps
+                         // a plugin that dies on startup from spinning.
+                         this->stopWorker();
+                         this->d->m_running = true;
+                         QTimer::singleShot(RESPAWN_DELAY,
+                                            this,
+                                            [this] () {
+                                                if (this->d->m_running)
+                                                    this->spawnWorker();
+                                            });
+                     });
+    QObject::connect(this->d->m_process,
+                     &QProcess::started,
+                     this,
+                     [this] () {
+                         // Replay the cached properties on every spawn.
+                         for (auto it = this->d->m_remoteProperties.begin();
+                              it != this->d->m_remoteProperties.end();
+                              it++) {
+                             QJsonObject message;
+                             message[it.key()] = QJsonValue::fromVariant(it.value());
+                             this->d->m_process->write(QJsonDocument(message).toJson(QJsonDocument::Compact)
+                                                       + "\n");
+                         }
+                     });
+    this->d->m_process->start(QCoreApplication::applicationFilePath(),
+                              {"--element-worker",
+                               this->d->m_pluginId,
+                               this->d->m_inChannel->name(),
+                               this->d->m_outChannel->name()});
+}
+
+void AkRemoteElement::stopWorker()
+{
+    this->d->m_running = false;
+
+    if (this->d->m_process) {
+        this->d->m_process->disconnect(this);
+        this->d->m_process->kill();
+        this->d->m_process->waitForFinished(1000);
+        delete this->d->m_process;
+        this->d->m_process = nullptr;
+    }
+
+    if (this->d->m_outChannel)
+        this->d->m_outChannel->stop();
+
+    if (this->d->m_reader) {
+        this->d->m_reader->wait();
+        delete this->d->m_reader;
+        this->d->m_reader = nullptr;
+    }
+
+    if (this->d->m_inChannel) {
+        delete this->d->m_inChannel;
+        this->d->m_inChannel = nullptr;
+    }
+
+    if (this->d->m_outChannel) {
+        delete this->d->m_outChannel;
+        this->d->m_outChannel = nullptr;
+    }
+}
+
+void AkRemoteElement::stateChange(AkElement::ElementState from,
+                                  AkElement::ElementState to)
+{
+    if (from == AkElement::ElementStateNull
+        && to != AkElement::ElementStateNull) {
+        if (this->d->m_pluginId.isEmpty())
+            return;
+
+        this->d->m_running = true;
+        this->spawnWorker();
+    } else if (to == AkElement::ElementStateNull) {
+        this->stopWorker();
+    }
+}
+
+void AkRemoteElement::setPluginId(const QString &pluginId)
+{
+    if (this->d->m_pluginId == pluginId)
+        return;
+
+    this->d->m_pluginId = pluginId;
+    emit this->pluginIdChanged(pluginId);
+}
+
+void AkRemoteElement::resetPluginId()
+{
+    this->setPluginId(QString());
+}
+
+AkPacket AkRemoteElement::iStream(const AkPacket &packet)
+{
+    /* While the worker is down the frame passes through unprocessed,
+     * losing a worker degrades the stream instead of freezing it.
+     */
+    if (!this->d->m_inChannel
+        || !this->d->m_process
+        || this->d->m_process->state() != QProcess::Running
+        || !this->d->m_inChannel->writePacket(packet))
+        akSend(packet)
+
+    return AkPacket();
+}
+
+#include "moc_akremoteelement.cpp"
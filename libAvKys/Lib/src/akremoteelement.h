@@ -0,0 +1,81 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef AKREMOTEELEMENT_H
+#define AKREMOTEELEMENT_H
+
+#include "akelement.h"
+
+class AkRemoteElementPrivate;
+
+/* Proxy that runs a plugin element in a worker process.
+ *
+ * From the pipeline's point of view it is the element it wraps: packets
+ * written to iStream() travel to the worker over a shared memory channel,
+ * the worker runs them through the real element and the results come back
+ * the same way, zero-copy on both ends. Remote properties are forwarded
+ * as JSON lines over the worker's standard input.
+ *
+ * The proxy supervises its worker: if the process crashes it is
+ * respawned with fresh channels and the cached remote properties are
+ * replayed, so a plugin fault costs a moment of stream and nothing else.
+ * While the worker is down, frames pass through unprocessed.
+ */
+class AKCOMMONS_EXPORT AkRemoteElement: public AkElement
+{
+    Q_OBJECT
+    Q_PROPERTY(QString pluginId
+               READ pluginId
+               WRITE setPluginId
+               RESET resetPluginId
+               NOTIFY pluginIdChanged)
+
+    public:
+        explicit AkRemoteElement(const QString &pluginId=QString());
+        ~AkRemoteElement();
+
+        Q_INVOKABLE QString pluginId() const;
+
+        /* Sets a property on the element inside the worker. Values are
+         * cached and replayed after a respawn.
+         */
+        Q_INVOKABLE void setRemoteProperty(const QString &name,
+                                           const QVariant &value);
+
+    private:
+        AkRemoteElementPrivate *d;
+
+        void spawnWorker();
+        void stopWorker();
+
+    protected:
+        void stateChange(AkElement::ElementState from,
+                         AkElement::ElementState to);
+
+    signals:
+        void pluginIdChanged(const QString &pluginId);
+
+    public slots:
+        void setPluginId(const QString &pluginId);
+        void resetPluginId();
+
+        AkPacket iStream(const AkPacket &packet);
+};
+
+#endif // AKREMOTEELEMENT_H
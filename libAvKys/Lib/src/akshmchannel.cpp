@@ -0,0 +1,329 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QMap>
+#include <QMutex>
+#include <QSet>
+#include <QSharedMemory>
+#include <QSystemSemaphore>
+#include <atomic>
+
+#include "akshmchannel.h"
+#include "akbuffer.h"
+#include "akpacketstream.h"
+
+#define AK_SHM_CHANNEL_MAGIC 0x416B5368
+#define AK_SHM_CHANNEL_VERSION 1
+
+// Message size marking a skipped ring tail.
+#define AK_SHM_WRAP_MARKER 0xffffffff
+
+/* Segment layout: this header followed by the ring bytes. The positions
+ * are free running, both sides reduce them modulo the capacity. They are
+ * C++11 atomics placed in the mapping itself, both processes load and
+ * store them lock free.
+ */
+struct AkShmChannelHeader
+{
+    quint32 magic;
+    quint32 version;
+    quint64 capacity;
+    std::atomic<quint64> writePos;
+    std::atomic<quint64> readPos;
+};
+
+class AkShmChannelPrivate
+{
+    public:
+        QString m_name;
+        QSharedMemory m_memory;
+        QSystemSemaphore *m_semaphore;
+        AkPacketStream m_stream;
+        QMutex m_mutex;
+
+        /* Reader side: the cursor runs ahead of the shared read position
+         * while frames are still referenced by the pipeline. Regions are
+         * reclaimed when released, in arrival order.
+         */
+        quint64 m_readCursor;
+        QMap<quint64, quint64> m_pending;
+        QSet<quint64> m_freed;
+        std::atomic<bool> m_stopping;
+
+        AkShmChannelPrivate(const QString &name):
+            m_name(name),
+            m_memory(name),
+            m_semaphore(nullptr),
+            m_readCursor(0),
+            m_stopping(false)
+        {
+        }
+
+        inline AkShmChannelHeader *header()
+        {
+            return reinterpret_cast<AkShmChannelHeader *>(this->m_memory.data());
+        }
+
+        inline quint8 *ring()
+        {
+            return reinterpret_cast<quint8 *>(this->m_memory.data())
+                   + sizeof(AkShmChannelHeader);
+        }
+
+        void releaseRegion(quint64 start);
+};
+
+void AkShmChannelPrivate::releaseRegion(quint64 start)
+{
+    QMutexLocker locker(&this->m_mutex);
+
+    if (!this->m_pending.contains(start))
+        return;
+
+    // Mark freed, then advance the shared read position over the
+    // contiguous freed prefix. Frames usually drop their last reference
+    // in arrival order, so the prefix is usually everything freed.
+    this->m_freed << start;
+    auto header = this->header();
+
+    if (!header)
+        return;
+
+    quint64 readPos = header->readPos.load(std::memory_order_relaxed);
+    bool advanced = false;
+
+    while (!this->m_pending.isEmpty()
+           && this->m_freed.contains(this->m_pending.firstKey())) {
+        quint64 first = this->m_pending.firstKey();
+        readPos = this->m_pending[first];
+        this->m_freed.remove(first);
+        this->m_pending.remove(first);
+        advanced = true;
+    }
+
+    if (advanced)
+        header->readPos.store(readPos, std::memory_order_release);
+}
+
+AkShmChannel::AkShmChannel(const QString &name, QObject *parent):
+    QObject(parent)
+{
+    this->d = new AkShmChannelPrivate(name);
+}
+
+AkShmChannel::~AkShmChannel()
+{
+    this->stop();
+    this->detach();
+    delete this->d;
+}
+
+QString AkShmChannel::name() const
+{
+    return this->d->m_name;
+}
+
+bool AkShmChannel::isAttached() const
+{
+    return this->d->m_memory.isAttached();
+}
+
+bool AkShmChannel::create(int size)
+{
+    if (this->d->m_memory.isAttached())
+        return false;
+
+    if (!this->d->m_memory.create(size + int(sizeof(AkShmChannelHeader))))
+        return false;
+
+    auto header = this->d->header();
+    header->capacity = quint64(size);
+    header->writePos.store(0, std::memory_order_relaxed);
+    header->readPos.store(0, std::memory_order_relaxed);
+    header->version = AK_SHM_CHANNEL_VERSION;
+    header->magic = AK_SHM_CHANNEL_MAGIC;
+
+    this->d->m_semaphore =
+            new QSystemSemaphore(this->d->m_name + ".sem",
+                                 0,
+                                 QSystemSemaphore::Create);
+    this->d->m_readCursor = 0;
+    this->d->m_stopping.store(false);
+
+    return true;
+}
+
+bool AkShmChannel::attach()
+{
+    if (this->d->m_memory.isAttached())
+        return false;
+
+    if (!this->d->m_memory.attach())
+        return false;
+
+    auto header = this->d->header();
+
+    if (header->magic != AK_SHM_CHANNEL_MAGIC
+        || header->version != AK_SHM_CHANNEL_VERSION) {
+        this->d->m_memory.detach();
+
+        return false;
+    }
+
+    this->d->m_semaphore =
+            new QSystemSemaphore(this->d->m_name + ".sem",
+                                 0,
+                                 QSystemSemaphore::Open);
+    this->d->m_readCursor = header->readPos.load(std::memory_order_acquire);
+    this->d->m_stopping.store(false);
+
+    return true;
+}
+
+void AkShmChannel::detach()
+{
+    if (this->d->m_memory.isAttached())
+        this->d->m_memory.detach();
+
+    if (this->d->m_semaphore) {
+        delete this->d->m_semaphore;
+        this->d->m_semaphore = nullptr;
+    }
+
+    this->d->m_mutex.lock();
+    this->d->m_pending.clear();
+    this->d->m_stream.reset();
+    this->d->m_mutex.unlock();
+}
+
+bool AkShmChannel::writePacket(const AkPacket &packet)
+{
+    if (!this->d->m_memory.isAttached())
+        return false;
+
+    QMutexLocker locker(&this->d->m_mutex);
+    auto blob = this->d->m_stream.write(packet);
+    auto header = this->d->header();
+    quint64 capacity = header->capacity;
+    quint64 need = sizeof(quint32) + quint64(blob.size());
+
+    if (need > capacity)
+        return false;
+
+    quint64 writePos = header->writePos.load(std::memory_order_relaxed);
+    quint64 readPos = header->readPos.load(std::memory_order_acquire);
+    quint64 freeSpace = capacity - (writePos - readPos);
+    quint64 offset = writePos % capacity;
+    quint64 tail = capacity - offset;
+    quint64 skip = tail < need? tail: 0;
+
+    if (need + skip > freeSpace)
+        return false;
+
+    auto ring = this->d->ring();
+
+    if (skip) {
+        // The message wouldn't be contiguous here, skip the tail.
+        if (tail >= sizeof(quint32)) {
+            quint32 marker = AK_SHM_WRAP_MARKER;
+            memcpy(ring + offset, &marker, sizeof(quint32));
+        }
+
+        writePos += skip;
+        offset = 0;
+    }
+
+    quint32 size = quint32(blob.size());
+    memcpy(ring + offset, &size, sizeof(quint32));
+    memcpy(ring + offset + sizeof(quint32), blob.constData(), size_t(size));
+    header->writePos.store(writePos + need, std::memory_order_release);
+    this->d->m_semaphore->release();
+
+    return true;
+}
+
+AkPacket AkShmChannel::readPacket()
+{
+    if (!this->d->m_memory.isAttached() || !this->d->m_semaphore)
+        return AkPacket();
+
+    this->d->m_semaphore->acquire();
+
+    if (this->d->m_stopping.load())
+        return AkPacket();
+
+    this->d->m_mutex.lock();
+    auto header = this->d->header();
+    quint64 capacity = header->capacity;
+    auto ring = this->d->ring();
+    quint64 cursor = this->d->m_readCursor;
+    quint64 start = cursor;
+    quint64 offset = cursor % capacity;
+    quint64 tail = capacity - offset;
+
+    // A short or skipped tail counts as part of the next message's
+    // region, so releasing that message reclaims the tail too.
+    if (tail < sizeof(quint32)) {
+        cursor += tail;
+        offset = 0;
+    } else {
+        quint32 size = 0;
+        memcpy(&size, ring + offset, sizeof(quint32));
+
+        if (size == AK_SHM_WRAP_MARKER) {
+            cursor += tail;
+            offset = 0;
+        }
+    }
+
+    quint32 size = 0;
+    memcpy(&size, ring + offset, sizeof(quint32));
+    auto message = ring + offset + sizeof(quint32);
+    cursor += sizeof(quint32) + size;
+    this->d->m_readCursor = cursor;
+    this->d->m_pending[start] = cursor;
+    this->d->m_mutex.unlock();
+
+    auto d = this->d;
+    auto packet = this->d->m_stream.read(message,
+                                         int(size),
+                                         nullptr,
+                                         [d, start] () {
+                                             d->releaseRegion(start);
+                                         });
+
+    /* If no zero-copy payload was attached (malformed message, or a
+     * packet without payload), the release callback will never fire,
+     * reclaim the region right away.
+     */
+    if (packet.frameBuffer().isEmpty())
+        this->d->releaseRegion(start);
+
+    return packet;
+}
+
+void AkShmChannel::stop()
+{
+    this->d->m_stopping.store(true);
+
+    if (this->d->m_semaphore)
+        this->d->m_semaphore->release();
+}
+
+#include "moc_akshmchannel.cpp"
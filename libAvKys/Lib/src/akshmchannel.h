@@ -0,0 +1,81 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef AKSHMCHANNEL_H
+#define AKSHMCHANNEL_H
+
+#include "akpacket.h"
+
+class AkShmChannelPrivate;
+
+/* One-direction packet channel over shared memory.
+ *
+ * A named ring buffer of serialized packets (AkPacketStream layout)
+ * shared between two processes, one writer and one reader, with a system
+ * semaphore for cross-process wakeups. Messages are stored contiguously,
+ * the writer skips the ring tail when a message wouldn't fit in one
+ * piece, so the reader can hand the payload to the pipeline in place:
+ * reading is zero-copy, the ring space of a frame is reclaimed when the
+ * last packet reference drops.
+ *
+ * The writer never blocks; a frame that doesn't fit because the reader
+ * is behind is dropped, the same policy the audio rings apply on
+ * overrun.
+ */
+class AKCOMMONS_EXPORT AkShmChannel: public QObject
+{
+    Q_OBJECT
+
+    public:
+        explicit AkShmChannel(const QString &name, QObject *parent=nullptr);
+        ~AkShmChannel();
+
+        Q_INVOKABLE QString name() const;
+        Q_INVOKABLE bool isAttached() const;
+
+        /* Creates the segment and becomes the writer or reader side.
+         * 'size' is the ring capacity in bytes.
+         */
+        Q_INVOKABLE bool create(int size);
+
+        /* Attaches to a segment created by the peer process. */
+        Q_INVOKABLE bool attach();
+
+        Q_INVOKABLE void detach();
+
+        /* Serializes 'packet' into the ring. Returns false, dropping the
+         * frame, when the reader is too far behind.
+         */
+        Q_INVOKABLE bool writePacket(const AkPacket &packet);
+
+        /* Blocks until a packet arrives or stop() is called, in which
+         * case it returns a null packet. The returned packet references
+         * the ring directly.
+         */
+        Q_INVOKABLE AkPacket readPacket();
+
+    private:
+        AkShmChannelPrivate *d;
+
+    public Q_SLOTS:
+        /* Unblocks any reader waiting in readPacket(). */
+        void stop();
+};
+
+#endif // AKSHMCHANNEL_H
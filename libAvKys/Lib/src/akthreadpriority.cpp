@@ -0,0 +1,150 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QtGlobal>
+#include <cstring>
+
+#ifdef Q_OS_WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#ifdef Q_OS_LINUX
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "akthreadpriority.h"
+
+/* Modest realtime slots: enough to preempt any normal thread, low enough
+ * not to fight the kernel's own realtime workers. */
+#define FIFO_PRIORITY_AUDIO 10
+#define FIFO_PRIORITY_CAPTURE 5
+#define NICE_BACKGROUND 10
+
+#ifdef Q_OS_WIN32
+/* MMCSS registers the thread with the multimedia scheduler service. The
+ * library is loaded lazily so platforms without it just skip the boost. */
+static void applyMmcss(const wchar_t *taskName)
+{
+    typedef HANDLE (WINAPI *AvSetMmThreadCharacteristicsWFunc)(LPCWSTR,
+                                                               LPDWORD);
+    static AvSetMmThreadCharacteristicsWFunc avSetMmThreadCharacteristics =
+            nullptr;
+    static bool resolved = false;
+
+    if (!resolved) {
+        resolved = true;
+        auto avrt = LoadLibraryW(L"avrt.dll");
+
+        if (avrt)
+            avSetMmThreadCharacteristics =
+                    reinterpret_cast<AvSetMmThreadCharacteristicsWFunc>(
+                        GetProcAddress(avrt, "AvSetMmThreadCharacteristicsW"));
+    }
+
+    if (avSetMmThreadCharacteristics) {
+        DWORD taskIndex = 0;
+        avSetMmThreadCharacteristics(taskName, &taskIndex);
+    }
+}
+#endif
+
+bool AkThreadPriority::apply(ThreadClass threadClass)
+{
+#ifdef Q_OS_WIN32
+    int priority = THREAD_PRIORITY_NORMAL;
+
+    switch (threadClass) {
+    case ThreadClassRealtimeAudio:
+        applyMmcss(L"Pro Audio");
+        priority = THREAD_PRIORITY_TIME_CRITICAL;
+
+        break;
+    case ThreadClassCapture:
+        applyMmcss(L"Capture");
+        priority = THREAD_PRIORITY_HIGHEST;
+
+        break;
+    case ThreadClassProcessing:
+        return true;
+    case ThreadClassBackground:
+        priority = THREAD_PRIORITY_LOWEST;
+
+        break;
+    }
+
+    return SetThreadPriority(GetCurrentThread(), priority);
+#else
+    switch (threadClass) {
+    case ThreadClassRealtimeAudio:
+    case ThreadClassCapture: {
+        sched_param param;
+        memset(&param, 0, sizeof(sched_param));
+        param.sched_priority = threadClass == ThreadClassRealtimeAudio?
+                                   FIFO_PRIORITY_AUDIO:
+                                   FIFO_PRIORITY_CAPTURE;
+
+        if (pthread_setschedparam(pthread_self(),
+                                  SCHED_FIFO,
+                                  &param) == 0)
+            return true;
+
+#ifdef Q_OS_LINUX
+        /* No realtime privilege, a negative niceness still helps when
+         * RLIMIT_NICE allows it. */
+        auto tid = __pid_t(syscall(SYS_gettid));
+
+        if (setpriority(PRIO_PROCESS,
+                        id_t(tid),
+                        threadClass == ThreadClassRealtimeAudio?
+                            -10: -5) == 0)
+            return true;
+#endif
+
+        return false;
+    }
+    case ThreadClassProcessing:
+        return true;
+    case ThreadClassBackground: {
+#ifdef Q_OS_LINUX
+        auto tid = __pid_t(syscall(SYS_gettid));
+
+        return setpriority(PRIO_PROCESS,
+                           id_t(tid),
+                           NICE_BACKGROUND) == 0;
+#else
+        sched_param param;
+        memset(&param, 0, sizeof(sched_param));
+
+        return pthread_setschedparam(pthread_self(),
+                                     SCHED_OTHER,
+                                     &param) == 0;
+#endif
+    }
+    }
+
+    return false;
+#endif
+}
+
+#include "moc_akthreadpriority.cpp"
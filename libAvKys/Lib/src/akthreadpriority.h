@@ -0,0 +1,61 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef AKTHREADPRIORITY_H
+#define AKTHREADPRIORITY_H
+
+#include <QObject>
+
+#include "akcommons.h"
+
+/* Scheduling classes for the pipeline threads.
+ *
+ * Device loops compete with QML rendering at default priority, so a busy
+ * GUI can starve a capture thread past its dequeue deadline and drop
+ * frames the hardware delivered fine. Threads pick the class matching
+ * their deadline and apply() maps it to the best policy the platform
+ * grants: SCHED_FIFO on POSIX, priority plus MMCSS on Windows, falling
+ * back to plain niceness or to the default scheduling when the process
+ * lacks the privilege. Losing the elevation is never an error.
+ */
+class AKCOMMONS_EXPORT AkThreadPriority: public QObject
+{
+    Q_OBJECT
+
+    public:
+        enum ThreadClass
+        {
+            // Audio device callbacks, the tightest deadline.
+            ThreadClassRealtimeAudio,
+            // Device dequeue loops, a missed deadline drops a frame.
+            ThreadClassCapture,
+            // Frame conversion and effects, default scheduling.
+            ThreadClassProcessing,
+            // Housekeeping nobody waits for, yields to everything above.
+            ThreadClassBackground
+        };
+        Q_ENUM(ThreadClass)
+
+        /* Apply to the calling thread. Returns true when the elevated
+         * policy was granted, false when the thread keeps the default
+         * scheduling. */
+        Q_INVOKABLE static bool apply(ThreadClass threadClass);
+};
+
+#endif // AKTHREADPRIORITY_H
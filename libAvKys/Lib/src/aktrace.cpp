@@ -0,0 +1,204 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+
+#include "aktrace.h"
+#include "akpacketstream.h"
+
+// "AKTR" followed by the format version.
+#define TRACE_MAGIC 0x414b5452
+#define TRACE_VERSION 1
+
+class AkTracePrivate
+{
+    public:
+        QMutex m_mutex;
+        QFile m_file;
+        QDataStream m_dataStream;
+        AkPacketStream m_packetStream;
+        QElapsedTimer m_clock;
+        qint64 m_packets;
+        bool m_capturing;
+        bool m_reading;
+        bool m_payloads;
+
+        AkTracePrivate():
+            m_packets(0),
+            m_capturing(false),
+            m_reading(false),
+            m_payloads(true)
+        {
+        }
+};
+
+AkTrace::AkTrace(QObject *parent):
+    QObject(parent)
+{
+    this->d = new AkTracePrivate();
+}
+
+AkTrace::~AkTrace()
+{
+    this->stopCapture();
+    this->close();
+    delete this->d;
+}
+
+bool AkTrace::startCapture(const QString &fileName, bool payloads)
+{
+    QMutexLocker locker(&this->d->m_mutex);
+
+    if (this->d->m_capturing || this->d->m_reading)
+        return false;
+
+    this->d->m_file.setFileName(fileName);
+
+    if (!this->d->m_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    this->d->m_dataStream.setDevice(&this->d->m_file);
+    this->d->m_dataStream << quint32(TRACE_MAGIC)
+                          << quint16(TRACE_VERSION)
+                          << payloads;
+    this->d->m_packetStream.reset();
+    this->d->m_clock.start();
+    this->d->m_packets = 0;
+    this->d->m_payloads = payloads;
+    this->d->m_capturing = true;
+
+    return true;
+}
+
+void AkTrace::stopCapture()
+{
+    QMutexLocker locker(&this->d->m_mutex);
+
+    if (!this->d->m_capturing)
+        return;
+
+    this->d->m_capturing = false;
+    this->d->m_dataStream.setDevice(nullptr);
+    this->d->m_file.close();
+}
+
+bool AkTrace::capturing() const
+{
+    QMutexLocker locker(&this->d->m_mutex);
+
+    return this->d->m_capturing;
+}
+
+qint64 AkTrace::packets() const
+{
+    QMutexLocker locker(&this->d->m_mutex);
+
+    return this->d->m_packets;
+}
+
+bool AkTrace::open(const QString &fileName)
+{
+    QMutexLocker locker(&this->d->m_mutex);
+
+    if (this->d->m_capturing || this->d->m_reading)
+        return false;
+
+    this->d->m_file.setFileName(fileName);
+
+    if (!this->d->m_file.open(QIODevice::ReadOnly))
+        return false;
+
+    this->d->m_dataStream.setDevice(&this->d->m_file);
+    quint32 magic = 0;
+    quint16 version = 0;
+    this->d->m_dataStream >> magic >> version >> this->d->m_payloads;
+
+    if (magic != TRACE_MAGIC || version != TRACE_VERSION) {
+        this->d->m_dataStream.setDevice(nullptr);
+        this->d->m_file.close();
+
+        return false;
+    }
+
+    this->d->m_packetStream.reset();
+    this->d->m_packets = 0;
+    this->d->m_reading = true;
+
+    return true;
+}
+
+void AkTrace::close()
+{
+    QMutexLocker locker(&this->d->m_mutex);
+
+    if (!this->d->m_reading)
+        return;
+
+    this->d->m_reading = false;
+    this->d->m_dataStream.setDevice(nullptr);
+    this->d->m_file.close();
+}
+
+bool AkTrace::hasPayloads() const
+{
+    QMutexLocker locker(&this->d->m_mutex);
+
+    return this->d->m_payloads;
+}
+
+AkPacket AkTrace::readPacket(qint64 *timestampNs)
+{
+    QMutexLocker locker(&this->d->m_mutex);
+
+    if (!this->d->m_reading || this->d->m_dataStream.atEnd())
+        return AkPacket();
+
+    qint64 timestamp = 0;
+    QByteArray record;
+    this->d->m_dataStream >> timestamp >> record;
+
+    if (record.isEmpty())
+        return AkPacket();
+
+    if (timestampNs)
+        *timestampNs = timestamp;
+
+    this->d->m_packets++;
+
+    return this->d->m_packetStream.read(record);
+}
+
+void AkTrace::iStream(const AkPacket &packet)
+{
+    QMutexLocker locker(&this->d->m_mutex);
+
+    if (!this->d->m_capturing)
+        return;
+
+    auto record = this->d->m_payloads?
+                      this->d->m_packetStream.write(packet):
+                      this->d->m_packetStream.write(packet, QByteArray());
+    this->d->m_dataStream << this->d->m_clock.nsecsElapsed() << record;
+    this->d->m_packets++;
+}
+
+#include "moc_aktrace.cpp"
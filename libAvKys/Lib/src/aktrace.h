@@ -0,0 +1,70 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef AKTRACE_H
+#define AKTRACE_H
+
+#include "akpacket.h"
+
+class AkTracePrivate;
+
+/* Packet trace capture and playback.
+ *
+ * A trace is every packet that crossed a point of a live pipeline: caps,
+ * timing fields, the wall clock arrival time, and optionally the payload,
+ * in the AkPacketStream wire format with a small file header. Connect
+ * iStream() to any element's oStream signal to capture, then a replay
+ * driver re-feeds the file through any chain at maximum speed, so a
+ * customer's workload can be profiled without their devices. Payload-less
+ * traces stay tiny and still reproduce caps, sizes and timing exactly;
+ * the replayer substitutes synthetic pixels.
+ */
+class AKCOMMONS_EXPORT AkTrace: public QObject
+{
+    Q_OBJECT
+
+    public:
+        explicit AkTrace(QObject *parent=nullptr);
+        ~AkTrace();
+
+        /* Capture side. 'payloads' false records caps and timing only. */
+        Q_INVOKABLE bool startCapture(const QString &fileName,
+                                      bool payloads=true);
+        Q_INVOKABLE void stopCapture();
+        Q_INVOKABLE bool capturing() const;
+        Q_INVOKABLE qint64 packets() const;
+
+        /* Playback side. */
+        Q_INVOKABLE bool open(const QString &fileName);
+        Q_INVOKABLE void close();
+        Q_INVOKABLE bool hasPayloads() const;
+
+        /* Next packet of the trace, null at the end. 'timestampNs' is the
+         * arrival time relative to the capture start. */
+        AkPacket readPacket(qint64 *timestampNs=nullptr);
+
+    private:
+        AkTracePrivate *d;
+
+    public Q_SLOTS:
+        // Capture tap, connect any element's oStream signal here.
+        void iStream(const AkPacket &packet);
+};
+
+#endif // AKTRACE_H
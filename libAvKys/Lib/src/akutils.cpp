@@ -21,10 +21,13 @@
 #include <QImage>
 #include <QMap>
 #include <QVariant>
+#include <cstring>
 
 #include "akutils.h"
+#include "akbuffer.h"
 #include "akcaps.h"
 #include "akvideocaps.h"
+#include "akvideoconvert.h"
 #include "akpacket.h"
 #include "akvideopacket.h"
 
@@ -53,10 +56,6 @@ AkPacket AkUtils::imageToPacket(const QImage &image, const AkPacket &defaultPack
     if (!AkImageToFormat->contains(image.format()))
         return AkPacket();
 
-    size_t imageSize = size_t(image.bytesPerLine()) * size_t(image.height());
-    QByteArray oBuffer(int(imageSize), 0);
-    memcpy(oBuffer.data(), image.constBits(), imageSize);
-
     AkVideoCaps caps(defaultPacket.caps());
     caps.format() = AkImageToFormat->value(image.format());
     caps.bpp() = AkVideoCaps::bitsPerPixel(caps.format());
@@ -65,7 +64,41 @@ AkPacket AkUtils::imageToPacket(const QImage &image, const AkPacket &defaultPack
 
     AkPacket packet = defaultPacket;
     packet.setCaps(caps.toCaps());
-    packet.setBuffer(oBuffer);
+
+    int packedBytesPerLine = image.width() * image.depth() / 8;
+
+    if (image.bytesPerLine() == packedBytesPerLine) {
+        /* Hold a shallow QImage reference so the pixel data stays alive for
+         * as long as the packet circulates, instead of copying the whole
+         * frame. If the caller later modifies its image it detaches, leaving
+         * this view untouched. */
+        auto held = new QImage(image);
+        size_t imageSize =
+                size_t(held->bytesPerLine()) * size_t(held->height());
+        auto oBuffer =
+                AkBuffer::fromRawData(const_cast<quint8 *>(held->constBits()),
+                                      imageSize,
+                                      [held] () {
+                                          delete held;
+                                      });
+        packet.setBuffer({});
+        packet.setFrameBuffer(oBuffer);
+    } else {
+        /* QImage pads every row to 4 bytes, but packets carry packed rows
+         * and packetToImage() rebuilds its view with the packed stride, so
+         * padded frames are repacked row by row. Only sub-32bpp formats at
+         * widths not divisible by 4 take this copy. */
+        QByteArray oBuffer(packedBytesPerLine * image.height(), 0);
+        auto dst = oBuffer.data();
+
+        for (int y = 0; y < image.height(); y++) {
+            memcpy(dst, image.constScanLine(y), size_t(packedBytesPerLine));
+            dst += packedBytesPerLine;
+        }
+
+        packet.setBuffer(oBuffer);
+        packet.setFrameBuffer({});
+    }
 
     return packet;
 }
@@ -80,10 +113,23 @@ QImage AkUtils::packetToImage(const AkPacket &packet)
     if (!AkImageToFormat->values().contains(caps.format()))
         return QImage();
 
-    QImage image(caps.width(),
+    /* Alias the packet buffer instead of copying it, the cleanup function
+     * keeps a packet reference alive for as long as the view is in use.
+     * Writing to the image detaches it, so effects that modify the frame
+     * still pay at most one copy. */
+    auto held = new AkPacket(packet);
+    int bpp = caps.bpp() > 0?
+                  caps.bpp(): AkVideoCaps::bitsPerPixel(caps.format());
+    int bytesPerLine = bpp * caps.width() / 8;
+    QImage image(reinterpret_cast<const uchar *>(held->constData()),
+                 caps.width(),
                  caps.height(),
-                 AkImageToFormat->key(caps.format()));
-    memcpy(image.bits(), packet.buffer().constData(), size_t(packet.buffer().size()));
+                 bytesPerLine,
+                 AkImageToFormat->key(caps.format()),
+                 [] (void *info) {
+                     delete static_cast<AkPacket *>(info);
+                 },
+                 held);
 
     if (caps.format() == AkVideoCaps::Format_gray)
         for (int i = 0; i < 256; i++)
@@ -137,13 +183,23 @@ AkVideoPacket AkUtils::convertVideo(const AkVideoPacket &packet,
                                     AkVideoCaps::PixelFormat format,
                                     const QSize &size)
 {
-    if (!AkImageToFormat->values().contains(format))
-        return AkVideoPacket();
-
     if (packet.caps().format() == format
         && (size.isEmpty() || packet.caps().size() == size))
         return packet;
 
+    // Direct kernels skip the QImage round-trip for the common capture and
+    // effects formats whenever no rescaling is needed.
+    if ((size.isEmpty() || packet.caps().size() == size)
+        && AkVideoConvert::canConvert(packet.caps().format(), format)) {
+        auto oPacket = AkVideoConvert::convert(packet, format);
+
+        if (oPacket)
+            return oPacket;
+    }
+
+    if (!AkImageToFormat->values().contains(format))
+        return AkVideoPacket();
+
     QImage frame = AkUtils::packetToImage(packet.toPacket());
 
     if (frame.isNull())
@@ -21,7 +21,6 @@
 #include <QDebug>
 #include <QMetaEnum>
 #include <QSize>
-#include <QVector>
 
 #include "akvideocaps.h"
 #include "akfrac.h"
@@ -33,212 +32,247 @@ class VideoFormat
         AkVideoCaps::PixelFormat format;
         int bpp;
         quint32 fourCC;
+        int planes;
+        int planeBits[4];
+        int widthShift[4];
+        int heightShift[4];
+        int endianness;
+
+        static inline const VideoFormat *byFormat(AkVideoCaps::PixelFormat format);
+        static inline const VideoFormat *byBpp(int bpp);
+        static inline const VideoFormat *byFourCC(quint32 fourCC);
+};
 
-        static inline const QVector<VideoFormat> &formats()
-        {
-            static const QVector<VideoFormat> videoFormats = {
-                {AkVideoCaps::Format_none,             0, AK_FOURCC_NULL},
-                {AkVideoCaps::Format_yuv420p,         12, AkFourCC('I', '4', '2', '0')},
-                {AkVideoCaps::Format_yuyv422,         16, AkFourCC('Y', 'U', 'Y', '2')},
-                {AkVideoCaps::Format_rgb24,           24, AkFourCC('R', 'G', 'B', 24)},
-                {AkVideoCaps::Format_bgr24,           24, AkFourCC('B', 'G', 'R', 24)},
-                {AkVideoCaps::Format_yuv422p,         16, AkFourCC('Y', '4', '2', 'B')},
-                {AkVideoCaps::Format_yuv444p,         24, AkFourCC('4', '4', '4', 'P')},
-                {AkVideoCaps::Format_yuv410p,          9, AkFourCC('Y', 'U', 'V', '9')},
-                {AkVideoCaps::Format_yuv411p,         12, AkFourCC('Y', '4', '1', 'B')},
-                {AkVideoCaps::Format_gray,             8, AkFourCC('Y', '8', '0', '0')},
-                {AkVideoCaps::Format_monow,            1, AkFourCC('B', '1', 'W', '0')},
-                {AkVideoCaps::Format_monob,            1, AkFourCC('B', '0', 'W', '1')},
-                {AkVideoCaps::Format_pal8,             8, AkFourCC('P', 'A', 'L', 8)},
-                {AkVideoCaps::Format_yuvj420p,        12, AkFourCC('I', '4', '2', '0')},
-                {AkVideoCaps::Format_yuvj422p,        16, AkFourCC('Y', '4', '2', 'B')},
-                {AkVideoCaps::Format_yuvj444p,        24, AkFourCC('4', '4', '4', 'P')},
-                {AkVideoCaps::Format_uyvy422,         16, AkFourCC('U', 'Y', 'V', 'Y')},
-                {AkVideoCaps::Format_uyyvyy411,       12, AkFourCC('Y', '4', '1', '1')},
-                {AkVideoCaps::Format_bgr8,             8, AkFourCC('B', 'G', 'R', 8)},
-                {AkVideoCaps::Format_bgr4,             4, AkFourCC('B', 'G', 'R', 4)},
-                {AkVideoCaps::Format_bgr4_byte,        4, AkFourCC('R', '4', 'B', 'Y')},
-                {AkVideoCaps::Format_rgb8,             8, AkFourCC('R', 'G', 'B', 8)},
-                {AkVideoCaps::Format_rgb4,             4, AkFourCC('R', 'G', 'B', 4)},
-                {AkVideoCaps::Format_rgb4_byte,        4, AkFourCC('B', '4', 'B', 'Y')},
-                {AkVideoCaps::Format_nv12,            12, AkFourCC('N', 'V', '1', '2')},
-                {AkVideoCaps::Format_nv21,            12, AkFourCC('N', 'V', '2', '1')},
-                {AkVideoCaps::Format_argb,            32, AkFourCC('A', 'R', 'G', 'B')},
-                {AkVideoCaps::Format_rgba,            32, AkFourCC('R', 'G', 'B', 'A')},
-                {AkVideoCaps::Format_abgr,            32, AkFourCC('A', 'B', 'G', 'R')},
-                {AkVideoCaps::Format_bgra,            32, AkFourCC('B', 'G', 'R', 'A')},
-                {AkVideoCaps::Format_gray16be,        16, AkFourCC(16, 0, '1', 'Y')},
-                {AkVideoCaps::Format_gray16le,        16, AkFourCC('Y', '1', 0, 16)},
-                {AkVideoCaps::Format_yuv440p,         16, AkFourCC('4', '4', '0', 'P')},
-                {AkVideoCaps::Format_yuvj440p,        16, AkFourCC('4', '4', '0', 'P')},
-                {AkVideoCaps::Format_yuva420p,        20, AkFourCC('Y', '4', 11, 8)},
-                {AkVideoCaps::Format_rgb48be,         48, AkFourCC('0', 'R', 'G', 'B')},
-                {AkVideoCaps::Format_rgb48le,         48, AkFourCC('R', 'G', 'B', '0')},
-                {AkVideoCaps::Format_rgb565be,        16, AkFourCC(16, 'B', 'G', 'R')},
-                {AkVideoCaps::Format_rgb565le,        16, AkFourCC('R', 'G', 'B', 16)},
-                {AkVideoCaps::Format_rgb555be,        15, AkFourCC(15, 'B', 'G', 'R')},
-                {AkVideoCaps::Format_rgb555le,        15, AkFourCC('R', 'G', 'B', 15)},
-                {AkVideoCaps::Format_bgr565be,        16, AkFourCC(16, 'R', 'G', 'B')},
-                {AkVideoCaps::Format_bgr565le,        16, AkFourCC('B', 'G', 'R', 16)},
-                {AkVideoCaps::Format_bgr555be,        15, AkFourCC(15, 'R', 'G', 'B')},
-                {AkVideoCaps::Format_bgr555le,        15, AkFourCC('B', 'G', 'R', 15)},
-                {AkVideoCaps::Format_yuv420p16le,     24, AkFourCC('Y', '3', 11, 16)},
-                {AkVideoCaps::Format_yuv420p16be,     24, AkFourCC(16, 11, '3', 'Y')},
-                {AkVideoCaps::Format_yuv422p16le,     32, AkFourCC('Y', '3', 10, 16)},
-                {AkVideoCaps::Format_yuv422p16be,     32, AkFourCC(16, 10, '3', 'Y')},
-                {AkVideoCaps::Format_yuv444p16le,     48, AkFourCC('Y', '3', 0, 16)},
-                {AkVideoCaps::Format_yuv444p16be,     48, AkFourCC(16, 0, '3', 'Y')},
-                {AkVideoCaps::Format_rgb444le,        12, AkFourCC('R', 'G', 'B', 12)},
-                {AkVideoCaps::Format_rgb444be,        12, AkFourCC(12, 'B', 'G', 'R')},
-                {AkVideoCaps::Format_bgr444le,        12, AkFourCC('B', 'G', 'R', 12)},
-                {AkVideoCaps::Format_bgr444be,        12, AkFourCC(12, 'R', 'G', 'B')},
-                {AkVideoCaps::Format_ya8,             16, AkFourCC('Y', '2', 0, 8)},
-                {AkVideoCaps::Format_bgr48be,         48, AkFourCC('0', 'B', 'G', 'R')},
-                {AkVideoCaps::Format_bgr48le,         48, AkFourCC('B', 'G', 'R', '0')},
-                {AkVideoCaps::Format_yuv420p9be,      13, AkFourCC(9, 11, '3', 'Y')},
-                {AkVideoCaps::Format_yuv420p9le,      13, AkFourCC('Y', '3', 11, 9)},
-                {AkVideoCaps::Format_yuv420p10be,     15, AkFourCC(10, 11, '3', 'Y')},
-                {AkVideoCaps::Format_yuv420p10le,     15, AkFourCC('Y', '3', 11, 10)},
-                {AkVideoCaps::Format_yuv422p10be,     20, AkFourCC(10, 10, '3', 'Y')},
-                {AkVideoCaps::Format_yuv422p10le,     20, AkFourCC('Y', '3', 10, 10)},
-                {AkVideoCaps::Format_yuv444p9be,      27, AkFourCC(9, 0, '3', 'Y')},
-                {AkVideoCaps::Format_yuv444p9le,      27, AkFourCC('Y', '3', 0, 9)},
-                {AkVideoCaps::Format_yuv444p10be,     30, AkFourCC(10, 0, '3', 'Y')},
-                {AkVideoCaps::Format_yuv444p10le,     30, AkFourCC('Y', '3', 0, 10)},
-                {AkVideoCaps::Format_yuv422p9be,      18, AkFourCC(9, 10, '3', 'Y')},
-                {AkVideoCaps::Format_yuv422p9le,      18, AkFourCC('Y', '3', 10, 9)},
-                {AkVideoCaps::Format_gbrp,            24, AkFourCC('G', '3', 0, 8)},
-                {AkVideoCaps::Format_gbrp9be,         27, AkFourCC(9, 0, '3', 'G')},
-                {AkVideoCaps::Format_gbrp9le,         27, AkFourCC('G', '3', 0, 9)},
-                {AkVideoCaps::Format_gbrp10be,        30, AkFourCC(10, 0, '3', 'G')},
-                {AkVideoCaps::Format_gbrp10le,        30, AkFourCC('G', '3', 0, 10)},
-                {AkVideoCaps::Format_gbrp16be,        48, AkFourCC(16, 0, '3', 'G')},
-                {AkVideoCaps::Format_gbrp16le,        48, AkFourCC('G', '3', 0, 16)},
-                {AkVideoCaps::Format_yuva422p,        24, AkFourCC('Y', '4', 10, 8)},
-                {AkVideoCaps::Format_yuva444p,        32, AkFourCC('Y', '4', 0, 8)},
-                {AkVideoCaps::Format_yuva420p9be,     22, AkFourCC(9, 11, '4', 'Y')},
-                {AkVideoCaps::Format_yuva420p9le,     22, AkFourCC('Y', '4', 11, 9)},
-                {AkVideoCaps::Format_yuva422p9be,     27, AkFourCC(9, 10, '4', 'Y')},
-                {AkVideoCaps::Format_yuva422p9le,     27, AkFourCC('Y', '4', 10, 9)},
-                {AkVideoCaps::Format_yuva444p9be,     36, AkFourCC(9, 0, '4', 'Y')},
-                {AkVideoCaps::Format_yuva444p9le,     36, AkFourCC('Y', '4', 0, 9)},
-                {AkVideoCaps::Format_yuva420p10be,    25, AkFourCC(10, 11, '4', 'Y')},
-                {AkVideoCaps::Format_yuva420p10le,    25, AkFourCC('Y', '4', 11, 10)},
-                {AkVideoCaps::Format_yuva422p10be,    30, AkFourCC(10, 10, '4', 'Y')},
-                {AkVideoCaps::Format_yuva422p10le,    30, AkFourCC('Y', '4', 10, 10)},
-                {AkVideoCaps::Format_yuva444p10be,    40, AkFourCC(10, 0, '4', 'Y')},
-                {AkVideoCaps::Format_yuva444p10le,    40, AkFourCC('Y', '4', 0, 10)},
-                {AkVideoCaps::Format_yuva420p16be,    40, AkFourCC(16, 11, '4', 'Y')},
-                {AkVideoCaps::Format_yuva420p16le,    40, AkFourCC('Y', '4', 11, 16)},
-                {AkVideoCaps::Format_yuva422p16be,    48, AkFourCC(16, 10, '4', 'Y')},
-                {AkVideoCaps::Format_yuva422p16le,    48, AkFourCC('Y', '4', 10, 16)},
-                {AkVideoCaps::Format_yuva444p16be,    64, AkFourCC(16, 0, '4', 'Y')},
-                {AkVideoCaps::Format_yuva444p16le,    64, AkFourCC('Y', '4', 0, 16)},
-                {AkVideoCaps::Format_xyz12le,         36, AkFourCC('X', 'Y', 'Z', '$')},
-                {AkVideoCaps::Format_xyz12be,         36, AkFourCC('$', 'Z', 'Y', 'X')},
-                {AkVideoCaps::Format_nv16,            16, AK_FOURCC_NULL},
-                {AkVideoCaps::Format_nv20le,          20, AK_FOURCC_NULL},
-                {AkVideoCaps::Format_nv20be,          20, AK_FOURCC_NULL},
-                {AkVideoCaps::Format_rgba64be,        64, AkFourCC('@', 'R', 'B', 'A')},
-                {AkVideoCaps::Format_rgba64le,        64, AkFourCC('R', 'B', 'A', '@')},
-                {AkVideoCaps::Format_bgra64be,        64, AkFourCC('@', 'B', 'R', 'A')},
-                {AkVideoCaps::Format_bgra64le,        64, AkFourCC('B', 'R', 'A', '@')},
-                {AkVideoCaps::Format_yvyu422,         16, AkFourCC('Y', 'V', 'Y', 'U')},
-                {AkVideoCaps::Format_ya16be,          32, AK_FOURCC_NULL},
-                {AkVideoCaps::Format_ya16le,          32, AK_FOURCC_NULL},
-                {AkVideoCaps::Format_gbrap,           32, AkFourCC('G', '4', 0, 8)},
-                {AkVideoCaps::Format_gbrap16be,       64, AkFourCC(16, 0, '4', 'G')},
-                {AkVideoCaps::Format_gbrap16le,       64, AkFourCC('G', '4', 0, 16)},
-                {AkVideoCaps::Format_0rgb,            24, AkFourCC(0, 'R', 'G', 'B')},
-                {AkVideoCaps::Format_rgb0,            24, AkFourCC('R', 'G', 'B', 0)},
-                {AkVideoCaps::Format_0bgr,            24, AkFourCC(0, 'B', 'G', 'R')},
-                {AkVideoCaps::Format_bgr0,            24, AkFourCC('B', 'G', 'R', 0)},
-                {AkVideoCaps::Format_yuv420p12be,     18, AkFourCC(12, 11, '3', 'Y')},
-                {AkVideoCaps::Format_yuv420p12le,     18, AkFourCC('Y', '3', 11, 12)},
-                {AkVideoCaps::Format_yuv420p14be,     21, AkFourCC(14, 11, '3', 'Y')},
-                {AkVideoCaps::Format_yuv420p14le,     21, AkFourCC('Y', '3', 11, 14)},
-                {AkVideoCaps::Format_yuv422p12be,     24, AkFourCC(12, 10, '3', 'Y')},
-                {AkVideoCaps::Format_yuv422p12le,     24, AkFourCC('Y', '3', 10, 12)},
-                {AkVideoCaps::Format_yuv422p14be,     28, AkFourCC(14, 10, '3', 'Y')},
-                {AkVideoCaps::Format_yuv422p14le,     28, AkFourCC('Y', '3', 10, 14)},
-                {AkVideoCaps::Format_yuv444p12be,     36, AkFourCC(12, 0, '3', 'Y')},
-                {AkVideoCaps::Format_yuv444p12le,     36, AkFourCC('Y', '3', 0, 12)},
-                {AkVideoCaps::Format_yuv444p14be,     42, AkFourCC(14, 0, '3', 'Y')},
-                {AkVideoCaps::Format_yuv444p14le,     42, AkFourCC('Y', '3', 0, 14)},
-                {AkVideoCaps::Format_gbrp12be,        36, AkFourCC(12, 0, '3', 'G')},
-                {AkVideoCaps::Format_gbrp12le,        36, AkFourCC('G', '3', 0, 12)},
-                {AkVideoCaps::Format_gbrp14be,        42, AkFourCC(14, 0, '3', 'G')},
-                {AkVideoCaps::Format_gbrp14le,        42, AkFourCC('G', '3', 0, 14)},
-                {AkVideoCaps::Format_yuvj411p,        12, AK_FOURCC_NULL},
-                {AkVideoCaps::Format_bayer_bggr8,      8, AkFourCC(0xBA, 'B', 'G',    8)},
-                {AkVideoCaps::Format_bayer_rggb8,      8, AkFourCC(0xBA, 'R', 'G',    8)},
-                {AkVideoCaps::Format_bayer_gbrg8,      8, AkFourCC(0xBA, 'G', 'B',    8)},
-                {AkVideoCaps::Format_bayer_grbg8,      8, AkFourCC(0xBA, 'G', 'R',    8)},
-                {AkVideoCaps::Format_bayer_bggr16le,  16, AkFourCC(0xBA, 'B', 'G',   16)},
-                {AkVideoCaps::Format_bayer_bggr16be,  16, AkFourCC(  16, 'G', 'B', 0xBA)},
-                {AkVideoCaps::Format_bayer_rggb16le,  16, AkFourCC(0xBA, 'R', 'G',   16)},
-                {AkVideoCaps::Format_bayer_rggb16be,  16, AkFourCC(  16, 'G', 'R', 0xBA)},
-                {AkVideoCaps::Format_bayer_gbrg16le,  16, AkFourCC(0xBA, 'G', 'B',   16)},
-                {AkVideoCaps::Format_bayer_gbrg16be,  16, AkFourCC(  16, 'B', 'G', 0xBA)},
-                {AkVideoCaps::Format_bayer_grbg16le,  16, AkFourCC(0xBA, 'G', 'R',   16)},
-                {AkVideoCaps::Format_bayer_grbg16be,  16, AkFourCC(  16, 'R', 'G', 0xBA)},
-                {AkVideoCaps::Format_yuv440p10le,     20, AK_FOURCC_NULL},
-                {AkVideoCaps::Format_yuv440p10be,     20, AK_FOURCC_NULL},
-                {AkVideoCaps::Format_yuv440p12le,     24, AK_FOURCC_NULL},
-                {AkVideoCaps::Format_yuv440p12be,     24, AK_FOURCC_NULL},
-                {AkVideoCaps::Format_ayuv64le,        64, AK_FOURCC_NULL},
-                {AkVideoCaps::Format_ayuv64be,        64, AK_FOURCC_NULL},
-                {AkVideoCaps::Format_p010le,          15, AK_FOURCC_NULL},
-                {AkVideoCaps::Format_p010be,          15, AK_FOURCC_NULL},
-                {AkVideoCaps::Format_gbrap12be,       48, AkFourCC(12, 0, '4', 'G')},
-                {AkVideoCaps::Format_gbrap12le,       48, AkFourCC('G', '4', 0, 12)},
-                {AkVideoCaps::Format_gbrap10be,       40, AkFourCC(10, 0, '4', 'G')},
-                {AkVideoCaps::Format_gbrap10le,       40, AkFourCC('G', '4', 0, 10)},
-                {AkVideoCaps::Format_gray12be,        12, AkFourCC(12, 0, '1', 'Y')},
-                {AkVideoCaps::Format_gray12le,        12, AkFourCC('Y', '1', 0, 12)},
-                {AkVideoCaps::Format_gray10be,        10, AkFourCC(10, 0, '1', 'Y')},
-                {AkVideoCaps::Format_gray10le,        10, AkFourCC('Y', '1', 0, 10)},
-                {AkVideoCaps::Format_p016le,          24, AK_FOURCC_NULL},
-                {AkVideoCaps::Format_p016be,          24, AK_FOURCC_NULL},
-                {AkVideoCaps::Format_gray9be,          9, AkFourCC(9, 0, '1', 'Y')},
-                {AkVideoCaps::Format_gray9le,          9, AkFourCC('Y', '1', 0, 9)},
-                {AkVideoCaps::Format_gbrpf32be,       96, AK_FOURCC_NULL},
-                {AkVideoCaps::Format_gbrpf32le,       96, AK_FOURCC_NULL},
-                {AkVideoCaps::Format_gbrapf32be,     128, AK_FOURCC_NULL},
-                {AkVideoCaps::Format_gbrapf32le,     128, AK_FOURCC_NULL},
-            };
-
-            return videoFormats;
-        }
-
-        static inline const VideoFormat *byFormat(AkVideoCaps::PixelFormat format)
-        {
-            for (int i = 0; i < formats().size(); i++)
-                if (formats()[i].format == format)
-                    return &formats()[i];
-
-            return &formats()[0];
-        }
-
-        static inline const VideoFormat *byBpp(int bpp)
-        {
-            for (int i = 0; i < formats().size(); i++)
-                if (formats()[i].bpp == bpp)
-                    return &formats()[i];
-
-            return &formats()[0];
-        }
-
-        static inline const VideoFormat *byFourCC(quint32 fourCC)
-        {
-            for (int i = 0; i < formats().size(); i++)
-                if (formats()[i].fourCC == fourCC)
-                    return &formats()[i];
-
-            return &formats()[0];
-        }
+/* One row per pixel format, in enumeration order with Format_none first, so
+ * looking a format up is a plain array load. Each row carries the bits per
+ * pixel, the fourCC, the plane layout as bits per sample and subsampling
+ * shifts per plane, and the endianness of the stored samples. The hardware
+ * surface formats carry no data.
+ */
+static const VideoFormat akVideoCapsFormats[] = {
+    {AkVideoCaps::Format_none,              0, AK_FOURCC_NULL, 1, { 0,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_yuv420p,          12, AkFourCC('I', '4', '2', '0'), 3, { 8,  8,  8,  0}, { 0,  1,  1,  0}, { 0,  1,  1,  0}, 0},
+    {AkVideoCaps::Format_yuyv422,          16, AkFourCC('Y', 'U', 'Y', '2'), 1, {16,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_rgb24,            24, AkFourCC('R', 'G', 'B', 24), 1, {24,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_bgr24,            24, AkFourCC('B', 'G', 'R', 24), 1, {24,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_yuv422p,          16, AkFourCC('Y', '4', '2', 'B'), 3, { 8,  8,  8,  0}, { 0,  1,  1,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_yuv444p,          24, AkFourCC('4', '4', '4', 'P'), 3, { 8,  8,  8,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_yuv410p,           9, AkFourCC('Y', 'U', 'V', '9'), 3, { 8,  8,  8,  0}, { 0,  2,  2,  0}, { 0,  2,  2,  0}, 0},
+    {AkVideoCaps::Format_yuv411p,          12, AkFourCC('Y', '4', '1', 'B'), 3, { 8,  8,  8,  0}, { 0,  2,  2,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_gray,              8, AkFourCC('Y', '8', '0', '0'), 1, { 8,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_monow,             1, AkFourCC('B', '1', 'W', '0'), 1, { 1,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_monob,             1, AkFourCC('B', '0', 'W', '1'), 1, { 1,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_pal8,              8, AkFourCC('P', 'A', 'L', 8), 1, { 8,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_yuvj420p,         12, AkFourCC('I', '4', '2', '0'), 3, { 8,  8,  8,  0}, { 0,  1,  1,  0}, { 0,  1,  1,  0}, 0},
+    {AkVideoCaps::Format_yuvj422p,         16, AkFourCC('Y', '4', '2', 'B'), 3, { 8,  8,  8,  0}, { 0,  1,  1,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_yuvj444p,         24, AkFourCC('4', '4', '4', 'P'), 3, { 8,  8,  8,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_xvmcmc,            0, AK_FOURCC_NULL, 1, { 0,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_xvmcidct,          0, AK_FOURCC_NULL, 1, { 0,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_uyvy422,          16, AkFourCC('U', 'Y', 'V', 'Y'), 1, {16,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_uyyvyy411,        12, AkFourCC('Y', '4', '1', '1'), 1, {12,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_bgr8,              8, AkFourCC('B', 'G', 'R', 8), 1, { 8,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_bgr4,              4, AkFourCC('B', 'G', 'R', 4), 1, { 4,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_bgr4_byte,         4, AkFourCC('R', '4', 'B', 'Y'), 1, { 4,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_rgb8,              8, AkFourCC('R', 'G', 'B', 8), 1, { 8,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_rgb4,              4, AkFourCC('R', 'G', 'B', 4), 1, { 4,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_rgb4_byte,         4, AkFourCC('B', '4', 'B', 'Y'), 1, { 4,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_nv12,             12, AkFourCC('N', 'V', '1', '2'), 2, { 8, 16,  0,  0}, { 0,  1,  0,  0}, { 0,  1,  0,  0}, 0},
+    {AkVideoCaps::Format_nv21,             12, AkFourCC('N', 'V', '2', '1'), 2, { 8, 16,  0,  0}, { 0,  1,  0,  0}, { 0,  1,  0,  0}, 0},
+    {AkVideoCaps::Format_argb,             32, AkFourCC('A', 'R', 'G', 'B'), 1, {32,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_rgba,             32, AkFourCC('R', 'G', 'B', 'A'), 1, {32,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_abgr,             32, AkFourCC('A', 'B', 'G', 'R'), 1, {32,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_bgra,             32, AkFourCC('B', 'G', 'R', 'A'), 1, {32,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_gray16be,         16, AkFourCC(16, 0, '1', 'Y'), 1, {16,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_gray16le,         16, AkFourCC('Y', '1', 0, 16), 1, {16,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_yuv440p,          16, AkFourCC('4', '4', '0', 'P'), 3, { 8,  8,  8,  0}, { 0,  0,  0,  0}, { 0,  1,  1,  0}, 0},
+    {AkVideoCaps::Format_yuvj440p,         16, AkFourCC('4', '4', '0', 'P'), 3, { 8,  8,  8,  0}, { 0,  0,  0,  0}, { 0,  1,  1,  0}, 0},
+    {AkVideoCaps::Format_yuva420p,         20, AkFourCC('Y', '4', 11, 8), 4, { 8,  8,  8,  8}, { 0,  1,  1,  0}, { 0,  1,  1,  0}, 0},
+    {AkVideoCaps::Format_vdpau_h264,        0, AK_FOURCC_NULL, 1, { 0,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_vdpau_mpeg1,       0, AK_FOURCC_NULL, 1, { 0,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_vdpau_mpeg2,       0, AK_FOURCC_NULL, 1, { 0,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_vdpau_wmv3,        0, AK_FOURCC_NULL, 1, { 0,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_vdpau_vc1,         0, AK_FOURCC_NULL, 1, { 0,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_rgb48be,          48, AkFourCC('0', 'R', 'G', 'B'), 1, {48,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_rgb48le,          48, AkFourCC('R', 'G', 'B', '0'), 1, {48,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_rgb565be,         16, AkFourCC(16, 'B', 'G', 'R'), 1, {16,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_rgb565le,         16, AkFourCC('R', 'G', 'B', 16), 1, {16,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_rgb555be,         15, AkFourCC(15, 'B', 'G', 'R'), 1, {15,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_rgb555le,         15, AkFourCC('R', 'G', 'B', 15), 1, {15,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_bgr565be,         16, AkFourCC(16, 'R', 'G', 'B'), 1, {16,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_bgr565le,         16, AkFourCC('B', 'G', 'R', 16), 1, {16,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_bgr555be,         15, AkFourCC(15, 'R', 'G', 'B'), 1, {15,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_bgr555le,         15, AkFourCC('B', 'G', 'R', 15), 1, {15,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_vaapi_moco,        0, AK_FOURCC_NULL, 1, { 0,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_vaapi_idct,        0, AK_FOURCC_NULL, 1, { 0,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_vaapi_vld,         0, AK_FOURCC_NULL, 1, { 0,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_yuv420p16le,      24, AkFourCC('Y', '3', 11, 16), 3, {16, 16, 16,  0}, { 0,  1,  1,  0}, { 0,  1,  1,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_yuv420p16be,      24, AkFourCC(16, 11, '3', 'Y'), 3, {16, 16, 16,  0}, { 0,  1,  1,  0}, { 0,  1,  1,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_yuv422p16le,      32, AkFourCC('Y', '3', 10, 16), 3, {16, 16, 16,  0}, { 0,  1,  1,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_yuv422p16be,      32, AkFourCC(16, 10, '3', 'Y'), 3, {16, 16, 16,  0}, { 0,  1,  1,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_yuv444p16le,      48, AkFourCC('Y', '3', 0, 16), 3, {16, 16, 16,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_yuv444p16be,      48, AkFourCC(16, 0, '3', 'Y'), 3, {16, 16, 16,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_vdpau_mpeg4,       0, AK_FOURCC_NULL, 1, { 0,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_dxva2_vld,         0, AK_FOURCC_NULL, 1, { 0,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_rgb444le,         12, AkFourCC('R', 'G', 'B', 12), 1, {12,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_rgb444be,         12, AkFourCC(12, 'B', 'G', 'R'), 1, {12,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_bgr444le,         12, AkFourCC('B', 'G', 'R', 12), 1, {12,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_bgr444be,         12, AkFourCC(12, 'R', 'G', 'B'), 1, {12,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_ya8,              16, AkFourCC('Y', '2', 0, 8), 1, {16,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_bgr48be,          48, AkFourCC('0', 'B', 'G', 'R'), 1, {48,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_bgr48le,          48, AkFourCC('B', 'G', 'R', '0'), 1, {48,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_yuv420p9be,       13, AkFourCC(9, 11, '3', 'Y'), 3, {16, 16, 16,  0}, { 0,  1,  1,  0}, { 0,  1,  1,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_yuv420p9le,       13, AkFourCC('Y', '3', 11, 9), 3, {16, 16, 16,  0}, { 0,  1,  1,  0}, { 0,  1,  1,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_yuv420p10be,      15, AkFourCC(10, 11, '3', 'Y'), 3, {16, 16, 16,  0}, { 0,  1,  1,  0}, { 0,  1,  1,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_yuv420p10le,      15, AkFourCC('Y', '3', 11, 10), 3, {16, 16, 16,  0}, { 0,  1,  1,  0}, { 0,  1,  1,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_yuv422p10be,      20, AkFourCC(10, 10, '3', 'Y'), 3, {16, 16, 16,  0}, { 0,  1,  1,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_yuv422p10le,      20, AkFourCC('Y', '3', 10, 10), 3, {16, 16, 16,  0}, { 0,  1,  1,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_yuv444p9be,       27, AkFourCC(9, 0, '3', 'Y'), 3, {16, 16, 16,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_yuv444p9le,       27, AkFourCC('Y', '3', 0, 9), 3, {16, 16, 16,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_yuv444p10be,      30, AkFourCC(10, 0, '3', 'Y'), 3, {16, 16, 16,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_yuv444p10le,      30, AkFourCC('Y', '3', 0, 10), 3, {16, 16, 16,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_yuv422p9be,       18, AkFourCC(9, 10, '3', 'Y'), 3, {16, 16, 16,  0}, { 0,  1,  1,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_yuv422p9le,       18, AkFourCC('Y', '3', 10, 9), 3, {16, 16, 16,  0}, { 0,  1,  1,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_vda_vld,           0, AK_FOURCC_NULL, 1, { 0,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_gbrp,             24, AkFourCC('G', '3', 0, 8), 3, { 8,  8,  8,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_gbrp9be,          27, AkFourCC(9, 0, '3', 'G'), 3, {16, 16, 16,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_gbrp9le,          27, AkFourCC('G', '3', 0, 9), 3, {16, 16, 16,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_gbrp10be,         30, AkFourCC(10, 0, '3', 'G'), 3, {16, 16, 16,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_gbrp10le,         30, AkFourCC('G', '3', 0, 10), 3, {16, 16, 16,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_gbrp16be,         48, AkFourCC(16, 0, '3', 'G'), 3, {16, 16, 16,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_gbrp16le,         48, AkFourCC('G', '3', 0, 16), 3, {16, 16, 16,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_yuva420p9be,      22, AkFourCC(9, 11, '4', 'Y'), 4, {16, 16, 16, 16}, { 0,  1,  1,  0}, { 0,  1,  1,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_yuva420p9le,      22, AkFourCC('Y', '4', 11, 9), 4, {16, 16, 16, 16}, { 0,  1,  1,  0}, { 0,  1,  1,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_yuva422p9be,      27, AkFourCC(9, 10, '4', 'Y'), 4, {16, 16, 16, 16}, { 0,  1,  1,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_yuva422p9le,      27, AkFourCC('Y', '4', 10, 9), 4, {16, 16, 16, 16}, { 0,  1,  1,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_yuva444p9be,      36, AkFourCC(9, 0, '4', 'Y'), 4, {16, 16, 16, 16}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_yuva444p9le,      36, AkFourCC('Y', '4', 0, 9), 4, {16, 16, 16, 16}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_yuva420p10be,     25, AkFourCC(10, 11, '4', 'Y'), 4, {16, 16, 16, 16}, { 0,  1,  1,  0}, { 0,  1,  1,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_yuva420p10le,     25, AkFourCC('Y', '4', 11, 10), 4, {16, 16, 16, 16}, { 0,  1,  1,  0}, { 0,  1,  1,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_yuva422p10be,     30, AkFourCC(10, 10, '4', 'Y'), 4, {16, 16, 16, 16}, { 0,  1,  1,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_yuva422p10le,     30, AkFourCC('Y', '4', 10, 10), 4, {16, 16, 16, 16}, { 0,  1,  1,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_yuva444p10be,     40, AkFourCC(10, 0, '4', 'Y'), 4, {16, 16, 16, 16}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_yuva444p10le,     40, AkFourCC('Y', '4', 0, 10), 4, {16, 16, 16, 16}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_yuva420p16be,     40, AkFourCC(16, 11, '4', 'Y'), 4, {16, 16, 16, 16}, { 0,  1,  1,  0}, { 0,  1,  1,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_yuva420p16le,     40, AkFourCC('Y', '4', 11, 16), 4, {16, 16, 16, 16}, { 0,  1,  1,  0}, { 0,  1,  1,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_yuva422p16be,     48, AkFourCC(16, 10, '4', 'Y'), 4, {16, 16, 16, 16}, { 0,  1,  1,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_yuva422p16le,     48, AkFourCC('Y', '4', 10, 16), 4, {16, 16, 16, 16}, { 0,  1,  1,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_yuva444p16be,     64, AkFourCC(16, 0, '4', 'Y'), 4, {16, 16, 16, 16}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_yuva444p16le,     64, AkFourCC('Y', '4', 0, 16), 4, {16, 16, 16, 16}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_vdpau,             0, AK_FOURCC_NULL, 1, { 0,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_xyz12le,          36, AkFourCC('X', 'Y', 'Z', '$'), 1, {36,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_xyz12be,          36, AkFourCC('$', 'Z', 'Y', 'X'), 1, {36,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_nv16,             16, AK_FOURCC_NULL, 2, { 8, 16,  0,  0}, { 0,  1,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_nv20le,           20, AK_FOURCC_NULL, 2, {16, 32,  0,  0}, { 0,  1,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_nv20be,           20, AK_FOURCC_NULL, 2, {16, 32,  0,  0}, { 0,  1,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_yvyu422,          16, AkFourCC('Y', 'V', 'Y', 'U'), 1, {16,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_vda,               0, AK_FOURCC_NULL, 1, { 0,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_ya16be,           32, AK_FOURCC_NULL, 1, {32,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_ya16le,           32, AK_FOURCC_NULL, 1, {32,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_qsv,               0, AK_FOURCC_NULL, 1, { 0,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_mmal,              0, AK_FOURCC_NULL, 1, { 0,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_d3d11va_vld,       0, AK_FOURCC_NULL, 1, { 0,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_rgba64be,         64, AkFourCC('@', 'R', 'B', 'A'), 1, {64,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_rgba64le,         64, AkFourCC('R', 'B', 'A', '@'), 1, {64,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_bgra64be,         64, AkFourCC('@', 'B', 'R', 'A'), 1, {64,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_bgra64le,         64, AkFourCC('B', 'R', 'A', '@'), 1, {64,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_0rgb,             24, AkFourCC(0, 'R', 'G', 'B'), 1, {24,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_rgb0,             24, AkFourCC('R', 'G', 'B', 0), 1, {24,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_0bgr,             24, AkFourCC(0, 'B', 'G', 'R'), 1, {24,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_bgr0,             24, AkFourCC('B', 'G', 'R', 0), 1, {24,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_yuva444p,         32, AkFourCC('Y', '4', 0, 8), 4, { 8,  8,  8,  8}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_yuva422p,         24, AkFourCC('Y', '4', 10, 8), 4, { 8,  8,  8,  8}, { 0,  1,  1,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_yuv420p12be,      18, AkFourCC(12, 11, '3', 'Y'), 3, {16, 16, 16,  0}, { 0,  1,  1,  0}, { 0,  1,  1,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_yuv420p12le,      18, AkFourCC('Y', '3', 11, 12), 3, {16, 16, 16,  0}, { 0,  1,  1,  0}, { 0,  1,  1,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_yuv420p14be,      21, AkFourCC(14, 11, '3', 'Y'), 3, {16, 16, 16,  0}, { 0,  1,  1,  0}, { 0,  1,  1,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_yuv420p14le,      21, AkFourCC('Y', '3', 11, 14), 3, {16, 16, 16,  0}, { 0,  1,  1,  0}, { 0,  1,  1,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_yuv422p12be,      24, AkFourCC(12, 10, '3', 'Y'), 3, {16, 16, 16,  0}, { 0,  1,  1,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_yuv422p12le,      24, AkFourCC('Y', '3', 10, 12), 3, {16, 16, 16,  0}, { 0,  1,  1,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_yuv422p14be,      28, AkFourCC(14, 10, '3', 'Y'), 3, {16, 16, 16,  0}, { 0,  1,  1,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_yuv422p14le,      28, AkFourCC('Y', '3', 10, 14), 3, {16, 16, 16,  0}, { 0,  1,  1,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_yuv444p12be,      36, AkFourCC(12, 0, '3', 'Y'), 3, {16, 16, 16,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_yuv444p12le,      36, AkFourCC('Y', '3', 0, 12), 3, {16, 16, 16,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_yuv444p14be,      42, AkFourCC(14, 0, '3', 'Y'), 3, {16, 16, 16,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_yuv444p14le,      42, AkFourCC('Y', '3', 0, 14), 3, {16, 16, 16,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_gbrp12be,         36, AkFourCC(12, 0, '3', 'G'), 3, {16, 16, 16,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_gbrp12le,         36, AkFourCC('G', '3', 0, 12), 3, {16, 16, 16,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_gbrp14be,         42, AkFourCC(14, 0, '3', 'G'), 3, {16, 16, 16,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_gbrp14le,         42, AkFourCC('G', '3', 0, 14), 3, {16, 16, 16,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_gbrap,            32, AkFourCC('G', '4', 0, 8), 4, { 8,  8,  8,  8}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_gbrap16be,        64, AkFourCC(16, 0, '4', 'G'), 4, {16, 16, 16, 16}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_gbrap16le,        64, AkFourCC('G', '4', 0, 16), 4, {16, 16, 16, 16}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_yuvj411p,         12, AK_FOURCC_NULL, 3, { 8,  8,  8,  0}, { 0,  2,  2,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_bayer_bggr8,       8, AkFourCC(0xBA, 'B', 'G',    8), 1, { 8,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_bayer_rggb8,       8, AkFourCC(0xBA, 'R', 'G',    8), 1, { 8,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_bayer_gbrg8,       8, AkFourCC(0xBA, 'G', 'B',    8), 1, { 8,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_bayer_grbg8,       8, AkFourCC(0xBA, 'G', 'R',    8), 1, { 8,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_bayer_bggr16le,   16, AkFourCC(0xBA, 'B', 'G',   16), 1, {16,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_bayer_bggr16be,   16, AkFourCC(  16, 'G', 'B', 0xBA), 1, {16,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_bayer_rggb16le,   16, AkFourCC(0xBA, 'R', 'G',   16), 1, {16,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_bayer_rggb16be,   16, AkFourCC(  16, 'G', 'R', 0xBA), 1, {16,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_bayer_gbrg16le,   16, AkFourCC(0xBA, 'G', 'B',   16), 1, {16,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_bayer_gbrg16be,   16, AkFourCC(  16, 'B', 'G', 0xBA), 1, {16,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_bayer_grbg16le,   16, AkFourCC(0xBA, 'G', 'R',   16), 1, {16,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_bayer_grbg16be,   16, AkFourCC(  16, 'R', 'G', 0xBA), 1, {16,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_yuv440p10le,      20, AK_FOURCC_NULL, 3, {16, 16, 16,  0}, { 0,  0,  0,  0}, { 0,  1,  1,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_yuv440p10be,      20, AK_FOURCC_NULL, 3, {16, 16, 16,  0}, { 0,  0,  0,  0}, { 0,  1,  1,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_yuv440p12le,      24, AK_FOURCC_NULL, 3, {16, 16, 16,  0}, { 0,  0,  0,  0}, { 0,  1,  1,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_yuv440p12be,      24, AK_FOURCC_NULL, 3, {16, 16, 16,  0}, { 0,  0,  0,  0}, { 0,  1,  1,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_ayuv64le,         64, AK_FOURCC_NULL, 1, {64,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_ayuv64be,         64, AK_FOURCC_NULL, 1, {64,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_p010le,           15, AK_FOURCC_NULL, 2, {16, 32,  0,  0}, { 0,  1,  0,  0}, { 0,  1,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_p010be,           15, AK_FOURCC_NULL, 2, {16, 32,  0,  0}, { 0,  1,  0,  0}, { 0,  1,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_gbrap12be,        48, AkFourCC(12, 0, '4', 'G'), 4, {16, 16, 16, 16}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_gbrap12le,        48, AkFourCC('G', '4', 0, 12), 4, {16, 16, 16, 16}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_gbrap10be,        40, AkFourCC(10, 0, '4', 'G'), 4, {16, 16, 16, 16}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_gbrap10le,        40, AkFourCC('G', '4', 0, 10), 4, {16, 16, 16, 16}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_gray12be,         12, AkFourCC(12, 0, '1', 'Y'), 1, {16,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_gray12le,         12, AkFourCC('Y', '1', 0, 12), 1, {16,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_gray10be,         10, AkFourCC(10, 0, '1', 'Y'), 1, {16,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_gray10le,         10, AkFourCC('Y', '1', 0, 10), 1, {16,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_p016le,           24, AK_FOURCC_NULL, 2, {16, 32,  0,  0}, { 0,  1,  0,  0}, { 0,  1,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_p016be,           24, AK_FOURCC_NULL, 2, {16, 32,  0,  0}, { 0,  1,  0,  0}, { 0,  1,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_gray9be,           9, AkFourCC(9, 0, '1', 'Y'), 1, {16,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_gray9le,           9, AkFourCC('Y', '1', 0, 9), 1, {16,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_gbrpf32be,        96, AK_FOURCC_NULL, 3, {32, 32, 32,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_gbrpf32le,        96, AK_FOURCC_NULL, 3, {32, 32, 32,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_gbrapf32be,      128, AK_FOURCC_NULL, 4, {32, 32, 32, 32}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_BIG_ENDIAN},
+    {AkVideoCaps::Format_gbrapf32le,      128, AK_FOURCC_NULL, 4, {32, 32, 32, 32}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, Q_LITTLE_ENDIAN},
+    {AkVideoCaps::Format_v210,              0, AK_FOURCC_NULL, 1, { 0,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_v216,              0, AK_FOURCC_NULL, 1, { 0,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
+    {AkVideoCaps::Format_v308,              0, AK_FOURCC_NULL, 1, { 0,  0,  0,  0}, { 0,  0,  0,  0}, { 0,  0,  0,  0}, 0},
 };
 
+static const int akVideoCapsNFormats =
+        sizeof(akVideoCapsFormats) / sizeof(VideoFormat);
+
+const VideoFormat *VideoFormat::byFormat(AkVideoCaps::PixelFormat format)
+{
+    int i = int(format) + 1;
+
+    if (i < 0 || i >= akVideoCapsNFormats)
+        i = 0;
+
+    return akVideoCapsFormats + i;
+}
+
+const VideoFormat *VideoFormat::byBpp(int bpp)
+{
+    for (int i = 0; i < akVideoCapsNFormats; i++)
+        if (akVideoCapsFormats[i].bpp == bpp)
+            return akVideoCapsFormats + i;
+
+    return akVideoCapsFormats;
+}
+
+const VideoFormat *VideoFormat::byFourCC(quint32 fourCC)
+{
+    for (int i = 0; i < akVideoCapsNFormats; i++)
+        if (akVideoCapsFormats[i].fourCC == fourCC)
+            return akVideoCapsFormats + i;
+
+    return akVideoCapsFormats;
+}
+
 class AkVideoCapsPrivate
 {
     public:
@@ -582,6 +616,41 @@ int AkVideoCaps::bitsPerPixel(const QString &pixelFormat)
     return AkVideoCaps::bitsPerPixel(AkVideoCaps::pixelFormatFromString(pixelFormat));
 }
 
+int AkVideoCaps::planeCount(AkVideoCaps::PixelFormat pixelFormat)
+{
+    return VideoFormat::byFormat(pixelFormat)->planes;
+}
+
+int AkVideoCaps::bitsPerPlane(AkVideoCaps::PixelFormat pixelFormat, int plane)
+{
+    if (plane < 0 || plane > 3)
+        return 0;
+
+    return VideoFormat::byFormat(pixelFormat)->planeBits[plane];
+}
+
+int AkVideoCaps::widthShift(AkVideoCaps::PixelFormat pixelFormat, int plane)
+{
+    if (plane < 0 || plane > 3)
+        return 0;
+
+    return VideoFormat::byFormat(pixelFormat)->widthShift[plane];
+}
+
+int AkVideoCaps::heightShift(AkVideoCaps::PixelFormat pixelFormat, int plane)
+{
+    if (plane < 0 || plane > 3)
+        return 0;
+
+    return VideoFormat::byFormat(pixelFormat)->heightShift[plane];
+}
+
+int AkVideoCaps::endianness(AkVideoCaps::PixelFormat pixelFormat)
+{
+    // Q_LITTLE_ENDIAN, Q_BIG_ENDIAN, or 0 when the samples are single bytes.
+    return VideoFormat::byFormat(pixelFormat)->endianness;
+}
+
 QString AkVideoCaps::pixelFormatToString(AkVideoCaps::PixelFormat pixelFormat)
 {
     AkVideoCaps caps;
@@ -310,6 +310,11 @@ class AKCOMMONS_EXPORT AkVideoCaps: public QObject
 
         Q_INVOKABLE static int bitsPerPixel(PixelFormat pixelFormat);
         Q_INVOKABLE static int bitsPerPixel(const QString &pixelFormat);
+        Q_INVOKABLE static int planeCount(PixelFormat pixelFormat);
+        Q_INVOKABLE static int bitsPerPlane(PixelFormat pixelFormat, int plane);
+        Q_INVOKABLE static int widthShift(PixelFormat pixelFormat, int plane);
+        Q_INVOKABLE static int heightShift(PixelFormat pixelFormat, int plane);
+        Q_INVOKABLE static int endianness(PixelFormat pixelFormat);
         Q_INVOKABLE static QString pixelFormatToString(PixelFormat pixelFormat);
         Q_INVOKABLE static PixelFormat pixelFormatFromString(const QString &pixelFormat);
         Q_INVOKABLE static quint32 fourCC(PixelFormat pixelFormat);
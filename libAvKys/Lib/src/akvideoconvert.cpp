@@ -0,0 +1,379 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QMap>
+#include <QPair>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "akvideoconvert.h"
+#include "akvideopacket.h"
+
+/* Integer BT.601 YUV -> RGB:
+ *
+ * c = y - 16, d = u - 128, e = v - 128
+ * r = clamp((298 c         + 409 e + 128) >> 8)
+ * g = clamp((298 c - 100 d - 208 e + 128) >> 8)
+ * b = clamp((298 c + 516 d         + 128) >> 8)
+ */
+inline quint8 clamp8(int value)
+{
+    return quint8(value < 0? 0: value > 255? 255: value);
+}
+
+inline void yuvToRgb(int y, int u, int v, quint8 *r, quint8 *g, quint8 *b)
+{
+    int c = y - 16;
+    int d = u - 128;
+    int e = v - 128;
+    *r = clamp8((298 * c + 409 * e + 128) >> 8);
+    *g = clamp8((298 * c - 100 * d - 208 * e + 128) >> 8);
+    *b = clamp8((298 * c + 516 * d + 128) >> 8);
+}
+
+typedef void (*ConvertFunction)(const quint8 *src,
+                                quint8 *dst,
+                                int width,
+                                int height);
+
+static void convertYuyvTo0rgb(const quint8 *src,
+                              quint8 *dst,
+                              int width,
+                              int height)
+{
+    int pixels = width * height;
+    int i = 0;
+    auto oPixel = reinterpret_cast<quint32 *>(dst);
+
+#if defined(__SSE2__)
+    /* Halved coefficients so every product fits in a signed 16 bit lane,
+     * saturating adds keep the clamping semantics of the scalar code. */
+    const __m128i byteMask = _mm_set1_epi16(0x00ff);
+    const __m128i c16 = _mm_set1_epi16(16);
+    const __m128i c128 = _mm_set1_epi16(128);
+    const __m128i cY = _mm_set1_epi16(149);
+    const __m128i cRV = _mm_set1_epi16(204);
+    const __m128i cGU = _mm_set1_epi16(50);
+    const __m128i cGV = _mm_set1_epi16(104);
+    const __m128i cBU = _mm_set1_epi16(258);
+    const __m128i round = _mm_set1_epi16(64);
+    const __m128i alpha = _mm_set1_epi8(char(0xff));
+
+    for (; i + 8 <= pixels; i += 8) {
+        __m128i block =
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * i));
+        __m128i y = _mm_and_si128(block, byteMask);
+        __m128i uv = _mm_srli_epi16(block, 8);
+        __m128i u = _mm_shufflelo_epi16(uv, _MM_SHUFFLE(2, 2, 0, 0));
+        u = _mm_shufflehi_epi16(u, _MM_SHUFFLE(2, 2, 0, 0));
+        __m128i v = _mm_shufflelo_epi16(uv, _MM_SHUFFLE(3, 3, 1, 1));
+        v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(3, 3, 1, 1));
+
+        __m128i c = _mm_sub_epi16(y, c16);
+        __m128i d = _mm_sub_epi16(u, c128);
+        __m128i e = _mm_sub_epi16(v, c128);
+
+        __m128i yv = _mm_adds_epi16(_mm_mullo_epi16(c, cY), round);
+        __m128i r = _mm_srai_epi16(_mm_adds_epi16(yv,
+                                                  _mm_mullo_epi16(e, cRV)), 7);
+        __m128i g = _mm_srai_epi16(_mm_subs_epi16(yv,
+                                                  _mm_adds_epi16(_mm_mullo_epi16(d, cGU),
+                                                                 _mm_mullo_epi16(e, cGV))), 7);
+        __m128i b = _mm_srai_epi16(_mm_adds_epi16(yv,
+                                                  _mm_mullo_epi16(d, cBU)), 7);
+
+        __m128i r8 = _mm_packus_epi16(r, r);
+        __m128i g8 = _mm_packus_epi16(g, g);
+        __m128i b8 = _mm_packus_epi16(b, b);
+
+        __m128i bg = _mm_unpacklo_epi8(b8, g8);
+        __m128i ra = _mm_unpacklo_epi8(r8, alpha);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(oPixel + i),
+                         _mm_unpacklo_epi16(bg, ra));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(oPixel + i + 4),
+                         _mm_unpackhi_epi16(bg, ra));
+    }
+#endif
+
+    for (; i < pixels; i += 2) {
+        const quint8 *pair = src + 2 * i;
+        quint8 r;
+        quint8 g;
+        quint8 b;
+        yuvToRgb(pair[0], pair[1], pair[3], &r, &g, &b);
+        oPixel[i] = 0xff000000 | quint32(r) << 16 | quint32(g) << 8 | b;
+        yuvToRgb(pair[2], pair[1], pair[3], &r, &g, &b);
+        oPixel[i + 1] = 0xff000000 | quint32(r) << 16 | quint32(g) << 8 | b;
+    }
+}
+
+static void convertYuyvToRgb24(const quint8 *src,
+                               quint8 *dst,
+                               int width,
+                               int height)
+{
+    int pixels = width * height;
+
+    for (int i = 0; i < pixels; i += 2) {
+        const quint8 *pair = src + 2 * i;
+        quint8 *oPixel = dst + 3 * i;
+        yuvToRgb(pair[0], pair[1], pair[3], oPixel, oPixel + 1, oPixel + 2);
+        yuvToRgb(pair[2], pair[1], pair[3], oPixel + 3, oPixel + 4, oPixel + 5);
+    }
+}
+
+static void convertYuyvToGray(const quint8 *src,
+                              quint8 *dst,
+                              int width,
+                              int height)
+{
+    int pixels = width * height;
+
+    for (int i = 0; i < pixels; i++)
+        dst[i] = src[2 * i];
+}
+
+static void convertUyvyTo0rgb(const quint8 *src,
+                              quint8 *dst,
+                              int width,
+                              int height)
+{
+    int pixels = width * height;
+    auto oPixel = reinterpret_cast<quint32 *>(dst);
+
+    for (int i = 0; i < pixels; i += 2) {
+        const quint8 *pair = src + 2 * i;
+        quint8 r;
+        quint8 g;
+        quint8 b;
+        yuvToRgb(pair[1], pair[0], pair[2], &r, &g, &b);
+        oPixel[i] = 0xff000000 | quint32(r) << 16 | quint32(g) << 8 | b;
+        yuvToRgb(pair[3], pair[0], pair[2], &r, &g, &b);
+        oPixel[i + 1] = 0xff000000 | quint32(r) << 16 | quint32(g) << 8 | b;
+    }
+}
+
+static void convertUyvyToGray(const quint8 *src,
+                              quint8 *dst,
+                              int width,
+                              int height)
+{
+    int pixels = width * height;
+
+    for (int i = 0; i < pixels; i++)
+        dst[i] = src[2 * i + 1];
+}
+
+static void convertNv12To0rgb(const quint8 *src,
+                              quint8 *dst,
+                              int width,
+                              int height)
+{
+    const quint8 *yPlane = src;
+    const quint8 *uvPlane = src + width * height;
+    auto oPixel = reinterpret_cast<quint32 *>(dst);
+
+    for (int j = 0; j < height; j++) {
+        const quint8 *yLine = yPlane + j * width;
+        const quint8 *uvLine = uvPlane + (j >> 1) * width;
+        quint32 *oLine = oPixel + j * width;
+
+        for (int i = 0; i < width; i++) {
+            quint8 r;
+            quint8 g;
+            quint8 b;
+            yuvToRgb(yLine[i], uvLine[i & ~1], uvLine[i | 1], &r, &g, &b);
+            oLine[i] = 0xff000000 | quint32(r) << 16 | quint32(g) << 8 | b;
+        }
+    }
+}
+
+static void convertNv12ToGray(const quint8 *src,
+                              quint8 *dst,
+                              int width,
+                              int height)
+{
+    memcpy(dst, src, size_t(width) * size_t(height));
+}
+
+static void convertRgb24To0rgb(const quint8 *src,
+                               quint8 *dst,
+                               int width,
+                               int height)
+{
+    int pixels = width * height;
+    auto oPixel = reinterpret_cast<quint32 *>(dst);
+
+    for (int i = 0; i < pixels; i++) {
+        const quint8 *iPixel = src + 3 * i;
+        oPixel[i] = 0xff000000
+                  | quint32(iPixel[0]) << 16
+                  | quint32(iPixel[1]) << 8
+                  | iPixel[2];
+    }
+}
+
+static void convert0rgbToRgb24(const quint8 *src,
+                               quint8 *dst,
+                               int width,
+                               int height)
+{
+    int pixels = width * height;
+    auto iPixel = reinterpret_cast<const quint32 *>(src);
+
+    for (int i = 0; i < pixels; i++) {
+        quint8 *oPixel = dst + 3 * i;
+        oPixel[0] = quint8(iPixel[i] >> 16);
+        oPixel[1] = quint8(iPixel[i] >> 8);
+        oPixel[2] = quint8(iPixel[i]);
+    }
+}
+
+static void convertRgb24ToGray(const quint8 *src,
+                               quint8 *dst,
+                               int width,
+                               int height)
+{
+    int pixels = width * height;
+
+    for (int i = 0; i < pixels; i++) {
+        const quint8 *iPixel = src + 3 * i;
+        dst[i] = quint8((77 * iPixel[0] + 150 * iPixel[1] + 29 * iPixel[2]) >> 8);
+    }
+}
+
+static void convert0rgbToGray(const quint8 *src,
+                              quint8 *dst,
+                              int width,
+                              int height)
+{
+    int pixels = width * height;
+    auto iPixel = reinterpret_cast<const quint32 *>(src);
+
+    for (int i = 0; i < pixels; i++) {
+        int r = int(iPixel[i] >> 16) & 0xff;
+        int g = int(iPixel[i] >> 8) & 0xff;
+        int b = int(iPixel[i]) & 0xff;
+        dst[i] = quint8((77 * r + 150 * g + 29 * b) >> 8);
+    }
+}
+
+static void convertGrayTo0rgb(const quint8 *src,
+                              quint8 *dst,
+                              int width,
+                              int height)
+{
+    int pixels = width * height;
+    auto oPixel = reinterpret_cast<quint32 *>(dst);
+
+    for (int i = 0; i < pixels; i++)
+        oPixel[i] = 0xff000000
+                  | quint32(src[i]) << 16
+                  | quint32(src[i]) << 8
+                  | src[i];
+}
+
+static void convertGrayToRgb24(const quint8 *src,
+                               quint8 *dst,
+                               int width,
+                               int height)
+{
+    int pixels = width * height;
+
+    for (int i = 0; i < pixels; i++) {
+        quint8 *oPixel = dst + 3 * i;
+        oPixel[0] = src[i];
+        oPixel[1] = src[i];
+        oPixel[2] = src[i];
+    }
+}
+
+typedef QPair<AkVideoCaps::PixelFormat, AkVideoCaps::PixelFormat> FormatPair;
+typedef QMap<FormatPair, ConvertFunction> ConvertFunctionMap;
+
+inline ConvertFunctionMap initConvertFunctionMap()
+{
+    ConvertFunctionMap convertFunctions {
+        {{AkVideoCaps::Format_yuyv422, AkVideoCaps::Format_0rgb }, convertYuyvTo0rgb },
+        {{AkVideoCaps::Format_yuyv422, AkVideoCaps::Format_argb }, convertYuyvTo0rgb },
+        {{AkVideoCaps::Format_yuyv422, AkVideoCaps::Format_rgb24}, convertYuyvToRgb24},
+        {{AkVideoCaps::Format_yuyv422, AkVideoCaps::Format_gray }, convertYuyvToGray },
+        {{AkVideoCaps::Format_uyvy422, AkVideoCaps::Format_0rgb }, convertUyvyTo0rgb },
+        {{AkVideoCaps::Format_uyvy422, AkVideoCaps::Format_argb }, convertUyvyTo0rgb },
+        {{AkVideoCaps::Format_uyvy422, AkVideoCaps::Format_gray }, convertUyvyToGray },
+        {{AkVideoCaps::Format_nv12   , AkVideoCaps::Format_0rgb }, convertNv12To0rgb },
+        {{AkVideoCaps::Format_nv12   , AkVideoCaps::Format_argb }, convertNv12To0rgb },
+        {{AkVideoCaps::Format_nv12   , AkVideoCaps::Format_gray }, convertNv12ToGray },
+        {{AkVideoCaps::Format_rgb24  , AkVideoCaps::Format_0rgb }, convertRgb24To0rgb},
+        {{AkVideoCaps::Format_rgb24  , AkVideoCaps::Format_argb }, convertRgb24To0rgb},
+        {{AkVideoCaps::Format_rgb24  , AkVideoCaps::Format_gray }, convertRgb24ToGray},
+        {{AkVideoCaps::Format_0rgb   , AkVideoCaps::Format_rgb24}, convert0rgbToRgb24},
+        {{AkVideoCaps::Format_0rgb   , AkVideoCaps::Format_gray }, convert0rgbToGray },
+        {{AkVideoCaps::Format_argb   , AkVideoCaps::Format_rgb24}, convert0rgbToRgb24},
+        {{AkVideoCaps::Format_argb   , AkVideoCaps::Format_gray }, convert0rgbToGray },
+        {{AkVideoCaps::Format_gray   , AkVideoCaps::Format_0rgb }, convertGrayTo0rgb },
+        {{AkVideoCaps::Format_gray   , AkVideoCaps::Format_argb }, convertGrayTo0rgb },
+        {{AkVideoCaps::Format_gray   , AkVideoCaps::Format_rgb24}, convertGrayToRgb24},
+    };
+
+    return convertFunctions;
+}
+
+Q_GLOBAL_STATIC_WITH_ARGS(ConvertFunctionMap,
+                          akConvertFunctions,
+                          (initConvertFunctionMap()))
+
+bool AkVideoConvert::canConvert(AkVideoCaps::PixelFormat from,
+                                AkVideoCaps::PixelFormat to)
+{
+    return from == to
+            || akConvertFunctions->contains({from, to});
+}
+
+AkVideoPacket AkVideoConvert::convert(const AkVideoPacket &packet,
+                                      AkVideoCaps::PixelFormat format)
+{
+    if (packet.caps().format() == format)
+        return packet;
+
+    auto convertFunction =
+            akConvertFunctions->value({packet.caps().format(), format});
+
+    if (!convertFunction)
+        return AkVideoPacket();
+
+    AkVideoCaps oCaps(packet.caps());
+    oCaps.format() = format;
+    oCaps.bpp() = AkVideoCaps::bitsPerPixel(format);
+
+    QByteArray oBuffer(oCaps.pictureSize(), 0);
+    convertFunction(reinterpret_cast<const quint8 *>(packet.buffer().constData()),
+                    reinterpret_cast<quint8 *>(oBuffer.data()),
+                    oCaps.width(),
+                    oCaps.height());
+
+    AkVideoPacket oPacket(packet);
+    oPacket.caps() = oCaps;
+    oPacket.buffer() = oBuffer;
+
+    return oPacket;
+}
@@ -0,0 +1,43 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef AKVIDEOCONVERT_H
+#define AKVIDEOCONVERT_H
+
+#include "akvideocaps.h"
+
+class AkVideoPacket;
+
+/* Direct pixel format conversion over packet planes.
+ *
+ * These kernels convert between the formats capture devices actually
+ * deliver (yuyv422, uyvy422, nv12) and the formats the effects chain
+ * consumes (rgb24, 0rgb, argb, gray) without round-tripping through QImage.
+ * On x86 the hottest packed YUV kernels use SSE2, everything else is
+ * tight integer scalar code.
+ */
+namespace AkVideoConvert
+{
+    AKCOMMONS_EXPORT bool canConvert(AkVideoCaps::PixelFormat from,
+                                     AkVideoCaps::PixelFormat to);
+    AKCOMMONS_EXPORT AkVideoPacket convert(const AkVideoPacket &packet,
+                                           AkVideoCaps::PixelFormat format);
+}
+
+#endif // AKVIDEOCONVERT_H
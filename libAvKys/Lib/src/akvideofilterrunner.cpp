@@ -0,0 +1,229 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QAtomicInt>
+#include <QSemaphore>
+#include <QStringList>
+#include <QThread>
+#include <QThreadPool>
+#include <QVector>
+
+#ifdef Q_OS_LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "akvideofilterrunner.h"
+
+// Below this height threading overhead beats the parallel speedup.
+#define MIN_PARALLEL_HEIGHT 64
+
+/* Optional processor placement for the worker pool. AK_VIDEO_FILTER_CPUS
+ * takes a list like "0-3,8"; when set, the workers are pinned to those
+ * processors, which keeps the band kernels of one pipeline on the same
+ * socket as the frames they touch on multi-node machines. When unset
+ * (the default) the scheduler is free to migrate them. */
+static QVector<int> akFilterRunnerCpuSet()
+{
+    QVector<int> cpus;
+    auto env = QString::fromLatin1(qgetenv("AK_VIDEO_FILTER_CPUS"));
+
+    for (const QString &token: env.split(',', QString::SkipEmptyParts)) {
+        auto range = token.trimmed().split('-');
+        bool okFrom = false;
+        bool okTo = false;
+        int from = range.first().toInt(&okFrom);
+        int to = range.last().toInt(&okTo);
+
+        if (!okFrom || !okTo || from < 0 || to < from)
+            continue;
+
+        for (int cpu = from; cpu <= to; cpu++)
+            if (!cpus.contains(cpu))
+                cpus << cpu;
+    }
+
+    return cpus;
+}
+
+static void akFilterRunnerPinThread(const QVector<int> &cpus)
+{
+#ifdef Q_OS_LINUX
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+
+    for (int cpu: cpus)
+        CPU_SET(cpu, &cpuSet);
+
+    pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+#else
+    Q_UNUSED(cpus)
+#endif
+}
+
+class AkVideoFilterRunnerPrivate
+{
+    public:
+        QThreadPool m_pool;
+        QVector<int> m_cpuSet;
+
+        AkVideoFilterRunnerPrivate()
+        {
+            this->m_cpuSet = akFilterRunnerCpuSet();
+            int workers = qMax(QThread::idealThreadCount() - 1, 1);
+
+            // Don't oversubscribe a restricted processor set.
+            if (!this->m_cpuSet.isEmpty())
+                workers = qBound(1, this->m_cpuSet.size(), workers);
+
+            this->m_pool.setMaxThreadCount(workers);
+        }
+};
+
+class AkVideoFilterBandRunnable: public QRunnable
+{
+    public:
+        AkVideoFilterBandRunnable(const AkVideoFilterRunner::RowBandKernel *kernel,
+                                  QAtomicInt *nextBand,
+                                  int bands,
+                                  int bandHeight,
+                                  int height,
+                                  const QVector<int> *cpuSet,
+                                  QSemaphore *done):
+            m_kernel(kernel),
+            m_nextBand(nextBand),
+            m_bands(bands),
+            m_bandHeight(bandHeight),
+            m_height(height),
+            m_cpuSet(cpuSet),
+            m_done(done)
+        {
+            this->setAutoDelete(true);
+        }
+
+        void run()
+        {
+            if (!this->m_cpuSet->isEmpty()) {
+                /* Pool threads are recycled, so the affinity call runs
+                 * once per thread, not once per frame. */
+                static thread_local bool pinned = false;
+
+                if (!pinned) {
+                    akFilterRunnerPinThread(*this->m_cpuSet);
+                    pinned = true;
+                }
+            }
+
+            for (;;) {
+                int band = this->m_nextBand->fetchAndAddOrdered(1);
+
+                if (band >= this->m_bands)
+                    break;
+
+                int yStart = band * this->m_bandHeight;
+                int yEnd = qMin(yStart + this->m_bandHeight, this->m_height);
+                (*this->m_kernel)(yStart, yEnd);
+            }
+
+            this->m_done->release();
+        }
+
+    private:
+        const AkVideoFilterRunner::RowBandKernel *m_kernel;
+        QAtomicInt *m_nextBand;
+        int m_bands;
+        int m_bandHeight;
+        int m_height;
+        const QVector<int> *m_cpuSet;
+        QSemaphore *m_done;
+};
+
+AkVideoFilterRunner::AkVideoFilterRunner(QObject *parent):
+    QObject(parent)
+{
+    this->d = new AkVideoFilterRunnerPrivate();
+}
+
+AkVideoFilterRunner::~AkVideoFilterRunner()
+{
+    this->d->m_pool.waitForDone();
+    delete this->d;
+}
+
+void AkVideoFilterRunner::run(int height,
+                              const RowBandKernel &kernel,
+                              int bands)
+{
+    if (height < 1)
+        return;
+
+    int workers = this->d->m_pool.maxThreadCount();
+
+    if (workers < 2 || height < MIN_PARALLEL_HEIGHT) {
+        kernel(0, height);
+
+        return;
+    }
+
+    if (bands < 1)
+        // Several bands per worker so the atomic counter can re-balance
+        // uneven rows.
+        bands = qMin(4 * (workers + 1), height);
+
+    int bandHeight = (height + bands - 1) / bands;
+    QAtomicInt nextBand(0);
+    QSemaphore done;
+
+    for (int i = 0; i < workers; i++)
+        this->d->m_pool.start(new AkVideoFilterBandRunnable(&kernel,
+                                                            &nextBand,
+                                                            bands,
+                                                            bandHeight,
+                                                            height,
+                                                            &this->d->m_cpuSet,
+                                                            &done));
+
+    // The calling thread pulls bands too instead of blocking idle.
+    for (;;) {
+        int band = nextBand.fetchAndAddOrdered(1);
+
+        if (band >= bands)
+            break;
+
+        int yStart = band * bandHeight;
+        int yEnd = qMin(yStart + bandHeight, height);
+        kernel(yStart, yEnd);
+    }
+
+    done.acquire(workers);
+}
+
+int AkVideoFilterRunner::workers() const
+{
+    return this->d->m_pool.maxThreadCount() + 1;
+}
+
+Q_GLOBAL_STATIC(AkVideoFilterRunner, akGlobalFilterRunner)
+
+AkVideoFilterRunner *AkVideoFilterRunner::globalRunner()
+{
+    return akGlobalFilterRunner;
+}
+
+#include "moc_akvideofilterrunner.cpp"
@@ -0,0 +1,60 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef AKVIDEOFILTERRUNNER_H
+#define AKVIDEOFILTERRUNNER_H
+
+#include <QObject>
+#include <functional>
+
+#include "akcommons.h"
+
+class AkVideoFilterRunnerPrivate;
+
+/* Row band scheduler for per-pixel effect loops.
+ *
+ * Splits the frame into horizontal bands and runs the kernel for every band
+ * on a persistent worker pool. Bands are handed out from a shared atomic
+ * counter, so fast workers keep pulling work while slow ones finish their
+ * band, which balances load even when rows have uneven cost. The calling
+ * thread participates too and run() returns once the whole frame is done.
+ */
+class AKCOMMONS_EXPORT AkVideoFilterRunner: public QObject
+{
+    Q_OBJECT
+
+    public:
+        typedef std::function<void (int yStart, int yEnd)> RowBandKernel;
+
+        explicit AkVideoFilterRunner(QObject *parent=nullptr);
+        ~AkVideoFilterRunner();
+
+        /* Run 'kernel' over [0, height) split in 'bands' bands. A band count
+         * of 0 picks bands based on the worker count. Falls back to a plain
+         * single threaded call for small frames. */
+        void run(int height, const RowBandKernel &kernel, int bands=0);
+        Q_INVOKABLE int workers() const;
+
+        static AkVideoFilterRunner *globalRunner();
+
+    private:
+        AkVideoFilterRunnerPrivate *d;
+};
+
+#endif // AKVIDEOFILTERRUNNER_H
@@ -0,0 +1,44 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include "akvideokernel.h"
+
+bool AkVideoKernel::canMap(AkVideoCaps::PixelFormat format)
+{
+    switch (format) {
+    case AkVideoCaps::Format_argb:
+    case AkVideoCaps::Format_0rgb:
+    case AkVideoCaps::Format_rgb24:
+    case AkVideoCaps::Format_bgr24:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool AkVideoKernel::canMapLuma(AkVideoCaps::PixelFormat format)
+{
+    switch (format) {
+    case AkVideoCaps::Format_gray:
+    case AkVideoCaps::Format_yuyv422:
+        return true;
+    default:
+        return false;
+    }
+}
@@ -0,0 +1,242 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef AKVIDEOKERNEL_H
+#define AKVIDEOKERNEL_H
+
+#include <qrgb.h>
+
+#include "akvideocaps.h"
+#include "akvideopacket.h"
+#include "akvideofilterrunner.h"
+
+/* Per-pixel access specialized at compile time for the packed formats the
+ * pipeline carries. Every specialization exposes BytesPerPixel plus
+ * load()/store() of a QRgb, so the kernel loops below compile to straight
+ * unpack-free code for word sized formats.
+ */
+template <AkVideoCaps::PixelFormat format>
+class AkVideoPixelTraits;
+
+template <>
+class AkVideoPixelTraits<AkVideoCaps::Format_argb>
+{
+    public:
+        enum { BytesPerPixel = 4 };
+
+        inline static QRgb load(const quint8 *pixel)
+        {
+            return *reinterpret_cast<const QRgb *>(pixel);
+        }
+
+        inline static void store(quint8 *pixel, QRgb color)
+        {
+            *reinterpret_cast<QRgb *>(pixel) = color;
+        }
+};
+
+template <>
+class AkVideoPixelTraits<AkVideoCaps::Format_0rgb>
+{
+    public:
+        enum { BytesPerPixel = 4 };
+
+        inline static QRgb load(const quint8 *pixel)
+        {
+            return 0xff000000 | *reinterpret_cast<const QRgb *>(pixel);
+        }
+
+        inline static void store(quint8 *pixel, QRgb color)
+        {
+            *reinterpret_cast<QRgb *>(pixel) = color;
+        }
+};
+
+template <>
+class AkVideoPixelTraits<AkVideoCaps::Format_rgb24>
+{
+    public:
+        enum { BytesPerPixel = 3 };
+
+        inline static QRgb load(const quint8 *pixel)
+        {
+            return qRgb(pixel[0], pixel[1], pixel[2]);
+        }
+
+        inline static void store(quint8 *pixel, QRgb color)
+        {
+            pixel[0] = quint8(qRed(color));
+            pixel[1] = quint8(qGreen(color));
+            pixel[2] = quint8(qBlue(color));
+        }
+};
+
+template <>
+class AkVideoPixelTraits<AkVideoCaps::Format_bgr24>
+{
+    public:
+        enum { BytesPerPixel = 3 };
+
+        inline static QRgb load(const quint8 *pixel)
+        {
+            return qRgb(pixel[2], pixel[1], pixel[0]);
+        }
+
+        inline static void store(quint8 *pixel, QRgb color)
+        {
+            pixel[0] = quint8(qBlue(color));
+            pixel[1] = quint8(qGreen(color));
+            pixel[2] = quint8(qRed(color));
+        }
+};
+
+/* Format specialized kernel loops for packet-to-packet effects.
+ *
+ * An effect hands in a per-pixel functor and the packet is processed in the
+ * format it arrives in, parallel over row bands, instead of paying the
+ * ARGB round trip through AkUtils both ways. map() runs a QRgb -> QRgb
+ * functor on RGB-family formats; mapLuma() runs a quint8 -> quint8 functor
+ * on the luma bytes of gray and yuyv422 packets, leaving chroma untouched,
+ * which lets luma-only effects skip colorspace conversion entirely. Callers
+ * check canMap()/canMapLuma() once when the stream caps are known and fall
+ * back to the AkUtils path for anything else.
+ */
+class AKCOMMONS_EXPORT AkVideoKernel
+{
+    public:
+        static bool canMap(AkVideoCaps::PixelFormat format);
+        static bool canMapLuma(AkVideoCaps::PixelFormat format);
+
+        template <typename Kernel>
+        static AkVideoPacket map(const AkVideoPacket &src,
+                                 const Kernel &kernel)
+        {
+            switch (AkVideoCaps(src.caps()).format()) {
+            case AkVideoCaps::Format_argb:
+                return mapAs<AkVideoCaps::Format_argb>(src, kernel);
+            case AkVideoCaps::Format_0rgb:
+                return mapAs<AkVideoCaps::Format_0rgb>(src, kernel);
+            case AkVideoCaps::Format_rgb24:
+                return mapAs<AkVideoCaps::Format_rgb24>(src, kernel);
+            case AkVideoCaps::Format_bgr24:
+                return mapAs<AkVideoCaps::Format_bgr24>(src, kernel);
+            default:
+                return AkVideoPacket();
+            }
+        }
+
+        template <typename Kernel>
+        static AkVideoPacket mapLuma(const AkVideoPacket &src,
+                                     const Kernel &kernel,
+                                     bool neutralizeChroma=false)
+        {
+            AkVideoCaps caps(src.caps());
+
+            switch (caps.format()) {
+            case AkVideoCaps::Format_gray:
+                return mapLumaAs(src, kernel, 1, false);
+            case AkVideoCaps::Format_yuyv422:
+                return mapLumaAs(src, kernel, 2, neutralizeChroma);
+            default:
+                return AkVideoPacket();
+            }
+        }
+
+    private:
+        template <AkVideoCaps::PixelFormat format, typename Kernel>
+        static AkVideoPacket mapAs(const AkVideoPacket &src,
+                                   const Kernel &kernel)
+        {
+            typedef AkVideoPixelTraits<format> Traits;
+            AkVideoCaps caps(src.caps());
+            int width = caps.width();
+            int height = caps.height();
+            size_t lineSize = size_t(width) * Traits::BytesPerPixel;
+
+            /* buffer() materializes a deep copy for frameBuffer backed
+             * packets, so the input bytes must stay bound to a local for
+             * the whole run. */
+            const QByteArray iBuffer(src.buffer());
+
+            if (iBuffer.size() < int(lineSize * size_t(height)))
+                return AkVideoPacket();
+
+            QByteArray oBuffer(iBuffer);
+            auto oBits = reinterpret_cast<quint8 *>(oBuffer.data());
+            auto iBits = reinterpret_cast<const quint8 *>(iBuffer.constData());
+
+            AkVideoFilterRunner::globalRunner()->run(height,
+                                                     [&] (int yStart, int yEnd) {
+                for (int y = yStart; y < yEnd; y++) {
+                    const quint8 *iLine = iBits + y * lineSize;
+                    quint8 *oLine = oBits + y * lineSize;
+
+                    for (int x = 0; x < width; x++) {
+                        size_t offset = size_t(x) * Traits::BytesPerPixel;
+                        Traits::store(oLine + offset,
+                                      kernel(Traits::load(iLine + offset)));
+                    }
+                }
+            });
+
+            AkVideoPacket dst(src);
+            dst.setBuffer(oBuffer);
+
+            return dst;
+        }
+
+        template <typename Kernel>
+        static AkVideoPacket mapLumaAs(const AkVideoPacket &src,
+                                       const Kernel &kernel,
+                                       int step,
+                                       bool neutralizeChroma)
+        {
+            AkVideoCaps caps(src.caps());
+            int width = caps.width();
+            int height = caps.height();
+            size_t lineSize = size_t(width) * size_t(step);
+
+            if (src.buffer().size() < int(lineSize * size_t(height)))
+                return AkVideoPacket();
+
+            QByteArray oBuffer(src.buffer());
+            auto oBits = reinterpret_cast<quint8 *>(oBuffer.data());
+
+            AkVideoFilterRunner::globalRunner()->run(height,
+                                                     [&] (int yStart, int yEnd) {
+                for (int y = yStart; y < yEnd; y++) {
+                    quint8 *oLine = oBits + y * lineSize;
+
+                    for (int x = 0; x < width; x++)
+                        oLine[x * step] = kernel(oLine[x * step]);
+
+                    if (neutralizeChroma)
+                        for (int x = 1; x < width * step; x += step)
+                            oLine[x] = 128;
+                }
+            });
+
+            AkVideoPacket dst(src);
+            dst.setBuffer(oBuffer);
+
+            return dst;
+        }
+};
+
+#endif // AKVIDEOKERNEL_H
@@ -17,6 +17,7 @@
  * Web-Site: http://webcamoid.github.io/
  */
 
+#include <utility>
 #include <QDebug>
 #include <QVariant>
 
@@ -28,8 +29,56 @@ class AkVideoPacketPrivate
 {
     public:
         AkVideoCaps m_caps;
+        int m_planeCount;
+        size_t m_planeOffset[4];
+        size_t m_bytesPerLine[4];
+        int m_lines[4];
+
+        AkVideoPacketPrivate():
+            m_planeCount(0),
+            m_planeOffset{0, 0, 0, 0},
+            m_bytesPerLine{0, 0, 0, 0},
+            m_lines{0, 0, 0, 0}
+        {
+        }
+
+        inline void updatePlanes();
 };
 
+void AkVideoPacketPrivate::updatePlanes()
+{
+    if (!this->m_caps) {
+        this->m_planeCount = 0;
+
+        return;
+    }
+
+    int width = this->m_caps.width();
+    int height = this->m_caps.height();
+    auto format = this->m_caps.format();
+    this->m_planeCount = AkVideoCaps::planeCount(format);
+
+    if (this->m_planeCount < 2) {
+        // Packed formats travel as a single plane of bpp bits per pixel.
+        this->m_planeOffset[0] = 0;
+        this->m_bytesPerLine[0] = size_t(this->m_caps.bpp() * width) / 8;
+        this->m_lines[0] = height;
+
+        return;
+    }
+
+    size_t offset = 0;
+
+    for (int plane = 0; plane < this->m_planeCount; plane++) {
+        this->m_planeOffset[plane] = offset;
+        this->m_bytesPerLine[plane] =
+                size_t(AkVideoCaps::bitsPerPlane(format, plane)
+                       * (width >> AkVideoCaps::widthShift(format, plane))) / 8;
+        this->m_lines[plane] = height >> AkVideoCaps::heightShift(format, plane);
+        offset += this->m_bytesPerLine[plane] * size_t(this->m_lines[plane]);
+    }
+}
+
 AkVideoPacket::AkVideoPacket(QObject *parent):
     AkPacket(parent)
 {
@@ -45,6 +94,7 @@ AkVideoPacket::AkVideoPacket(const AkVideoCaps &caps,
 {
     this->d = new AkVideoPacketPrivate();
     this->d->m_caps = caps;
+    this->d->updatePlanes();
     this->buffer() = buffer;
     this->pts() = pts;
     this->timeBase() = timeBase;
@@ -52,29 +102,28 @@ AkVideoPacket::AkVideoPacket(const AkVideoCaps &caps,
     this->id() = id;
 }
 
-AkVideoPacket::AkVideoPacket(const AkPacket &other)
+AkVideoPacket::AkVideoPacket(const AkPacket &other):
+    AkPacket(other)
 {
+    // The base copy shares the buffers, only the caps change representation.
     this->d = new AkVideoPacketPrivate();
     this->d->m_caps = other.caps();
-    this->data() = other.data();
-    this->buffer() = other.buffer();
-    this->pts() = other.pts();
-    this->timeBase() = other.timeBase();
-    this->index() = other.index();
-    this->id() = other.id();
+    this->d->updatePlanes();
 }
 
 AkVideoPacket::AkVideoPacket(const AkVideoPacket &other):
-    AkPacket()
+    AkPacket(other)
 {
     this->d = new AkVideoPacketPrivate();
     this->d->m_caps = other.d->m_caps;
-    this->data() = other.data();
-    this->buffer() = other.buffer();
-    this->pts() = other.pts();
-    this->timeBase() = other.timeBase();
-    this->index() = other.index();
-    this->id() = other.id();
+    this->d->updatePlanes();
+}
+
+AkVideoPacket::AkVideoPacket(AkVideoPacket &&other):
+    AkPacket(std::move(other))
+{
+    this->d = other.d;
+    other.d = new AkVideoPacketPrivate();
 }
 
 AkVideoPacket::~AkVideoPacket()
@@ -84,13 +133,9 @@ AkVideoPacket::~AkVideoPacket()
 
 AkVideoPacket &AkVideoPacket::operator =(const AkPacket &other)
 {
+    this->AkPacket::operator =(other);
     this->d->m_caps = other.caps();
-    this->data() = other.data();
-    this->buffer() = other.buffer();
-    this->pts() = other.pts();
-    this->timeBase() = other.timeBase();
-    this->index() = other.index();
-    this->id() = other.id();
+    this->d->updatePlanes();
 
     return *this;
 }
@@ -98,18 +143,22 @@ AkVideoPacket &AkVideoPacket::operator =(const AkPacket &other)
 AkVideoPacket &AkVideoPacket::operator =(const AkVideoPacket &other)
 {
     if (this != &other) {
+        this->AkPacket::operator =(other);
         this->d->m_caps = other.d->m_caps;
-        this->data() = other.data();
-        this->buffer() = other.buffer();
-        this->pts() = other.pts();
-        this->timeBase() = other.timeBase();
-        this->index() = other.index();
-        this->id() = other.id();
+        this->d->updatePlanes();
     }
 
     return *this;
 }
 
+AkVideoPacket &AkVideoPacket::operator =(AkVideoPacket &&other)
+{
+    this->AkPacket::operator =(std::move(other));
+    qSwap(this->d, other.d);
+
+    return *this;
+}
+
 AkVideoPacket::operator bool() const
 {
     return this->d->m_caps.isValid();
@@ -125,6 +174,57 @@ AkVideoCaps &AkVideoPacket::caps()
     return this->d->m_caps;
 }
 
+int AkVideoPacket::planeCount() const
+{
+    return this->d->m_planeCount;
+}
+
+int AkVideoPacket::bytesPerLine(int plane) const
+{
+    if (plane < 0 || plane >= this->d->m_planeCount)
+        return 0;
+
+    return int(this->d->m_bytesPerLine[plane]);
+}
+
+int AkVideoPacket::lines(int plane) const
+{
+    if (plane < 0 || plane >= this->d->m_planeCount)
+        return 0;
+
+    return this->d->m_lines[plane];
+}
+
+const quint8 *AkVideoPacket::constLine(int plane, int y) const
+{
+    if (plane < 0 || plane >= this->d->m_planeCount)
+        return nullptr;
+
+    return reinterpret_cast<const quint8 *>(this->constData())
+           + this->d->m_planeOffset[plane]
+           + size_t(y) * this->d->m_bytesPerLine[plane];
+}
+
+quint8 *AkVideoPacket::line(int plane, int y)
+{
+    if (plane < 0 || plane >= this->d->m_planeCount)
+        return nullptr;
+
+    /* Mirror constData(): frame buffer backed packets travel with an
+     * empty legacy buffer, so write access goes through the frame
+     * buffer, detaching shared storage before handing out the pointer. */
+    quint8 *data = nullptr;
+
+    if (this->buffer().isEmpty() && this->frameBuffer())
+        data = this->frameBuffer().writableData();
+    else
+        data = reinterpret_cast<quint8 *>(this->buffer().data());
+
+    return data
+           + this->d->m_planeOffset[plane]
+           + size_t(y) * this->d->m_bytesPerLine[plane];
+}
+
 QString AkVideoPacket::toString() const
 {
     QString packetInfo;
@@ -164,13 +264,9 @@ QString AkVideoPacket::toString() const
 
 AkPacket AkVideoPacket::toPacket() const
 {
-    AkPacket packet;
-    packet.caps() =  this->d->m_caps.toCaps();
-    packet.buffer() = this->buffer();
-    packet.pts() = this->pts();
-    packet.timeBase() = this->timeBase();
-    packet.index() = this->index();
-    packet.id() = this->id();
+    // Share the buffers with the new packet instead of copying them.
+    AkPacket packet(*this);
+    packet.caps() = this->d->m_caps.toCaps();
 
     return packet;
 }
@@ -181,6 +277,7 @@ void AkVideoPacket::setCaps(const AkVideoCaps &caps)
         return;
 
     this->d->m_caps = caps;
+    this->d->updatePlanes();
     emit this->capsChanged(caps);
 }
 
@@ -44,14 +44,24 @@ class AKCOMMONS_EXPORT AkVideoPacket: public AkPacket
                       qint64 id=-1);
         AkVideoPacket(const AkPacket &other);
         AkVideoPacket(const AkVideoPacket &other);
+        AkVideoPacket(AkVideoPacket &&other);
         ~AkVideoPacket();
         AkVideoPacket &operator =(const AkPacket &other);
         AkVideoPacket &operator =(const AkVideoPacket &other);
+        AkVideoPacket &operator =(AkVideoPacket &&other);
         operator bool() const;
 
         Q_INVOKABLE AkVideoCaps caps() const;
         Q_INVOKABLE AkVideoCaps &caps();
 
+        // The plane layout is derived from the caps set through the
+        // constructors or setCaps().
+        Q_INVOKABLE int planeCount() const;
+        Q_INVOKABLE int bytesPerLine(int plane) const;
+        Q_INVOKABLE int lines(int plane) const;
+        const quint8 *constLine(int plane, int y) const;
+        quint8 *line(int plane, int y);
+
         Q_INVOKABLE QString toString() const;
         Q_INVOKABLE AkPacket toPacket() const;
 
@@ -0,0 +1,372 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QColor>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLFunctions>
+#include <QOpenGLShaderProgram>
+#include <QVector>
+
+#include "akvideoshaderchain.h"
+
+#ifndef GL_BGRA
+#define GL_BGRA 0x80E1
+#endif
+
+/* Shared by every pass. The effects only supply fragment shaders, the
+ * geometry is always the same full frame quad.
+ */
+static const char *akVideoShaderChainVertex =
+        "attribute vec2 position;\n"
+        "varying vec2 uv;\n"
+        "\n"
+        "void main()\n"
+        "{\n"
+        "    uv = 0.5 * position + vec2(0.5);\n"
+        "    gl_Position = vec4(position, 0.0, 1.0);\n"
+        "}\n";
+
+class AkVideoShaderChainPrivate
+{
+    public:
+        AkVideoShaderChain *self;
+        QOffscreenSurface *m_surface;
+        QOpenGLContext *m_context;
+        QOpenGLFramebufferObject *m_fbo[2];
+        QVector<QOpenGLShaderProgram *> m_programs;
+        QStringList m_passes;
+        QVariantMap m_uniforms;
+        GLuint m_frameTexture;
+        int m_width;
+        int m_height;
+        bool m_isValid;
+
+        AkVideoShaderChainPrivate(AkVideoShaderChain *self):
+            self(self),
+            m_surface(nullptr),
+            m_context(nullptr),
+            m_frameTexture(0),
+            m_width(0),
+            m_height(0),
+            m_isValid(false)
+        {
+            this->m_fbo[0] = nullptr;
+            this->m_fbo[1] = nullptr;
+        }
+
+        inline void initialize();
+        inline void releaseFrames();
+        inline void releasePrograms();
+        inline bool resizeFrames(int width, int height);
+        inline void applyUniforms(QOpenGLShaderProgram *program) const;
+};
+
+AkVideoShaderChain::AkVideoShaderChain(QObject *parent):
+    QObject(parent)
+{
+    this->d = new AkVideoShaderChainPrivate(this);
+    this->d->initialize();
+}
+
+AkVideoShaderChain::~AkVideoShaderChain()
+{
+    if (this->d->m_isValid
+        && this->d->m_context->makeCurrent(this->d->m_surface)) {
+        this->d->releasePrograms();
+        this->d->releaseFrames();
+        this->d->m_context->doneCurrent();
+    }
+
+    delete this->d->m_context;
+    delete this->d->m_surface;
+    delete this->d;
+}
+
+bool AkVideoShaderChain::isValid() const
+{
+    return this->d->m_isValid;
+}
+
+QStringList AkVideoShaderChain::passes() const
+{
+    return this->d->m_passes;
+}
+
+QVariantMap AkVideoShaderChain::uniforms() const
+{
+    return this->d->m_uniforms;
+}
+
+void AkVideoShaderChainPrivate::initialize()
+{
+    this->m_surface = new QOffscreenSurface();
+    this->m_surface->create();
+
+    if (!this->m_surface->isValid())
+        return;
+
+    this->m_context = new QOpenGLContext();
+
+    if (!this->m_context->create())
+        return;
+
+    this->m_isValid = this->m_context->makeCurrent(this->m_surface);
+
+    if (this->m_isValid)
+        this->m_context->doneCurrent();
+}
+
+void AkVideoShaderChainPrivate::releaseFrames()
+{
+    for (auto &fbo: this->m_fbo) {
+        delete fbo;
+        fbo = nullptr;
+    }
+
+    if (this->m_frameTexture) {
+        this->m_context->functions()->glDeleteTextures(1,
+                                                       &this->m_frameTexture);
+        this->m_frameTexture = 0;
+    }
+
+    this->m_width = 0;
+    this->m_height = 0;
+}
+
+void AkVideoShaderChainPrivate::releasePrograms()
+{
+    qDeleteAll(this->m_programs);
+    this->m_programs.clear();
+}
+
+bool AkVideoShaderChainPrivate::resizeFrames(int width, int height)
+{
+    if (this->m_width == width && this->m_height == height)
+        return true;
+
+    this->releaseFrames();
+    auto gl = this->m_context->functions();
+
+    gl->glGenTextures(1, &this->m_frameTexture);
+    gl->glBindTexture(GL_TEXTURE_2D, this->m_frameTexture);
+    gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    gl->glTexImage2D(GL_TEXTURE_2D,
+                     0,
+                     GL_RGBA,
+                     width,
+                     height,
+                     0,
+                     GL_BGRA,
+                     GL_UNSIGNED_BYTE,
+                     nullptr);
+
+    for (auto &fbo: this->m_fbo) {
+        fbo = new QOpenGLFramebufferObject(width, height);
+
+        if (!fbo->isValid()) {
+            this->releaseFrames();
+
+            return false;
+        }
+    }
+
+    this->m_width = width;
+    this->m_height = height;
+
+    return true;
+}
+
+void AkVideoShaderChainPrivate::applyUniforms(QOpenGLShaderProgram *program) const
+{
+    for (auto it = this->m_uniforms.begin();
+         it != this->m_uniforms.end();
+         it++) {
+        auto name = it.key().toStdString();
+        auto &value = it.value();
+
+        switch (value.type()) {
+        case QVariant::Int:
+            program->setUniformValue(name.c_str(), value.toInt());
+
+            break;
+        case QVariant::Bool:
+            program->setUniformValue(name.c_str(), value.toBool());
+
+            break;
+        case QVariant::Color:
+            program->setUniformValue(name.c_str(), value.value<QColor>());
+
+            break;
+        case QVariant::PointF:
+            program->setUniformValue(name.c_str(), value.toPointF());
+
+            break;
+        default:
+            program->setUniformValue(name.c_str(),
+                                     GLfloat(value.toDouble()));
+
+            break;
+        }
+    }
+}
+
+bool AkVideoShaderChain::setPasses(const QStringList &fragmentShaders)
+{
+    if (this->d->m_passes == fragmentShaders)
+        return true;
+
+    if (!this->d->m_isValid
+        || !this->d->m_context->makeCurrent(this->d->m_surface))
+        return false;
+
+    QVector<QOpenGLShaderProgram *> programs;
+
+    for (const QString &source: fragmentShaders) {
+        auto program = new QOpenGLShaderProgram();
+
+        if (!program->addShaderFromSourceCode(QOpenGLShader::Vertex,
+                                              akVideoShaderChainVertex)
+            || !program->addShaderFromSourceCode(QOpenGLShader::Fragment,
+                                                 source)
+            || !program->link()) {
+            delete program;
+            qDeleteAll(programs);
+            this->d->m_context->doneCurrent();
+
+            return false;
+        }
+
+        programs << program;
+    }
+
+    this->d->releasePrograms();
+    this->d->m_programs = programs;
+    this->d->m_passes = fragmentShaders;
+    this->d->m_context->doneCurrent();
+
+    return true;
+}
+
+void AkVideoShaderChain::setUniforms(const QVariantMap &uniforms)
+{
+    this->d->m_uniforms = uniforms;
+}
+
+AkVideoPacket AkVideoShaderChain::process(const AkVideoPacket &packet)
+{
+    AkVideoCaps caps(packet.caps());
+
+    // The frames travel as 32 bits BGRA words both ways, anything else
+    // goes through the caller's CPU path.
+    if (caps.format() != AkVideoCaps::Format_argb
+        && caps.format() != AkVideoCaps::Format_0rgb)
+        return AkVideoPacket();
+
+    if (!this->d->m_isValid
+        || this->d->m_programs.isEmpty()
+        || !this->d->m_context->makeCurrent(this->d->m_surface))
+        return AkVideoPacket();
+
+    int width = caps.width();
+    int height = caps.height();
+    size_t frameSize = 4 * size_t(width) * size_t(height);
+
+    if (size_t(packet.buffer().size()) < frameSize
+        || !this->d->resizeFrames(width, height)) {
+        this->d->m_context->doneCurrent();
+
+        return AkVideoPacket();
+    }
+
+    auto gl = this->d->m_context->functions();
+
+    // Upload the frame once, every pass after the first one samples the
+    // previous framebuffer directly.
+    gl->glBindTexture(GL_TEXTURE_2D, this->d->m_frameTexture);
+    gl->glTexSubImage2D(GL_TEXTURE_2D,
+                        0,
+                        0,
+                        0,
+                        width,
+                        height,
+                        GL_BGRA,
+                        GL_UNSIGNED_BYTE,
+                        packet.constData());
+
+    static const GLfloat quad[] = {
+        -1.0f, -1.0f,
+         1.0f, -1.0f,
+        -1.0f,  1.0f,
+         1.0f,  1.0f
+    };
+
+    GLuint sourceTexture = this->d->m_frameTexture;
+    QOpenGLFramebufferObject *target = nullptr;
+
+    for (int pass = 0; pass < this->d->m_programs.size(); pass++) {
+        target = this->d->m_fbo[pass & 0x1];
+        target->bind();
+        gl->glViewport(0, 0, width, height);
+
+        auto program = this->d->m_programs[pass];
+        program->bind();
+        program->setUniformValue("frame", 0);
+        program->setUniformValue("resolution",
+                                 GLfloat(width),
+                                 GLfloat(height));
+        this->d->applyUniforms(program);
+
+        gl->glActiveTexture(GL_TEXTURE0);
+        gl->glBindTexture(GL_TEXTURE_2D, sourceTexture);
+
+        program->enableAttributeArray("position");
+        program->setAttributeArray("position", quad, 2);
+        gl->glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        program->disableAttributeArray("position");
+        program->release();
+
+        target->release();
+        sourceTexture = target->texture();
+    }
+
+    // Single readback after the last pass.
+    QByteArray oBuffer(int(frameSize), 0);
+    target->bind();
+    gl->glReadPixels(0,
+                     0,
+                     width,
+                     height,
+                     GL_BGRA,
+                     GL_UNSIGNED_BYTE,
+                     oBuffer.data());
+    target->release();
+    this->d->m_context->doneCurrent();
+
+    AkVideoPacket dst(packet);
+    dst.setBuffer(oBuffer);
+
+    return dst;
+}
+
+#include "moc_akvideoshaderchain.cpp"
@@ -0,0 +1,76 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef AKVIDEOSHADERCHAIN_H
+#define AKVIDEOSHADERCHAIN_H
+
+#include <QObject>
+#include <QVariantMap>
+
+#include "akvideopacket.h"
+
+class AkVideoShaderChainPrivate;
+
+/* Offscreen GPU pass chain for packet-to-packet effects.
+ *
+ * An effect registers one fragment shader per pass. process() uploads the
+ * ARGB frame once, runs every pass on the GPU ping-ponging between two
+ * framebuffers with no intermediate readback, and reads the result back
+ * only after the last pass. Each pass samples the previous one through the
+ * 'frame' sampler and gets the frame size in the 'resolution' uniform;
+ * values set with setUniforms() are applied to every pass, so effect
+ * parameters can change per frame without recompiling.
+ *
+ * Callers check isValid() once when the stream starts and keep their CPU
+ * kernel as the fallback: creating the context can fail on headless or
+ * software-only setups, and process() returns an empty packet for frame
+ * formats the chain can't take. Handing the final texture straight to the
+ * scene graph needs cooperation from the display side, until then the
+ * result is read back once per frame.
+ */
+class AKCOMMONS_EXPORT AkVideoShaderChain: public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool isValid
+               READ isValid
+               CONSTANT)
+
+    public:
+        explicit AkVideoShaderChain(QObject *parent=nullptr);
+        ~AkVideoShaderChain();
+
+        Q_INVOKABLE bool isValid() const;
+        Q_INVOKABLE QStringList passes() const;
+        Q_INVOKABLE QVariantMap uniforms() const;
+
+        /* Compile one program per fragment shader source. Returns false and
+         * keeps the previous passes if any of them fails to compile. */
+        bool setPasses(const QStringList &fragmentShaders);
+        void setUniforms(const QVariantMap &uniforms);
+
+        /* Run the whole chain over the packet. Returns an empty packet when
+         * the chain is not usable for this frame, so the caller can run its
+         * CPU path instead. */
+        AkVideoPacket process(const AkVideoPacket &packet);
+
+    private:
+        AkVideoShaderChainPrivate *d;
+};
+
+#endif // AKVIDEOSHADERCHAIN_H
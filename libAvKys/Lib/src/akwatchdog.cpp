@@ -0,0 +1,211 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QThread>
+#include <QTimer>
+
+#include "akwatchdog.h"
+#include "akelement.h"
+
+#define CHECK_INTERVAL 500
+
+class AkWatchdogWatch
+{
+    public:
+        int m_timeout;
+        AkWatchdog::RecoveryAction m_action;
+        qint64 m_since;
+
+        // Time the stall was flagged, -1 while the element is healthy.
+        qint64 m_stalledAt;
+};
+
+class AkWatchdogPrivate
+{
+    public:
+        QThread m_thread;
+        QTimer *m_timer;
+        mutable QMutex m_mutex;
+        QHash<AkElement *, AkWatchdogWatch> m_watches;
+        QAtomicInt m_active;
+};
+
+AkWatchdog::AkWatchdog(QObject *parent):
+    QObject(parent)
+{
+    this->d = new AkWatchdogPrivate;
+    this->d->m_active.storeRelease(0);
+    qRegisterMetaType<AkElement *>("AkElement*");
+
+    // The monitor runs in its own thread, it only reads atomic heartbeats
+    // and the element states, so a wedged pipeline can't wedge it too.
+    this->d->m_thread.start();
+    this->moveToThread(&this->d->m_thread);
+    this->d->m_timer = new QTimer;
+    this->d->m_timer->setInterval(CHECK_INTERVAL);
+    this->d->m_timer->moveToThread(&this->d->m_thread);
+    QObject::connect(this->d->m_timer,
+                     &QTimer::timeout,
+                     this,
+                     &AkWatchdog::checkHeartbeats);
+}
+
+AkWatchdog::~AkWatchdog()
+{
+    this->d->m_thread.quit();
+    this->d->m_thread.wait();
+    delete this->d->m_timer;
+    delete this->d;
+}
+
+bool AkWatchdog::active() const
+{
+    return this->d->m_active.loadAcquire() != 0;
+}
+
+void AkWatchdog::watch(AkElement *element,
+                       int timeoutMs,
+                       RecoveryAction action)
+{
+    if (!element)
+        return;
+
+    QObject::connect(element,
+                     SIGNAL(destroyed(QObject *)),
+                     this,
+                     SLOT(elementDestroyed(QObject *)),
+                     Qt::ConnectionType(Qt::DirectConnection
+                                        | Qt::UniqueConnection));
+    QMutexLocker locker(&this->d->m_mutex);
+    this->d->m_watches[element] = {timeoutMs,
+                                   action,
+                                   AkWatchdog::clockMs(),
+                                   -1};
+    this->d->m_active.storeRelease(1);
+    QMetaObject::invokeMethod(this->d->m_timer,
+                              "start",
+                              Qt::QueuedConnection);
+}
+
+void AkWatchdog::unwatch(AkElement *element)
+{
+    QMutexLocker locker(&this->d->m_mutex);
+    this->d->m_watches.remove(element);
+
+    if (this->d->m_watches.isEmpty()) {
+        this->d->m_active.storeRelease(0);
+        QMetaObject::invokeMethod(this->d->m_timer,
+                                  "stop",
+                                  Qt::QueuedConnection);
+    }
+}
+
+qint64 AkWatchdog::clockMs()
+{
+    static const QElapsedTimer akWatchdogClock = [] {
+        QElapsedTimer timer;
+        timer.start();
+
+        return timer;
+    }();
+
+    return akWatchdogClock.elapsed();
+}
+
+Q_GLOBAL_STATIC(AkWatchdog, akGlobalWatchdog)
+
+AkWatchdog *AkWatchdog::instance()
+{
+    return akGlobalWatchdog;
+}
+
+void AkWatchdog::checkHeartbeats()
+{
+    qint64 now = AkWatchdog::clockMs();
+    QList<AkElement *> stalledElements;
+    QList<AkElement *> recoveredElements;
+    QList<AkElement *> restartElements;
+
+    this->d->m_mutex.lock();
+
+    for (auto it = this->d->m_watches.begin();
+         it != this->d->m_watches.end();
+         it++) {
+        auto element = it.key();
+        auto &watch = it.value();
+
+        // Idle and paused elements are legitimately silent.
+        if (element->state() != AkElement::ElementStatePlaying) {
+            watch.m_since = now;
+            watch.m_stalledAt = -1;
+
+            continue;
+        }
+
+        auto beat = element->lastActivity();
+        auto last = qMax(beat, watch.m_since);
+
+        if (watch.m_stalledAt < 0 && now - last > watch.m_timeout) {
+            watch.m_stalledAt = now;
+            stalledElements << element;
+
+            if (watch.m_action == RecoveryActionRestart) {
+                restartElements << element;
+                // Fresh leash, the restart itself takes a while.
+                watch.m_since = now;
+            }
+        } else if (watch.m_stalledAt >= 0 && beat > watch.m_stalledAt) {
+            watch.m_stalledAt = -1;
+            recoveredElements << element;
+        }
+    }
+
+    this->d->m_mutex.unlock();
+
+    for (auto element: stalledElements)
+        emit this->stalled(element);
+
+    /* Bounce only the wedged element through Null back to Playing, in its
+     * own thread, the rest of the graph keeps running. */
+    for (auto element: restartElements) {
+        QMetaObject::invokeMethod(element,
+                                  "setState",
+                                  Qt::QueuedConnection,
+                                  Q_ARG(AkElement::ElementState,
+                                        AkElement::ElementStateNull));
+        QMetaObject::invokeMethod(element,
+                                  "setState",
+                                  Qt::QueuedConnection,
+                                  Q_ARG(AkElement::ElementState,
+                                        AkElement::ElementStatePlaying));
+    }
+
+    for (auto element: recoveredElements)
+        emit this->recovered(element);
+}
+
+void AkWatchdog::elementDestroyed(QObject *element)
+{
+    this->unwatch(reinterpret_cast<AkElement *>(element));
+}
+
+#include "moc_akwatchdog.cpp"
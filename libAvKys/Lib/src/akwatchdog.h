@@ -0,0 +1,81 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef AKWATCHDOG_H
+#define AKWATCHDOG_H
+
+#include <QObject>
+
+#include "akcommons.h"
+
+class AkWatchdogPrivate;
+class AkElement;
+
+/* Stall watchdog for running pipelines.
+ *
+ * Watched elements publish a heartbeat, an atomic timestamp refreshed every
+ * time they deliver a packet downstream, and a monitor thread flags any
+ * watched element that stays playing without delivering for longer than its
+ * timeout. Recovery is configurable per watch: just notify through the
+ * stalled() signal, so the application can switch to a fallback source, or
+ * bounce the wedged element through Null back to Playing, leaving the rest
+ * of the graph untouched. The heartbeat costs one clock read and one atomic
+ * store per packet, and nothing at all while no element is watched.
+ */
+class AKCOMMONS_EXPORT AkWatchdog: public QObject
+{
+    Q_OBJECT
+    Q_ENUMS(RecoveryAction)
+
+    public:
+        enum RecoveryAction
+        {
+            RecoveryActionNotify,
+            RecoveryActionRestart
+        };
+
+        explicit AkWatchdog(QObject *parent=nullptr);
+        ~AkWatchdog();
+
+        /* True while at least one element is watched. Elements skip the
+         * heartbeat entirely when this is false. */
+        bool active() const;
+
+        Q_INVOKABLE void watch(AkElement *element,
+                               int timeoutMs=3000,
+                               RecoveryAction action=RecoveryActionRestart);
+        Q_INVOKABLE void unwatch(AkElement *element);
+
+        // Monotonic milliseconds shared by heartbeats and the monitor.
+        static qint64 clockMs();
+        static AkWatchdog *instance();
+
+    private:
+        AkWatchdogPrivate *d;
+
+    Q_SIGNALS:
+        void stalled(AkElement *element);
+        void recovered(AkElement *element);
+
+    private Q_SLOTS:
+        void checkHeartbeats();
+        void elementDestroyed(QObject *element);
+};
+
+#endif // AKWATCHDOG_H
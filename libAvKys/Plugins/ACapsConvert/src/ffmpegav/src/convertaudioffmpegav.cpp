@@ -80,12 +80,21 @@ class ConvertAudioFFmpegAVPrivate
 {
     public:
         AkAudioCaps m_caps;
+        AkAudioCaps m_iCaps;
         AVAudioResampleContext *m_resampleContext;
+        uint64_t m_iSampleLayout;
+        uint64_t m_oSampleLayout;
+        AVSampleFormat m_iSampleFormat;
+        AVSampleFormat m_oSampleFormat;
         QMutex m_mutex;
         bool m_contextIsOpen;
 
         ConvertAudioFFmpegAVPrivate():
             m_resampleContext(nullptr),
+            m_iSampleLayout(0),
+            m_oSampleLayout(0),
+            m_iSampleFormat(AV_SAMPLE_FMT_NONE),
+            m_oSampleFormat(AV_SAMPLE_FMT_NONE),
             m_contextIsOpen(false)
         {
         }
@@ -111,7 +120,9 @@ bool ConvertAudioFFmpegAV::init(const AkAudioCaps &caps)
 {
     QMutexLocker mutexLocker(&this->d->m_mutex);
     this->d->m_caps = caps;
+    this->d->m_iCaps = AkAudioCaps();
     this->d->m_resampleContext = avresample_alloc_context();
+    this->d->m_contextIsOpen = false;
 
     return true;
 }
@@ -123,28 +134,48 @@ AkPacket ConvertAudioFFmpegAV::convert(const AkAudioPacket &packet)
     if (!this->d->m_caps)
         return AkPacket();
 
-    uint64_t iSampleLayout = channelLayouts->value(packet.caps().layout(), 0);
+    /* The sample format lookups go through strings, so they are redone only
+     * when the input caps change, which also reopens the context; before
+     * this the context kept the parameters of the first packet forever. In
+     * the steady state everything below uses the cached values.
+     */
+    auto iCaps = packet.caps();
+    iCaps.samples() = 0;
+
+    if (iCaps != this->d->m_iCaps) {
+        this->d->m_iSampleLayout =
+                channelLayouts->value(packet.caps().layout(), 0);
+        this->d->m_iSampleFormat =
+                av_get_sample_fmt(AkAudioCaps::sampleFormatToString(packet.caps().format())
+                                  .toStdString().c_str());
+        this->d->m_oSampleLayout =
+                channelLayouts->value(this->d->m_caps.layout(),
+                                      AV_CH_LAYOUT_STEREO);
+        this->d->m_oSampleFormat =
+                av_get_sample_fmt(AkAudioCaps::sampleFormatToString(this->d->m_caps.format())
+                                  .toStdString().c_str());
+
+        if (this->d->m_contextIsOpen) {
+            avresample_close(this->d->m_resampleContext);
+            this->d->m_contextIsOpen = false;
+        }
 
-    AVSampleFormat iSampleFormat =
-            av_get_sample_fmt(AkAudioCaps::sampleFormatToString(packet.caps().format())
-                              .toStdString().c_str());
+        this->d->m_iCaps = iCaps;
+    }
 
+    uint64_t iSampleLayout = this->d->m_iSampleLayout;
+    AVSampleFormat iSampleFormat = this->d->m_iSampleFormat;
     int iSampleRate = packet.caps().rate();
     int iNChannels = packet.caps().channels();
     int iNSamples = packet.caps().samples();
 
-    uint64_t oSampleLayout = channelLayouts->value(this->d->m_caps.layout(),
-                                                   AV_CH_LAYOUT_STEREO);
-
-    AVSampleFormat oSampleFormat =
-            av_get_sample_fmt(AkAudioCaps::sampleFormatToString(this->d->m_caps.format())
-                              .toStdString().c_str());
-
+    uint64_t oSampleLayout = this->d->m_oSampleLayout;
+    AVSampleFormat oSampleFormat = this->d->m_oSampleFormat;
     int oSampleRate = this->d->m_caps.rate();
     int oNChannels = this->d->m_caps.channels();
 
     // Create input audio frame.
-    static AVFrame iFrame;
+    AVFrame iFrame;
     memset(&iFrame, 0, sizeof(AVFrame));
     iFrame.format = iSampleFormat;
     iFrame.channel_layout = uint64_t(iSampleLayout);
@@ -271,6 +302,7 @@ void ConvertAudioFFmpegAV::uninit()
 {
     QMutexLocker mutexLocker(&this->d->m_mutex);
     this->d->m_caps = AkAudioCaps();
+    this->d->m_iCaps = AkAudioCaps();
 
     if (this->d->m_resampleContext)
         avresample_free(&this->d->m_resampleContext);
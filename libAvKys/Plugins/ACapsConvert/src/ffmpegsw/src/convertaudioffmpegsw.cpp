@@ -76,11 +76,20 @@ class ConvertAudioFFmpegSWPrivate
 {
     public:
         AkAudioCaps m_caps;
+        AkAudioCaps m_iCaps;
         SwrContext *m_resampleContext;
+        int64_t m_iSampleLayout;
+        int64_t m_oSampleLayout;
+        AVSampleFormat m_iSampleFormat;
+        AVSampleFormat m_oSampleFormat;
         QMutex m_mutex;
 
         ConvertAudioFFmpegSWPrivate():
-            m_resampleContext(nullptr)
+            m_resampleContext(nullptr),
+            m_iSampleLayout(0),
+            m_oSampleLayout(0),
+            m_iSampleFormat(AV_SAMPLE_FMT_NONE),
+            m_oSampleFormat(AV_SAMPLE_FMT_NONE)
         {
         }
 };
@@ -105,6 +114,7 @@ bool ConvertAudioFFmpegSW::init(const AkAudioCaps &caps)
 {
     QMutexLocker mutexLocker(&this->d->m_mutex);
     this->d->m_caps = caps;
+    this->d->m_iCaps = AkAudioCaps();
 
     return true;
 }
@@ -116,42 +126,57 @@ AkPacket ConvertAudioFFmpegSW::convert(const AkAudioPacket &packet)
     if (!this->d->m_caps)
         return AkPacket();
 
-    int64_t iSampleLayout = channelLayouts->value(packet.caps().layout(), 0);
-
-    AVSampleFormat iSampleFormat =
-            av_get_sample_fmt(AkAudioCaps::sampleFormatToString(packet.caps().format())
-                              .toStdString().c_str());
+    /* The sample format lookups go through strings and the context setup
+     * walks the option tables, so both are done only when the input caps
+     * actually change. In the steady state the cached context is reused
+     * untouched, packet after packet.
+     */
+    auto iCaps = packet.caps();
+    iCaps.samples() = 0;
+
+    if (!this->d->m_resampleContext || iCaps != this->d->m_iCaps) {
+        this->d->m_iSampleLayout =
+                channelLayouts->value(packet.caps().layout(), 0);
+        this->d->m_iSampleFormat =
+                av_get_sample_fmt(AkAudioCaps::sampleFormatToString(packet.caps().format())
+                                  .toStdString().c_str());
+        this->d->m_oSampleLayout =
+                channelLayouts->value(this->d->m_caps.layout(),
+                                      AV_CH_LAYOUT_STEREO);
+        this->d->m_oSampleFormat =
+                av_get_sample_fmt(AkAudioCaps::sampleFormatToString(this->d->m_caps.format())
+                                  .toStdString().c_str());
+
+        this->d->m_resampleContext =
+                swr_alloc_set_opts(this->d->m_resampleContext,
+                                   this->d->m_oSampleLayout,
+                                   this->d->m_oSampleFormat,
+                                   this->d->m_caps.rate(),
+                                   this->d->m_iSampleLayout,
+                                   this->d->m_iSampleFormat,
+                                   packet.caps().rate(),
+                                   0,
+                                   nullptr);
+
+        if (!this->d->m_resampleContext)
+            return AkPacket();
+
+        this->d->m_iCaps = iCaps;
+    }
 
+    int64_t iSampleLayout = this->d->m_iSampleLayout;
+    AVSampleFormat iSampleFormat = this->d->m_iSampleFormat;
     int iSampleRate = packet.caps().rate();
     int iNChannels = packet.caps().channels();
     int iNSamples = packet.caps().samples();
 
-    int64_t oSampleLayout = channelLayouts->value(this->d->m_caps.layout(),
-                                                  AV_CH_LAYOUT_STEREO);
-
-    AVSampleFormat oSampleFormat =
-            av_get_sample_fmt(AkAudioCaps::sampleFormatToString(this->d->m_caps.format())
-                              .toStdString().c_str());
-
+    int64_t oSampleLayout = this->d->m_oSampleLayout;
+    AVSampleFormat oSampleFormat = this->d->m_oSampleFormat;
     int oSampleRate = this->d->m_caps.rate();
     int oNChannels = this->d->m_caps.channels();
 
-    this->d->m_resampleContext =
-            swr_alloc_set_opts(this->d->m_resampleContext,
-                               oSampleLayout,
-                               oSampleFormat,
-                               oSampleRate,
-                               iSampleLayout,
-                               iSampleFormat,
-                               iSampleRate,
-                               0,
-                               nullptr);
-
-    if (!this->d->m_resampleContext)
-        return AkPacket();
-
     // Create input audio frame.
-    static AVFrame iFrame;
+    AVFrame iFrame;
     memset(&iFrame, 0, sizeof(AVFrame));
     iFrame.format = iSampleFormat;
     iFrame.channels = iNChannels;
@@ -231,6 +256,7 @@ void ConvertAudioFFmpegSW::uninit()
 {
     QMutexLocker mutexLocker(&this->d->m_mutex);
     this->d->m_caps = AkAudioCaps();
+    this->d->m_iCaps = AkAudioCaps();
 
     if (this->d->m_resampleContext)
         swr_free(&this->d->m_resampleContext);
@@ -25,10 +25,15 @@
 #include <QQmlContext>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akvideofilterrunner.h>
 
 #include "agingelement.h"
 #include "scratch.h"
 
+// Pooled grain planes cycled per frame, see AgingElementPrivate.
+static const int NoisePlanes = 4;
+static const int ColorVariance = 24;
+
 class AgingElementPrivate
 {
     public:
@@ -36,12 +41,54 @@ class AgingElementPrivate
         QMutex m_mutex;
         bool m_addDust;
 
+        /* Pregenerated grain planes. Each frame picks a random plane and a
+         * random offset into it, and a small slice of one plane is
+         * refreshed, so the grain stays alive without a qrand() call per
+         * pixel.
+         */
+        QVector<QVector<quint8>> m_noisePlanes;
+        QSize m_noiseSize;
+        int m_noiseRefresh;
+
         AgingElementPrivate():
-            m_addDust(true)
+            m_addDust(true),
+            m_noiseRefresh(0)
         {
         }
+
+        inline void updateNoisePlanes(const QSize &size);
 };
 
+void AgingElementPrivate::updateNoisePlanes(const QSize &size)
+{
+    int planeSize = size.width() * (size.height() + 1);
+
+    if (this->m_noiseSize != size) {
+        this->m_noisePlanes.resize(NoisePlanes);
+
+        for (auto &plane: this->m_noisePlanes) {
+            plane.resize(planeSize);
+
+            for (auto &noise: plane)
+                noise = quint8(qrand() % ColorVariance);
+        }
+
+        this->m_noiseSize = size;
+
+        return;
+    }
+
+    // Refresh one slice per frame, cycling through the pool.
+    auto &plane = this->m_noisePlanes[this->m_noiseRefresh % NoisePlanes];
+    int sliceSize = planeSize / 32;
+    int offset = sliceSize * (this->m_noiseRefresh / NoisePlanes % 32);
+
+    for (int i = 0; i < sliceSize; i++)
+        plane[offset + i] = quint8(qrand() % ColorVariance);
+
+    this->m_noiseRefresh++;
+}
+
 AgingElement::AgingElement(): AkElement()
 {
     this->d = new AgingElementPrivate;
@@ -70,26 +117,35 @@ QImage AgingElement::colorAging(const QImage &src)
     QImage dst(src.size(), src.format());
 
     int lumaVariance = 8;
-    int colorVariance = 24;
     int luma = -32 + qrand() % lumaVariance;
 
-    for (int y = 0; y < src.height(); y++) {
-        const QRgb *srcLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
-        QRgb *dstLine = reinterpret_cast<QRgb *>(dst.scanLine(y));
+    this->d->updateNoisePlanes(src.size());
 
-        for (int x = 0; x < src.width(); x++) {
-            int c = qrand() % colorVariance;
-            int r = qRed(srcLine[x]) + luma + c;
-            int g = qGreen(srcLine[x]) + luma + c;
-            int b = qBlue(srcLine[x]) + luma + c;
+    int width = src.width();
+    const auto &plane = this->d->m_noisePlanes[qrand() % NoisePlanes];
+    const quint8 *noise = plane.constData() + qrand() % width;
 
-            r = qBound(0, r, 255);
-            g = qBound(0, g, 255);
-            b = qBound(0, b, 255);
+    AkVideoFilterRunner::globalRunner()->run(src.height(),
+                                             [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            const QRgb *srcLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
+            QRgb *dstLine = reinterpret_cast<QRgb *>(dst.scanLine(y));
+            const quint8 *noiseLine = noise + y * width;
+
+            for (int x = 0; x < width; x++) {
+                int c = luma + noiseLine[x];
+                int r = qRed(srcLine[x]) + c;
+                int g = qGreen(srcLine[x]) + c;
+                int b = qBlue(srcLine[x]) + c;
 
-            dstLine[x] = qRgba(r, g, b, qAlpha(srcLine[x]));
+                r = qBound(0, r, 255);
+                g = qBound(0, g, 255);
+                b = qBound(0, b, 255);
+
+                dstLine[x] = qRgba(r, g, b, qAlpha(srcLine[x]));
+            }
         }
-    }
+    });
 
     return dst;
 }
@@ -67,6 +67,16 @@ inline SampleFormatMap initSampleFormatMap()
 
 Q_GLOBAL_STATIC_WITH_ARGS(SampleFormatMap, sampleFormats, (initSampleFormatMap()))
 
+// Address of the given frame inside the mmaped driver ring buffer. With
+// interleaved access all the channels share the first area.
+inline char *areaData(const snd_pcm_channel_area_t *areas,
+                      snd_pcm_uframes_t offset)
+{
+    return static_cast<char *>(areas[0].addr)
+           + areas[0].first / 8
+           + offset * areas[0].step / 8;
+}
+
 class AudioDevAlsaPrivate
 {
     public:
@@ -84,11 +94,13 @@ class AudioDevAlsaPrivate
         QFileSystemWatcher *m_fsWatcher;
         QTimer m_timer;
         QMutex m_mutex;
+        bool m_mmap;
 
         AudioDevAlsaPrivate(AudioDevAlsa *self):
             self(self),
             m_pcmHnd(nullptr),
-            m_fsWatcher(nullptr)
+            m_fsWatcher(nullptr),
+            m_mmap(false)
         {
         }
 
@@ -206,18 +218,45 @@ bool AudioDevAlsa::init(const QString &device, const AkAudioCaps &caps)
     if (error < 0)
         goto init_fail;
 
+    /* Try the mmap access mode first, so samples are exchanged directly
+     * with the driver ring buffer instead of being staged through
+     * alsa-lib, and fall back to the plain read/write mode if the device
+     * can't do it.
+     */
+    this->d->m_mmap = true;
     error = snd_pcm_set_params(this->d->m_pcmHnd,
                                sampleFormats->value(caps.format(),
                                                     SND_PCM_FORMAT_UNKNOWN),
-                               SND_PCM_ACCESS_RW_INTERLEAVED,
+                               SND_PCM_ACCESS_MMAP_INTERLEAVED,
                                uint(caps.channels()),
                                uint(caps.rate()),
                                1,
                                500000);
 
+    if (error < 0) {
+        this->d->m_mmap = false;
+        error = snd_pcm_set_params(this->d->m_pcmHnd,
+                                   sampleFormats->value(caps.format(),
+                                                        SND_PCM_FORMAT_UNKNOWN),
+                                   SND_PCM_ACCESS_RW_INTERLEAVED,
+                                   uint(caps.channels()),
+                                   uint(caps.rate()),
+                                   1,
+                                   500000);
+    }
+
     if (error < 0)
         goto init_fail;
 
+    // Unlike the read/write transfers, the mmap ones don't auto start the
+    // capture stream, so do it here.
+    if (this->d->m_mmap && device.endsWith(":Input")) {
+        error = snd_pcm_start(this->d->m_pcmHnd);
+
+        if (error < 0)
+            goto init_fail;
+    }
+
     return true;
 
 init_fail:
@@ -236,6 +275,68 @@ QByteArray AudioDevAlsa::read(int samples)
     QByteArray buffer(int(bufferSize), 0);
     auto data = buffer.data();
 
+    if (this->d->m_mmap) {
+        while (samples > 0) {
+            auto avail = snd_pcm_avail_update(this->d->m_pcmHnd);
+
+            if (avail < 0) {
+                avail = snd_pcm_recover(this->d->m_pcmHnd, int(avail), 0);
+
+                if (avail < 0)
+                    return QByteArray();
+
+                snd_pcm_start(this->d->m_pcmHnd);
+
+                continue;
+            }
+
+            if (avail < 1) {
+                snd_pcm_wait(this->d->m_pcmHnd, 1000);
+
+                continue;
+            }
+
+            const snd_pcm_channel_area_t *areas = nullptr;
+            snd_pcm_uframes_t offset = 0;
+            auto frames = snd_pcm_uframes_t(qMin<snd_pcm_sframes_t>(avail,
+                                                                    samples));
+
+            if (snd_pcm_mmap_begin(this->d->m_pcmHnd,
+                                   &areas,
+                                   &offset,
+                                   &frames) < 0)
+                return QByteArray();
+
+            // Copy the samples straight out of the driver ring buffer.
+            memcpy(data,
+                   areaData(areas, offset),
+                   size_t(snd_pcm_frames_to_bytes(this->d->m_pcmHnd,
+                                                  snd_pcm_sframes_t(frames))));
+
+            auto rsamples = snd_pcm_mmap_commit(this->d->m_pcmHnd,
+                                                offset,
+                                                frames);
+
+            if (rsamples < 0) {
+                rsamples = snd_pcm_recover(this->d->m_pcmHnd,
+                                           int(rsamples),
+                                           0);
+
+                if (rsamples < 0)
+                    return QByteArray();
+
+                snd_pcm_start(this->d->m_pcmHnd);
+
+                continue;
+            }
+
+            data += snd_pcm_frames_to_bytes(this->d->m_pcmHnd, rsamples);
+            samples -= rsamples;
+        }
+
+        return buffer;
+    }
+
     while (samples > 0) {
         auto rsamples = snd_pcm_readi(this->d->m_pcmHnd,
                                       data,
@@ -270,6 +371,77 @@ bool AudioDevAlsa::write(const AkAudioPacket &packet)
     auto data = packet.buffer().constData();
     int dataSize = packet.buffer().size();
 
+    if (this->d->m_mmap) {
+        while (dataSize > 0) {
+            auto avail = snd_pcm_avail_update(this->d->m_pcmHnd);
+
+            if (avail < 0) {
+                avail = snd_pcm_recover(this->d->m_pcmHnd, int(avail), 0);
+
+                if (avail < 0)
+                    return false;
+
+                continue;
+            }
+
+            if (avail < 1) {
+                /* The mmap transfers don't auto start the playback stream
+                 * when the queued samples pass the start threshold, so if
+                 * the ring filled up while still in the prepared state,
+                 * kick it manually before waiting for room.
+                 */
+                if (snd_pcm_state(this->d->m_pcmHnd) == SND_PCM_STATE_PREPARED
+                    && snd_pcm_start(this->d->m_pcmHnd) < 0)
+                    return false;
+
+                snd_pcm_wait(this->d->m_pcmHnd, 1000);
+
+                continue;
+            }
+
+            auto samples = snd_pcm_bytes_to_frames(this->d->m_pcmHnd,
+                                                   dataSize);
+            const snd_pcm_channel_area_t *areas = nullptr;
+            snd_pcm_uframes_t offset = 0;
+            auto frames = snd_pcm_uframes_t(qMin(avail, samples));
+
+            if (snd_pcm_mmap_begin(this->d->m_pcmHnd,
+                                   &areas,
+                                   &offset,
+                                   &frames) < 0)
+                return false;
+
+            // Write the samples straight into the driver ring buffer.
+            memcpy(areaData(areas, offset),
+                   data,
+                   size_t(snd_pcm_frames_to_bytes(this->d->m_pcmHnd,
+                                                  snd_pcm_sframes_t(frames))));
+
+            samples = snd_pcm_mmap_commit(this->d->m_pcmHnd, offset, frames);
+
+            if (samples < 0) {
+                samples = snd_pcm_recover(this->d->m_pcmHnd, int(samples), 0);
+
+                if (samples < 0)
+                    return false;
+
+                continue;
+            }
+
+            auto dataWritten = snd_pcm_frames_to_bytes(this->d->m_pcmHnd,
+                                                       samples);
+            data += dataWritten;
+            dataSize -= dataWritten;
+        }
+
+        // Start the stream if the whole packet fitted in the ring buffer
+        // without filling it.
+        if (snd_pcm_state(this->d->m_pcmHnd) == SND_PCM_STATE_PREPARED)
+            snd_pcm_start(this->d->m_pcmHnd);
+
+        return true;
+    }
+
     while (dataSize > 0) {
         auto samples = snd_pcm_bytes_to_frames(this->d->m_pcmHnd, dataSize);
         samples = snd_pcm_writei(this->d->m_pcmHnd,
@@ -408,24 +580,25 @@ void AudioDevAlsa::updateDevices()
 
         snd_ctl_close(ctlHnd);
 
-        QList<AkAudioCaps::SampleFormat> _supportedFormats;
-        QList<int> _supportedChannels;
-        QList<int> _supportedSampleRates;
-
         auto input = deviceId + ":Input";
-        this->d->fillDeviceInfo(input,
-                                &_supportedFormats,
-                                &_supportedChannels,
-                                &_supportedSampleRates);
 
-        if (_supportedFormats.isEmpty())
-            _supportedFormats = this->d->m_supportedFormats.value(input);
+        // The caps probed in previous scans survive, so a hotplug rescan
+        // only opens the devices that just appeared.
+        auto _supportedFormats = this->d->m_supportedFormats.value(input);
+        auto _supportedChannels = this->d->m_supportedChannels.value(input);
+        auto _supportedSampleRates = this->d->m_supportedSampleRates.value(input);
 
-        if (_supportedChannels.isEmpty())
-            _supportedChannels = this->d->m_supportedChannels.value(input);
-
-        if (_supportedSampleRates.isEmpty())
-            _supportedSampleRates = this->d->m_supportedSampleRates.value(input);
+        if (_supportedFormats.isEmpty()
+            || _supportedChannels.isEmpty()
+            || _supportedSampleRates.isEmpty()) {
+            _supportedFormats.clear();
+            _supportedChannels.clear();
+            _supportedSampleRates.clear();
+            this->d->fillDeviceInfo(input,
+                                    &_supportedFormats,
+                                    &_supportedChannels,
+                                    &_supportedSampleRates);
+        }
 
         if (!_supportedFormats.isEmpty()
             && !_supportedChannels.isEmpty()
@@ -437,24 +610,22 @@ void AudioDevAlsa::updateDevices()
             supportedSampleRates[input] = _supportedSampleRates;
         }
 
-        _supportedFormats.clear();
-        _supportedChannels.clear();
-        _supportedSampleRates.clear();
-
         auto output = deviceId + ":Output";
-        this->d->fillDeviceInfo(output,
-                                &_supportedFormats,
-                                &_supportedChannels,
-                                &_supportedSampleRates);
+        _supportedFormats = this->d->m_supportedFormats.value(output);
+        _supportedChannels = this->d->m_supportedChannels.value(output);
+        _supportedSampleRates = this->d->m_supportedSampleRates.value(output);
 
-        if (_supportedFormats.isEmpty())
-            _supportedFormats = this->d->m_supportedFormats.value(output);
-
-        if (_supportedChannels.isEmpty())
-            _supportedChannels = this->d->m_supportedChannels.value(output);
-
-        if (_supportedSampleRates.isEmpty())
-            _supportedSampleRates = this->d->m_supportedSampleRates.value(output);
+        if (_supportedFormats.isEmpty()
+            || _supportedChannels.isEmpty()
+            || _supportedSampleRates.isEmpty()) {
+            _supportedFormats.clear();
+            _supportedChannels.clear();
+            _supportedSampleRates.clear();
+            this->d->fillDeviceInfo(output,
+                                    &_supportedFormats,
+                                    &_supportedChannels,
+                                    &_supportedSampleRates);
+        }
 
         if (!_supportedFormats.isEmpty()
             && !_supportedChannels.isEmpty()
@@ -492,20 +663,21 @@ void AudioDevAlsa::updateDevices()
 
             if (fillInputs && (io.isEmpty() || io == "Input")) {
                 auto input = deviceId + ":Input";
-
-                this->d->fillDeviceInfo(input,
-                                        &_supportedFormats,
-                                        &_supportedChannels,
-                                        &_supportedSampleRates);
-
-                if (_supportedFormats.isEmpty())
-                    _supportedFormats = this->d->m_supportedFormats.value(input);
-
-                if (_supportedChannels.isEmpty())
-                    _supportedChannels = this->d->m_supportedChannels.value(input);
-
-                if (_supportedSampleRates.isEmpty())
-                    _supportedSampleRates = this->d->m_supportedSampleRates.value(input);
+                _supportedFormats = this->d->m_supportedFormats.value(input);
+                _supportedChannels = this->d->m_supportedChannels.value(input);
+                _supportedSampleRates = this->d->m_supportedSampleRates.value(input);
+
+                if (_supportedFormats.isEmpty()
+                    || _supportedChannels.isEmpty()
+                    || _supportedSampleRates.isEmpty()) {
+                    _supportedFormats.clear();
+                    _supportedChannels.clear();
+                    _supportedSampleRates.clear();
+                    this->d->fillDeviceInfo(input,
+                                            &_supportedFormats,
+                                            &_supportedChannels,
+                                            &_supportedSampleRates);
+                }
 
                 if (!_supportedFormats.isEmpty()
                     && !_supportedChannels.isEmpty()
@@ -524,20 +696,21 @@ void AudioDevAlsa::updateDevices()
 
             if (fillOuputs && (io.isEmpty() || io == "Output")) {
                 auto output = deviceId + ":Output";
-
-                this->d->fillDeviceInfo(output,
-                                        &_supportedFormats,
-                                        &_supportedChannels,
-                                        &_supportedSampleRates);
-
-                if (_supportedFormats.isEmpty())
-                    _supportedFormats = this->d->m_supportedFormats.value(output);
-
-                if (_supportedChannels.isEmpty())
-                    _supportedChannels = this->d->m_supportedChannels.value(output);
-
-                if (_supportedSampleRates.isEmpty())
-                    _supportedSampleRates = this->d->m_supportedSampleRates.value(output);
+                _supportedFormats = this->d->m_supportedFormats.value(output);
+                _supportedChannels = this->d->m_supportedChannels.value(output);
+                _supportedSampleRates = this->d->m_supportedSampleRates.value(output);
+
+                if (_supportedFormats.isEmpty()
+                    || _supportedChannels.isEmpty()
+                    || _supportedSampleRates.isEmpty()) {
+                    _supportedFormats.clear();
+                    _supportedChannels.clear();
+                    _supportedSampleRates.clear();
+                    this->d->fillDeviceInfo(output,
+                                            &_supportedFormats,
+                                            &_supportedChannels,
+                                            &_supportedSampleRates);
+                }
 
                 if (!_supportedFormats.isEmpty()
                     && !_supportedChannels.isEmpty()
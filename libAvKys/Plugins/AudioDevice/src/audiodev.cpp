@@ -66,6 +66,11 @@ QString AudioDev::error() const
     return QString();
 }
 
+bool AudioDev::exclusiveMode() const
+{
+    return false;
+}
+
 QString AudioDev::defaultInput()
 {
     return QString();
@@ -148,4 +153,14 @@ bool AudioDev::uninit()
     return true;
 }
 
+void AudioDev::setExclusiveMode(bool exclusiveMode)
+{
+    Q_UNUSED(exclusiveMode)
+}
+
+void AudioDev::resetExclusiveMode()
+{
+    this->setExclusiveMode(false);
+}
+
 #include "moc_audiodev.cpp"
@@ -31,6 +31,13 @@ class AudioDev: public QObject
     Q_PROPERTY(QString error
                READ error
                NOTIFY errorChanged)
+    // Request exclusive access to the device, backends that don't support
+    // it just ignore the flag.
+    Q_PROPERTY(bool exclusiveMode
+               READ exclusiveMode
+               WRITE setExclusiveMode
+               RESET resetExclusiveMode
+               NOTIFY exclusiveModeChanged)
 
     public:
         explicit AudioDev(QObject *parent=nullptr);
@@ -38,6 +45,7 @@ class AudioDev: public QObject
 
         Q_INVOKABLE QVector<int> &commonSampleRates();
         Q_INVOKABLE virtual QString error() const;
+        Q_INVOKABLE virtual bool exclusiveMode() const;
         Q_INVOKABLE virtual QString defaultInput();
         Q_INVOKABLE virtual QString defaultOutput();
         Q_INVOKABLE virtual QStringList inputs();
@@ -57,10 +65,15 @@ class AudioDev: public QObject
 
     Q_SIGNALS:
         void errorChanged(const QString &error);
+        void exclusiveModeChanged(bool exclusiveMode);
         void defaultInputChanged(const QString &defaultInput);
         void defaultOutputChanged(const QString &defaultOutput);
         void inputsChanged(const QStringList &inputs);
         void outputsChanged(const QStringList &outputs);
+
+    public Q_SLOTS:
+        virtual void setExclusiveMode(bool exclusiveMode);
+        virtual void resetExclusiveMode();
 };
 
 #endif // AUDIODEV_H
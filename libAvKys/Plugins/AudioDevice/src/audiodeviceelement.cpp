@@ -26,6 +26,7 @@
 #include <akfrac.h>
 #include <akcaps.h>
 #include <akaudiopacket.h>
+#include <akthreadpriority.h>
 
 #include "audiodeviceelement.h"
 #include "audiodeviceglobals.h"
@@ -65,12 +66,18 @@ class AudioDeviceElementPrivate
         QMutex m_mutexLib;
         bool m_readFramesLoop;
         bool m_pause;
+        bool m_exclusiveMode;
+        int m_batchSize;
+        int m_maxBatchLatency;
 
         AudioDeviceElementPrivate(AudioDeviceElement *self):
             self(self),
             m_bufferSize(1024),
             m_readFramesLoop(false),
-            m_pause(false)
+            m_pause(false),
+            m_exclusiveMode(false),
+            m_batchSize(1),
+            m_maxBatchLatency(0)
         {
             this->m_convert = AkElement::create("ACapsConvert");
         }
@@ -251,6 +258,26 @@ QString AudioDeviceElement::audioLib() const
     return globalAudioDevice->audioLib();
 }
 
+bool AudioDeviceElement::exclusiveMode() const
+{
+    return this->d->m_exclusiveMode;
+}
+
+int AudioDeviceElement::batchSize() const
+{
+    return this->d->m_batchSize;
+}
+
+int AudioDeviceElement::maxBatchLatency() const
+{
+    return this->d->m_maxBatchLatency;
+}
+
+QList<AkCaps::CapsType> AudioDeviceElement::acceptedMediaTypes() const
+{
+    return {AkCaps::CapsAudio};
+}
+
 void AudioDeviceElementPrivate::readFramesLoop()
 {
     if (!this->m_audioDevice)
@@ -261,6 +288,10 @@ void AudioDeviceElementPrivate::readFramesLoop()
     CoInitializeEx(NULL, COINIT_MULTITHREADED);
 #endif
 
+    // Audio has the tightest deadline in the pipeline, a late read here
+    // is an audible glitch.
+    AkThreadPriority::apply(AkThreadPriority::ThreadClassRealtimeAudio);
+
     QString device = this->m_device;
     AkAudioCaps caps(this->m_caps);
     qint64 streamId = Ak::id();
@@ -282,8 +313,36 @@ void AudioDeviceElementPrivate::readFramesLoop()
 
             QByteArray oBuffer(buffer.size(), 0);
             memcpy(oBuffer.data(), buffer.constData(), size_t(buffer.size()));
+            int samples = bufferSize;
+
+            /* Coalesce additional periods into the same packet, so each
+             * trip through the element links carries more samples. The
+             * latency bound keeps the batch from growing past what the
+             * monitoring path can tolerate.
+             */
+            int batchSize = this->m_batchSize;
+            int maxBatchLatency = this->m_maxBatchLatency;
+
+            for (int period = 1;
+                 period < batchSize
+                 && this->m_readFramesLoop
+                 && !this->m_pause;
+                 period++) {
+                if (maxBatchLatency > 0
+                    && qint64(samples + bufferSize) * 1000
+                       > qint64(maxBatchLatency) * caps.rate())
+                    break;
+
+                buffer = this->m_audioDevice->read(bufferSize);
+
+                if (buffer.isEmpty())
+                    break;
+
+                oBuffer += buffer;
+                samples += bufferSize;
+            }
 
-            caps.samples() = bufferSize;
+            caps.samples() = samples;
             AkAudioPacket packet(caps, oBuffer);
 
             qint64 pts = qint64(QTime::currentTime().msecsSinceStartOfDay()
@@ -339,6 +398,45 @@ void AudioDeviceElement::setAudioLib(const QString &audioLib)
     globalAudioDevice->setAudioLib(audioLib);
 }
 
+void AudioDeviceElement::setExclusiveMode(bool exclusiveMode)
+{
+    if (this->d->m_exclusiveMode == exclusiveMode)
+        return;
+
+    this->d->m_exclusiveMode = exclusiveMode;
+
+    this->d->m_mutexLib.lock();
+
+    if (this->d->m_audioDevice)
+        this->d->m_audioDevice->setExclusiveMode(exclusiveMode);
+
+    this->d->m_mutexLib.unlock();
+
+    emit this->exclusiveModeChanged(exclusiveMode);
+}
+
+void AudioDeviceElement::setBatchSize(int batchSize)
+{
+    batchSize = qMax(batchSize, 1);
+
+    if (this->d->m_batchSize == batchSize)
+        return;
+
+    this->d->m_batchSize = batchSize;
+    emit this->batchSizeChanged(batchSize);
+}
+
+void AudioDeviceElement::setMaxBatchLatency(int maxBatchLatency)
+{
+    maxBatchLatency = qMax(maxBatchLatency, 0);
+
+    if (this->d->m_maxBatchLatency == maxBatchLatency)
+        return;
+
+    this->d->m_maxBatchLatency = maxBatchLatency;
+    emit this->maxBatchLatencyChanged(maxBatchLatency);
+}
+
 void AudioDeviceElement::resetDevice()
 {
     this->setDevice("");
@@ -363,6 +461,21 @@ void AudioDeviceElement::resetAudioLib()
     globalAudioDevice->resetAudioLib();
 }
 
+void AudioDeviceElement::resetExclusiveMode()
+{
+    this->setExclusiveMode(false);
+}
+
+void AudioDeviceElement::resetBatchSize()
+{
+    this->setBatchSize(1);
+}
+
+void AudioDeviceElement::resetMaxBatchLatency()
+{
+    this->setMaxBatchLatency(0);
+}
+
 AkPacket AudioDeviceElement::iStream(const AkAudioPacket &packet)
 {
     if (!this->d->m_audioDevice)
@@ -576,6 +689,7 @@ void AudioDeviceElement::audioLibUpdated(const QString &audioLib)
         return;
     }
 
+    this->d->m_audioDevice->setExclusiveMode(this->d->m_exclusiveMode);
     this->d->m_mutexLib.unlock();
 
     QObject::connect(this->d->m_audioDevice.data(),
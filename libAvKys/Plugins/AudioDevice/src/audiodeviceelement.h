@@ -62,6 +62,29 @@ class AudioDeviceElement: public AkElement
                WRITE setAudioLib
                RESET resetAudioLib
                NOTIFY audioLibChanged)
+    // Open the device in exclusive/low latency mode, if the backend
+    // supports it.
+    Q_PROPERTY(bool exclusiveMode
+               READ exclusiveMode
+               WRITE setExclusiveMode
+               RESET resetExclusiveMode
+               NOTIFY exclusiveModeChanged)
+    // Number of capture periods coalesced into one packet. With small
+    // buffer sizes the per-packet dispatch overhead dominates the actual
+    // sample processing, so batching trades latency for throughput. 1
+    // keeps the one packet per period behavior.
+    Q_PROPERTY(int batchSize
+               READ batchSize
+               WRITE setBatchSize
+               RESET resetBatchSize
+               NOTIFY batchSizeChanged)
+    // Upper bound, in milliseconds, on the audio a batched packet may
+    // accumulate. 0 leaves batchSize as the only limit.
+    Q_PROPERTY(int maxBatchLatency
+               READ maxBatchLatency
+               WRITE setMaxBatchLatency
+               RESET resetMaxBatchLatency
+               NOTIFY maxBatchLatencyChanged)
 
     public:
         explicit AudioDeviceElement();
@@ -80,6 +103,11 @@ class AudioDeviceElement: public AkElement
         Q_INVOKABLE QList<int> supportedChannels(const QString &device);
         Q_INVOKABLE QList<int> supportedSampleRates(const QString &device);
         Q_INVOKABLE QString audioLib() const;
+        Q_INVOKABLE bool exclusiveMode() const;
+        Q_INVOKABLE int batchSize() const;
+        Q_INVOKABLE int maxBatchLatency() const;
+
+        QList<AkCaps::CapsType> acceptedMediaTypes() const;
 
     private:
         AudioDeviceElementPrivate *d;
@@ -93,16 +121,25 @@ class AudioDeviceElement: public AkElement
         void bufferSizeChanged(int bufferSize);
         void capsChanged(const AkCaps &caps);
         void audioLibChanged(const QString &audioLib);
+        void exclusiveModeChanged(bool exclusiveMode);
+        void batchSizeChanged(int batchSize);
+        void maxBatchLatencyChanged(int maxBatchLatency);
 
     public slots:
         void setDevice(const QString &device);
         void setBufferSize(int bufferSize);
         void setCaps(const AkCaps &caps);
         void setAudioLib(const QString &audioLib);
+        void setExclusiveMode(bool exclusiveMode);
+        void setBatchSize(int batchSize);
+        void setMaxBatchLatency(int maxBatchLatency);
         void resetDevice();
         void resetBufferSize();
         void resetCaps();
         void resetAudioLib();
+        void resetExclusiveMode();
+        void resetBatchSize();
+        void resetMaxBatchLatency();
         AkPacket iStream(const AkAudioPacket &packet);
         bool setState(AkElement::ElementState state);
 
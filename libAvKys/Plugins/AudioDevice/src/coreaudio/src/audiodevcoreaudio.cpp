@@ -20,6 +20,7 @@
 #include <QMap>
 #include <QVector>
 #include <QWaitCondition>
+#include <atomic>
 #include <akaudiocaps.h>
 #include <akaudiopacket.h>
 #include <CoreAudio/CoreAudio.h>
@@ -30,6 +31,80 @@
 #define OUTPUT_DEVICE 0
 #define INPUT_DEVICE  1
 
+/* Single producer/single consumer byte ring for moving samples between the
+ * AudioUnit callback and the feeder threads.
+ *
+ * The callback runs under CoreAudio's realtime rules, so it must not take a
+ * lock or allocate. The ring is allocated once before the unit starts and
+ * the read/write positions are free running atomic counters, so each side
+ * only ever stores its own position and loads the other one.
+ */
+class AudioDevCoreAudioRing
+{
+    public:
+        explicit AudioDevCoreAudioRing(size_t size):
+            m_size(1),
+            m_readPos(0),
+            m_writePos(0)
+        {
+            // Power of two capacity, so the positions wrap with a mask.
+            while (this->m_size < size)
+                this->m_size <<= 1;
+
+            this->m_data = new char[this->m_size];
+        }
+
+        ~AudioDevCoreAudioRing()
+        {
+            delete [] this->m_data;
+        }
+
+        inline size_t readSpace() const
+        {
+            return this->m_writePos.load(std::memory_order_acquire)
+                 - this->m_readPos.load(std::memory_order_relaxed);
+        }
+
+        inline size_t writeSpace() const
+        {
+            return this->m_size
+                 - this->m_writePos.load(std::memory_order_relaxed)
+                 + this->m_readPos.load(std::memory_order_acquire);
+        }
+
+        inline size_t read(char *data, size_t size)
+        {
+            auto readPos = this->m_readPos.load(std::memory_order_relaxed);
+            size = qMin(size, this->readSpace());
+            auto offset = readPos & (this->m_size - 1);
+            auto firstChunk = qMin(size, this->m_size - offset);
+            memcpy(data, this->m_data + offset, firstChunk);
+            memcpy(data + firstChunk, this->m_data, size - firstChunk);
+            this->m_readPos.store(readPos + size, std::memory_order_release);
+
+            return size;
+        }
+
+        inline size_t write(const char *data, size_t size)
+        {
+            auto writePos = this->m_writePos.load(std::memory_order_relaxed);
+            size = qMin(size, this->writeSpace());
+            auto offset = writePos & (this->m_size - 1);
+            auto firstChunk = qMin(size, this->m_size - offset);
+            memcpy(this->m_data + offset, data, firstChunk);
+            memcpy(this->m_data, data + firstChunk, size - firstChunk);
+            this->m_writePos.store(writePos + size, std::memory_order_release);
+
+            return size;
+        }
+
+    private:
+        char *m_data;
+        size_t m_size;
+        std::atomic<size_t> m_readPos;
+        std::atomic<size_t> m_writePos;
+};
+
 class AudioDevCoreAudioPrivate
 {
     public:
@@ -47,11 +122,10 @@ class AudioDevCoreAudioPrivate
         AudioUnit m_audioUnit;
         UInt32 m_bufferSize;
         AudioBufferList *m_bufferList;
-        QByteArray m_buffer;
+        AudioDevCoreAudioRing *m_ring;
         QMutex m_mutex;
         QWaitCondition m_canWrite;
         QWaitCondition m_samplesAvailable;
-        int m_maxBufferSize;
         AkAudioCaps m_curCaps;
         bool m_isInput;
 
@@ -60,7 +134,7 @@ class AudioDevCoreAudioPrivate
             m_audioUnit(nullptr),
             m_bufferSize(0),
             m_bufferList(nullptr),
-            m_maxBufferSize(0),
+            m_ring(nullptr),
             m_isInput(false)
         {
 
@@ -418,32 +492,17 @@ bool AudioDevCoreAudio::init(const QString &device, const AkAudioCaps &caps)
         return false;
     }
 
-    status = AudioUnitInitialize(this->d->m_audioUnit);
-
-    if (status != noErr) {
-        this->d->m_error = QString("Can't initialize device: %1")
-                           .arg(this->d->statusToStr(status));
-        emit this->errorChanged(this->d->m_error);
-
-        return false;
-    }
-
-    status = AudioOutputUnitStart(this->d->m_audioUnit);
-
-    if (status != noErr) {
-        this->d->m_error = QString("Can't start device: %1")
-                           .arg(this->d->statusToStr(status));
-        emit this->errorChanged(this->d->m_error);
-
-        return false;
-    }
-
+    /* Everything the callback touches is allocated before the unit starts,
+     * once started the callback is limited to moving bytes through the ring.
+     */
     this->d->m_curCaps = caps;
     this->d->m_isInput = input;
-    this->d->m_maxBufferSize = 2
-                             * caps.bps()
-                             * caps.channels()
-                             * int(bufferSize) / 8;
+
+    size_t cycleSize = size_t(caps.bps())
+                     * size_t(caps.channels())
+                     * size_t(bufferSize) / 8;
+    size_t ringSize = qMax(4 * cycleSize, size_t(65536));
+    this->d->m_ring = new AudioDevCoreAudioRing(ringSize);
 
     UInt32 nBuffers = streamDescription.mFormatFlags
                     & kAudioFormatFlagIsNonInterleaved?
@@ -465,26 +524,50 @@ bool AudioDevCoreAudio::init(const QString &device, const AkAudioCaps &caps)
         this->d->m_bufferList->mBuffers[i].mData = 0;
     }
 
+    status = AudioUnitInitialize(this->d->m_audioUnit);
+
+    if (status != noErr) {
+        this->d->m_error = QString("Can't initialize device: %1")
+                           .arg(this->d->statusToStr(status));
+        emit this->errorChanged(this->d->m_error);
+        this->uninit();
+
+        return false;
+    }
+
+    status = AudioOutputUnitStart(this->d->m_audioUnit);
+
+    if (status != noErr) {
+        this->d->m_error = QString("Can't start device: %1")
+                           .arg(this->d->statusToStr(status));
+        emit this->errorChanged(this->d->m_error);
+        this->uninit();
+
+        return false;
+    }
+
     return true;
 }
 
 QByteArray AudioDevCoreAudio::read(int samples)
 {
-    int bufferSize = this->d->m_curCaps.bps()
-                   * this->d->m_curCaps.channels()
-                   * samples / 8;
-    QByteArray audioData;
+    size_t bufferSize = size_t(this->d->m_curCaps.bps()
+                               * this->d->m_curCaps.channels()
+                               * samples / 8);
+    QByteArray audioData(int(bufferSize), 0);
+    size_t readBytes = 0;
 
     this->d->m_mutex.lock();
 
-    while (audioData.size() < bufferSize) {
-        if (this->d->m_buffer.isEmpty())
+    while (readBytes < bufferSize) {
+        if (this->d->m_ring->readSpace() < 1) {
             this->d->m_samplesAvailable.wait(&this->d->m_mutex);
 
-        int copyBytes = qMin(this->d->m_buffer.size(),
-                             bufferSize - audioData.size());
-        audioData += this->d->m_buffer.mid(0, copyBytes);
-        this->d->m_buffer.remove(0, copyBytes);
+            continue;
+        }
+
+        readBytes += this->d->m_ring->read(audioData.data() + readBytes,
+                                           bufferSize - readBytes);
     }
 
     this->d->m_mutex.unlock();
@@ -494,12 +577,23 @@ QByteArray AudioDevCoreAudio::read(int samples)
 
 bool AudioDevCoreAudio::write(const AkAudioPacket &packet)
 {
+    auto buffer = packet.buffer();
+    size_t writtenBytes = 0;
+
     this->d->m_mutex.lock();
 
-    if (this->d->m_buffer.size() >= this->d->m_maxBufferSize)
-        this->d->m_canWrite.wait(&this->d->m_mutex);
+    while (writtenBytes < size_t(buffer.size())) {
+        if (this->d->m_ring->writeSpace() < 1) {
+            this->d->m_canWrite.wait(&this->d->m_mutex);
+
+            continue;
+        }
+
+        writtenBytes +=
+                this->d->m_ring->write(buffer.constData() + writtenBytes,
+                                       size_t(buffer.size()) - writtenBytes);
+    }
 
-    this->d->m_buffer += packet.buffer();
     this->d->m_mutex.unlock();
 
     return true;
@@ -507,11 +601,6 @@ bool AudioDevCoreAudio::write(const AkAudioPacket &packet)
 
 bool AudioDevCoreAudio::uninit()
 {
-    if (this->d->m_bufferList) {
-        free(this->d->m_bufferList);
-        this->d->m_bufferList = nullptr;
-    }
-
     if (this->d->m_audioUnit) {
         AudioOutputUnitStop(this->d->m_audioUnit);
         AudioUnitUninitialize(this->d->m_audioUnit);
@@ -519,10 +608,20 @@ bool AudioDevCoreAudio::uninit()
         this->d->m_audioUnit = nullptr;
     }
 
+    // The callback is gone at this point, so the buffers can be released.
+    if (this->d->m_bufferList) {
+        free(this->d->m_bufferList);
+        this->d->m_bufferList = nullptr;
+    }
+
+    if (this->d->m_ring) {
+        delete this->d->m_ring;
+        this->d->m_ring = nullptr;
+    }
+
     this->d->m_bufferSize = 0;
     this->d->m_curCaps = AkAudioCaps();
     this->d->m_isInput = false;
-    this->d->m_buffer.clear();
 
     return true;
 }
@@ -896,9 +995,14 @@ OSStatus AudioDevCoreAudioPrivate::audioCallback(void *audioDev,
 {
     auto self = static_cast<AudioDevCoreAudio *>(audioDev);
 
-    if (!self)
+    if (!self || !self->d->m_ring)
         return noErr;
 
+    /* This callback runs in CoreAudio's realtime thread, so it must not
+     * lock, allocate or touch anything but the preallocated ring. Wakeups
+     * use tryLock(): if a feeder thread holds the mutex the wakeup is
+     * skipped and it recovers on the next cycle.
+     */
     if (self->d->m_isInput) {
         self->d->clearBuffer();
 
@@ -913,51 +1017,31 @@ OSStatus AudioDevCoreAudioPrivate::audioCallback(void *audioDev,
         if (status != noErr)
             return status;
 
-        self->d->m_mutex.lock();
-
-        // FIXME: This assumees that all samples are interleaved, so appending it to
-        // the buffer is ok. It must be fixed for planar sample formats.
+        /* The ring is strictly single producer/single consumer, so on
+         * overrun the callback drops the incoming samples instead of
+         * touching the read position owned by the reader thread.
+         */
         for (UInt32 i = 0; i < self->d->m_bufferList->mNumberBuffers; i++)
-            self->d->m_buffer +=
-                QByteArray::fromRawData(static_cast<const char *>(self->d->m_bufferList->mBuffers[i].mData),
-                                        int(self->d->m_bufferList->mBuffers[i].mDataByteSize));
-
-        // We use a ring buffer and all old samples are discarded.
-        if (self->d->m_buffer.size() > self->d->m_maxBufferSize) {
-            int k = self->d->m_curCaps.bps()
-                    * self->d->m_curCaps.channels();
-            int bufferSize = k * int(self->d->m_maxBufferSize / k);
-
-            self->d->m_buffer =
-                self->d->m_buffer.mid(self->d->m_buffer.size() - bufferSize,
-                                      bufferSize);
-        }
+            self->d->m_ring->write(static_cast<const char *>(self->d->m_bufferList->mBuffers[i].mData),
+                                   self->d->m_bufferList->mBuffers[i].mDataByteSize);
 
-        self->d->m_samplesAvailable.wakeAll();
-        self->d->m_mutex.unlock();
+        if (self->d->m_mutex.tryLock()) {
+            self->d->m_samplesAvailable.wakeAll();
+            self->d->m_mutex.unlock();
+        }
     } else {
-        // FIXME: Same as above.
-        if (data->mNumberBuffers == 1) {
-            int i = 0; // Write just the first buffer.
-
-            memset(data->mBuffers[i].mData,
-                   0,
-                   data->mBuffers[i].mDataByteSize);
-
-            self->d->m_mutex.lock();
-            int copyBytes = qMin(int(data->mBuffers[i].mDataByteSize),
-                                  self->d->m_buffer.size());
-
-            if (copyBytes > 0) {
-                memcpy(data->mBuffers[i].mData,
-                       self->d->m_buffer.constData(),
-                       size_t(copyBytes));
-                self->d->m_buffer.remove(0, copyBytes);
-            }
-
-            if (self->d->m_buffer.size() <= self->d->m_maxBufferSize)
-                self->d->m_canWrite.wakeAll();
+        for (UInt32 i = 0; i < data->mNumberBuffers; i++) {
+            auto buffer = static_cast<char *>(data->mBuffers[i].mData);
+            auto bufferSize = size_t(data->mBuffers[i].mDataByteSize);
+            auto readBytes = self->d->m_ring->read(buffer, bufferSize);
+
+            // Pad with silence on underrun.
+            if (readBytes < bufferSize)
+                memset(buffer + readBytes, 0, bufferSize - readBytes);
+        }
 
+        if (self->d->m_mutex.tryLock()) {
+            self->d->m_canWrite.wakeAll();
             self->d->m_mutex.unlock();
         }
     }
@@ -22,9 +22,11 @@
 #include <QVector>
 #include <QMutex>
 #include <QWaitCondition>
+#include <limits>
 #include <ak.h>
 #include <akaudiopacket.h>
 #include <jack/jack.h>
+#include <jack/ringbuffer.h>
 
 #include "audiodevjack.h"
 #include "jackserver.h"
@@ -65,9 +67,13 @@ class AudioDevJackPrivate
         QString m_curDevice;
         int m_sampleRate;
         int m_curChannels;
-        int m_maxBufferSize;
         bool m_isInput;
-        QByteArray m_buffer;
+
+        /* One preallocated lock-free ring per channel. The process callback
+         * only moves samples between the port buffers and these rings, so
+         * the planar float format travels unconverted and the RT thread
+         * never locks nor allocates. */
+        QVector<jack_ringbuffer_t *> m_ringBuffers;
         jack_client_t *m_client;
         QMutex m_mutex;
         QWaitCondition m_canWrite;
@@ -76,12 +82,31 @@ class AudioDevJackPrivate
         AudioDevJackPrivate():
             m_sampleRate(0),
             m_curChannels(0),
-            m_maxBufferSize(0),
             m_isInput(false),
             m_client(nullptr)
         {
         }
 
+        inline size_t minReadSpace() const
+        {
+            size_t space = std::numeric_limits<size_t>::max();
+
+            for (auto ring: this->m_ringBuffers)
+                space = qMin(space, jack_ringbuffer_read_space(ring));
+
+            return space;
+        }
+
+        inline size_t minWriteSpace() const
+        {
+            size_t space = std::numeric_limits<size_t>::max();
+
+            for (auto ring: this->m_ringBuffers)
+                space = qMin(space, jack_ringbuffer_write_space(ring));
+
+            return space;
+        }
+
         static int onProcessCallback(jack_nframes_t nframes, void *userData);
         static void onShutdownCallback(void *userData);
 };
@@ -144,9 +169,11 @@ AudioDevJack::AudioDevJack(QObject *parent):
         if (ports)
             jack_free(ports);
 
+        // Planar float, JACK's native layout, so nothing is converted on
+        // the way in or out when the pipeline negotiates it.
         if (channels > 0)
             this->d->m_caps[deviceId] =
-                    AkAudioCaps(AkAudioCaps::SampleFormat_flt,
+                    AkAudioCaps(AkAudioCaps::SampleFormat_fltp,
                                 channels,
                                 this->d->m_sampleRate);
     }
@@ -206,7 +233,7 @@ QList<AkAudioCaps::SampleFormat> AudioDevJack::supportedFormats(const QString &d
 {
     Q_UNUSED(device)
 
-    return QList<AkAudioCaps::SampleFormat> {AkAudioCaps::SampleFormat_flt};
+    return QList<AkAudioCaps::SampleFormat> {AkAudioCaps::SampleFormat_fltp};
 }
 
 QList<int> AudioDevJack::supportedChannels(const QString &device)
@@ -232,12 +259,11 @@ bool AudioDevJack::init(const QString &device, const AkAudioCaps &caps)
         || caps.channels() < 1
         || caps.channels() > 2
         || caps.rate() != this->d->m_sampleRate
-        || caps.format() != AkAudioCaps::SampleFormat_flt)
+        || caps.format() != AkAudioCaps::SampleFormat_fltp)
         return false;
 
     this->d->m_appPorts.clear();
     this->d->m_curChannels = 0;
-    this->d->m_buffer.clear();
 
     QString portName = device == ":jackinput:"?
                            "input": "output";
@@ -268,6 +294,28 @@ bool AudioDevJack::init(const QString &device, const AkAudioCaps &caps)
 
     auto bufferSize = jack_get_buffer_size(this->d->m_client);
 
+    /* Preallocate and lock the rings before the client is activated, the
+     * process callback never allocates. Four periods of headroom per
+     * channel, with a floor for very small period sizes. */
+    auto ringSize = qMax(4 * size_t(bufferSize)
+                         * sizeof(jack_default_audio_sample_t),
+                         size_t(65536));
+
+    for (int channel = 0; channel < caps.channels(); channel++) {
+        auto ring = jack_ringbuffer_create(ringSize);
+
+        if (!ring) {
+            this->d->m_error = "AudioDevJack::init: Can't allocate ring buffer";
+            Q_EMIT this->errorChanged(this->d->m_error);
+            this->uninit();
+
+            return false;
+        }
+
+        jack_ringbuffer_mlock(ring);
+        this->d->m_ringBuffers << ring;
+    }
+
     // Activate JACK client
 
     if (auto error = jack_status_t(jack_activate(this->d->m_client))) {
@@ -308,10 +356,6 @@ bool AudioDevJack::init(const QString &device, const AkAudioCaps &caps)
 
     this->d->m_curDevice = device;
     this->d->m_curChannels = caps.channels();
-    this->d->m_maxBufferSize = int(2
-                             * sizeof(jack_default_audio_sample_t)
-                             * uint(caps.channels())
-                             * bufferSize);
     this->d->m_isInput = device == ":jackinput:";
 
     return true;
@@ -319,23 +363,34 @@ bool AudioDevJack::init(const QString &device, const AkAudioCaps &caps)
 
 QByteArray AudioDevJack::read(int samples)
 {
-    int bufferSize = 2
-                     * int(sizeof(jack_default_audio_sample_t))
-                     * this->d->m_curChannels
-                     * samples;
-
-    QByteArray audioData;
+    int planeSize = samples * int(sizeof(jack_default_audio_sample_t));
+    QByteArray audioData(planeSize * this->d->m_curChannels, 0);
+    int readBytes = 0;
 
     this->d->m_mutex.lock();
 
-    while (audioData.size() < bufferSize) {
-        if (this->d->m_buffer.size() < 1)
+    // Planar layout, one contiguous plane per channel, drained from the
+    // per channel rings in lockstep.
+    while (readBytes < planeSize) {
+        auto available = this->d->minReadSpace();
+
+        if (available < 1) {
             this->d->m_samplesAvailable.wait(&this->d->m_mutex);
 
-        int copyBytes = qMin(this->d->m_buffer.size(),
-                             bufferSize - audioData.size());
-        audioData += this->d->m_buffer.mid(0, copyBytes);
-        this->d->m_buffer.remove(0, copyBytes);
+            continue;
+        }
+
+        auto chunk = size_t(qMin(qint64(available),
+                                 qint64(planeSize - readBytes)));
+
+        for (int channel = 0; channel < this->d->m_curChannels; channel++)
+            jack_ringbuffer_read(this->d->m_ringBuffers[channel],
+                                 audioData.data()
+                                 + channel * planeSize
+                                 + readBytes,
+                                 chunk);
+
+        readBytes += int(chunk);
     }
 
     this->d->m_mutex.unlock();
@@ -345,12 +400,33 @@ QByteArray AudioDevJack::read(int samples)
 
 bool AudioDevJack::write(const AkAudioPacket &packet)
 {
+    int planeSize = packet.buffer().size() / this->d->m_curChannels;
+    int writtenBytes = 0;
+
     this->d->m_mutex.lock();
 
-    if (this->d->m_buffer.size() >= this->d->m_maxBufferSize)
-        this->d->m_canWrite.wait(&this->d->m_mutex);
+    while (writtenBytes < planeSize) {
+        auto space = this->d->minWriteSpace();
+
+        if (space < 1) {
+            this->d->m_canWrite.wait(&this->d->m_mutex);
+
+            continue;
+        }
+
+        auto chunk = size_t(qMin(qint64(space),
+                                 qint64(planeSize - writtenBytes)));
+
+        for (int channel = 0; channel < this->d->m_curChannels; channel++)
+            jack_ringbuffer_write(this->d->m_ringBuffers[channel],
+                                  packet.buffer().constData()
+                                  + channel * planeSize
+                                  + writtenBytes,
+                                  chunk);
+
+        writtenBytes += int(chunk);
+    }
 
-    this->d->m_buffer += packet.buffer();
     this->d->m_mutex.unlock();
 
     return true;
@@ -365,7 +441,12 @@ bool AudioDevJack::uninit()
 
     this->d->m_appPorts.clear();
     this->d->m_curChannels = 0;
-    this->d->m_buffer.clear();
+
+    // Safe once the client is deactivated, the process callback is gone.
+    for (auto ring: this->d->m_ringBuffers)
+        jack_ringbuffer_free(ring);
+
+    this->d->m_ringBuffers.clear();
 
     return true;
 }
@@ -374,67 +455,59 @@ int AudioDevJackPrivate::onProcessCallback(jack_nframes_t nframes,
                                            void *userData)
 {
     auto self = reinterpret_cast<AudioDevJack *>(userData);
+    auto bytes = size_t(nframes) * sizeof(jack_default_audio_sample_t);
 
+    /* RT thread: only port buffer <-> ring moves, the rings are lock-free
+     * and the planar layout needs no interleaving. The waiting side is
+     * woken with a try-lock so this thread never blocks on the mutex; a
+     * missed wakeup is recovered on the next cycle. */
     if (self->d->m_isInput) {
-        self->d->m_mutex.lock();
-        QVector<const jack_default_audio_sample_t *> ports;
-
-        for (auto port: self->d->m_appPorts)
-            ports << reinterpret_cast<const jack_default_audio_sample_t *>(jack_port_get_buffer(port,
-                                                                                                nframes));
-
-        int samples = int(nframes) * self->d->m_curChannels;
-        auto oldLen = self->d->m_buffer.size();
-        self->d->m_buffer.resize(oldLen
-                                 + samples
-                                 * int(sizeof(jack_default_audio_sample_t)));
-        auto buffer = reinterpret_cast<jack_default_audio_sample_t *>(self->d->m_buffer.data())
-                      + oldLen;
-
-        // Copy samples
-        for (int i = 0; i < samples; i++)
-            buffer[i] = ports[i % self->d->m_curChannels][i / self->d->m_curChannels];
-
-        // We use a ring buffer and all old samples are discarded.
-        if (self->d->m_buffer.size() > self->d->m_maxBufferSize) {
-            int k = int(sizeof(jack_default_audio_sample_t))
-                    * self->d->m_curChannels;
-            int bufferSize = k * int(self->d->m_maxBufferSize / k);
-
-            self->d->m_buffer =
-                    self->d->m_buffer.mid(self->d->m_buffer.size() - bufferSize,
-                                          bufferSize);
+        for (int channel = 0;
+             channel < self->d->m_ringBuffers.size();
+             channel++) {
+            auto port = jack_port_get_buffer(self->d->m_appPorts[channel],
+                                             nframes);
+            auto ring = self->d->m_ringBuffers[channel];
+            auto space = jack_ringbuffer_write_space(ring);
+
+            // The consumer lags, drop the oldest samples.
+            if (space < bytes)
+                jack_ringbuffer_read_advance(ring, bytes - space);
+
+            jack_ringbuffer_write(ring,
+                                  reinterpret_cast<const char *>(port),
+                                  bytes);
         }
 
-        self->d->m_samplesAvailable.wakeAll();
-        self->d->m_mutex.unlock();
+        if (self->d->m_mutex.tryLock()) {
+            self->d->m_samplesAvailable.wakeAll();
+            self->d->m_mutex.unlock();
+        }
     } else {
-        self->d->m_mutex.lock();
-        QVector<jack_default_audio_sample_t *> ports;
-
-        for (auto port: self->d->m_appPorts) {
-            ports << reinterpret_cast<jack_default_audio_sample_t *>(jack_port_get_buffer(port,
-                                                                                          nframes));
-            std::fill_n(ports.last(), nframes, 0.);
+        for (int channel = 0;
+             channel < self->d->m_ringBuffers.size();
+             channel++) {
+            auto port =
+                    reinterpret_cast<jack_default_audio_sample_t *>(jack_port_get_buffer(self->d->m_appPorts[channel],
+                                                                                         nframes));
+            auto readBytes =
+                    jack_ringbuffer_read(self->d->m_ringBuffers[channel],
+                                         reinterpret_cast<char *>(port),
+                                         bytes);
+
+            // Underrun, pad with silence.
+            if (readBytes < bytes)
+                std::fill_n(port
+                            + readBytes / sizeof(jack_default_audio_sample_t),
+                            (bytes - readBytes)
+                            / sizeof(jack_default_audio_sample_t),
+                            0.f);
         }
 
-        auto buffer = reinterpret_cast<const jack_default_audio_sample_t *>(self->d->m_buffer.constData());
-        int samples = qMin(self->d->m_buffer.size() / int(sizeof(jack_default_audio_sample_t)),
-                           int(nframes) * self->d->m_curChannels);
-
-        // Copy samples
-        for (int i = 0; i < samples; i++)
-            ports[i % self->d->m_curChannels][i / self->d->m_curChannels] = buffer[i];
-
-        if (samples > 0)
-            self->d->m_buffer.remove(0,
-                                     samples
-                                     * int(sizeof(jack_default_audio_sample_t)));
-
-        if (self->d->m_buffer.size() <= self->d->m_maxBufferSize)
+        if (self->d->m_mutex.tryLock()) {
             self->d->m_canWrite.wakeAll();
-
-        self->d->m_mutex.unlock();
+            self->d->m_mutex.unlock();
+        }
     }
 
     return 0;
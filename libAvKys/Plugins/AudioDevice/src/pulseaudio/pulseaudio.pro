@@ -42,7 +42,7 @@ LIBS += -L$${PWD}/../../../../Lib/ -l$${COMMONS_TARGET}
 OTHER_FILES += pspec.json
 
 CONFIG += link_pkgconfig
-PKGCONFIG += libpulse-simple
+PKGCONFIG += libpulse
 
 QT += qml
 
@@ -22,7 +22,7 @@
 #include <QVector>
 #include <QMutex>
 #include <akaudiopacket.h>
-#include <pulse/simple.h>
+#include <pulse/stream.h>
 #include <pulse/context.h>
 #include <pulse/introspect.h>
 #include <pulse/subscribe.h>
@@ -52,7 +52,7 @@ class AudioDevPulseAudioPrivate
     public:
         AudioDevPulseAudio *self;
         QString m_error;
-        pa_simple *m_paSimple;
+        pa_stream *m_stream;
         pa_threaded_mainloop *m_mainLoop;
         pa_context *m_context;
         QString m_defaultSink;
@@ -65,13 +65,19 @@ class AudioDevPulseAudioPrivate
         int m_curBps;
         int m_curChannels;
 
+        /* Bytes of the currently peeked capture fragment already consumed.
+         * pa_stream_drop() only drops whole fragments, so a fragment larger
+         * than a read request survives across calls. */
+        size_t m_fragmentOffset;
+
         AudioDevPulseAudioPrivate(AudioDevPulseAudio *self):
             self(self),
-            m_paSimple(nullptr),
+            m_stream(nullptr),
             m_mainLoop(nullptr),
             m_context(nullptr),
             m_curBps(0),
-            m_curChannels(0)
+            m_curChannels(0),
+            m_fragmentOffset(0)
         {
         }
 
@@ -92,6 +98,14 @@ class AudioDevPulseAudioPrivate
                                      const pa_sink_info *info,
                                      int isLast,
                                      void *userdata);
+        static void streamNotifyCallback(pa_stream *stream,
+                                         void *userdata);
+        static void streamRequestCallback(pa_stream *stream,
+                                          size_t nbytes,
+                                          void *userdata);
+        static void streamSuccessCallback(pa_stream *stream,
+                                          int success,
+                                          void *userdata);
 };
 
 AudioDevPulseAudio::AudioDevPulseAudio(QObject *parent):
@@ -336,7 +350,8 @@ QList<int> AudioDevPulseAudio::supportedSampleRates(const QString &device)
 
 bool AudioDevPulseAudio::init(const QString &device, const AkAudioCaps &caps)
 {
-    int error;
+    if (!this->d->m_context || !this->d->m_mainLoop)
+        return false;
 
     pa_sample_spec ss;
     ss.format = sampleFormats->value(caps.format());
@@ -344,97 +359,250 @@ bool AudioDevPulseAudio::init(const QString &device, const AkAudioCaps &caps)
     ss.rate = uint32_t(caps.rate());
     this->d->m_curBps = AkAudioCaps::bitsPerSample(caps.format()) / 8;
     this->d->m_curChannels = caps.channels();
+    this->d->m_fragmentOffset = 0;
 
     this->d->m_mutex.lock();
     bool isInput = this->d->m_sources.values().contains(device);
     this->d->m_mutex.unlock();
 
-    this->d->m_paSimple =
-            pa_simple_new(nullptr,
+    pa_threaded_mainloop_lock(this->d->m_mainLoop);
+    this->d->m_stream =
+            pa_stream_new(this->d->m_context,
                           QCoreApplication::applicationName().toStdString().c_str(),
-                          isInput? PA_STREAM_RECORD: PA_STREAM_PLAYBACK,
-                          device.toStdString().c_str(),
-                          QCoreApplication::organizationName().toStdString().c_str(),
                           &ss,
-                          nullptr,
-                          nullptr,
-                          &error);
+                          nullptr);
+
+    if (!this->d->m_stream) {
+        this->d->m_error =
+                QString(pa_strerror(pa_context_errno(this->d->m_context)));
+        pa_threaded_mainloop_unlock(this->d->m_mainLoop);
+        emit this->errorChanged(this->d->m_error);
+
+        return false;
+    }
+
+    pa_stream_set_state_callback(this->d->m_stream,
+                                 AudioDevPulseAudioPrivate::streamNotifyCallback,
+                                 this);
+    int result;
+
+    if (isInput) {
+        pa_stream_set_read_callback(this->d->m_stream,
+                                    AudioDevPulseAudioPrivate::streamRequestCallback,
+                                    this);
+        result = pa_stream_connect_record(this->d->m_stream,
+                                          device.toStdString().c_str(),
+                                          nullptr,
+                                          PA_STREAM_NOFLAGS);
+    } else {
+        pa_stream_set_write_callback(this->d->m_stream,
+                                     AudioDevPulseAudioPrivate::streamRequestCallback,
+                                     this);
+        result = pa_stream_connect_playback(this->d->m_stream,
+                                            device.toStdString().c_str(),
+                                            nullptr,
+                                            PA_STREAM_NOFLAGS,
+                                            nullptr,
+                                            nullptr);
+    }
 
-    if (!this->d->m_paSimple) {
-        this->d->m_error = QString(pa_strerror(error));
+    if (result < 0) {
+        this->d->m_error =
+                QString(pa_strerror(pa_context_errno(this->d->m_context)));
+        pa_stream_unref(this->d->m_stream);
+        this->d->m_stream = nullptr;
+        pa_threaded_mainloop_unlock(this->d->m_mainLoop);
         emit this->errorChanged(this->d->m_error);
 
         return false;
     }
 
+    // Wait until the stream is ready.
+    forever {
+        auto state = pa_stream_get_state(this->d->m_stream);
+
+        if (state == PA_STREAM_READY)
+            break;
+
+        if (state == PA_STREAM_FAILED
+            || state == PA_STREAM_TERMINATED) {
+            this->d->m_error =
+                    QString(pa_strerror(pa_context_errno(this->d->m_context)));
+            pa_stream_unref(this->d->m_stream);
+            this->d->m_stream = nullptr;
+            pa_threaded_mainloop_unlock(this->d->m_mainLoop);
+            emit this->errorChanged(this->d->m_error);
+
+            return false;
+        }
+
+        pa_threaded_mainloop_wait(this->d->m_mainLoop);
+    }
+
+    pa_threaded_mainloop_unlock(this->d->m_mainLoop);
+
     return true;
 }
 
 QByteArray AudioDevPulseAudio::read(int samples)
 {
-    if (!this->d->m_paSimple)
+    if (!this->d->m_stream)
         return QByteArray();
 
-    int error;
-
     QByteArray buffer(samples
                       * this->d->m_curBps
                       * this->d->m_curChannels,
                       0);
+    size_t readBytes = 0;
 
-    if (pa_simple_read(this->d->m_paSimple,
-                       buffer.data(),
-                       size_t(buffer.size()),
-                       &error) < 0) {
-        this->d->m_error = QString(pa_strerror(error));
-        emit this->errorChanged(this->d->m_error);
+    pa_threaded_mainloop_lock(this->d->m_mainLoop);
 
-        return QByteArray();
+    /* Consume the server-shared fragments in place: peek, copy the slice
+     * straight into the destination buffer and drop the fragment only once
+     * it's fully consumed. No staging buffer in between. */
+    while (readBytes < size_t(buffer.size())) {
+        const void *fragment = nullptr;
+        size_t fragmentSize = 0;
+
+        if (pa_stream_peek(this->d->m_stream,
+                           &fragment,
+                           &fragmentSize) < 0) {
+            this->d->m_error =
+                    QString(pa_strerror(pa_context_errno(this->d->m_context)));
+            pa_threaded_mainloop_unlock(this->d->m_mainLoop);
+            emit this->errorChanged(this->d->m_error);
+
+            return QByteArray();
+        }
+
+        if (fragmentSize < 1) {
+            pa_threaded_mainloop_wait(this->d->m_mainLoop);
+
+            continue;
+        }
+
+        auto left = fragmentSize - this->d->m_fragmentOffset;
+        auto chunk = qMin(left, size_t(buffer.size()) - readBytes);
+
+        // A null fragment with a size is a hole, it reads as silence.
+        if (fragment)
+            memcpy(buffer.data() + readBytes,
+                   reinterpret_cast<const char *>(fragment)
+                   + this->d->m_fragmentOffset,
+                   chunk);
+        else
+            memset(buffer.data() + readBytes, 0, chunk);
+
+        readBytes += chunk;
+        this->d->m_fragmentOffset += chunk;
+
+        if (this->d->m_fragmentOffset >= fragmentSize) {
+            pa_stream_drop(this->d->m_stream);
+            this->d->m_fragmentOffset = 0;
+        }
     }
 
+    pa_threaded_mainloop_unlock(this->d->m_mainLoop);
+
     return buffer;
 }
 
 bool AudioDevPulseAudio::write(const AkAudioPacket &packet)
 {
-    if (!this->d->m_paSimple)
+    if (!this->d->m_stream)
         return false;
 
-    int error;
+    auto data = packet.buffer().constData();
+    size_t left = size_t(packet.buffer().size());
 
-    if (pa_simple_write(this->d->m_paSimple,
-                        packet.buffer().constData(),
-                        size_t(packet.buffer().size()),
-                        &error) < 0) {
-        this->d->m_error = QString(pa_strerror(error));
-        emit this->errorChanged(this->d->m_error);
+    pa_threaded_mainloop_lock(this->d->m_mainLoop);
 
-        return false;
+    /* Render into the server-shared buffer handed out by
+     * pa_stream_begin_write() instead of going through a staging buffer,
+     * the server reads the samples from the same memory. */
+    while (left > 0) {
+        auto writableBytes = pa_stream_writable_size(this->d->m_stream);
+
+        if (writableBytes == size_t(-1)) {
+            this->d->m_error =
+                    QString(pa_strerror(pa_context_errno(this->d->m_context)));
+            pa_threaded_mainloop_unlock(this->d->m_mainLoop);
+            emit this->errorChanged(this->d->m_error);
+
+            return false;
+        }
+
+        if (writableBytes < 1) {
+            pa_threaded_mainloop_wait(this->d->m_mainLoop);
+
+            continue;
+        }
+
+        void *buffer = nullptr;
+        size_t bufferSize = qMin(left, writableBytes);
+
+        if (pa_stream_begin_write(this->d->m_stream,
+                                  &buffer,
+                                  &bufferSize) < 0
+            || !buffer) {
+            this->d->m_error =
+                    QString(pa_strerror(pa_context_errno(this->d->m_context)));
+            pa_threaded_mainloop_unlock(this->d->m_mainLoop);
+            emit this->errorChanged(this->d->m_error);
+
+            return false;
+        }
+
+        auto chunk = qMin(left, bufferSize);
+        memcpy(buffer, data, chunk);
+        pa_stream_write(this->d->m_stream,
+                        buffer,
+                        chunk,
+                        nullptr,
+                        0,
+                        PA_SEEK_RELATIVE);
+        data += chunk;
+        left -= chunk;
     }
 
+    pa_threaded_mainloop_unlock(this->d->m_mainLoop);
+
     return true;
 }
 
 bool AudioDevPulseAudio::uninit()
 {
+    if (!this->d->m_stream)
+        return false;
+
     bool ok = true;
+    pa_threaded_mainloop_lock(this->d->m_mainLoop);
 
-    if (this->d->m_paSimple) {
-        int error;
+    // Let the playback buffer play out before tearing the stream down.
+    if (pa_stream_get_state(this->d->m_stream) == PA_STREAM_READY) {
+        auto operation =
+                pa_stream_drain(this->d->m_stream,
+                                AudioDevPulseAudioPrivate::streamSuccessCallback,
+                                this);
 
-        if (pa_simple_drain(this->d->m_paSimple, &error) < 0) {
-            this->d->m_error = QString(pa_strerror(error));
-            emit this->errorChanged(this->d->m_error);
+        if (operation) {
+            while (pa_operation_get_state(operation) == PA_OPERATION_RUNNING)
+                pa_threaded_mainloop_wait(this->d->m_mainLoop);
+
+            pa_operation_unref(operation);
+        } else {
             ok = false;
         }
+    }
 
-        pa_simple_free(this->d->m_paSimple);
-    } else
-        ok = false;
+    pa_stream_disconnect(this->d->m_stream);
+    pa_stream_unref(this->d->m_stream);
+    this->d->m_stream = nullptr;
+    pa_threaded_mainloop_unlock(this->d->m_mainLoop);
 
-    this->d->m_paSimple = nullptr;
     this->d->m_curBps = 0;
     this->d->m_curChannels = 0;
+    this->d->m_fragmentOffset = 0;
 
     return ok;
 }
@@ -637,4 +805,41 @@ void AudioDevPulseAudioPrivate::sinkInfoCallback(pa_context *context,
     audioDevice->d->m_mutex.unlock();
 }
 
+void AudioDevPulseAudioPrivate::streamNotifyCallback(pa_stream *stream,
+                                                     void *userdata)
+{
+    Q_UNUSED(stream)
+
+    auto audioDevice = reinterpret_cast<AudioDevPulseAudio *>(userdata);
+
+    // Return as soon as possible.
+    pa_threaded_mainloop_signal(audioDevice->d->m_mainLoop, 0);
+}
+
+void AudioDevPulseAudioPrivate::streamRequestCallback(pa_stream *stream,
+                                                      size_t nbytes,
+                                                      void *userdata)
+{
+    Q_UNUSED(stream)
+    Q_UNUSED(nbytes)
+
+    auto audioDevice = reinterpret_cast<AudioDevPulseAudio *>(userdata);
+
+    // Return as soon as possible.
+    pa_threaded_mainloop_signal(audioDevice->d->m_mainLoop, 0);
+}
+
+void AudioDevPulseAudioPrivate::streamSuccessCallback(pa_stream *stream,
+                                                      int success,
+                                                      void *userdata)
+{
+    Q_UNUSED(stream)
+    Q_UNUSED(success)
+
+    auto audioDevice = reinterpret_cast<AudioDevPulseAudio *>(userdata);
+
+    // Return as soon as possible.
+    pa_threaded_mainloop_signal(audioDevice->d->m_mainLoop, 0);
+}
+
 #include "moc_audiodevpulseaudio.cpp"
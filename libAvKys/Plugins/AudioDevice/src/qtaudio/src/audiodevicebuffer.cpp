@@ -17,14 +17,20 @@
  * Web-Site: http://webcamoid.github.io/
  */
 
+#include <QThread>
+#include <cstring>
+
 #include "audiodevicebuffer.h"
 
-#define TIME_OUT 500
+#define WRITE_WAIT_US 1000
 #define BLOCK_SIZE (2 * 2 * 1024)
 
 AudioDeviceBuffer::AudioDeviceBuffer(QObject *parent):
     QIODevice(parent)
 {
+    this->m_capacity = 0;
+    this->m_readCursor = 0;
+    this->m_writeCursor = 0;
     this->m_blockSize = BLOCK_SIZE;
     this->m_maxBufferSize = 4 * BLOCK_SIZE;
     this->m_isOpen = false;
@@ -68,10 +74,6 @@ bool AudioDeviceBuffer::canReadLine() const
 void AudioDeviceBuffer::close()
 {
     this->m_isOpen = false;
-
-    this->m_mutex.lock();
-    this->m_buffer.clear();
-    this->m_mutex.unlock();
     QIODevice::close();
 }
 
@@ -82,10 +84,18 @@ bool AudioDeviceBuffer::isSequential() const
 
 bool AudioDeviceBuffer::open(QIODevice::OpenMode mode)
 {
-    this->m_mutex.lock();
-    this->m_buffer.clear();
+    // The ring capacity is a power of two fixed while the device is open,
+    // so the masked cursors are the only state the two threads share.
+    qint64 capacity = 2;
+
+    while (capacity < this->m_maxBufferSize)
+        capacity *= 2;
+
+    this->m_ring.resize(int(capacity));
+    this->m_capacity = capacity;
+    this->m_readCursor = 0;
+    this->m_writeCursor = 0;
     this->m_isOpen = QIODevice::open(mode);
-    this->m_mutex.unlock();
 
     return this->m_isOpen;
 }
@@ -133,39 +143,62 @@ qint64 AudioDeviceBuffer::readData(char *data, qint64 maxSize)
 
     memset(data, 0, size_t(maxSize));
 
-    this->m_mutex.lock();
-    auto copyBytes = qMin<qint64>(this->m_buffer.size(), maxSize);
-    memcpy(data, this->m_buffer.constData(), size_t(copyBytes));
-    this->m_buffer.remove(0, int(copyBytes));
+    // Wait-free consumer side. This runs in the audio callback, it copies
+    // whatever is available, pads the rest with silence and never blocks.
+    auto readCursor = this->m_readCursor.load();
+    auto available = this->m_writeCursor.loadAcquire() - readCursor;
+    auto copyBytes = qMin<qint64>(available, maxSize);
 
-    if (this->m_buffer.size() < this->m_maxBufferSize)
-        this->m_bufferNotFull.wakeAll();
+    if (copyBytes > 0) {
+        auto offset = readCursor & (this->m_capacity - 1);
+        auto tailBytes = qMin<qint64>(copyBytes, this->m_capacity - offset);
+        memcpy(data, this->m_ring.constData() + offset, size_t(tailBytes));
 
-    this->m_mutex.unlock();
+        if (copyBytes > tailBytes)
+            memcpy(data + tailBytes,
+                   this->m_ring.constData(),
+                   size_t(copyBytes - tailBytes));
+
+        this->m_readCursor.storeRelease(readCursor + copyBytes);
+    }
 
     return maxSize;
 }
 
 qint64 AudioDeviceBuffer::writeData(const char *data, qint64 maxSize)
 {
-    qint64 writenSize = 0;
+    qint64 writtenSize = 0;
 
-    this->m_mutex.lock();
+    // Producer side, pipeline thread. Blocking here is fine, it is how the
+    // device applies backpressure to the rest of the pipeline.
+    while (this->m_isOpen && writtenSize < maxSize) {
+        auto writeCursor = this->m_writeCursor.load();
+        auto freeBytes = this->m_capacity
+                         - (writeCursor - this->m_readCursor.loadAcquire());
 
-    while (this->m_isOpen) {
-        if (this->m_buffer.size() >= this->m_maxBufferSize)
-            if (!this->m_bufferNotFull.wait(&this->m_mutex, TIME_OUT))
-                continue;
+        if (freeBytes < 1) {
+            QThread::usleep(WRITE_WAIT_US);
 
-        this->m_buffer.append(QByteArray::fromRawData(data, int(maxSize)));
-        writenSize = maxSize;
+            continue;
+        }
 
-        break;
-    }
+        auto copyBytes = qMin<qint64>(freeBytes, maxSize - writtenSize);
+        auto offset = writeCursor & (this->m_capacity - 1);
+        auto tailBytes = qMin<qint64>(copyBytes, this->m_capacity - offset);
+        memcpy(this->m_ring.data() + offset,
+               data + writtenSize,
+               size_t(tailBytes));
 
-    this->m_mutex.unlock();
+        if (copyBytes > tailBytes)
+            memcpy(this->m_ring.data(),
+                   data + writtenSize + tailBytes,
+                   size_t(copyBytes - tailBytes));
+
+        this->m_writeCursor.storeRelease(writeCursor + copyBytes);
+        writtenSize += copyBytes;
+    }
 
-    return writenSize;
+    return writtenSize;
 }
 
 void AudioDeviceBuffer::setBlockSize(qint64 blockSize)
@@ -21,8 +21,9 @@
 #define AUDIODEVICEBUFFER_H
 
 #include <QIODevice>
-#include <QMutex>
-#include <QWaitCondition>
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include <QByteArray>
 
 class AudioDeviceBuffer: public QIODevice
 {
@@ -60,12 +61,17 @@ class AudioDeviceBuffer: public QIODevice
         bool waitForReadyRead(int msecs);
 
     private:
-        QByteArray m_buffer;
+        /* Single-producer/single-consumer ring buffer. The pipeline thread
+         * writes, the audio callback reads, and the cursors are the only
+         * shared state, so the callback never takes a lock.
+         */
+        QByteArray m_ring;
+        qint64 m_capacity;
+        QAtomicInteger<qint64> m_readCursor;
+        QAtomicInteger<qint64> m_writeCursor;
         qint64 m_blockSize;
         qint64 m_maxBufferSize;
-        QMutex m_mutex;
-        QWaitCondition m_bufferNotFull;
-        bool m_isOpen;
+        QAtomicInt m_isOpen;
 
     protected:
         qint64 readData(char *data, qint64 maxSize);
@@ -101,6 +101,7 @@ class AudioDevWasapiPrivate
         ULONG m_cRef;
         AkAudioCaps m_curCaps;
         QString m_curDevice;
+        bool m_exclusiveMode;
 
         AudioDevWasapiPrivate(AudioDevWasapi *self):
             self(self),
@@ -110,12 +111,14 @@ class AudioDevWasapiPrivate
             m_pCaptureClient(nullptr),
             m_pRenderClient(nullptr),
             m_hEvent(nullptr),
-            m_cRef(1)
+            m_cRef(1),
+            m_exclusiveMode(false)
         {
         }
 
         inline bool waveFormatFromAk(WAVEFORMATEX *wfx,
                                      const AkAudioCaps &caps) const;
+        inline bool reactivateAudioClient();
         inline void fillDeviceInfo(const QString &device,
                                    EDataFlow dataFlow,
                                    QList<AkAudioCaps::SampleFormat> *supportedFormats,
@@ -163,6 +166,11 @@ QString AudioDevWasapi::error() const
     return this->d->m_error;
 }
 
+bool AudioDevWasapi::exclusiveMode() const
+{
+    return this->d->m_exclusiveMode;
+}
+
 QString AudioDevWasapi::defaultInput()
 {
     return this->d->m_defaultSource;
@@ -262,7 +270,12 @@ bool AudioDevWasapi::init(const QString &device,
     if (justActivate)
         return true;
 
-    // Get the minimum size of the buffer in 100-nanosecond units,
+    // Set audio device format.
+    WAVEFORMATEX wfx;
+    this->d->waveFormatFromAk(&wfx, caps);
+    this->d->m_curCaps = caps;
+
+    // Get the default and minimum device periods in 100-nanosecond units,
     // this means you must do:
     //
     // bufferSize(seconds) = 100e-9 * hnsRequestedDuration
@@ -270,30 +283,83 @@ bool AudioDevWasapi::init(const QString &device,
     // to get the size of the buffer in seconds.
     //
     REFERENCE_TIME hnsRequestedDuration;
-    this->d->m_pAudioClient->GetDevicePeriod(nullptr, &hnsRequestedDuration);
+    REFERENCE_TIME hnsMinimumPeriod;
+    this->d->m_pAudioClient->GetDevicePeriod(&hnsRequestedDuration,
+                                             &hnsMinimumPeriod);
+
+    /* An exclusive stream bypasses the audio engine mixer and talks to the
+     * hardware directly, so the device must accept the requested format as
+     * is. Check it first and fall back to shared mode if it doesn't, or if
+     * the endpoint is configured to deny exclusive access.
+     */
+    bool exclusive = this->d->m_exclusiveMode
+                     && SUCCEEDED(this->d->m_pAudioClient->IsFormatSupported(AUDCLNT_SHAREMODE_EXCLUSIVE,
+                                                                             &wfx,
+                                                                             nullptr));
+
+    if (exclusive) {
+        // An event driven exclusive stream requires the buffer duration and
+        // the device period to be equal, use the minimum period the hardware
+        // supports for the lowest latency.
+        hr = this->d->m_pAudioClient->Initialize(AUDCLNT_SHAREMODE_EXCLUSIVE,
+                                                 AUDCLNT_STREAMFLAGS_EVENTCALLBACK,
+                                                 hnsMinimumPeriod,
+                                                 hnsMinimumPeriod,
+                                                 &wfx,
+                                                 nullptr);
+
+        if (hr == AUDCLNT_E_BUFFER_SIZE_NOT_ALIGNED) {
+            // The period must hold a whole number of audio frames. Read the
+            // aligned buffer size back, convert it to a period, and retry
+            // with a fresh audio client, the failed one can't be
+            // initialized again.
+            UINT32 nFrames = 0;
+
+            if (SUCCEEDED(this->d->m_pAudioClient->GetBufferSize(&nFrames))
+                && this->d->reactivateAudioClient()) {
+                REFERENCE_TIME hnsAlignedPeriod =
+                        REFERENCE_TIME(1e7 * nFrames / caps.rate() + 0.5);
+                hr = this->d->m_pAudioClient->Initialize(AUDCLNT_SHAREMODE_EXCLUSIVE,
+                                                         AUDCLNT_STREAMFLAGS_EVENTCALLBACK,
+                                                         hnsAlignedPeriod,
+                                                         hnsAlignedPeriod,
+                                                         &wfx,
+                                                         nullptr);
+            }
+        }
 
-    // Accumulate a minimum of 1 sec. of audio in the buffer.
-    REFERENCE_TIME minDuration = 10e6;
+        if (FAILED(hr)) {
+            if (!this->d->reactivateAudioClient()) {
+                this->d->m_error = "Initialize: " + errorCodes->value(hr);
+                emit this->errorChanged(this->d->m_error);
+                this->uninit();
 
-    if (hnsRequestedDuration < minDuration)
-        hnsRequestedDuration = minDuration;
+                return false;
+            }
 
-    // Set audio device format.
-    WAVEFORMATEX wfx;
-    this->d->waveFormatFromAk(&wfx, caps);
-    this->d->m_curCaps = caps;
+            exclusive = false;
+        }
+    }
 
-    if (FAILED(hr = this->d->m_pAudioClient->Initialize(AUDCLNT_SHAREMODE_SHARED,
-                                                        AUDCLNT_STREAMFLAGS_EVENTCALLBACK,
-                                                        hnsRequestedDuration,
-                                                        hnsRequestedDuration,
-                                                        &wfx,
-                                                        nullptr))) {
-        this->d->m_error = "Initialize: " + errorCodes->value(hr);
-        emit this->errorChanged(this->d->m_error);
-        this->uninit();
+    if (!exclusive) {
+        // Accumulate a minimum of 1 sec. of audio in the buffer.
+        REFERENCE_TIME minDuration = 10e6;
 
-        return false;
+        if (hnsRequestedDuration < minDuration)
+            hnsRequestedDuration = minDuration;
+
+        if (FAILED(hr = this->d->m_pAudioClient->Initialize(AUDCLNT_SHAREMODE_SHARED,
+                                                            AUDCLNT_STREAMFLAGS_EVENTCALLBACK,
+                                                            hnsRequestedDuration,
+                                                            hnsRequestedDuration,
+                                                            &wfx,
+                                                            nullptr))) {
+            this->d->m_error = "Initialize: " + errorCodes->value(hr);
+            emit this->errorChanged(this->d->m_error);
+            this->uninit();
+
+            return false;
+        }
     }
 
     // Create an event handler for checking when an aundio frame is required
@@ -611,6 +677,22 @@ bool AudioDevWasapiPrivate::waveFormatFromAk(WAVEFORMATEX *wfx,
     return true;
 }
 
+bool AudioDevWasapiPrivate::reactivateAudioClient()
+{
+    if (!this->m_pDevice)
+        return false;
+
+    if (this->m_pAudioClient) {
+        this->m_pAudioClient->Release();
+        this->m_pAudioClient = nullptr;
+    }
+
+    return SUCCEEDED(this->m_pDevice->Activate(__uuidof(IAudioClient),
+                                               CLSCTX_ALL,
+                                               nullptr,
+                                               reinterpret_cast<void **>(&this->m_pAudioClient)));
+}
+
 void AudioDevWasapiPrivate::fillDeviceInfo(const QString &device,
                                            EDataFlow dataFlow,
                                            QList<AkAudioCaps::SampleFormat> *supportedFormats,
@@ -763,6 +845,21 @@ HRESULT AudioDevWasapi::OnPropertyValueChanged(LPCWSTR pwstrDeviceId,
     return S_OK;
 }
 
+void AudioDevWasapi::setExclusiveMode(bool exclusiveMode)
+{
+    if (this->d->m_exclusiveMode == exclusiveMode)
+        return;
+
+    // Takes effect on the next init().
+    this->d->m_exclusiveMode = exclusiveMode;
+    emit this->exclusiveModeChanged(exclusiveMode);
+}
+
+void AudioDevWasapi::resetExclusiveMode()
+{
+    this->setExclusiveMode(false);
+}
+
 void AudioDevWasapi::updateDevices()
 {
     if (!this->d->m_deviceEnumerator) {
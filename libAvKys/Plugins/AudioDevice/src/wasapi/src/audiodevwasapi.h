@@ -35,6 +35,7 @@ class AudioDevWasapi: public AudioDev, public IMMNotificationClient
         ~AudioDevWasapi();
 
         Q_INVOKABLE QString error() const;
+        Q_INVOKABLE bool exclusiveMode() const;
         Q_INVOKABLE QString defaultInput();
         Q_INVOKABLE QString defaultOutput();
         Q_INVOKABLE QStringList inputs();
@@ -70,6 +71,10 @@ class AudioDevWasapi: public AudioDev, public IMMNotificationClient
         HRESULT STDMETHODCALLTYPE OnPropertyValueChanged(LPCWSTR pwstrDeviceId,
                                                          const PROPERTYKEY key);
 
+    public slots:
+        void setExclusiveMode(bool exclusiveMode);
+        void resetExclusiveMode();
+
     private slots:
         void updateDevices();
 };
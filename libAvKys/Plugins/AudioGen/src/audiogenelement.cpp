@@ -64,6 +64,9 @@ inline WaveTypeMap initWaveTypeMap()
 
 Q_GLOBAL_STATIC_WITH_ARGS(WaveTypeMap, waveTypeToStr, (initWaveTypeMap()))
 
+// One period of the waveform, scanned with a 16.16 fixed point phase
+// accumulator. Power of two so the index wraps with a mask.
+static const int WaveTableSize = 4096;
 
 class AudioGenElementPrivate
 {
@@ -77,6 +80,15 @@ class AudioGenElementPrivate
         QThreadPool m_threadPool;
         QFuture<void> m_readFramesLoopResult;
         QMutex m_mutex;
+        QVector<qint32> m_waveTable;
+        QByteArray m_silenceBuffer;
+        QByteArray m_noiseTable;
+        AudioGenElement::WaveType m_tableWaveType;
+        qreal m_tableFrequency;
+        qreal m_tableVolume;
+        int m_tableRate;
+        quint32 m_phase;
+        quint32 m_phaseStep;
         bool m_readFramesLoop;
         bool m_pause;
         qint64 m_id;
@@ -88,12 +100,22 @@ class AudioGenElementPrivate
             m_volume(1.0),
             m_sampleDuration(25.0),
             m_audioConvert(AkElement::create("ACapsConvert")),
+            m_tableWaveType(AudioGenElement::WaveTypeSilence),
+            m_tableFrequency(0.0),
+            m_tableVolume(0.0),
+            m_tableRate(0),
+            m_phase(0),
+            m_phaseStep(0),
             m_readFramesLoop(false),
             m_pause(false),
             m_id(-1)
         {
         }
 
+        inline void updateWaveTable(AudioGenElement::WaveType waveType,
+                                    qreal frequency,
+                                    qreal volume,
+                                    int rate);
         inline void readFramesLoop();
 };
 
@@ -139,6 +161,68 @@ qreal AudioGenElement::sampleDuration() const
     return this->d->m_sampleDuration;
 }
 
+void AudioGenElementPrivate::updateWaveTable(AudioGenElement::WaveType waveType,
+                                             qreal frequency,
+                                             qreal volume,
+                                             int rate)
+{
+    if (waveType == this->m_tableWaveType
+        && qFuzzyCompare(frequency, this->m_tableFrequency)
+        && qFuzzyCompare(volume, this->m_tableVolume)
+        && rate == this->m_tableRate
+        && !this->m_waveTable.isEmpty())
+        return;
+
+    qint32 ampMax = qint32(volume * std::numeric_limits<qint32>::max());
+    qint32 ampMin = qint32(volume * std::numeric_limits<qint32>::min());
+    this->m_waveTable.resize(WaveTableSize);
+    qint32 *table = this->m_waveTable.data();
+
+    switch (waveType) {
+    case AudioGenElement::WaveTypeSine:
+        for (int i = 0; i < WaveTableSize; i++)
+            table[i] = qRound(ampMax * qSin(2 * M_PI * i / WaveTableSize));
+
+        break;
+    case AudioGenElement::WaveTypeSquare:
+        for (int i = 0; i < WaveTableSize; i++)
+            table[i] = i < WaveTableSize / 2? ampMax: ampMin;
+
+        break;
+    case AudioGenElement::WaveTypeSawtooth: {
+        qreal k = (qreal(ampMax) - ampMin) / (WaveTableSize - 1);
+
+        for (int i = 0; i < WaveTableSize; i++)
+            table[i] = qRound(k * i + ampMin);
+
+        break;
+    }
+    case AudioGenElement::WaveTypeTriangle: {
+        qreal k = 2 * (qreal(ampMax) - ampMin) / (WaveTableSize - 2);
+
+        for (int i = 0; i < WaveTableSize / 2; i++)
+            table[i] = qRound(k * i + ampMin);
+
+        for (int i = WaveTableSize / 2; i < WaveTableSize; i++)
+            table[i] = qRound(k * (WaveTableSize - i) + ampMin);
+
+        break;
+    }
+    default:
+        this->m_waveTable.fill(0);
+
+        break;
+    }
+
+    this->m_phaseStep =
+            quint32(qRound64(65536.0 * WaveTableSize * frequency / rate));
+    this->m_phase = 0;
+    this->m_tableWaveType = waveType;
+    this->m_tableFrequency = frequency;
+    this->m_tableVolume = volume;
+    this->m_tableRate = rate;
+}
+
 void AudioGenElementPrivate::readFramesLoop()
 {
     qint64 pts = 0;
@@ -197,55 +281,56 @@ void AudioGenElementPrivate::readFramesLoop()
         }
 
         size_t bufferSize = sizeof(qint32) * size_t(nSamples);
-
-        QByteArray iBuffer(int(bufferSize), 0);
-        qreal time = QTime::currentTime().msecsSinceStartOfDay() / 1.e3;
-        qreal tdiff = 1. / oAudioCaps.rate();
+        QByteArray iBuffer;
 
         if (this->m_waveType == AudioGenElement::WaveTypeSilence) {
-            iBuffer.fill(0);
+            // Share one zeroed buffer between frames; downstream only
+            // reads it, so the packets just bump its reference count.
+            if (this->m_silenceBuffer.size() != int(bufferSize))
+                this->m_silenceBuffer = QByteArray(int(bufferSize), 0);
+
+            iBuffer = this->m_silenceBuffer;
         } else if (this->m_waveType == AudioGenElement::WaveTypeWhiteNoise) {
-            static std::default_random_engine engine;
-            static std::uniform_int_distribution<int> distribution(-128, 127);
+            /* Noise isn't periodic, but it doesn't have to be fresh
+             * either: a copy from a random offset of a pregenerated table
+             * is indistinguishable and turns the per-sample engine calls
+             * into one memcpy.
+             */
+            int size = int(bufferSize);
+
+            if (this->m_noiseTable.size() < 2 * size) {
+                this->m_noiseTable.resize(2 * size);
+                std::default_random_engine engine;
+                std::uniform_int_distribution<int> distribution(-128, 127);
+
+                for (int i = 0; i < this->m_noiseTable.size(); i++)
+                    this->m_noiseTable[i] = char(distribution(engine));
+            }
 
-            for (int i = 0; i < iBuffer.size(); i++)
-                iBuffer[i] = char(distribution(engine));
+            iBuffer.resize(size);
+            int offset = qrand() % (this->m_noiseTable.size() - size + 1);
+            memcpy(iBuffer.data(),
+                   this->m_noiseTable.constData() + offset,
+                   size_t(size));
         } else {
-            qint32 ampMax = qint32(this->m_volume * std::numeric_limits<qint32>::max());
-            qint32 ampMin = qint32(this->m_volume * std::numeric_limits<qint32>::min());
-            qreal t = time;
+            // The periodic waves read a precomputed one period table with
+            // a fixed point phase increment, no per-sample math at all.
+            // The phase carries across frames, so they join seamlessly.
+            this->updateWaveTable(this->m_waveType,
+                                  this->m_frequency,
+                                  this->m_volume,
+                                  oAudioCaps.rate());
+
+            iBuffer.resize(int(bufferSize));
+            const qint32 *table = this->m_waveTable.constData();
             qint32 *buff = reinterpret_cast<qint32 *>(iBuffer.data());
+            quint32 phase = this->m_phase;
+            quint32 phaseStep = this->m_phaseStep;
 
-            if (this->m_waveType == AudioGenElement::WaveTypeSine) {
-                for  (int i = 0; i < nSamples; i++, time += tdiff)
-                    buff[i] = qRound(ampMax * qSin(2 * M_PI * this->m_frequency * t));
-            } else if (this->m_waveType == AudioGenElement::WaveTypeSquare) {
-                for  (int i = 0; i < nSamples; i++, time += tdiff)
-                    buff[i] = qRound(2 * this->m_frequency * t) & 0x1?
-                                  ampMin: ampMax;
-            } else {
-                qint32 mod = qRound(oAudioCaps.rate() / this->m_frequency);
-
-                if (this->m_waveType == AudioGenElement::WaveTypeSawtooth) {
-                    qreal k = (qreal(ampMax) - ampMin) / (mod - 1);
-
-                    for  (int i = 0; i < nSamples; i++, time += tdiff) {
-                        qint32 nsample = qRound(t / tdiff);
-                        buff[i] = qRound(k * (nsample % mod) + ampMin);
-                    }
-                } else if (this->m_waveType == AudioGenElement::WaveTypeTriangle) {
-                    mod /= 2;
-                    qreal k = (qreal(ampMax) - ampMin) / (mod - 1);
-
-                    for  (int i = 0; i < nSamples; i++, time += tdiff) {
-                        qint32 nsample = qRound(t / tdiff);
-
-                        buff[i] = qRound(2 * this->m_frequency * t) & 0x1?
-                                      qRound(-k * (nsample % mod) + ampMax):
-                                      qRound( k * (nsample % mod) + ampMin);
-                    }
-                }
-            }
+            for (int i = 0; i < nSamples; i++, phase += phaseStep)
+                buff[i] = table[(phase >> 16) & (WaveTableSize - 1)];
+
+            this->m_phase = phase;
         }
 
         AkAudioCaps iAudioCaps(oAudioCaps);
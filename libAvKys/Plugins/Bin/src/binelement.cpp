@@ -27,19 +27,56 @@
 class BinElementPrivate
 {
     public:
+        enum PacketRoute
+        {
+            PacketRouteDrop,
+            PacketRoutePassthrough,
+            PacketRouteSingleInput,
+            PacketRouteFanOut
+        };
+
         QString m_description;
         QMap<QString, AkElementPtr> m_elements;
         QList<AkElementPtr> m_inputs;
         QList<AkElementPtr> m_outputs;
         Pipeline m_pipelineDescription;
+        PacketRoute m_route;
+        AkElement *m_directInput;
         bool m_blocking;
 
         BinElementPrivate():
+            m_route(PacketRoutePassthrough),
+            m_directInput(nullptr),
             m_blocking(false)
         {
         }
+
+        inline void updateRoute();
 };
 
+/* The routing decision only depends on the description and the blocking
+ * flag, so resolve it here once per reconfiguration instead of once per
+ * packet. Linear bins with a single entry point collapse to a direct
+ * call on that element. */
+void BinElementPrivate::updateRoute()
+{
+    if (!this->m_description.isEmpty()) {
+        if (this->m_inputs.size() == 1) {
+            this->m_route = PacketRouteSingleInput;
+            this->m_directInput = this->m_inputs.first().data();
+
+            return;
+        }
+
+        this->m_route = PacketRouteFanOut;
+    } else {
+        this->m_route = this->m_blocking?
+                            PacketRouteDrop: PacketRoutePassthrough;
+    }
+
+    this->m_directInput = nullptr;
+}
+
 BinElement::BinElement():
     AkElement()
 {
@@ -130,6 +167,7 @@ void BinElement::setDescription(const QString &description)
         }
     }
 
+    this->d->updateRoute();
     this->setState(preState);
     emit this->descriptionChanged(description);
 }
@@ -140,6 +178,7 @@ void BinElement::setBlocking(bool blocking)
         return;
 
     this->d->m_blocking = blocking;
+    this->d->updateRoute();
     emit this->blockingChanged(blocking);
 }
 
@@ -155,11 +194,21 @@ void BinElement::resetBlocking()
 
 AkPacket BinElement::iStream(const AkPacket &packet)
 {
-    if (!this->d->m_description.isEmpty())
+    switch (this->d->m_route) {
+    case BinElementPrivate::PacketRoutePassthrough:
+        akSend(packet)
+    case BinElementPrivate::PacketRouteSingleInput:
+        this->d->m_directInput->iStream(packet);
+
+        break;
+    case BinElementPrivate::PacketRouteFanOut:
         for (const AkElementPtr &element: this->d->m_inputs)
             element->iStream(packet);
-    else if (!this->d->m_blocking)
-        akSend(packet)
+
+        break;
+    default:
+        break;
+    }
 
     return AkPacket();
 }
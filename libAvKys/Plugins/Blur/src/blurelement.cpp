@@ -21,6 +21,11 @@
 #include <QQmlContext>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akvideofilterrunner.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #include "blurelement.h"
 #include "pixel.h"
@@ -60,29 +65,36 @@ void BlurElementPrivate::integralImage(const QImage &image,
                                        int oWidth, int oHeight,
                                        PixelU32 *integral)
 {
-    for (int y = 1; y < oHeight; y++) {
-        auto line = reinterpret_cast<const QRgb *>(image.constScanLine(y - 1));
-
-        // Reset current line summation.
-        PixelU32 sum;
-
-        for (int x = 1; x < oWidth; x++) {
-            QRgb pixel = line[x - 1];
-
-            // Accumulate pixels in current line.
-            sum += pixel;
-
-            // Offset to the current line.
-            int offset = x + y * oWidth;
+    auto runner = AkVideoFilterRunner::globalRunner();
+
+    /* The integral image is built in two separable passes so both can run
+     * in parallel bands: horizontal prefix sums with every row independent,
+     * then a vertical accumulation with every column independent. Unsigned
+     * additions are associative, so the result is bit-exact with the old
+     * single threaded accumulation.
+     */
+    runner->run(oHeight - 1, [&] (int yStart, int yEnd) {
+        for (int y = yStart + 1; y <= yEnd; y++) {
+            auto line = reinterpret_cast<const QRgb *>(image.constScanLine(y - 1));
+            auto integralLine = integral + y * oWidth;
+            PixelU32 sum;
+
+            for (int x = 1; x < oWidth; x++) {
+                sum += line[x - 1];
+                integralLine[x] = sum;
+            }
+        }
+    });
 
-            // Offset to the previous line.
-            // equivalent to x + (y - 1) * oWidth;
-            int offsetPrevious = offset - oWidth;
+    runner->run(oWidth - 1, [&] (int xStart, int xEnd) {
+        for (int y = 2; y < oHeight; y++) {
+            auto integralLine = integral + y * oWidth;
+            auto previousLine = integralLine - oWidth;
 
-            // Accumulate current line and previous line.
-            integral[offset] = sum + integral[offsetPrevious];
+            for (int x = xStart + 1; x <= xEnd; x++)
+                integralLine[x] += previousLine[x];
         }
-    }
+    });
 }
 
 QString BlurElement::controlInterfaceProvide(const QString &controlId) const
@@ -123,6 +135,24 @@ AkPacket BlurElement::iStream(const AkPacket &packet)
         return AkPacket();
 
     src = src.convertToFormat(QImage::Format_ARGB32);
+
+    int radius = this->d->m_radius;
+    QSize frameSize = src.size();
+    auto quality = this->quality();
+
+    if (quality != AkElement::QualityFull) {
+        /* A blurred frame carries no detail anyway, so under load it is
+         * computed at reduced resolution and interpolated back up, which
+         * is nearly indistinguishable on a moving image and divides the
+         * whole cost by the square of the factor. */
+        int shift = quality == AkElement::QualityBalanced? 1: 2;
+        src = src.scaled(qMax(frameSize.width() >> shift, 1),
+                         qMax(frameSize.height() >> shift, 1),
+                         Qt::IgnoreAspectRatio,
+                         Qt::FastTransformation);
+        radius = qMax(radius >> shift, 1);
+    }
+
     QImage oFrame(src.size(), src.format());
 
     int oWidth = src.width() + 1;
@@ -130,26 +160,99 @@ AkPacket BlurElement::iStream(const AkPacket &packet)
     PixelU32 *integral = new PixelU32[oWidth * oHeight];
     this->d->integralImage(src, oWidth, oHeight, integral);
 
-    int radius = this->d->m_radius;
-
-    for (int y = 0; y < src.height(); y++) {
-        QRgb *oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
-        int yp = qMax(y - radius, 0);
-        int kh = qMin(y + radius, src.height() - 1) - yp + 1;
-
-        for (int x = 0; x < src.width(); x++) {
-            int xp = qMax(x - radius, 0);
-            int kw = qMin(x + radius, src.width() - 1) - xp + 1;
-
-            PixelU32 sum = integralSum(integral, oWidth, xp, yp, kw, kh);
-            PixelU32 mean = sum / quint32(kw * kh);
-
-            oLine[x] = qRgba(int(mean.r), int(mean.g), int(mean.b), int(mean.a));
+    int width = src.width();
+    int height = src.height();
+
+    AkVideoFilterRunner::globalRunner()->run(height,
+                                             [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            QRgb *oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+            int yp = qMax(y - radius, 0);
+            int kh = qMin(y + radius, height - 1) - yp + 1;
+
+            auto blurPixel = [&] (int x) {
+                int xp = qMax(x - radius, 0);
+                int kw = qMin(x + radius, width - 1) - xp + 1;
+
+                PixelU32 sum = integralSum(integral, oWidth, xp, yp, kw, kh);
+                PixelU32 mean = sum / quint32(kw * kh);
+
+                oLine[x] = qRgba(int(mean.r), int(mean.g), int(mean.b), int(mean.a));
+            };
+
+            // Rows clipped by the frame border keep the bounds checks.
+            if (kh != 2 * radius + 1) {
+                for (int x = 0; x < width; x++)
+                    blurPixel(x);
+
+                continue;
+            }
+
+            int xMin = qMin(radius, width);
+            int xMax = qMax(width - radius, xMin);
+
+            for (int x = 0; x < xMin; x++)
+                blurPixel(x);
+
+            if (xMax > xMin) {
+                /* In the interior the window never touches the border, so
+                 * the area is constant and the four integral taps advance
+                 * one pixel per iteration with no clamping.
+                 */
+                quint32 area = quint32((2 * radius + 1) * kh);
+                auto p0 = integral + (xMin - radius) + yp * oWidth;
+                auto p1 = p0 + 2 * radius + 1;
+                auto p2 = p0 + kh * oWidth;
+                auto p3 = p2 + 2 * radius + 1;
+
+#if defined(__SSE2__)
+                // A PixelU32 is four packed quint32, exactly one SSE register.
+                for (int x = xMin; x < xMax; x++) {
+                    auto sum = _mm_sub_epi32(
+                                   _mm_add_epi32(
+                                       _mm_loadu_si128(reinterpret_cast<const __m128i *>(p0)),
+                                       _mm_loadu_si128(reinterpret_cast<const __m128i *>(p3))),
+                                   _mm_add_epi32(
+                                       _mm_loadu_si128(reinterpret_cast<const __m128i *>(p1)),
+                                       _mm_loadu_si128(reinterpret_cast<const __m128i *>(p2))));
+                    quint32 mean[4];
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(mean), sum);
+                    oLine[x] = qRgba(int(mean[0] / area),
+                                     int(mean[1] / area),
+                                     int(mean[2] / area),
+                                     int(mean[3] / area));
+                    p0++;
+                    p1++;
+                    p2++;
+                    p3++;
+                }
+#else
+                for (int x = xMin; x < xMax; x++) {
+                    PixelU32 mean = (*p0 + *p3 - *p1 - *p2) / area;
+                    oLine[x] = qRgba(int(mean.r),
+                                     int(mean.g),
+                                     int(mean.b),
+                                     int(mean.a));
+                    p0++;
+                    p1++;
+                    p2++;
+                    p3++;
+                }
+#endif
+            }
+
+            for (int x = xMax; x < width; x++)
+                blurPixel(x);
         }
-    }
+    });
 
     delete [] integral;
 
+    if (oFrame.size() != frameSize)
+        oFrame = oFrame.scaled(frameSize,
+                               Qt::IgnoreAspectRatio,
+                               Qt::SmoothTransformation);
+
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
 }
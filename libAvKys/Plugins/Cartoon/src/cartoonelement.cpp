@@ -19,12 +19,12 @@
 
 #include <limits>
 #include <QtMath>
-#include <QPainter>
 #include <QDateTime>
 #include <QMutex>
 #include <QQmlContext>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akvideofilterrunner.h>
 
 #include "cartoonelement.h"
 
@@ -57,16 +57,14 @@ class CartoonElementPrivate
         }
 
         inline QVector<QRgb> palette(const QImage &img,
+                                     const QSize &scanSize,
                                      int ncolors,
                                      int colorDiff);
+        inline void invalidatePalette();
         inline QRgb nearestColor(int *index,
                                  int *diff,
                                  const QVector<QRgb> &palette,
                                  QRgb color) const;
-        inline QImage edges(const QImage &src,
-                            int thLow,
-                            int thHi,
-                            QRgb color) const;
         inline int rgb24Torgb16(QRgb color);
         inline void rgb16Torgb24(int *r, int *g, int *b, int color);
         inline QRgb rgb16Torgb24(int color);
@@ -118,23 +116,29 @@ QSize CartoonElement::scanSize() const
 }
 
 QVector<QRgb> CartoonElementPrivate::palette(const QImage &img,
+                                             const QSize &scanSize,
                                              int ncolors,
                                              int colorDiff)
 {
     qint64 time = QDateTime::currentMSecsSinceEpoch();
+    QMutexLocker locker(&this->m_mutex);
 
     // This code stabilize the color change between frames.
     if (this->m_palette.isEmpty() || (time - this->m_lastTime) >= 3 * 1000) {
+        /* The scan frame is only needed when the look-up table is
+         * rebuilt, so the scaling runs here and not once per frame. */
+        QImage scanFrame = img.scaled(scanSize, Qt::KeepAspectRatio);
+
         // Create a histogram of 66k colors.
         QVector<QPair<int, int>> histogram(1 << 16);
 
         for (int i = 0; i < histogram.size(); i++)
             histogram[i].second = i;
 
-        for (int y = 0; y < img.height(); y++) {
-            const QRgb *line = reinterpret_cast<const QRgb *>(img.constScanLine(y));
+        for (int y = 0; y < scanFrame.height(); y++) {
+            const QRgb *line = reinterpret_cast<const QRgb *>(scanFrame.constScanLine(y));
 
-            for (int x = 0; x < img.width(); x++)
+            for (int x = 0; x < scanFrame.width(); x++)
                 // Pixels must be converted from 24 bits to 16 bits color depth.
                 histogram[this->rgb24Torgb16(line[x])].first++;
         }
@@ -191,6 +195,12 @@ QVector<QRgb> CartoonElementPrivate::palette(const QImage &img,
     return palette;
 }
 
+void CartoonElementPrivate::invalidatePalette()
+{
+    QMutexLocker locker(&this->m_mutex);
+    this->m_palette.clear();
+}
+
 QRgb CartoonElementPrivate::nearestColor(int *index,
                                          int *diff,
                                          const QVector<QRgb> &palette,
@@ -235,62 +245,6 @@ QRgb CartoonElementPrivate::nearestColor(int *index,
     return palette[index_];
 }
 
-QImage CartoonElementPrivate::edges(const QImage &src,
-                                    int thLow,
-                                    int thHi,
-                                    QRgb color) const
-{
-    QImage dst(src.size(), src.format());
-
-    if (thLow > thHi)
-        std::swap(thLow, thHi);
-
-    QVector<QRgb> colors(256);
-
-    for (int i = 0; i < colors.size(); i++) {
-        int alpha = i < thLow? 0: i > thHi? 255: i;
-        colors[i] = qRgba(qRed(color), qGreen(color), qBlue(color), alpha);
-    }
-
-    for (int y = 0; y < src.height(); y++) {
-        const QRgb *srcLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
-        QRgb *dstLine = reinterpret_cast<QRgb *>(dst.scanLine(y));
-
-        const QRgb *srcLine_m1 = y < 1? srcLine: srcLine - src.width();
-        const QRgb *srcLine_p1 = y >= src.height() - 1? srcLine: srcLine + src.width();
-
-        for (int x = 0; x < src.width(); x++) {
-            int x_m1 = x < 1? x: x - 1;
-            int x_p1 = x >= src.width() - 1? x: x + 1;
-
-            int s_m1_p1 = qGray(srcLine_m1[x_p1]);
-            int s_p1_p1 = qGray(srcLine_p1[x_p1]);
-            int s_m1_m1 = qGray(srcLine_m1[x_m1]);
-            int s_p1_m1 = qGray(srcLine_p1[x_m1]);
-
-            int gradX = s_m1_p1
-                      + 2 * qGray(srcLine[x_p1])
-                      + s_p1_p1
-                      - s_m1_m1
-                      - 2 * qGray(srcLine[x_m1])
-                      - s_p1_m1;
-
-            int gradY = s_m1_m1
-                      + 2 * qGray(srcLine_m1[x])
-                      + s_m1_p1
-                      - s_p1_m1
-                      - 2 * qGray(srcLine_p1[x])
-                      - s_p1_p1;
-
-            int grad = qAbs(gradX) + qAbs(gradY);
-            grad = qBound(0, grad, 255);
-            dstLine[x] = colors[grad];
-        }
-    }
-
-    return dst;
-}
-
 int CartoonElementPrivate::rgb24Torgb16(QRgb color)
 {
     return ((qRed(color) >> 3) << 11)
@@ -340,6 +294,7 @@ void CartoonElement::setNColors(int ncolors)
         return;
 
     this->d->m_ncolors = ncolors;
+    this->d->invalidatePalette();
     emit this->ncolorsChanged(ncolors);
 }
 
@@ -349,6 +304,7 @@ void CartoonElement::setColorDiff(int colorDiff)
         return;
 
     this->d->m_colorDiff = colorDiff;
+    this->d->invalidatePalette();
     emit this->colorDiffChanged(colorDiff);
 }
 
@@ -453,36 +409,116 @@ AkPacket CartoonElement::iStream(const AkPacket &packet)
 
     if (this->d->m_id != packet.id()) {
         this->d->m_id = packet.id();
-        this->d->m_palette.clear();
+        this->d->invalidatePalette();
         this->d->m_lastTime = QDateTime::currentMSecsSinceEpoch();
     }
 
-    // Palettize image.
-    QVector<QRgb> palette =
-            this->d->palette(src.scaled(scanSize, Qt::KeepAspectRatio),
-                             this->d->m_ncolors,
-                             this->d->m_colorDiff);
-
-    for (int y = 0; y < src.height(); y++) {
-        const QRgb *srcLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
-        QRgb *dstLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+    QVector<QRgb> palette = this->d->palette(src,
+                                             scanSize,
+                                             this->d->m_ncolors,
+                                             this->d->m_colorDiff);
+    int width = src.width();
+    int height = src.height();
+    auto runner = AkVideoFilterRunner::globalRunner();
+
+    if (!this->d->m_showEdges) {
+        // Palettize image.
+        runner->run(height, [&] (int yStart, int yEnd) {
+            for (int y = yStart; y < yEnd; y++) {
+                auto srcLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
+                auto dstLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+
+                for (int x = 0; x < width; x++)
+                    dstLine[x] = palette[this->d->rgb24Torgb16(srcLine[x])];
+            }
+        });
 
-        for (int x = 0; x < src.width(); x++)
-            dstLine[x] = palette[this->d->rgb24Torgb16(srcLine[x])];
+        AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
+        akSend(oPacket)
     }
 
-    // Draw the edges.
-    if (this->d->m_showEdges) {
-        QPainter painter;
-        painter.begin(&oFrame);
-        QImage edges =
-                this->d->edges(src,
-                               this->d->m_thresholdLow,
-                               this->d->m_thresholdHi,
-                               this->d->m_lineColor);
-        painter.drawImage(0, 0, edges);
-        painter.end();
-    }
+    /* The Sobel operator reads each luma up to six times, so compute the
+     * luma plane once into a pooled scratch plane. */
+    quint8 *gray = this->scratchPlane("gray", src.size());
+
+    runner->run(height, [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            auto srcLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
+            quint8 *grayLine = gray + y * width;
+
+            for (int x = 0; x < width; x++)
+                grayLine[x] = quint8(qGray(srcLine[x]));
+        }
+    });
+
+    int thLow = this->d->m_thresholdLow;
+    int thHi = this->d->m_thresholdHi;
+
+    if (thLow > thHi)
+        std::swap(thLow, thHi);
+
+    quint8 alphaTable[256];
+
+    for (int i = 0; i < 256; i++)
+        alphaTable[i] = quint8(i < thLow? 0: i > thHi? 255: i);
+
+    QRgb lineColor = this->d->m_lineColor;
+    int lr = qRed(lineColor);
+    int lg = qGreen(lineColor);
+    int lb = qBlue(lineColor);
+
+    /* Palettize, detect the edges and blend the line color over the
+     * quantized pixel in a single pass, instead of a full edges image
+     * plus a painter draw. The palettized pixels are opaque, so the
+     * source-over blend reduces to a plain mix by the edge alpha. */
+    runner->run(height, [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            auto srcLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
+            auto dstLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+
+            const quint8 *grayLine = gray + y * width;
+            const quint8 *grayLine_m1 = y < 1? grayLine: grayLine - width;
+            const quint8 *grayLine_p1 = y >= height - 1? grayLine: grayLine + width;
+
+            for (int x = 0; x < width; x++) {
+                QRgb color = palette[this->d->rgb24Torgb16(srcLine[x])];
+
+                int x_m1 = x < 1? x: x - 1;
+                int x_p1 = x >= width - 1? x: x + 1;
+
+                int s_m1_p1 = grayLine_m1[x_p1];
+                int s_p1_p1 = grayLine_p1[x_p1];
+                int s_m1_m1 = grayLine_m1[x_m1];
+                int s_p1_m1 = grayLine_p1[x_m1];
+
+                int gradX = s_m1_p1
+                          + 2 * grayLine[x_p1]
+                          + s_p1_p1
+                          - s_m1_m1
+                          - 2 * grayLine[x_m1]
+                          - s_p1_m1;
+
+                int gradY = s_m1_m1
+                          + 2 * grayLine_m1[x]
+                          + s_m1_p1
+                          - s_p1_m1
+                          - 2 * grayLine_p1[x]
+                          - s_p1_p1;
+
+                int grad = qBound(0, qAbs(gradX) + qAbs(gradY), 255);
+                int a = alphaTable[grad];
+
+                if (a == 0)
+                    dstLine[x] = color;
+                else if (a == 255)
+                    dstLine[x] = qRgb(lr, lg, lb);
+                else
+                    dstLine[x] = qRgb((lr * a + qRed(color) * (255 - a)) / 255,
+                                      (lg * a + qGreen(color) * (255 - a)) / 255,
+                                      (lb * a + qBlue(color) * (255 - a)) / 255);
+            }
+        }
+    });
 
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
@@ -21,6 +21,7 @@
 #include <QImage>
 #include <QQmlContext>
 #include <akutils.h>
+#include <akcolorlut.h>
 #include <akpacket.h>
 
 #include "changehslelement.h"
@@ -29,6 +30,7 @@ class ChangeHSLElementPrivate
 {
     public:
         QVector<qreal> m_kernel;
+        AkColorLut m_lut;
 };
 
 ChangeHSLElement::ChangeHSLElement(): AkElement()
@@ -40,6 +42,8 @@ ChangeHSLElement::ChangeHSLElement(): AkElement()
         0, 1, 0, 0,
         0, 0, 1, 0
     };
+
+    this->d->m_lut.setHslKernel(this->d->m_kernel);
 }
 
 ChangeHSLElement::~ChangeHSLElement()
@@ -84,6 +88,7 @@ void ChangeHSLElement::setKernel(const QVariantList &kernel)
         return;
 
     this->d->m_kernel = k;
+    this->d->m_lut.setHslKernel(k);
     emit this->kernelChanged(kernel);
 }
 
@@ -110,34 +115,11 @@ AkPacket ChangeHSLElement::iStream(const AkPacket &packet)
 
     src = src.convertToFormat(QImage::Format_ARGB32);
     QImage oFrame(src.size(), src.format());
-    QVector<qreal> kernel = this->d->m_kernel;
-
-    for (int y = 0; y < src.height(); y++) {
-        const QRgb *srcLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
-        QRgb *dstLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
-
-        for (int x = 0; x < src.width(); x++) {
-            int h;
-            int s;
-            int l;
-            int a;
-
-            QColor(srcLine[x]).getHsl(&h, &s, &l, &a);
-
-            int ht = int(h * kernel[0] + s * kernel[1] + l * kernel[2]  + kernel[3]);
-            int st = int(h * kernel[4] + s * kernel[5] + l * kernel[6]  + kernel[7]);
-            int lt = int(h * kernel[8] + s * kernel[9] + l * kernel[10] + kernel[11]);
-
-            ht = qBound(0, ht, 359);
-            st = qBound(0, st, 255);
-            lt = qBound(0, lt, 255);
-
-            QColor color;
-            color.setHsl(ht, st, lt, a);
 
-            dstLine[x] = color.rgba();
-        }
-    }
+    // The kernel compiles into additive tables over the HSL components in
+    // the setter, and the conversions are done inline instead of through
+    // QColor.
+    this->d->m_lut.apply(src, oFrame);
 
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
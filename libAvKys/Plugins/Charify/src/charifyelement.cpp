@@ -18,11 +18,14 @@
  */
 
 #include <QApplication>
+#include <QHash>
 #include <QPainter>
 #include <QQmlContext>
 #include <QMutex>
+#include <QVector>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akvideofilterrunner.h>
 
 #include "charifyelement.h"
 
@@ -96,6 +99,11 @@ class CharifyElementPrivate
         QRgb m_foregroundColor;
         QRgb m_backgroundColor;
         QVector<Character> m_characters;
+
+        /* Contiguous atlas of coverage masks, one glyph of
+         * fontSize.width() x fontSize.height() bytes per gray level.
+         */
+        QVector<quint8> m_glyphMasks;
         QSize m_fontSize;
         QMutex m_mutex;
         bool m_reversed;
@@ -427,50 +435,98 @@ AkPacket CharifyElement::iStream(const AkPacket &packet)
 
     this->d->m_mutex.lock();
     QSize fontSize = this->d->m_fontSize;
-    QVector<Character> characters = this->d->m_characters;
+    QVector<quint8> glyphMasks = this->d->m_glyphMasks;
     this->d->m_mutex.unlock();
 
-    int textWidth = src.width() / fontSize.width();
-    int textHeight = src.height() / fontSize.height();
+    int cellWidth = fontSize.width();
+    int cellHeight = fontSize.height();
+    int textWidth = src.width() / cellWidth;
+    int textHeight = src.height() / cellHeight;
 
-    int outWidth = textWidth * fontSize.width();
-    int outHeight = textHeight * fontSize.height();
+    int outWidth = textWidth * cellWidth;
+    int outHeight = textHeight * cellHeight;
 
     QImage oFrame(outWidth, outHeight, src.format());
 
-    if (characters.isEmpty()) {
+    if (glyphMasks.isEmpty()) {
         oFrame.fill(qRgb(0, 0, 0));
         auto oPacket = AkUtils::imageToPacket(oFrame.scaled(src.size()),
                                               packet);
         akSend(oPacket)
     }
 
-    QImage textImage = src.scaled(textWidth, textHeight);
-    const QRgb *textImageBits = reinterpret_cast<const QRgb *>(textImage.constBits());
-    int textArea = textImage.width() * textImage.height();
-    QPainter painter;
-
-    painter.begin(&oFrame);
-
-    for (int i = 0; i < textArea; i++) {
-        int x = fontSize.width() * (i % textWidth);
-        int y = fontSize.height() * (i / textWidth);
-
-        if (this->d->m_mode == ColorModeFixed)
-            painter.drawImage(x, y, characters[qGray(textImageBits[i])].image);
-        else {
-            QChar chr = characters[qGray(textImageBits[i])].chr;
-            QRgb foreground = textImageBits[i];
-            QImage image = this->drawChar(chr,
-                                          this->d->m_font,
-                                          fontSize,
-                                          foreground,
-                                          this->d->m_backgroundColor);
-            painter.drawImage(x, y, image);
+    bool fixedMode = this->d->m_mode == ColorModeFixed;
+    QRgb foregroundColor = this->d->m_foregroundColor;
+    QRgb backgroundColor = this->d->m_backgroundColor;
+    int glyphArea = cellWidth * cellHeight;
+    const quint8 *masks = glyphMasks.constData();
+
+    // Mean color of every character cell.
+    QVector<QRgb> cellColors(textWidth * textHeight);
+
+    AkVideoFilterRunner::globalRunner()->run(textHeight,
+                                             [&] (int yStart, int yEnd) {
+        for (int cy = yStart; cy < yEnd; cy++) {
+            QRgb *cellLine = cellColors.data() + cy * textWidth;
+
+            for (int cx = 0; cx < textWidth; cx++) {
+                int r = 0;
+                int g = 0;
+                int b = 0;
+
+                for (int j = 0; j < cellHeight; j++) {
+                    auto srcLine =
+                            reinterpret_cast<const QRgb *>(src.constScanLine(cy * cellHeight + j))
+                            + cx * cellWidth;
+
+                    for (int i = 0; i < cellWidth; i++) {
+                        QRgb pixel = srcLine[i];
+                        r += qRed(pixel);
+                        g += qGreen(pixel);
+                        b += qBlue(pixel);
+                    }
+                }
+
+                cellLine[cx] = qRgb(r / glyphArea, g / glyphArea, b / glyphArea);
+            }
         }
-    }
-
-    painter.end();
+    });
+
+    /* Blit the glyph matching each cell, blending foreground over background
+     * with the coverage mask.
+     */
+    AkVideoFilterRunner::globalRunner()->run(textHeight,
+                                             [&] (int yStart, int yEnd) {
+        for (int cy = yStart; cy < yEnd; cy++) {
+            const QRgb *cellLine = cellColors.constData() + cy * textWidth;
+
+            for (int cx = 0; cx < textWidth; cx++) {
+                QRgb mean = cellLine[cx];
+                const quint8 *mask = masks + qGray(mean) * glyphArea;
+                QRgb foreground = fixedMode? foregroundColor: mean;
+                int fr = qRed(foreground);
+                int fg = qGreen(foreground);
+                int fb = qBlue(foreground);
+                int br = qRed(backgroundColor);
+                int bg = qGreen(backgroundColor);
+                int bb = qBlue(backgroundColor);
+
+                for (int j = 0; j < cellHeight; j++) {
+                    auto dstLine =
+                            reinterpret_cast<QRgb *>(oFrame.scanLine(cy * cellHeight + j))
+                            + cx * cellWidth;
+                    const quint8 *maskLine = mask + j * cellWidth;
+
+                    for (int i = 0; i < cellWidth; i++) {
+                        int m = maskLine[i];
+                        dstLine[i] = qRgb((fr * m + br * (255 - m)) / 255,
+                                          (fg * m + bg * (255 - m)) / 255,
+                                          (fb * m + bb * (255 - m)) / 255);
+                    }
+                }
+            }
+        }
+    });
 
     auto oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
@@ -493,11 +549,7 @@ void CharifyElement::updateCharTable()
                                       this->d->m_foregroundColor,
                                       this->d->m_backgroundColor);
         int weight = this->imageWeight(image, this->d->m_reversed);
-
-        if (this->d->m_mode == ColorModeFixed)
-            characters.append(Character(chr, image, weight));
-        else
-            characters.append(Character(chr, QImage(), weight));
+        characters.append(Character(chr, QImage(), weight));
     }
 
     QMutexLocker(&this->d->m_mutex);
@@ -506,6 +558,7 @@ void CharifyElement::updateCharTable()
 
     if (characters.isEmpty()) {
         this->d->m_characters.clear();
+        this->d->m_glyphMasks.clear();
 
         return;
     }
@@ -517,6 +570,42 @@ void CharifyElement::updateCharTable()
         int c = i * (characters.size() - 1) / 255;
         this->d->m_characters[i] = characters[c];
     }
+
+    /* Rasterize every distinct glyph once as a white on black coverage mask
+     * and lay the 256 gray levels out contiguously, so the per frame work
+     * reduces to colorized blits from the atlas.
+     */
+    int glyphArea = fontSize.width() * fontSize.height();
+    this->d->m_glyphMasks.resize(256 * glyphArea);
+    QHash<QChar, QVector<quint8>> masks;
+
+    for (int i = 0; i < 256; i++) {
+        QChar chr = this->d->m_characters[i].chr;
+
+        if (!masks.contains(chr)) {
+            QImage image = this->drawChar(chr,
+                                          this->d->m_font,
+                                          fontSize,
+                                          qRgb(255, 255, 255),
+                                          qRgb(0, 0, 0));
+            QVector<quint8> mask(glyphArea);
+
+            for (int y = 0; y < fontSize.height(); y++) {
+                auto imageLine =
+                        reinterpret_cast<const QRgb *>(image.constScanLine(y));
+
+                for (int x = 0; x < fontSize.width(); x++)
+                    mask[x + y * fontSize.width()] =
+                            quint8(qGray(imageLine[x]));
+            }
+
+            masks[chr] = mask;
+        }
+
+        memcpy(this->d->m_glyphMasks.data() + i * glyphArea,
+               masks[chr].constData(),
+               size_t(glyphArea));
+    }
 }
 
 #include "moc_charifyelement.cpp"
@@ -20,8 +20,10 @@
 #include <QImage>
 #include <QQmlContext>
 #include <QtMath>
+#include <QVector>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akvideofilterrunner.h>
 
 #include "cinemaelement.h"
 
@@ -96,24 +98,48 @@ AkPacket CinemaElement::iStream(const AkPacket &packet)
     QImage oFrame(src.size(), src.format());
     int cy = src.height() >> 1;
 
+    /* Classify the rows once per frame and hoist the blend constants:
+     * the strip color and its alpha are the same for every darkened
+     * pixel, so the inner loop is three integer multiply-adds. Rows
+     * outside the strips stay a plain memcpy and the bands run on the
+     * worker pool. */
+    QVector<bool> striped(src.height());
+
     for (int y = 0; y < src.height(); y++) {
         qreal k = 1.0 - qAbs(y - cy) / qreal(cy);
-        auto iLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
-        QRgb *oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+        striped[y] = k <= this->m_stripSize;
+    }
 
-        if (k > this->m_stripSize)
-            memcpy(oLine, iLine, size_t(src.bytesPerLine()));
-        else
-            for (int x = 0; x < src.width(); x++) {
-                qreal a = qAlpha(this->m_stripColor) / 255.0;
+    int a = qAlpha(this->m_stripColor);
+    int sr = qRed(this->m_stripColor);
+    int sg = qGreen(this->m_stripColor);
+    int sb = qBlue(this->m_stripColor);
+    int width = src.width();
 
-                int r = int(a * (qRed(this->m_stripColor) - qRed(iLine[x])) + qRed(iLine[x]));
-                int g = int(a * (qGreen(this->m_stripColor) - qGreen(iLine[x])) + qGreen(iLine[x]));
-                int b = int(a * (qBlue(this->m_stripColor) - qBlue(iLine[x])) + qBlue(iLine[x]));
+    AkVideoFilterRunner::globalRunner()->run(src.height(),
+                                             [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            auto iLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
+            auto oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+
+            if (!striped[y]) {
+                memcpy(oLine, iLine, size_t(src.bytesPerLine()));
+
+                continue;
+            }
+
+            for (int x = 0; x < width; x++) {
+                int r = qRed(iLine[x]);
+                int g = qGreen(iLine[x]);
+                int b = qBlue(iLine[x]);
+                r += a * (sr - r) / 255;
+                g += a * (sg - g) / 255;
+                b += a * (sb - b) / 255;
 
                 oLine[x] = qRgba(r, g, b, qAlpha(iLine[x]));
             }
-    }
+        }
+    });
 
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
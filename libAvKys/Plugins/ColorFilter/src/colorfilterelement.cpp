@@ -22,6 +22,7 @@
 #include <QtMath>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akvideofilterrunner.h>
 
 #include "colorfilterelement.h"
 
@@ -138,44 +139,53 @@ AkPacket ColorFilterElement::iStream(const AkPacket &packet)
     src = src.convertToFormat(QImage::Format_ARGB32);
     QImage oFrame(src.size(), src.format());
 
-    for (int y = 0; y < src.height(); y++) {
-        const QRgb *srcLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
-        QRgb *dstLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+    int width = src.width();
+    int rf = qRed(this->m_color);
+    int gf = qGreen(this->m_color);
+    int bf = qBlue(this->m_color);
+    qreal radius = this->m_radius;
+    bool soft = this->m_soft;
 
-        for (int x = 0; x < src.width(); x++) {
-            int r = qRed(srcLine[x]);
-            int g = qGreen(srcLine[x]);
-            int b = qBlue(srcLine[x]);
+    // Compare squared distances, the root is only needed for softening.
+    qreal radius2 = radius < 0.0? -1.0: radius * radius;
 
-            int rf = qRed(this->m_color);
-            int gf = qGreen(this->m_color);
-            int bf = qBlue(this->m_color);
+    AkVideoFilterRunner::globalRunner()->run(src.height(),
+                                             [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            const QRgb *srcLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
+            QRgb *dstLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
 
-            int rd = r - rf;
-            int gd = g - gf;
-            int bd = b - bf;
+            for (int x = 0; x < width; x++) {
+                int r = qRed(srcLine[x]);
+                int g = qGreen(srcLine[x]);
+                int b = qBlue(srcLine[x]);
 
-            qreal k = sqrt(rd * rd + gd * gd + bd * bd);
+                int rd = r - rf;
+                int gd = g - gf;
+                int bd = b - bf;
 
-            if (k <= this->m_radius) {
-                if (this->m_soft) {
-                    qreal p = k / this->m_radius;
+                int k2 = rd * rd + gd * gd + bd * bd;
 
-                    int gray = qGray(srcLine[x]);
+                if (k2 <= radius2) {
+                    if (soft) {
+                        qreal p = sqrt(qreal(k2)) / radius;
+
+                        int gray = qGray(srcLine[x]);
 
-                    r = int(p * (gray - r) + r);
-                    g = int(p * (gray - g) + g);
-                    b = int(p * (gray - b) + b);
+                        r = int(p * (gray - r) + r);
+                        g = int(p * (gray - g) + g);
+                        b = int(p * (gray - b) + b);
 
-                    dstLine[x] = qRgba(r, g, b, qAlpha(srcLine[x]));
-                } else
-                    dstLine[x] = srcLine[x];
-            } else {
-                int gray = qGray(srcLine[x]);
-                dstLine[x] = qRgba(gray, gray, gray, qAlpha(srcLine[x]));
+                        dstLine[x] = qRgba(r, g, b, qAlpha(srcLine[x]));
+                    } else
+                        dstLine[x] = srcLine[x];
+                } else {
+                    int gray = qGray(srcLine[x]);
+                    dstLine[x] = qRgba(gray, gray, gray, qAlpha(srcLine[x]));
+                }
             }
         }
-    }
+    });
 
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
@@ -22,6 +22,7 @@
 #include <QtMath>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akvideofilterrunner.h>
 
 #include "colorreplaceelement.h"
 
@@ -138,41 +139,51 @@ AkPacket ColorReplaceElement::iStream(const AkPacket &packet)
     src = src.convertToFormat(QImage::Format_ARGB32);
     QImage oFrame(src.size(), src.format());
 
-    for (int y = 0; y < src.height(); y++) {
-        const QRgb *srcLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
-        QRgb *dstLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
-
-        for (int x = 0; x < src.width(); x++) {
-            int r = qRed(srcLine[x]);
-            int g = qGreen(srcLine[x]);
-            int b = qBlue(srcLine[x]);
-
-            int rf = qRed(this->m_from);
-            int gf = qGreen(this->m_from);
-            int bf = qBlue(this->m_from);
-
-            int rd = r - rf;
-            int gd = g - gf;
-            int bd = b - bf;
-
-            qreal k = sqrt(rd * rd + gd * gd + bd * bd);
-
-            if (k <= this->m_radius) {
-                qreal p = k / this->m_radius;
-
-                int rt = qRed(this->m_to);
-                int gt = qGreen(this->m_to);
-                int bt = qBlue(this->m_to);
-
-                r = int(p * (r - rt) + rt);
-                g = int(p * (g - gt) + gt);
-                b = int(p * (b - bt) + bt);
-
-                dstLine[x] = qRgba(r, g, b, qAlpha(srcLine[x]));
-            } else
-                dstLine[x] = srcLine[x];
+    /* Hoist the colors out of the loop and match on the squared distance
+     * in integers; the square root only runs for the pixels inside the
+     * radius, which in a chroma key are the minority. The branch-light
+     * integer loop vectorizes, and the rows go to the worker pool. */
+    int rf = qRed(this->m_from);
+    int gf = qGreen(this->m_from);
+    int bf = qBlue(this->m_from);
+    int rt = qRed(this->m_to);
+    int gt = qGreen(this->m_to);
+    int bt = qBlue(this->m_to);
+    qreal radius = this->m_radius;
+    qreal radius2 = radius * radius;
+    int width = src.width();
+
+    AkVideoFilterRunner::globalRunner()->run(src.height(),
+                                             [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            auto srcLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
+            auto dstLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+
+            for (int x = 0; x < width; x++) {
+                int r = qRed(srcLine[x]);
+                int g = qGreen(srcLine[x]);
+                int b = qBlue(srcLine[x]);
+
+                int rd = r - rf;
+                int gd = g - gf;
+                int bd = b - bf;
+
+                int k2 = rd * rd + gd * gd + bd * bd;
+
+                if (radius >= 0.0 && k2 <= radius2) {
+                    qreal p = radius > 0.0? sqrt(k2) / radius: 0.0;
+
+                    r = int(p * (r - rt) + rt);
+                    g = int(p * (g - gt) + gt);
+                    b = int(p * (b - bt) + bt);
+
+                    dstLine[x] = qRgba(r, g, b, qAlpha(srcLine[x]));
+                } else {
+                    dstLine[x] = srcLine[x];
+                }
+            }
         }
-    }
+    });
 
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
@@ -23,6 +23,7 @@
 #include <QStandardPaths>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akvideofilterrunner.h>
 
 #include "colortapelement.h"
 
@@ -123,24 +124,37 @@ AkPacket ColorTapElement::iStream(const AkPacket &packet)
     QImage oFrame(src.size(), src.format());
     auto tableBits = reinterpret_cast<const QRgb *>(this->d->m_table.constBits());
 
-    for (int y = 0; y < src.height(); y++) {
-        auto srcLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
-        auto dstLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+    /* Split the table into per-channel tables of already shifted
+     * components, so a pixel is three loads and two ORs, and drop the
+     * lock before scanning the frame instead of holding it for the
+     * whole pass. */
+    quint32 rTable[256];
+    quint32 gTable[256];
+    quint32 bTable[256];
+
+    for (int i = 0; i < 256; i++) {
+        rTable[i] = quint32(qRed(tableBits[i])) << 16;
+        gTable[i] = quint32(qGreen(tableBits[i])) << 8;
+        bTable[i] = quint32(qBlue(tableBits[i]));
+    }
 
-        for (int x = 0; x < src.width(); x++) {
-            int r = qRed(srcLine[x]);
-            int g = qGreen(srcLine[x]);
-            int b = qBlue(srcLine[x]);
+    this->d->m_mutex.unlock();
 
-            int ro = qRed(tableBits[r]);
-            int go = qGreen(tableBits[g]);
-            int bo = qBlue(tableBits[b]);
+    int width = src.width();
 
-            dstLine[x] = qRgb(ro, go, bo);
-        }
-    }
+    AkVideoFilterRunner::globalRunner()->run(src.height(),
+                                             [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            auto srcLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
+            auto dstLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
 
-    this->d->m_mutex.unlock();
+            for (int x = 0; x < width; x++)
+                dstLine[x] = 0xff000000
+                             | rTable[qRed(srcLine[x])]
+                             | gTable[qGreen(srcLine[x])]
+                             | bTable[qBlue(srcLine[x])];
+        }
+    });
 
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
@@ -21,6 +21,7 @@
 #include <QImage>
 #include <QQmlContext>
 #include <akutils.h>
+#include <akcolorlut.h>
 #include <akpacket.h>
 
 #include "colortransformelement.h"
@@ -29,6 +30,7 @@ class ColorTransformElementPrivate
 {
     public:
         QVector<qreal> m_kernel;
+        AkColorLut m_lut;
 };
 
 ColorTransformElement::ColorTransformElement(): AkElement()
@@ -40,6 +42,8 @@ ColorTransformElement::ColorTransformElement(): AkElement()
         0, 1, 0, 0,
         0, 0, 1, 0
     };
+
+    this->d->m_lut.setKernel(this->d->m_kernel);
 }
 
 ColorTransformElement::~ColorTransformElement()
@@ -84,6 +88,7 @@ void ColorTransformElement::setKernel(const QVariantList &kernel)
         return;
 
     this->d->m_kernel = k;
+    this->d->m_lut.setKernel(k);
     emit this->kernelChanged(kernel);
 }
 
@@ -110,28 +115,10 @@ AkPacket ColorTransformElement::iStream(const AkPacket &packet)
 
     src = src.convertToFormat(QImage::Format_ARGB32);
     QImage oFrame(src.size(), src.format());
-    auto kernel = this->d->m_kernel;
-
-    for (int y = 0; y < src.height(); y++) {
-        auto srcLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
-        auto dstLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
-
-        for (int x = 0; x < src.width(); x++) {
-            int r = qRed(srcLine[x]);
-            int g = qGreen(srcLine[x]);
-            int b = qBlue(srcLine[x]);
-
-            int rt = int(r * kernel[0] + g * kernel[1] + b * kernel[2]  + kernel[3]);
-            int gt = int(r * kernel[4] + g * kernel[5] + b * kernel[6]  + kernel[7]);
-            int bt = int(r * kernel[8] + g * kernel[9] + b * kernel[10] + kernel[11]);
-
-            rt = qBound(0, rt, 255);
-            gt = qBound(0, gt, 255);
-            bt = qBound(0, bt, 255);
 
-            dstLine[x] = qRgba(rt, gt, bt, qAlpha(srcLine[x]));
-        }
-    }
+    // The kernel compiles into additive tables in the setter, each frame
+    // reduces to lookups.
+    this->d->m_lut.apply(src, oFrame);
 
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
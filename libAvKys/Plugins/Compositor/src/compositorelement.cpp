@@ -0,0 +1,291 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QImage>
+#include <QMutex>
+#include <akutils.h>
+#include <akpacket.h>
+#include <akvideofilterrunner.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "compositorelement.h"
+
+// Overlays buffer at most this many frames while waiting for the base
+// layer to catch up.
+#define COMPOSITOR_QUEUE_SIZE 8
+
+inline qreal packetTime(const AkPacket &packet)
+{
+    return packet.pts() * packet.timeBase().value();
+}
+
+/* Blend one row of premultiplied overlay pixels over an opaque base row.
+ * 'opacity' is in [0, 256]. With a premultiplied source the operation is
+ * the same for all four channels,
+ *
+ *     out = src * opacity / 256 + dst * (256 - alpha') / 256
+ *
+ * where alpha' is the source alpha already scaled by the opacity, which
+ * is what makes it vectorizable without per-channel special cases.
+ */
+inline void blendRow(const QRgb *src, QRgb *dst, int width, int opacity)
+{
+    int x = 0;
+
+#if defined(__SSE2__)
+    __m128i zero = _mm_setzero_si128();
+    __m128i op = _mm_set1_epi16(qint16(opacity));
+    __m128i full = _mm_set1_epi16(256);
+
+    for (; x < width - 3; x += 4) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + x));
+
+        __m128i sLo = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(s, zero), op), 8);
+        __m128i sHi = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(s, zero), op), 8);
+
+        // Broadcast each pixel's alpha to its four channels.
+        __m128i aLo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(sLo, _MM_SHUFFLE(3, 3, 3, 3)),
+                                          _MM_SHUFFLE(3, 3, 3, 3));
+        __m128i aHi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(sHi, _MM_SHUFFLE(3, 3, 3, 3)),
+                                          _MM_SHUFFLE(3, 3, 3, 3));
+
+        __m128i dLo = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero),
+                                                     _mm_sub_epi16(full, aLo)), 8);
+        __m128i dHi = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero),
+                                                     _mm_sub_epi16(full, aHi)), 8);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x),
+                         _mm_packus_epi16(_mm_add_epi16(sLo, dLo),
+                                          _mm_add_epi16(sHi, dHi)));
+    }
+#endif
+
+    for (; x < width; x++) {
+        QRgb sp = src[x];
+        QRgb dp = dst[x];
+        int t = 256 - ((qAlpha(sp) * opacity) >> 8);
+
+        dst[x] = qRgba(qMin(((qRed(sp) * opacity) >> 8)
+                            + ((qRed(dp) * t) >> 8), 255),
+                       qMin(((qGreen(sp) * opacity) >> 8)
+                            + ((qGreen(dp) * t) >> 8), 255),
+                       qMin(((qBlue(sp) * opacity) >> 8)
+                            + ((qBlue(dp) * t) >> 8), 255),
+                       qMin(((qAlpha(sp) * opacity) >> 8)
+                            + ((qAlpha(dp) * t) >> 8), 255));
+    }
+}
+
+typedef QPair<qreal, QImage> CompositorFrame;
+
+class CompositorLayer
+{
+    public:
+        QRect m_rect;
+        int m_opacity;
+        QList<CompositorFrame> m_frames;
+
+        CompositorLayer():
+            m_opacity(256)
+        {
+        }
+};
+
+class CompositorElementPrivate
+{
+    public:
+        QMutex m_mutex;
+        QMap<int, CompositorLayer> m_layers;
+        int m_latency;
+
+        CompositorElementPrivate():
+            m_latency(500)
+        {
+        }
+};
+
+CompositorElement::CompositorElement(): AkElement()
+{
+    this->d = new CompositorElementPrivate;
+}
+
+CompositorElement::~CompositorElement()
+{
+    delete this->d;
+}
+
+int CompositorElement::latency() const
+{
+    return this->d->m_latency;
+}
+
+QRect CompositorElement::layerRect(int input) const
+{
+    QMutexLocker locker(&this->d->m_mutex);
+
+    return this->d->m_layers.value(input).m_rect;
+}
+
+qreal CompositorElement::layerOpacity(int input) const
+{
+    QMutexLocker locker(&this->d->m_mutex);
+
+    return this->d->m_layers.value(input).m_opacity / 256.0;
+}
+
+void CompositorElement::stateChange(AkElement::ElementState from,
+                                    AkElement::ElementState to)
+{
+    Q_UNUSED(from)
+
+    if (to == AkElement::ElementStateNull) {
+        QMutexLocker locker(&this->d->m_mutex);
+
+        for (auto &layer: this->d->m_layers)
+            layer.m_frames.clear();
+    }
+}
+
+void CompositorElement::setLatency(int latency)
+{
+    if (this->d->m_latency == latency)
+        return;
+
+    this->d->m_latency = latency;
+    emit this->latencyChanged(latency);
+}
+
+void CompositorElement::resetLatency()
+{
+    this->setLatency(500);
+}
+
+void CompositorElement::setLayerRect(int input, const QRect &rect)
+{
+    QMutexLocker locker(&this->d->m_mutex);
+    auto &layer = this->d->m_layers[input];
+    layer.m_rect = rect;
+
+    // Queued frames were scaled for the previous rect.
+    layer.m_frames.clear();
+}
+
+void CompositorElement::setLayerOpacity(int input, qreal opacity)
+{
+    QMutexLocker locker(&this->d->m_mutex);
+    this->d->m_layers[input].m_opacity =
+            int(qBound(0.0, opacity, 1.0) * 256);
+}
+
+void CompositorElement::removeLayer(int input)
+{
+    QMutexLocker locker(&this->d->m_mutex);
+    this->d->m_layers.remove(input);
+}
+
+AkPacket CompositorElement::iStream(const AkPacket &packet)
+{
+    if (packet.index() > 0) {
+        /* Overlay path: premultiply and scale now, at the overlay's own
+         * frame rate, then queue the frame for the next base frame.
+         */
+        QImage frame = AkUtils::packetToImage(packet);
+
+        if (frame.isNull())
+            return AkPacket();
+
+        frame = frame.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+        QMutexLocker locker(&this->d->m_mutex);
+        auto &layer = this->d->m_layers[packet.index()];
+
+        if (layer.m_rect.isValid()
+            && layer.m_rect.size() != frame.size())
+            frame = frame.scaled(layer.m_rect.size(),
+                                 Qt::IgnoreAspectRatio,
+                                 Qt::SmoothTransformation);
+
+        layer.m_frames << CompositorFrame(packetTime(packet), frame);
+
+        while (layer.m_frames.size() > COMPOSITOR_QUEUE_SIZE)
+            layer.m_frames.removeFirst();
+
+        return AkPacket();
+    }
+
+    QImage oFrame = AkUtils::packetToImage(packet);
+
+    if (oFrame.isNull())
+        return AkPacket();
+
+    oFrame = oFrame.convertToFormat(QImage::Format_ARGB32);
+    qreal time = packetTime(packet);
+
+    this->d->m_mutex.lock();
+    qreal latency = this->d->m_latency / 1000.0;
+
+    for (auto &layer: this->d->m_layers) {
+        // Advance each queue to the newest frame not ahead of the base.
+        while (layer.m_frames.size() > 1
+               && layer.m_frames[1].first <= time)
+            layer.m_frames.removeFirst();
+
+        if (layer.m_frames.isEmpty())
+            continue;
+
+        // A frame lagging more than the latency window is skipped, a
+        // stalled overlay must not freeze stale content over live video.
+        if (time - layer.m_frames.first().first > latency)
+            continue;
+
+        const QImage &frame = layer.m_frames.first().second;
+        QPoint pos = layer.m_rect.isValid()?
+                         layer.m_rect.topLeft(): QPoint(0, 0);
+        QRect target = QRect(pos, frame.size()) & oFrame.rect();
+
+        if (target.isEmpty())
+            continue;
+
+        int srcX = target.x() - pos.x();
+        int srcY = target.y() - pos.y();
+        int width = target.width();
+        int opacity = layer.m_opacity;
+
+        AkVideoFilterRunner::globalRunner()->run(target.height(),
+                                                 [&] (int yStart, int yEnd) {
+            for (int y = yStart; y < yEnd; y++) {
+                auto srcLine = reinterpret_cast<const QRgb *>(frame.constScanLine(y + srcY))
+                             + srcX;
+                auto dstLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y + target.y()))
+                             + target.x();
+                blendRow(srcLine, dstLine, width, opacity);
+            }
+        });
+    }
+
+    this->d->m_mutex.unlock();
+
+    AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
+    akSend(oPacket)
+}
+
+#include "moc_compositorelement.cpp"
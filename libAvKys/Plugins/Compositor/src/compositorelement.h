@@ -0,0 +1,77 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef COMPOSITORELEMENT_H
+#define COMPOSITORELEMENT_H
+
+#include <akelement.h>
+
+class CompositorElementPrivate;
+
+/* Multi input video compositor.
+ *
+ * The packet index selects the layer, following the same convention
+ * Multiplex uses for stream routing: index 0 is the base layer, every
+ * higher index is an overlay blended over it in index order. Each overlay
+ * has a target rect and an opacity, and overlay frames are matched to the
+ * base frame by PTS, with a configurable latency bounding how far an
+ * overlay may lag before it's skipped.
+ *
+ * Overlays are premultiplied and scaled when they arrive, at the
+ * overlay's own frame rate, so the per-base-frame cost is just the
+ * blend loop.
+ */
+class CompositorElement: public AkElement
+{
+    Q_OBJECT
+    Q_PROPERTY(int latency
+               READ latency
+               WRITE setLatency
+               RESET resetLatency
+               NOTIFY latencyChanged)
+
+    public:
+        explicit CompositorElement();
+        ~CompositorElement();
+
+        Q_INVOKABLE int latency() const;
+        Q_INVOKABLE QRect layerRect(int input) const;
+        Q_INVOKABLE qreal layerOpacity(int input) const;
+
+    private:
+        CompositorElementPrivate *d;
+
+    protected:
+        void stateChange(AkElement::ElementState from,
+                         AkElement::ElementState to);
+
+    signals:
+        void latencyChanged(int latency);
+
+    public slots:
+        void setLatency(int latency);
+        void resetLatency();
+        void setLayerRect(int input, const QRect &rect);
+        void setLayerOpacity(int input, qreal opacity);
+        void removeLayer(int input);
+
+        AkPacket iStream(const AkPacket &packet);
+};
+
+#endif // COMPOSITORELEMENT_H
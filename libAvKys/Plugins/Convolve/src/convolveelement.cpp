@@ -27,6 +27,7 @@
 #include <akpacket.h>
 
 #include "convolveelement.h"
+#include "convolveplan.h"
 
 class ConvolveElementPrivate
 {
@@ -35,6 +36,7 @@ class ConvolveElementPrivate
         QSize m_kernelSize;
         AkFrac m_factor;
         QMutex m_mutex;
+        ConvolvePlan m_plan;
         int m_bias;
 
         ConvolveElementPrivate():
@@ -185,60 +187,18 @@ AkPacket ConvolveElement::iStream(const AkPacket &packet)
 
     this->d->m_mutex.lock();
     QVector<int> kernel = this->d->m_kernel;
-    const int *kernelBits = kernel.constData();
     qint64 factorNum = this->d->m_factor.num();
     qint64 factorDen = this->d->m_factor.den();
-    int kernelWidth = this->d->m_kernelSize.width();
-    int kernelHeight = this->d->m_kernelSize.height();
+    QSize kernelSize = this->d->m_kernelSize;
+    int bias = this->d->m_bias;
     this->d->m_mutex.unlock();
 
-    int minI = -(kernelWidth - 1) / 2;
-    int maxI = (kernelWidth + 1) / 2;
-    int minJ = -(kernelHeight - 1) / 2;
-    int maxJ = (kernelHeight + 1) / 2;
-
-    for (int y = 0; y < src.height(); y++) {
-        auto iLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
-        auto oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
-
-        for (int x = 0; x < src.width(); x++) {
-            int r = 0;
-            int g = 0;
-            int b = 0;
-
-            for (int j = minJ, k = 0; j < maxJ; j++) {
-                int yp = qBound(0, y + j, src.height() - 1);
-                auto iLine =
-                        reinterpret_cast<const QRgb *>(src.constScanLine(yp));
-
-                for (int i = minI; i < maxI; i++, k++) {
-                    int xp = qBound(0, x + i, src.width() - 1);
-
-                    if (kernelBits[k]) {
-                        r += kernelBits[k] * qRed(iLine[xp]);
-                        g += kernelBits[k] * qGreen(iLine[xp]);
-                        b += kernelBits[k] * qBlue(iLine[xp]);
-                    }
-                }
-            }
-
-            if (factorNum) {
-                r = int(factorNum * r / factorDen + this->d->m_bias);
-                g = int(factorNum * g / factorDen + this->d->m_bias);
-                b = int(factorNum * b / factorDen + this->d->m_bias);
-
-                r = qBound(0, r, 255);
-                g = qBound(0, g, 255);
-                b = qBound(0, b, 255);
-            } else {
-                r = 255;
-                g = 255;
-                b = 255;
-            }
-
-            oLine[x] = qRgba(r, g, b, qAlpha(iLine[x]));
-        }
-    }
+    // The plan only depends on the kernel and the frame geometry, so a
+    // live pipeline compiles it once and reuses it frame after frame.
+    if (!this->d->m_plan.matches(kernel, kernelSize, src))
+        this->d->m_plan.compile(kernel, kernelSize, src);
+
+    this->d->m_plan.apply(src, oFrame, factorNum, factorDen, bias);
 
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
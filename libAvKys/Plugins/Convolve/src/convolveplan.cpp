@@ -0,0 +1,377 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <akvideofilterrunner.h>
+
+#include "convolveplan.h"
+
+ConvolvePlan::ConvolvePlan():
+    m_width(0),
+    m_height(0),
+    m_stride(0),
+    m_minI(0),
+    m_maxI(0),
+    m_minJ(0),
+    m_maxJ(0),
+    m_separable(false),
+    m_separableScale(1)
+{
+}
+
+bool ConvolvePlan::matches(const QVector<int> &kernel,
+                           const QSize &kernelSize,
+                           const QImage &frame) const
+{
+    return this->m_kernel == kernel
+           && this->m_kernelSize == kernelSize
+           && this->m_width == frame.width()
+           && this->m_height == frame.height()
+           && this->m_stride == frame.bytesPerLine() / int(sizeof(QRgb));
+}
+
+void ConvolvePlan::compile(const QVector<int> &kernel,
+                           const QSize &kernelSize,
+                           const QImage &frame)
+{
+    this->m_kernel = kernel;
+    this->m_kernelSize = kernelSize;
+    this->m_width = frame.width();
+    this->m_height = frame.height();
+    this->m_stride = frame.bytesPerLine() / int(sizeof(QRgb));
+
+    int kw = kernelSize.width();
+    int kh = kernelSize.height();
+    this->m_minI = -(kw - 1) / 2;
+    this->m_maxI = (kw + 1) / 2;
+    this->m_minJ = -(kh - 1) / 2;
+    this->m_maxJ = (kh + 1) / 2;
+
+    // Flatten the kernel to its non-zero taps, with the offsets resolved
+    // against the frame stride so the interior loop is a plain gather.
+    this->m_taps.clear();
+
+    for (int j = 0; j < kh; j++)
+        for (int i = 0; i < kw; i++) {
+            int weight = kernel.value(j * kw + i);
+
+            if (weight)
+                this->m_taps << Tap {
+                    (j + this->m_minJ) * this->m_stride + i + this->m_minI,
+                    weight
+                };
+        }
+
+    /* Rank-one test: with a non-zero pivot at (j0, i0), the kernel is
+     * separable iff every 2x2 minor through the pivot vanishes. Then
+     * K = (column x row) / pivot exactly in integers, and the division by
+     * the pivot is folded into the final factor so the output stays
+     * bit-exact with the direct form.
+     */
+    this->m_separable = false;
+    this->m_separableScale = 1;
+    int pivotJ = -1;
+    int pivotI = -1;
+
+    for (int k = 0; k < kernel.size() && pivotJ < 0; k++)
+        if (kernel[k]) {
+            pivotJ = k / kw;
+            pivotI = k % kw;
+        }
+
+    if (pivotJ >= 0 && kw > 1 && kh > 1) {
+        int pivot = kernel[pivotJ * kw + pivotI];
+        bool separable = true;
+
+        for (int j = 0; j < kh && separable; j++)
+            for (int i = 0; i < kw; i++)
+                if (qint64(kernel[j * kw + i]) * pivot
+                    != qint64(kernel[j * kw + pivotI])
+                       * kernel[pivotJ * kw + i]) {
+                    separable = false;
+
+                    break;
+                }
+
+        if (separable) {
+            this->m_rowKernel.resize(kw);
+            this->m_colKernel.resize(kh);
+
+            for (int i = 0; i < kw; i++)
+                this->m_rowKernel[i] = kernel[pivotJ * kw + i];
+
+            for (int j = 0; j < kh; j++)
+                this->m_colKernel[j] = kernel[j * kw + pivotI];
+
+            this->m_separable = true;
+            this->m_separableScale = pivot;
+            this->m_scratch.resize(3 * this->m_width * this->m_height);
+        }
+    }
+}
+
+void ConvolvePlan::apply(const QImage &src,
+                         QImage &dst,
+                         qint64 factorNum,
+                         qint64 factorDen,
+                         int bias)
+{
+    if (this->m_separable)
+        this->applySeparable(src, dst, factorNum, factorDen, bias);
+    else
+        this->applyGeneric(src, dst, factorNum, factorDen, bias);
+}
+
+void ConvolvePlan::convolvePixel(const QRgb *srcBits,
+                                 QRgb *oLine,
+                                 int x,
+                                 int y,
+                                 qint64 factorNum,
+                                 qint64 factorDen,
+                                 int bias) const
+{
+    int r = 0;
+    int g = 0;
+    int b = 0;
+
+    for (int j = this->m_minJ, k = 0; j < this->m_maxJ; j++) {
+        int yp = qBound(0, y + j, this->m_height - 1);
+        auto iLine = srcBits + yp * this->m_stride;
+
+        for (int i = this->m_minI; i < this->m_maxI; i++, k++) {
+            int weight = this->m_kernel[k];
+
+            if (weight) {
+                int xp = qBound(0, x + i, this->m_width - 1);
+                r += weight * qRed(iLine[xp]);
+                g += weight * qGreen(iLine[xp]);
+                b += weight * qBlue(iLine[xp]);
+            }
+        }
+    }
+
+    if (factorNum) {
+        r = int(factorNum * r / factorDen + bias);
+        g = int(factorNum * g / factorDen + bias);
+        b = int(factorNum * b / factorDen + bias);
+        r = qBound(0, r, 255);
+        g = qBound(0, g, 255);
+        b = qBound(0, b, 255);
+    } else {
+        r = 255;
+        g = 255;
+        b = 255;
+    }
+
+    auto alpha = qAlpha(srcBits[x + y * this->m_stride]);
+    oLine[x] = qRgba(r, g, b, alpha);
+}
+
+void ConvolvePlan::applyGeneric(const QImage &src,
+                                QImage &dst,
+                                qint64 factorNum,
+                                qint64 factorDen,
+                                int bias) const
+{
+    auto srcBits = reinterpret_cast<const QRgb *>(src.constBits());
+    int xMin = qMin(-this->m_minI, this->m_width);
+    int xMax = qMax(this->m_width - this->m_maxI + 1, xMin);
+
+    AkVideoFilterRunner::globalRunner()->run(this->m_height,
+                                             [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            auto oLine = reinterpret_cast<QRgb *>(dst.scanLine(y));
+
+            // Rows clipped by the frame border keep the clamped taps.
+            if (y + this->m_minJ < 0
+                || y + this->m_maxJ - 1 >= this->m_height) {
+                for (int x = 0; x < this->m_width; x++)
+                    this->convolvePixel(srcBits, oLine, x, y,
+                                        factorNum, factorDen, bias);
+
+                continue;
+            }
+
+            for (int x = 0; x < xMin; x++)
+                this->convolvePixel(srcBits, oLine, x, y,
+                                    factorNum, factorDen, bias);
+
+            auto center = srcBits + y * this->m_stride;
+
+            for (int x = xMin; x < xMax; x++) {
+                int r = 0;
+                int g = 0;
+                int b = 0;
+
+                for (const Tap &tap: this->m_taps) {
+                    auto pixel = center[x + tap.offset];
+                    r += tap.weight * qRed(pixel);
+                    g += tap.weight * qGreen(pixel);
+                    b += tap.weight * qBlue(pixel);
+                }
+
+                if (factorNum) {
+                    r = int(factorNum * r / factorDen + bias);
+                    g = int(factorNum * g / factorDen + bias);
+                    b = int(factorNum * b / factorDen + bias);
+                    r = qBound(0, r, 255);
+                    g = qBound(0, g, 255);
+                    b = qBound(0, b, 255);
+                } else {
+                    r = 255;
+                    g = 255;
+                    b = 255;
+                }
+
+                oLine[x] = qRgba(r, g, b, qAlpha(center[x]));
+            }
+
+            for (int x = xMax; x < this->m_width; x++)
+                this->convolvePixel(srcBits, oLine, x, y,
+                                    factorNum, factorDen, bias);
+        }
+    });
+}
+
+void ConvolvePlan::applySeparable(const QImage &src,
+                                  QImage &dst,
+                                  qint64 factorNum,
+                                  qint64 factorDen,
+                                  int bias)
+{
+    auto srcBits = reinterpret_cast<const QRgb *>(src.constBits());
+    auto scratch = this->m_scratch.data();
+    int kw = this->m_kernelSize.width();
+    int kh = this->m_kernelSize.height();
+    auto rowKernel = this->m_rowKernel.constData();
+    auto colKernel = this->m_colKernel.constData();
+    int xMin = qMin(-this->m_minI, this->m_width);
+    int xMax = qMax(this->m_width - this->m_maxI + 1, xMin);
+    auto runner = AkVideoFilterRunner::globalRunner();
+
+    // Horizontal pass, every row is independent.
+    runner->run(this->m_height, [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            auto iLine = srcBits + y * this->m_stride;
+            auto sLine = scratch + 3 * y * this->m_width;
+
+            auto sumPixel = [&] (int x) {
+                int r = 0;
+                int g = 0;
+                int b = 0;
+
+                for (int i = 0; i < kw; i++) {
+                    int xp = qBound(0, x + this->m_minI + i, this->m_width - 1);
+                    auto pixel = iLine[xp];
+                    r += rowKernel[i] * qRed(pixel);
+                    g += rowKernel[i] * qGreen(pixel);
+                    b += rowKernel[i] * qBlue(pixel);
+                }
+
+                sLine[3 * x] = r;
+                sLine[3 * x + 1] = g;
+                sLine[3 * x + 2] = b;
+            };
+
+            for (int x = 0; x < xMin; x++)
+                sumPixel(x);
+
+            for (int x = xMin; x < xMax; x++) {
+                auto pixel = iLine + x + this->m_minI;
+                int r = 0;
+                int g = 0;
+                int b = 0;
+
+                for (int i = 0; i < kw; i++) {
+                    r += rowKernel[i] * qRed(pixel[i]);
+                    g += rowKernel[i] * qGreen(pixel[i]);
+                    b += rowKernel[i] * qBlue(pixel[i]);
+                }
+
+                sLine[3 * x] = r;
+                sLine[3 * x + 1] = g;
+                sLine[3 * x + 2] = b;
+            }
+
+            for (int x = xMax; x < this->m_width; x++)
+                sumPixel(x);
+        }
+    });
+
+    // Vertical pass over the horizontal sums. The pivot the kernel was
+    // factored by is folded into the divisor, keeping the integer
+    // truncation identical to the direct convolution.
+    qint64 den = factorDen * this->m_separableScale;
+
+    runner->run(this->m_height, [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            auto iLine = srcBits + y * this->m_stride;
+            auto oLine = reinterpret_cast<QRgb *>(dst.scanLine(y));
+            bool interior = y + this->m_minJ >= 0
+                            && y + this->m_maxJ - 1 < this->m_height;
+
+            for (int x = 0; x < this->m_width; x++) {
+                qint64 r = 0;
+                qint64 g = 0;
+                qint64 b = 0;
+
+                if (interior) {
+                    auto sColumn = scratch
+                                   + 3 * ((y + this->m_minJ) * this->m_width
+                                          + x);
+
+                    for (int j = 0; j < kh; j++) {
+                        r += qint64(colKernel[j]) * sColumn[0];
+                        g += qint64(colKernel[j]) * sColumn[1];
+                        b += qint64(colKernel[j]) * sColumn[2];
+                        sColumn += 3 * this->m_width;
+                    }
+                } else {
+                    for (int j = 0; j < kh; j++) {
+                        int yp = qBound(0, y + this->m_minJ + j,
+                                        this->m_height - 1);
+                        auto sPixel = scratch
+                                      + 3 * (yp * this->m_width + x);
+                        r += qint64(colKernel[j]) * sPixel[0];
+                        g += qint64(colKernel[j]) * sPixel[1];
+                        b += qint64(colKernel[j]) * sPixel[2];
+                    }
+                }
+
+                int ir;
+                int ig;
+                int ib;
+
+                if (factorNum) {
+                    ir = int(factorNum * r / den + bias);
+                    ig = int(factorNum * g / den + bias);
+                    ib = int(factorNum * b / den + bias);
+                    ir = qBound(0, ir, 255);
+                    ig = qBound(0, ig, 255);
+                    ib = qBound(0, ib, 255);
+                } else {
+                    ir = 255;
+                    ig = 255;
+                    ib = 255;
+                }
+
+                oLine[x] = qRgba(ir, ig, ib, qAlpha(iLine[x]));
+            }
+        }
+    });
+}
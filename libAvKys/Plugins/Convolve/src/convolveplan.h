@@ -0,0 +1,100 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef CONVOLVEPLAN_H
+#define CONVOLVEPLAN_H
+
+#include <QImage>
+#include <QSize>
+#include <QVector>
+
+/* Compiled execution plan for one (kernel, frame geometry) pair. The plan
+ * decides once how the kernel is applied — separable row/column passes when
+ * the kernel has rank one, a flat list of non-zero taps otherwise — and
+ * splits every row into clamped edges and a branch-free interior, so the
+ * per-pixel loops carry no bounds checks. The factor, bias and clamping are
+ * applied at run time and don't invalidate the plan.
+ */
+class ConvolvePlan
+{
+    public:
+        ConvolvePlan();
+
+        bool matches(const QVector<int> &kernel,
+                     const QSize &kernelSize,
+                     const QImage &frame) const;
+        void compile(const QVector<int> &kernel,
+                     const QSize &kernelSize,
+                     const QImage &frame);
+        void apply(const QImage &src,
+                   QImage &dst,
+                   qint64 factorNum,
+                   qint64 factorDen,
+                   int bias);
+
+    private:
+        class Tap
+        {
+            public:
+                int offset;
+                int weight;
+        };
+
+        QVector<int> m_kernel;
+        QSize m_kernelSize;
+        int m_width;
+        int m_height;
+        int m_stride;
+
+        // Interior limits, outside of them the taps are clamped.
+        int m_minI;
+        int m_maxI;
+        int m_minJ;
+        int m_maxJ;
+
+        // Rank-one decomposition, valid when m_separable is set.
+        bool m_separable;
+        QVector<int> m_rowKernel;
+        QVector<int> m_colKernel;
+        int m_separableScale;
+        QVector<int> m_scratch;
+
+        // Non-zero taps with offsets resolved against the frame stride.
+        QVector<Tap> m_taps;
+
+        void convolvePixel(const QRgb *srcBits,
+                           QRgb *oLine,
+                           int x,
+                           int y,
+                           qint64 factorNum,
+                           qint64 factorDen,
+                           int bias) const;
+        void applySeparable(const QImage &src,
+                            QImage &dst,
+                            qint64 factorNum,
+                            qint64 factorDen,
+                            int bias);
+        void applyGeneric(const QImage &src,
+                          QImage &dst,
+                          qint64 factorNum,
+                          qint64 factorDen,
+                          int bias) const;
+};
+
+#endif // CONVOLVEPLAN_H
@@ -26,6 +26,8 @@
 #include <QtMath>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akframering.h>
+#include <akvideofilterrunner.h>
 
 #include "delaygrabelement.h"
 
@@ -54,7 +56,7 @@ class DelayGrabElementPrivate
         int m_nFrames;
         QMutex m_mutex;
         QSize m_frameSize;
-        QVector<QImage> m_frames;
+        AkFrameRing m_frames;
         QVector<int> m_delayMap;
 
         DelayGrabElementPrivate():
@@ -189,14 +191,8 @@ AkPacket DelayGrabElement::iStream(const AkPacket &packet)
     }
 
     int nFrames = this->d->m_nFrames > 0? this->d->m_nFrames: 1;
-    this->d->m_frames << src.copy();
-    int diff = this->d->m_frames.size() - nFrames;
-
-    for (int i = 0; i < diff; i++)
-        this->d->m_frames.removeFirst();
-
-    if (this->d->m_frames.isEmpty())
-        akSend(packet)
+    this->d->m_frames.resize(nFrames, src.size(), src.format());
+    this->d->m_frames.push(src);
 
     this->d->m_mutex.lock();
     int blockSize = this->d->m_blockSize > 0? this->d->m_blockSize: 1;
@@ -208,30 +204,37 @@ AkPacket DelayGrabElement::iStream(const AkPacket &packet)
     if (delayMap.isEmpty())
         akSend(packet)
 
+    int framesStored = this->d->m_frames.size();
+    int frameWidth = src.width();
+
     // Copy image blockwise to screenbuffer
-    for (int i = 0, y = 0; y < delayMapHeight; y++) {
-        for (int x = 0; x < delayMapWidth ; i++, x++) {
-            int curFrame = qAbs(this->d->m_frames.size() - 1 - delayMap[i])
-                           % this->d->m_frames.size();
-            int curFrameWidth = this->d->m_frames[curFrame].width();
-            int xyoff = blockSize * (x + y * curFrameWidth);
-
-            // source
-            auto source = reinterpret_cast<const QRgb *>(this->d->m_frames[curFrame].constBits());
-            source += xyoff;
-
-            // target
-            QRgb *dest = destBits;
-            dest += xyoff;
-
-            // copy block
-            for (int j = 0; j < blockSize; j++) {
-                memcpy(dest, source, size_t(4 * blockSize));
-                source += curFrameWidth;
-                dest += curFrameWidth;
+    AkVideoFilterRunner::globalRunner()->run(delayMapHeight,
+                                             [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            int i = y * delayMapWidth;
+
+            for (int x = 0; x < delayMapWidth; i++, x++) {
+                int curFrame = qAbs(framesStored - 1 - delayMap[i])
+                               % framesStored;
+                int xyoff = blockSize * (x + y * frameWidth);
+
+                // source
+                auto source = reinterpret_cast<const QRgb *>(this->d->m_frames.at(curFrame).constBits());
+                source += xyoff;
+
+                // target
+                QRgb *dest = destBits;
+                dest += xyoff;
+
+                // copy block
+                for (int j = 0; j < blockSize; j++) {
+                    memcpy(dest, source, size_t(4 * blockSize));
+                    source += frameWidth;
+                    dest += frameWidth;
+                }
             }
         }
-    }
+    });
 
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
@@ -19,10 +19,11 @@
 
 #include <QImage>
 #include <QQmlContext>
-#include <QtConcurrent>
+#include <QVector>
 #include <QtMath>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akvideofilterrunner.h>
 
 #include "denoiseelement.h"
 #include "params.h"
@@ -36,6 +37,13 @@ class DenoiseElementPrivate
         qreal m_sigma;
         int *m_weight;
 
+        /* Scratch arena reused across frames, only reallocated when the
+         * frame geometry changes.
+         */
+        QVector<PixelU8> m_planes;
+        QVector<PixelU32> m_integral;
+        QVector<PixelU64> m_integral2;
+
         DenoiseElementPrivate():
             m_radius(1),
             m_factor(1024),
@@ -52,7 +60,7 @@ class DenoiseElementPrivate
                                   PixelU32 *integral,
                                   PixelU64 *integral2);
         inline static void denoise(const DenoiseStaticParams &staticParams,
-                                   const DenoiseParams *params);
+                                   const DenoiseParams &params);
 };
 
 DenoiseElement::DenoiseElement(): AkElement()
@@ -95,46 +103,56 @@ void DenoiseElementPrivate::integralImage(const QImage &image,
                                           PixelU32 *integral,
                                           PixelU64 *integral2)
 {
-    for (int y = 1; y < oHeight; y++) {
-        auto line = reinterpret_cast<const QRgb *>(image.constScanLine(y - 1));
-        PixelU8 *planesLine = planes
-                              + (y - 1) * image.width();
-
-        // Reset current line summation.
-        PixelU32 sum;
-        PixelU64 sum2;
-
-        for (int x = 1; x < oWidth; x++) {
-            QRgb pixel = line[x - 1];
-
-            // Accumulate pixels in current line.
-            sum += pixel;
-            sum2 += pow2(pixel);
-
-            // Offset to the current line.
-            int offset = x + y * oWidth;
-
-            // Offset to the previous line.
-            // equivalent to x + (y - 1) * oWidth;
-            int offsetPrevious = offset - oWidth;
-
-            planesLine[x - 1] = pixel;
-
-            // Accumulate current line and previous line.
-            integral[offset] = sum + integral[offsetPrevious];
-            integral2[offset] = sum2 + integral2[offsetPrevious];
+    auto runner = AkVideoFilterRunner::globalRunner();
+
+    /* Two separable passes: horizontal prefix sums with independent rows,
+     * then a vertical accumulation with independent columns, so both run
+     * in parallel bands. The window statistics then come from four taps
+     * per pixel however large the radius is.
+     */
+    runner->run(oHeight - 1, [&] (int yStart, int yEnd) {
+        for (int y = yStart + 1; y <= yEnd; y++) {
+            auto line = reinterpret_cast<const QRgb *>(image.constScanLine(y - 1));
+            auto planesLine = planes + (y - 1) * image.width();
+            auto integralLine = integral + y * oWidth;
+            auto integral2Line = integral2 + y * oWidth;
+            PixelU32 sum;
+            PixelU64 sum2;
+
+            for (int x = 1; x < oWidth; x++) {
+                QRgb pixel = line[x - 1];
+                sum += pixel;
+                sum2 += pow2(pixel);
+                planesLine[x - 1] = pixel;
+                integralLine[x] = sum;
+                integral2Line[x] = sum2;
+            }
         }
-    }
+    });
+
+    runner->run(oWidth - 1, [&] (int xStart, int xEnd) {
+        for (int y = 2; y < oHeight; y++) {
+            auto integralLine = integral + y * oWidth;
+            auto integral2Line = integral2 + y * oWidth;
+            auto previousLine = integralLine - oWidth;
+            auto previous2Line = integral2Line - oWidth;
+
+            for (int x = xStart + 1; x <= xEnd; x++) {
+                integralLine[x] += previousLine[x];
+                integral2Line[x] += previous2Line[x];
+            }
+        }
+    });
 }
 
 void DenoiseElementPrivate::denoise(const DenoiseStaticParams &staticParams,
-                                    const DenoiseParams *params)
+                                    const DenoiseParams &params)
 {
     PixelU32 sum = integralSum(staticParams.integral, staticParams.oWidth,
-                               params->xp, params->yp, params->kw, params->kh);
+                               params.xp, params.yp, params.kw, params.kh);
     PixelU64 sum2 = integralSum(staticParams.integral2, staticParams.oWidth,
-                                params->xp, params->yp, params->kw, params->kh);
-    quint32 ks = quint32(params->kw * params->kh);
+                                params.xp, params.yp, params.kw, params.kh);
+    quint32 ks = quint32(params.kw * params.kh);
 
     PixelU32 mean = sum / ks;
     PixelU32 dev = sqrt(ks * sum2 - pow2(sum)) / ks;
@@ -147,12 +165,12 @@ void DenoiseElementPrivate::denoise(const DenoiseStaticParams &staticParams,
     PixelI32 pixel;
     PixelI32 sumW;
 
-    for (int j = 0; j < params->kh; j++) {
+    for (int j = 0; j < params.kh; j++) {
         const PixelU8 *line = staticParams.planes
-                              + (params->yp + j) * staticParams.width;
+                              + (params.yp + j) * staticParams.width;
 
-        for (int i = 0; i < params->kw; i++) {
-            PixelU8 pix = line[params->xp + i];
+        for (int i = 0; i < params.kw; i++) {
+            PixelU8 pix = line[params.xp + i];
             PixelU32 mask = mdMask | pix;
             PixelI32 weight(staticParams.weights[mask.r],
                             staticParams.weights[mask.g],
@@ -163,22 +181,21 @@ void DenoiseElementPrivate::denoise(const DenoiseStaticParams &staticParams,
     }
 
     if (sumW.r < 1)
-        pixel.r = params->iPixel.r;
+        pixel.r = params.iPixel.r;
     else
         pixel.r /= sumW.r;
 
     if (sumW.g < 1)
-        pixel.g = params->iPixel.g;
+        pixel.g = params.iPixel.g;
     else
         pixel.g /= sumW.g;
 
     if (sumW.b < 1)
-        pixel.b = params->iPixel.b;
+        pixel.b = params.iPixel.b;
     else
         pixel.b /= sumW.b;
 
-    *params->oPixel = qRgba(pixel.r, pixel.g, pixel.b, params->alpha);
-    delete params;
+    *params.oPixel = qRgba(pixel.r, pixel.g, pixel.b, params.alpha);
 }
 
 void DenoiseElementPrivate::makeTable(int factor)
@@ -281,6 +298,23 @@ AkPacket DenoiseElement::iStream(const AkPacket &packet)
     if (radius < 1)
         akSend(packet)
 
+    /* The weighting loop is quadratic in the window side, so shrinking
+     * the window under load cuts the per-pixel cost sharply. The
+     * statistics come from fewer neighbors and a bit more grain
+     * survives, which beats dropping the effect outright. */
+    switch (this->quality()) {
+    case AkElement::QualityBalanced:
+        radius = qMax(radius / 2, 1);
+        break;
+
+    case AkElement::QualityFast:
+        radius = 1;
+        break;
+
+    default:
+        break;
+    }
+
     QImage src = AkUtils::packetToImage(packet);
 
     if (src.isNull())
@@ -299,9 +333,19 @@ AkPacket DenoiseElement::iStream(const AkPacket &packet)
 
     int oWidth = src.width() + 1;
     int oHeight = src.height() + 1;
-    PixelU8 *planes = new PixelU8[oWidth * oHeight];
-    PixelU32 *integral = new PixelU32[oWidth * oHeight];
-    PixelU64 *integral2 = new PixelU64[oWidth * oHeight];
+
+    // The first row and column of the integral planes are the zeroed
+    // borders, they are never written again so the arena can be reused
+    // as is on the following frames.
+    if (this->d->m_integral.size() != oWidth * oHeight) {
+        this->d->m_planes.resize(src.width() * src.height());
+        this->d->m_integral = QVector<PixelU32>(oWidth * oHeight);
+        this->d->m_integral2 = QVector<PixelU64>(oWidth * oHeight);
+    }
+
+    auto planes = this->d->m_planes.data();
+    auto integral = this->d->m_integral.data();
+    auto integral2 = this->d->m_integral2.data();
     this->d->integralImage(src,
                            oWidth, oHeight,
                            planes, integral, integral2);
@@ -316,45 +360,34 @@ AkPacket DenoiseElement::iStream(const AkPacket &packet)
     staticParams.mu = this->d->m_mu;
     staticParams.sigma = this->d->m_sigma < 0.1? 0.1: this->d->m_sigma;
 
-    QThreadPool threadPool;
-
-    if (threadPool.maxThreadCount() < 8)
-        threadPool.setMaxThreadCount(8);
-
-    for (int y = 0, pos = 0; y < src.height(); y++) {
-        const QRgb *iLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
-        QRgb *oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
-        int yp = qMax(y - radius, 0);
-        int kh = qMin(y + radius, src.height() - 1) - yp + 1;
-
-        for (int x = 0; x < src.width(); x++, pos++) {
-            int xp = qMax(x - radius, 0);
-            int kw = qMin(x + radius, src.width() - 1) - xp + 1;
-
-            auto params = new DenoiseParams();
-            params->xp = xp;
-            params->yp = yp;
-            params->kw = kw;
-            params->kh = kh;
-            params->iPixel = planes[pos];
-            params->oPixel = oLine + x;
-            params->alpha = qAlpha(iLine[x]);
-
-            if (radius >= 20)
-                QtConcurrent::run(&threadPool,
-                                  DenoiseElementPrivate::denoise,
-                                  staticParams,
-                                  params);
-            else
-                this->d->denoise(staticParams, params);
+    int width = src.width();
+    int height = src.height();
+
+    AkVideoFilterRunner::globalRunner()->run(height,
+                                             [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            auto iLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
+            auto oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+            int yp = qMax(y - radius, 0);
+            int kh = qMin(y + radius, height - 1) - yp + 1;
+            int pos = y * width;
+
+            for (int x = 0; x < width; x++) {
+                int xp = qMax(x - radius, 0);
+                int kw = qMin(x + radius, width - 1) - xp + 1;
+
+                DenoiseParams params;
+                params.xp = xp;
+                params.yp = yp;
+                params.kw = kw;
+                params.kh = kh;
+                params.iPixel = planes[pos + x];
+                params.oPixel = oLine + x;
+                params.alpha = qAlpha(iLine[x]);
+                DenoiseElementPrivate::denoise(staticParams, params);
+            }
         }
-    }
-
-    threadPool.waitForDone();
-
-    delete [] planes;
-    delete [] integral;
-    delete [] integral2;
+    });
 
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
@@ -22,3 +22,4 @@ CONFIG(debug, debug|release): CONFIG += ordered
 
 SUBDIRS = src src/qtscreen
 CONFIG(config_avfoundation): SUBDIRS += src/avfoundation
+CONFIG(config_xdamage): SUBDIRS += src/xshm
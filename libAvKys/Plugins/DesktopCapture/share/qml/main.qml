@@ -26,7 +26,7 @@ GridLayout {
     columns: 2
 
     Component.onCompleted: {
-        var fps = Ak.newFrac(DesktopCapture.fps).value;
+        var fps = Ak.fracValue(DesktopCapture.fps);
         var q = Infinity;
         var index = -1;
 
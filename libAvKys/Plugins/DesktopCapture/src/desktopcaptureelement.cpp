@@ -126,6 +126,14 @@ QString DesktopCaptureElement::captureLib() const
     return globalDesktopCapture->captureLib();
 }
 
+QSize DesktopCaptureElement::outputSize() const
+{
+    if (!this->d->m_screenCapture)
+        return QSize();
+
+    return this->d->m_screenCapture->outputSize();
+}
+
 QString DesktopCaptureElement::controlInterfaceProvide(const QString &controlId) const
 {
     Q_UNUSED(controlId)
@@ -166,6 +174,18 @@ void DesktopCaptureElement::resetMedia()
         this->d->m_screenCapture->resetMedia();
 }
 
+void DesktopCaptureElement::setOutputSize(const QSize &outputSize)
+{
+    if (this->d->m_screenCapture)
+        this->d->m_screenCapture->setOutputSize(outputSize);
+}
+
+void DesktopCaptureElement::resetOutputSize()
+{
+    if (this->d->m_screenCapture)
+        this->d->m_screenCapture->resetOutputSize();
+}
+
 void DesktopCaptureElement::setCaptureLib(const QString &captureLib)
 {
     globalDesktopCapture->setCaptureLib(captureLib);
@@ -268,6 +288,10 @@ void DesktopCaptureElement::captureLibUpdated(const QString &captureLib)
                      &ScreenDev::sizeChanged,
                      this,
                      &DesktopCaptureElement::sizeChanged);
+    QObject::connect(this->d->m_screenCapture.data(),
+                     &ScreenDev::outputSizeChanged,
+                     this,
+                     &DesktopCaptureElement::outputSizeChanged);
     QObject::connect(this->d->m_screenCapture.data(),
                      &ScreenDev::oStream,
                      this,
@@ -56,6 +56,13 @@ class DesktopCaptureElement: public AkMultimediaSourceElement
                WRITE setCaptureLib
                RESET resetCaptureLib
                NOTIFY captureLibChanged)
+    /* Requested frame size, the capture downscales to fit it before the
+     * frame enters the pipeline. An invalid size means native resolution. */
+    Q_PROPERTY(QSize outputSize
+               READ outputSize
+               WRITE setOutputSize
+               RESET resetOutputSize
+               NOTIFY outputSizeChanged)
 
     public:
         explicit DesktopCaptureElement();
@@ -69,6 +76,7 @@ class DesktopCaptureElement: public AkMultimediaSourceElement
         Q_INVOKABLE QString description(const QString &media);
         Q_INVOKABLE AkCaps caps(int stream);
         Q_INVOKABLE QString captureLib() const;
+        Q_INVOKABLE QSize outputSize() const;
 
     private:
         DesktopCaptureElementPrivate *d;
@@ -87,10 +95,13 @@ class DesktopCaptureElement: public AkMultimediaSourceElement
         void sizeChanged(const QString &media, const QSize &size);
         void error(const QString &message);
         void captureLibChanged(const QString &captureLib);
+        void outputSizeChanged(const QSize &outputSize);
 
     public slots:
         void setFps(const AkFrac &fps);
         void resetFps();
+        void setOutputSize(const QSize &outputSize);
+        void resetOutputSize();
         void setMedia(const QString &media);
         void resetMedia();
         void setCaptureLib(const QString &captureLib);
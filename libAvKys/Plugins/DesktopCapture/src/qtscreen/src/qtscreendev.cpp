@@ -21,7 +21,6 @@
 #include <QDesktopWidget>
 #include <QScreen>
 #include <QTime>
-#include <QTimer>
 #include <QtConcurrent>
 #include <QThreadPool>
 #include <QFuture>
@@ -29,6 +28,7 @@
 #include <ak.h>
 #include <akutils.h>
 #include <akfrac.h>
+#include <akframeclock.h>
 #include <akpacket.h>
 #include <akcaps.h>
 
@@ -42,22 +42,25 @@ class QtScreenDevPrivate
         QString m_curScreen;
         int m_curScreenNumber;
         qint64 m_id;
+        qint64 m_clockSub;
         bool m_threadedRead;
-        QTimer m_timer;
         QThreadPool m_threadPool;
         QFuture<void> m_threadStatus;
         QMutex m_mutex;
         AkPacket m_curPacket;
+        QSize m_outputSize;
 
         QtScreenDevPrivate(QtScreenDev *self):
             self(self),
             m_curScreenNumber(-1),
             m_id(-1),
+            m_clockSub(-1),
             m_threadedRead(false)
         {
         }
 
         inline void sendPacket(const AkPacket &packet);
+        inline QSize targetSize(const QSize &nativeSize) const;
 };
 
 QtScreenDev::QtScreenDev():
@@ -65,8 +68,6 @@ QtScreenDev::QtScreenDev():
 {
     this->d = new QtScreenDevPrivate(this);
     this->d->m_fps = AkFrac(30000, 1001);
-    this->d->m_timer.setInterval(qRound(1.e3 *
-                                        this->d->m_fps.invert().value()));
     this->d->m_curScreenNumber = -1;
     this->d->m_threadedRead = true;
 
@@ -82,10 +83,6 @@ QtScreenDev::QtScreenDev():
                      &QDesktopWidget::resized,
                      this,
                      &QtScreenDev::srceenResized);
-    QObject::connect(&this->d->m_timer,
-                     &QTimer::timeout,
-                     this,
-                     &QtScreenDev::readFrame);
 }
 
 QtScreenDev::~QtScreenDev()
@@ -155,22 +152,41 @@ AkCaps QtScreenDev::caps(int stream)
     if (!screen)
         return QString();
 
+    auto size = this->d->targetSize(screen->size());
+
     AkVideoCaps caps;
     caps.isValid() = true;
     caps.format() = AkVideoCaps::Format_rgb24;
     caps.bpp() = AkVideoCaps::bitsPerPixel(caps.format());
-    caps.width() = screen->size().width();
-    caps.height() = screen->size().height();
+    caps.width() = size.width();
+    caps.height() = size.height();
     caps.fps() = this->d->m_fps;
 
     return caps.toCaps();
 }
 
+QSize QtScreenDev::outputSize() const
+{
+    return this->d->m_outputSize;
+}
+
 void QtScreenDevPrivate::sendPacket(const AkPacket &packet)
 {
     emit self->oStream(packet);
 }
 
+/* Size the frames leave the capture with. Only downscaling makes sense
+ * here, upscaling at the source would just inflate every later stage. */
+QSize QtScreenDevPrivate::targetSize(const QSize &nativeSize) const
+{
+    if (!this->m_outputSize.isValid()
+        || (this->m_outputSize.width() >= nativeSize.width()
+            && this->m_outputSize.height() >= nativeSize.height()))
+        return nativeSize;
+
+    return nativeSize.scaled(this->m_outputSize, Qt::KeepAspectRatio);
+}
+
 void QtScreenDev::setFps(const AkFrac &fps)
 {
     if (this->d->m_fps == fps)
@@ -180,8 +196,9 @@ void QtScreenDev::setFps(const AkFrac &fps)
     this->d->m_fps = fps;
     this->d->m_mutex.unlock();
     emit this->fpsChanged(fps);
-    this->d->m_timer.setInterval(qRound(1.e3 *
-                                        this->d->m_fps.invert().value()));
+
+    if (this->d->m_clockSub >= 0)
+        AkFrameClock::globalClock()->setRate(this->d->m_clockSub, fps);
 }
 
 void QtScreenDev::resetFps()
@@ -189,6 +206,22 @@ void QtScreenDev::resetFps()
     this->setFps(AkFrac(30000, 1001));
 }
 
+void QtScreenDev::setOutputSize(const QSize &outputSize)
+{
+    if (this->d->m_outputSize == outputSize)
+        return;
+
+    this->d->m_mutex.lock();
+    this->d->m_outputSize = outputSize;
+    this->d->m_mutex.unlock();
+    emit this->outputSizeChanged(outputSize);
+}
+
+void QtScreenDev::resetOutputSize()
+{
+    this->setOutputSize(QSize());
+}
+
 void QtScreenDev::setMedia(const QString &media)
 {
     for (int i = 0; i < QGuiApplication::screens().size(); i++) {
@@ -234,16 +267,23 @@ void QtScreenDev::resetStreams()
 bool QtScreenDev::init()
 {
     this->d->m_id = Ak::id();
-    this->d->m_timer.setInterval(qRound(1.e3 *
-                                        this->d->m_fps.invert().value()));
-    this->d->m_timer.start();
+
+    // One shared wakeup per frame period serves every capture running.
+    this->d->m_clockSub =
+            AkFrameClock::globalClock()->subscribe(this,
+                                                   "readFrame",
+                                                   this->d->m_fps);
 
     return true;
 }
 
 bool QtScreenDev::uninit()
 {
-    this->d->m_timer.stop();
+    if (this->d->m_clockSub >= 0) {
+        AkFrameClock::globalClock()->unsubscribe(this->d->m_clockSub);
+        this->d->m_clockSub = -1;
+    }
+
     this->d->m_threadStatus.waitForFinished();
 
     return true;
@@ -256,20 +296,30 @@ void QtScreenDev::readFrame()
     auto fps = this->d->m_fps;
     this->d->m_mutex.unlock();
 
-    AkVideoCaps caps;
-    caps.isValid() = true;
-    caps.format() = AkVideoCaps::Format_rgb24;
-    caps.bpp() = AkVideoCaps::bitsPerPixel(caps.format());
-    caps.width() = screen->size().width();
-    caps.height() = screen->size().height();
-    caps.fps() = fps;
-
     auto frame =
             screen->grabWindow(QApplication::desktop()->winId(),
                                screen->geometry().x(),
                                screen->geometry().y(),
                                screen->geometry().width(),
                                screen->geometry().height());
+    auto size = this->d->targetSize(frame.size());
+
+    /* Downscale the pixmap before it is converted, so the platform backend
+     * gets the chance to do it and the RGB conversion and everything after
+     * it touch the reduced frame only. */
+    if (size != frame.size())
+        frame = frame.scaled(size,
+                             Qt::IgnoreAspectRatio,
+                             Qt::SmoothTransformation);
+
+    AkVideoCaps caps;
+    caps.isValid() = true;
+    caps.format() = AkVideoCaps::Format_rgb24;
+    caps.bpp() = AkVideoCaps::bitsPerPixel(caps.format());
+    caps.width() = size.width();
+    caps.height() = size.height();
+    caps.fps() = fps;
+
     QImage frameImg = frame.toImage().convertToFormat(QImage::Format_RGB888);
     AkPacket packet = AkUtils::imageToPacket(frameImg, caps.toCaps());
 
@@ -46,6 +46,13 @@ class QtScreenDev: public ScreenDev
                WRITE setFps
                RESET resetFps
                NOTIFY fpsChanged)
+    /* Requested frame size, the capture downscales to fit it before the
+     * frame enters the pipeline. An invalid size means native resolution. */
+    Q_PROPERTY(QSize outputSize
+               READ outputSize
+               WRITE setOutputSize
+               RESET resetOutputSize
+               NOTIFY outputSizeChanged)
 
     public:
         explicit QtScreenDev();
@@ -58,6 +65,7 @@ class QtScreenDev: public ScreenDev
         Q_INVOKABLE int defaultStream(const QString &mimeType);
         Q_INVOKABLE QString description(const QString &media);
         Q_INVOKABLE AkCaps caps(int stream);
+        Q_INVOKABLE QSize outputSize() const;
 
     private:
         QtScreenDevPrivate *d;
@@ -69,11 +77,14 @@ class QtScreenDev: public ScreenDev
         void loopChanged(bool loop);
         void fpsChanged(const AkFrac &fps);
         void sizeChanged(const QString &media, const QSize &size);
+        void outputSizeChanged(const QSize &outputSize);
         void error(const QString &message);
 
     public slots:
         void setFps(const AkFrac &fps);
         void resetFps();
+        void setOutputSize(const QSize &outputSize);
+        void resetOutputSize();
         void setMedia(const QString &media);
         void resetMedia();
         void setStreams(const QList<int> &streams);
@@ -72,6 +72,11 @@ AkCaps ScreenDev::caps(int stream)
     return AkCaps();
 }
 
+QSize ScreenDev::outputSize() const
+{
+    return QSize();
+}
+
 void ScreenDev::setFps(const AkFrac &fps)
 {
     Q_UNUSED(fps)
@@ -81,6 +86,15 @@ void ScreenDev::resetFps()
 {
 }
 
+void ScreenDev::setOutputSize(const QSize &outputSize)
+{
+    Q_UNUSED(outputSize)
+}
+
+void ScreenDev::resetOutputSize()
+{
+}
+
 void ScreenDev::setMedia(const QString &media)
 {
     Q_UNUSED(media)
@@ -21,6 +21,7 @@
 #define SCREENDEV_H
 
 #include <QObject>
+#include <QSize>
 
 class DesktopCaptureElement;
 class AkFrac;
@@ -42,6 +43,7 @@ class ScreenDev: public QObject
         Q_INVOKABLE virtual int defaultStream(const QString &mimeType);
         Q_INVOKABLE virtual QString description(const QString &media);
         Q_INVOKABLE virtual AkCaps caps(int stream);
+        Q_INVOKABLE virtual QSize outputSize() const;
 
     signals:
         void mediasChanged(const QStringList &medias);
@@ -49,11 +51,14 @@ class ScreenDev: public QObject
         void streamsChanged(const QList<int> &streams);
         void fpsChanged(const AkFrac &fps);
         void sizeChanged(const QString &media, const QSize &size);
+        void outputSizeChanged(const QSize &outputSize);
         void oStream(const AkPacket &packet);
 
     public slots:
         virtual void setFps(const AkFrac &fps);
         virtual void resetFps();
+        virtual void setOutputSize(const QSize &outputSize);
+        virtual void resetOutputSize();
         virtual void setMedia(const QString &media);
         virtual void resetMedia();
         virtual void setStreams(const QList<int> &streams);
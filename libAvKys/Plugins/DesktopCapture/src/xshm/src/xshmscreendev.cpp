@@ -0,0 +1,787 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QGuiApplication>
+#include <QScreen>
+#include <QTime>
+#include <QtConcurrent>
+#include <QThreadPool>
+#include <QFuture>
+#include <QMutex>
+#include <ak.h>
+#include <akutils.h>
+#include <akfrac.h>
+#include <akframeclock.h>
+#include <akpacket.h>
+#include <akcaps.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/Xatom.h>
+#include <X11/extensions/XShm.h>
+#include <X11/extensions/Xdamage.h>
+#include <X11/extensions/Xcomposite.h>
+
+#include "xshmscreendev.h"
+
+class XShmScreenDevPrivate
+{
+    public:
+        XShmScreenDev *self;
+        AkFrac m_fps;
+        QString m_curScreen;
+        int m_curScreenNumber;
+        qint64 m_id;
+        qint64 m_clockSub;
+        QThreadPool m_threadPool;
+        QFuture<void> m_threadStatus;
+        QMutex m_mutex;
+        AkPacket m_curPacket;
+        QSize m_outputSize;
+
+        // X11 capture state. The shared segment is mapped once at init and
+        // reused for every grab, and XDamage tells us when the screen has
+        // actually changed so static desktops cost nothing.
+        Display *m_display;
+        XImage *m_image;
+        XShmSegmentInfo m_shmInfo;
+        Damage m_damage;
+        int m_damageEventBase;
+        bool m_dirty;
+        bool m_haveShm;
+
+        // Single window capture state. When m_curWindow is set the grab reads
+        // the window drawable directly, so only the window's own pixels cross
+        // the wire, at the window's native size.
+        Window m_curWindow;
+        bool m_windowRedirected;
+
+        XShmScreenDevPrivate(XShmScreenDev *self):
+            self(self),
+            m_curScreenNumber(-1),
+            m_id(-1),
+            m_clockSub(-1),
+            m_display(nullptr),
+            m_image(nullptr),
+            m_damage(None),
+            m_damageEventBase(0),
+            m_dirty(true),
+            m_haveShm(false),
+            m_curWindow(None),
+            m_windowRedirected(false)
+        {
+            memset(&this->m_shmInfo, 0, sizeof(XShmSegmentInfo));
+        }
+
+        inline bool attachShm(int width, int height);
+        inline void detachShm();
+        inline bool processDamageEvents();
+        inline void sendPacket(const AkPacket &packet);
+        inline QSize targetSize(const QSize &nativeSize) const;
+        inline QVector<Window> clientWindows(Display *display) const;
+        inline QString windowTitle(Display *display, Window window) const;
+        inline QSize windowSize(Window window) const;
+};
+
+XShmScreenDev::XShmScreenDev():
+    ScreenDev()
+{
+    this->d = new XShmScreenDevPrivate(this);
+    this->d->m_fps = AkFrac(30000, 1001);
+
+    QObject::connect(qApp,
+                     &QGuiApplication::screenAdded,
+                     this,
+                     &XShmScreenDev::screenCountChanged);
+    QObject::connect(qApp,
+                     &QGuiApplication::screenRemoved,
+                     this,
+                     &XShmScreenDev::screenCountChanged);
+}
+
+XShmScreenDev::~XShmScreenDev()
+{
+    this->uninit();
+    delete this->d;
+}
+
+AkFrac XShmScreenDev::fps() const
+{
+    return this->d->m_fps;
+}
+
+QStringList XShmScreenDev::medias()
+{
+    QStringList medias;
+
+    for (int i = 0; i < QGuiApplication::screens().size(); i++)
+        medias << QString("screen://%1").arg(i);
+
+    auto display = XOpenDisplay(nullptr);
+
+    if (display) {
+        for (auto &window: this->d->clientWindows(display))
+            medias << QString("window://%1").arg(window);
+
+        XCloseDisplay(display);
+    }
+
+    return medias;
+}
+
+QString XShmScreenDev::media() const
+{
+    if (!this->d->m_curScreen.isEmpty())
+        return this->d->m_curScreen;
+
+    int screen = QGuiApplication::screens().indexOf(QGuiApplication::primaryScreen());
+
+    return QString("screen://%1").arg(screen);
+}
+
+QList<int> XShmScreenDev::streams() const
+{
+    QList<int> streams;
+    streams << 0;
+
+    return streams;
+}
+
+int XShmScreenDev::defaultStream(const QString &mimeType)
+{
+    if (mimeType == "video/x-raw")
+        return 0;
+
+    return -1;
+}
+
+QString XShmScreenDev::description(const QString &media)
+{
+    for (int i = 0; i < QGuiApplication::screens().size(); i++)
+        if (QString("screen://%1").arg(i) == media)
+            return QString("Screen %1").arg(i);
+
+    if (media.startsWith("window://")) {
+        bool ok = false;
+        auto window = Window(media.mid(9).toULongLong(&ok));
+
+        if (!ok)
+            return QString();
+
+        QString title;
+        auto display = XOpenDisplay(nullptr);
+
+        if (display) {
+            title = this->d->windowTitle(display, window);
+            XCloseDisplay(display);
+        }
+
+        if (title.isEmpty())
+            title = QString("Window 0x%1").arg(quint64(window), 0, 16);
+
+        return title;
+    }
+
+    return QString();
+}
+
+AkCaps XShmScreenDev::caps(int stream)
+{
+    if (stream != 0)
+        return AkCaps();
+
+    if (this->d->m_curWindow != None) {
+        auto size = this->d->windowSize(this->d->m_curWindow);
+
+        if (!size.isValid())
+            return AkCaps();
+
+        size = this->d->targetSize(size);
+
+        AkVideoCaps caps;
+        caps.isValid() = true;
+        caps.format() = AkVideoCaps::Format_0rgb;
+        caps.bpp() = AkVideoCaps::bitsPerPixel(caps.format());
+        caps.width() = size.width();
+        caps.height() = size.height();
+        caps.fps() = this->d->m_fps;
+
+        return caps.toCaps();
+    }
+
+    if (this->d->m_curScreenNumber < 0)
+        return AkCaps();
+
+    QScreen *screen = QGuiApplication::screens()[this->d->m_curScreenNumber];
+
+    if (!screen)
+        return QString();
+
+    auto size = this->d->targetSize(screen->size());
+
+    AkVideoCaps caps;
+    caps.isValid() = true;
+    caps.format() = AkVideoCaps::Format_0rgb;
+    caps.bpp() = AkVideoCaps::bitsPerPixel(caps.format());
+    caps.width() = size.width();
+    caps.height() = size.height();
+    caps.fps() = this->d->m_fps;
+
+    return caps.toCaps();
+}
+
+QSize XShmScreenDev::outputSize() const
+{
+    return this->d->m_outputSize;
+}
+
+bool XShmScreenDevPrivate::attachShm(int width, int height)
+{
+    this->m_image = XShmCreateImage(this->m_display,
+                                    DefaultVisual(this->m_display,
+                                                  DefaultScreen(this->m_display)),
+                                    uint(DefaultDepth(this->m_display,
+                                                      DefaultScreen(this->m_display))),
+                                    ZPixmap,
+                                    nullptr,
+                                    &this->m_shmInfo,
+                                    uint(width),
+                                    uint(height));
+
+    if (!this->m_image)
+        return false;
+
+    this->m_shmInfo.shmid = shmget(IPC_PRIVATE,
+                                   size_t(this->m_image->bytes_per_line
+                                          * this->m_image->height),
+                                   IPC_CREAT | 0600);
+
+    if (this->m_shmInfo.shmid < 0) {
+        XDestroyImage(this->m_image);
+        this->m_image = nullptr;
+
+        return false;
+    }
+
+    this->m_shmInfo.shmaddr = reinterpret_cast<char *>(shmat(this->m_shmInfo.shmid,
+                                                             nullptr,
+                                                             0));
+    this->m_image->data = this->m_shmInfo.shmaddr;
+    this->m_shmInfo.readOnly = False;
+
+    if (!XShmAttach(this->m_display, &this->m_shmInfo)) {
+        this->detachShm();
+
+        return false;
+    }
+
+    // Mark the segment for removal so it goes away with the process even if
+    // we crash while attached.
+    shmctl(this->m_shmInfo.shmid, IPC_RMID, nullptr);
+    this->m_haveShm = true;
+
+    return true;
+}
+
+void XShmScreenDevPrivate::detachShm()
+{
+    if (this->m_haveShm) {
+        XShmDetach(this->m_display, &this->m_shmInfo);
+        this->m_haveShm = false;
+    }
+
+    if (this->m_image) {
+        this->m_image->data = nullptr;
+        XDestroyImage(this->m_image);
+        this->m_image = nullptr;
+    }
+
+    if (this->m_shmInfo.shmaddr) {
+        shmdt(this->m_shmInfo.shmaddr);
+        this->m_shmInfo.shmaddr = nullptr;
+    }
+}
+
+bool XShmScreenDevPrivate::processDamageEvents()
+{
+    while (XPending(this->m_display)) {
+        XEvent event;
+        XNextEvent(this->m_display, &event);
+
+        if (event.type == this->m_damageEventBase + XDamageNotify)
+            this->m_dirty = true;
+    }
+
+    return this->m_dirty;
+}
+
+void XShmScreenDevPrivate::sendPacket(const AkPacket &packet)
+{
+    emit self->oStream(packet);
+}
+
+/* Size the frames leave the capture with. XShm always transfers the
+ * drawable at native size, but downscaling right after the grab still
+ * quarters the data every later stage touches. Only downscaling makes
+ * sense here, upscaling at the source would just inflate the pipeline. */
+QSize XShmScreenDevPrivate::targetSize(const QSize &nativeSize) const
+{
+    if (!this->m_outputSize.isValid()
+        || (this->m_outputSize.width() >= nativeSize.width()
+            && this->m_outputSize.height() >= nativeSize.height()))
+        return nativeSize;
+
+    return nativeSize.scaled(this->m_outputSize, Qt::KeepAspectRatio);
+}
+
+QVector<Window> XShmScreenDevPrivate::clientWindows(Display *display) const
+{
+    QVector<Window> windows;
+    Atom clientList = XInternAtom(display, "_NET_CLIENT_LIST", True);
+
+    if (clientList == None)
+        return windows;
+
+    Atom actualType = None;
+    int actualFormat = 0;
+    unsigned long nItems = 0;
+    unsigned long bytesAfter = 0;
+    unsigned char *data = nullptr;
+
+    if (XGetWindowProperty(display,
+                           DefaultRootWindow(display),
+                           clientList,
+                           0,
+                           ~0L,
+                           False,
+                           XA_WINDOW,
+                           &actualType,
+                           &actualFormat,
+                           &nItems,
+                           &bytesAfter,
+                           &data) != Success)
+        return windows;
+
+    if (actualType == XA_WINDOW && actualFormat == 32) {
+        auto windowIds = reinterpret_cast<unsigned long *>(data);
+
+        for (unsigned long i = 0; i < nItems; i++)
+            windows << Window(windowIds[i]);
+    }
+
+    if (data)
+        XFree(data);
+
+    return windows;
+}
+
+QString XShmScreenDevPrivate::windowTitle(Display *display, Window window) const
+{
+    Atom netWmName = XInternAtom(display, "_NET_WM_NAME", False);
+    Atom utf8String = XInternAtom(display, "UTF8_STRING", False);
+    Atom actualType = None;
+    int actualFormat = 0;
+    unsigned long nItems = 0;
+    unsigned long bytesAfter = 0;
+    unsigned char *data = nullptr;
+    QString title;
+
+    if (XGetWindowProperty(display,
+                           window,
+                           netWmName,
+                           0,
+                           ~0L,
+                           False,
+                           utf8String,
+                           &actualType,
+                           &actualFormat,
+                           &nItems,
+                           &bytesAfter,
+                           &data) == Success
+        && data) {
+        title = QString::fromUtf8(reinterpret_cast<char *>(data),
+                                  int(nItems));
+        XFree(data);
+    }
+
+    if (title.isEmpty()) {
+        char *name = nullptr;
+
+        if (XFetchName(display, window, &name) && name) {
+            title = QString::fromLatin1(name);
+            XFree(name);
+        }
+    }
+
+    return title;
+}
+
+QSize XShmScreenDevPrivate::windowSize(Window window) const
+{
+    auto display = this->m_display;
+    bool temporary = false;
+
+    if (!display) {
+        display = XOpenDisplay(nullptr);
+        temporary = true;
+    }
+
+    if (!display)
+        return QSize();
+
+    QSize size;
+    XWindowAttributes attributes;
+
+    if (XGetWindowAttributes(display, window, &attributes))
+        size = QSize(attributes.width, attributes.height);
+
+    if (temporary)
+        XCloseDisplay(display);
+
+    return size;
+}
+
+void XShmScreenDev::setFps(const AkFrac &fps)
+{
+    if (this->d->m_fps == fps)
+        return;
+
+    this->d->m_mutex.lock();
+    this->d->m_fps = fps;
+    this->d->m_mutex.unlock();
+    emit this->fpsChanged(fps);
+
+    if (this->d->m_clockSub >= 0)
+        AkFrameClock::globalClock()->setRate(this->d->m_clockSub, fps);
+}
+
+void XShmScreenDev::resetFps()
+{
+    this->setFps(AkFrac(30000, 1001));
+}
+
+void XShmScreenDev::setOutputSize(const QSize &outputSize)
+{
+    if (this->d->m_outputSize == outputSize)
+        return;
+
+    this->d->m_mutex.lock();
+    this->d->m_outputSize = outputSize;
+    this->d->m_mutex.unlock();
+    emit this->outputSizeChanged(outputSize);
+}
+
+void XShmScreenDev::resetOutputSize()
+{
+    this->setOutputSize(QSize());
+}
+
+void XShmScreenDev::setMedia(const QString &media)
+{
+    if (media.startsWith("window://")) {
+        bool ok = false;
+        auto window = Window(media.mid(9).toULongLong(&ok));
+
+        if (!ok || this->d->m_curWindow == window)
+            return;
+
+        this->d->m_curScreen = media;
+        this->d->m_curScreenNumber = -1;
+        this->d->m_curWindow = window;
+
+        emit this->mediaChanged(media);
+
+        return;
+    }
+
+    for (int i = 0; i < QGuiApplication::screens().size(); i++) {
+        QString screen = QString("screen://%1").arg(i);
+
+        if (screen == media) {
+            if (this->d->m_curScreenNumber == i
+                && this->d->m_curWindow == None)
+                break;
+
+            this->d->m_curScreen = screen;
+            this->d->m_curScreenNumber = i;
+            this->d->m_curWindow = None;
+
+            emit this->mediaChanged(media);
+
+            break;
+        }
+    }
+}
+
+void XShmScreenDev::resetMedia()
+{
+    int screen = QGuiApplication::screens().indexOf(QGuiApplication::primaryScreen());
+
+    if (this->d->m_curScreenNumber == screen
+        && this->d->m_curWindow == None)
+        return;
+
+    this->d->m_curScreen = QString("screen://%1").arg(screen);
+    this->d->m_curScreenNumber = screen;
+    this->d->m_curWindow = None;
+
+    emit this->mediaChanged(this->d->m_curScreen);
+}
+
+void XShmScreenDev::setStreams(const QList<int> &streams)
+{
+    Q_UNUSED(streams)
+}
+
+void XShmScreenDev::resetStreams()
+{
+
+}
+
+bool XShmScreenDev::init()
+{
+    this->d->m_display = XOpenDisplay(nullptr);
+
+    if (!this->d->m_display)
+        return false;
+
+    int errorBase = 0;
+
+    if (!XShmQueryExtension(this->d->m_display)
+        || !XDamageQueryExtension(this->d->m_display,
+                                  &this->d->m_damageEventBase,
+                                  &errorBase)) {
+        XCloseDisplay(this->d->m_display);
+        this->d->m_display = nullptr;
+
+        return false;
+    }
+
+    if (this->d->m_curWindow != None) {
+        // Redirect the window offscreen so the compositor keeps rendering
+        // its contents even while it is covered by other windows.
+        int compositeEventBase = 0;
+
+        if (XCompositeQueryExtension(this->d->m_display,
+                                     &compositeEventBase,
+                                     &errorBase)) {
+            XCompositeRedirectWindow(this->d->m_display,
+                                     this->d->m_curWindow,
+                                     CompositeRedirectAutomatic);
+            this->d->m_windowRedirected = true;
+        }
+
+        auto size = this->d->windowSize(this->d->m_curWindow);
+
+        if (!size.isValid()
+            || !this->d->attachShm(size.width(), size.height())) {
+            this->uninit();
+
+            return false;
+        }
+
+        this->d->m_damage = XDamageCreate(this->d->m_display,
+                                          this->d->m_curWindow,
+                                          XDamageReportNonEmpty);
+    } else {
+        int screenNumber = this->d->m_curScreenNumber;
+
+        if (screenNumber < 0)
+            screenNumber =
+                    QGuiApplication::screens().indexOf(QGuiApplication::primaryScreen());
+
+        auto screen = QGuiApplication::screens().value(screenNumber);
+
+        if (!screen
+            || !this->d->attachShm(screen->geometry().width(),
+                                   screen->geometry().height())) {
+            XCloseDisplay(this->d->m_display);
+            this->d->m_display = nullptr;
+
+            return false;
+        }
+
+        this->d->m_damage = XDamageCreate(this->d->m_display,
+                                          DefaultRootWindow(this->d->m_display),
+                                          XDamageReportNonEmpty);
+    }
+    this->d->m_dirty = true;
+    this->d->m_id = Ak::id();
+
+    // One shared wakeup per frame period serves every capture running.
+    this->d->m_clockSub =
+            AkFrameClock::globalClock()->subscribe(this,
+                                                   "readFrame",
+                                                   this->d->m_fps);
+
+    return true;
+}
+
+bool XShmScreenDev::uninit()
+{
+    if (this->d->m_clockSub >= 0) {
+        AkFrameClock::globalClock()->unsubscribe(this->d->m_clockSub);
+        this->d->m_clockSub = -1;
+    }
+
+    this->d->m_threadStatus.waitForFinished();
+
+    if (this->d->m_display) {
+        if (this->d->m_damage != None) {
+            XDamageDestroy(this->d->m_display, this->d->m_damage);
+            this->d->m_damage = None;
+        }
+
+        if (this->d->m_windowRedirected) {
+            XCompositeUnredirectWindow(this->d->m_display,
+                                       this->d->m_curWindow,
+                                       CompositeRedirectAutomatic);
+            this->d->m_windowRedirected = false;
+        }
+
+        this->d->detachShm();
+        XCloseDisplay(this->d->m_display);
+        this->d->m_display = nullptr;
+    }
+
+    return true;
+}
+
+void XShmScreenDev::readFrame()
+{
+    if (!this->d->m_display || !this->d->m_image)
+        return;
+
+    if (this->d->m_curWindow != None) {
+        XWindowAttributes attributes;
+
+        // The window can go away or get unmapped at any time, check before
+        // touching the drawable to avoid an X protocol error.
+        if (!XGetWindowAttributes(this->d->m_display,
+                                  this->d->m_curWindow,
+                                  &attributes)
+            || attributes.map_state == IsUnmapped)
+            return;
+
+        if (attributes.width != this->d->m_image->width
+            || attributes.height != this->d->m_image->height) {
+            this->d->detachShm();
+
+            if (!this->d->attachShm(attributes.width, attributes.height))
+                return;
+
+            this->d->m_dirty = true;
+            emit this->sizeChanged(this->d->m_curScreen,
+                                   QSize(attributes.width,
+                                         attributes.height));
+        }
+
+        // Nothing painted since the last grab, keep the wire silent.
+        if (!this->d->processDamageEvents())
+            return;
+
+        if (!XShmGetImage(this->d->m_display,
+                          this->d->m_curWindow,
+                          this->d->m_image,
+                          0,
+                          0,
+                          AllPlanes))
+            return;
+    } else {
+        // Nothing painted since the last grab, keep the wire silent.
+        if (!this->d->processDamageEvents())
+            return;
+
+        auto screen = QGuiApplication::screens().value(this->d->m_curScreenNumber);
+
+        if (!screen)
+            screen = QGuiApplication::primaryScreen();
+
+        if (!XShmGetImage(this->d->m_display,
+                          DefaultRootWindow(this->d->m_display),
+                          this->d->m_image,
+                          screen->geometry().x(),
+                          screen->geometry().y(),
+                          AllPlanes))
+            return;
+    }
+
+    XDamageSubtract(this->d->m_display, this->d->m_damage, None, None);
+    this->d->m_dirty = false;
+
+    this->d->m_mutex.lock();
+    auto fps = this->d->m_fps;
+    this->d->m_mutex.unlock();
+
+    QImage frameImg(reinterpret_cast<const uchar *>(this->d->m_image->data),
+                    this->d->m_image->width,
+                    this->d->m_image->height,
+                    this->d->m_image->bytes_per_line,
+                    QImage::Format_RGB32);
+    auto size = this->d->targetSize(frameImg.size());
+
+    /* Downscale straight out of the shared segment, Qt's raster scaler is
+     * vectorized, so everything after this point touches the reduced
+     * frame only. */
+    if (size != frameImg.size())
+        frameImg = frameImg.scaled(size,
+                                   Qt::IgnoreAspectRatio,
+                                   Qt::SmoothTransformation);
+
+    AkVideoCaps caps;
+    caps.isValid() = true;
+    caps.format() = AkVideoCaps::Format_0rgb;
+    caps.bpp() = AkVideoCaps::bitsPerPixel(caps.format());
+    caps.width() = size.width();
+    caps.height() = size.height();
+    caps.fps() = fps;
+
+    AkPacket packet = AkUtils::imageToPacket(frameImg, caps.toCaps());
+
+    if (!packet)
+        return;
+
+    qint64 pts = qint64(QTime::currentTime().msecsSinceStartOfDay()
+                        * fps.value() / 1e3);
+
+    packet.setPts(pts);
+    packet.setTimeBase(fps.invert());
+    packet.setIndex(0);
+    packet.setId(this->d->m_id);
+
+    if (!this->d->m_threadStatus.isRunning()) {
+        this->d->m_curPacket = packet;
+
+        this->d->m_threadStatus =
+                QtConcurrent::run(&this->d->m_threadPool,
+                                  this->d,
+                                  &XShmScreenDevPrivate::sendPacket,
+                                  this->d->m_curPacket);
+    }
+}
+
+void XShmScreenDev::screenCountChanged(QScreen *screen)
+{
+    Q_UNUSED(screen)
+
+    emit this->mediasChanged(this->medias());
+}
+
+#include "moc_xshmscreendev.cpp"
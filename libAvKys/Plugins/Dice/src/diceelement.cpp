@@ -24,6 +24,7 @@
 #include <QtMath>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akvideofilterrunner.h>
 
 #include "diceelement.h"
 
@@ -106,6 +107,51 @@ AkPacket DiceElement::iStream(const AkPacket &packet)
         emit this->frameSizeChanged(this->d->m_frameSize);
     }
 
+    /* The old loop allocated two temporary images and went through
+     * QPainter for every die of every frame. Interior dice are rotated
+     * with plain pixel addressing instead, cell rows in parallel; the
+     * copy of the source above already covers the unrotated dice, and
+     * only the partial dice at the right and bottom borders still take
+     * the painter path. */
+    int ds = this->d->m_diceSize;
+    int width = src.width();
+    int height = src.height();
+    int mapWidth = this->d->m_diceMap.width();
+    int mapHeight = this->d->m_diceMap.height();
+
+    AkVideoFilterRunner::globalRunner()->run(mapHeight,
+                                             [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            auto diceLine = reinterpret_cast<const quint8 *>(this->d->m_diceMap.constScanLine(y));
+            int yp = ds * y;
+
+            if (yp + ds > height)
+                continue;
+
+            for (int x = 0; x < mapWidth; x++) {
+                quint8 direction = diceLine[x];
+                int xp = ds * x;
+
+                if (direction > 2 || xp + ds > width)
+                    continue;
+
+                for (int j = 0; j < ds; j++) {
+                    auto oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(yp + j)) + xp;
+
+                    if (direction == 0)
+                        for (int i = 0; i < ds; i++)
+                            oLine[i] = reinterpret_cast<const QRgb *>(src.constScanLine(yp + ds - 1 - i))[xp + j];
+                    else if (direction == 1)
+                        for (int i = 0; i < ds; i++)
+                            oLine[i] = reinterpret_cast<const QRgb *>(src.constScanLine(yp + i))[xp + ds - 1 - j];
+                    else
+                        for (int i = 0; i < ds; i++)
+                            oLine[i] = reinterpret_cast<const QRgb *>(src.constScanLine(yp + ds - 1 - j))[xp + ds - 1 - i];
+                }
+            }
+        }
+    });
+
     QTransform rotateLeft;
     QTransform rotateRight;
     QTransform rotate180;
@@ -117,14 +163,17 @@ AkPacket DiceElement::iStream(const AkPacket &packet)
     QPainter painter;
     painter.begin(&oFrame);
 
-    for (int y = 0; y < this->d->m_diceMap.height(); y++) {
+    for (int y = 0; y < mapHeight; y++) {
         auto diceLine = reinterpret_cast<const quint8 *>(this->d->m_diceMap.constScanLine(y));
+        int yp = ds * y;
+
+        for (int x = 0; x < mapWidth; x++) {
+            int xp = ds * x;
+
+            if (xp + ds <= width && yp + ds <= height)
+                continue;
 
-        for (int x = 0; x < this->d->m_diceMap.width(); x++) {
-            int xp = this->d->m_diceSize * x;
-            int yp = this->d->m_diceSize * y;
-            QImage dice = src.copy(xp, yp,
-                                   this->d->m_diceSize, this->d->m_diceSize);
+            QImage dice = src.copy(xp, yp, ds, ds);
             quint8 direction = diceLine[x];
 
             if (direction == 0)
@@ -17,11 +17,12 @@
  * Web-Site: http://webcamoid.github.io/
  */
 
+#include <QImage>
 #include <QtMath>
-#include <QPainter>
 #include <QQmlContext>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akvideofilterrunner.h>
 
 #include "dizzyelement.h"
 
@@ -138,9 +139,8 @@ AkPacket DizzyElement::iStream(const AkPacket &packet)
 
     src = src.convertToFormat(QImage::Format_ARGB32);
     QImage oFrame(src.size(), src.format());
-    oFrame.fill(0);
 
-    if (this->d->m_prevFrame.isNull()) {
+    if (this->d->m_prevFrame.isNull() || this->d->m_prevFrame.size() != src.size()) {
         this->d->m_prevFrame = QImage(src.size(), src.format());
         this->d->m_prevFrame.fill(0);
     }
@@ -151,20 +151,63 @@ AkPacket DizzyElement::iStream(const AkPacket &packet)
     qreal angle = (2 * M_PI / 180) * sin(pts) + (M_PI / 180) * sin(pts + 2.5);
     qreal scale = 1.0 + this->d->m_zoomRate;
 
-    QTransform transform;
-    transform.scale(scale, scale);
-    transform.rotateRadians(angle);
-    this->d->m_prevFrame = this->d->m_prevFrame.transformed(transform);
-
-    QRect rect(this->d->m_prevFrame.rect());
-    rect.moveCenter(oFrame.rect().center());
-
-    QPainter painter;
-    painter.begin(&oFrame);
-    painter.drawImage(rect, this->d->m_prevFrame);
-    painter.setOpacity(1.0 - this->d->m_strength);
-    painter.drawImage(0, 0, src);
-    painter.end();
+    /* Inverse-map the zoomed rotation about the frame center with a 16.16
+     * fixed point affine, stepped incrementally along each scanline, and
+     * blend the current frame over it in the same pass.
+     */
+    int width = src.width();
+    int height = src.height();
+    qreal cosA = cos(angle) / scale;
+    qreal sinA = sin(angle) / scale;
+    qreal cx = 0.5 * (width - 1);
+    qreal cy = 0.5 * (height - 1);
+    int cosF = qRound(65536.0 * cosA);
+    int sinF = qRound(65536.0 * sinA);
+    int txF = qRound(65536.0 * (cx - cosA * cx - sinA * cy));
+    int tyF = qRound(65536.0 * (cy + sinA * cx - cosA * cy));
+
+    int opacity = qRound(256.0 * (1.0 - this->d->m_strength));
+    const uchar *prevBits = this->d->m_prevFrame.constBits();
+    int prevBpl = this->d->m_prevFrame.bytesPerLine();
+
+    AkVideoFilterRunner::globalRunner()->run(height, [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            auto iLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
+            QRgb *oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+            int qxF = sinF * y + txF;
+            int qyF = cosF * y + tyF;
+
+            for (int x = 0; x < width; x++) {
+                int qx = qxF >> 16;
+                int qy = qyF >> 16;
+                qxF += cosF;
+                qyF -= sinF;
+
+                QRgb bg = qRgba(0, 0, 0, 0);
+
+                if (qx >= 0 && qx < width && qy >= 0 && qy < height)
+                    bg = reinterpret_cast<const QRgb *>(prevBits
+                                                        + qy * prevBpl)[qx];
+
+                QRgb fg = iLine[x];
+                int fa = (opacity * qAlpha(fg)) >> 8;
+
+                if (fa == 255) {
+                    oLine[x] = fg;
+                } else if (fa == 0) {
+                    oLine[x] = bg;
+                } else {
+                    int wf = 255 * fa;
+                    int wb = qAlpha(bg) * (255 - fa);
+                    int wo = wf + wb;
+                    oLine[x] = qRgba((qRed(fg) * wf + qRed(bg) * wb) / wo,
+                                     (qGreen(fg) * wf + qGreen(bg) * wb) / wo,
+                                     (qBlue(fg) * wf + qBlue(bg) * wb) / wo,
+                                     wo / 255);
+                }
+            }
+        }
+    });
 
     this->d->m_prevFrame = oFrame;
 
@@ -23,6 +23,11 @@
 #include <QtMath>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akvideofilterrunner.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #include "edgeelement.h"
 
@@ -95,85 +100,107 @@ QVector<quint8> EdgeElement::equalize(const QImage &image)
 
 void EdgeElement::sobel(int width, int height, const QVector<quint8> &gray,
                         QVector<quint16> &gradient,
-                        QVector<quint8> &direction) const
+                        QVector<quint8> &direction,
+                        bool withDirection) const
 {
     gradient.resize(gray.size());
     direction.resize(gray.size());
 
-    for (int y = 0; y < height; y++) {
-        int yOffset = y * width;
-        const quint8 *grayLine = gray.constData() + yOffset;
-
-        const quint8 *grayLine_m1 = y < 1? grayLine: grayLine - width;
-        const quint8 *grayLine_p1 = y >= height - 1? grayLine: grayLine + width;
-
-        quint16 *gradientLine = gradient.data() + yOffset;
-        quint8 *directionLine = direction.data() + yOffset;
-
-        for (int x = 0; x < width; x++) {
-            int x_m1 = x < 1? x: x - 1;
-            int x_p1 = x >= width - 1? x: x + 1;
-
-            int gradX = grayLine_m1[x_p1]
-                      + 2 * grayLine[x_p1]
-                      + grayLine_p1[x_p1]
-                      - grayLine_m1[x_m1]
-                      - 2 * grayLine[x_m1]
-                      - grayLine_p1[x_m1];
-
-            int gradY = grayLine_m1[x_m1]
-                      + 2 * grayLine_m1[x]
-                      + grayLine_m1[x_p1]
-                      - grayLine_p1[x_m1]
-                      - 2 * grayLine_p1[x]
-                      - grayLine_p1[x_p1];
-
-            gradientLine[x] = quint16(qAbs(gradX) + qAbs(gradY));
-
-            /* Gradient directions are classified in 4 possible cases
-             *
-             * dir 0
-             *
-             * x x x
-             * - - -
-             * x x x
-             *
-             * dir 1
-             *
-             * x x /
-             * x / x
-             * / x x
-             *
-             * dir 2
-             *
-             * \ x x
-             * x \ x
-             * x x \
-             *
-             * dir 3
-             *
-             * x | x
-             * x | x
-             * x | x
-             */
-            if (gradX == 0 && gradY == 0)
-                directionLine[x] = 0;
-            else if (gradX == 0)
-                directionLine[x] = 3;
-            else {
-                qreal a = 180. * atan(qreal(gradY) / gradX) / M_PI;
-
-                if (a >= -22.5 && a < 22.5)
+    /* tan(22.5°) and tan(67.5°) in 4.12 fixed point. Comparing the absolute
+     * gradients against them classifies the angle without evaluating atan()
+     * per pixel.
+     */
+    static const int tanPi8 = 1697;
+    static const int tan3Pi8 = 9889;
+
+    AkVideoFilterRunner::globalRunner()->run(height, [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            int yOffset = y * width;
+            const quint8 *grayLine = gray.constData() + yOffset;
+
+            const quint8 *grayLine_m1 = y < 1? grayLine: grayLine - width;
+            const quint8 *grayLine_p1 = y >= height - 1? grayLine: grayLine + width;
+
+            quint16 *gradientLine = gradient.data() + yOffset;
+            quint8 *directionLine = direction.data() + yOffset;
+
+            auto sobelAt = [&] (int x, int x_m1, int x_p1) {
+                int gradX = grayLine_m1[x_p1]
+                          + 2 * grayLine[x_p1]
+                          + grayLine_p1[x_p1]
+                          - grayLine_m1[x_m1]
+                          - 2 * grayLine[x_m1]
+                          - grayLine_p1[x_m1];
+
+                int gradY = grayLine_m1[x_m1]
+                          + 2 * grayLine_m1[x]
+                          + grayLine_m1[x_p1]
+                          - grayLine_p1[x_m1]
+                          - 2 * grayLine_p1[x]
+                          - grayLine_p1[x_p1];
+
+                gradientLine[x] = quint16(qAbs(gradX) + qAbs(gradY));
+
+                if (!withDirection)
+                    return;
+
+                /* Gradient directions are classified in 4 possible cases
+                 *
+                 * dir 0
+                 *
+                 * x x x
+                 * - - -
+                 * x x x
+                 *
+                 * dir 1
+                 *
+                 * x x /
+                 * x / x
+                 * / x x
+                 *
+                 * dir 2
+                 *
+                 * \ x x
+                 * x \ x
+                 * x x \
+                 *
+                 * dir 3
+                 *
+                 * x | x
+                 * x | x
+                 * x | x
+                 */
+                if (gradX == 0 && gradY == 0)
                     directionLine[x] = 0;
-                else if (a >= 22.5 && a < 67.5)
-                    directionLine[x] = 1;
-                else if (a >= -67.5 && a < -22.5)
-                    directionLine[x] = 2;
-                else
+                else if (gradX == 0)
                     directionLine[x] = 3;
-            }
+                else {
+                    int absX = qAbs(gradX);
+                    int absY = qAbs(gradY) << 12;
+
+                    if (absY < tanPi8 * absX)
+                        directionLine[x] = 0;
+                    else if (absY >= tan3Pi8 * absX)
+                        directionLine[x] = 3;
+                    else if ((gradX > 0) == (gradY > 0))
+                        directionLine[x] = 1;
+                    else
+                        directionLine[x] = 2;
+                }
+            };
+
+            /* The border columns take the clamped neighborhood, the interior
+             * reads its neighbors directly.
+             */
+            sobelAt(0, 0, qMin(1, width - 1));
+
+            for (int x = 1; x < width - 1; x++)
+                sobelAt(x, x - 1, x + 1);
+
+            if (width > 1)
+                sobelAt(width - 1, width - 2, width - 1);
         }
-    }
+    });
 }
 
 QVector<quint16> EdgeElement::thinning(int width, int height,
@@ -182,55 +209,57 @@ QVector<quint16> EdgeElement::thinning(int width, int height,
 {
     QVector<quint16> thinned(gradient.size(), 0);
 
-    for (int y = 0; y < height; y++) {
-        int yOffset = y * width;
-        const quint16 *edgesLine = gradient.constData() + yOffset;
-        const quint16 *edgesLine_m1 = y < 1? edgesLine: edgesLine - width;
-        const quint16 *edgesLine_p1 = y >= height - 1? edgesLine: edgesLine + width;
-        const quint8 *edgesAngleLine = direction.constData() + yOffset;
-        quint16 *thinnedLine = thinned.data() + yOffset;
-
-        for (int x = 0; x < width; x++) {
-            int x_m1 = x < 1? 0: x - 1;
-            int x_p1 = x >= width - 1? x: x + 1;
-
-            quint8 direction = edgesAngleLine[x];
-
-            if (direction == 0) {
-                /* x x x
-                 * - - -
-                 * x x x
-                 */
-                if (edgesLine[x] >= edgesLine[x_m1]
-                    && edgesLine[x] >= edgesLine[x_p1])
-                    thinnedLine[x] = edgesLine[x];
-            } else if (direction == 1) {
-                /* x x /
-                 * x / x
-                 * / x x
-                 */
-                if (edgesLine[x] >= edgesLine_m1[x_p1]
-                    && edgesLine[x] >= edgesLine_p1[x_m1])
-                    thinnedLine[x] = edgesLine[x];
-            } else if (direction == 2) {
-                /* \ x x
-                 * x \ x
-                 * x x \
-                 */
-                if (edgesLine[x] >= edgesLine_m1[x_m1]
-                    && edgesLine[x] >= edgesLine_p1[x_p1])
-                    thinnedLine[x] = edgesLine[x];
-            } else {
-                /* x | x
-                 * x | x
-                 * x | x
-                 */
-                if (edgesLine[x] >= edgesLine_m1[x]
-                    && edgesLine[x] >= edgesLine_p1[x])
-                    thinnedLine[x] = edgesLine[x];
+    AkVideoFilterRunner::globalRunner()->run(height, [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            int yOffset = y * width;
+            const quint16 *edgesLine = gradient.constData() + yOffset;
+            const quint16 *edgesLine_m1 = y < 1? edgesLine: edgesLine - width;
+            const quint16 *edgesLine_p1 = y >= height - 1? edgesLine: edgesLine + width;
+            const quint8 *edgesAngleLine = direction.constData() + yOffset;
+            quint16 *thinnedLine = thinned.data() + yOffset;
+
+            for (int x = 0; x < width; x++) {
+                int x_m1 = x < 1? 0: x - 1;
+                int x_p1 = x >= width - 1? x: x + 1;
+
+                quint8 direction = edgesAngleLine[x];
+
+                if (direction == 0) {
+                    /* x x x
+                     * - - -
+                     * x x x
+                     */
+                    if (edgesLine[x] >= edgesLine[x_m1]
+                        && edgesLine[x] >= edgesLine[x_p1])
+                        thinnedLine[x] = edgesLine[x];
+                } else if (direction == 1) {
+                    /* x x /
+                     * x / x
+                     * / x x
+                     */
+                    if (edgesLine[x] >= edgesLine_m1[x_p1]
+                        && edgesLine[x] >= edgesLine_p1[x_m1])
+                        thinnedLine[x] = edgesLine[x];
+                } else if (direction == 2) {
+                    /* \ x x
+                     * x \ x
+                     * x x \
+                     */
+                    if (edgesLine[x] >= edgesLine_m1[x_m1]
+                        && edgesLine[x] >= edgesLine_p1[x_p1])
+                        thinnedLine[x] = edgesLine[x];
+                } else {
+                    /* x | x
+                     * x | x
+                     * x | x
+                     */
+                    if (edgesLine[x] >= edgesLine_m1[x]
+                        && edgesLine[x] >= edgesLine_p1[x])
+                        thinnedLine[x] = edgesLine[x];
+                }
             }
         }
-    }
+    });
 
     return thinned;
 }
@@ -426,9 +455,13 @@ AkPacket EdgeElement::iStream(const AkPacket &packet)
 
     QVector<quint16> gradient;
     QVector<quint8> direction;
-    this->sobel(src.width(), src.height(), in, gradient, direction);
+    bool canny = this->m_canny;
+    bool invert = this->m_invert;
+
+    // The direction plane is only consumed by the thinning pass.
+    this->sobel(src.width(), src.height(), in, gradient, direction, canny);
 
-    if (this->m_canny) {
+    if (canny) {
         QVector<quint16> thinned = this->thinning(src.width(), src.height(),
                                                   gradient, direction);
 
@@ -443,26 +476,56 @@ AkPacket EdgeElement::iStream(const AkPacket &packet)
         QVector<quint8> thresholded = this->threshold(src.width(), src.height(),
                                                       thinned, thresholds, colors);
 
-        QVector<quint8> canny = this->hysteresisThresholding(src.width(), src.height(),
-                                                             thresholded);
+        QVector<quint8> cannyEdges =
+                this->hysteresisThresholding(src.width(), src.height(),
+                                             thresholded);
 
-        for (int y = 0; y < src.height(); y++) {
-            const quint8 *srcLine = canny.constData() + y * src.width();
-            quint8 *dstLine = oFrame.scanLine(y);
+        AkVideoFilterRunner::globalRunner()->run(src.height(),
+                                                 [&] (int yStart, int yEnd) {
+            for (int y = yStart; y < yEnd; y++) {
+                const quint8 *srcLine = cannyEdges.constData() + y * src.width();
+                quint8 *dstLine = oFrame.scanLine(y);
 
-            for (int x = 0; x < src.width(); x++)
-                dstLine[x] = this->m_invert? 255 - srcLine[x]: srcLine[x];
-        }
-    } else
-        for (int y = 0; y < src.height(); y++) {
-            const quint16 *srcLine = gradient.constData() + y * src.width();
-            quint8 *dstLine = oFrame.scanLine(y);
-
-            for (int x = 0; x < src.width(); x++) {
-                int gray = qBound<int>(0, srcLine[x], 255);
-                dstLine[x] = this->m_invert? quint8(255 - gray): quint8(gray);
+                for (int x = 0; x < src.width(); x++)
+                    dstLine[x] = invert? 255 - srcLine[x]: srcLine[x];
             }
-        }
+        });
+    } else {
+        int width = src.width();
+
+        AkVideoFilterRunner::globalRunner()->run(src.height(),
+                                                 [&] (int yStart, int yEnd) {
+            for (int y = yStart; y < yEnd; y++) {
+                const quint16 *srcLine = gradient.constData() + y * width;
+                quint8 *dstLine = oFrame.scanLine(y);
+                int x = 0;
+
+#if defined(__SSE2__)
+                /* The gradients never exceed 4080, so packing them as signed
+                 * 16 bit words saturates to the 0..255 range, and inverting
+                 * is a xor against 255.
+                 */
+                __m128i mask = _mm_set1_epi8(invert? char(0xff): 0);
+
+                for (; x + 16 <= width; x += 16) {
+                    __m128i lo =
+                            _mm_loadu_si128(reinterpret_cast<const __m128i *>(srcLine + x));
+                    __m128i hi =
+                            _mm_loadu_si128(reinterpret_cast<const __m128i *>(srcLine + x + 8));
+                    __m128i packed = _mm_packus_epi16(lo, hi);
+                    packed = _mm_xor_si128(packed, mask);
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(dstLine + x),
+                                     packed);
+                }
+#endif
+
+                for (; x < width; x++) {
+                    int gray = qBound<int>(0, srcLine[x], 255);
+                    dstLine[x] = invert? quint8(255 - gray): quint8(gray);
+                }
+            }
+        });
+    }
 
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
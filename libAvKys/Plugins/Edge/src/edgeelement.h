@@ -70,7 +70,8 @@ class EdgeElement: public AkElement
 
         QVector<quint8> equalize(const QImage &image);
         void sobel(int width, int height, const QVector<quint8> &gray,
-                   QVector<quint16> &gradient, QVector<quint8> &direction) const;
+                   QVector<quint16> &gradient, QVector<quint8> &direction,
+                   bool withDirection) const;
         QVector<quint16> thinning(int width, int height,
                                   const QVector<quint16> &gradient,
                                   const QVector<quint8> &direction) const;
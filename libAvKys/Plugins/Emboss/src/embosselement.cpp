@@ -22,6 +22,11 @@
 #include <QtMath>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akvideofilterrunner.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #include "embosselement.h"
 
@@ -94,43 +99,93 @@ AkPacket EmbossElement::iStream(const AkPacket &packet)
 
     src = src.convertToFormat(QImage::Format_Grayscale8);
     QImage oFrame(src.size(), src.format());
-
-    for (int y = 0; y < src.height(); y++) {
-        int y_m1 = y - 1;
-        int y_p1 = y + 1;
-
-        if (y_m1 < 0)
-            y_m1 = 0;
-
-        if (y_p1 >= src.height())
-            y_p1 = src.height() - 1;
-
-        const quint8 *srcLine_m1 = src.constScanLine(y_m1);
-        const quint8 *srcLine = src.constScanLine(y);
-        const quint8 *srcLine_p1 = src.constScanLine(y_p1);
-        quint8 *dstLine = oFrame.scanLine(y);
-
-        for (int x = 0; x < src.width(); x++) {
-            int x_m1 = x - 1;
-            int x_p1 = x + 1;
-
-            if (x_m1 < 0)
-                x_m1 = 0;
-
-            if (x_p1 >= src.width())
-                x_p1 = src.width() - 1;
-
-            int gray = srcLine_m1[x_m1] * 2
-                     + srcLine_m1[x]
-                     + srcLine[x_m1]
-                     - srcLine[x_p1]
-                     - srcLine_p1[x]
-                     - srcLine_p1[x_p1] * 2;
-
-            gray = qRound(this->m_factor * gray + this->m_bias);
-            dstLine[x] = quint8(qBound(0, gray, 255));
+    int width = src.width();
+    int height = src.height();
+
+    /* Factor and bias in 20.12 fixed point, so the kernel runs on integers
+     * only. The factor falls back to floating point in the unlikely case it
+     * does not fit in 16 bits.
+     */
+    int fk = qRound(this->m_factor * (1 << 12));
+    int bk = qRound(this->m_bias * (1 << 12)) + (1 << 11);
+    bool fixedPoint = fk >= -32768 && fk < 32768;
+    qreal factor = this->m_factor;
+    qreal bias = this->m_bias;
+
+    AkVideoFilterRunner::globalRunner()->run(height, [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            int y_m1 = qMax(y - 1, 0);
+            int y_p1 = qMin(y + 1, height - 1);
+
+            const quint8 *srcLine_m1 = src.constScanLine(y_m1);
+            const quint8 *srcLine = src.constScanLine(y);
+            const quint8 *srcLine_p1 = src.constScanLine(y_p1);
+            quint8 *dstLine = oFrame.scanLine(y);
+
+            auto embossAt = [&] (int x, int x_m1, int x_p1) {
+                int gray = srcLine_m1[x_m1] * 2
+                         + srcLine_m1[x]
+                         + srcLine[x_m1]
+                         - srcLine[x_p1]
+                         - srcLine_p1[x]
+                         - srcLine_p1[x_p1] * 2;
+
+                gray = fixedPoint?
+                           (gray * fk + bk) >> 12:
+                           qRound(factor * gray + bias);
+                dstLine[x] = quint8(qBound(0, gray, 255));
+            };
+
+            embossAt(0, 0, qMin(1, width - 1));
+            int x = 1;
+
+#if defined(__SSE2__)
+            if (fixedPoint) {
+                const __m128i zero = _mm_setzero_si128();
+                const __m128i vfk = _mm_set1_epi16(qint16(fk));
+                const __m128i vbk = _mm_set1_epi32(bk);
+
+                auto load = [&zero] (const quint8 *src) {
+                    auto bytes =
+                            _mm_loadl_epi64(reinterpret_cast<const __m128i *>(src));
+
+                    return _mm_unpacklo_epi8(bytes, zero);
+                };
+
+                for (; x + 8 <= width - 1; x += 8) {
+                    __m128i gray = load(srcLine_m1 + x - 1);
+                    gray = _mm_add_epi16(gray, gray);
+                    gray = _mm_add_epi16(gray, load(srcLine_m1 + x));
+                    gray = _mm_add_epi16(gray, load(srcLine + x - 1));
+                    gray = _mm_sub_epi16(gray, load(srcLine + x + 1));
+                    gray = _mm_sub_epi16(gray, load(srcLine_p1 + x));
+                    __m128i br = load(srcLine_p1 + x + 1);
+                    gray = _mm_sub_epi16(gray, _mm_add_epi16(br, br));
+
+                    // Widen the products to 32 bits for the factor and bias.
+                    __m128i lo = _mm_mullo_epi16(gray, vfk);
+                    __m128i hi = _mm_mulhi_epi16(gray, vfk);
+                    __m128i p0 = _mm_unpacklo_epi16(lo, hi);
+                    __m128i p1 = _mm_unpackhi_epi16(lo, hi);
+                    p0 = _mm_srai_epi32(_mm_add_epi32(p0, vbk), 12);
+                    p1 = _mm_srai_epi32(_mm_add_epi32(p1, vbk), 12);
+
+                    // The packs saturate the result to the 0..255 range.
+                    __m128i packed =
+                            _mm_packus_epi16(_mm_packs_epi32(p0, p1), zero);
+                    _mm_storel_epi64(reinterpret_cast<__m128i *>(dstLine + x),
+                                     packed);
+                }
+            }
+#endif
+
+            for (; x < width - 1; x++)
+                embossAt(x, x - 1, x + 1);
+
+            if (width > 1)
+                embossAt(width - 1, width - 2, width - 1);
         }
-    }
+    });
 
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
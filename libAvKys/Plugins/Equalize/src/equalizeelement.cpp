@@ -18,27 +18,58 @@
  */
 
 #include <QImage>
+#include <QMutex>
 #include <QVector>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akvideofilterrunner.h>
 
 #include "equalizeelement.h"
 #include "pixelstructs.h"
 
 EqualizeElement::EqualizeElement(): AkElement()
 {
+    this->m_sceneThreshold = 0.0;
 }
 
-QVector<quint64> EqualizeElement::histogram(const QImage &img) const
+qreal EqualizeElement::sceneThreshold() const
+{
+    return this->m_sceneThreshold;
+}
+
+QVector<quint64> EqualizeElement::histogram(const QImage &img, int yStep) const
 {
     QVector<quint64> histogram(256, 0);
+    QMutex mutex;
 
-    for (int y = 0; y < img.height(); y++) {
-        const QRgb *srcLine = reinterpret_cast<const QRgb *>(img.constScanLine(y));
+    // Each band accumulates into its own partial histogram, merged once at
+    // the end, so the bins are never contended between the threads.
+    AkVideoFilterRunner::globalRunner()->run(img.height(),
+                                             [&] (int yStart, int yEnd) {
+        quint64 partial[256];
+        memset(partial, 0, sizeof(partial));
 
-        for (int x = 0; x < img.width(); x++)
-            histogram[qGray(srcLine[x])]++;
-    }
+        for (int y = yStart; y < yEnd; y++) {
+            if (y % yStep)
+                continue;
+
+            auto srcLine = reinterpret_cast<const QRgb *>(img.constScanLine(y));
+
+            for (int x = 0; x < img.width(); x++)
+                partial[qGray(srcLine[x])]++;
+        }
+
+        mutex.lock();
+
+        for (int i = 0; i < 256; i++)
+            histogram[i] += partial[i];
+
+        mutex.unlock();
+    });
+
+    if (yStep > 1)
+        for (int i = 0; i < 256; i++)
+            histogram[i] *= quint64(yStep);
 
     return histogram;
 }
@@ -56,9 +87,9 @@ QVector<quint64> EqualizeElement::cumulativeHistogram(const QVector<quint64> &hi
     return cumulativeHistogram;
 }
 
-QVector<quint8> EqualizeElement::equalizationTable(const QImage &img) const
+QVector<quint8> EqualizeElement::equalizationTable(const QVector<quint64> &histogram) const
 {
-    QVector<quint64> cumHist = this->cumulativeHistogram(this->histogram(img));
+    QVector<quint64> cumHist = this->cumulativeHistogram(histogram);
     QVector<quint8> equalizationTable(cumHist.size());
     int maxLevel = cumHist.size() - 1;
     quint64 q = cumHist[maxLevel] - cumHist[0];
@@ -74,6 +105,20 @@ QVector<quint8> EqualizeElement::equalizationTable(const QImage &img) const
     return equalizationTable;
 }
 
+void EqualizeElement::setSceneThreshold(qreal sceneThreshold)
+{
+    if (qFuzzyCompare(this->m_sceneThreshold, sceneThreshold))
+        return;
+
+    this->m_sceneThreshold = sceneThreshold;
+    emit this->sceneThresholdChanged(sceneThreshold);
+}
+
+void EqualizeElement::resetSceneThreshold()
+{
+    this->setSceneThreshold(0.0);
+}
+
 AkPacket EqualizeElement::iStream(const AkPacket &packet)
 {
     QImage src = AkUtils::packetToImage(packet);
@@ -83,22 +128,54 @@ AkPacket EqualizeElement::iStream(const AkPacket &packet)
 
     src = src.convertToFormat(QImage::Format_ARGB32);
     QImage oFrame(src.size(), src.format());
-    QVector<quint8> equTable = this->equalizationTable(src);
+    qreal sceneThreshold = this->m_sceneThreshold;
+    bool reuse = false;
+
+    if (sceneThreshold > 0.0 && this->m_histogram.size() == 256) {
+        /* Temporal mode: a subsampled histogram measures the scene change.
+         * Below the threshold the stored histogram is only updated
+         * incrementally towards the sample, skipping the full-frame pass.
+         */
+        QVector<quint64> sampled = this->histogram(src, 4);
+        quint64 diff = 0;
+
+        for (int i = 0; i < 256; i++)
+            diff += quint64(qAbs(qint64(sampled[i])
+                                 - qint64(this->m_histogram[i])));
 
-    for (int y = 0; y < src.height(); y++) {
-        const QRgb *srcLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
-        QRgb *dstLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+        quint64 total = quint64(src.width()) * quint64(src.height());
 
-        for (int x = 0; x < src.width(); x++){
-            int r = equTable[qRed(srcLine[x])];
-            int g = equTable[qGreen(srcLine[x])];
-            int b = equTable[qBlue(srcLine[x])];
-            int a = equTable[qAlpha(srcLine[x])];
+        if (total > 0 && qreal(diff) / (2 * total) < sceneThreshold) {
+            for (int i = 0; i < 256; i++)
+                this->m_histogram[i] = (3 * this->m_histogram[i]
+                                        + sampled[i]) / 4;
 
-            dstLine[x] = qRgba(r, g, b, a);
+            reuse = true;
         }
     }
 
+    if (!reuse)
+        this->m_histogram = this->histogram(src);
+
+    QVector<quint8> equTable = this->equalizationTable(this->m_histogram);
+
+    AkVideoFilterRunner::globalRunner()->run(src.height(),
+                                             [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            auto srcLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
+            auto dstLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+
+            for (int x = 0; x < src.width(); x++) {
+                int r = equTable[qRed(srcLine[x])];
+                int g = equTable[qGreen(srcLine[x])];
+                int b = equTable[qBlue(srcLine[x])];
+                int a = equTable[qAlpha(srcLine[x])];
+
+                dstLine[x] = qRgba(r, g, b, a);
+            }
+        }
+    });
+
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
 }
@@ -25,16 +25,31 @@
 class EqualizeElement: public AkElement
 {
     Q_OBJECT
+    Q_PROPERTY(qreal sceneThreshold
+               READ sceneThreshold
+               WRITE setSceneThreshold
+               RESET resetSceneThreshold
+               NOTIFY sceneThresholdChanged)
 
     public:
         explicit EqualizeElement();
 
+        Q_INVOKABLE qreal sceneThreshold() const;
+
     private:
-        QVector<quint64> histogram(const QImage &img) const;
+        qreal m_sceneThreshold;
+        QVector<quint64> m_histogram;
+
+        QVector<quint64> histogram(const QImage &img, int yStep=1) const;
         QVector<quint64> cumulativeHistogram(const QVector<quint64> &histogram) const;
-        QVector<quint8> equalizationTable(const QImage &img) const;
+        QVector<quint8> equalizationTable(const QVector<quint64> &histogram) const;
+
+    signals:
+        void sceneThresholdChanged(qreal sceneThreshold);
 
     public slots:
+        void setSceneThreshold(qreal sceneThreshold);
+        void resetSceneThreshold();
         AkPacket iStream(const AkPacket &packet);
 };
 
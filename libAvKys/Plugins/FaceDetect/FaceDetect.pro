@@ -49,6 +49,15 @@ LIBS += -L$${PWD}/../../Lib/ -l$${COMMONS_TARGET}
 
 OTHER_FILES += pspec.json
 
+CONFIG(config_opencl) {
+    DEFINES += HAVE_OPENCL
+
+    HEADERS += src/haar/haardetectorcl.h
+    SOURCES += src/haar/haardetectorcl.cpp
+
+    LIBS += -lOpenCL
+}
+
 QT += qml widgets concurrent
 
 RESOURCES += \
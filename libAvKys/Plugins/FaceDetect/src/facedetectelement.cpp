@@ -75,6 +75,13 @@ class FaceDetectElementPrivate
         QSize m_scanSize;
         AkElementPtr m_blurFilter;
         HaarDetector m_cascadeClassifier;
+
+        /* Temporal tracking: between two full-frame scans only the inflated
+         * regions around the last detections are rescanned.
+         */
+        int m_fullScanInterval;
+        int m_framesToFullScan;
+        QVector<QRect> m_trackedFaces;
 };
 
 FaceDetectElement::FaceDetectElement(): AkElement()
@@ -92,6 +99,8 @@ FaceDetectElement::FaceDetectElement(): AkElement()
     this->d->m_scanSize = QSize(160, 120);
     this->d->m_blurFilter = AkElement::create("Blur");
     this->d->m_blurFilter->setProperty("radius", 32);
+    this->d->m_fullScanInterval = 0;
+    this->d->m_framesToFullScan = 0;
 
     QObject::connect(this->d->m_blurFilter.data(),
                      SIGNAL(radiusChanged(int)),
@@ -152,6 +161,11 @@ QSize FaceDetectElement::scanSize() const
     return this->d->m_scanSize;
 }
 
+int FaceDetectElement::fullScanInterval() const
+{
+    return this->d->m_fullScanInterval;
+}
+
 QString FaceDetectElement::controlInterfaceProvide(const QString &controlId) const
 {
     Q_UNUSED(controlId)
@@ -265,6 +279,16 @@ void FaceDetectElement::setScanSize(const QSize &scanSize)
     emit this->scanSizeChanged(scanSize);
 }
 
+void FaceDetectElement::setFullScanInterval(int fullScanInterval)
+{
+    if (this->d->m_fullScanInterval == fullScanInterval)
+        return;
+
+    this->d->m_fullScanInterval = fullScanInterval;
+    this->d->m_framesToFullScan = 0;
+    emit this->fullScanIntervalChanged(fullScanInterval);
+}
+
 void FaceDetectElement::resetHaarFile()
 {
     this->setHaarFile(":/FaceDetect/share/haarcascades/haarcascade_frontalface_alt.xml");
@@ -310,6 +334,11 @@ void FaceDetectElement::resetScanSize()
     this->setScanSize(QSize(160, 120));
 }
 
+void FaceDetectElement::resetFullScanInterval()
+{
+    this->setFullScanInterval(0);
+}
+
 AkPacket FaceDetectElement::iStream(const AkPacket &packet)
 {
     QSize scanSize(this->d->m_scanSize);
@@ -334,7 +363,62 @@ AkPacket FaceDetectElement::iStream(const AkPacket &packet)
         scale = qreal(src.height() / scanSize.height());
 
     this->d->m_cascadeClassifier.setEqualize(true);
-    QVector<QRect> vecFaces = this->d->m_cascadeClassifier.detect(scanFrame);
+
+    /* Under load the scale pyramid gets sparser: fewer intermediate
+     * window sizes are scanned, so a face can be caught one pyramid step
+     * later or jitter slightly in size, but every scan costs a fraction
+     * of the full sweep. */
+    qreal scaleFactor = 1.1;
+
+    switch (this->quality()) {
+    case AkElement::QualityBalanced:
+        scaleFactor = 1.2;
+        break;
+
+    case AkElement::QualityFast:
+        scaleFactor = 1.35;
+        break;
+
+    default:
+        break;
+    }
+
+    QVector<QRect> vecFaces;
+    bool tracking = this->d->m_fullScanInterval > 1
+                    && this->d->m_framesToFullScan > 0
+                    && !this->d->m_trackedFaces.isEmpty();
+
+    if (tracking) {
+        /* Only rescan the inflated regions around the last detections. An
+         * empty result falls back to a full scan right away, so lost or
+         * fast moving faces are picked up again.
+         */
+        for (const QRect &face: this->d->m_trackedFaces) {
+            QRect region = face.adjusted(-face.width() / 2,
+                                         -face.height() / 2,
+                                         face.width() / 2,
+                                         face.height() / 2)
+                           & scanFrame.rect();
+            QVector<QRect> regionFaces =
+                    this->d->m_cascadeClassifier.detect(scanFrame.copy(region),
+                                                        scaleFactor);
+
+            for (const QRect &regionFace: regionFaces)
+                vecFaces << regionFace.translated(region.topLeft());
+        }
+
+        this->d->m_framesToFullScan--;
+
+        if (vecFaces.isEmpty())
+            tracking = false;
+    }
+
+    if (!tracking) {
+        vecFaces = this->d->m_cascadeClassifier.detect(scanFrame, scaleFactor);
+        this->d->m_framesToFullScan = this->d->m_fullScanInterval - 1;
+    }
+
+    this->d->m_trackedFaces = vecFaces;
 
     if (vecFaces.isEmpty())
         akSend(packet)
@@ -74,6 +74,11 @@ class FaceDetectElement: public AkElement
                    WRITE setScanSize
                    RESET resetScanSize
                    NOTIFY scanSizeChanged)
+        Q_PROPERTY(int fullScanInterval
+                   READ fullScanInterval
+                   WRITE setFullScanInterval
+                   RESET resetFullScanInterval
+                   NOTIFY fullScanIntervalChanged)
 
     public:
         enum MarkerType
@@ -97,6 +102,7 @@ class FaceDetectElement: public AkElement
         Q_INVOKABLE QSize pixelGridSize() const;
         Q_INVOKABLE int blurRadius() const;
         Q_INVOKABLE QSize scanSize() const;
+        Q_INVOKABLE int fullScanInterval() const;
 
     private:
         FaceDetectElementPrivate *d;
@@ -116,6 +122,7 @@ class FaceDetectElement: public AkElement
         void pixelGridSizeChanged(const QSize &pixelGridSize);
         void blurRadiusChanged(int blurRadius);
         void scanSizeChanged(const QSize &scanSize);
+        void fullScanIntervalChanged(int fullScanInterval);
 
     public slots:
         void setHaarFile(const QString &haarFile);
@@ -127,6 +134,7 @@ class FaceDetectElement: public AkElement
         void setPixelGridSize(const QSize &pixelGridSize);
         void setBlurRadius(int blurRadius);
         void setScanSize(const QSize &scanSize);
+        void setFullScanInterval(int fullScanInterval);
         void resetHaarFile();
         void resetMarkerType();
         void resetMarkerColor();
@@ -136,6 +144,7 @@ class FaceDetectElement: public AkElement
         void resetPixelGridSize();
         void resetBlurRadius();
         void resetScanSize();
+        void resetFullScanInterval();
         AkPacket iStream(const AkPacket &packet);
 };
 
@@ -60,11 +60,16 @@
 #include <QtMath>
 
 #include <QFile>
+#include <QDataStream>
 #include <QXmlStreamReader>
 #include <QStringList>
 
 #include "haarcascade.h"
 
+// Compiled cascade blob identifier, bump the version on layout changes.
+#define HAAR_BINARY_MAGIC   0x616B4843
+#define HAAR_BINARY_VERSION 1
+
 HaarCascadeHID::HaarCascadeHID(const HaarCascade &cascade,
                                int startX,
                                int endX,
@@ -82,9 +87,7 @@ HaarCascadeHID::HaarCascadeHID(const HaarCascade &cascade,
                                const quint32 **p,
                                const quint64 **pq,
                                const quint32 **ip,
-                               const quint32 **icp,
-                               QList<QRect> *roi,
-                               QMutex *mutex)
+                               const quint32 **icp)
 {
     this->m_count = cascade.m_stages.size();
     this->m_stages = new HaarStageHID *[this->m_count];
@@ -100,8 +103,6 @@ HaarCascadeHID::HaarCascadeHID(const HaarCascade &cascade,
     this->m_invArea = invArea;
     this->m_isTree = cascade.m_isTree;
     this->m_cannyPruning = cannyPruning;
-    this->m_roi = roi;
-    this->m_mutex = mutex;
 
     for (int i = 0; i < 4; i++) {
         this->m_p[i] = p[i];
@@ -136,9 +137,13 @@ HaarCascadeHID::~HaarCascadeHID()
     delete [] this->m_stages;
 }
 
-void HaarCascadeHID::run(HaarCascadeHID *cascade)
+void HaarCascadeHID::run(const HaarCascadeHID *cascade,
+                         int startY,
+                         int endY,
+                         QList<QRect> *roi,
+                         QMutex *mutex)
 {
-    for (int j = cascade->m_startY; j < cascade->m_endY; j++) {
+    for (int j = startY; j < endY; j++) {
         int y = qRound(j * cascade->m_step);
         int iStep = 1;
 
@@ -206,19 +211,17 @@ void HaarCascadeHID::run(HaarCascadeHID *cascade)
                 }
 
             if (stageResult > 0) {
-                cascade->m_mutex->lock();
-                cascade->m_roi->append(QRect(x,
-                                             y,
-                                             cascade->m_windowWidth,
-                                             cascade->m_windowHeight));
-                cascade->m_mutex->unlock();
+                mutex->lock();
+                roi->append(QRect(x,
+                                  y,
+                                  cascade->m_windowWidth,
+                                  cascade->m_windowHeight));
+                mutex->unlock();
             }
 
             iStep = stageResult != 0? 1: 2;
         }
     }
-
-    delete cascade;
 }
 
 HaarCascade::HaarCascade(QObject *parent):
@@ -384,6 +387,149 @@ bool HaarCascade::load(const QString &fileName)
     return true;
 }
 
+bool HaarCascade::loadBinary(const QString &fileName)
+{
+    this->resetName();
+    this->resetWindowSize();
+    this->resetStages();
+    this->m_isTree = false;
+
+    QFile haarFile(fileName);
+
+    if (!haarFile.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&haarFile);
+    quint32 magic = 0;
+    qint32 version = 0;
+    stream >> magic >> version;
+
+    if (magic != HAAR_BINARY_MAGIC || version != HAAR_BINARY_VERSION)
+        return false;
+
+    QString name;
+    QSize windowSize;
+    bool isTree = false;
+    qint32 nStages = 0;
+    stream >> name >> windowSize >> isTree >> nStages;
+
+    if (stream.status() != QDataStream::Ok || nStages < 0)
+        return false;
+
+    HaarStageVector stages(nStages);
+
+    for (int i = 0; i < nStages; i++) {
+        qreal threshold = 0.0;
+        qint32 parent = -1;
+        qint32 next = -1;
+        qint32 child = -1;
+        qint32 nTrees = 0;
+        stream >> threshold >> parent >> next >> child >> nTrees;
+
+        if (stream.status() != QDataStream::Ok || nTrees < 0)
+            return false;
+
+        stages[i].setThreshold(threshold);
+        stages[i].setParentStage(parent);
+        stages[i].setNextStage(next);
+        stages[i].setChildStage(child);
+
+        HaarTreeVector trees(nTrees);
+
+        for (int j = 0; j < nTrees; j++) {
+            qint32 nFeatures = 0;
+            stream >> nFeatures;
+
+            if (stream.status() != QDataStream::Ok || nFeatures < 0)
+                return false;
+
+            HaarFeatureVector features(nFeatures);
+
+            for (int k = 0; k < nFeatures; k++) {
+                bool tilted = false;
+                qreal featureThreshold = 0.0;
+                qint32 leftNode = -1;
+                qreal leftVal = 0.0;
+                qint32 rightNode = -1;
+                qreal rightVal = 0.0;
+                RectVector rects;
+                RealVector weight;
+                stream >> tilted
+                       >> featureThreshold
+                       >> leftNode
+                       >> leftVal
+                       >> rightNode
+                       >> rightVal
+                       >> rects
+                       >> weight;
+
+                features[k].setTilted(tilted);
+                features[k].setThreshold(featureThreshold);
+                features[k].setLeftNode(leftNode);
+                features[k].setLeftVal(leftVal);
+                features[k].setRightNode(rightNode);
+                features[k].setRightVal(rightVal);
+                features[k].setRects(rects);
+                features[k].setWeight(weight);
+            }
+
+            trees[j].setFeatures(features);
+        }
+
+        stages[i].setTrees(trees);
+    }
+
+    if (stream.status() != QDataStream::Ok)
+        return false;
+
+    this->m_name = name;
+    this->m_windowSize = windowSize;
+    this->m_stages = stages;
+    this->m_isTree = isTree;
+
+    return true;
+}
+
+bool HaarCascade::saveBinary(const QString &fileName) const
+{
+    QFile haarFile(fileName);
+
+    if (!haarFile.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream stream(&haarFile);
+    stream << quint32(HAAR_BINARY_MAGIC)
+           << qint32(HAAR_BINARY_VERSION)
+           << this->m_name
+           << this->m_windowSize
+           << this->m_isTree
+           << qint32(this->m_stages.size());
+
+    for (auto &stage: this->m_stages) {
+        stream << stage.threshold()
+               << qint32(stage.parentStage())
+               << qint32(stage.nextStage())
+               << qint32(stage.childStage())
+               << qint32(stage.trees().size());
+
+        for (auto &tree: stage.trees()) {
+            stream << qint32(tree.features().size());
+
+            for (auto &feature: tree.features())
+                stream << feature.tilted()
+                       << feature.threshold()
+                       << qint32(feature.leftNode())
+                       << feature.leftVal()
+                       << qint32(feature.rightNode())
+                       << feature.rightVal()
+                       << feature.rects()
+                       << feature.weight();
+        }
+    }
+
+    return stream.status() == QDataStream::Ok;
+}
+
 HaarCascade &HaarCascade::operator =(const HaarCascade &other)
 {
     if (this != &other) {
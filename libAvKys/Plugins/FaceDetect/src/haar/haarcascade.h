@@ -26,6 +26,12 @@
 
 class HaarCascade;
 
+/* Hidden/precomputed state for scanning one scale level: the stages with
+ * their feature offsets resolved against the integral images. Building it
+ * is not free, so the detector caches one instance per scale while the
+ * frame geometry and the detection parameters stay the same. Scanning is
+ * read-only, several row bands of the same instance can run in parallel.
+ */
 class HaarCascadeHID
 {
     public:
@@ -46,12 +52,24 @@ class HaarCascadeHID
                                 const quint32 **p,
                                 const quint64 **pq,
                                 const quint32 **ip,
-                                const quint32 **icp,
-                                QList<QRect> *roi,
-                                QMutex *mutex);
+                                const quint32 **icp);
         ~HaarCascadeHID();
 
-        static void run(HaarCascadeHID *cascade);
+        inline int startY() const
+        {
+            return this->m_startY;
+        }
+
+        inline int endY() const
+        {
+            return this->m_endY;
+        }
+
+        static void run(const HaarCascadeHID *cascade,
+                        int startY,
+                        int endY,
+                        QList<QRect> *roi,
+                        QMutex *mutex);
 
     private:
         int m_count;
@@ -71,8 +89,8 @@ class HaarCascadeHID
         const quint64 *m_pq[4];
         const quint32 *m_ip[4];
         const quint32 *m_icp[4];
-        QList<QRect> *m_roi;
-        QMutex *m_mutex;
+
+    friend class HaarDetectorCL;
 };
 
 class HaarCascade: public QObject
@@ -111,6 +129,14 @@ class HaarCascade: public QObject
         Q_INVOKABLE QString errorString() const;
         Q_INVOKABLE bool load(const QString &fileName);
 
+        /* Compiled cascade format: the stages, trees and features flattened
+         * into a single binary blob, read back with zero parsing. Loading
+         * the XML source takes hundreds of milliseconds, loading the blob
+         * is a plain sequential read.
+         */
+        Q_INVOKABLE bool loadBinary(const QString &fileName);
+        Q_INVOKABLE bool saveBinary(const QString &fileName) const;
+
         HaarCascade &operator =(const HaarCascade &other);
         bool operator ==(const HaarCascade &other) const;
         bool operator !=(const HaarCascade &other) const;
@@ -59,14 +59,27 @@
 
 #include <QtMath>
 #include <QtConcurrent>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #include "haarcascade.h"
 #include "haardetector.h"
 
+#ifdef HAVE_OPENCL
+#include "haardetectorcl.h"
+#endif
+
 class HaarDetectorPrivate
 {
     public:
         HaarCascade m_cascade;
+        QString m_pendingCascade;
         bool m_equalize;
         int m_denoiseRadius;
         int m_denoiseMu;
@@ -78,6 +91,34 @@ class HaarDetectorPrivate
         QVector<int> m_weight;
         QMutex m_mutex;
 
+        /* Scratch planes reused from frame to frame, and the precomputed
+         * per-scale scan state, valid while the frame geometry and the
+         * detection parameters stay the same.
+         */
+        QVector<quint8> m_gray;
+        QVector<quint8> m_denoised;
+        QVector<quint32> m_integral;
+        QVector<quint64> m_integral2;
+        QVector<quint32> m_tiltedIntegral;
+        QVector<quint32> m_integralCanny;
+        QVector<HaarCascadeHID *> m_scaleCache;
+        QSize m_cacheFrameSize;
+        qreal m_cacheScaleFactor;
+        QSize m_cacheMinObjectSize;
+        QSize m_cacheMaxObjectSize;
+        bool m_cacheCannyPruning;
+        bool m_cacheValid;
+
+#ifdef HAVE_OPENCL
+        /* The GPU evaluator mirrors the scale cache on the device and keeps
+         * the CPU scan below as its fallback.
+         */
+        HaarDetectorCL m_gpu;
+        bool m_gpuCascadeValid;
+#endif
+
+        void clearScaleCache();
+        void loadPendingCascade();
         QVector<int> makeWeightTable(int factor) const;
         void computeGray(const QImage &src, bool equalize,
                          QVector<quint8> &gray) const;
@@ -138,6 +179,48 @@ class HaarDetectorPrivate
                                    qreal eps=0.2) const;
 };
 
+void HaarDetectorPrivate::clearScaleCache()
+{
+    qDeleteAll(this->m_scaleCache);
+    this->m_scaleCache.clear();
+    this->m_cacheValid = false;
+}
+
+/* Deferred cascade load, called with the mutex held.
+ *
+ * The XML is parsed only when a detection actually runs, so creating the
+ * element or toggling the effect off doesn't pay for it. The parsed result
+ * is kept as a compiled blob in the cache directory, keyed by the source
+ * file name, and later loads read the blob with no parsing at all.
+ */
+void HaarDetectorPrivate::loadPendingCascade()
+{
+    if (this->m_pendingCascade.isEmpty())
+        return;
+
+    auto fileName = this->m_pendingCascade;
+    this->m_pendingCascade.clear();
+
+    // The file may already be a compiled cascade.
+    if (this->m_cascade.loadBinary(fileName))
+        return;
+
+    auto cacheDir =
+            QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+            + "/haarcascades";
+    auto hash = QCryptographicHash::hash(fileName.toUtf8(),
+                                         QCryptographicHash::Md5).toHex();
+    auto compiledFile = cacheDir + "/" + hash + ".hcb";
+
+    if (this->m_cascade.loadBinary(compiledFile))
+        return;
+
+    if (this->m_cascade.load(fileName)) {
+        QDir().mkpath(cacheDir);
+        this->m_cascade.saveBinary(compiledFile);
+    }
+}
+
 QVector<int> HaarDetectorPrivate::makeWeightTable(int factor) const
 {
     QVector<int> weight(1 << 24);
@@ -322,77 +405,139 @@ void HaarDetectorPrivate::computeIntegral(int width, int height,
     int oWidth = width + 1;
     int oHeight = height + 1;
     int outSize = oWidth * oHeight;
-    integral.resize(outSize);
-    integral2.resize(outSize);
-    tiltedIntegral.resize(outSize);
-
     int oWidth2 = oWidth + 1;
-    quint32 *integralLine = integral.data() + oWidth2;
-    quint64 *integral2Line = integral2.data() + oWidth2;
-    quint32 *tiltedIntegralLine = tiltedIntegral.data() + oWidth2;
 
-    quint8 pixel;
-    quint32 sum = 0;
-    quint64 sum2 = 0;
+    // Allocating fresh planes zeroes the borders. The first row and column
+    // are never written again, so the planes can be reused as is on the
+    // following frames.
+    if (integral.size() != outSize) {
+        integral = QVector<quint32>(outSize);
+        integral2 = QVector<quint64>(outSize);
+        tiltedIntegral = QVector<quint32>(outSize);
+    }
 
-    for (int x = 0; x < width; x++) {
-        pixel = image[x];
-        sum += pixel;
-        sum2 += pixel * pixel;
+    /* The tilted integral carries a diagonal recurrence from one row to the
+     * next, so it stays a single sequential sweep, running concurrently with
+     * the two passes below.
+     */
+    QFuture<void> tilted = QtConcurrent::run([&] () {
+        quint32 *tiltedIntegralLine = tiltedIntegral.data() + oWidth2;
 
-        integralLine[x] = sum;
-        integral2Line[x] = sum2;
-        tiltedIntegralLine[x] = pixel;
-    }
+        for (int x = 0; x < width; x++)
+            tiltedIntegralLine[x] = image[x];
 
-    for (int y = 2; y < oHeight; y++) {
-        const quint8 *imageLine_mow = image.constData() + y * width - oWidth;
-        const quint8 *imageLine_mow_mw = imageLine_mow - width;
+        for (int y = 2; y < oHeight; y++) {
+            const quint8 *imageLine_mow = image.constData() + y * width - oWidth;
+            const quint8 *imageLine_mow_mw = imageLine_mow - width;
 
-        int yoOffset = y * oWidth;
+            tiltedIntegralLine = tiltedIntegral.data() + y * oWidth;
+            quint32 *tiltedIntegralLine_mow2 = tiltedIntegralLine - oWidth2;
+            quint32 *tiltedIntegralLine_mw = tiltedIntegralLine - width;
+            quint32 *tiltedIntegralLine_m2ow = tiltedIntegralLine - 2 * oWidth;
 
-        integralLine = integral.data() + yoOffset;
-        quint32 *integralLine_mow = integralLine - oWidth;
+            for (int x = 0; x < oWidth; x++) {
+                quint32 tiltedSum = 0;
 
-        integral2Line = integral2.data() + yoOffset;
-        quint64 *integral2Line_mow = integral2Line - oWidth;
+                if (x > 0) {
+                    tiltedSum += imageLine_mow[x];
+                    tiltedSum += imageLine_mow_mw[x];
+                    tiltedSum += tiltedIntegralLine_mow2[x];
+                }
 
-        tiltedIntegralLine = tiltedIntegral.data() + yoOffset;
-        quint32 *tiltedIntegralLine_mow2 = tiltedIntegralLine - oWidth2;
-        quint32 *tiltedIntegralLine_mw = tiltedIntegralLine - width;
-        quint32 *tiltedIntegralLine_m2ow = tiltedIntegralLine - 2 * oWidth;
+                if (x < width) {
+                    tiltedSum += tiltedIntegralLine_mw[x];
 
-        sum = 0;
-        sum2 = 0;
+                    if (x > 0)
+                        tiltedSum -= tiltedIntegralLine_m2ow[x];
+                }
 
-        for (int x = 0; x < oWidth; x++) {
-            if (x > 0) {
-                pixel = imageLine_mow[x];
-                sum += pixel;
-                sum2 += pixel * pixel;
-            } else
-                pixel = 0;
+                tiltedIntegralLine[x] = tiltedSum;
+            }
+        }
+    });
 
-            integralLine[x] = sum + integralLine_mow[x];
-            integral2Line[x] = sum2 + integral2Line_mow[x];
+    QThreadPool threadPool;
 
-            quint32 tiltedSum = pixel;
+    if (threadPool.maxThreadCount() < 8)
+        threadPool.setMaxThreadCount(8);
 
-            if (x > 0) {
-                tiltedSum += imageLine_mow_mw[x];
-                tiltedSum += tiltedIntegralLine_mow2[x];
+    /* The plain integrals split into two separable passes: horizontal prefix
+     * sums with independent rows, then a vertical accumulation with
+     * independent columns, so both run in parallel bands.
+     */
+    int nBands = threadPool.maxThreadCount();
+    int bandHeight = qMax((height + nBands - 1) / nBands, 1);
+
+    for (int bandStart = 1; bandStart < oHeight; bandStart += bandHeight) {
+        int bandEnd = qMin(bandStart + bandHeight, oHeight);
+
+        QtConcurrent::run(&threadPool, [&, bandStart, bandEnd] () {
+            for (int y = bandStart; y < bandEnd; y++) {
+                const quint8 *imageLine = image.constData() + (y - 1) * width;
+                quint32 *integralLine = integral.data() + y * oWidth;
+                quint64 *integral2Line = integral2.data() + y * oWidth;
+                quint32 sum = 0;
+                quint64 sum2 = 0;
+
+                for (int x = 1; x < oWidth; x++) {
+                    quint8 pixel = imageLine[x - 1];
+                    sum += pixel;
+                    sum2 += pixel * pixel;
+                    integralLine[x] = sum;
+                    integral2Line[x] = sum2;
+                }
             }
+        });
+    }
 
-            if (x < width) {
-                tiltedSum += tiltedIntegralLine_mw[x];
+    threadPool.waitForDone();
 
-                if (x > 0)
-                    tiltedSum -= tiltedIntegralLine_m2ow[x];
-            }
+    int bandWidth = qMax((width + nBands - 1) / nBands, 1);
+
+    for (int bandStart = 1; bandStart < oWidth; bandStart += bandWidth) {
+        int bandEnd = qMin(bandStart + bandWidth, oWidth);
+
+        QtConcurrent::run(&threadPool, [&, bandStart, bandEnd] () {
+            for (int y = 2; y < oHeight; y++) {
+                quint32 *integralLine = integral.data() + y * oWidth;
+                quint64 *integral2Line = integral2.data() + y * oWidth;
+                const quint32 *integralPrevLine = integralLine - oWidth;
+                const quint64 *integral2PrevLine = integral2Line - oWidth;
+                int x = bandStart;
+
+#if defined(__SSE2__)
+                for (; x + 4 <= bandEnd; x += 4) {
+                    auto line = reinterpret_cast<__m128i *>(integralLine + x);
+                    auto prevLine = reinterpret_cast<const __m128i *>(integralPrevLine + x);
+                    _mm_storeu_si128(line,
+                                     _mm_add_epi32(_mm_loadu_si128(line),
+                                                   _mm_loadu_si128(prevLine)));
+                }
+#endif
 
-            tiltedIntegralLine[x] = tiltedSum;
-        }
+                for (; x < bandEnd; x++)
+                    integralLine[x] += integralPrevLine[x];
+
+                x = bandStart;
+
+#if defined(__SSE2__)
+                for (; x + 2 <= bandEnd; x += 2) {
+                    auto line = reinterpret_cast<__m128i *>(integral2Line + x);
+                    auto prevLine = reinterpret_cast<const __m128i *>(integral2PrevLine + x);
+                    _mm_storeu_si128(line,
+                                     _mm_add_epi64(_mm_loadu_si128(line),
+                                                   _mm_loadu_si128(prevLine)));
+                }
+#endif
+
+                for (; x < bandEnd; x++)
+                    integral2Line[x] += integral2PrevLine[x];
+            }
+        });
     }
+
+    threadPool.waitForDone();
+    tilted.waitForFinished();
 }
 
 QVector<quint8> HaarDetectorPrivate::canny(int width, int height,
@@ -988,12 +1133,21 @@ HaarDetector::HaarDetector(QObject *parent): QObject(parent)
     this->d->m_lowCannyThreshold = 0;
     this->d->m_highCannyThreshold = 50;
     this->d->m_minNeighbors = 3;
+    this->d->m_cacheScaleFactor = 0;
+    this->d->m_cacheCannyPruning = false;
+    this->d->m_cacheValid = false;
+
+#ifdef HAVE_OPENCL
+    this->d->m_gpuCascadeValid = false;
+#endif
 
     this->d->m_weight = this->d->makeWeightTable(1024);
 }
 
 HaarDetector::~HaarDetector()
 {
+    this->d->clearScaleCache();
+
     delete this->d;
 }
 
@@ -1080,7 +1234,13 @@ int &HaarDetector::minNeighbors()
 bool HaarDetector::loadCascade(const QString &fileName)
 {
     this->d->m_mutex.lock();
-    bool r = this->d->m_cascade.load(fileName);
+    /* Only record the file here, the load runs lazily on the first
+     * detection. A malformed cascade is reported by detect() returning
+     * nothing instead of by this call.
+     */
+    this->d->m_pendingCascade = fileName;
+    this->d->clearScaleCache();
+    bool r = QFile::exists(fileName);
     this->d->m_mutex.unlock();
 
     return r;
@@ -1089,27 +1249,36 @@ bool HaarDetector::loadCascade(const QString &fileName)
 QVector<QRect> HaarDetector::detect(const QImage &image, qreal scaleFactor,
                                     QSize minObjectSize, QSize maxObjectSize) const
 {
-    QVector<quint8> gray;
+    // The scratch planes and the per-scale cache are shared between calls.
+    this->d->m_mutex.lock();
+    this->d->loadPendingCascade();
+
+    if (this->d->m_cascade.stages().isEmpty()) {
+        this->d->m_mutex.unlock();
+
+        return QVector<QRect>();
+    }
+
+    QVector<quint8> &gray = this->d->m_gray;
     this->d->computeGray(image, this->d->m_equalize, gray);
 
     if (this->d->m_denoiseRadius > 0) {
-        QVector<quint8> denoised;
         this->d->denoise(image.width(), image.height(), gray,
                          this->d->m_denoiseRadius,
                          this->d->m_denoiseMu,
                          this->d->m_denoiseSigma,
-                         denoised);
+                         this->d->m_denoised);
 
-        gray = denoised;
+        gray = this->d->m_denoised;
     }
 
-    QVector<quint32> integral;
-    QVector<quint64> integral2;
-    QVector<quint32> tiltedIntegral;
+    QVector<quint32> &integral = this->d->m_integral;
+    QVector<quint64> &integral2 = this->d->m_integral2;
+    QVector<quint32> &tiltedIntegral = this->d->m_tiltedIntegral;
     this->d->computeIntegral(image.width(), image.height(), gray,
                              integral, integral2, tiltedIntegral);
 
-    QVector<quint32> integralCanny;
+    QVector<quint32> &integralCanny = this->d->m_integralCanny;
     bool cannyPruning = this->d->m_cannyPruning;
 
     if (cannyPruning) {
@@ -1123,109 +1292,170 @@ QVector<QRect> HaarDetector::detect(const QImage &image, qreal scaleFactor,
 
     int oWidth = image.width() + 1;
 
-    const quint32 *p[4];
-    const quint64 *pq[4];
-    const quint32 *ip[4];
-    const quint32 *icp[4];
-
-    QList<QRect> roi;
-    QThreadPool threadPool;
-    QMutex mutex;
-    static const int border = 1;
+    /* The per-scale scan state embeds the scaled feature offsets and the
+     * window pointers into the integral planes. All of it is a function of
+     * the frame geometry and the detection parameters alone, so it is
+     * rebuilt only when one of them changes or the cascade is reloaded.
+     */
+    if (!this->d->m_cacheValid
+        || this->d->m_cacheFrameSize != image.size()
+        || !qFuzzyCompare(this->d->m_cacheScaleFactor, scaleFactor)
+        || this->d->m_cacheMinObjectSize != minObjectSize
+        || this->d->m_cacheMaxObjectSize != maxObjectSize
+        || this->d->m_cacheCannyPruning != cannyPruning) {
+        this->d->clearScaleCache();
+
+        const quint32 *p[4];
+        const quint64 *pq[4];
+        const quint32 *ip[4];
+        const quint32 *icp[4];
+        static const int border = 1;
+
+        for (qreal scale = 1; ; scale *= scaleFactor) {
+            int windowWidth = qRound(scale * this->d->m_cascade.windowSize().width());
+            int windowHeight = qRound(scale * this->d->m_cascade.windowSize().height());
+
+            if (windowWidth > image.width()
+                || windowHeight > image.height())
+                break;
 
-    if (threadPool.maxThreadCount() < 8)
-        threadPool.setMaxThreadCount(8);
+            if (!minObjectSize.isEmpty())
+                if (windowWidth < minObjectSize.width()
+                    || windowHeight < minObjectSize.height())
+                    continue;
 
-    this->d->m_mutex.lock();
+            if (!maxObjectSize.isEmpty())
+                if (windowWidth > maxObjectSize.width()
+                    || windowHeight > maxObjectSize.height())
+                    break;
+
+            size_t offset0;
+            size_t offset1;
+            size_t offset2;
+            size_t offset3;
+
+            if (cannyPruning) {
+                int x = qRound(0.15 * windowWidth);
+                int y = qRound(0.15 * windowHeight);
+                int width = qRound(0.7 * windowWidth);
+                int height = qRound(0.7 * windowHeight);
+
+                offset0 = size_t(x + y * oWidth);
+                offset1 = size_t(x + width + y * oWidth);
+                offset2 = size_t(x + (y + height) * oWidth);
+                offset3 = size_t(x + width + (y + height) * oWidth);
+
+                ip[0] = integral.constData() + offset0;
+                ip[1] = integral.constData() + offset1;
+                ip[2] = integral.constData() + offset2;
+                ip[3] = integral.constData() + offset3;
+
+                icp[0] = integralCanny.constData() + offset0;
+                icp[1] = integralCanny.constData() + offset1;
+                icp[2] = integralCanny.constData() + offset2;
+                icp[3] = integralCanny.constData() + offset3;
+            }
 
-    for (qreal scale = 1; ; scale *= scaleFactor) {
-        int windowWidth = qRound(scale * this->d->m_cascade.windowSize().width());
-        int windowHeight = qRound(scale * this->d->m_cascade.windowSize().height());
+            int rectX = qRound(scale * border);
+            int rectY = qRound(scale * border);
+            int rectWidth = qRound(scale * (this->d->m_cascade.windowSize().width() - 2 * border));
+            int rectHeight = qRound(scale * (this->d->m_cascade.windowSize().height() - 2 * border));
+
+            offset0 = size_t(rectX + rectY * oWidth);
+            offset1 = size_t(rectX + rectWidth + rectY * oWidth);
+            offset2 = size_t(rectX + (rectY + rectHeight) * oWidth);
+            offset3 = size_t(rectX + rectWidth + (rectY + rectHeight) * oWidth);
+
+            p[0] = integral.constData() + offset0;
+            p[1] = integral.constData() + offset1;
+            p[2] = integral.constData() + offset2;
+            p[3] = integral.constData() + offset3;
+
+            pq[0] = integral2.constData() + offset0;
+            pq[1] = integral2.constData() + offset1;
+            pq[2] = integral2.constData() + offset2;
+            pq[3] = integral2.constData() + offset3;
+
+            qreal invArea = 1.0 / (rectWidth * rectHeight);
+            qreal step = qMax(2.0, scale);
+
+            int startX = 0;
+            int startY = 0;
+            int endX = qRound((image.width() - windowWidth) / step);
+            int endY = qRound((image.height() - windowHeight) / step);
+
+            this->d->m_scaleCache << new HaarCascadeHID(this->d->m_cascade,
+                                                        startX, endX, startY, endY,
+                                                        windowWidth, windowHeight,
+                                                        oWidth,
+                                                        integral.constData(),
+                                                        tiltedIntegral.constData(),
+                                                        step,
+                                                        invArea,
+                                                        scale,
+                                                        cannyPruning,
+                                                        p, pq, ip, icp);
+        }
 
-        if (windowWidth > image.width()
-            || windowHeight > image.height())
-            break;
+        this->d->m_cacheFrameSize = image.size();
+        this->d->m_cacheScaleFactor = scaleFactor;
+        this->d->m_cacheMinObjectSize = minObjectSize;
+        this->d->m_cacheMaxObjectSize = maxObjectSize;
+        this->d->m_cacheCannyPruning = cannyPruning;
+        this->d->m_cacheValid = true;
+
+#ifdef HAVE_OPENCL
+        this->d->m_gpuCascadeValid =
+                this->d->m_gpu.isValid()
+                && this->d->m_gpu.uploadCascade(this->d->m_scaleCache,
+                                                integral.constData(),
+                                                integral2.constData(),
+                                                tiltedIntegral.constData());
+#endif
+    }
 
-        if (!minObjectSize.isEmpty())
-            if (windowWidth < minObjectSize.width()
-                || windowHeight < minObjectSize.height())
-                continue;
+#ifdef HAVE_OPENCL
+    if (this->d->m_gpuCascadeValid) {
+        QList<QRect> gpuRoi;
 
-        if (!maxObjectSize.isEmpty())
-            if (windowWidth > maxObjectSize.width()
-                || windowHeight > maxObjectSize.height())
-                break;
+        if (this->d->m_gpu.scan(integral,
+                                integral2,
+                                tiltedIntegral,
+                                &gpuRoi)) {
+            this->d->m_mutex.unlock();
 
-        size_t offset0;
-        size_t offset1;
-        size_t offset2;
-        size_t offset3;
-
-        if (cannyPruning) {
-            int x = qRound(0.15 * windowWidth);
-            int y = qRound(0.15 * windowHeight);
-            int width = qRound(0.7 * windowWidth);
-            int height = qRound(0.7 * windowHeight);
-
-            offset0 = size_t(x + y * oWidth);
-            offset1 = size_t(x + width + y * oWidth);
-            offset2 = size_t(x + (y + height) * oWidth);
-            offset3 = size_t(x + width + (y + height) * oWidth);
-
-            ip[0] = integral.constData() + offset0;
-            ip[1] = integral.constData() + offset1;
-            ip[2] = integral.constData() + offset2;
-            ip[3] = integral.constData() + offset3;
-
-            icp[0] = integralCanny.constData() + offset0;
-            icp[1] = integralCanny.constData() + offset1;
-            icp[2] = integralCanny.constData() + offset2;
-            icp[3] = integralCanny.constData() + offset3;
+            return this->d->groupRectangles(gpuRoi.toVector(),
+                                            this->d->m_minNeighbors);
         }
 
-        int rectX = qRound(scale * border);
-        int rectY = qRound(scale * border);
-        int rectWidth = qRound(scale * (this->d->m_cascade.windowSize().width() - 2 * border));
-        int rectHeight = qRound(scale * (this->d->m_cascade.windowSize().height() - 2 * border));
-
-        offset0 = size_t(rectX + rectY * oWidth);
-        offset1 = size_t(rectX + rectWidth + rectY * oWidth);
-        offset2 = size_t(rectX + (rectY + rectHeight) * oWidth);
-        offset3 = size_t(rectX + rectWidth + (rectY + rectHeight) * oWidth);
-
-        p[0] = integral.constData() + offset0;
-        p[1] = integral.constData() + offset1;
-        p[2] = integral.constData() + offset2;
-        p[3] = integral.constData() + offset3;
-
-        pq[0] = integral2.constData() + offset0;
-        pq[1] = integral2.constData() + offset1;
-        pq[2] = integral2.constData() + offset2;
-        pq[3] = integral2.constData() + offset3;
-
-        qreal invArea = 1.0 / (rectWidth * rectHeight);
-        qreal step = qMax(2.0, scale);
-
-        int startX = 0;
-        int startY = 0;
-        int endX = qRound((image.width() - windowWidth) / step);
-        int endY = qRound((image.height() - windowHeight) / step);
-
-        HaarCascadeHID *cascade = new HaarCascadeHID(this->d->m_cascade,
-                                                     startX, endX, startY, endY,
-                                                     windowWidth, windowHeight,
-                                                     oWidth,
-                                                     integral.constData(),
-                                                     tiltedIntegral.constData(),
-                                                     step,
-                                                     invArea,
-                                                     scale,
-                                                     cannyPruning,
-                                                     p, pq, ip, icp,
-                                                     &roi,
-                                                     &mutex);
-
-        QtConcurrent::run(&threadPool, HaarCascadeHID::run, cascade);
+        // The device went away, fall through to the CPU scan.
+        this->d->m_gpuCascadeValid = false;
+    }
+#endif
+
+    QList<QRect> roi;
+    QThreadPool threadPool;
+    QMutex mutex;
+
+    if (threadPool.maxThreadCount() < 8)
+        threadPool.setMaxThreadCount(8);
+
+    int nBands = threadPool.maxThreadCount();
+
+    /* Every scale splits into row bands, so the scan saturates the pool
+     * even when only a few scale levels fit in the frame.
+     */
+    for (HaarCascadeHID *cascade: this->d->m_scaleCache) {
+        int rows = cascade->endY() - cascade->startY();
+        int bandHeight = qMax((rows + nBands - 1) / nBands, 1);
+
+        for (int startY = cascade->startY();
+             startY < cascade->endY();
+             startY += bandHeight) {
+            int endY = qMin(startY + bandHeight, cascade->endY());
+            QtConcurrent::run(&threadPool, HaarCascadeHID::run,
+                              cascade, startY, endY, &roi, &mutex);
+        }
     }
 
     threadPool.waitForDone();
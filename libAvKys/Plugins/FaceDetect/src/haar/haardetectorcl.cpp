@@ -0,0 +1,637 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QtMath>
+
+#ifdef __APPLE__
+#include <OpenCL/cl.h>
+#else
+#include <CL/cl.h>
+#endif
+
+#include "haardetectorcl.h"
+#include "haarstage.h"
+
+/* One work item per window position. The flattened buffers mirror the
+ * HaarCascadeHID layout: 16 ints per feature (count, left node, right
+ * node, tilted flag, then the four corner offsets of up to three rects)
+ * and 6 floats (threshold, left value, right value, rect weights with the
+ * inverse window area already folded in, like the CPU side). The window
+ * sums are computed in uint so the wraparound matches the CPU arithmetic.
+ */
+static const char *haarDetectorCLKernel =
+    "__kernel void scanWindows(__global const uint *integral,\n"
+    "                          __global const ulong *integral2,\n"
+    "                          __global const uint *tilted,\n"
+    "                          __global const int *featInt,\n"
+    "                          __global const float *featFloat,\n"
+    "                          __global const int *treeFirst,\n"
+    "                          __global const int *stageFirst,\n"
+    "                          __global const int *stageCount,\n"
+    "                          __global const float *stageThreshold,\n"
+    "                          const int firstStage,\n"
+    "                          const int nStages,\n"
+    "                          const int startX,\n"
+    "                          const int startY,\n"
+    "                          const int oWidth,\n"
+    "                          const float step,\n"
+    "                          const float invArea,\n"
+    "                          const int4 pOfs,\n"
+    "                          const int hitsOffset,\n"
+    "                          __global uchar *hits)\n"
+    "{\n"
+    "    int i = get_global_id(0);\n"
+    "    int j = get_global_id(1);\n"
+    "    int x = (int) round((i + startX) * step);\n"
+    "    int y = (int) round((j + startY) * step);\n"
+    "    int offset = x + y * oWidth;\n"
+    "\n"
+    "    uint sum = integral[offset + pOfs.x]\n"
+    "             - integral[offset + pOfs.y]\n"
+    "             - integral[offset + pOfs.z]\n"
+    "             + integral[offset + pOfs.w];\n"
+    "    ulong sum2 = integral2[offset + pOfs.x]\n"
+    "               - integral2[offset + pOfs.y]\n"
+    "               - integral2[offset + pOfs.z]\n"
+    "               + integral2[offset + pOfs.w];\n"
+    "    float mean = sum * invArea;\n"
+    "    float vnorm = sum2 * invArea - mean * mean;\n"
+    "    vnorm = vnorm >= 0.0f? sqrt(vnorm): 1.0f;\n"
+    "\n"
+    "    uchar window = 1;\n"
+    "\n"
+    "    for (int s = firstStage; s < firstStage + nStages; s++) {\n"
+    "        float stageSum = 0.0f;\n"
+    "\n"
+    "        for (int t = stageFirst[s];\n"
+    "             t < stageFirst[s] + stageCount[s];\n"
+    "             t++) {\n"
+    "            int base = treeFirst[t];\n"
+    "            int idx = 0;\n"
+    "\n"
+    "            for (;;) {\n"
+    "                __global const int *fi = featInt + 16 * (base + idx);\n"
+    "                __global const float *ff = featFloat + 6 * (base + idx);\n"
+    "                __global const uint *plane = fi[3]? tilted: integral;\n"
+    "                float featureSum = 0.0f;\n"
+    "\n"
+    "                for (int r = 0; r < fi[0]; r++) {\n"
+    "                    uint rectSum = plane[offset + fi[4 + r]]\n"
+    "                                 - plane[offset + fi[7 + r]]\n"
+    "                                 - plane[offset + fi[10 + r]]\n"
+    "                                 + plane[offset + fi[13 + r]];\n"
+    "                    featureSum += rectSum * ff[3 + r];\n"
+    "                }\n"
+    "\n"
+    "                if (featureSum < ff[0] * vnorm) {\n"
+    "                    if (fi[1] < 0) {\n"
+    "                        stageSum += ff[1];\n"
+    "\n"
+    "                        break;\n"
+    "                    }\n"
+    "\n"
+    "                    idx = fi[1];\n"
+    "                } else {\n"
+    "                    if (fi[2] < 0) {\n"
+    "                        stageSum += ff[2];\n"
+    "\n"
+    "                        break;\n"
+    "                    }\n"
+    "\n"
+    "                    idx = fi[2];\n"
+    "                }\n"
+    "            }\n"
+    "        }\n"
+    "\n"
+    "        if (stageSum < stageThreshold[s]) {\n"
+    "            window = 0;\n"
+    "\n"
+    "            break;\n"
+    "        }\n"
+    "    }\n"
+    "\n"
+    "    hits[hitsOffset + i + j * get_global_size(0)] = window;\n"
+    "}\n";
+
+class HaarDetectorCLPrivate
+{
+    public:
+        struct Scale
+        {
+            int firstStage;
+            int nStages;
+            int startX;
+            int startY;
+            int gridWidth;
+            int gridHeight;
+            int oWidth;
+            int windowWidth;
+            int windowHeight;
+            cl_float step;
+            cl_float invArea;
+            cl_int4 pOfs;
+            int hitsOffset;
+        };
+
+        cl_device_id m_device;
+        cl_context m_context;
+        cl_command_queue m_queue;
+        cl_program m_program;
+        cl_kernel m_kernel;
+        cl_mem m_integral;
+        cl_mem m_integral2;
+        cl_mem m_tilted;
+        cl_mem m_featInt;
+        cl_mem m_featFloat;
+        cl_mem m_treeFirst;
+        cl_mem m_stageFirst;
+        cl_mem m_stageCount;
+        cl_mem m_stageThreshold;
+        cl_mem m_hits;
+        size_t m_integralCapacity;
+        size_t m_integral2Capacity;
+        size_t m_tiltedCapacity;
+        QVector<Scale> m_scales;
+        int m_hitsSize;
+        bool m_isValid;
+
+        HaarDetectorCLPrivate():
+            m_device(nullptr),
+            m_context(nullptr),
+            m_queue(nullptr),
+            m_program(nullptr),
+            m_kernel(nullptr),
+            m_integral(nullptr),
+            m_integral2(nullptr),
+            m_tilted(nullptr),
+            m_featInt(nullptr),
+            m_featFloat(nullptr),
+            m_treeFirst(nullptr),
+            m_stageFirst(nullptr),
+            m_stageCount(nullptr),
+            m_stageThreshold(nullptr),
+            m_hits(nullptr),
+            m_integralCapacity(0),
+            m_integral2Capacity(0),
+            m_tiltedCapacity(0),
+            m_hitsSize(0),
+            m_isValid(false)
+        {
+        }
+
+        inline void initialize();
+        inline bool createReadOnly(const void *data, size_t size, cl_mem *buffer);
+        inline bool uploadPlane(const void *data, size_t size,
+                                cl_mem *buffer, size_t *capacity);
+        inline void releaseBuffer(cl_mem *buffer);
+        inline void releaseCascade();
+        inline void release();
+};
+
+void HaarDetectorCLPrivate::initialize()
+{
+    cl_uint nPlatforms = 0;
+
+    if (clGetPlatformIDs(0, nullptr, &nPlatforms) != CL_SUCCESS
+        || nPlatforms < 1)
+        return;
+
+    QVector<cl_platform_id> platforms(int(nPlatforms));
+
+    if (clGetPlatformIDs(nPlatforms, platforms.data(), nullptr) != CL_SUCCESS)
+        return;
+
+    // Take the first platform with a GPU device. Running the cascade on a
+    // CL CPU device would just fight the caller's own thread pool.
+    for (const cl_platform_id &platform: platforms)
+        if (clGetDeviceIDs(platform,
+                           CL_DEVICE_TYPE_GPU,
+                           1,
+                           &this->m_device,
+                           nullptr) == CL_SUCCESS)
+            break;
+
+    if (!this->m_device)
+        return;
+
+    cl_int error = CL_SUCCESS;
+    this->m_context = clCreateContext(nullptr,
+                                      1,
+                                      &this->m_device,
+                                      nullptr,
+                                      nullptr,
+                                      &error);
+
+    if (error != CL_SUCCESS)
+        return;
+
+    this->m_queue = clCreateCommandQueue(this->m_context,
+                                         this->m_device,
+                                         0,
+                                         &error);
+
+    if (error != CL_SUCCESS)
+        return;
+
+    this->m_program = clCreateProgramWithSource(this->m_context,
+                                                1,
+                                                &haarDetectorCLKernel,
+                                                nullptr,
+                                                &error);
+
+    if (error != CL_SUCCESS)
+        return;
+
+    if (clBuildProgram(this->m_program,
+                       1,
+                       &this->m_device,
+                       nullptr,
+                       nullptr,
+                       nullptr) != CL_SUCCESS)
+        return;
+
+    this->m_kernel = clCreateKernel(this->m_program, "scanWindows", &error);
+
+    if (error != CL_SUCCESS)
+        return;
+
+    this->m_isValid = true;
+}
+
+bool HaarDetectorCLPrivate::createReadOnly(const void *data,
+                                           size_t size,
+                                           cl_mem *buffer)
+{
+    this->releaseBuffer(buffer);
+
+    if (size < 1)
+        return false;
+
+    cl_int error = CL_SUCCESS;
+    *buffer = clCreateBuffer(this->m_context,
+                             CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+                             size,
+                             const_cast<void *>(data),
+                             &error);
+
+    return error == CL_SUCCESS;
+}
+
+bool HaarDetectorCLPrivate::uploadPlane(const void *data,
+                                        size_t size,
+                                        cl_mem *buffer,
+                                        size_t *capacity)
+{
+    if (*capacity != size) {
+        this->releaseBuffer(buffer);
+        cl_int error = CL_SUCCESS;
+        *buffer = clCreateBuffer(this->m_context,
+                                 CL_MEM_READ_ONLY,
+                                 size,
+                                 nullptr,
+                                 &error);
+
+        if (error != CL_SUCCESS) {
+            *capacity = 0;
+
+            return false;
+        }
+
+        *capacity = size;
+    }
+
+    return clEnqueueWriteBuffer(this->m_queue,
+                                *buffer,
+                                CL_FALSE,
+                                0,
+                                size,
+                                data,
+                                0,
+                                nullptr,
+                                nullptr) == CL_SUCCESS;
+}
+
+void HaarDetectorCLPrivate::releaseBuffer(cl_mem *buffer)
+{
+    if (*buffer) {
+        clReleaseMemObject(*buffer);
+        *buffer = nullptr;
+    }
+}
+
+void HaarDetectorCLPrivate::releaseCascade()
+{
+    this->releaseBuffer(&this->m_featInt);
+    this->releaseBuffer(&this->m_featFloat);
+    this->releaseBuffer(&this->m_treeFirst);
+    this->releaseBuffer(&this->m_stageFirst);
+    this->releaseBuffer(&this->m_stageCount);
+    this->releaseBuffer(&this->m_stageThreshold);
+    this->releaseBuffer(&this->m_hits);
+    this->m_scales.clear();
+    this->m_hitsSize = 0;
+}
+
+void HaarDetectorCLPrivate::release()
+{
+    this->releaseCascade();
+    this->releaseBuffer(&this->m_integral);
+    this->releaseBuffer(&this->m_integral2);
+    this->releaseBuffer(&this->m_tilted);
+    this->m_integralCapacity = 0;
+    this->m_integral2Capacity = 0;
+    this->m_tiltedCapacity = 0;
+
+    if (this->m_kernel) {
+        clReleaseKernel(this->m_kernel);
+        this->m_kernel = nullptr;
+    }
+
+    if (this->m_program) {
+        clReleaseProgram(this->m_program);
+        this->m_program = nullptr;
+    }
+
+    if (this->m_queue) {
+        clReleaseCommandQueue(this->m_queue);
+        this->m_queue = nullptr;
+    }
+
+    if (this->m_context) {
+        clReleaseContext(this->m_context);
+        this->m_context = nullptr;
+    }
+
+    this->m_isValid = false;
+}
+
+HaarDetectorCL::HaarDetectorCL()
+{
+    this->d = new HaarDetectorCLPrivate;
+    this->d->initialize();
+
+    if (!this->d->m_isValid)
+        this->d->release();
+}
+
+HaarDetectorCL::~HaarDetectorCL()
+{
+    this->d->release();
+    delete this->d;
+}
+
+bool HaarDetectorCL::isValid() const
+{
+    return this->d->m_isValid;
+}
+
+bool HaarDetectorCL::uploadCascade(const QVector<HaarCascadeHID *> &scales,
+                                   const quint32 *integral,
+                                   const quint64 *integral2,
+                                   const quint32 *tiltedIntegral)
+{
+    this->d->releaseCascade();
+
+    if (!this->d->m_isValid || scales.isEmpty())
+        return false;
+
+    QVector<cl_int> featInt;
+    QVector<cl_float> featFloat;
+    QVector<cl_int> treeFirst;
+    QVector<cl_int> stageFirst;
+    QVector<cl_int> stageCount;
+    QVector<cl_float> stageThreshold;
+    int hitsSize = 0;
+
+    for (const HaarCascadeHID *cascade: scales) {
+        // Stage trees and canny pruning take data dependent paths the
+        // kernel doesn't implement.
+        if (cascade->m_isTree || cascade->m_cannyPruning)
+            return false;
+
+        HaarDetectorCLPrivate::Scale scale;
+        scale.firstStage = stageFirst.size();
+        scale.nStages = cascade->m_count;
+        scale.startX = cascade->m_startX;
+        scale.startY = cascade->m_startY;
+        scale.gridWidth = cascade->m_endX - cascade->m_startX;
+        scale.gridHeight = cascade->m_endY - cascade->m_startY;
+        scale.oWidth = cascade->m_oWidth;
+        scale.windowWidth = cascade->m_windowWidth;
+        scale.windowHeight = cascade->m_windowHeight;
+        scale.step = cl_float(cascade->m_step);
+        scale.invArea = cl_float(cascade->m_invArea);
+
+        for (int k = 0; k < 4; k++)
+            scale.pOfs.s[k] = cl_int(cascade->m_p[k] - integral);
+
+        scale.hitsOffset = hitsSize;
+
+        if (scale.gridWidth < 1 || scale.gridHeight < 1)
+            continue;
+
+        hitsSize += scale.gridWidth * scale.gridHeight;
+
+        for (int s = 0; s < cascade->m_count; s++) {
+            const HaarStageHID *stage = cascade->m_stages[s];
+            stageFirst << treeFirst.size();
+            stageCount << stage->m_count;
+            stageThreshold << cl_float(stage->m_threshold);
+
+            for (int t = 0; t < stage->m_count; t++) {
+                const HaarTreeHID *tree = stage->m_trees[t];
+                treeFirst << featInt.size() / 16;
+
+                for (int f = 0; f < tree->m_count; f++) {
+                    const HaarFeatureHID *feature = tree->m_features[f];
+                    auto base = feature->m_tilted? tiltedIntegral: integral;
+                    cl_int fi[16] = {0};
+                    fi[0] = feature->m_count;
+                    fi[1] = feature->m_leftNode;
+                    fi[2] = feature->m_rightNode;
+                    fi[3] = feature->m_tilted;
+
+                    for (int r = 0; r < feature->m_count; r++) {
+                        fi[4 + r] = cl_int(feature->m_p0[r] - base);
+                        fi[7 + r] = cl_int(feature->m_p1[r] - base);
+                        fi[10 + r] = cl_int(feature->m_p2[r] - base);
+                        fi[13 + r] = cl_int(feature->m_p3[r] - base);
+                    }
+
+                    for (int k = 0; k < 16; k++)
+                        featInt << fi[k];
+
+                    featFloat << cl_float(feature->m_threshold)
+                              << cl_float(feature->m_leftVal)
+                              << cl_float(feature->m_rightVal);
+
+                    for (int r = 0; r < HAAR_FEATURE_MAX; r++)
+                        featFloat << cl_float(r < feature->m_count?
+                                                  feature->m_weight[r]: 0);
+                }
+            }
+        }
+
+        this->d->m_scales << scale;
+    }
+
+    if (hitsSize < 1) {
+        this->d->releaseCascade();
+
+        return false;
+    }
+
+    cl_int error = CL_SUCCESS;
+    this->d->m_hits = clCreateBuffer(this->d->m_context,
+                                     CL_MEM_WRITE_ONLY,
+                                     size_t(hitsSize),
+                                     nullptr,
+                                     &error);
+
+    if (error != CL_SUCCESS
+        || !this->d->createReadOnly(featInt.constData(),
+                                    size_t(featInt.size()) * sizeof(cl_int),
+                                    &this->d->m_featInt)
+        || !this->d->createReadOnly(featFloat.constData(),
+                                    size_t(featFloat.size()) * sizeof(cl_float),
+                                    &this->d->m_featFloat)
+        || !this->d->createReadOnly(treeFirst.constData(),
+                                    size_t(treeFirst.size()) * sizeof(cl_int),
+                                    &this->d->m_treeFirst)
+        || !this->d->createReadOnly(stageFirst.constData(),
+                                    size_t(stageFirst.size()) * sizeof(cl_int),
+                                    &this->d->m_stageFirst)
+        || !this->d->createReadOnly(stageCount.constData(),
+                                    size_t(stageCount.size()) * sizeof(cl_int),
+                                    &this->d->m_stageCount)
+        || !this->d->createReadOnly(stageThreshold.constData(),
+                                    size_t(stageThreshold.size()) * sizeof(cl_float),
+                                    &this->d->m_stageThreshold)) {
+        this->d->releaseCascade();
+
+        return false;
+    }
+
+    this->d->m_hitsSize = hitsSize;
+
+    return true;
+}
+
+bool HaarDetectorCL::scan(const QVector<quint32> &integral,
+                          const QVector<quint64> &integral2,
+                          const QVector<quint32> &tiltedIntegral,
+                          QList<QRect> *roi)
+{
+    if (!this->d->m_isValid || this->d->m_scales.isEmpty())
+        return false;
+
+    if (!this->d->uploadPlane(integral.constData(),
+                              size_t(integral.size()) * sizeof(quint32),
+                              &this->d->m_integral,
+                              &this->d->m_integralCapacity)
+        || !this->d->uploadPlane(integral2.constData(),
+                                 size_t(integral2.size()) * sizeof(quint64),
+                                 &this->d->m_integral2,
+                                 &this->d->m_integral2Capacity)
+        || !this->d->uploadPlane(tiltedIntegral.constData(),
+                                 size_t(tiltedIntegral.size()) * sizeof(quint32),
+                                 &this->d->m_tilted,
+                                 &this->d->m_tiltedCapacity)) {
+        this->d->release();
+
+        return false;
+    }
+
+    auto kernel = this->d->m_kernel;
+    clSetKernelArg(kernel, 0, sizeof(cl_mem), &this->d->m_integral);
+    clSetKernelArg(kernel, 1, sizeof(cl_mem), &this->d->m_integral2);
+    clSetKernelArg(kernel, 2, sizeof(cl_mem), &this->d->m_tilted);
+    clSetKernelArg(kernel, 3, sizeof(cl_mem), &this->d->m_featInt);
+    clSetKernelArg(kernel, 4, sizeof(cl_mem), &this->d->m_featFloat);
+    clSetKernelArg(kernel, 5, sizeof(cl_mem), &this->d->m_treeFirst);
+    clSetKernelArg(kernel, 6, sizeof(cl_mem), &this->d->m_stageFirst);
+    clSetKernelArg(kernel, 7, sizeof(cl_mem), &this->d->m_stageCount);
+    clSetKernelArg(kernel, 8, sizeof(cl_mem), &this->d->m_stageThreshold);
+    clSetKernelArg(kernel, 18, sizeof(cl_mem), &this->d->m_hits);
+
+    for (const HaarDetectorCLPrivate::Scale &scale: this->d->m_scales) {
+        cl_int firstStage = scale.firstStage;
+        cl_int nStages = scale.nStages;
+        cl_int startX = scale.startX;
+        cl_int startY = scale.startY;
+        cl_int oWidth = scale.oWidth;
+        cl_int hitsOffset = scale.hitsOffset;
+        clSetKernelArg(kernel, 9, sizeof(cl_int), &firstStage);
+        clSetKernelArg(kernel, 10, sizeof(cl_int), &nStages);
+        clSetKernelArg(kernel, 11, sizeof(cl_int), &startX);
+        clSetKernelArg(kernel, 12, sizeof(cl_int), &startY);
+        clSetKernelArg(kernel, 13, sizeof(cl_int), &oWidth);
+        clSetKernelArg(kernel, 14, sizeof(cl_float), &scale.step);
+        clSetKernelArg(kernel, 15, sizeof(cl_float), &scale.invArea);
+        clSetKernelArg(kernel, 16, sizeof(cl_int4), &scale.pOfs);
+        clSetKernelArg(kernel, 17, sizeof(cl_int), &hitsOffset);
+
+        size_t globalSize[] = {size_t(scale.gridWidth),
+                               size_t(scale.gridHeight)};
+
+        if (clEnqueueNDRangeKernel(this->d->m_queue,
+                                   kernel,
+                                   2,
+                                   nullptr,
+                                   globalSize,
+                                   nullptr,
+                                   0,
+                                   nullptr,
+                                   nullptr) != CL_SUCCESS) {
+            this->d->release();
+
+            return false;
+        }
+    }
+
+    QVector<quint8> hits(this->d->m_hitsSize);
+
+    if (clEnqueueReadBuffer(this->d->m_queue,
+                            this->d->m_hits,
+                            CL_TRUE,
+                            0,
+                            size_t(this->d->m_hitsSize),
+                            hits.data(),
+                            0,
+                            nullptr,
+                            nullptr) != CL_SUCCESS) {
+        this->d->release();
+
+        return false;
+    }
+
+    for (const HaarDetectorCLPrivate::Scale &scale: this->d->m_scales) {
+        const quint8 *scaleHits = hits.constData() + scale.hitsOffset;
+
+        for (int j = 0; j < scale.gridHeight; j++)
+            for (int i = 0; i < scale.gridWidth; i++)
+                if (scaleHits[i + j * scale.gridWidth])
+                    roi->append(QRect(qRound((i + scale.startX) * scale.step),
+                                      qRound((j + scale.startY) * scale.step),
+                                      scale.windowWidth,
+                                      scale.windowHeight));
+    }
+
+    return true;
+}
@@ -0,0 +1,75 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef HAARDETECTORCL_H
+#define HAARDETECTORCL_H
+
+#include <QList>
+#include <QRect>
+#include <QVector>
+
+#include "haarcascade.h"
+
+class HaarDetectorCLPrivate;
+
+/* OpenCL window scan over the per-scale cascade state.
+ *
+ * The evaluator flattens the HaarCascadeHID scale cache into plain
+ * int/float buffers — the same scaled feature offsets the CPU scan reads —
+ * and runs one work item per window position, so both paths evaluate the
+ * identical cascade. The integral planes are uploaded once per frame and
+ * every scale is scanned from them without further transfers.
+ *
+ * isValid() reports whether a GPU device and the program are usable; the
+ * caller keeps the CPU scan as the fallback for that case, for cascades
+ * with stage trees, and for canny pruning, which the kernel doesn't
+ * implement. The kernel also doesn't replicate the CPU shortcut of
+ * stepping two windows after a stage zero reject, it just evaluates the
+ * full grid, which can only add windows that the grouping stage filters
+ * the same way.
+ */
+class HaarDetectorCL
+{
+    public:
+        HaarDetectorCL();
+        ~HaarDetectorCL();
+
+        bool isValid() const;
+
+        /* Rebuild the flattened cascade buffers from the scale cache. Call
+         * whenever the cache was rebuilt. Returns false for cascades the
+         * kernel can't evaluate. */
+        bool uploadCascade(const QVector<HaarCascadeHID *> &scales,
+                           const quint32 *integral,
+                           const quint64 *integral2,
+                           const quint32 *tiltedIntegral);
+
+        /* Scan every cached scale and append the accepted windows to roi.
+         * Returns false on any device error, leaving roi untouched so the
+         * caller can run the CPU scan instead. */
+        bool scan(const QVector<quint32> &integral,
+                  const QVector<quint64> &integral2,
+                  const QVector<quint32> &tiltedIntegral,
+                  QList<QRect> *roi);
+
+    private:
+        HaarDetectorCLPrivate *d;
+};
+
+#endif // HAARDETECTORCL_H
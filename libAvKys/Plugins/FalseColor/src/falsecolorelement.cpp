@@ -21,6 +21,7 @@
 #include <QVariant>
 #include <QQmlContext>
 #include <akutils.h>
+#include <akcolorlut.h>
 #include <akpacket.h>
 
 #include "falsecolorelement.h"
@@ -30,8 +31,59 @@ class FalseColorElementPrivate
     public:
         QList<QRgb> m_table;
         bool m_soft;
+        AkColorLut m_lut;
+        bool m_lutDirty;
+
+        void updateLut();
 };
 
+void FalseColorElementPrivate::updateLut()
+{
+    QVector<QRgb> table(256);
+    QList<QRgb> tableRgb = this->m_table;
+
+    for (int i = 0; i < 256; i++) {
+        QRgb color;
+
+        if (this->m_soft) {
+            int low = i * (tableRgb.size() - 1) / 255;
+            low = qBound(0, low, tableRgb.size() - 2);
+            int high = low + 1;
+
+            int rl = qRed(tableRgb[low]);
+            int gl = qGreen(tableRgb[low]);
+            int bl = qBlue(tableRgb[low]);
+
+            int rh = qRed(tableRgb[high]);
+            int gh = qGreen(tableRgb[high]);
+            int bh = qBlue(tableRgb[high]);
+
+            int l = 255 * low / (tableRgb.size() - 1);
+            int h = 255 * high / (tableRgb.size() - 1);
+
+            qreal k = qreal(i - l) / (h - l);
+
+            int r = int(k * (rh - rl) + rl);
+            int g = int(k * (gh - gl) + gl);
+            int b = int(k * (bh - bl) + bl);
+
+            r = qBound(0, r, 255);
+            g = qBound(0, g, 255);
+            b = qBound(0, b, 255);
+
+            color = qRgb(r, g, b);
+        } else {
+            int t = tableRgb.size() * i / 255;
+            t = qBound(0, t, tableRgb.size() - 1);
+            color = tableRgb[t];
+        }
+
+        table[i] = color;
+    }
+
+    this->m_lut.setGrayTable(table);
+}
+
 FalseColorElement::FalseColorElement(): AkElement()
 {
     this->d = new FalseColorElementPrivate;
@@ -44,6 +96,7 @@ FalseColorElement::FalseColorElement(): AkElement()
     };
 
     this->d->m_soft = false;
+    this->d->m_lutDirty = true;
 }
 
 FalseColorElement::~FalseColorElement()
@@ -93,6 +146,7 @@ void FalseColorElement::setTable(const QVariantList &table)
         return;
 
     this->d->m_table = tableRgb;
+    this->d->m_lutDirty = true;
     emit this->tableChanged(table);
 }
 
@@ -102,6 +156,7 @@ void FalseColorElement::setSoft(bool soft)
         return;
 
     this->d->m_soft = soft;
+    this->d->m_lutDirty = true;
     emit this->softChanged(soft);
 }
 
@@ -135,55 +190,14 @@ AkPacket FalseColorElement::iStream(const AkPacket &packet)
     src = src.convertToFormat(QImage::Format_Grayscale8);
     QImage oFrame(src.size(), QImage::Format_ARGB32);
 
-    QRgb table[256];
-    QList<QRgb> tableRgb = this->d->m_table;
-
-    for (int i = 0; i < 256; i++) {
-        QRgb color;
-
-        if (this->d->m_soft) {
-            int low = i * (tableRgb.size() - 1) / 255;
-            low = qBound(0, low, tableRgb.size() - 2);
-            int high = low + 1;
-
-            int rl = qRed(tableRgb[low]);
-            int gl = qGreen(tableRgb[low]);
-            int bl = qBlue(tableRgb[low]);
-
-            int rh = qRed(tableRgb[high]);
-            int gh = qGreen(tableRgb[high]);
-            int bh = qBlue(tableRgb[high]);
-
-            int l = 255 * low / (tableRgb.size() - 1);
-            int h = 255 * high / (tableRgb.size() - 1);
-
-            qreal k = qreal(i - l) / (h - l);
-
-            int r = int(k * (rh - rl) + rl);
-            int g = int(k * (gh - gl) + gl);
-            int b = int(k * (bh - bl) + bl);
-
-            r = qBound(0, r, 255);
-            g = qBound(0, g, 255);
-            b = qBound(0, b, 255);
-
-            color = qRgb(r, g, b);
-        } else {
-            int t = tableRgb.size() * i / 255;
-            t = qBound(0, t, tableRgb.size() - 1);
-            color = tableRgb[t];
-        }
-
-        table[i] = color;
+    // The gradient expands into the palette only when the table or the
+    // soft flag change, not once per frame.
+    if (this->d->m_lutDirty) {
+        this->d->updateLut();
+        this->d->m_lutDirty = false;
     }
 
-    for (int y = 0; y < src.height(); y++) {
-        const quint8 *srcLine = src.constScanLine(y);
-        QRgb *dstLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
-
-        for (int x = 0; x < src.width(); x++)
-            dstLine[x] = table[srcLine[x]];
-    }
+    this->d->m_lut.applyGray(src, oFrame);
 
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
@@ -24,6 +24,7 @@
 #include <QtMath>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akvideofilterrunner.h>
 
 #include "fireelement.h"
 
@@ -41,6 +42,42 @@ inline FireModeMap initFireModeMap()
 
 Q_GLOBAL_STATIC_WITH_ARGS(FireModeMap, fireModeToStr, (initFireModeMap()))
 
+inline QVector<quint8> initDiffSqrtTable()
+{
+    /* sqrt((dr² + dg² + db²) / 3) for every possible color difference, so
+     * the seeding pass stays in integer math.
+     */
+    QVector<quint8> table(65026);
+
+    for (int i = 0; i < table.size(); i++)
+        table[i] = quint8(sqrt(i));
+
+    return table;
+}
+
+Q_GLOBAL_STATIC_WITH_ARGS(QVector<quint8>, diffSqrtTable, (initDiffSqrtTable()))
+
+// Composite "fg" over "bg", both with straight alpha.
+inline QRgb alphaOver(QRgb fg, QRgb bg)
+{
+    int fa = qAlpha(fg);
+
+    if (fa == 255)
+        return fg;
+
+    if (fa == 0)
+        return bg;
+
+    int wf = 255 * fa;
+    int wb = qAlpha(bg) * (255 - fa);
+    int wo = wf + wb;
+
+    return qRgba((qRed(fg) * wf + qRed(bg) * wb) / wo,
+                 (qGreen(fg) * wf + qGreen(bg) * wb) / wo,
+                 (qBlue(fg) * wf + qBlue(bg) * wb) / wo,
+                 wo / 255);
+}
+
 class FireElementPrivate
 {
     public:
@@ -72,18 +109,21 @@ class FireElementPrivate
         {
         }
 
-        inline QImage imageDiff(const QImage &img1,
-                                const QImage &img2,
-                                int colors,
-                                int threshold,
-                                int lumaThreshold,
-                                int alphaVariation,
-                                FireElement::FireMode mode);
+        inline void seedFire(const QImage &img1,
+                             const QImage &img2,
+                             QImage &fire,
+                             int colors,
+                             int threshold,
+                             int lumaThreshold,
+                             int alphaVariation,
+                             FireElement::FireMode mode);
         inline QImage zoomImage(const QImage &src, qreal factor);
-        inline void coolImage(QImage &src, int colorDiff);
-        inline void imageAlphaDiff(QImage &src, int alphaDiff);
+        inline void decayImage(QImage &src, int colorDiff, int alphaDiff);
         inline void disolveImage(QImage &src, qreal amount);
-        inline QImage burn(const QImage &src, const QVector<QRgb> &palette);
+        inline void burn(const QImage &fire,
+                         const QImage &src,
+                         QImage &dest,
+                         const QVector<QRgb> &palette);
         inline QVector<QRgb> createPalette();
 };
 
@@ -155,56 +195,63 @@ int FireElement::nColors() const
     return this->d->m_nColors;
 }
 
-QImage FireElementPrivate::imageDiff(const QImage &img1,
-                                     const QImage &img2,
-                                     int colors,
-                                     int threshold,
-                                     int lumaThreshold,
-                                     int alphaVariation,
-                                     FireElement::FireMode mode)
+void FireElementPrivate::seedFire(const QImage &img1,
+                                  const QImage &img2,
+                                  QImage &fire,
+                                  int colors,
+                                  int threshold,
+                                  int lumaThreshold,
+                                  int alphaVariation,
+                                  FireElement::FireMode mode)
 {
     int width = qMin(img1.width(), img2.width());
     int height = qMin(img1.height(), img2.height());
-    QImage diff(width, height, QImage::Format_ARGB32);
+    const quint8 *sqrtTable = diffSqrtTable->constData();
 
-    for (int y = 0; y < height; y++) {
-        auto iLine1 = reinterpret_cast<const QRgb *>(img1.constScanLine(y));
-        auto iLine2 = reinterpret_cast<const QRgb *>(img2.constScanLine(y));
-        QRgb *oLine = reinterpret_cast<QRgb *>(diff.scanLine(y));
+    // Detach the buffer before the bands write to it.
+    fire.bits();
 
-        for (int x = 0; x < width; x++) {
-            int r1 = qRed(iLine1[x]);
-            int g1 = qGreen(iLine1[x]);
-            int b1 = qBlue(iLine1[x]);
+    AkVideoFilterRunner::globalRunner()->run(height, [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            auto iLine1 = reinterpret_cast<const QRgb *>(img1.constScanLine(y));
+            auto iLine2 = reinterpret_cast<const QRgb *>(img2.constScanLine(y));
+            QRgb *fireLine = reinterpret_cast<QRgb *>(fire.scanLine(y));
 
-            int r2 = qRed(iLine2[x]);
-            int g2 = qGreen(iLine2[x]);
-            int b2 = qBlue(iLine2[x]);
+            for (int x = 0; x < width; x++) {
+                int r1 = qRed(iLine1[x]);
+                int g1 = qGreen(iLine1[x]);
+                int b1 = qBlue(iLine1[x]);
 
-            int dr = r1 - r2;
-            int dg = g1 - g2;
-            int db = b1 - b2;
+                int r2 = qRed(iLine2[x]);
+                int g2 = qGreen(iLine2[x]);
+                int b2 = qBlue(iLine2[x]);
 
-            int alpha = dr * dr + dg * dg + db * db;
-            alpha = int(sqrt(alpha / 3));
+                int dr = r1 - r2;
+                int dg = g1 - g2;
+                int db = b1 - b2;
 
-            if (mode == FireElement::FireModeSoft)
-                alpha = alpha < threshold? 0: alpha;
-            else
-                alpha = alpha < threshold?
-                            0: (256 - alphaVariation)
-                            + qrand() % alphaVariation;
+                int alpha = sqrtTable[(dr * dr + dg * dg + db * db) / 3];
 
-            int gray = qGray(iLine2[x]);
+                if (mode == FireElement::FireModeSoft)
+                    alpha = alpha < threshold? 0: alpha;
+                else
+                    alpha = alpha < threshold?
+                                0: (256 - alphaVariation)
+                                + qrand() % alphaVariation;
 
-            alpha = gray < lumaThreshold? 0: alpha;
-            int b = (256 - colors) + qrand() % colors;
+                int gray = qGray(iLine2[x]);
 
-            oLine[x] = qRgba(0, 0, b, alpha);
-        }
-    }
+                alpha = gray < lumaThreshold? 0: alpha;
 
-    return diff;
+                // A fully transparent seed leaves the flame untouched.
+                if (alpha < 1)
+                    continue;
+
+                int b = (256 - colors) + qrand() % colors;
+                fireLine[x] = alphaOver(qRgba(0, 0, b, alpha), fireLine[x]);
+            }
+        }
+    });
 }
 
 QImage FireElementPrivate::zoomImage(const QImage &src, qreal factor)
@@ -225,30 +272,36 @@ QImage FireElementPrivate::zoomImage(const QImage &src, qreal factor)
     return zoom;
 }
 
-void FireElementPrivate::coolImage(QImage &src, int colorDiff)
+void FireElementPrivate::decayImage(QImage &src, int colorDiff, int alphaDiff)
 {
-    for (int y = 0; y < src.height(); y++) {
-        QRgb *srcLine = reinterpret_cast<QRgb *>(src.scanLine(y));
+    // Cooling and fading are clamped adds, so both fold into one lookup.
+    quint8 blueTable[256];
+    quint8 alphaTable[256];
 
-        for (int x = 0; x < src.width(); x++) {
-            int b = qBound(0, qBlue(srcLine[x]) + colorDiff, 255);
-            srcLine[x] = qRgba(0, 0, b, qAlpha(srcLine[x]));
-        }
+    for (int i = 0; i < 256; i++) {
+        blueTable[i] = quint8(qBound(0, i + colorDiff, 255));
+        alphaTable[i] = quint8(qBound(0, i + alphaDiff, 255));
     }
-}
 
-void FireElementPrivate::imageAlphaDiff(QImage &src, int alphaDiff)
-{
-    for (int y = 0; y < src.height(); y++) {
-        QRgb *srcLine = reinterpret_cast<QRgb *>(src.scanLine(y));
+    int width = src.width();
+
+    // Detach the buffer before the bands write to it.
+    src.bits();
+
+    AkVideoFilterRunner::globalRunner()->run(src.height(),
+                                             [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            QRgb *srcLine = reinterpret_cast<QRgb *>(src.scanLine(y));
 
-        for (int x = 0; x < src.width(); x++) {
-            QRgb pixel = srcLine[x];
-            int b = qBlue(pixel);
-            int a = qBound(0, qAlpha(pixel) + alphaDiff, 255);
-            srcLine[x] = qRgba(0, 0, b, a);
+            for (int x = 0; x < width; x++) {
+                QRgb pixel = srcLine[x];
+                srcLine[x] = qRgba(0,
+                                   0,
+                                   blueTable[qBlue(pixel)],
+                                   alphaTable[qAlpha(pixel)]);
+            }
         }
-    }
+    });
 }
 
 void FireElementPrivate::disolveImage(QImage &src, qreal amount)
@@ -259,33 +312,40 @@ void FireElementPrivate::disolveImage(QImage &src, qreal amount)
     for (qint64 i = 0; i < n; i++) {
         int x = qrand() % src.width();
         int y = qrand() % src.height();
-        QRgb pixel = src.pixel(x, y);
+        QRgb *line = reinterpret_cast<QRgb *>(src.scanLine(y));
+        QRgb pixel = line[x];
         int b = qBlue(pixel);
         int a = qAlpha(pixel) < 1? 0: qrand() % qAlpha(pixel);
 
-        src.setPixel(x, y, qRgba(0, 0, b, a));
+        line[x] = qRgba(0, 0, b, a);
     }
 }
 
-QImage FireElementPrivate::burn(const QImage &src, const QVector<QRgb> &palette)
-{
-    QImage dest(src.size(), src.format());
-
-    for (int y = 0; y < src.height(); y++) {
-        const QRgb *srcLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
-        QRgb *dstLine = reinterpret_cast<QRgb *>(dest.scanLine(y));
-
-        for (int x = 0; x < src.width(); x++) {
-            int index = qBlue(srcLine[x]);
-            int r = qRed(palette[index]);
-            int g = qGreen(palette[index]);
-            int b = qBlue(palette[index]);
-
-            dstLine[x] = qRgba(r, g, b, qAlpha(srcLine[x]));
+void FireElementPrivate::burn(const QImage &fire,
+                              const QImage &src,
+                              QImage &dest,
+                              const QVector<QRgb> &palette)
+{
+    int width = src.width();
+    const QRgb *colorTable = palette.constData();
+
+    AkVideoFilterRunner::globalRunner()->run(src.height(),
+                                             [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            auto fireLine = reinterpret_cast<const QRgb *>(fire.constScanLine(y));
+            auto srcLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
+            QRgb *dstLine = reinterpret_cast<QRgb *>(dest.scanLine(y));
+
+            for (int x = 0; x < width; x++) {
+                QRgb color = colorTable[qBlue(fireLine[x])];
+                dstLine[x] = alphaOver(qRgba(qRed(color),
+                                             qGreen(color),
+                                             qBlue(color),
+                                             qAlpha(fireLine[x])),
+                                       srcLine[x]);
+            }
         }
-    }
-
-    return dest;
+    });
 }
 
 QVector<QRgb> FireElementPrivate::createPalette()
@@ -482,38 +542,33 @@ AkPacket FireElement::iStream(const AkPacket &packet)
     } else {
         this->d->m_fireBuffer = this->d->zoomImage(this->d->m_fireBuffer,
                                                    this->d->m_zoom);
-        this->d->coolImage(this->d->m_fireBuffer, this->d->m_cool);
-        this->d->imageAlphaDiff(this->d->m_fireBuffer, this->d->m_alphaDiff);
+        this->d->decayImage(this->d->m_fireBuffer,
+                            this->d->m_cool,
+                            this->d->m_alphaDiff);
         this->d->disolveImage(this->d->m_fireBuffer, this->d->m_disolve);
 
         int nColors = this->d->m_nColors > 0? this->d->m_nColors: 1;
 
         // Compute the difference between previous and current frame,
-        // and save it to the buffer.
-        QImage diff =
-                this->d->imageDiff(this->d->m_prevFrame,
-                                   src,
-                                   nColors,
-                                   this->d->m_threshold,
-                                   this->d->m_lumaThreshold,
-                                   this->d->m_alphaVariation,
-                                   this->d->m_mode);
-
-        QPainter painter;
-        painter.begin(&this->d->m_fireBuffer);
-        painter.drawImage(0, 0, diff);
-        painter.end();
+        // and composite it over the buffer.
+        this->d->seedFire(this->d->m_prevFrame,
+                          src,
+                          this->d->m_fireBuffer,
+                          nColors,
+                          this->d->m_threshold,
+                          this->d->m_lumaThreshold,
+                          this->d->m_alphaVariation,
+                          this->d->m_mode);
 
         auto firePacket = AkUtils::imageToPacket(this->d->m_fireBuffer, packet);
         auto blurPacket = this->d->m_blurFilter->iStream(firePacket);
         this->d->m_fireBuffer = AkUtils::packetToImage(blurPacket);
 
         // Apply buffer.
-        painter.begin(&oFrame);
-        painter.drawImage(0, 0, src);
-        painter.drawImage(0, 0, this->d->burn(this->d->m_fireBuffer,
-                                              this->d->m_palette));
-        painter.end();
+        this->d->burn(this->d->m_fireBuffer,
+                      src,
+                      oFrame,
+                      this->d->m_palette);
     }
 
     this->d->m_prevFrame = src.copy();
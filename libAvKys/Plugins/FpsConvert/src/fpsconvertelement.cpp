@@ -0,0 +1,144 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QMutex>
+#include <akpacket.h>
+#include <akvideocaps.h>
+
+#include "fpsconvertelement.h"
+
+class FpsConvertElementPrivate
+{
+    public:
+        AkFrac m_fps;
+        QMutex m_mutex;
+
+        // Retiming state: index of the next output frame and the time of
+        // the last input frame, used to detect stream restarts.
+        qint64 m_frameCount;
+        qreal m_lastTime;
+        bool m_synced;
+
+        FpsConvertElementPrivate():
+            m_frameCount(0),
+            m_lastTime(0.0),
+            m_synced(false)
+        {
+        }
+};
+
+FpsConvertElement::FpsConvertElement(): AkElement()
+{
+    this->d = new FpsConvertElementPrivate;
+}
+
+FpsConvertElement::~FpsConvertElement()
+{
+    delete this->d;
+}
+
+AkFrac FpsConvertElement::fps() const
+{
+    return this->d->m_fps;
+}
+
+void FpsConvertElement::setFps(const AkFrac &fps)
+{
+    if (this->d->m_fps == fps)
+        return;
+
+    this->d->m_mutex.lock();
+    this->d->m_fps = fps;
+    this->d->m_synced = false;
+    this->d->m_mutex.unlock();
+
+    emit this->fpsChanged(fps);
+}
+
+void FpsConvertElement::resetFps()
+{
+    this->setFps(AkFrac());
+}
+
+AkPacket FpsConvertElement::iStream(const AkPacket &packet)
+{
+    this->d->m_mutex.lock();
+    AkFrac fps = this->d->m_fps;
+    AkFrac timeBase = packet.timeBase();
+
+    if (!fps.isValid() || !timeBase.isValid()) {
+        this->d->m_mutex.unlock();
+
+        akSend(packet)
+    }
+
+    /* Output frame k plays at k / fps, the input frame at pts * timeBase.
+     * Frame k is due when
+     *
+     *     k * fps.den() * timeBase.den() <= pts * timeBase.num() * fps.num()
+     *
+     * which is the same comparison with both sides brought to a common
+     * denominator, so it's exact in integer math.
+     */
+    qint64 inTicks = packet.pts() * timeBase.num() * fps.num();
+    qint64 outStep = fps.den() * timeBase.den();
+    qreal time = packet.pts() * timeBase.value();
+
+    // Re-baseline on the first frame and on backward jumps, so seeks and
+    // stream restarts don't flood the sink with catch-up duplicates.
+    if (!this->d->m_synced || time < this->d->m_lastTime) {
+        this->d->m_frameCount = inTicks / outStep;
+        this->d->m_synced = true;
+    }
+
+    this->d->m_lastTime = time;
+
+    AkPacket oPacket(packet);
+    AkVideoCaps caps(packet.caps());
+    caps.fps() = fps;
+    oPacket.caps() = caps.toCaps();
+    oPacket.timeBase() = fps.invert();
+    bool sent = false;
+
+    while (this->d->m_frameCount * outStep <= inTicks) {
+        oPacket.pts() = this->d->m_frameCount;
+        this->d->m_frameCount++;
+        // send() reaches fast-linked sinks too, a raw emit would not.
+        this->send(oPacket);
+        sent = true;
+    }
+
+    this->d->m_mutex.unlock();
+
+    // If no output frame was due, the input frame is dropped.
+    return sent? oPacket: AkPacket();
+}
+
+bool FpsConvertElement::setState(AkElement::ElementState state)
+{
+    if (state == AkElement::ElementStateNull) {
+        this->d->m_mutex.lock();
+        this->d->m_synced = false;
+        this->d->m_mutex.unlock();
+    }
+
+    return AkElement::setState(state);
+}
+
+#include "moc_fpsconvertelement.cpp"
@@ -0,0 +1,66 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef FPSCONVERTELEMENT_H
+#define FPSCONVERTELEMENT_H
+
+#include <akelement.h>
+#include <akfrac.h>
+
+class FpsConvertElementPrivate;
+
+/* Timestamp driven frame rate converter.
+ *
+ * Retimes a video stream to a fixed frame rate by dropping or duplicating
+ * frames by PTS. A duplicated frame is a shallow packet copy, the pixel
+ * buffer is shared, and all the timing decisions are exact integer cross
+ * products of the input time base and the target rate, so dups and drops
+ * never accumulate rounding drift. An invalid fps passes the stream
+ * through untouched.
+ */
+class FpsConvertElement: public AkElement
+{
+    Q_OBJECT
+    Q_PROPERTY(AkFrac fps
+               READ fps
+               WRITE setFps
+               RESET resetFps
+               NOTIFY fpsChanged)
+
+    public:
+        explicit FpsConvertElement();
+        ~FpsConvertElement();
+
+        Q_INVOKABLE AkFrac fps() const;
+
+    private:
+        FpsConvertElementPrivate *d;
+
+    signals:
+        void fpsChanged(const AkFrac &fps);
+
+    public slots:
+        void setFps(const AkFrac &fps);
+        void resetFps();
+
+        AkPacket iStream(const AkPacket &packet);
+        bool setState(AkElement::ElementState state);
+};
+
+#endif // FPSCONVERTELEMENT_H
@@ -19,8 +19,11 @@
 
 #include <QImage>
 #include <QQmlContext>
+#include <QVector>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akframering.h>
+#include <akvideofilterrunner.h>
 
 #include "frameoverlapelement.h"
 
@@ -29,7 +32,7 @@ class FrameOverlapElementPrivate
     public:
         int m_nFrames;
         int m_stride;
-        QVector<QImage> m_frames;
+        AkFrameRing m_frames;
         QSize m_frameSize;
 
         FrameOverlapElementPrivate():
@@ -118,48 +121,50 @@ AkPacket FrameOverlapElement::iStream(const AkPacket &packet)
         this->d->m_frameSize = src.size();
     }
 
-    this->d->m_frames << src.copy();
-    int diff = this->d->m_frames.size() - this->d->m_nFrames;
-
-    for (int i = 0; i < diff; i++)
-        this->d->m_frames.removeFirst();
+    int nFrames = this->d->m_nFrames > 0? this->d->m_nFrames: 1;
+    this->d->m_frames.resize(nFrames, src.size(), src.format());
+    this->d->m_frames.push(src);
 
     int stride = this->d->m_stride > 0? this->d->m_stride: 1;
 
-    for (int y = 0; y < oFrame.height(); y++) {
-        QRgb *dstBits = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
-
-        for (int x = 0; x < oFrame.width(); x++) {
-            int r = 0;
-            int g = 0;
-            int b = 0;
-            int a = 0;
-            int n = 0;
-
-            for (int frame = this->d->m_frames.size() - 1;
-                 frame >= 0;
-                 frame -= stride) {
-                QRgb pixel = this->d->m_frames[frame].pixel(x, y);
-
-                r += qRed(pixel);
-                g += qGreen(pixel);
-                b += qBlue(pixel);
-                a += qAlpha(pixel);
-                n++;
-            }
+    // Frames blended together, from the newest one backwards.
+    QVector<const QImage *> frames;
+
+    for (int frame = this->d->m_frames.size() - 1; frame >= 0; frame -= stride)
+        frames << &this->d->m_frames.at(frame);
+
+    int n = frames.size();
+    int width = oFrame.width();
+
+    AkVideoFilterRunner::globalRunner()->run(oFrame.height(),
+                                             [&] (int yStart, int yEnd) {
+        QVector<const QRgb *> srcLines(n);
 
-            if (n > 0) {
-                r /= n;
-                g /= n;
-                b /= n;
-                a /= n;
+        for (int y = yStart; y < yEnd; y++) {
+            QRgb *dstBits = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
 
-                dstBits[x] = qRgba(r, g, b, a);
-            } else {
-                dstBits[x] = qRgba(0, 0, 0, 0);
+            for (int k = 0; k < n; k++)
+                srcLines[k] = reinterpret_cast<const QRgb *>(frames[k]->constScanLine(y));
+
+            for (int x = 0; x < width; x++) {
+                int r = 0;
+                int g = 0;
+                int b = 0;
+                int a = 0;
+
+                for (int k = 0; k < n; k++) {
+                    QRgb pixel = srcLines[k][x];
+
+                    r += qRed(pixel);
+                    g += qGreen(pixel);
+                    b += qBlue(pixel);
+                    a += qAlpha(pixel);
+                }
+
+                dstBits[x] = qRgba(r / n, g / n, b / n, a / n);
             }
         }
-    }
+    });
 
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
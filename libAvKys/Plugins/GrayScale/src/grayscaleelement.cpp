@@ -20,6 +20,12 @@
 #include <QImage>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akvideokernel.h>
+#include <akvideofilterrunner.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #include "grayscaleelement.h"
 
@@ -29,12 +35,77 @@ GrayScaleElement::GrayScaleElement(): AkElement()
 
 AkPacket GrayScaleElement::iStream(const AkPacket &packet)
 {
+    AkVideoPacket videoPacket(packet);
+    auto format = videoPacket.caps().format();
+
+    // Gray packets are already the result, and for yuyv the luma plane is,
+    // so neutralizing the chroma is all it takes. No colorspace conversion
+    // in either case.
+    if (format == AkVideoCaps::Format_gray)
+        akSend(packet)
+
+    if (AkVideoKernel::canMapLuma(format)) {
+        AkPacket oPacket =
+                AkVideoKernel::mapLuma(videoPacket,
+                                       [] (quint8 luma) -> quint8 {
+                                           return luma;
+                                       },
+                                       true).toPacket();
+
+        if (oPacket)
+            akSend(oPacket)
+    }
+
     QImage src = AkUtils::packetToImage(packet);
 
     if (src.isNull())
         return AkPacket();
 
-    QImage oFrame = src.convertToFormat(QImage::Format_Grayscale8);
+    if (src.format() != QImage::Format_RGB32
+        && src.format() != QImage::Format_ARGB32)
+        src = src.convertToFormat(QImage::Format_ARGB32);
+
+    QImage oFrame(src.size(), QImage::Format_Grayscale8);
+    int width = src.width();
+
+    AkVideoFilterRunner::globalRunner()->run(src.height(),
+                                             [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            auto iLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
+            quint8 *oLine = oFrame.scanLine(y);
+            int x = 0;
+
+#if defined(__SSE2__)
+            // qGray() is (11 r + 16 g + 5 b) / 32; madd folds the weighting
+            // of the interleaved channels, 8 pixels per iteration.
+            __m128i zero = _mm_setzero_si128();
+            __m128i coeff = _mm_set_epi16(0, 11, 16, 5, 0, 11, 16, 5);
+
+            auto lumaOf4 = [&] (const QRgb *pixels) -> __m128i {
+                __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pixels));
+                __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi8(p, zero), coeff);
+                __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi8(p, zero), coeff);
+                lo = _mm_add_epi32(lo, _mm_srli_si128(lo, 4));
+                hi = _mm_add_epi32(hi, _mm_srli_si128(hi, 4));
+                lo = _mm_shuffle_epi32(lo, _MM_SHUFFLE(2, 0, 2, 0));
+                hi = _mm_shuffle_epi32(hi, _MM_SHUFFLE(2, 0, 2, 0));
+
+                return _mm_srli_epi32(_mm_unpacklo_epi64(lo, hi), 5);
+            };
+
+            for (; x < width - 7; x += 8) {
+                __m128i words = _mm_packs_epi32(lumaOf4(iLine + x),
+                                                lumaOf4(iLine + x + 4));
+                _mm_storel_epi64(reinterpret_cast<__m128i *>(oLine + x),
+                                 _mm_packus_epi16(words, zero));
+            }
+#endif
+
+            for (; x < width; x++)
+                oLine[x] = quint8(qGray(iLine[x]));
+        }
+    });
+
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
 }
@@ -21,8 +21,10 @@
 #include <QQmlContext>
 #include <QMutex>
 #include <QStandardPaths>
+#include <QVector>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akvideofilterrunner.h>
 
 #include "halftoneelement.h"
 
@@ -38,11 +40,24 @@ class HalftoneElementPrivate
         QSize m_frameSize;
         QImage m_patternImage;
 
+        /* The threshold matrix tiled to the frame width with slope and
+         * intercept already applied, so the per-pixel work is a compare.
+         */
+        QVector<quint8> m_thresholdPlane;
+        int m_planeWidth;
+        qint64 m_planeKey;
+        qreal m_planeSlope;
+        qreal m_planeIntercept;
+
         HalftoneElementPrivate():
             m_pattern(":/Halftone/share/patterns/ditherCluster8Matrix.bmp"),
             m_lightness(0.5),
             m_slope(1.0),
-            m_intercept(0.0)
+            m_intercept(0.0),
+            m_planeWidth(0),
+            m_planeKey(0),
+            m_planeSlope(0.0),
+            m_planeIntercept(0.0)
         {
         }
 };
@@ -240,41 +255,70 @@ AkPacket HalftoneElement::iStream(const AkPacket &packet)
         akSend(packet)
     }
 
-    QImage patternImage = this->d->m_patternImage.copy();
+    // Shallow copy, updatePattern() always replaces the whole image.
+    QImage patternImage = this->d->m_patternImage;
     this->d->m_mutex.unlock();
 
-    // filter image
-    for (int y = 0; y < src.height(); y++) {
-        const QRgb *iLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
-        QRgb *oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
-
-        for (int x = 0; x < src.width(); x++) {
-            int col = x % patternImage.width();
-            int row = y % patternImage.height();
-
-            int gray = qGray(iLine[x]);
-            const quint8 *pattern = reinterpret_cast<const quint8 *>(patternImage.constScanLine(row));
-            int threshold = pattern[col];
-            threshold = int(this->d->m_slope
-                            * threshold
-                            + this->d->m_intercept);
-            threshold = qBound(0, threshold, 255);
-
-            if (gray > threshold)
-                oLine[x] = iLine[x];
-            else {
-                QColor color(iLine[x]);
-
-                color.setHsl(color.hue(),
-                             color.saturation(),
-                             int(this->d->m_lightness * color.lightness()),
-                             color.alpha());
-
-                oLine[x] = color.rgba();
-            }
+    int width = src.width();
+    int height = src.height();
+    int patternWidth = patternImage.width();
+    int patternHeight = patternImage.height();
+    qreal slope = this->d->m_slope;
+    qreal intercept = this->d->m_intercept;
+    qreal lightness = this->d->m_lightness;
+
+    if (this->d->m_planeWidth != width
+        || this->d->m_planeKey != patternImage.cacheKey()
+        || this->d->m_planeSlope != slope
+        || this->d->m_planeIntercept != intercept) {
+        quint8 thresholdTable[256];
+
+        for (int i = 0; i < 256; i++)
+            thresholdTable[i] = quint8(qBound(0,
+                                              int(slope * i + intercept),
+                                              255));
+
+        this->d->m_thresholdPlane.resize(patternHeight * width);
+
+        for (int row = 0; row < patternHeight; row++) {
+            auto pattern = patternImage.constScanLine(row);
+            quint8 *planeLine = this->d->m_thresholdPlane.data() + row * width;
+
+            for (int x = 0; x < width; x++)
+                planeLine[x] = thresholdTable[pattern[x % patternWidth]];
         }
+
+        this->d->m_planeWidth = width;
+        this->d->m_planeKey = patternImage.cacheKey();
+        this->d->m_planeSlope = slope;
+        this->d->m_planeIntercept = intercept;
     }
 
+    const quint8 *plane = this->d->m_thresholdPlane.constData();
+
+    AkVideoFilterRunner::globalRunner()->run(height, [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            const QRgb *iLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
+            QRgb *oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+            const quint8 *thresholdLine = plane + (y % patternHeight) * width;
+
+            for (int x = 0; x < width; x++) {
+                if (qGray(iLine[x]) > thresholdLine[x])
+                    oLine[x] = iLine[x];
+                else {
+                    QColor color(iLine[x]);
+
+                    color.setHsl(color.hue(),
+                                 color.saturation(),
+                                 int(lightness * color.lightness()),
+                                 color.alpha());
+
+                    oLine[x] = color.rgba();
+                }
+            }
+        }
+    });
+
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
 }
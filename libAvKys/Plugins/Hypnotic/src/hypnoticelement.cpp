@@ -23,6 +23,7 @@
 #include <QtMath>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akvideofilterrunner.h>
 
 #include "hypnoticelement.h"
 
@@ -64,7 +65,6 @@ class HypnoticElementPrivate
 
         inline QVector<QRgb> createPalette();
         inline OpticalMap createOpticalMap(const QSize &size);
-        inline QImage imageThreshold(const QImage &src, int threshold);
 };
 
 HypnoticElement::HypnoticElement(): AkElement()
@@ -158,21 +158,6 @@ OpticalMap HypnoticElementPrivate::createOpticalMap(const QSize &size)
     return opticalMap;
 }
 
-QImage HypnoticElementPrivate::imageThreshold(const QImage &src, int threshold)
-{
-    QImage diff(src.size(), QImage::Format_Grayscale8);
-
-    for (int y = 0; y < src.height(); y++) {
-        const QRgb *srcBits = reinterpret_cast<const QRgb *>(src.constScanLine(y));
-        quint8 *diffBits = diff.scanLine(y);
-
-        for (int x = 0; x < src.width(); x++)
-            diffBits[x] = qGray(srcBits[x]) >= threshold? 255: 0;
-    }
-
-    return diff;
-}
-
 QString HypnoticElement::controlInterfaceProvide(const QString &controlId) const
 {
     Q_UNUSED(controlId)
@@ -257,16 +242,28 @@ AkPacket HypnoticElement::iStream(const AkPacket &packet)
     this->d->m_speed += this->d->m_speedInc;
     this->d->m_phase -= this->d->m_speed;
 
-    QImage diff = this->d->imageThreshold(src, this->d->m_threshold);
-
-    for (int i = 0, y = 0; y < src.height(); y++) {
-        QRgb *oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
-        const quint8 *optLine = opticalMap.constScanLine(y);
-        const quint8 *diffLine = diff.constScanLine(y);
-
-        for (int x = 0; x < src.width(); i++, x++)
-            oLine[x] = this->d->m_palette[((char(optLine[x] + this->d->m_phase)) ^ diffLine[x]) & 255];
-    }
+    /* The polar tables are already cached per geometry, the animation
+     * only shifts the table values by the phase. Fold the threshold pass
+     * into the same scan, so each frame is read and written exactly
+     * once, and spread the rows over the worker pool. */
+    quint8 phase = this->d->m_phase;
+    int threshold = this->d->m_threshold;
+    const QRgb *palette = this->d->m_palette.constData();
+    int width = src.width();
+
+    AkVideoFilterRunner::globalRunner()->run(src.height(),
+                                             [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            auto iLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
+            auto oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+            const quint8 *optLine = opticalMap.constScanLine(y);
+
+            for (int x = 0; x < width; x++) {
+                quint8 diff = qGray(iLine[x]) >= threshold? 255: 0;
+                oLine[x] = palette[(char(optLine[x] + phase) ^ diff) & 255];
+            }
+        }
+    });
 
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
@@ -28,6 +28,7 @@
 ImplodeElement::ImplodeElement(): AkElement()
 {
     this->m_amount = 1.0;
+    this->m_mapAmount = 0;
 }
 
 qreal ImplodeElement::amount() const
@@ -74,37 +75,39 @@ AkPacket ImplodeElement::iStream(const AkPacket &packet)
 
     src = src.convertToFormat(QImage::Format_ARGB32);
     QImage oFrame(src.size(), src.format());
-
-    int xc = src.width() >> 1;
-    int yc = src.height() >> 1;
-    int radius = qMin(xc, yc);
-
-    for (int y = 0; y < src.height(); y++) {
-        const QRgb *iLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
-        QRgb *oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
-        int yDiff = y - yc;
-
-        for (int x = 0; x < src.width(); x++) {
+    qreal amount = this->m_amount;
+
+    // The implosion only depends on the amount and the frame geometry.
+    if (!this->m_displacementMap.isValid(src.size())
+        || this->m_mapAmount != amount) {
+        int xc = src.width() >> 1;
+        int yc = src.height() >> 1;
+        int radius = qMin(xc, yc);
+        int width = src.width();
+        int height = src.height();
+
+        this->m_displacementMap.setMap(src.size(), [&] (int x, int y) {
             int xDiff = x - xc;
+            int yDiff = y - yc;
             qreal distance = sqrt(xDiff * xDiff + yDiff * yDiff);
 
             if (distance >= radius)
-                oLine[x] = iLine[x];
-            else {
-                qreal factor = pow(distance / radius, this->m_amount);
+                return QPoint(x, y);
 
-                int xp = int(factor * xDiff + xc);
-                int yp = int(factor * yDiff + yc);
+            qreal factor = pow(distance / radius, amount);
 
-                xp = qBound(0, xp, oFrame.width() - 1);
-                yp = qBound(0, yp, oFrame.height() - 1);
+            int xp = int(factor * xDiff + xc);
+            int yp = int(factor * yDiff + yc);
 
-                const QRgb *line = reinterpret_cast<const QRgb *>(src.constScanLine(yp));
-                oLine[x] = line[xp];
-            }
-        }
+            return QPoint(qBound(0, xp, width - 1),
+                          qBound(0, yp, height - 1));
+        });
+
+        this->m_mapAmount = amount;
     }
 
+    this->m_displacementMap.apply(src, oFrame);
+
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
 }
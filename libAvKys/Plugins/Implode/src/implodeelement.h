@@ -21,6 +21,7 @@
 #define IMPLODEELEMENT_H
 
 #include <akelement.h>
+#include <akdisplacementmap.h>
 
 class ImplodeElement: public AkElement
 {
@@ -43,6 +44,8 @@ class ImplodeElement: public AkElement
 
     private:
         qreal m_amount;
+        qreal m_mapAmount;
+        AkDisplacementMap m_displacementMap;
 
     signals:
         void amountChanged(qreal amount);
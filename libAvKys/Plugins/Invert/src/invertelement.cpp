@@ -20,6 +20,12 @@
 #include <QImage>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akvideokernel.h>
+#include <akvideofilterrunner.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #include "invertelement.h"
 
@@ -29,13 +35,55 @@ InvertElement::InvertElement(): AkElement()
 
 AkPacket InvertElement::iStream(const AkPacket &packet)
 {
+    // Process the packet in its own format when possible, skipping the
+    // ARGB round trip entirely.
+    AkVideoPacket videoPacket(packet);
+
+    if (AkVideoKernel::canMap(videoPacket.caps().format())) {
+        AkPacket oPacket =
+                AkVideoKernel::map(videoPacket, [] (QRgb color) -> QRgb {
+                    return color ^ 0x00ffffff;
+                }).toPacket();
+
+        if (oPacket)
+            akSend(oPacket)
+    }
+
     QImage src = AkUtils::packetToImage(packet);
 
     if (src.isNull())
         return AkPacket();
 
-    QImage oFrame = src.convertToFormat(QImage::Format_ARGB32);
-    oFrame.invertPixels();
+    src = src.convertToFormat(QImage::Format_ARGB32);
+    QImage oFrame(src.size(), src.format());
+
+    int width = src.width();
+
+    AkVideoFilterRunner::globalRunner()->run(src.height(),
+                                             [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            auto iLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
+            QRgb *oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+            int x = 0;
+
+#if defined(__SSE2__)
+            // Invert the color channels and keep the alpha, 16 pixels per
+            // iteration.
+            __m128i mask = _mm_set1_epi32(0x00ffffff);
+
+            for (; x < width - 15; x += 16)
+                for (int i = 0; i < 4; i++) {
+                    auto ip = reinterpret_cast<const __m128i *>(iLine + x) + i;
+                    auto op = reinterpret_cast<__m128i *>(oLine + x) + i;
+                    _mm_storeu_si128(op, _mm_xor_si128(_mm_loadu_si128(ip),
+                                                       mask));
+                }
+#endif
+
+            for (; x < width; x++)
+                oLine[x] = iLine[x] ^ 0x00ffffff;
+        }
+    });
 
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
@@ -18,10 +18,12 @@
  */
 
 #include <QQmlContext>
+#include <QtAlgorithms>
 #include <QtMath>
-#include <QPainter>
+#include <QVector>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akvideofilterrunner.h>
 
 #include "lifeelement.h"
 
@@ -33,12 +35,20 @@ class LifeElementPrivate
         int m_lumaThreshold;
         QSize m_frameSize;
         QImage m_prevFrame;
-        QImage m_lifeBuffer;
+
+        /* The life grid packed 64 cells per word. Generations are evaluated
+         * word-wise with bit-parallel adders, so one step costs a handful of
+         * logic operations per 64 cells.
+         */
+        int m_wordsPerRow;
+        QVector<quint64> m_lifeGrid;
+        QVector<quint64> m_nextGrid;
 
         LifeElementPrivate():
             m_lifeColor(qRgb(255, 255, 255)),
             m_threshold(15),
-            m_lumaThreshold(15)
+            m_lumaThreshold(15),
+            m_wordsPerRow(0)
         {
         }
 };
@@ -68,74 +78,149 @@ int LifeElement::lumaThreshold() const
     return this->d->m_lumaThreshold;
 }
 
-QImage LifeElement::imageDiff(const QImage &img1,
-                              const QImage &img2,
-                              int threshold,
-                              int lumaThreshold)
+void LifeElement::seedFromDiff(const QImage &img1,
+                               const QImage &img2,
+                               int threshold,
+                               int lumaThreshold)
 {
     int width = qMin(img1.width(), img2.width());
     int height = qMin(img1.height(), img2.height());
-    QImage diff(width, height, QImage::Format_Indexed8);
+    int wordsPerRow = this->d->m_wordsPerRow;
+    quint64 *grid = this->d->m_lifeGrid.data();
 
-    for (int y = 0; y < height; y++) {
-        const QRgb *line1 = reinterpret_cast<const QRgb *>(img1.constScanLine(y));
-        const QRgb *line2 = reinterpret_cast<const QRgb *>(img2.constScanLine(y));
-        quint8 *lineDiff = diff.scanLine(y);
+    AkVideoFilterRunner::globalRunner()->run(height, [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            const QRgb *line1 = reinterpret_cast<const QRgb *>(img1.constScanLine(y));
+            const QRgb *line2 = reinterpret_cast<const QRgb *>(img2.constScanLine(y));
+            quint64 *lifeLine = grid + y * wordsPerRow;
 
-        for (int x = 0; x < width; x++) {
-            int r1 = qRed(line1[x]);
-            int g1 = qGreen(line1[x]);
-            int b1 = qBlue(line1[x]);
+            for (int w = 0; w < wordsPerRow; w++) {
+                quint64 bits = 0;
+                int xStart = w << 6;
+                int xEnd = qMin(xStart + 64, width);
 
-            int r2 = qRed(line2[x]);
-            int g2 = qGreen(line2[x]);
-            int b2 = qBlue(line2[x]);
+                for (int x = xStart; x < xEnd; x++) {
+                    int r1 = qRed(line1[x]);
+                    int g1 = qGreen(line1[x]);
+                    int b1 = qBlue(line1[x]);
 
-            int dr = r1 - r2;
-            int dg = g1 - g2;
-            int db = b1 - b2;
+                    int r2 = qRed(line2[x]);
+                    int g2 = qGreen(line2[x]);
+                    int b2 = qBlue(line2[x]);
 
-            int colorDiff = dr * dr + dg * dg + db * db;
+                    int dr = r1 - r2;
+                    int dg = g1 - g2;
+                    int db = b1 - b2;
 
-            lineDiff[x] = sqrt(colorDiff / 3) >= threshold
-                          && qGray(line2[x]) >= lumaThreshold? 1: 0;
-        }
-    }
+                    int colorDiff = dr * dr + dg * dg + db * db;
+
+                    if (sqrt(colorDiff / 3) >= threshold
+                        && qGray(line2[x]) >= lumaThreshold)
+                        bits |= Q_UINT64_C(1) << (x - xStart);
+                }
 
-    return diff;
+                lifeLine[w] |= bits;
+            }
+        }
+    });
 }
 
 void LifeElement::updateLife()
 {
-    QImage lifeBuffer(this->d->m_lifeBuffer.size(),
-                      this->d->m_lifeBuffer.format());
-    lifeBuffer.fill(0);
+    int width = this->d->m_frameSize.width();
+    int height = this->d->m_frameSize.height();
+    int wordsPerRow = this->d->m_wordsPerRow;
+    const quint64 *grid = this->d->m_lifeGrid.constData();
+    quint64 *next = this->d->m_nextGrid.data();
 
-    for (int y = 1; y < lifeBuffer.height() - 1; y++) {
-        auto iLine = this->d->m_lifeBuffer.constScanLine(y);
-        auto oLine = lifeBuffer.scanLine(y);
+    // The border cells always die, like in the per-cell implementation.
+    quint64 firstMask = ~Q_UINT64_C(1);
+    quint64 lastMask = (Q_UINT64_C(1) << ((width - 1) & 63)) - 1;
+    int lastWord = wordsPerRow - 1;
 
-        for (int x = 1; x < lifeBuffer.width() - 1; x++) {
-            int count = 0;
+    AkVideoFilterRunner::globalRunner()->run(height, [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            quint64 *nextLine = next + y * wordsPerRow;
 
-            for (int j = -1; j < 2; j++) {
-                auto line = this->d->m_lifeBuffer.constScanLine(y + j);
+            if (y < 1 || y >= height - 1) {
+                memset(nextLine, 0, size_t(wordsPerRow) * sizeof(quint64));
 
-                for (int i = -1; i < 2; i++)
-                    count += line[x + i];
+                continue;
             }
 
-            count -= iLine[x];
-
-            if ((iLine[x] && count == 2) || count == 3)
-                oLine[x] = 1;
+            const quint64 *up = grid + (y - 1) * wordsPerRow;
+            const quint64 *mid = grid + y * wordsPerRow;
+            const quint64 *dn = grid + (y + 1) * wordsPerRow;
+
+            for (int w = 0; w < wordsPerRow; w++) {
+                quint64 upC = up[w];
+                quint64 midC = mid[w];
+                quint64 dnC = dn[w];
+                quint64 upP = w > 0? up[w - 1]: 0;
+                quint64 midP = w > 0? mid[w - 1]: 0;
+                quint64 dnP = w > 0? dn[w - 1]: 0;
+                quint64 upN = w < lastWord? up[w + 1]: 0;
+                quint64 midN = w < lastWord? mid[w + 1]: 0;
+                quint64 dnN = w < lastWord? dn[w + 1]: 0;
+
+                /* Words whose whole neighborhood is empty stay empty, which
+                 * skips most of a sparse grid.
+                 */
+                quint64 active = upC | midC | dnC
+                                 | ((upP | midP | dnP) >> 63)
+                                 | ((upN | midN | dnN) << 63);
+
+                if (!active) {
+                    nextLine[w] = 0;
+
+                    continue;
+                }
+
+                // West and east neighbors aligned onto each cell.
+                quint64 upW = (upC << 1) | (upP >> 63);
+                quint64 upE = (upC >> 1) | (upN << 63);
+                quint64 midW = (midC << 1) | (midP >> 63);
+                quint64 midE = (midC >> 1) | (midN << 63);
+                quint64 dnW = (dnC << 1) | (dnP >> 63);
+                quint64 dnE = (dnC >> 1) | (dnN << 63);
+
+                /* Per-row neighbor sums as (ones, twos) bit planes, then the
+                 * three partial sums added into the count bit planes. The
+                 * third bit saturates, which is enough since any count of 4
+                 * or more kills the cell anyway.
+                 */
+                quint64 onesUp = upW ^ upC ^ upE;
+                quint64 twosUp = (upW & upC) | (upE & (upW ^ upC));
+                quint64 onesDn = dnW ^ dnC ^ dnE;
+                quint64 twosDn = (dnW & dnC) | (dnE & (dnW ^ dnC));
+                quint64 onesMid = midW ^ midE;
+                quint64 twosMid = midW & midE;
+
+                quint64 bit0 = onesUp ^ onesDn ^ onesMid;
+                quint64 carry = (onesUp & onesDn) | (onesMid & (onesUp ^ onesDn));
+
+                quint64 t0 = twosUp ^ twosDn;
+                quint64 tc0 = twosUp & twosDn;
+                quint64 t1 = twosMid ^ carry;
+                quint64 tc1 = twosMid & carry;
+                quint64 bit1 = t0 ^ t1;
+                quint64 bit2 = (t0 & t1) | tc0 | tc1;
+
+                // Alive with 3 neighbors, or already alive with 2.
+                quint64 alive = ~bit2 & bit1 & (bit0 | midC);
+
+                if (w == 0)
+                    alive &= firstMask;
+
+                if (w == lastWord)
+                    alive &= lastMask;
+
+                nextLine[w] = alive;
+            }
         }
-    }
+    });
 
-    memcpy(this->d->m_lifeBuffer.bits(),
-           lifeBuffer.constBits(),
-           size_t(lifeBuffer.bytesPerLine())
-           * size_t(lifeBuffer.height()));
+    qSwap(this->d->m_lifeGrid, this->d->m_nextGrid);
 }
 
 QString LifeElement::controlInterfaceProvide(const QString &controlId) const
@@ -207,42 +292,48 @@ AkPacket LifeElement::iStream(const AkPacket &packet)
     QImage oFrame = src;
 
     if (src.size() != this->d->m_frameSize) {
-        this->d->m_lifeBuffer = QImage();
         this->d->m_prevFrame = QImage();
         this->d->m_frameSize = src.size();
     }
 
     if (this->d->m_prevFrame.isNull()) {
-        this->d->m_lifeBuffer = QImage(src.size(), QImage::Format_Indexed8);
-        this->d->m_lifeBuffer.setColor(0, 0);
-        this->d->m_lifeBuffer.setColor(1, this->d->m_lifeColor);
-        this->d->m_lifeBuffer.fill(0);
-    }
-    else {
-        // Compute the difference between previous and current frame,
-        // and save it to the buffer.
-        QImage diff =
-                this->imageDiff(this->d->m_prevFrame,
-                                src,
-                                this->d->m_threshold,
-                                this->d->m_lumaThreshold);
-
-        this->d->m_lifeBuffer.setColor(1, this->d->m_lifeColor);
-
-        for (int y = 0; y < this->d->m_lifeBuffer.height(); y++) {
-            auto diffLine = diff.constScanLine(y);
-            auto lifeBufferLine = this->d->m_lifeBuffer.scanLine(y);
-
-            for (int x = 0; x < this->d->m_lifeBuffer.width(); x++)
-                lifeBufferLine[x] |= diffLine[x];
-        }
+        this->d->m_wordsPerRow = (src.width() + 63) >> 6;
+        int gridWords = this->d->m_wordsPerRow * src.height();
+        this->d->m_lifeGrid = QVector<quint64>(gridWords, 0);
+        this->d->m_nextGrid = QVector<quint64>(gridWords, 0);
+    } else {
+        // Cells touched by motion between the frames come alive.
+        this->seedFromDiff(this->d->m_prevFrame,
+                           src,
+                           this->d->m_threshold,
+                           this->d->m_lumaThreshold);
 
         this->updateLife();
 
-        QPainter painter;
-        painter.begin(&oFrame);
-        painter.drawImage(0, 0, this->d->m_lifeBuffer);
-        painter.end();
+        QRgb lifeColor = this->d->m_lifeColor;
+        int wordsPerRow = this->d->m_wordsPerRow;
+        const quint64 *grid = this->d->m_lifeGrid.constData();
+
+        // Detach the output before the bands write to it.
+        oFrame.bits();
+
+        AkVideoFilterRunner::globalRunner()->run(src.height(),
+                                                 [&] (int yStart, int yEnd) {
+            for (int y = yStart; y < yEnd; y++) {
+                auto oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+                const quint64 *lifeLine = grid + y * wordsPerRow;
+
+                for (int w = 0; w < wordsPerRow; w++) {
+                    quint64 bits = lifeLine[w];
+                    int xStart = w << 6;
+
+                    while (bits) {
+                        oLine[xStart + qCountTrailingZeroBits(bits)] = lifeColor;
+                        bits &= bits - 1;
+                    }
+                }
+            }
+        });
     }
 
     this->d->m_prevFrame = src.copy();
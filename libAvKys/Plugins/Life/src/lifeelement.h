@@ -55,10 +55,10 @@ class LifeElement: public AkElement
     private:
         LifeElementPrivate *d;
 
-        QImage imageDiff(const QImage &img1,
-                         const QImage &img2,
-                         int threshold,
-                         int lumaThreshold);
+        void seedFromDiff(const QImage &img1,
+                          const QImage &img2,
+                          int threshold,
+                          int lumaThreshold);
         void updateLife();
 
     protected:
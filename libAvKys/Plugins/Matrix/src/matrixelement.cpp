@@ -24,6 +24,8 @@
 #include <QMutex>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akvideocaps.h>
+#include <akvideofilterrunner.h>
 
 #include "matrixelement.h"
 #include "character.h"
@@ -96,7 +98,7 @@ class MatrixElementPrivate
                         QRgb foreground, QRgb background) const;
         int imageWeight(const QImage &image) const;
         static bool chrLessThan(const Character &chr1, const Character &chr2);
-        QImage renderRain(const QSize &frameSize, const QImage &textImage);
+        void renderRain(QImage &frame, const QImage &textImage);
 };
 
 MatrixElement::MatrixElement(): AkElement()
@@ -282,12 +284,9 @@ bool MatrixElementPrivate::chrLessThan(const Character &chr1,
     return chr1.weight < chr2.weight;
 }
 
-QImage MatrixElementPrivate::renderRain(const QSize &frameSize,
-                                        const QImage &textImage)
+void MatrixElementPrivate::renderRain(QImage &frame, const QImage &textImage)
 {
     this->m_mutex.lock();
-    QImage rain(frameSize, QImage::Format_ARGB32);
-    rain.fill(qRgba(0, 0, 0, 0));
     QPainter painter;
 
     bool randomStart = this->m_rain.isEmpty();
@@ -306,7 +305,11 @@ QImage MatrixElementPrivate::renderRain(const QSize &frameSize,
                                  this->m_maxSpeed,
                                  randomStart);
 
-    painter.begin(&rain);
+    /* The sprites go straight onto the output; source-over composition is
+     * associative, so this matches painting them on a transparent plane
+     * and blending that over the frame, minus the frame sized temporary.
+     */
+    painter.begin(&frame);
 
     for (int i = 0; i < this->m_rain.size(); i++) {
         QPoint tail = this->m_rain[i].tail();
@@ -332,8 +335,6 @@ QImage MatrixElementPrivate::renderRain(const QSize &frameSize,
 
     painter.end();
     this->m_mutex.unlock();
-
-    return rain;
 }
 
 QString MatrixElement::controlInterfaceProvide(const QString &controlId) const
@@ -583,44 +584,70 @@ AkPacket MatrixElement::iStream(const AkPacket &packet)
     src = src.convertToFormat(QImage::Format_RGB32);
 
     this->d->m_mutex.lock();
-    int textWidth = src.width() / this->d->m_fontSize.width();
-    int textHeight = src.height() / this->d->m_fontSize.height();
-
-    int outWidth = textWidth * this->d->m_fontSize.width();
-    int outHeight = textHeight * this->d->m_fontSize.height();
-
-    QImage oFrame(outWidth, outHeight, src.format());
-
+    QSize fontSize = this->d->m_fontSize;
     QList<Character> characters(this->d->m_characters);
     this->d->m_mutex.unlock();
 
+    int fontWidth = fontSize.width();
+    int fontHeight = fontSize.height();
+    int textWidth = src.width() / fontWidth;
+    int textHeight = src.height() / fontHeight;
+
+    int outWidth = textWidth * fontWidth;
+    int outHeight = textHeight * fontHeight;
+
     if (characters.size() < 256) {
+        QImage oFrame(outWidth, outHeight, src.format());
         oFrame.fill(this->d->m_backgroundColor);
         AkPacket oPacket = AkUtils::imageToPacket(oFrame.scaled(src.size()),
                                                   packet);
         akSend(oPacket)
     }
 
+    /* The output image is a view over the packet buffer, so the rendered
+     * frame is sent downstream without a final copy.
+     */
+    int oLineSize = 4 * outWidth;
+    QByteArray oBuffer(oLineSize * outHeight, 0);
+    QImage oFrame(reinterpret_cast<uchar *>(oBuffer.data()),
+                  outWidth,
+                  outHeight,
+                  oLineSize,
+                  src.format());
+
     QImage textImage = src.scaled(textWidth, textHeight);
     QRgb *textImageBits = reinterpret_cast<QRgb *>(textImage.bits());
-    int textArea = textImage.width() * textImage.height();
-    QPainter painter;
-
-    painter.begin(&oFrame);
-
-    for (int i = 0; i < textArea; i++) {
-        int x = this->d->m_fontSize.width() * (i % textWidth);
-        int y = this->d->m_fontSize.height() * (i / textWidth);
-
-        Character chr = characters[qGray(textImageBits[i])];
-        painter.drawImage(x, y, chr.image);
-        textImageBits[i] = chr.foreground;
-    }
-
-    painter.drawImage(0, 0, this->d->renderRain(oFrame.size(), textImage));
-    painter.end();
-
-    AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
+    size_t glyphLineSize = size_t(fontWidth) * sizeof(QRgb);
+
+    // Blit the glyphs row-wise from the pre-rendered set, one text row
+    // band per thread.
+    AkVideoFilterRunner::globalRunner()->run(textHeight,
+                                             [&] (int yStart, int yEnd) {
+        for (int ty = yStart; ty < yEnd; ty++)
+            for (int tx = 0; tx < textWidth; tx++) {
+                int i = tx + ty * textWidth;
+                const Character &chr = characters[qGray(textImageBits[i])];
+                textImageBits[i] = chr.foreground;
+
+                for (int fy = 0; fy < fontHeight; fy++) {
+                    auto oLine = oFrame.scanLine(fy + ty * fontHeight)
+                                 + tx * glyphLineSize;
+                    memcpy(oLine, chr.image.constScanLine(fy), glyphLineSize);
+                }
+            }
+    });
+
+    this->d->renderRain(oFrame, textImage);
+
+    AkVideoCaps caps(packet.caps());
+    caps.format() = AkVideoCaps::Format_0rgb;
+    caps.bpp() = AkVideoCaps::bitsPerPixel(caps.format());
+    caps.width() = outWidth;
+    caps.height() = outHeight;
+
+    AkPacket oPacket = packet;
+    oPacket.setCaps(caps.toCaps());
+    oPacket.setBuffer(oBuffer);
     akSend(oPacket)
 }
 
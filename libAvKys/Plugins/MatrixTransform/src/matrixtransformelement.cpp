@@ -20,18 +20,19 @@
 #include <QVariant>
 #include <QVector>
 #include <QImage>
-#include <QMutex>
 #include <QQmlContext>
+#include <QtMath>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akvideofilterrunner.h>
 
 #include "matrixtransformelement.h"
 
 class MatrixTransformElementPrivate
 {
     public:
+        // Setter-side copy, the frame thread reads the published snapshot.
         QVector<qreal> m_kernel;
-        QMutex m_mutex;
 };
 
 MatrixTransformElement::MatrixTransformElement(): AkElement()
@@ -41,6 +42,7 @@ MatrixTransformElement::MatrixTransformElement(): AkElement()
         1, 0, 0,
         0, 1, 0
     };
+    this->publishParameters({{"kernel", this->kernel()}});
 }
 
 MatrixTransformElement::~MatrixTransformElement()
@@ -84,8 +86,8 @@ void MatrixTransformElement::setKernel(const QVariantList &kernel)
     if (this->d->m_kernel == k)
         return;
 
-    QMutexLocker(&this->d->m_mutex);
     this->d->m_kernel = k;
+    this->publishParameters({{"kernel", kernel}});
     emit this->kernelChanged(kernel);
 }
 
@@ -109,33 +111,84 @@ AkPacket MatrixTransformElement::iStream(const AkPacket &packet)
     src = src.convertToFormat(QImage::Format_ARGB32);
     QImage oFrame = QImage(src.size(), src.format());
 
-    this->d->m_mutex.lock();
-    QVector<qreal> kernel = this->d->m_kernel;
-    this->d->m_mutex.unlock();
+    QVector<qreal> kernel;
 
-    qreal det = kernel[0] * kernel[4] - kernel[1] * kernel[3];
-
-    QRect rect(0, 0, src.width(), src.height());
-    int cx = src.width() >> 1;
-    int cy = src.height() >> 1;
+    for (const QVariant &e: this->parametersSnapshot().value("kernel").toList())
+        kernel << e.toReal();
 
-    for (int y = 0; y < src.height(); y++) {
-        QRgb *oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+    qreal det = kernel[0] * kernel[4] - kernel[1] * kernel[3];
 
-        for (int x = 0; x < src.width(); x++) {
-            int dx = int(x - cx - kernel[2]);
-            int dy = int(y - cy - kernel[5]);
+    if (qFuzzyIsNull(det)) {
+        // Degenerate matrix, every output pixel is outside the source.
+        oFrame.fill(qRgba(0, 0, 0, 0));
+        AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
+        akSend(oPacket)
+    }
 
-            int xp = int(cx + (dx * kernel[4] - dy * kernel[3]) / det);
-            int yp = int(cy + (dy * kernel[0] - dx * kernel[1]) / det);
+    int width = src.width();
+    int height = src.height();
+    int cx = width >> 1;
+    int cy = height >> 1;
+
+    /* Fast path for identity and whole-pixel translations, the common
+     * digital pan case: rows shift with memcpy instead of remapping
+     * every pixel. */
+    if (kernel[0] == 1.0 && kernel[1] == 0.0
+        && kernel[3] == 0.0 && kernel[4] == 1.0
+        && kernel[2] == qreal(qRound(kernel[2]))
+        && kernel[5] == qreal(qRound(kernel[5]))) {
+        int tx = qRound(kernel[2]);
+        int ty = qRound(kernel[5]);
+
+        if (tx == 0 && ty == 0)
+            akSend(packet)
+
+        oFrame.fill(qRgba(0, 0, 0, 0));
+        int xStart = qMax(0, tx);
+        int xEnd = qMin(width, width + tx);
+
+        if (xStart < xEnd)
+            for (int y = qMax(0, ty); y < qMin(height, height + ty); y++)
+                memcpy(reinterpret_cast<QRgb *>(oFrame.scanLine(y)) + xStart,
+                       reinterpret_cast<const QRgb *>(src.constScanLine(y - ty)) + xStart - tx,
+                       size_t(xEnd - xStart) * sizeof(QRgb));
+
+        AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
+        akSend(oPacket)
+    }
 
-            if (rect.contains(xp, yp)) {
-                const QRgb *iLine = reinterpret_cast<const QRgb *>(src.constScanLine(yp));
-                oLine[x] = iLine[xp];
-            } else
-                oLine[x] = qRgba(0, 0, 0, 0);
+    /* General path: the inverse mapping is affine, so the source
+     * coordinate moves by a constant step per output column. Walk each
+     * row with 16.16 fixed-point increments instead of re-evaluating
+     * the matrix per pixel, rows in parallel on the worker pool. */
+    static const int fpShift = 16;
+    static const qint64 fpOne = 1 << fpShift;
+    qint64 xStepFp = qRound64(kernel[4] / det * fpOne);
+    qint64 yStepFp = qRound64(-kernel[1] / det * fpOne);
+
+    AkVideoFilterRunner::globalRunner()->run(height,
+                                             [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            auto oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+            qreal dx = -cx - kernel[2];
+            qreal dy = y - cy - kernel[5];
+            qint64 sxFp = qRound64((cx + (dx * kernel[4] - dy * kernel[3]) / det) * fpOne);
+            qint64 syFp = qRound64((cy + (dy * kernel[0] - dx * kernel[1]) / det) * fpOne);
+
+            for (int x = 0; x < width; x++) {
+                int xp = int(sxFp >> fpShift);
+                int yp = int(syFp >> fpShift);
+
+                if (xp >= 0 && xp < width && yp >= 0 && yp < height)
+                    oLine[x] = reinterpret_cast<const QRgb *>(src.constScanLine(yp))[xp];
+                else
+                    oLine[x] = qRgba(0, 0, 0, 0);
+
+                sxFp += xStepFp;
+                syFp += yStepFp;
+            }
         }
-    }
+    });
 
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
@@ -32,9 +32,11 @@ HEADERS = \
     src/plugin.h \
     src/mediawriterffmpeg.h \
     ../mediawriter.h \
+    src/asyncwriter.h \
     src/abstractstream.h \
     src/videostream.h \
-    src/audiostream.h
+    src/audiostream.h \
+    src/passthroughstream.h
 
 INCLUDEPATH += \
     ../../../../Lib/src \
@@ -77,6 +79,8 @@ CONFIG(config_ffmpeg_avutil_extraoptions): \
     DEFINES += HAVE_EXTRAOPTIONS
 CONFIG(config_ffmpeg_avutil_framealloc): \
     DEFINES += HAVE_FRAMEALLOC
+CONFIG(config_ffmpeg_avutil_hwcontext): \
+    DEFINES += HAVE_HWCONTEXT
 
 QT += qml concurrent
 
@@ -84,9 +88,11 @@ SOURCES = \
     src/plugin.cpp \
     src/mediawriterffmpeg.cpp \
     ../mediawriter.cpp \
+    src/asyncwriter.cpp \
     src/abstractstream.cpp \
     src/videostream.cpp \
-    src/audiostream.cpp
+    src/audiostream.cpp \
+    src/passthroughstream.cpp
 
 DESTDIR = $${OUT_PWD}/../../submodules/MultiSink
 
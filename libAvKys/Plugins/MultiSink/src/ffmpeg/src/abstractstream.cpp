@@ -65,6 +65,9 @@ class AbstractStreamPrivate
         QWaitCondition m_packetQueueNotEmpty;
         QFuture<void> m_convertLoopResult;
         bool m_runConvertLoop;
+        bool m_dropOldest;
+        int m_maxQueueDepth;
+        quint64 m_droppedPackets;
 
         // Frame queue and encoding loop.
         QFuture<void> m_encodeLoopResult;
@@ -92,8 +95,12 @@ AbstractStream::AbstractStream(const AVFormatContext *formatContext,
 
     this->d = new AbstractStreamPrivate(this);
     this->m_maxPacketQueueSize = 9;
+    this->m_passthrough = false;
     this->d->m_runConvertLoop = false;
     this->d->m_runEncodeLoop = false;
+    this->d->m_dropOldest = false;
+    this->d->m_maxQueueDepth = 0;
+    this->d->m_droppedPackets = 0;
     this->d->m_index = index;
     this->d->m_streamIndex = streamIndex;
     this->d->m_mediaType = AVMEDIA_TYPE_UNKNOWN;
@@ -198,18 +205,55 @@ void AbstractStream::packetEnqueue(const AkPacket &packet)
     this->d->m_convertMutex.lock();
     bool enqueue = true;
 
-    if (this->d->m_packetQueue.size() >= this->m_maxPacketQueueSize)
-        enqueue = this->d->m_packetQueueNotFull.wait(&this->d->m_convertMutex,
-                                                     THREAD_WAIT_LIMIT);
+    if (this->d->m_packetQueue.size() >= this->m_maxPacketQueueSize) {
+        if (this->d->m_dropOldest) {
+            // Keep the newest packets, a live pipeline must never stall on
+            // a hiccuping encoder.
+            while (this->d->m_packetQueue.size() >= this->m_maxPacketQueueSize) {
+                this->d->m_packetQueue.dequeue();
+                this->d->m_droppedPackets++;
+            }
+        } else {
+            enqueue = this->d->m_packetQueueNotFull.wait(&this->d->m_convertMutex,
+                                                         THREAD_WAIT_LIMIT);
+
+            if (!enqueue)
+                this->d->m_droppedPackets++;
+        }
+    }
 
     if (enqueue) {
         this->d->m_packetQueue << packet;
+
+        if (this->d->m_packetQueue.size() > this->d->m_maxQueueDepth)
+            this->d->m_maxQueueDepth = this->d->m_packetQueue.size();
+
         this->d->m_packetQueueNotEmpty.wakeAll();
     }
 
     this->d->m_convertMutex.unlock();
 }
 
+void AbstractStream::setDropOldest(bool dropOldest)
+{
+    this->d->m_convertMutex.lock();
+    this->d->m_dropOldest = dropOldest;
+    this->d->m_convertMutex.unlock();
+}
+
+QVariantMap AbstractStream::queueStats() const
+{
+    this->d->m_convertMutex.lock();
+    QVariantMap stats {
+        {"queueDepth"    , this->d->m_packetQueue.size()},
+        {"maxQueueDepth" , this->d->m_maxQueueDepth     },
+        {"droppedPackets", this->d->m_droppedPackets    },
+    };
+    this->d->m_convertMutex.unlock();
+
+    return stats;
+}
+
 void AbstractStream::convertPacket(const AkPacket &packet)
 {
     Q_UNUSED(packet);
@@ -246,8 +290,15 @@ void AbstractStream::rescaleTS(AVPacket *pkt, AVRational src, AVRational dst)
 void AbstractStream::deleteFrame(AVFrame **frame)
 {
     if (frame && *frame) {
-        av_freep(&((*frame)->data[0]));
-        (*frame)->data[0] = nullptr;
+        // Refcounted frames (e.g. hardware frames) own their planes through
+        // buf[], only plain av_image_alloc'ed planes are freed by hand.
+#ifdef HAVE_FRAMEALLOC
+        if (!(*frame)->buf[0])
+#endif
+        {
+            av_freep(&((*frame)->data[0]));
+            (*frame)->data[0] = nullptr;
+        }
     }
 
 #ifdef HAVE_FRAMEALLOC
@@ -301,10 +352,13 @@ bool AbstractStream::init()
     if (!this->d->m_codecContext)
         return false;
 
-    if (avcodec_open2(this->d->m_codecContext,
-                      this->d->m_codecContext->codec,
-                      &this->d->m_codecOptions) < 0)
-        return false;
+    /* Passthrough streams have no encoder attached, the already compressed
+     * packets are muxed as is, so only the packet queue is started. */
+    if (!this->m_passthrough) {
+        if (avcodec_open2(this->d->m_codecContext,
+                          this->d->m_codecContext->codec,
+                          &this->d->m_codecOptions) < 0)
+            return false;
 
 #ifdef HAVE_CODECPAR
         avcodec_parameters_from_context(this->d->m_stream->codecpar,
@@ -313,11 +367,12 @@ bool AbstractStream::init()
         avcodec_copy_context(this->d->m_stream->codec, this->d->m_codecContext);
 #endif
 
-    this->d->m_runEncodeLoop = true;
-    this->d->m_encodeLoopResult =
-            QtConcurrent::run(&this->d->m_threadPool,
-                              this->d,
-                              &AbstractStreamPrivate::encodeLoop);
+        this->d->m_runEncodeLoop = true;
+        this->d->m_encodeLoopResult =
+                QtConcurrent::run(&this->d->m_threadPool,
+                                  this->d,
+                                  &AbstractStreamPrivate::encodeLoop);
+    }
 
     this->d->m_runConvertLoop = true;
 
@@ -59,9 +59,12 @@ class AbstractStream: public QObject
         Q_INVOKABLE AVFormatContext *formatContext() const;
         Q_INVOKABLE AVCodecContext *codecContext() const;
         Q_INVOKABLE void packetEnqueue(const AkPacket &packet);
+        Q_INVOKABLE void setDropOldest(bool dropOldest);
+        Q_INVOKABLE QVariantMap queueStats() const;
 
     protected:
         int m_maxPacketQueueSize;
+        bool m_passthrough;
 
         virtual void convertPacket(const AkPacket &packet);
         virtual int encodeData(AVFrame *frame);
@@ -0,0 +1,341 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QFile>
+#include <QMutex>
+#include <QQueue>
+#include <QWaitCondition>
+#include <QtConcurrent>
+#include <QThreadPool>
+#include <QFuture>
+#include <QElapsedTimer>
+#include <akbuffer.h>
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#endif
+
+#include "asyncwriter.h"
+
+extern "C"
+{
+    #include <libavformat/avio.h>
+    #include <libavutil/mem.h>
+}
+
+// Chunk and alignment sizes are multiples of any common filesystem block
+// size, so full chunks stay O_DIRECT compatible.
+#define CHUNK_SIZE (4 * 1024 * 1024)
+#define CHUNK_ALIGN 4096
+#define AVIO_BUFFER_SIZE (512 * 1024)
+
+// Backlog limit. Beyond this the muxer blocks until the disk catches up.
+#define MAX_QUEUED_BYTES (64 * 1024 * 1024)
+
+struct WriteChunk
+{
+    qint64 offset;
+    AkBuffer buffer;
+    qint64 size;
+};
+
+class AsyncWriterPrivate
+{
+    public:
+        QFile m_file;
+        AVIOContext *m_context;
+        QThreadPool m_threadPool;
+        QFuture<void> m_writeResult;
+        QMutex m_mutex;
+        QWaitCondition m_dataAvailable;
+        QWaitCondition m_spaceAvailable;
+        QQueue<WriteChunk> m_queue;
+        AkBuffer m_cache;
+        qint64 m_cacheFill;
+        qint64 m_cacheOffset;
+        qint64 m_position;
+        qint64 m_fileSize;
+        qint64 m_queuedBytes;
+        bool m_direct;
+        bool m_quit;
+
+        // Stats, guarded by m_mutex.
+        qint64 m_writes;
+        qint64 m_writtenBytes;
+        qint64 m_writeTime;
+        qint64 m_maxWriteTime;
+        qint64 m_maxQueuedBytes;
+
+        AsyncWriterPrivate():
+            m_context(nullptr),
+            m_cacheFill(0),
+            m_cacheOffset(0),
+            m_position(0),
+            m_fileSize(0),
+            m_queuedBytes(0),
+            m_direct(false),
+            m_quit(false),
+            m_writes(0),
+            m_writtenBytes(0),
+            m_writeTime(0),
+            m_maxWriteTime(0),
+            m_maxQueuedBytes(0)
+        {
+        }
+
+        inline void flushCache();
+        void writeLoop();
+
+        static int write(void *opaque, uint8_t *buf, int size);
+        static int64_t seek(void *opaque, int64_t offset, int whence);
+};
+
+AsyncWriter::AsyncWriter(const QString &location, bool direct)
+{
+    this->d = new AsyncWriterPrivate;
+
+#ifdef Q_OS_LINUX
+    if (direct) {
+        int fd = ::open(location.toStdString().c_str(),
+                        O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT | O_CLOEXEC,
+                        0644);
+
+        if (fd >= 0) {
+            this->d->m_file.open(fd,
+                                 QIODevice::WriteOnly | QIODevice::Unbuffered,
+                                 QFileDevice::AutoCloseHandle);
+            this->d->m_direct = this->d->m_file.isOpen();
+        }
+    }
+#else
+    Q_UNUSED(direct)
+#endif
+
+    if (!this->d->m_file.isOpen()) {
+        this->d->m_file.setFileName(location);
+        this->d->m_file.open(QIODevice::WriteOnly
+                             | QIODevice::Truncate
+                             | QIODevice::Unbuffered);
+    }
+
+    if (!this->d->m_file.isOpen())
+        return;
+
+    auto avioBuffer =
+            reinterpret_cast<uint8_t *>(av_malloc(AVIO_BUFFER_SIZE));
+    this->d->m_context = avio_alloc_context(avioBuffer,
+                                            AVIO_BUFFER_SIZE,
+                                            1,
+                                            this->d,
+                                            nullptr,
+                                            AsyncWriterPrivate::write,
+                                            AsyncWriterPrivate::seek);
+
+    if (!this->d->m_context) {
+        av_free(avioBuffer);
+        this->d->m_file.close();
+
+        return;
+    }
+
+    this->d->m_cache = AkBuffer(CHUNK_SIZE, CHUNK_ALIGN);
+    this->d->m_threadPool.setMaxThreadCount(1);
+    this->d->m_writeResult =
+            QtConcurrent::run(&this->d->m_threadPool,
+                              this->d,
+                              &AsyncWriterPrivate::writeLoop);
+}
+
+AsyncWriter::~AsyncWriter()
+{
+    if (this->d->m_file.isOpen()) {
+        this->d->m_mutex.lock();
+        this->d->flushCache();
+        this->d->m_quit = true;
+        this->d->m_dataAvailable.wakeAll();
+        this->d->m_mutex.unlock();
+        this->d->m_writeResult.waitForFinished();
+        this->d->m_file.close();
+    }
+
+    if (this->d->m_context) {
+        av_freep(&this->d->m_context->buffer);
+        av_free(this->d->m_context);
+    }
+
+    delete this->d;
+}
+
+bool AsyncWriter::isOpen() const
+{
+    return this->d->m_context != nullptr;
+}
+
+AVIOContext *AsyncWriter::stream() const
+{
+    return this->d->m_context;
+}
+
+QVariantMap AsyncWriter::stats() const
+{
+    QMutexLocker locker(&this->d->m_mutex);
+
+    QVariantMap stats = {
+        {"writes"        , this->d->m_writes        },
+        {"writtenBytes"  , this->d->m_writtenBytes  },
+        {"queuedBytes"   , this->d->m_queuedBytes   },
+        {"maxQueuedBytes", this->d->m_maxQueuedBytes},
+        {"maxWriteTime"  , this->d->m_maxWriteTime  },
+        {"avgWriteTime"  , this->d->m_writes > 0?
+                               qreal(this->d->m_writeTime)
+                               / this->d->m_writes: 0.0},
+    };
+
+    return stats;
+}
+
+void AsyncWriterPrivate::flushCache()
+{
+    if (this->m_cacheFill < 1)
+        return;
+
+    this->m_queue.enqueue({this->m_cacheOffset,
+                           this->m_cache,
+                           this->m_cacheFill});
+    this->m_queuedBytes += this->m_cacheFill;
+    this->m_maxQueuedBytes = qMax(this->m_maxQueuedBytes,
+                                  this->m_queuedBytes);
+    this->m_cache = AkBuffer(CHUNK_SIZE, CHUNK_ALIGN);
+    this->m_cacheOffset += this->m_cacheFill;
+    this->m_cacheFill = 0;
+    this->m_dataAvailable.wakeAll();
+}
+
+void AsyncWriterPrivate::writeLoop()
+{
+    for (;;) {
+        this->m_mutex.lock();
+
+        while (this->m_queue.isEmpty() && !this->m_quit)
+            this->m_dataAvailable.wait(&this->m_mutex);
+
+        if (this->m_queue.isEmpty()) {
+            this->m_mutex.unlock();
+
+            break;
+        }
+
+        auto chunk = this->m_queue.dequeue();
+        this->m_mutex.unlock();
+
+#ifdef Q_OS_LINUX
+        // Partial chunks and rewrites break the O_DIRECT alignment
+        // contract, switch the descriptor back to buffered I/O for the
+        // rest of the file.
+        if (this->m_direct
+            && (chunk.size % CHUNK_ALIGN != 0
+                || chunk.offset % CHUNK_ALIGN != 0)) {
+            int flags = fcntl(this->m_file.handle(), F_GETFL);
+            fcntl(this->m_file.handle(), F_SETFL, flags & ~O_DIRECT);
+            this->m_direct = false;
+        }
+#endif
+
+        QElapsedTimer timer;
+        timer.start();
+        this->m_file.seek(chunk.offset);
+        this->m_file.write(reinterpret_cast<const char *>(chunk.buffer.constData()),
+                           chunk.size);
+        auto elapsed = timer.elapsed();
+
+        this->m_mutex.lock();
+        this->m_queuedBytes -= chunk.size;
+        this->m_writes++;
+        this->m_writtenBytes += chunk.size;
+        this->m_writeTime += elapsed;
+        this->m_maxWriteTime = qMax(this->m_maxWriteTime, elapsed);
+        this->m_spaceAvailable.wakeAll();
+        this->m_mutex.unlock();
+    }
+}
+
+int AsyncWriterPrivate::write(void *opaque, uint8_t *buf, int size)
+{
+    auto self = reinterpret_cast<AsyncWriterPrivate *>(opaque);
+    QMutexLocker locker(&self->m_mutex);
+    qint64 remaining = size;
+
+    while (remaining > 0) {
+        auto chunk = qMin(remaining, CHUNK_SIZE - self->m_cacheFill);
+        memcpy(self->m_cache.writableData() + self->m_cacheFill,
+               buf,
+               size_t(chunk));
+        self->m_cacheFill += chunk;
+        buf += chunk;
+        remaining -= chunk;
+
+        if (self->m_cacheFill >= CHUNK_SIZE) {
+            self->flushCache();
+
+            while (self->m_queuedBytes >= MAX_QUEUED_BYTES && !self->m_quit)
+                self->m_spaceAvailable.wait(&self->m_mutex);
+        }
+    }
+
+    self->m_position += size;
+    self->m_fileSize = qMax(self->m_fileSize, self->m_position);
+
+    return size;
+}
+
+int64_t AsyncWriterPrivate::seek(void *opaque, int64_t offset, int whence)
+{
+    auto self = reinterpret_cast<AsyncWriterPrivate *>(opaque);
+    QMutexLocker locker(&self->m_mutex);
+
+    if (whence & AVSEEK_SIZE)
+        return self->m_fileSize;
+
+    qint64 position = 0;
+
+    switch (whence & ~AVSEEK_FORCE) {
+    case SEEK_SET:
+        position = offset;
+        break;
+    case SEEK_CUR:
+        position = self->m_position + offset;
+        break;
+    case SEEK_END:
+        position = self->m_fileSize + offset;
+        break;
+    default:
+        return -1;
+    }
+
+    if (position < 0)
+        return -1;
+
+    if (position != self->m_position) {
+        self->flushCache();
+        self->m_position = position;
+        self->m_cacheOffset = position;
+    }
+
+    return position;
+}
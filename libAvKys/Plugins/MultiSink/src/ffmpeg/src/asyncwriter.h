@@ -0,0 +1,51 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef ASYNCWRITER_H
+#define ASYNCWRITER_H
+
+#include <QString>
+#include <QVariantMap>
+
+struct AVIOContext;
+class AsyncWriterPrivate;
+
+/* Buffered output stage between the muxer and the filesystem. The muxer
+ * writes into large aligned memory chunks through a custom AVIOContext,
+ * and a dedicated I/O thread flushes the chunks to disk, so an I/O burst
+ * on a contended drive stalls the queue instead of the encode path. The
+ * queue is bounded; when the disk falls persistently behind, the muxer
+ * blocks instead of growing memory without limit. */
+class AsyncWriter
+{
+    public:
+        AsyncWriter(const QString &location, bool direct=false);
+        ~AsyncWriter();
+
+        bool isOpen() const;
+        // AVIOContext feeding this writer, owned by the writer.
+        AVIOContext *stream() const;
+        // Write latency and backlog counters, see the keys in stats().
+        QVariantMap stats() const;
+
+    private:
+        AsyncWriterPrivate *d;
+};
+
+#endif // ASYNCWRITER_H
@@ -17,11 +17,11 @@
  * Web-Site: http://webcamoid.github.io/
  */
 
-#include <QDebug>
 #include <QSharedPointer>
 #include <QMutex>
 #include <QWaitCondition>
 #include <akelement.h>
+#include <aklog.h>
 #include <akcaps.h>
 #include <akaudiocaps.h>
 #include <akpacket.h>
@@ -30,11 +30,32 @@
 extern "C"
 {
     #include <libavutil/channel_layout.h>
+    #include <libavutil/audio_fifo.h>
 }
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include "audiostream.h"
 #include "mediawriterffmpeg.h"
 
+/* Frames whose peak stays below this level for longer than the hold are
+ * encoded as silence: the first one primes the encoder with zeroed samples
+ * and its compressed output is replayed for the rest of the stretch, so a
+ * quiet room costs one reference count instead of an encode. -40 dBFS sits
+ * above the noise floor of a quiet room at normal gain, far below any
+ * signal worth keeping; the hold keeps speech pauses real so ungating is
+ * instant and gapless. */
+#define SILENCE_PEAK_S16 328
+#define SILENCE_PEAK_FLT 0.01f
+#define SILENCE_HOLD 1.0
+
+/* Encoder errors repeat at frame rate when the stream goes bad, logging
+ * them synchronously would change the timing being diagnosed. */
+static const int audioStreamLog =
+        AkLog::registerCategory("MultiSink.audio", AkLog::LevelWarning);
+
 typedef QMap<AkAudioCaps::ChannelLayout, uint64_t> AkFFChannelLayoutsMap;
 
 inline AkFFChannelLayoutsMap initAkFFChannelFormatsMap()
@@ -81,18 +102,112 @@ class AudioStreamPrivate
 {
     public:
         AkElementPtr m_convert;
-        AVFrame *m_frame;
+        AVAudioFifo *m_frameFifo;
         QMutex m_frameMutex;
         int64_t m_pts;
         QWaitCondition m_frameReady;
+        AVPacket *m_silencePacket;
+        int m_silenceSamples;
+        qreal m_silentTime;
 
         AudioStreamPrivate():
-            m_frame(nullptr),
-            m_pts(0)
+            m_frameFifo(nullptr),
+            m_pts(0),
+            m_silencePacket(nullptr),
+            m_silenceSamples(0),
+            m_silentTime(0.0)
         {
         }
+
+        inline bool frameIsQuiet(const AVFrame *frame, int channels) const;
+        inline void clearSilencePacket();
 };
 
+static inline int peakS16(const int16_t *samples, int nSamples)
+{
+    int peak = 0;
+    int i = 0;
+
+#if defined(__SSE2__)
+    // Saturating negation keeps -32768 from wrapping, 8 samples per step.
+    __m128i zero = _mm_setzero_si128();
+    __m128i vPeak = zero;
+
+    for (; i < nSamples - 7; i += 8) {
+        auto v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(samples + i));
+        vPeak = _mm_max_epi16(vPeak,
+                              _mm_max_epi16(v, _mm_subs_epi16(zero, v)));
+    }
+
+    vPeak = _mm_max_epi16(vPeak, _mm_srli_si128(vPeak, 8));
+    vPeak = _mm_max_epi16(vPeak, _mm_srli_si128(vPeak, 4));
+    vPeak = _mm_max_epi16(vPeak, _mm_srli_si128(vPeak, 2));
+    peak = int16_t(_mm_cvtsi128_si32(vPeak));
+#endif
+
+    for (; i < nSamples; i++)
+        peak = qMax(peak, qAbs(int(samples[i])));
+
+    return peak;
+}
+
+static inline float peakFlt(const float *samples, int nSamples)
+{
+    float peak = 0.0f;
+
+    for (int i = 0; i < nSamples; i++)
+        peak = qMax(peak, qAbs(samples[i]));
+
+    return peak;
+}
+
+bool AudioStreamPrivate::frameIsQuiet(const AVFrame *frame,
+                                      int channels) const
+{
+    auto format = AVSampleFormat(frame->format);
+    bool planar = av_sample_fmt_is_planar(format);
+    int planes = planar? channels: 1;
+    int samplesPerPlane = planar?
+                              frame->nb_samples:
+                              frame->nb_samples * channels;
+
+    switch (av_get_packed_sample_fmt(format)) {
+    case AV_SAMPLE_FMT_S16:
+        for (int plane = 0; plane < planes; plane++)
+            if (peakS16(reinterpret_cast<const int16_t *>(frame->data[plane]),
+                        samplesPerPlane) >= SILENCE_PEAK_S16)
+                return false;
+
+        return true;
+    case AV_SAMPLE_FMT_FLT:
+        for (int plane = 0; plane < planes; plane++)
+            if (peakFlt(reinterpret_cast<const float *>(frame->data[plane]),
+                        samplesPerPlane) >= SILENCE_PEAK_FLT)
+                return false;
+
+        return true;
+    default:
+        // Formats without a scanner are never gated.
+        return false;
+    }
+}
+
+void AudioStreamPrivate::clearSilencePacket()
+{
+    if (!this->m_silencePacket)
+        return;
+
+#ifdef HAVE_PACKETREF
+    av_packet_free(&this->m_silencePacket);
+#else
+    av_free_packet(this->m_silencePacket);
+    delete this->m_silencePacket;
+    this->m_silencePacket = nullptr;
+#endif
+
+    this->m_silenceSamples = 0;
+}
+
 AudioStream::AudioStream(const AVFormatContext *formatContext,
                          uint index,
                          int streamIndex,
@@ -239,67 +354,33 @@ void AudioStream::convertPacket(const AkPacket &packet)
 
     this->d->m_frameMutex.lock();
 
-    // Create new buffer.
-#ifdef HAVE_FRAMEALLOC
-    auto oFrame = av_frame_alloc();
-#else
-    auto oFrame = avcodec_alloc_frame();
-#endif
-
-    if (av_samples_alloc(oFrame->data,
-                         oFrame->linesize,
-                         channels,
-                         iFrame.nb_samples
-                         + (this->d->m_frame? this->d->m_frame->nb_samples: 0),
-                         AVSampleFormat(iFrame.format),
-                         1) < 0) {
-        this->deleteFrame(&oFrame);
+    /* The fifo grows on demand, so once it reached the high water mark of the
+     * stream no more allocations happen and queuing a packet is just one
+     * sample copy.
+     */
+    if (!this->d->m_frameFifo)
+        this->d->m_frameFifo =
+                av_audio_fifo_alloc(AVSampleFormat(iFrame.format),
+                                    channels,
+                                    qMax(codecContext->frame_size,
+                                         iFrame.nb_samples));
+
+    if (!this->d->m_frameFifo) {
         this->d->m_frameMutex.unlock();
 
         return;
     }
 
-    // Copy old samples to new buffer.
-    if (this->d->m_frame)
-        if (av_samples_copy(oFrame->data,
-                            this->d->m_frame->data,
-                            0,
-                            0,
-                            this->d->m_frame->nb_samples,
-                            channels,
-                            AVSampleFormat(iFrame.format)) < 0) {
-            this->deleteFrame(&oFrame);
-            this->d->m_frameMutex.unlock();
-
-            return;
-        }
-
-    // Copy converted samples to the new buffer.
-    if (av_samples_copy(oFrame->data,
-                        iFrame.data,
-                        this->d->m_frame? this->d->m_frame->nb_samples: 0,
-                        0,
-                        iFrame.nb_samples,
-                        channels,
-                        AVSampleFormat(iFrame.format)) < 0) {
-        this->deleteFrame(&oFrame);
+    if (av_audio_fifo_write(this->d->m_frameFifo,
+                            reinterpret_cast<void **>(iFrame.data),
+                            iFrame.nb_samples) < iFrame.nb_samples) {
         this->d->m_frameMutex.unlock();
 
         return;
     }
 
-    oFrame->format = codecContext->sample_fmt;
-    oFrame->channel_layout = codecContext->channel_layout;
-    oFrame->sample_rate = codecContext->sample_rate;
-    oFrame->nb_samples = (this->d->m_frame? this->d->m_frame->nb_samples: 0)
-                         + iFrame.nb_samples;
-    oFrame->pts = this->d->m_frame? this->d->m_frame->pts: 0;
-
-    this->deleteFrame(&this->d->m_frame);
-    this->d->m_frame = oFrame;
-
     if (codecContext->codec->capabilities & CODEC_CAP_VARIABLE_FRAME_SIZE
-        || oFrame->nb_samples >= codecContext->frame_size) {
+        || av_audio_fifo_size(this->d->m_frameFifo) >= codecContext->frame_size) {
         this->d->m_frameReady.wakeAll();
     }
 
@@ -322,15 +403,69 @@ int AudioStream::encodeData(AVFrame *frame)
     }
 
     auto stream = this->stream();
+    bool primeSilence = false;
+
+    if (frame) {
+        int channels =
+                av_get_channel_layout_nb_channels(frame->channel_layout);
+
+        if (this->d->frameIsQuiet(frame, channels)) {
+            this->d->m_silentTime += qreal(frame->nb_samples)
+                                     / codecContext->sample_rate;
+
+            if (this->d->m_silentTime >= SILENCE_HOLD) {
+                if (this->d->m_silencePacket
+                    && this->d->m_silenceSamples == frame->nb_samples) {
+                    /* Replay the compressed silence frame under the
+                     * current clock, the encoder never runs. */
+                    AVPacket pkt;
+                    memset(&pkt, 0, sizeof(AVPacket));
+                    av_init_packet(&pkt);
+
+#ifdef HAVE_PACKETREF
+                    if (av_packet_ref(&pkt, this->d->m_silencePacket) < 0)
+                        return AVERROR(ENOMEM);
+#else
+                    if (av_copy_packet(&pkt, this->d->m_silencePacket) < 0)
+                        return AVERROR(ENOMEM);
+#endif
+
+                    pkt.pts = frame->pts;
+                    pkt.dts = frame->pts;
+                    pkt.duration = frame->nb_samples;
+                    pkt.stream_index = this->streamIndex();
+                    this->rescaleTS(&pkt,
+                                    codecContext->time_base,
+                                    stream->time_base);
+                    emit this->packetReady(&pkt);
+
+                    return 0;
+                }
+
+                /* First gated frame of the stretch: encode true zeros once
+                 * and keep the compressed result for replaying. */
+                av_samples_set_silence(frame->data,
+                                       0,
+                                       frame->nb_samples,
+                                       channels,
+                                       AVSampleFormat(frame->format));
+                primeSilence = true;
+            }
+        } else {
+            // Any signal ungates instantly, this frame encodes for real.
+            this->d->m_silentTime = 0.0;
+        }
+    }
 
     // Compress audio packet.
 #ifdef HAVE_SENDRECV
     int result = avcodec_send_frame(codecContext, frame);
 
     if (result < 0) {
-        char error[1024];
-        av_strerror(result, error, 1024);
-        qDebug() << "Error: " << error;
+        AkLog::write(audioStreamLog,
+                     AkLog::LevelError,
+                     "audio encoder returned error %lld",
+                     result);
 
         return result;
     }
@@ -345,6 +480,19 @@ int AudioStream::encodeData(AVFrame *frame)
         if (result < 0)
             break;
 
+        if (primeSilence && frame && !this->d->m_silencePacket) {
+#ifdef HAVE_PACKETREF
+            this->d->m_silencePacket = av_packet_alloc();
+            av_packet_ref(this->d->m_silencePacket, &pkt);
+#else
+            this->d->m_silencePacket = new AVPacket;
+            memset(this->d->m_silencePacket, 0, sizeof(AVPacket));
+            av_init_packet(this->d->m_silencePacket);
+            av_copy_packet(this->d->m_silencePacket, &pkt);
+#endif
+            this->d->m_silenceSamples = frame->nb_samples;
+        }
+
         pkt.stream_index = this->streamIndex();
         this->rescaleTS(&pkt, codecContext->time_base, stream->time_base);
 
@@ -366,9 +514,10 @@ int AudioStream::encodeData(AVFrame *frame)
                                        &gotPacket);
 
     if (result < 0) {
-        char error[1024];
-        av_strerror(result, error, 1024);
-        qDebug() << "Error: " << error;
+        AkLog::write(audioStreamLog,
+                     AkLog::LevelError,
+                     "audio encoder returned error %lld",
+                     result);
 
         return result;
     }
@@ -376,6 +525,14 @@ int AudioStream::encodeData(AVFrame *frame)
     if (!gotPacket)
         return result;
 
+    if (primeSilence && frame && !this->d->m_silencePacket) {
+        this->d->m_silencePacket = new AVPacket;
+        memset(this->d->m_silencePacket, 0, sizeof(AVPacket));
+        av_init_packet(this->d->m_silencePacket);
+        av_copy_packet(this->d->m_silencePacket, &pkt);
+        this->d->m_silenceSamples = frame->nb_samples;
+    }
+
     pkt.stream_index = this->streamIndex();
     this->rescaleTS(&pkt, codecContext->time_base, stream->time_base);
 
@@ -388,114 +545,67 @@ int AudioStream::encodeData(AVFrame *frame)
 
 AVFrame *AudioStream::dequeueFrame()
 {
-    /* FIXME: Allocating and copying frames when enqueuing/dequeuing is pretty
-     * slow, it can improved creating a fixed size frame, and then playing with
-     * read write pointers.
-     */
-
     auto codecContext = this->codecContext();
+    bool variableFrameSize =
+            codecContext->codec->capabilities & CODEC_CAP_VARIABLE_FRAME_SIZE;
+
     this->d->m_frameMutex.lock();
+    int available = this->d->m_frameFifo?
+                        av_audio_fifo_size(this->d->m_frameFifo): 0;
 
-    if (!this->d->m_frame
-        || (!(codecContext->codec->capabilities & CODEC_CAP_VARIABLE_FRAME_SIZE)
-            && this->d->m_frame->nb_samples < codecContext->frame_size)) {
+    if (available < 1
+        || (!variableFrameSize && available < codecContext->frame_size)) {
         if (!this->d->m_frameReady.wait(&this->d->m_frameMutex, THREAD_WAIT_LIMIT)) {
             this->d->m_frameMutex.unlock();
 
             return nullptr;
         }
-    }
 
-    AVFrame *oFrame = nullptr;
-
-    if (codecContext->codec->capabilities & CODEC_CAP_VARIABLE_FRAME_SIZE
-        || this->d->m_frame->nb_samples == codecContext->frame_size) {
-        oFrame = this->d->m_frame;
-        this->d->m_frame = nullptr;
-    } else {
-        // Create output buffer.
-#ifdef HAVE_FRAMEALLOC
-        auto oFrame = av_frame_alloc();
-#else
-        auto oFrame = avcodec_alloc_frame();
-#endif
-
-        oFrame->format = codecContext->sample_fmt;
-        oFrame->channel_layout = codecContext->channel_layout;
-        oFrame->sample_rate = codecContext->sample_rate;
-        oFrame->nb_samples = codecContext->frame_size;
-        oFrame->pts = this->d->m_frame->pts;
-        int channels = av_get_channel_layout_nb_channels(oFrame->channel_layout);
-
-        if (av_samples_alloc(oFrame->data,
-                             oFrame->linesize,
-                             channels,
-                             codecContext->frame_size,
-                             AVSampleFormat(oFrame->format),
-                             1) < 0) {
-            this->deleteFrame(&oFrame);
-            this->d->m_frameMutex.unlock();
+        available = this->d->m_frameFifo?
+                        av_audio_fifo_size(this->d->m_frameFifo): 0;
+    }
 
-            return nullptr;
-        }
+    int samples = variableFrameSize? available: codecContext->frame_size;
 
-        // Copy samples to the output buffer.
-        if (av_samples_copy(oFrame->data,
-                            this->d->m_frame->data,
-                            0,
-                            0,
-                            codecContext->frame_size,
-                            channels,
-                            AVSampleFormat(oFrame->format)) < 0) {
-            this->deleteFrame(&oFrame);
-            this->d->m_frameMutex.unlock();
+    if (samples < 1 || available < samples) {
+        this->d->m_frameMutex.unlock();
 
-            return nullptr;
-        }
+        return nullptr;
+    }
 
-        // Create new buffer.
+    // Create output buffer.
 #ifdef HAVE_FRAMEALLOC
-        auto frame = av_frame_alloc();
+    auto oFrame = av_frame_alloc();
 #else
-        auto frame = avcodec_alloc_frame();
+    auto oFrame = avcodec_alloc_frame();
 #endif
 
-        frame->format = codecContext->sample_fmt;
-        frame->channel_layout = codecContext->channel_layout;
-        frame->sample_rate = codecContext->sample_rate;
-        frame->nb_samples = this->d->m_frame->nb_samples - codecContext->frame_size;
-        frame->pts = this->d->m_frame->pts + codecContext->frame_size;
-
-        if (av_samples_alloc(frame->data,
-                             frame->linesize,
-                             channels,
-                             frame->nb_samples,
-                             AVSampleFormat(frame->format),
-                             1) < 0) {
-            this->deleteFrame(&oFrame);
-            this->deleteFrame(&frame);
-            this->d->m_frameMutex.unlock();
+    oFrame->format = codecContext->sample_fmt;
+    oFrame->channel_layout = codecContext->channel_layout;
+    oFrame->sample_rate = codecContext->sample_rate;
+    oFrame->nb_samples = samples;
+    int channels = av_get_channel_layout_nb_channels(oFrame->channel_layout);
 
-            return nullptr;
-        }
+    if (av_samples_alloc(oFrame->data,
+                         oFrame->linesize,
+                         channels,
+                         samples,
+                         AVSampleFormat(oFrame->format),
+                         1) < 0) {
+        this->deleteFrame(&oFrame);
+        this->d->m_frameMutex.unlock();
 
-        // Copy samples to the output buffer.
-        if (av_samples_copy(frame->data,
-                            this->d->m_frame->data,
-                            0,
-                            codecContext->frame_size,
-                            frame->nb_samples,
-                            channels,
-                            AVSampleFormat(frame->format)) < 0) {
-            this->deleteFrame(&oFrame);
-            this->deleteFrame(&frame);
-            this->d->m_frameMutex.unlock();
+        return nullptr;
+    }
 
-            return nullptr;
-        }
+    // Read one encoder frame out of the fifo.
+    if (av_audio_fifo_read(this->d->m_frameFifo,
+                           reinterpret_cast<void **>(oFrame->data),
+                           samples) < samples) {
+        this->deleteFrame(&oFrame);
+        this->d->m_frameMutex.unlock();
 
-        this->deleteFrame(&this->d->m_frame);
-        this->d->m_frame = frame;
+        return nullptr;
     }
 
     this->d->m_frameMutex.unlock();
@@ -518,7 +628,16 @@ void AudioStream::uninit()
 {
     AbstractStream::uninit();
     this->d->m_convert->setState(AkElement::ElementStateNull);
-    this->deleteFrame(&this->d->m_frame);
+    this->d->clearSilencePacket();
+    this->d->m_silentTime = 0.0;
+    this->d->m_frameMutex.lock();
+
+    if (this->d->m_frameFifo) {
+        av_audio_fifo_free(this->d->m_frameFifo);
+        this->d->m_frameFifo = nullptr;
+    }
+
+    this->d->m_frameMutex.unlock();
 }
 
 #include "moc_audiostream.cpp"
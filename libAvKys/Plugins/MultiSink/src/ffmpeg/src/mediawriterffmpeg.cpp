@@ -24,8 +24,11 @@
 #include <QSize>
 #include <QVector>
 #include <QLibrary>
+#include <QtConcurrent>
 #include <QThreadPool>
+#include <QFuture>
 #include <QMutex>
+#include <QElapsedTimer>
 #include <QtMath>
 #include <akutils.h>
 #include <akaudiocaps.h>
@@ -34,8 +37,10 @@
 #include <akpacket.h>
 
 #include "mediawriterffmpeg.h"
+#include "asyncwriter.h"
 #include "audiostream.h"
 #include "videostream.h"
+#include "passthroughstream.h"
 
 extern "C"
 {
@@ -49,6 +54,9 @@ extern "C"
     #include <libavutil/mathematics.h>
 }
 
+// Consecutive write failures on a network sink before reconnecting.
+#define MAX_WRITE_ERRORS 10
+
 typedef QMap<AVMediaType, QString> AvMediaTypeStrMap;
 typedef QVector<AkVideoCaps> VectorVideoCaps;
 typedef QMap<AVOptionType, QString> OptionTypeStrMap;
@@ -65,10 +73,20 @@ class MediaWriterFFmpegGlobal
         QVector<QSize> m_gxfSupportedSize;
         QVector<int> m_swfSupportedSampleRates;
         bool m_hasCudaSupport;
+        bool m_hasVaapiSupport;
+        bool m_hasQsvSupport;
         OptionTypeStrMap m_codecFFOptionTypeToStr;
         SupportedCodecsType m_supportedCodecs;
         QMap<QString, QVariantMap> m_codecDefaults;
 
+        /* AVOption tables parsed on first query, keyed by the owning
+         * AVClass. The classes are static data inside libavformat and
+         * libavcodec, so the parsed lists stay valid for the process and
+         * are shared by every writer instance; entries are never modified
+         * once inserted. */
+        QMutex m_parsedOptionsMutex;
+        QMap<const AVClass *, QVariantList> m_parsedOptions;
+
         MediaWriterFFmpegGlobal()
         {
             av_register_all();
@@ -87,6 +105,8 @@ class MediaWriterFFmpegGlobal
             this->m_gxfSupportedSize = this->initGXFSupportedSize();
             this->m_swfSupportedSampleRates = this->initSWFSupportedSampleRates();
             this->m_hasCudaSupport = this->initHasCudaSupport();
+            this->m_hasVaapiSupport = this->initHasVaapiSupport();
+            this->m_hasQsvSupport = this->initHasQsvSupport();
             this->m_codecFFOptionTypeToStr = this->initFFOptionTypeStrMap();
             this->m_supportedCodecs = this->initSupportedCodecs();
             this->m_codecDefaults = this->initCodecDefaults();
@@ -237,6 +257,34 @@ class MediaWriterFFmpegGlobal
             return false;
         }
 
+        inline bool initHasVaapiSupport()
+        {
+            QLibrary lib("va");
+
+            if (lib.load()) {
+                lib.unload();
+
+                return true;
+            }
+
+            return false;
+        }
+
+        inline bool initHasQsvSupport()
+        {
+            for (auto &libName: QStringList {"mfx", "mfxhw64"}) {
+                QLibrary lib(libName);
+
+                if (lib.load()) {
+                    lib.unload();
+
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
         inline OptionTypeStrMap initFFOptionTypeStrMap()
         {
             const OptionTypeStrMap optionTypeStrMap = {
@@ -283,6 +331,12 @@ class MediaWriterFFmpegGlobal
                     if ((codecName.contains("nvenc") && !this->m_hasCudaSupport))
                         continue;
 
+                    if (codecName.contains("vaapi") && !this->m_hasVaapiSupport)
+                        continue;
+
+                    if (codecName.contains("qsv") && !this->m_hasQsvSupport)
+                        continue;
+
                     bool codecSupported = avformat_query_codec(outputFormat,
                                                                codec->id,
                                                                CODEC_COMPLIANCE) > 0;
@@ -572,6 +626,16 @@ class MediaWriterFFmpegPrivate
         QMap<QString, QVariantMap> m_codecOptions;
         QList<QVariantMap> m_streamConfigs;
         AVFormatContext *m_formatContext;
+        AVFormatContext *m_activeContext;
+        AVFormatContext *m_nextContext;
+        QFuture<void> m_nextContextResult;
+        QString m_nextLocation;
+        QElapsedTimer m_segmentTimer;
+        qint64 m_segmentBytes;
+        int m_segmentIndex;
+        bool m_segmented;
+        bool m_networked;
+        int m_writeErrors;
         QThreadPool m_threadPool;
         qint64 m_maxPacketQueueSize;
         bool m_isRecording;
@@ -582,9 +646,20 @@ class MediaWriterFFmpegPrivate
         QMutex m_writeMutex;
         QMap<int, AbstractStreamPtr> m_streamsMap;
 
+        // Async writers indexed by the context they feed, see openOutput().
+        QMutex m_asyncWritersMutex;
+        QMap<AVFormatContext *, AsyncWriter *> m_asyncWriters;
+
         MediaWriterFFmpegPrivate(MediaWriterFFmpeg *self):
             self(self),
             m_formatContext(nullptr),
+            m_activeContext(nullptr),
+            m_nextContext(nullptr),
+            m_segmentBytes(0),
+            m_segmentIndex(0),
+            m_segmented(false),
+            m_networked(false),
+            m_writeErrors(0),
             m_maxPacketQueueSize(15 * 1024 * 1024),
             m_isRecording(false)
         {
@@ -594,6 +669,18 @@ class MediaWriterFFmpegPrivate
         QVariantList parseOptions(const AVClass *avClass) const;
         AVDictionary *formatContextOptions(AVFormatContext *formatContext,
                                            const QVariantMap &options);
+        QString segmentLocation(int index) const;
+        AVMediaType streamMediaType(const AVStream *stream) const;
+        bool openOutput(AVFormatContext *context, const QString &location);
+        void closeOutput(AVFormatContext *context);
+        void applyCrashSafeOptions(AVFormatContext *context,
+                                   AVDictionary **options);
+        AVFormatContext *openSegmentContext(const QString &location);
+        void openNextSegment();
+        void prepareNextSegment();
+        bool segmentBoundary(const AVPacket *packet) const;
+        void rotateSegment();
+        void swapReconnected();
 };
 
 MediaWriterFFmpeg::MediaWriterFFmpeg(QObject *parent):
@@ -654,6 +741,28 @@ qint64 MediaWriterFFmpeg::maxPacketQueueSize() const
     return this->d->m_maxPacketQueueSize;
 }
 
+QVariantMap MediaWriterFFmpeg::queueStats() const
+{
+    QVariantMap stats;
+
+    for (auto it = this->d->m_streamsMap.begin();
+         it != this->d->m_streamsMap.end();
+         it++)
+        stats[QString::number(it.key())] = it.value()->queueStats();
+
+    return stats;
+}
+
+QVariantMap MediaWriterFFmpeg::writeStats() const
+{
+    this->d->m_asyncWritersMutex.lock();
+    auto writer = this->d->m_asyncWriters.value(this->d->m_activeContext);
+    auto stats = writer? writer->stats(): QVariantMap();
+    this->d->m_asyncWritersMutex.unlock();
+
+    return stats;
+}
+
 QStringList MediaWriterFFmpeg::supportedFormats()
 {
     QStringList formats;
@@ -839,13 +948,22 @@ QVariantMap MediaWriterFFmpeg::addStream(int streamIndex,
     outputParams["index"] = streamIndex;
     auto codec = codecParams.value("codec").toString();
 
-    if (codec.isEmpty())
-        return QVariantMap();
+    if (streamCaps.mimeType() == "video/unknown") {
+        /* Compressed frames straight from the capture device, the stream
+         * codec is given by the fourcc and the packets are muxed as is. */
+        codec = PassthroughStream::codecName(streamCaps);
 
-    auto supportedCodecs = this->supportedCodecs(outputFormat, streamCaps.mimeType());
+        if (codec.isEmpty())
+            return QVariantMap();
+    } else {
+        if (codec.isEmpty())
+            return QVariantMap();
 
-    if (codec.isEmpty() || !supportedCodecs.contains(codec))
-        codec = this->defaultCodec(outputFormat, streamCaps.mimeType());
+        auto supportedCodecs = this->supportedCodecs(outputFormat, streamCaps.mimeType());
+
+        if (!supportedCodecs.contains(codec))
+            codec = this->defaultCodec(outputFormat, streamCaps.mimeType());
+    }
 
     outputParams["codec"] = codec;
     outputParams["caps"] = QVariant::fromValue(streamCaps);
@@ -869,6 +987,7 @@ QVariantMap MediaWriterFFmpeg::addStream(int streamIndex,
             gop = defaultCodecParams["defaultGOP"].toInt();
 
         outputParams["gop"] = gop;
+        outputParams["vfr"] = codecParams.value("vfr", false).toBool();
     }
 
     this->d->m_streamConfigs << outputParams;
@@ -939,6 +1058,12 @@ QVariantMap MediaWriterFFmpeg::updateStream(int index,
         streamChanged |= true;
     }
 
+    if (streamCaps.mimeType() == "video/x-raw"
+        && codecParams.contains("vfr")) {
+        this->d->m_streamConfigs[index]["vfr"] = codecParams["vfr"].toBool();
+        streamChanged |= true;
+    }
+
     if (streamChanged)
         emit this->streamsChanged(this->streams());
 
@@ -1019,13 +1144,29 @@ QString MediaWriterFFmpegPrivate::guessFormat()
     if (self->supportedFormats().contains(this->m_outputFormat))
         outputFormat = this->m_outputFormat;
     else {
+        auto location = self->location();
         auto format =
                 av_guess_format(nullptr,
-                                self->location().toStdString().c_str(),
+                                location.toStdString().c_str(),
                                 nullptr);
 
-        if (format)
+        if (format) {
             outputFormat = QString(format->name);
+        } else if (location.contains("://")) {
+            // Streaming URLs don't map to a file suffix, guess the muxer
+            // from the protocol instead.
+            static const QMap<QString, QString> protocolFormats = {
+                {"rtmp" , "flv"   },
+                {"rtmps", "flv"   },
+                {"rtsp" , "rtsp"  },
+                {"srt"  , "mpegts"},
+                {"udp"  , "mpegts"},
+                {"tcp"  , "mpegts"}
+            };
+
+            auto protocol = location.section("://", 0, 0).toLower();
+            outputFormat = protocolFormats.value(protocol);
+        }
     }
 
     return outputFormat;
@@ -1036,6 +1177,13 @@ QVariantList MediaWriterFFmpegPrivate::parseOptions(const AVClass *avClass) cons
     if (!avClass)
         return QVariantList();
 
+    {
+        QMutexLocker locker(&mediaWriterFFmpegGlobal->m_parsedOptionsMutex);
+
+        if (mediaWriterFFmpegGlobal->m_parsedOptions.contains(avClass))
+            return mediaWriterFFmpegGlobal->m_parsedOptions.value(avClass);
+    }
+
     QList<QVariantList> avOptions;
     QMap<QString, QVariantList> menu;
 
@@ -1223,6 +1371,9 @@ QVariantList MediaWriterFFmpegPrivate::parseOptions(const AVClass *avClass) cons
         options << QVariant(option);
     }
 
+    QMutexLocker locker(&mediaWriterFFmpegGlobal->m_parsedOptionsMutex);
+    mediaWriterFFmpegGlobal->m_parsedOptions[avClass] = options;
+
     return options;
 }
 
@@ -1261,6 +1412,265 @@ AVDictionary *MediaWriterFFmpegPrivate::formatContextOptions(AVFormatContext *fo
     return formatOptions;
 }
 
+QString MediaWriterFFmpegPrivate::segmentLocation(int index) const
+{
+    auto location = self->location();
+    int dot = location.lastIndexOf('.');
+    auto suffix = QString("_%1").arg(index, 5, 10, QChar('0'));
+
+    if (dot < 0)
+        return location + suffix;
+
+    return location.left(dot) + suffix + location.mid(dot);
+}
+
+AVMediaType MediaWriterFFmpegPrivate::streamMediaType(const AVStream *stream) const
+{
+#ifdef HAVE_CODECPAR
+    return stream->codecpar->codec_type;
+#else
+    return stream->codec->codec_type;
+#endif
+}
+
+bool MediaWriterFFmpegPrivate::openOutput(AVFormatContext *context,
+                                          const QString &location)
+{
+    if (self->asyncWrite() && !this->m_networked) {
+        auto writer = new AsyncWriter(location, self->directWrite());
+
+        if (writer->isOpen()) {
+            context->pb = writer->stream();
+            context->flags |= AVFMT_FLAG_CUSTOM_IO;
+            this->m_asyncWritersMutex.lock();
+            this->m_asyncWriters[context] = writer;
+            this->m_asyncWritersMutex.unlock();
+
+            return true;
+        }
+
+        // Couldn't open the buffered path, fall back to ffmpeg's own I/O.
+        delete writer;
+    }
+
+    int error = avio_open(&context->pb,
+                          location.toStdString().c_str(),
+                          this->m_networked?
+                              AVIO_FLAG_WRITE: AVIO_FLAG_READ_WRITE);
+
+    if (error < 0) {
+        char errorStr[1024];
+        av_strerror(AVERROR(error), errorStr, 1024);
+        qDebug() << "Can't open output file: " << errorStr;
+
+        return false;
+    }
+
+    return true;
+}
+
+void MediaWriterFFmpegPrivate::applyCrashSafeOptions(AVFormatContext *context,
+                                                     AVDictionary **options)
+{
+    if (!self->crashSafe())
+        return;
+
+    QString format(context->oformat->name);
+
+    if (format == "mp4"
+        || format == "mov"
+        || format == "3gp"
+        || format == "m4v"
+        || format == "ipod") {
+        /* Fragmented MP4: the moov goes up front and a moof closes every
+         * keyframe fragment, so the file stays playable up to the last
+         * flushed fragment. The per fragment overhead is a few hundred
+         * bytes against multi-second GOPs, well under a percent of
+         * bitrate. Explicit user movflags are left untouched. */
+        if (!av_dict_get(*options, "movflags", nullptr, 0))
+            av_dict_set(options,
+                        "movflags",
+                        "+empty_moov+frag_keyframe+default_base_moof",
+                        0);
+    } else if (format == "matroska" || format == "webm") {
+        // Short clusters bound the data loss window; Matroska needs no
+        // trailing index to stay decodable after a crash.
+        if (!av_dict_get(*options, "cluster_time_limit", nullptr, 0))
+            av_dict_set(options, "cluster_time_limit", "2000", 0);
+    }
+
+    // Push every muxed packet down to the I/O layer instead of letting it
+    // age in the avio buffer.
+    context->flags |= AVFMT_FLAG_FLUSH_PACKETS;
+}
+
+void MediaWriterFFmpegPrivate::closeOutput(AVFormatContext *context)
+{
+    this->m_asyncWritersMutex.lock();
+    auto writer = this->m_asyncWriters.take(context);
+    this->m_asyncWritersMutex.unlock();
+
+    if (writer) {
+        // Deleting the writer drains the backlog and closes the file.
+        delete writer;
+        context->pb = nullptr;
+    } else {
+        avio_close(context->pb);
+    }
+}
+
+AVFormatContext *MediaWriterFFmpegPrivate::openSegmentContext(const QString &location)
+{
+    auto context = avformat_alloc_context();
+
+    if (!context)
+        return nullptr;
+
+    context->oformat = this->m_formatContext->oformat;
+    memset(context->filename, 0, 1024);
+    memcpy(context->filename,
+           location.toStdString().c_str(),
+           size_t(location.size()));
+
+    for (uint i = 0; i < this->m_formatContext->nb_streams; i++) {
+        auto iStream = this->m_formatContext->streams[i];
+        auto oStream = avformat_new_stream(context, nullptr);
+
+        if (!oStream) {
+            avformat_free_context(context);
+
+            return nullptr;
+        }
+
+        oStream->id = iStream->id;
+        oStream->time_base = iStream->time_base;
+#ifdef HAVE_CODECPAR
+        avcodec_parameters_copy(oStream->codecpar, iStream->codecpar);
+#else
+        avcodec_copy_context(oStream->codec, iStream->codec);
+#endif
+    }
+
+    if (!(context->oformat->flags & AVFMT_NOFILE))
+        if (!this->openOutput(context, location)) {
+            avformat_free_context(context);
+
+            return nullptr;
+        }
+
+    auto formatOptions =
+            this->formatContextOptions(context,
+                                       this->m_formatOptions.value(this->guessFormat()));
+    this->applyCrashSafeOptions(context, &formatOptions);
+    int error = avformat_write_header(context, &formatOptions);
+    av_dict_free(&formatOptions);
+
+    if (error < 0) {
+        char errorStr[1024];
+        av_strerror(AVERROR(error), errorStr, 1024);
+        qDebug() << "Can't write segment header: " << errorStr;
+
+        if (!(context->oformat->flags & AVFMT_NOFILE))
+            this->closeOutput(context);
+
+        avformat_free_context(context);
+
+        return nullptr;
+    }
+
+    return context;
+}
+
+void MediaWriterFFmpegPrivate::openNextSegment()
+{
+    auto context = this->openSegmentContext(this->m_nextLocation);
+
+    this->m_writeMutex.lock();
+    this->m_nextContext = context;
+    this->m_writeMutex.unlock();
+}
+
+void MediaWriterFFmpegPrivate::prepareNextSegment()
+{
+    if (this->m_nextContext || this->m_nextContextResult.isRunning())
+        return;
+
+    // Pre-open the next segment at 3/4 of either limit, so the switchover
+    // itself only swaps pointers.
+    auto duration = self->segmentDuration();
+    auto maxSize = self->segmentMaxSize();
+    bool timeClose = duration > 0
+                     && this->m_segmentTimer.elapsed() >= 750 * duration;
+    bool sizeClose = maxSize > 0
+                     && this->m_segmentBytes >= 3 * maxSize / 4;
+
+    if (!timeClose && !sizeClose)
+        return;
+
+    this->m_nextLocation = this->segmentLocation(this->m_segmentIndex + 1);
+    this->m_nextContextResult =
+            QtConcurrent::run(&this->m_threadPool,
+                              this,
+                              &MediaWriterFFmpegPrivate::openNextSegment);
+}
+
+bool MediaWriterFFmpegPrivate::segmentBoundary(const AVPacket *packet) const
+{
+    auto duration = self->segmentDuration();
+    auto maxSize = self->segmentMaxSize();
+    bool limitReached = (duration > 0
+                         && this->m_segmentTimer.elapsed() >= 1000 * duration)
+                        || (maxSize > 0 && this->m_segmentBytes >= maxSize);
+
+    if (!limitReached)
+        return false;
+
+    // Only cut on a video key frame, so every segment starts decodable.
+    auto stream = this->m_formatContext->streams[packet->stream_index];
+
+    if (this->streamMediaType(stream) == AVMEDIA_TYPE_VIDEO)
+        return packet->flags & AV_PKT_FLAG_KEY;
+
+    for (uint i = 0; i < this->m_formatContext->nb_streams; i++)
+        if (this->streamMediaType(this->m_formatContext->streams[i]) == AVMEDIA_TYPE_VIDEO)
+            return false;
+
+    return true;
+}
+
+void MediaWriterFFmpegPrivate::rotateSegment()
+{
+    av_write_trailer(this->m_activeContext);
+
+    if (!(this->m_activeContext->oformat->flags & AVFMT_NOFILE))
+        this->closeOutput(this->m_activeContext);
+
+    // The first context owns the streams the encoders point to, so it's only
+    // freed on uninit().
+    if (this->m_activeContext != this->m_formatContext)
+        avformat_free_context(this->m_activeContext);
+
+    this->m_activeContext = this->m_nextContext;
+    this->m_nextContext = nullptr;
+    this->m_segmentIndex++;
+    this->m_segmentBytes = 0;
+    this->m_segmentTimer.restart();
+}
+
+void MediaWriterFFmpegPrivate::swapReconnected()
+{
+    // No trailer on the dead connection, it would just block on I/O.
+    if (!(this->m_activeContext->oformat->flags & AVFMT_NOFILE))
+        this->closeOutput(this->m_activeContext);
+
+    if (this->m_activeContext != this->m_formatContext)
+        avformat_free_context(this->m_activeContext);
+
+    this->m_activeContext = this->m_nextContext;
+    this->m_nextContext = nullptr;
+    this->m_writeErrors = 0;
+}
+
 AkVideoCaps MediaWriterFFmpeg::nearestDVCaps(const AkVideoCaps &caps) const
 {
     AkVideoCaps nearestCaps;
@@ -1523,13 +1933,20 @@ void MediaWriterFFmpeg::clearStreams()
 bool MediaWriterFFmpeg::init()
 {
     auto outputFormat = this->d->guessFormat();
+    this->d->m_networked = this->m_location.contains("://")
+                           && !this->m_location.startsWith("file://");
+    this->d->m_segmented = (this->m_segmentDuration > 0
+                            || this->m_segmentMaxSize > 0)
+                           && !this->d->m_networked;
+    auto location = this->d->m_segmented?
+                        this->d->segmentLocation(0): this->m_location;
 
 #ifdef HAVE_ALLOCOUTPUTCONTEXT
     if (avformat_alloc_output_context2(&this->d->m_formatContext,
                                        nullptr,
                                        this->d->m_outputFormat.isEmpty()?
                                             nullptr: this->d->m_outputFormat.toStdString().c_str(),
-                                       this->m_location.toStdString().c_str()) < 0)
+                                       location.toStdString().c_str()) < 0)
         return false;
 #else
     this->d->m_formatContext = avformat_alloc_context();
@@ -1540,7 +1957,7 @@ bool MediaWriterFFmpeg::init()
     this->d->m_formatContext->oformat =
             av_guess_format(this->d->m_outputFormat.isEmpty()?
                                 nullptr: this->d->m_outputFormat.toStdString().c_str(),
-                            this->m_location.toStdString().c_str(),
+                            location.toStdString().c_str(),
                             nullptr);
 
     if (!this->d->m_formatContext->oformat) {
@@ -1552,8 +1969,8 @@ bool MediaWriterFFmpeg::init()
 
     memset(this->d->m_formatContext->filename, 0, 1024);
     memcpy(this->d->m_formatContext->filename,
-           this->m_location.toStdString().c_str(),
-           size_t(this->m_location.size()));
+           location.toStdString().c_str(),
+           size_t(location.size()));
 #endif
 
     auto streamConfigs = this->d->m_streamConfigs.toVector();
@@ -1609,10 +2026,17 @@ bool MediaWriterFFmpeg::init()
                                                       configs,
                                                       this->d->m_codecOptions,
                                                       this));
+        } else if (streamCaps.mimeType() == "video/unknown") {
+            mediaStream =
+                    AbstractStreamPtr(new PassthroughStream(this->d->m_formatContext,
+                                                            uint(i), inputId,
+                                                            configs,
+                                                            this));
         } else {
         }
 
         if (mediaStream) {
+            mediaStream->setDropOldest(this->m_queuePolicy == "dropOldest");
             this->d->m_streamsMap[inputId] = mediaStream;
 
             QObject::connect(mediaStream.data(),
@@ -1628,32 +2052,24 @@ bool MediaWriterFFmpeg::init()
     // Print recording information.
     av_dump_format(this->d->m_formatContext,
                    0,
-                   this->m_location.toStdString().c_str(),
+                   location.toStdString().c_str(),
                    1);
 
     // Open file.
-    if (!(this->d->m_formatContext->oformat->flags & AVFMT_NOFILE)) {
-        int error = avio_open(&this->d->m_formatContext->pb,
-                              this->m_location.toStdString().c_str(),
-                              AVIO_FLAG_READ_WRITE);
-
-        if (error < 0) {
-            char errorStr[1024];
-            av_strerror(AVERROR(error), errorStr, 1024);
-            qDebug() << "Can't open output file: " << errorStr;
-
+    if (!(this->d->m_formatContext->oformat->flags & AVFMT_NOFILE))
+        if (!this->d->openOutput(this->d->m_formatContext, location)) {
             this->d->m_streamsMap.clear();
             avformat_free_context(this->d->m_formatContext);
             this->d->m_formatContext = nullptr;
 
             return false;
         }
-    }
 
     // Set format options.
     auto formatOptions =
             this->d->formatContextOptions(this->d->m_formatContext,
                                           this->d->m_formatOptions.value(outputFormat));
+    this->d->applyCrashSafeOptions(this->d->m_formatContext, &formatOptions);
 
     // Write file header.
     int error = avformat_write_header(this->d->m_formatContext, &formatOptions);
@@ -1666,7 +2082,7 @@ bool MediaWriterFFmpeg::init()
 
         if (!(this->d->m_formatContext->oformat->flags & AVFMT_NOFILE))
             // Close the output file.
-            avio_close(this->d->m_formatContext->pb);
+            this->d->closeOutput(this->d->m_formatContext);
 
         this->d->m_streamsMap.clear();
         avformat_free_context(this->d->m_formatContext);
@@ -1675,6 +2091,11 @@ bool MediaWriterFFmpeg::init()
         return false;
     }
 
+    this->d->m_activeContext = this->d->m_formatContext;
+    this->d->m_segmentIndex = 0;
+    this->d->m_segmentBytes = 0;
+    this->d->m_writeErrors = 0;
+    this->d->m_segmentTimer.restart();
     this->d->m_isRecording = true;
 
     return true;
@@ -1687,25 +2108,111 @@ void MediaWriterFFmpeg::uninit()
 
     this->d->m_isRecording = false;
     this->d->m_streamsMap.clear();
+    this->d->m_nextContextResult.waitForFinished();
 
     // Write the trailer, if any. The trailer must be written before you
     // close the CodecContexts open when you wrote the header; otherwise
     // av_write_trailer() may try to use memory that was freed on
     // av_codec_close().
-    av_write_trailer(this->d->m_formatContext);
+    av_write_trailer(this->d->m_activeContext);
 
-    if (!(this->d->m_formatContext->oformat->flags & AVFMT_NOFILE))
+    if (!(this->d->m_activeContext->oformat->flags & AVFMT_NOFILE))
         // Close the output file.
-        avio_close(this->d->m_formatContext->pb);
+        this->d->closeOutput(this->d->m_activeContext);
+
+    if (this->d->m_activeContext != this->d->m_formatContext)
+        avformat_free_context(this->d->m_activeContext);
+
+    // Discard a pre-opened segment that was never written to.
+    if (this->d->m_nextContext) {
+        av_write_trailer(this->d->m_nextContext);
+
+        if (!(this->d->m_nextContext->oformat->flags & AVFMT_NOFILE))
+            this->d->closeOutput(this->d->m_nextContext);
+
+        avformat_free_context(this->d->m_nextContext);
+        this->d->m_nextContext = nullptr;
+    }
 
     avformat_free_context(this->d->m_formatContext);
     this->d->m_formatContext = nullptr;
+    this->d->m_activeContext = nullptr;
 }
 
 void MediaWriterFFmpeg::writePacket(AVPacket *packet)
 {
     this->d->m_writeMutex.lock();
-    av_interleaved_write_frame(this->d->m_formatContext, packet);
+
+    if (this->d->m_segmented) {
+        if (this->d->m_nextContext && this->d->segmentBoundary(packet))
+            this->d->rotateSegment();
+        else
+            this->d->prepareNextSegment();
+
+        this->d->m_segmentBytes += packet->size;
+    } else if (this->d->m_networked) {
+        if (this->d->m_nextContext) {
+            this->d->swapReconnected();
+        } else if (this->d->m_nextContextResult.isRunning()) {
+            // Late packets are dropped instead of blocking the encoders
+            // while the connection is re-established.
+            this->d->m_writeMutex.unlock();
+
+            return;
+        }
+    }
+
+    if (this->d->m_activeContext != this->d->m_formatContext) {
+        auto refStream = this->d->m_formatContext->streams[packet->stream_index];
+        auto outStream = this->d->m_activeContext->streams[packet->stream_index];
+
+        // The muxer may have adjusted the time base when the header of the
+        // new context was written.
+        if (refStream->time_base.num != outStream->time_base.num
+            || refStream->time_base.den != outStream->time_base.den) {
+#ifdef HAVE_RESCALETS
+            av_packet_rescale_ts(packet,
+                                 refStream->time_base,
+                                 outStream->time_base);
+#else
+            if (packet->pts != AV_NOPTS_VALUE)
+                packet->pts = av_rescale_q(packet->pts,
+                                           refStream->time_base,
+                                           outStream->time_base);
+
+            if (packet->dts != AV_NOPTS_VALUE)
+                packet->dts = av_rescale_q(packet->dts,
+                                           refStream->time_base,
+                                           outStream->time_base);
+
+            if (packet->duration > 0)
+                packet->duration = av_rescale_q(packet->duration,
+                                                refStream->time_base,
+                                                outStream->time_base);
+#endif
+        }
+    }
+
+    int error = av_interleaved_write_frame(this->d->m_activeContext, packet);
+
+    if (this->d->m_networked) {
+        if (error < 0) {
+            this->d->m_writeErrors++;
+
+            if (this->d->m_writeErrors >= MAX_WRITE_ERRORS
+                && !this->d->m_nextContextResult.isRunning()) {
+                this->d->m_writeErrors = 0;
+                this->d->m_nextLocation = this->m_location;
+                this->d->m_nextContextResult =
+                        QtConcurrent::run(&this->d->m_threadPool,
+                                          this->d,
+                                          &MediaWriterFFmpegPrivate::openNextSegment);
+            }
+        } else {
+            this->d->m_writeErrors = 0;
+        }
+    }
+
     this->d->m_writeMutex.unlock();
 }
 
@@ -38,6 +38,8 @@ class MediaWriterFFmpeg: public MediaWriter
         Q_INVOKABLE QString outputFormat() const;
         Q_INVOKABLE QVariantList streams() const;
         Q_INVOKABLE qint64 maxPacketQueueSize() const;
+        Q_INVOKABLE QVariantMap queueStats() const;
+        Q_INVOKABLE QVariantMap writeStats() const;
 
         Q_INVOKABLE QStringList supportedFormats();
         Q_INVOKABLE QStringList fileExtensions(const QString &format);
@@ -0,0 +1,223 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <akcaps.h>
+#include <akfrac.h>
+#include <akpacket.h>
+
+#include "passthroughstream.h"
+#include "mediawriterffmpeg.h"
+
+typedef QMap<QString, AVCodecID> FourccToCodecIDMap;
+
+inline FourccToCodecIDMap initFourccToCodecIDMap()
+{
+    FourccToCodecIDMap fourccToCodecID = {
+        {"H264", AV_CODEC_ID_H264      },
+        {"X264", AV_CODEC_ID_H264      },
+        {"AVC1", AV_CODEC_ID_H264      },
+        {"DAVC", AV_CODEC_ID_H264      },
+        {"MJPG", AV_CODEC_ID_MJPEG     },
+        {"JPEG", AV_CODEC_ID_MJPEG     },
+        {"MPG2", AV_CODEC_ID_MPEG2VIDEO},
+        {"MPG4", AV_CODEC_ID_MPEG4     },
+        {"MP4V", AV_CODEC_ID_MPEG4     },
+        {"VP80", AV_CODEC_ID_VP8       },
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(55, 28, 1)
+        {"VP90", AV_CODEC_ID_VP9       },
+        {"HEVC", AV_CODEC_ID_HEVC      },
+        {"HVC1", AV_CODEC_ID_HEVC      },
+        {"X265", AV_CODEC_ID_HEVC      },
+#endif
+    };
+
+    return fourccToCodecID;
+}
+
+Q_GLOBAL_STATIC_WITH_ARGS(FourccToCodecIDMap, fourccToCodecID, (initFourccToCodecIDMap()))
+
+class PassthroughStreamPrivate
+{
+    public:
+        AkCaps m_caps;
+        AVCodecID m_codecId;
+
+        PassthroughStreamPrivate():
+            m_codecId(AV_CODEC_ID_NONE)
+        {
+        }
+
+        inline bool isKeyFrame(const uint8_t *data, int size) const;
+};
+
+inline QVariantMap dropCodecConfig(QVariantMap configs)
+{
+    // There is no encoder on a passthrough stream, keep the base class from
+    // attaching one.
+    configs.remove("codec");
+
+    return configs;
+}
+
+PassthroughStream::PassthroughStream(const AVFormatContext *formatContext,
+                                     uint index,
+                                     int streamIndex,
+                                     const QVariantMap &configs,
+                                     MediaWriterFFmpeg *mediaWriter,
+                                     QObject *parent):
+    AbstractStream(formatContext,
+                   index, streamIndex,
+                   dropCodecConfig(configs),
+                   {},
+                   mediaWriter,
+                   parent)
+{
+    this->d = new PassthroughStreamPrivate;
+    this->m_passthrough = true;
+    this->d->m_caps = configs["caps"].value<AkCaps>();
+    this->d->m_codecId = PassthroughStream::codecId(this->d->m_caps);
+
+    AkFrac fps(this->d->m_caps.property("fps").toString());
+
+    if (fps.num() < 1 || fps.den() < 1)
+        fps = AkFrac(30, 1);
+
+    AkFrac timeBase = fps.invert();
+    auto stream = this->stream();
+    stream->time_base.num = int(timeBase.num());
+    stream->time_base.den = int(timeBase.den());
+}
+
+PassthroughStream::~PassthroughStream()
+{
+    this->uninit();
+    delete this->d;
+}
+
+AVCodecID PassthroughStream::codecId(const AkCaps &caps)
+{
+    auto fourcc = caps.property("fourcc").toString().toUpper();
+
+    return fourccToCodecID->value(fourcc, AV_CODEC_ID_NONE);
+}
+
+QString PassthroughStream::codecName(const AkCaps &caps)
+{
+    auto codecId = PassthroughStream::codecId(caps);
+
+    if (codecId == AV_CODEC_ID_NONE)
+        return {};
+
+    return QString(avcodec_get_name(codecId));
+}
+
+void PassthroughStream::convertPacket(const AkPacket &packet)
+{
+    size_t dataSize = packet.frameBuffer().isEmpty()?
+                          size_t(packet.buffer().size()):
+                          packet.frameBuffer().size();
+
+    if (dataSize < 1)
+        return;
+
+    AVPacket pkt;
+    memset(&pkt, 0, sizeof(AVPacket));
+    av_init_packet(&pkt);
+    pkt.data = reinterpret_cast<uint8_t *>(const_cast<char *>(packet.constData()));
+    pkt.size = int(dataSize);
+
+    // Capture devices don't reorder frames, presentation and decoding order
+    // are the same.
+    pkt.pts = packet.pts();
+    pkt.dts = pkt.pts;
+    pkt.stream_index = this->streamIndex();
+
+    if (this->d->isKeyFrame(pkt.data, pkt.size))
+        pkt.flags |= AV_PKT_FLAG_KEY;
+
+    AkFrac timeBase = packet.timeBase();
+
+    if (timeBase.num() > 0 && timeBase.den() > 0) {
+        AVRational src;
+        src.num = int(timeBase.num());
+        src.den = int(timeBase.den());
+        this->rescaleTS(&pkt, src, this->stream()->time_base);
+    }
+
+    /* The muxer duplicates the packet data while it waits for interleaving,
+     * so the source buffer only needs to outlive this call. */
+    emit this->packetReady(&pkt);
+}
+
+bool PassthroughStream::init()
+{
+    if (this->d->m_codecId == AV_CODEC_ID_NONE)
+        return false;
+
+    auto stream = this->stream();
+
+#ifdef HAVE_CODECPAR
+    auto codecParams = stream->codecpar;
+#else
+    auto codecParams = stream->codec;
+#endif
+
+    codecParams->codec_type = AVMEDIA_TYPE_VIDEO;
+    codecParams->codec_id = this->d->m_codecId;
+    codecParams->codec_tag = 0;
+    codecParams->width = this->d->m_caps.property("width").toInt();
+    codecParams->height = this->d->m_caps.property("height").toInt();
+
+    return AbstractStream::init();
+}
+
+bool PassthroughStreamPrivate::isKeyFrame(const uint8_t *data, int size) const
+{
+    switch (this->m_codecId) {
+    case AV_CODEC_ID_MJPEG:
+    case AV_CODEC_ID_NONE:
+        // Intra-only, every frame is a sync point.
+        return true;
+
+    case AV_CODEC_ID_H264:
+        // Search the NAL start codes for an IDR slice.
+        for (int i = 0; i + 4 < size; i++)
+            if (data[i] == 0 && data[i + 1] == 0
+                && (data[i + 2] == 1
+                    || (data[i + 2] == 0 && data[i + 3] == 1))) {
+                int nalType = data[i + (data[i + 2] == 1? 3: 4)] & 0x1f;
+
+                if (nalType == 5)
+                    return true;
+
+                if (nalType == 1)
+                    return false;
+            }
+
+        return false;
+
+    case AV_CODEC_ID_VP8:
+        return size > 0 && !(data[0] & 0x01);
+
+    default:
+        return false;
+    }
+}
+
+#include "moc_passthroughstream.cpp"
@@ -0,0 +1,53 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef PASSTHROUGHSTREAM_H
+#define PASSTHROUGHSTREAM_H
+
+#include "abstractstream.h"
+
+class PassthroughStreamPrivate;
+class AkCaps;
+
+class PassthroughStream: public AbstractStream
+{
+    Q_OBJECT
+
+    public:
+        PassthroughStream(const AVFormatContext *formatContext=nullptr,
+                          uint index=0, int streamIndex=-1,
+                          const QVariantMap &configs={},
+                          MediaWriterFFmpeg *mediaWriter=nullptr,
+                          QObject *parent=nullptr);
+        ~PassthroughStream();
+
+        Q_INVOKABLE static AVCodecID codecId(const AkCaps &caps);
+        Q_INVOKABLE static QString codecName(const AkCaps &caps);
+
+    private:
+        PassthroughStreamPrivate *d;
+
+    protected:
+        void convertPacket(const AkPacket &packet);
+
+    public slots:
+        bool init();
+};
+
+#endif // PASSTHROUGHSTREAM_H
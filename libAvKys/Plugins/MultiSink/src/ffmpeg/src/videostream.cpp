@@ -17,27 +17,40 @@
  * Web-Site: http://webcamoid.github.io/
  */
 
-#include <QDebug>
 #include <QDateTime>
 #include <QImage>
+#include <QtConcurrent>
+#include <QFuture>
+#include <QThread>
 #include <QMutex>
 #include <QWaitCondition>
 #include <QtMath>
 #include <akutils.h>
 #include <akcaps.h>
 #include <akfrac.h>
+#include <aklog.h>
 #include <akpacket.h>
 #include <akvideopacket.h>
 
 extern "C"
 {
     #include <libavutil/imgutils.h>
+    #include <libavutil/pixdesc.h>
     #include <libswscale/swscale.h>
+
+#ifdef HAVE_HWCONTEXT
+    #include <libavutil/hwcontext.h>
+#endif
 }
 
 #include "videostream.h"
 #include "mediawriterffmpeg.h"
 
+/* Encoder errors repeat at frame rate when the stream goes bad, logging
+ * them synchronously would change the timing being diagnosed. */
+static const int videoStreamLog =
+        AkLog::registerCategory("MultiSink.video", AkLog::LevelWarning);
+
 struct XRGB
 {
     quint8 x;
@@ -59,20 +72,50 @@ class VideoStreamPrivate
     public:
         AVFrame *m_frame;
         SwsContext *m_scaleContext;
+        QVector<SwsContext *> m_bandScaleContexts;
         QMutex m_frameMutex;
         int64_t m_lastPts;
         int64_t m_refPts;
         QWaitCondition m_frameReady;
+        const void *m_lastFrameData;
+        size_t m_lastFrameSize;
+        bool m_vfr;
+        bool m_hwTimestamps;
+
+#ifdef HAVE_HWCONTEXT
+        AVBufferRef *m_hwDeviceContext;
+        AVBufferRef *m_hwFramesContext;
+        AVPixelFormat m_hwPixelFormat;
+        AVPixelFormat m_hwSwFormat;
+#endif
 
         VideoStreamPrivate():
             m_frame(nullptr),
             m_scaleContext(nullptr),
             m_lastPts(AV_NOPTS_VALUE),
-            m_refPts(AV_NOPTS_VALUE)
+            m_refPts(AV_NOPTS_VALUE),
+            m_lastFrameData(nullptr),
+            m_lastFrameSize(0),
+            m_vfr(false),
+            m_hwTimestamps(false)
         {
+#ifdef HAVE_HWCONTEXT
+            this->m_hwDeviceContext = nullptr;
+            this->m_hwFramesContext = nullptr;
+            this->m_hwPixelFormat = AV_PIX_FMT_NONE;
+            this->m_hwSwFormat = AV_PIX_FMT_NONE;
+#endif
         }
 
         inline QImage swapChannels(const QImage &image) const;
+        inline bool scaleParallel(const AVFrame &iFrame,
+                                  AVPixelFormat iFormat,
+                                  int iHeight,
+                                  AVFrame *oFrame);
+
+#ifdef HAVE_HWCONTEXT
+        inline void initHardwareEncoding(AVCodecContext *codecContext);
+#endif
 };
 
 VideoStream::VideoStream(const AVFormatContext *formatContext,
@@ -182,10 +225,29 @@ VideoStream::VideoStream(const AVFormatContext *formatContext,
     stream->time_base.num = int(timeBase.num());
     stream->time_base.den = int(timeBase.den());
     codecContext->time_base = stream->time_base;
+
+    /* Variable frame rate: one tick per millisecond so arbitrary gaps
+     * between frames are representable exactly. Containers that can't
+     * carry variable timing keep the constant clock. */
+    this->d->m_vfr = configs["vfr"].toBool()
+                     && formatContext->oformat->flags & AVFMT_VARIABLE_FPS;
+
+    if (this->d->m_vfr) {
+        stream->time_base.num = 1;
+        stream->time_base.den = 1000;
+        codecContext->time_base = stream->time_base;
+        stream->avg_frame_rate.num = int(videoCaps.fps().num());
+        stream->avg_frame_rate.den = int(videoCaps.fps().den());
+    }
+
     codecContext->gop_size = configs["gop"].toInt();
 
     if (codecContext->gop_size < 1)
         codecContext->gop_size = defaultCodecParams["defaultGOP"].toInt();
+
+#ifdef HAVE_HWCONTEXT
+    this->d->initHardwareEncoding(codecContext);
+#endif
 }
 
 VideoStream::~VideoStream()
@@ -193,9 +255,110 @@ VideoStream::~VideoStream()
     this->uninit();
     this->deleteFrame(&this->d->m_frame);
     sws_freeContext(this->d->m_scaleContext);
+
+    for (auto &context: this->d->m_bandScaleContexts)
+        sws_freeContext(context);
+
+#ifdef HAVE_HWCONTEXT
+    if (this->d->m_hwFramesContext)
+        av_buffer_unref(&this->d->m_hwFramesContext);
+
+    if (this->d->m_hwDeviceContext)
+        av_buffer_unref(&this->d->m_hwDeviceContext);
+#endif
+
     delete this->d;
 }
 
+#ifdef HAVE_HWCONTEXT
+void VideoStreamPrivate::initHardwareEncoding(AVCodecContext *codecContext)
+{
+    static const struct
+    {
+        AVPixelFormat format;
+        AVHWDeviceType deviceType;
+    } hwEncodeFormats[] = {
+        {AV_PIX_FMT_VAAPI       , AV_HWDEVICE_TYPE_VAAPI       },
+        {AV_PIX_FMT_CUDA        , AV_HWDEVICE_TYPE_CUDA        },
+        {AV_PIX_FMT_QSV         , AV_HWDEVICE_TYPE_QSV         },
+        {AV_PIX_FMT_VIDEOTOOLBOX, AV_HWDEVICE_TYPE_VIDEOTOOLBOX},
+        {AV_PIX_FMT_NONE        , AV_HWDEVICE_TYPE_NONE        },
+    };
+
+    auto codec = codecContext->codec;
+
+    if (!codec->pix_fmts)
+        return;
+
+    auto deviceType = AV_HWDEVICE_TYPE_NONE;
+    auto hwFormat = AV_PIX_FMT_NONE;
+    auto swFormat = AV_PIX_FMT_NONE;
+
+    for (auto format = codec->pix_fmts; *format != AV_PIX_FMT_NONE; format++) {
+        bool isHwFormat = false;
+
+        for (auto hw = hwEncodeFormats; hw->format != AV_PIX_FMT_NONE; hw++)
+            if (*format == hw->format) {
+                deviceType = hw->deviceType;
+                hwFormat = hw->format;
+                isHwFormat = true;
+
+                break;
+            }
+
+        // The first software format the encoder accepts becomes the
+        // upload format.
+        if (!isHwFormat && swFormat == AV_PIX_FMT_NONE)
+            swFormat = *format;
+    }
+
+    if (hwFormat == AV_PIX_FMT_NONE)
+        return;
+
+    if (swFormat == AV_PIX_FMT_NONE)
+        swFormat = AV_PIX_FMT_NV12;
+
+    AVBufferRef *deviceContext = nullptr;
+
+    if (av_hwdevice_ctx_create(&deviceContext,
+                               deviceType,
+                               nullptr,
+                               nullptr,
+                               0) < 0)
+        return;
+
+    auto framesContextRef = av_hwframe_ctx_alloc(deviceContext);
+
+    if (!framesContextRef) {
+        av_buffer_unref(&deviceContext);
+
+        return;
+    }
+
+    auto framesContext =
+            reinterpret_cast<AVHWFramesContext *>(framesContextRef->data);
+    framesContext->format = hwFormat;
+    framesContext->sw_format = swFormat;
+    framesContext->width = codecContext->width;
+    framesContext->height = codecContext->height;
+    framesContext->initial_pool_size = 4;
+
+    if (av_hwframe_ctx_init(framesContextRef) < 0) {
+        av_buffer_unref(&framesContextRef);
+        av_buffer_unref(&deviceContext);
+
+        return;
+    }
+
+    codecContext->hw_frames_ctx = av_buffer_ref(framesContextRef);
+    codecContext->pix_fmt = hwFormat;
+    this->m_hwDeviceContext = deviceContext;
+    this->m_hwFramesContext = framesContextRef;
+    this->m_hwPixelFormat = hwFormat;
+    this->m_hwSwFormat = swFormat;
+}
+#endif
+
 QImage VideoStreamPrivate::swapChannels(const QImage &image) const
 {
     QImage swapped(image.size(), image.format());
@@ -215,11 +378,132 @@ QImage VideoStreamPrivate::swapChannels(const QImage &image) const
     return swapped;
 }
 
+bool VideoStreamPrivate::scaleParallel(const AVFrame &iFrame,
+                                       AVPixelFormat iFormat,
+                                       int iHeight,
+                                       AVFrame *oFrame)
+{
+    /* Same size format conversion is row local, so it can be split in
+     * horizontal bands, one swscale context per band. Actual scaling
+     * can't, the filter would miss its neighbor rows at the seams. */
+    int iVSub = 0;
+    int iHSub = 0;
+    int oVSub = 0;
+    int oHSub = 0;
+    av_pix_fmt_get_chroma_sub_sample(iFormat, &iHSub, &iVSub);
+    av_pix_fmt_get_chroma_sub_sample(AVPixelFormat(oFrame->format),
+                                     &oHSub, &oVSub);
+    int align = 1 << qMax(iVSub, oVSub);
+    int bands = qMin(QThread::idealThreadCount(), iHeight / 128);
+
+    if (bands < 2)
+        return false;
+
+    if (this->m_bandScaleContexts.size() < bands)
+        this->m_bandScaleContexts.resize(bands);
+
+    QVector<QFuture<void>> futures;
+
+    for (int i = 0; i < bands; i++) {
+        int yStart = (iHeight * i / bands) & ~(align - 1);
+        int yEnd = i == bands - 1?
+                       iHeight:
+                       (iHeight * (i + 1) / bands) & ~(align - 1);
+
+        if (yEnd <= yStart)
+            continue;
+
+        futures << QtConcurrent::run([=] () {
+            int bandHeight = yEnd - yStart;
+            auto context =
+                    sws_getCachedContext(this->m_bandScaleContexts[i],
+                                         oFrame->width,
+                                         bandHeight,
+                                         iFormat,
+                                         oFrame->width,
+                                         bandHeight,
+                                         AVPixelFormat(oFrame->format),
+                                         SWS_FAST_BILINEAR,
+                                         nullptr,
+                                         nullptr,
+                                         nullptr);
+
+            if (!context)
+                return;
+
+            this->m_bandScaleContexts[i] = context;
+
+            const uint8_t *srcData[4];
+            uint8_t *dstData[4];
+            memset(srcData, 0, sizeof(srcData));
+            memset(dstData, 0, sizeof(dstData));
+
+            for (int plane = 0; plane < 4; plane++) {
+                int iShift = plane == 1 || plane == 2? iVSub: 0;
+                int oShift = plane == 1 || plane == 2? oVSub: 0;
+
+                if (iFrame.data[plane])
+                    srcData[plane] = iFrame.data[plane]
+                                   + (yStart >> iShift) * iFrame.linesize[plane];
+
+                if (oFrame->data[plane])
+                    dstData[plane] = oFrame->data[plane]
+                                   + (yStart >> oShift) * oFrame->linesize[plane];
+            }
+
+            sws_scale(context,
+                      srcData,
+                      iFrame.linesize,
+                      0,
+                      bandHeight,
+                      dstData,
+                      oFrame->linesize);
+        });
+    }
+
+    for (auto &future: futures)
+        future.waitForFinished();
+
+    return true;
+}
+
 void VideoStream::convertPacket(const AkPacket &packet)
 {
     if (!packet)
         return;
 
+    if (this->d->m_vfr) {
+        /* The scene change gate re-emits its cached output, sharing the
+         * pixel storage by reference, so an unchanged frame arrives with
+         * the same buffer. Skipping it here keeps static content out of
+         * the scaler and the encoder entirely; the next changed frame
+         * carries its real timestamp and the gap becomes part of the
+         * stream.
+         *
+         * The identity comes from the storage the packet actually travels
+         * with: buffer() materializes a fresh copy for frame buffer backed
+         * packets, so its pointer would never match twice. */
+        const void *data = nullptr;
+        size_t size = 0;
+        auto frameBuffer = packet.frameBuffer();
+
+        if (frameBuffer) {
+            data = frameBuffer.constData();
+            size = frameBuffer.size();
+        } else {
+            const QByteArray &buffer = packet.buffer();
+            data = buffer.constData();
+            size = size_t(buffer.size());
+        }
+
+        if (data == this->d->m_lastFrameData
+            && size == this->d->m_lastFrameSize)
+            return;
+
+        this->d->m_lastFrameData = data;
+        this->d->m_lastFrameSize = size;
+    }
+
     auto codecContext = this->codecContext();
 
 #ifdef HAVE_FRAMEALLOC
@@ -228,37 +512,50 @@ void VideoStream::convertPacket(const AkPacket &packet)
     auto oFrame = avcodec_alloc_frame();
 #endif
 
+#ifdef HAVE_HWCONTEXT
+    // Hardware encoders take frames in GPU memory, convert to the upload
+    // format here and transfer after scaling.
+    oFrame->format = this->d->m_hwPixelFormat != AV_PIX_FMT_NONE?
+                         this->d->m_hwSwFormat: codecContext->pix_fmt;
+#else
     oFrame->format = codecContext->pix_fmt;
+#endif
     oFrame->width = codecContext->width;
     oFrame->height = codecContext->height;
-    oFrame->pts = packet.pts();
-
-    QImage image = AkUtils::packetToImage(packet);
-    image = image.convertToFormat(QImage::Format_ARGB32);
-    image = this->d->swapChannels(image);
-    AkVideoPacket videoPacket(AkUtils::imageToPacket(image, packet));
+    /* In VFR mode the source timing is carried through in stream ticks.
+     * Otherwise frames with a driver capture stamp carry it through in
+     * nanoseconds, so encodeData() can timestamp from the capture time
+     * instead of regenerating from the wall clock. */
+    if (this->d->m_vfr) {
+        oFrame->pts = qRound64(packet.pts()
+                               * packet.timeBase().value()
+                               * 1000);
+    } else if (packet.hardwareTimestamp() >= 0) {
+        oFrame->pts = packet.hardwareTimestamp();
+        this->d->m_hwTimestamps = true;
+    } else {
+        oFrame->pts = packet.pts();
+    }
 
+    /* Feed the packet to swscale in its native format when FFmpeg can
+     * map it, the QImage round trip is only the fallback for formats
+     * it can't. */
+    AkVideoPacket videoPacket(packet);
     QString format = AkVideoCaps::pixelFormatToString(videoPacket.caps().format());
     AVPixelFormat iFormat = av_get_pix_fmt(format.toStdString().c_str());
+
+    if (iFormat == AV_PIX_FMT_NONE) {
+        QImage image = AkUtils::packetToImage(packet);
+        image = image.convertToFormat(QImage::Format_ARGB32);
+        image = this->d->swapChannels(image);
+        videoPacket = AkVideoPacket(AkUtils::imageToPacket(image, packet));
+        format = AkVideoCaps::pixelFormatToString(videoPacket.caps().format());
+        iFormat = av_get_pix_fmt(format.toStdString().c_str());
+    }
+
     int iWidth = videoPacket.caps().width();
     int iHeight = videoPacket.caps().height();
 
-    this->d->m_scaleContext =
-            sws_getCachedContext(this->d->m_scaleContext,
-                                 iWidth,
-                                 iHeight,
-                                 iFormat,
-                                 oFrame->width,
-                                 oFrame->height,
-                                 AVPixelFormat(oFrame->format),
-                                 SWS_FAST_BILINEAR,
-                                 nullptr,
-                                 nullptr,
-                                 nullptr);
-
-    if (!this->d->m_scaleContext)
-        return;
-
     AVFrame iFrame;
     memset(&iFrame, 0, sizeof(AVFrame));
 
@@ -273,10 +570,13 @@ void VideoStream::convertPacket(const AkPacket &packet)
                                 iWidth) < 0)
         return;
 
+    auto rawPacket = videoPacket.toPacket();
+    auto iData = reinterpret_cast<uint8_t *>(const_cast<char *>(rawPacket.constData()));
+
     if (av_image_fill_pointers(reinterpret_cast<uint8_t **>(iFrame.data),
                                iFormat,
                                iHeight,
-                               reinterpret_cast<uint8_t *>(videoPacket.buffer().data()),
+                               iData,
                                iFrame.linesize) < 0) {
         return;
     }
@@ -289,13 +589,69 @@ void VideoStream::convertPacket(const AkPacket &packet)
                        4) < 0)
         return;
 
-    sws_scale(this->d->m_scaleContext,
-              iFrame.data,
-              iFrame.linesize,
-              0,
-              iHeight,
-              oFrame->data,
-              oFrame->linesize);
+    if (iFormat == AVPixelFormat(oFrame->format)
+        && iWidth == oFrame->width
+        && iHeight == oFrame->height) {
+        // The negotiated input already matches the encoder, copy the
+        // planes without converting.
+        av_image_copy(oFrame->data,
+                      oFrame->linesize,
+                      const_cast<const uint8_t **>(reinterpret_cast<uint8_t **>(iFrame.data)),
+                      iFrame.linesize,
+                      iFormat,
+                      iWidth,
+                      iHeight);
+    } else if (iWidth == oFrame->width
+               && iHeight == oFrame->height
+               && this->d->scaleParallel(iFrame, iFormat, iHeight, oFrame)) {
+        // Pure format conversion ran split over the available cores.
+    } else {
+        this->d->m_scaleContext =
+                sws_getCachedContext(this->d->m_scaleContext,
+                                     iWidth,
+                                     iHeight,
+                                     iFormat,
+                                     oFrame->width,
+                                     oFrame->height,
+                                     AVPixelFormat(oFrame->format),
+                                     SWS_FAST_BILINEAR,
+                                     nullptr,
+                                     nullptr,
+                                     nullptr);
+
+        if (!this->d->m_scaleContext) {
+            this->deleteFrame(&oFrame);
+
+            return;
+        }
+
+        sws_scale(this->d->m_scaleContext,
+                  iFrame.data,
+                  iFrame.linesize,
+                  0,
+                  iHeight,
+                  oFrame->data,
+                  oFrame->linesize);
+    }
+
+#ifdef HAVE_HWCONTEXT
+    if (this->d->m_hwPixelFormat != AV_PIX_FMT_NONE) {
+        auto hwFrame = av_frame_alloc();
+
+        if (av_hwframe_get_buffer(codecContext->hw_frames_ctx,
+                                  hwFrame,
+                                  0) >= 0
+            && av_hwframe_transfer_data(hwFrame, oFrame, 0) >= 0) {
+            hwFrame->pts = oFrame->pts;
+            this->deleteFrame(&oFrame);
+            oFrame = hwFrame;
+        } else {
+            // Upload failed, let the encoder reject the software frame
+            // instead of stalling the pipeline.
+            av_frame_free(&hwFrame);
+        }
+    }
+#endif
 
     this->d->m_frameMutex.lock();
     this->deleteFrame(&this->d->m_frame);
@@ -317,13 +673,23 @@ int VideoStream::encodeData(AVFrame *frame)
                        codecContext->time_base.den);
 
     if (frame) {
-        qint64 pts = qRound64(QDateTime::currentMSecsSinceEpoch()
-                              / outTimeBase.value()
-                              / 1000);
+        /* VFR frames already carry their capture time in stream ticks and
+         * hardware stamped frames in nanoseconds, only the rest are
+         * stamped from the wall clock, and late: the encode time includes
+         * whatever delay the frame picked up in the pipeline. */
+        qint64 pts = this->d->m_vfr?
+                         frame->pts:
+                     this->d->m_hwTimestamps?
+                         qRound64(1e-9 * frame->pts
+                                  / outTimeBase.value()):
+                         qRound64(QDateTime::currentMSecsSinceEpoch()
+                                  / outTimeBase.value()
+                                  / 1000);
 
         if (this->d->m_refPts == AV_NOPTS_VALUE)
             this->d->m_lastPts = this->d->m_refPts = pts;
-        else if (this->d->m_lastPts != pts)
+        else if (pts > this->d->m_lastPts
+                 || (!this->d->m_vfr && pts != this->d->m_lastPts))
             this->d->m_lastPts = pts;
         else
             return AVERROR(EAGAIN);
@@ -358,9 +724,10 @@ int VideoStream::encodeData(AVFrame *frame)
     if (result == AVERROR_EOF || result == AVERROR(EAGAIN))
         return result;
     else if (result < 0) {
-        char errorStr[1024];
-        av_strerror(AVERROR(result), errorStr, 1024);
-        qDebug() << "Error encoding packets: " << errorStr;
+        AkLog::write(videoStreamLog,
+                     AkLog::LevelError,
+                     "video encoder returned error %lld",
+                     result);
 
         return result;
     }
@@ -2463,13 +2463,25 @@ void MediaWriterGStreamer::writeAudioPacket(const AkAudioPacket &packet)
     gst_caps_unref(inputCaps);
     gst_caps_unref(sourceCaps);
 
-    size_t size = size_t(packet.buffer().size());
-
-    GstBuffer *buffer = gst_buffer_new_allocate(nullptr, size, nullptr);
-    GstMapInfo info;
-    gst_buffer_map(buffer, &info, GST_MAP_WRITE);
-    memcpy(info.data, packet.buffer().constData(), size);
-    gst_buffer_unmap(buffer, &info);
+    AkPacket rawPacket = packet.toPacket();
+    size_t size = rawPacket.frameBuffer().isEmpty()?
+                      size_t(rawPacket.buffer().size()):
+                      rawPacket.frameBuffer().size();
+
+    /* Wrap the packet memory instead of copying it into a fresh
+     * allocation. The heap packet keeps the data alive until the
+     * pipeline releases the buffer. */
+    auto held = new AkPacket(rawPacket);
+    GstBuffer *buffer =
+            gst_buffer_new_wrapped_full(GST_MEMORY_FLAG_READONLY,
+                                        const_cast<char *>(held->constData()),
+                                        size,
+                                        0,
+                                        size,
+                                        held,
+                                        [] (gpointer data) {
+                                            delete static_cast<AkPacket *>(data);
+                                        });
 
     qint64 pts = qint64(packet.pts() * packet.timeBase().value() * GST_SECOND);
 
@@ -2534,13 +2546,22 @@ void MediaWriterGStreamer::writeVideoPacket(const AkVideoPacket &packet)
     gst_caps_unref(inputCaps);
     gst_caps_unref(sourceCaps);
 
-    size_t size = size_t(videoPacket.buffer().size());
-
-    GstBuffer *buffer = gst_buffer_new_allocate(nullptr, size, nullptr);
-    GstMapInfo info;
-    gst_buffer_map(buffer, &info, GST_MAP_WRITE);
-    memcpy(info.data, videoPacket.buffer().constData(), size);
-    gst_buffer_unmap(buffer, &info);
+    AkPacket rawPacket = videoPacket.toPacket();
+    size_t size = rawPacket.frameBuffer().isEmpty()?
+                      size_t(rawPacket.buffer().size()):
+                      rawPacket.frameBuffer().size();
+
+    auto held = new AkPacket(rawPacket);
+    GstBuffer *buffer =
+            gst_buffer_new_wrapped_full(GST_MEMORY_FLAG_READONLY,
+                                        const_cast<char *>(held->constData()),
+                                        size,
+                                        0,
+                                        size,
+                                        held,
+                                        [] (gpointer data) {
+                                            delete static_cast<AkPacket *>(data);
+                                        });
 
     qint64 pts = qint64(videoPacket.pts() * videoPacket.timeBase().value() * GST_SECOND);
 
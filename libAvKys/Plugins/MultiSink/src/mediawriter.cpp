@@ -26,6 +26,12 @@
 MediaWriter::MediaWriter(QObject *parent):
     QObject(parent)
 {
+    this->m_queuePolicy = "block";
+    this->m_segmentDuration = 0;
+    this->m_segmentMaxSize = 0;
+    this->m_asyncWrite = true;
+    this->m_directWrite = false;
+    this->m_crashSafe = false;
 }
 
 MediaWriter::~MediaWriter()
@@ -52,6 +58,46 @@ qint64 MediaWriter::maxPacketQueueSize() const
     return 0;
 }
 
+QString MediaWriter::queuePolicy() const
+{
+    return this->m_queuePolicy;
+}
+
+QVariantMap MediaWriter::queueStats() const
+{
+    return QVariantMap();
+}
+
+qint64 MediaWriter::segmentDuration() const
+{
+    return this->m_segmentDuration;
+}
+
+qint64 MediaWriter::segmentMaxSize() const
+{
+    return this->m_segmentMaxSize;
+}
+
+bool MediaWriter::asyncWrite() const
+{
+    return this->m_asyncWrite;
+}
+
+bool MediaWriter::directWrite() const
+{
+    return this->m_directWrite;
+}
+
+bool MediaWriter::crashSafe() const
+{
+    return this->m_crashSafe;
+}
+
+QVariantMap MediaWriter::writeStats() const
+{
+    return QVariantMap();
+}
+
 QStringList MediaWriter::formatsBlackList() const
 {
     return this->m_formatsBlackList;
@@ -202,6 +248,60 @@ void MediaWriter::setMaxPacketQueueSize(qint64 maxPacketQueueSize)
     Q_UNUSED(maxPacketQueueSize);
 }
 
+void MediaWriter::setQueuePolicy(const QString &queuePolicy)
+{
+    if (this->m_queuePolicy == queuePolicy)
+        return;
+
+    this->m_queuePolicy = queuePolicy;
+    emit this->queuePolicyChanged(queuePolicy);
+}
+
+void MediaWriter::setSegmentDuration(qint64 segmentDuration)
+{
+    if (this->m_segmentDuration == segmentDuration)
+        return;
+
+    this->m_segmentDuration = segmentDuration;
+    emit this->segmentDurationChanged(segmentDuration);
+}
+
+void MediaWriter::setSegmentMaxSize(qint64 segmentMaxSize)
+{
+    if (this->m_segmentMaxSize == segmentMaxSize)
+        return;
+
+    this->m_segmentMaxSize = segmentMaxSize;
+    emit this->segmentMaxSizeChanged(segmentMaxSize);
+}
+
+void MediaWriter::setAsyncWrite(bool asyncWrite)
+{
+    if (this->m_asyncWrite == asyncWrite)
+        return;
+
+    this->m_asyncWrite = asyncWrite;
+    emit this->asyncWriteChanged(asyncWrite);
+}
+
+void MediaWriter::setDirectWrite(bool directWrite)
+{
+    if (this->m_directWrite == directWrite)
+        return;
+
+    this->m_directWrite = directWrite;
+    emit this->directWriteChanged(directWrite);
+}
+
+void MediaWriter::setCrashSafe(bool crashSafe)
+{
+    if (this->m_crashSafe == crashSafe)
+        return;
+
+    this->m_crashSafe = crashSafe;
+    emit this->crashSafeChanged(crashSafe);
+}
+
 void MediaWriter::setFormatsBlackList(const QStringList &formatsBlackList)
 {
     if (this->m_formatsBlackList == formatsBlackList)
@@ -242,6 +342,36 @@ void MediaWriter::resetMaxPacketQueueSize()
 {
 }
 
+void MediaWriter::resetQueuePolicy()
+{
+    this->setQueuePolicy("block");
+}
+
+void MediaWriter::resetSegmentDuration()
+{
+    this->setSegmentDuration(0);
+}
+
+void MediaWriter::resetSegmentMaxSize()
+{
+    this->setSegmentMaxSize(0);
+}
+
+void MediaWriter::resetAsyncWrite()
+{
+    this->setAsyncWrite(true);
+}
+
+void MediaWriter::resetDirectWrite()
+{
+    this->setDirectWrite(false);
+}
+
+void MediaWriter::resetCrashSafe()
+{
+    this->setCrashSafe(false);
+}
+
 void MediaWriter::resetFormatsBlackList()
 {
     this->setFormatsBlackList({});
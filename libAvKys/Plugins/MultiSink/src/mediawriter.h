@@ -46,6 +46,45 @@ class MediaWriter: public QObject
                WRITE setMaxPacketQueueSize
                RESET resetMaxPacketQueueSize
                NOTIFY maxPacketQueueSizeChanged)
+    Q_PROPERTY(QString queuePolicy
+               READ queuePolicy
+               WRITE setQueuePolicy
+               RESET resetQueuePolicy
+               NOTIFY queuePolicyChanged)
+    // Start a new output file after this many seconds, 0 disables rotation.
+    Q_PROPERTY(qint64 segmentDuration
+               READ segmentDuration
+               WRITE setSegmentDuration
+               RESET resetSegmentDuration
+               NOTIFY segmentDurationChanged)
+    // Start a new output file after this many bytes, 0 disables rotation.
+    Q_PROPERTY(qint64 segmentMaxSize
+               READ segmentMaxSize
+               WRITE setSegmentMaxSize
+               RESET resetSegmentMaxSize
+               NOTIFY segmentMaxSizeChanged)
+    // Buffer muxed packets in memory and flush them from a dedicated I/O
+    // thread, so a slow or contended disk doesn't stall the encoders.
+    Q_PROPERTY(bool asyncWrite
+               READ asyncWrite
+               WRITE setAsyncWrite
+               RESET resetAsyncWrite
+               NOTIFY asyncWriteChanged)
+    // Bypass the page cache on drives dedicated to recording. Only
+    // honored together with asyncWrite, on platforms that support it.
+    Q_PROPERTY(bool directWrite
+               READ directWrite
+               WRITE setDirectWrite
+               RESET resetDirectWrite
+               NOTIFY directWriteChanged)
+    // Use crash tolerant container settings (fragmented MP4, short
+    // Matroska clusters), so a crash or power loss only costs the last
+    // few seconds instead of the whole recording.
+    Q_PROPERTY(bool crashSafe
+               READ crashSafe
+               WRITE setCrashSafe
+               RESET resetCrashSafe
+               NOTIFY crashSafeChanged)
     Q_PROPERTY(QStringList formatsBlackList
                READ formatsBlackList
                WRITE setFormatsBlackList
@@ -65,6 +104,14 @@ class MediaWriter: public QObject
         Q_INVOKABLE virtual QString outputFormat() const;
         Q_INVOKABLE virtual QVariantList streams() const;
         Q_INVOKABLE virtual qint64 maxPacketQueueSize() const;
+        Q_INVOKABLE virtual QString queuePolicy() const;
+        Q_INVOKABLE virtual QVariantMap queueStats() const;
+        Q_INVOKABLE virtual qint64 segmentDuration() const;
+        Q_INVOKABLE virtual qint64 segmentMaxSize() const;
+        Q_INVOKABLE virtual bool asyncWrite() const;
+        Q_INVOKABLE virtual bool directWrite() const;
+        Q_INVOKABLE virtual bool crashSafe() const;
+        Q_INVOKABLE virtual QVariantMap writeStats() const;
         Q_INVOKABLE virtual QStringList formatsBlackList() const;
         Q_INVOKABLE virtual QStringList codecsBlackList() const;
 
@@ -92,6 +139,12 @@ class MediaWriter: public QObject
 
     protected:
         QString m_location;
+        QString m_queuePolicy;
+        qint64 m_segmentDuration;
+        qint64 m_segmentMaxSize;
+        bool m_asyncWrite;
+        bool m_directWrite;
+        bool m_crashSafe;
         QStringList m_formatsBlackList;
         QStringList m_codecsBlackList;
 
@@ -103,6 +156,12 @@ class MediaWriter: public QObject
                                  const QVariantMap &codecOptions);
         void streamsChanged(const QVariantList &streams);
         void maxPacketQueueSizeChanged(qint64 maxPacketQueueSize);
+        void queuePolicyChanged(const QString &queuePolicy);
+        void segmentDurationChanged(qint64 segmentDuration);
+        void segmentMaxSizeChanged(qint64 segmentMaxSize);
+        void asyncWriteChanged(bool asyncWrite);
+        void directWriteChanged(bool directWrite);
+        void crashSafeChanged(bool crashSafe);
         void formatsBlackListChanged(const QStringList &formatsBlackList);
         void codecsBlackListChanged(const QStringList &codecsBlackList);
 
@@ -112,6 +171,12 @@ class MediaWriter: public QObject
         virtual void setFormatOptions(const QVariantMap &formatOptions);
         virtual void setCodecOptions(int index, const QVariantMap &codecOptions);
         virtual void setMaxPacketQueueSize(qint64 maxPacketQueueSize);
+        virtual void setQueuePolicy(const QString &queuePolicy);
+        virtual void setSegmentDuration(qint64 segmentDuration);
+        virtual void setSegmentMaxSize(qint64 segmentMaxSize);
+        virtual void setAsyncWrite(bool asyncWrite);
+        virtual void setDirectWrite(bool directWrite);
+        virtual void setCrashSafe(bool crashSafe);
         virtual void setFormatsBlackList(const QStringList &formatsBlackList);
         virtual void setCodecsBlackList(const QStringList &codecsBlackList);
         virtual void resetLocation();
@@ -119,6 +184,12 @@ class MediaWriter: public QObject
         virtual void resetFormatOptions();
         virtual void resetCodecOptions(int index);
         virtual void resetMaxPacketQueueSize();
+        virtual void resetQueuePolicy();
+        virtual void resetSegmentDuration();
+        virtual void resetSegmentMaxSize();
+        virtual void resetAsyncWrite();
+        virtual void resetDirectWrite();
+        virtual void resetCrashSafe();
         virtual void resetFormatsBlackList();
         virtual void resetCodecsBlackList();
         virtual void enqueuePacket(const AkPacket &packet);
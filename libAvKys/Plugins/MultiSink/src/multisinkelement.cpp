@@ -131,6 +131,14 @@ QVariantMap MultiSinkElement::userControlsValues() const
     return this->d->m_userControlsValues;
 }
 
+bool MultiSinkElement::crashSafe() const
+{
+    if (!this->d->m_mediaWriter)
+        return false;
+
+    return this->d->m_mediaWriter->crashSafe();
+}
+
 QStringList MultiSinkElement::formatsBlackList() const
 {
     if (!this->d->m_mediaWriter)
@@ -310,6 +318,12 @@ void MultiSinkElement::setUserControlsValues(const QVariantMap &userControlsValu
     emit this->userControlsValuesChanged(userControlsValues);
 }
 
+void MultiSinkElement::setCrashSafe(bool crashSafe)
+{
+    if (this->d->m_mediaWriter)
+        this->d->m_mediaWriter->setCrashSafe(crashSafe);
+}
+
 void MultiSinkElement::setFormatsBlackList(const QStringList &formatsBlackList)
 {
     if (this->d->m_mediaWriter)
@@ -365,6 +379,12 @@ void MultiSinkElement::resetUserControlsValues()
     this->setUserControlsValues({});
 }
 
+void MultiSinkElement::resetCrashSafe()
+{
+    if (this->d->m_mediaWriter)
+        this->d->m_mediaWriter->resetCrashSafe();
+}
+
 void MultiSinkElement::resetFormatsBlackList()
 {
     if (this->d->m_mediaWriter)
@@ -479,6 +499,10 @@ void MultiSinkElement::codecLibUpdated(const QString &codecLib)
                      &MediaWriter::streamsChanged,
                      this,
                      &MultiSinkElement::streamsChanged);
+    QObject::connect(this->d->m_mediaWriter.data(),
+                     &MediaWriter::crashSafeChanged,
+                     this,
+                     &MultiSinkElement::crashSafeChanged);
     QObject::connect(this->d->m_mediaWriter.data(),
                      &MediaWriter::formatsBlackListChanged,
                      this,
@@ -65,6 +65,13 @@ class MultiSinkElement: public AkElement
                WRITE setUserControlsValues
                RESET resetUserControlsValues
                NOTIFY userControlsValuesChanged)
+    // Record with crash tolerant container settings, so a crash or power
+    // loss only costs the last few seconds of the file.
+    Q_PROPERTY(bool crashSafe
+               READ crashSafe
+               WRITE setCrashSafe
+               RESET resetCrashSafe
+               NOTIFY crashSafeChanged)
     Q_PROPERTY(QStringList formatsBlackList
                READ formatsBlackList
                WRITE setFormatsBlackList
@@ -88,6 +95,7 @@ class MultiSinkElement: public AkElement
         Q_INVOKABLE bool showFormatOptions() const;
         Q_INVOKABLE QVariantList userControls() const;
         Q_INVOKABLE QVariantMap userControlsValues() const;
+        Q_INVOKABLE bool crashSafe() const;
         Q_INVOKABLE QStringList formatsBlackList() const;
         Q_INVOKABLE QStringList codecsBlackList() const;
         Q_INVOKABLE QStringList fileExtensions(const QString &format) const;
@@ -127,6 +135,7 @@ class MultiSinkElement: public AkElement
         void showFormatOptionsChanged(bool showFormatOptions);
         void userControlsChanged(const QVariantList &userControls);
         void userControlsValuesChanged(const QVariantMap &userControlsValues);
+        void crashSafeChanged(bool crashSafe);
         void formatsBlackListChanged(const QStringList &formatsBlackList);
         void codecsBlackListChanged(const QStringList &codecsBlackList);
 
@@ -139,6 +148,7 @@ class MultiSinkElement: public AkElement
         void setShowFormatOptions(bool showFormatOptions);
         void setUserControls(const QVariantList &userControls);
         void setUserControlsValues(const QVariantMap &userControlsValues);
+        void setCrashSafe(bool crashSafe);
         void setFormatsBlackList(const QStringList &formatsBlackList);
         void setCodecsBlackList(const QStringList &codecsBlackList);
         void resetLocation();
@@ -149,6 +159,7 @@ class MultiSinkElement: public AkElement
         void resetShowFormatOptions();
         void resetUserControls();
         void resetUserControlsValues();
+        void resetCrashSafe();
         void resetFormatsBlackList();
         void resetCodecsBlackList();
         void clearStreams();
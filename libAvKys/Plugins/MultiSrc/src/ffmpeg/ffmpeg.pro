@@ -73,6 +73,8 @@ CONFIG(config_ffmpeg_avformat_codecpar): \
     DEFINES += HAVE_CODECPAR
 CONFIG(config_ffmpeg_avutil_framealloc): \
     DEFINES += HAVE_FRAMEALLOC
+CONFIG(config_ffmpeg_avutil_hwcontext): \
+    DEFINES += HAVE_HWCONTEXT
 CONFIG(config_ffmpeg_avutil_sampleformat64): \
     DEFINES += HAVE_SAMPLEFORMAT64
 
@@ -300,6 +300,11 @@ qint64 AbstractStream::queueSize()
     return this->d->m_packetQueueSize;
 }
 
+int AbstractStream::packetsQueued()
+{
+    return this->d->m_packets.size();
+}
+
 Clock *AbstractStream::globalClock()
 {
     return this->d->m_globalClock;
@@ -523,6 +528,36 @@ bool AbstractStream::init()
     return true;
 }
 
+void AbstractStream::restart()
+{
+    /* Both loops stopped themselves when the EOF marker crossed the queues,
+     * wait for them and then start a fresh run reusing the already open
+     * codec context.
+     */
+    waitLoop(this->d->m_packetLoopResult);
+    waitLoop(this->d->m_dataLoopResult);
+
+    this->d->m_packets.clear();
+    this->d->m_frames.clear();
+    this->d->m_subtitles.clear();
+    this->d->m_packetQueueSize = 0;
+
+    if (this->d->m_codecContext)
+        avcodec_flush_buffers(this->d->m_codecContext);
+
+    this->m_clockDiff = 0;
+    this->d->m_runPacketLoop = true;
+    this->d->m_runDataLoop = true;
+    this->d->m_packetLoopResult =
+            QtConcurrent::run(&this->d->m_threadPool,
+                              this->d,
+                              &AbstractStreamPrivate::packetLoop);
+    this->d->m_dataLoopResult =
+            QtConcurrent::run(&this->d->m_threadPool,
+                              this->d,
+                              &AbstractStreamPrivate::dataLoop);
+}
+
 void AbstractStream::uninit()
 {
     this->d->m_runPacketLoop = false;
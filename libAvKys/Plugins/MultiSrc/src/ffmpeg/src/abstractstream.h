@@ -71,6 +71,7 @@ class AbstractStream: public QObject
         Q_INVOKABLE void dataEnqueue(AVFrame *frame);
         Q_INVOKABLE void subtitleEnqueue(AVSubtitle *subtitle);
         Q_INVOKABLE qint64 queueSize();
+        Q_INVOKABLE int packetsQueued();
         Q_INVOKABLE Clock *globalClock();
         Q_INVOKABLE qreal clockDiff() const;
         Q_INVOKABLE qreal &clockDiff();
@@ -103,6 +104,7 @@ class AbstractStream: public QObject
         void resetPaused();
         virtual bool init();
         virtual void uninit();
+        void restart();
 
         friend class AbstractStreamPrivate;
 };
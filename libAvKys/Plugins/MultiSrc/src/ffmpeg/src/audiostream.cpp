@@ -409,6 +409,11 @@ AkPacket AudioStreamPrivate::convert(AVFrame *iFrame)
 AVFrame *AudioStreamPrivate::copyFrame(AVFrame *frame) const
 {
 #ifdef HAVE_FRAMEALLOC
+    // Share the decoder's reference counted buffers instead of
+    // duplicating the samples.
+    if (frame->buf[0])
+        return av_frame_clone(frame);
+
     auto oFrame = av_frame_alloc();
 #else
     auto oFrame = avcodec_alloc_frame();
@@ -18,8 +18,15 @@
  */
 
 #include <QApplication>
+#include <QCryptographicHash>
 #include <QDesktopWidget>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
 #include <QFileInfo>
+#include <QImage>
+#include <QStandardPaths>
+#include <QTimer>
 #include <QtConcurrent>
 #include <QThreadPool>
 #include <QMutex>
@@ -29,6 +36,11 @@
 #include <ak.h>
 #include <akcaps.h>
 
+extern "C"
+{
+    #include <libswscale/swscale.h>
+}
+
 #include "mediasourceffmpeg.h"
 #include "videostream.h"
 #include "audiostream.h"
@@ -56,6 +68,26 @@ inline AvMediaTypeStrMap initAvMediaTypeStrMap()
 
 Q_GLOBAL_STATIC_WITH_ARGS(AvMediaTypeStrMap, mediaTypeToStr, (initAvMediaTypeStrMap()))
 
+// Minimum number of packets every stream should keep queued before the
+// demuxer is allowed to block on the aggregate queue bound.
+#define MIN_STREAM_PACKETS 25
+
+// Milliseconds between reconnection attempts while a network source stays
+// unreachable.
+#define RECONNECT_WAIT 3000
+
+// Seconds of compressed packets kept per stream for splicing at the loop
+// point, enough to cover a typical first GOP.
+#define PREROLL_DURATION 1.0
+
+// Height of the scrubbing thumbnails; the width follows the media aspect.
+#define THUMBNAIL_HEIGHT 90
+
+// Upper bound on thumbnails per media, one every THUMBNAIL_MIN_STEP
+// seconds until that would exceed the bound.
+#define THUMBNAIL_MAX_COUNT 100
+#define THUMBNAIL_MIN_STEP 5.0
+
 class MediaSourceFFmpegPrivate
 {
     public:
@@ -76,6 +108,47 @@ class MediaSourceFFmpegPrivate
         Clock m_globalClock;
         qreal m_curClockTime;
         QFuture<void> m_readPacketsLoopResult;
+        int m_eofCount;
+        int m_codecThreads;
+        bool m_lowLatency;
+        bool m_networked;
+        int m_jitterBufferPackets;
+        int m_stallTimeout;
+        AkElement::ElementState m_reconnectState;
+        QElapsedTimer m_readTimer;
+
+        /* Opening and probing runs on the pool so an unreachable network
+         * source can't block the caller for the connect timeout. The abort
+         * flag is polled by the interrupt callback, so a cancellation
+         * breaks even a blocked connect almost immediately. */
+        QFuture<void> m_openResult;
+        QAtomicInt m_abortOpen;
+        bool m_opening;
+        AkElement::ElementState m_openTarget;
+
+        /* Preroll cache for gapless looping. While the first lap plays, the
+         * read loop keeps a copy of the first PREROLL_DURATION seconds of
+         * compressed packets per stream; doLoop() feeds them straight back
+         * to the decoders at the loop point so the rewind seek happens while
+         * those frames already play. See cachePrerollPacket(). */
+        bool m_prerollCaching;
+        QMap<int, QVector<AVPacket *>> m_prerollCache;
+        QMap<int, qint64> m_prerollStart;
+        QMap<int, qint64> m_prerollEnd;
+        QSet<int> m_prerollDone;
+        QSet<int> m_skipPreroll;
+
+        /* Thumbnail index for scrubbing, generated once per local media
+         * from an independent demuxer and decoder so playback never
+         * notices, and cached on disk so the next open just reloads it.
+         * Runs on its own pool because m_threadPool is drained on every
+         * stop. */
+        QThreadPool m_thumbnailThreadPool;
+        QFuture<void> m_thumbnailsResult;
+        QAtomicInt m_abortThumbnails;
+        mutable QMutex m_thumbnailsMutex;
+        QVariantList m_thumbnails;
+        QString m_thumbnailsMedia;
 
         MediaSourceFFmpegPrivate(MediaSourceFFmpeg *self):
             self(self),
@@ -84,16 +157,36 @@ class MediaSourceFFmpegPrivate
             m_curState(AkElement::ElementStateNull),
             m_maxPacketQueueSize(15 * 1024 * 1024),
             m_showLog(false),
-            m_curClockTime(0.0)
+            m_curClockTime(0.0),
+            m_eofCount(0),
+            m_codecThreads(0),
+            m_lowLatency(false),
+            m_networked(false),
+            m_jitterBufferPackets(0),
+            m_stallTimeout(5000),
+            m_reconnectState(AkElement::ElementStateNull),
+            m_prerollCaching(false),
+            m_opening(false),
+            m_openTarget(AkElement::ElementStateNull)
         {
         }
 
         inline qint64 packetQueueSize();
+        inline bool streamStarving();
         inline static void deleteFormatContext(AVFormatContext *context);
         inline AbstractStreamPtr createStream(int index, bool noModify=false);
         inline void readPackets();
+        inline AVPacket *clonePacket(const AVPacket *packet) const;
+        inline void cachePrerollPacket(const AVPacket *packet);
+        inline bool dropPrerollDup(const AVPacket *packet);
+        inline void clearPrerollCache();
         inline void unlockQueue();
         inline int roundDown(int value, int multiply);
+        inline static int interruptCallback(void *opaque);
+        inline QString thumbnailCacheDir() const;
+        inline bool loadThumbnailIndex(const QString &cacheDir);
+        inline void startThumbnails();
+        inline void generateThumbnails();
 };
 
 MediaSourceFFmpeg::MediaSourceFFmpeg(QObject *parent):
@@ -108,13 +201,16 @@ MediaSourceFFmpeg::MediaSourceFFmpeg(QObject *parent):
     av_log_set_level(AV_LOG_QUIET);
 #endif
 
-    if (this->d->m_threadPool.maxThreadCount() < 2)
-        this->d->m_threadPool.setMaxThreadCount(2);
+    // Demuxing, looping and background opening can overlap.
+    if (this->d->m_threadPool.maxThreadCount() < 3)
+        this->d->m_threadPool.setMaxThreadCount(3);
 }
 
 MediaSourceFFmpeg::~MediaSourceFFmpeg()
 {
     this->setState(AkElement::ElementStateNull);
+    this->d->m_abortThumbnails.store(1);
+    this->d->m_thumbnailsResult.waitForFinished();
     delete this->d;
 }
 
@@ -287,6 +383,38 @@ bool MediaSourceFFmpeg::showLog() const
     return this->d->m_showLog;
 }
 
+int MediaSourceFFmpeg::codecThreads() const
+{
+    return this->d->m_codecThreads;
+}
+
+bool MediaSourceFFmpeg::lowLatency() const
+{
+    return this->d->m_lowLatency;
+}
+
+int MediaSourceFFmpeg::jitterBufferPackets() const
+{
+    return this->d->m_jitterBufferPackets;
+}
+
+int MediaSourceFFmpeg::stallTimeout() const
+{
+    return this->d->m_stallTimeout;
+}
+
+QVariantList MediaSourceFFmpeg::thumbnails() const
+{
+    QMutexLocker locker(&this->d->m_thumbnailsMutex);
+
+    return this->d->m_thumbnails;
+}
+
+bool MediaSourceFFmpeg::opening() const
+{
+    return this->d->m_opening;
+}
+
 qint64 MediaSourceFFmpegPrivate::packetQueueSize()
 {
     qint64 size = 0;
@@ -297,6 +425,15 @@ qint64 MediaSourceFFmpegPrivate::packetQueueSize()
     return size;
 }
 
+bool MediaSourceFFmpegPrivate::streamStarving()
+{
+    for (const AbstractStreamPtr &stream: this->m_streamsMap.values())
+        if (stream->packetsQueued() < MIN_STREAM_PACKETS)
+            return true;
+
+    return false;
+}
+
 void MediaSourceFFmpegPrivate::deleteFormatContext(AVFormatContext *context)
 {
     avformat_close_input(&context);
@@ -330,6 +467,24 @@ AbstractStreamPtr MediaSourceFFmpegPrivate::createStream(int index,
                                                       &this->m_globalClock,
                                                       noModify));
 
+    // Codec threading must be configured before the codec is opened in
+    // AbstractStream::init().
+    auto codecContext = stream->codecContext();
+
+    if (codecContext && !noModify) {
+        codecContext->thread_count = qMax(this->m_codecThreads, 0);
+
+        if (this->m_lowLatency) {
+            /* Frame threading queues one input frame per worker before the
+             * first picture comes back, adding a full frame of latency per
+             * thread. For live sources prefer slice threading plus low
+             * delay decoding, which keep per frame latency flat.
+             */
+            codecContext->thread_type = FF_THREAD_SLICE;
+            codecContext->flags |= CODEC_FLAG_LOW_DELAY;
+        }
+    }
+
     return stream;
 }
 
@@ -338,7 +493,12 @@ void MediaSourceFFmpegPrivate::readPackets()
     while (this->m_run) {
         this->m_dataMutex.lock();
 
-        if (this->packetQueueSize() >= this->m_maxPacketQueueSize)
+        /* Keep demuxing while any selected stream is about to run dry, even
+         * if that overshoots the aggregate queue bound: a slow video decode
+         * holding a full queue must not halt audio delivery.
+         */
+        if (this->packetQueueSize() >= this->m_maxPacketQueueSize
+            && !this->streamStarving())
             if (!this->m_packetQueueNotFull.wait(&this->m_dataMutex, THREAD_WAIT_LIMIT)) {
                 this->m_dataMutex.unlock();
 
@@ -348,12 +508,15 @@ void MediaSourceFFmpegPrivate::readPackets()
         AVPacket *packet = new AVPacket();
         av_init_packet(packet);
         bool notuse = true;
+        this->m_readTimer.restart();
         int r = av_read_frame(this->m_inputContext.data(), packet);
 
         if (r >= 0) {
             if (this->m_streamsMap.contains(packet->stream_index)
                 && (this->m_streams.isEmpty()
-                    || this->m_streams.contains(packet->stream_index))) {
+                    || this->m_streams.contains(packet->stream_index))
+                && !this->dropPrerollDup(packet)) {
+                this->cachePrerollPacket(packet);
                 this->m_streamsMap[packet->stream_index]->packetEnqueue(packet);
                 notuse = false;
             }
@@ -369,7 +532,16 @@ void MediaSourceFFmpegPrivate::readPackets()
         }
 
         if (r < 0) {
-            if (self->loop()) {
+            if (this->m_networked
+                && this->m_curState != AkElement::ElementStateNull) {
+                /* A stalled or dropped connection must not freeze the
+                 * pipeline, schedule a reconnection on the element thread
+                 * instead of reporting end of stream. */
+                this->m_reconnectState = this->m_curState;
+                QMetaObject::invokeMethod(self,
+                                          "reconnect",
+                                          Qt::QueuedConnection);
+            } else if (self->loop()) {
                 for (const AbstractStreamPtr &stream: this->m_streamsMap.values())
                     stream->packetEnqueue(nullptr);
             }
@@ -381,11 +553,94 @@ void MediaSourceFFmpegPrivate::readPackets()
     }
 }
 
+AVPacket *MediaSourceFFmpegPrivate::clonePacket(const AVPacket *packet) const
+{
+    auto clone = new AVPacket();
+    av_init_packet(clone);
+
+#ifdef HAVE_PACKETREF
+    av_packet_ref(clone, packet);
+#else
+    av_copy_packet(clone, const_cast<AVPacket *>(packet));
+#endif
+
+    return clone;
+}
+
+void MediaSourceFFmpegPrivate::cachePrerollPacket(const AVPacket *packet)
+{
+    if (!this->m_prerollCaching)
+        return;
+
+    auto dts = packet->dts != AV_NOPTS_VALUE? packet->dts: packet->pts;
+
+    if (dts == AV_NOPTS_VALUE)
+        return;
+
+    int index = packet->stream_index;
+
+    if (!this->m_prerollStart.contains(index))
+        this->m_prerollStart[index] = dts;
+
+    auto timeBase = this->m_inputContext->streams[index]->time_base;
+
+    if (qreal(dts - this->m_prerollStart[index]) * av_q2d(timeBase)
+        >= PREROLL_DURATION) {
+        this->m_prerollDone << index;
+
+        if (this->m_prerollDone.size() >= this->m_streamsMap.size())
+            this->m_prerollCaching = false;
+
+        return;
+    }
+
+    this->m_prerollCache[index] << this->clonePacket(packet);
+    this->m_prerollEnd[index] = dts;
+}
+
+bool MediaSourceFFmpegPrivate::dropPrerollDup(const AVPacket *packet)
+{
+    int index = packet->stream_index;
+
+    if (!this->m_skipPreroll.contains(index))
+        return false;
+
+    auto dts = packet->dts != AV_NOPTS_VALUE? packet->dts: packet->pts;
+
+    if (dts != AV_NOPTS_VALUE && dts <= this->m_prerollEnd.value(index))
+        return true;
+
+    this->m_skipPreroll.remove(index);
+
+    return false;
+}
+
+void MediaSourceFFmpegPrivate::clearPrerollCache()
+{
+    for (auto &packets: this->m_prerollCache)
+        for (auto &packet: packets) {
+#ifdef HAVE_PACKETREF
+            av_packet_unref(packet);
+#else
+            av_destruct_packet(packet);
+#endif
+            delete packet;
+        }
+
+    this->m_prerollCache.clear();
+    this->m_prerollStart.clear();
+    this->m_prerollEnd.clear();
+    this->m_prerollDone.clear();
+    this->m_skipPreroll.clear();
+    this->m_prerollCaching = false;
+}
+
 void MediaSourceFFmpegPrivate::unlockQueue()
 {
     this->m_dataMutex.lock();
 
-    if (this->packetQueueSize() < this->m_maxPacketQueueSize)
+    if (this->packetQueueSize() < this->m_maxPacketQueueSize
+        || this->streamStarving())
         this->m_packetQueueNotFull.wakeAll();
 
     if (this->packetQueueSize() < 1)
@@ -399,6 +654,323 @@ int MediaSourceFFmpegPrivate::roundDown(int value, int multiply)
     return value - value % multiply;
 }
 
+int MediaSourceFFmpegPrivate::interruptCallback(void *opaque)
+{
+    auto stream = static_cast<MediaSourceFFmpegPrivate *>(opaque);
+
+    // A cancelled open breaks out of any blocked I/O right away.
+    if (stream->m_abortOpen.load())
+        return 1;
+
+    if (!stream->m_networked || stream->m_stallTimeout < 1)
+        return 0;
+
+    /* Break a blocked network read once it stalls past the timeout, the
+     * read loop then triggers a reconnection. Opening and probing gets a
+     * longer leash since the timer isn't restarted while it runs. */
+    int timeout = stream->m_run?
+                      stream->m_stallTimeout: 3 * stream->m_stallTimeout;
+
+    if (stream->m_readTimer.isValid()
+        && stream->m_readTimer.elapsed() > timeout)
+        return 1;
+
+    return 0;
+}
+
+/* Cache directory of the current media, keyed by path, size and
+ * modification time so an edited file gets a fresh index. Empty for
+ * anything that is not a local file. */
+QString MediaSourceFFmpegPrivate::thumbnailCacheDir() const
+{
+    QString path = this->m_media;
+
+    if (path.startsWith("file://"))
+        path.remove(0, 7);
+
+    QFileInfo info(path);
+
+    if (!info.isFile())
+        return QString();
+
+    QByteArray key = info.absoluteFilePath().toUtf8()
+                     + QByteArray::number(info.size())
+                     + QByteArray::number(info.lastModified().toMSecsSinceEpoch());
+    auto hash = QCryptographicHash::hash(key, QCryptographicHash::Md5).toHex();
+
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+           + "/thumbnails/"
+           + QString(hash);
+}
+
+/* Reload a previously generated index: one "<msecs> <fileName>" line per
+ * thumbnail. Returns false if there is none, the caller then decodes. */
+bool MediaSourceFFmpegPrivate::loadThumbnailIndex(const QString &cacheDir)
+{
+    QFile indexFile(cacheDir + "/index");
+
+    if (!indexFile.open(QIODevice::ReadOnly | QIODevice::Text))
+        return false;
+
+    QVariantList thumbnails;
+
+    while (!indexFile.atEnd()) {
+        auto line = QString(indexFile.readLine()).trimmed();
+        int space = line.indexOf(' ');
+
+        if (space < 1)
+            continue;
+
+        QVariantMap entry {
+            {"time"     , line.left(space).toLongLong() / 1.e3},
+            {"thumbnail", cacheDir + "/" + line.mid(space + 1)}
+        };
+        thumbnails << entry;
+    }
+
+    indexFile.close();
+
+    if (thumbnails.isEmpty())
+        return false;
+
+    this->m_thumbnailsMutex.lock();
+    this->m_thumbnails = thumbnails;
+    this->m_thumbnailsMutex.unlock();
+    emit this->self->thumbnailsChanged(thumbnails);
+
+    return true;
+}
+
+void MediaSourceFFmpegPrivate::startThumbnails()
+{
+    // The index, or a generation already in flight, is current.
+    if (this->m_thumbnailsMedia == this->m_media)
+        return;
+
+    this->m_abortThumbnails.store(1);
+    this->m_thumbnailsResult.waitForFinished();
+    this->m_abortThumbnails.store(0);
+
+    this->m_thumbnailsMutex.lock();
+    this->m_thumbnails.clear();
+    this->m_thumbnailsMutex.unlock();
+    this->m_thumbnailsMedia = this->m_media;
+
+    auto cacheDir = this->thumbnailCacheDir();
+
+    if (cacheDir.isEmpty())
+        return;
+
+    // A disk cache hit skips the decoding entirely.
+    if (this->loadThumbnailIndex(cacheDir))
+        return;
+
+    this->m_thumbnailsResult =
+            QtConcurrent::run(&this->m_thumbnailThreadPool,
+                              this,
+                              &MediaSourceFFmpegPrivate::generateThumbnails);
+}
+
+/* Background thumbnail decoding. Every target position seeks to the
+ * preceding keyframe and decodes just that frame at thumbnail resolution,
+ * so a whole index costs a few seconds of one core even for long media. */
+void MediaSourceFFmpegPrivate::generateThumbnails()
+{
+    QString uri = this->m_thumbnailsMedia;
+
+    if (uri.startsWith("file://"))
+        uri.remove(0, 7);
+
+    AVFormatContext *context = nullptr;
+
+    if (avformat_open_input(&context,
+                            uri.toStdString().c_str(),
+                            nullptr,
+                            nullptr) < 0)
+        return;
+
+    if (avformat_find_stream_info(context, nullptr) < 0) {
+        avformat_close_input(&context);
+
+        return;
+    }
+
+    int videoIndex = av_find_best_stream(context,
+                                         AVMEDIA_TYPE_VIDEO,
+                                         -1,
+                                         -1,
+                                         nullptr,
+                                         0);
+
+    if (videoIndex < 0) {
+        avformat_close_input(&context);
+
+        return;
+    }
+
+    auto stream = context->streams[videoIndex];
+    auto codecContext = avcodec_alloc_context3(nullptr);
+
+#ifdef HAVE_CODECPAR
+    int copied = avcodec_parameters_to_context(codecContext,
+                                               stream->codecpar);
+#else
+    int copied = avcodec_copy_context(codecContext, stream->codec);
+#endif
+
+    auto codec = copied >= 0?
+                     avcodec_find_decoder(codecContext->codec_id): nullptr;
+
+    if (!codec || avcodec_open2(codecContext, codec, nullptr) < 0) {
+#ifdef HAVE_FREECONTEXT
+        avcodec_free_context(&codecContext);
+#else
+        avcodec_close(codecContext);
+        av_free(codecContext);
+#endif
+        avformat_close_input(&context);
+
+        return;
+    }
+
+    qreal duration = context->duration != AV_NOPTS_VALUE?
+                         context->duration / qreal(AV_TIME_BASE): 0.;
+    qreal step = qMax(THUMBNAIL_MIN_STEP, duration / THUMBNAIL_MAX_COUNT);
+    int count = qMax(1, int(duration / step));
+    auto startTime = context->start_time != AV_NOPTS_VALUE?
+                         context->start_time: 0;
+
+    auto cacheDir = this->thumbnailCacheDir();
+    QDir().mkpath(cacheDir);
+
+    QStringList indexLines;
+    QVariantList thumbnails;
+    auto frame = av_frame_alloc();
+    SwsContext *scaleContext = nullptr;
+    bool aborted = false;
+
+    for (int i = 0; i < count; i++) {
+        if (this->m_abortThumbnails.load()) {
+            aborted = true;
+
+            break;
+        }
+
+        qreal time = i * step;
+
+        if (av_seek_frame(context,
+                          -1,
+                          startTime + qint64(time * AV_TIME_BASE),
+                          AVSEEK_FLAG_BACKWARD) < 0)
+            continue;
+
+        avcodec_flush_buffers(codecContext);
+
+        AVPacket packet;
+        av_init_packet(&packet);
+        bool gotFrame = false;
+
+        while (!gotFrame && av_read_frame(context, &packet) >= 0) {
+            if (packet.stream_index == videoIndex) {
+#ifdef HAVE_SENDRECV
+                if (avcodec_send_packet(codecContext, &packet) >= 0
+                    && avcodec_receive_frame(codecContext, frame) >= 0)
+                    gotFrame = true;
+#else
+                int decoded = 0;
+                avcodec_decode_video2(codecContext,
+                                      frame,
+                                      &decoded,
+                                      &packet);
+                gotFrame = decoded != 0;
+#endif
+            }
+
+            av_packet_unref(&packet);
+        }
+
+        if (!gotFrame || frame->width < 1 || frame->height < 1)
+            continue;
+
+        int width =
+                qMax(2,
+                     frame->width * THUMBNAIL_HEIGHT / frame->height & ~1);
+        QImage thumbnail(width, THUMBNAIL_HEIGHT, QImage::Format_RGB32);
+        uint8_t *dstData[] = {thumbnail.bits(), nullptr, nullptr, nullptr};
+        int dstLinesize[] = {int(thumbnail.bytesPerLine()), 0, 0, 0};
+
+        scaleContext =
+                sws_getCachedContext(scaleContext,
+                                     frame->width,
+                                     frame->height,
+                                     AVPixelFormat(frame->format),
+                                     width,
+                                     THUMBNAIL_HEIGHT,
+                                     AV_PIX_FMT_RGB32,
+                                     SWS_FAST_BILINEAR,
+                                     nullptr,
+                                     nullptr,
+                                     nullptr);
+
+        if (!scaleContext)
+            continue;
+
+        sws_scale(scaleContext,
+                  frame->data,
+                  frame->linesize,
+                  0,
+                  frame->height,
+                  dstData,
+                  dstLinesize);
+
+        auto msecs = qint64(1.e3 * time);
+        auto fileName = QString("%1.jpg").arg(msecs, 9, 10, QChar('0'));
+
+        if (!thumbnail.save(cacheDir + "/" + fileName, "JPG"))
+            continue;
+
+        indexLines << QString("%1 %2").arg(msecs).arg(fileName);
+        QVariantMap entry {
+            {"time"     , time                     },
+            {"thumbnail", cacheDir + "/" + fileName}
+        };
+        thumbnails << entry;
+    }
+
+    if (scaleContext)
+        sws_freeContext(scaleContext);
+
+    av_frame_free(&frame);
+
+#ifdef HAVE_FREECONTEXT
+    avcodec_free_context(&codecContext);
+#else
+    avcodec_close(codecContext);
+    av_free(codecContext);
+#endif
+
+    avformat_close_input(&context);
+
+    if (aborted || thumbnails.isEmpty()) {
+        // An incomplete index is worse than none, regenerate next time.
+        QDir(cacheDir).removeRecursively();
+
+        return;
+    }
+
+    QFile indexFile(cacheDir + "/index");
+
+    if (indexFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        indexFile.write(indexLines.join('\n').toUtf8() + '\n');
+        indexFile.close();
+    }
+
+    this->m_thumbnailsMutex.lock();
+    this->m_thumbnails = thumbnails;
+    this->m_thumbnailsMutex.unlock();
+    emit this->self->thumbnailsChanged(thumbnails);
+}
+
 void MediaSourceFFmpeg::setMedia(const QString &media)
 {
     if (media == this->d->m_media)
@@ -451,6 +1023,42 @@ void MediaSourceFFmpeg::setLoop(bool loop)
     emit this->loopChanged(loop);
 }
 
+void MediaSourceFFmpeg::setCodecThreads(int codecThreads)
+{
+    if (this->d->m_codecThreads == codecThreads)
+        return;
+
+    this->d->m_codecThreads = codecThreads;
+    emit this->codecThreadsChanged(codecThreads);
+}
+
+void MediaSourceFFmpeg::setLowLatency(bool lowLatency)
+{
+    if (this->d->m_lowLatency == lowLatency)
+        return;
+
+    this->d->m_lowLatency = lowLatency;
+    emit this->lowLatencyChanged(lowLatency);
+}
+
+void MediaSourceFFmpeg::setJitterBufferPackets(int jitterBufferPackets)
+{
+    if (this->d->m_jitterBufferPackets == jitterBufferPackets)
+        return;
+
+    this->d->m_jitterBufferPackets = jitterBufferPackets;
+    emit this->jitterBufferPacketsChanged(jitterBufferPackets);
+}
+
+void MediaSourceFFmpeg::setStallTimeout(int stallTimeout)
+{
+    if (this->d->m_stallTimeout == stallTimeout)
+        return;
+
+    this->d->m_stallTimeout = stallTimeout;
+    emit this->stallTimeoutChanged(stallTimeout);
+}
+
 void MediaSourceFFmpeg::resetMedia()
 {
     this->setMedia("");
@@ -480,80 +1088,69 @@ void MediaSourceFFmpeg::resetLoop()
     this->setLoop(false);
 }
 
-bool MediaSourceFFmpeg::setState(AkElement::ElementState state)
+void MediaSourceFFmpeg::resetCodecThreads()
 {
-    switch (this->d->m_curState) {
-    case AkElement::ElementStateNull: {
-        if (state == AkElement::ElementStatePaused
-            || state == AkElement::ElementStatePlaying) {
-            if (!this->initContext())
-                return false;
-
-            if (avformat_find_stream_info(this->d->m_inputContext.data(),
-                                          nullptr) < 0) {
-                this->d->m_inputContext.clear();
-
-                return false;
-            }
-
-            QString uri = this->d->m_media;
-            av_dump_format(this->d->m_inputContext.data(),
-                           0,
-                           uri.toStdString().c_str(),
-                           false);
-
-            QList<int> filterStreams;
-
-            if (this->d->m_streams.isEmpty())
-                filterStreams << this->defaultStream("audio/x-raw")
-                              << this->defaultStream("video/x-raw");
-            else
-                filterStreams = this->d->m_streams;
-
-            for (const int &i: filterStreams) {
-                AbstractStreamPtr stream = this->d->createStream(i);
-
-                if (stream) {
-                    this->d->m_streamsMap[i] = stream;
-
-                    QObject::connect(stream.data(),
-                                     SIGNAL(oStream(AkPacket)),
-                                     this,
-                                     SIGNAL(oStream(AkPacket)),
-                                     Qt::DirectConnection);
-
-                    QObject::connect(stream.data(),
-                                     SIGNAL(notify()),
-                                     this,
-                                     SLOT(packetConsumed()));
+    this->setCodecThreads(0);
+}
 
-                    QObject::connect(stream.data(),
-                                     SIGNAL(frameSent()),
-                                     this,
-                                     SLOT(log()));
+void MediaSourceFFmpeg::resetLowLatency()
+{
+    this->setLowLatency(false);
+}
 
-                    QObject::connect(stream.data(),
-                                     SIGNAL(eof()),
-                                     this,
-                                     SLOT(doLoop()));
+void MediaSourceFFmpeg::resetJitterBufferPackets()
+{
+    this->setJitterBufferPackets(0);
+}
 
-                    stream->init();
+void MediaSourceFFmpeg::resetStallTimeout()
+{
+    this->setStallTimeout(5000);
+}
 
-                    if (state == AkElement::ElementStatePaused)
-                        stream->setPaused(true);
-                }
-            }
+bool MediaSourceFFmpeg::setState(AkElement::ElementState state)
+{
+    // Stopping the source also cancels any pending reconnection.
+    if (state == AkElement::ElementStateNull)
+        this->d->m_reconnectState = AkElement::ElementStateNull;
+
+    if (this->d->m_opening) {
+        if (state == AkElement::ElementStateNull) {
+            /* Cancel the background open; the interrupt callback breaks
+             * any blocked connect almost immediately. */
+            this->d->m_abortOpen.store(1);
+            this->d->m_openResult.waitForFinished();
+            this->d->m_abortOpen.store(0);
+
+            if (this->d->m_curState == AkElement::ElementStateNull)
+                return true;
+
+            // The open won the race, fall through and tear it down.
+        } else {
+            // Just retarget the open that is already under way.
+            this->d->m_openTarget = state;
 
-            if (state == AkElement::ElementStatePaused)
-                this->d->m_curClockTime = 0.;
+            return true;
+        }
+    }
 
-            this->d->m_globalClock.setClock(0.);
-            this->d->m_run = true;
-            this->d->m_readPacketsLoopResult =
-                    QtConcurrent::run(&this->d->m_threadPool,
-                                      this->d,
-                                      &MediaSourceFFmpegPrivate::readPackets);
-            this->d->m_curState = state;
+    switch (this->d->m_curState) {
+    case AkElement::ElementStateNull: {
+        if (state == AkElement::ElementStatePaused
+            || state == AkElement::ElementStatePlaying) {
+            /* Opening can block for the whole connect timeout on an
+             * unreachable network source, so it runs on the pool and this
+             * call returns at once. Multiple sources configured at the
+             * same time open in parallel, each on its own pool. */
+            this->d->m_openTarget = state;
+            this->d->m_opening = true;
+            emit this->openingChanged(true);
+            this->d->m_openResult =
+                    QtConcurrent::run(&this->d->m_threadPool, [this] () {
+                        this->openMedia();
+                        this->d->m_opening = false;
+                        emit this->openingChanged(false);
+                    });
 
             return true;
         }
@@ -579,6 +1176,7 @@ bool MediaSourceFFmpeg::setState(AkElement::ElementState state)
             for (const AbstractStreamPtr &stream: this->d->m_streamsMap)
                 stream->uninit();
 
+            this->d->clearPrerollCache();
             this->d->m_streamsMap.clear();
             this->d->m_inputContext.clear();
             this->d->m_curState = state;
@@ -615,6 +1213,7 @@ bool MediaSourceFFmpeg::setState(AkElement::ElementState state)
             for (const AbstractStreamPtr &stream: this->d->m_streamsMap)
                 stream->uninit();
 
+            this->d->clearPrerollCache();
             this->d->m_streamsMap.clear();
             this->d->m_inputContext.clear();
             this->d->m_curState = state;
@@ -642,12 +1241,204 @@ bool MediaSourceFFmpeg::setState(AkElement::ElementState state)
     return false;
 }
 
+/* Blocking part of the Null to Paused/Playing transition, runs on the
+ * pool. Aborting through the interrupt callback makes initContext or the
+ * probing fail, so the state stays Null and the context stays clear. */
+bool MediaSourceFFmpeg::openMedia()
+{
+    auto state = this->d->m_openTarget;
+
+    if (!this->initContext())
+        return false;
+
+    if (avformat_find_stream_info(this->d->m_inputContext.data(),
+                                  nullptr) < 0) {
+        this->d->m_inputContext.clear();
+
+        return false;
+    }
+
+    QString uri = this->d->m_media;
+    av_dump_format(this->d->m_inputContext.data(),
+                   0,
+                   uri.toStdString().c_str(),
+                   false);
+
+    QList<int> filterStreams;
+
+    if (this->d->m_streams.isEmpty())
+        filterStreams << this->defaultStream("audio/x-raw")
+                      << this->defaultStream("video/x-raw");
+    else
+        filterStreams = this->d->m_streams;
+
+    for (const int &i: filterStreams) {
+        AbstractStreamPtr stream = this->d->createStream(i);
+
+        if (stream) {
+            this->d->m_streamsMap[i] = stream;
+
+            QObject::connect(stream.data(),
+                             SIGNAL(oStream(AkPacket)),
+                             this,
+                             SIGNAL(oStream(AkPacket)),
+                             Qt::DirectConnection);
+
+            QObject::connect(stream.data(),
+                             SIGNAL(notify()),
+                             this,
+                             SLOT(packetConsumed()));
+
+            QObject::connect(stream.data(),
+                             SIGNAL(frameSent()),
+                             this,
+                             SLOT(log()));
+
+            QObject::connect(stream.data(),
+                             SIGNAL(eof()),
+                             this,
+                             SLOT(doLoop()));
+
+            stream->init();
+
+            if (state == AkElement::ElementStatePaused)
+                stream->setPaused(true);
+        }
+    }
+
+    if (state == AkElement::ElementStatePaused)
+        this->d->m_curClockTime = 0.;
+
+    this->d->m_globalClock.setClock(0.);
+    this->d->m_eofCount = 0;
+
+    // A network source reconnects instead of looping, caching a
+    // preroll for it would only waste memory.
+    this->d->clearPrerollCache();
+    this->d->m_prerollCaching = this->d->m_loop
+                                && !this->d->m_networked;
+    this->d->m_run = true;
+    this->d->m_readPacketsLoopResult =
+            QtConcurrent::run(&this->d->m_threadPool,
+                              this->d,
+                              &MediaSourceFFmpegPrivate::readPackets);
+    this->d->m_curState = state;
+
+    // Kick the thumbnail index for seekable local media; it decodes on
+    // its own demuxer and pool, fully detached from playback.
+    if (!this->d->m_networked)
+        this->d->startThumbnails();
+
+    return true;
+}
+
 void MediaSourceFFmpeg::doLoop()
 {
+    // Every running stream signals EOF once its queues drain, wait for the
+    // last one before rewinding.
+    int runningStreams = 0;
+
+    for (const AbstractStreamPtr &stream: this->d->m_streamsMap)
+        if (stream->isValid()
+            && (stream->mediaType() == AVMEDIA_TYPE_VIDEO
+                || stream->mediaType() == AVMEDIA_TYPE_AUDIO
+                || stream->mediaType() == AVMEDIA_TYPE_SUBTITLE))
+            runningStreams++;
+
+    this->d->m_eofCount++;
+
+    if (this->d->m_eofCount < runningStreams)
+        return;
+
+    this->d->m_eofCount = 0;
+
+    /* Loop by seeking the already open demuxer back to the first keyframe
+     * and flushing the decoders, instead of closing the media and paying
+     * for avformat_open_input/avformat_find_stream_info probing on every
+     * lap. Non seekable sources keep the close and reopen path.
+     */
+    this->d->m_readPacketsLoopResult.waitForFinished();
+
+    /* Splice the cached preroll straight into the decoders so the next lap
+     * starts playing at once; the rewind seek below then runs while those
+     * frames are already on screen, and the read loop discards the demuxed
+     * duplicates of the spliced range.
+     */
+    bool spliced = false;
+
+    if (!this->d->m_prerollCache.isEmpty()) {
+        for (const AbstractStreamPtr &stream: this->d->m_streamsMap)
+            stream->restart();
+
+        this->d->m_globalClock.setClock(0.);
+
+        for (auto it = this->d->m_prerollCache.constBegin();
+             it != this->d->m_prerollCache.constEnd();
+             it++) {
+            if (!this->d->m_streamsMap.contains(it.key()))
+                continue;
+
+            for (auto &packet: it.value())
+                this->d->m_streamsMap[it.key()]
+                        ->packetEnqueue(this->d->clonePacket(packet));
+
+            this->d->m_skipPreroll << it.key();
+        }
+
+        spliced = true;
+    }
+
+    auto startTime = this->d->m_inputContext->start_time;
+
+    if (startTime == AV_NOPTS_VALUE)
+        startTime = 0;
+
+    if (av_seek_frame(this->d->m_inputContext.data(),
+                      -1,
+                      startTime,
+                      AVSEEK_FLAG_BACKWARD) >= 0) {
+        if (!spliced) {
+            for (const AbstractStreamPtr &stream: this->d->m_streamsMap)
+                stream->restart();
+
+            this->d->m_globalClock.setClock(0.);
+        }
+
+        this->d->m_run = true;
+        this->d->m_readPacketsLoopResult =
+                QtConcurrent::run(&this->d->m_threadPool,
+                                  this->d,
+                                  &MediaSourceFFmpegPrivate::readPackets);
+
+        return;
+    }
+
     this->setState(AkElement::ElementStateNull);
     this->setState(AkElement::ElementStatePlaying);
 }
 
+void MediaSourceFFmpeg::reconnect()
+{
+    auto state = this->d->m_reconnectState;
+    this->d->m_reconnectState = AkElement::ElementStateNull;
+
+    // The source may have been stopped while the retry was pending.
+    if (!this->d->m_networked || state == AkElement::ElementStateNull)
+        return;
+
+    if (this->d->m_curState != AkElement::ElementStateNull)
+        this->setState(AkElement::ElementStateNull);
+
+    if (!this->setState(state)) {
+        emit this->error(QString("Reconnecting to \"%1\".")
+                            .arg(this->d->m_media));
+
+        // Keep retrying while the source stays unreachable.
+        this->d->m_reconnectState = state;
+        QTimer::singleShot(RECONNECT_WAIT, this, SLOT(reconnect()));
+    }
+}
+
 void MediaSourceFFmpeg::packetConsumed()
 {
     QtConcurrent::run(&this->d->m_threadPool,
@@ -688,6 +1479,21 @@ bool MediaSourceFFmpeg::initContext()
     else if (uri == "/dev/dsp")
         inputFormat = av_find_input_format("oss");
 
+    this->d->m_networked = uri.contains("://")
+                           && !uri.startsWith("file://");
+
+    if (this->d->m_networked && this->d->m_jitterBufferPackets > 0) {
+        // Depth of the RTP reorder window, absorbs jittered and out of
+        // order packets before they reach the demuxer queues.
+        av_dict_set(&inputOptions,
+                    "reorder_queue_size",
+                    QString::number(this->d->m_jitterBufferPackets)
+                        .toStdString().c_str(),
+                    0);
+    }
+
+    this->d->m_readTimer.start();
+
     QStringList mmsSchemes;
     mmsSchemes << "mms://" << "mmsh://" << "mmst://";
 
@@ -700,7 +1506,10 @@ bool MediaSourceFFmpeg::initContext()
             uriCopy.replace(QRegExp(QString("^%1").arg(schemer)),
                             scheme);
 
-        inputContext = nullptr;
+        inputContext = avformat_alloc_context();
+        inputContext->interrupt_callback.callback =
+                &MediaSourceFFmpegPrivate::interruptCallback;
+        inputContext->interrupt_callback.opaque = this->d;
 
         if (avformat_open_input(&inputContext,
                                 uriCopy.toStdString().c_str(),
@@ -713,7 +1522,9 @@ bool MediaSourceFFmpeg::initContext()
         av_dict_free(&inputOptions);
 
     if (!inputContext) {
-        emit this->error(QString("Can't open \"%1\" stream.").arg(uri));
+        // A cancelled open is not an error, the user asked for it.
+        if (!this->d->m_abortOpen.load())
+            emit this->error(QString("Can't open \"%1\" stream.").arg(uri));
 
         return false;
     }
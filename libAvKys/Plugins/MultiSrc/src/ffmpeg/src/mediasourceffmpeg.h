@@ -37,6 +37,36 @@ class MediaSourceFFmpeg: public MediaSource
                WRITE setShowLog
                RESET resetShowLog
                NOTIFY showLogChanged)
+    // Number of codec worker threads, 0 means auto detect.
+    Q_PROPERTY(int codecThreads
+               READ codecThreads
+               WRITE setCodecThreads
+               RESET resetCodecThreads
+               NOTIFY codecThreadsChanged)
+    // Force slice threading and low delay decoding, for live sources.
+    Q_PROPERTY(bool lowLatency
+               READ lowLatency
+               WRITE setLowLatency
+               RESET resetLowLatency
+               NOTIFY lowLatencyChanged)
+    // RTP reorder window of the demuxer in packets, 0 means library default.
+    Q_PROPERTY(int jitterBufferPackets
+               READ jitterBufferPackets
+               WRITE setJitterBufferPackets
+               RESET resetJitterBufferPackets
+               NOTIFY jitterBufferPacketsChanged)
+    /* Milliseconds a blocked network read is allowed to stall before the
+     * connection is dropped and reopened, 0 disables the watchdog. */
+    Q_PROPERTY(int stallTimeout
+               READ stallTimeout
+               WRITE setStallTimeout
+               RESET resetStallTimeout
+               NOTIFY stallTimeoutChanged)
+    /* True while the input is being opened and probed in the background.
+     * Requesting the Null state during this window cancels the open. */
+    Q_PROPERTY(bool opening
+               READ opening
+               NOTIFY openingChanged)
 
     public:
         explicit MediaSourceFFmpeg(QObject *parent=nullptr);
@@ -54,6 +84,12 @@ class MediaSourceFFmpeg: public MediaSource
         Q_INVOKABLE AkCaps caps(int stream);
         Q_INVOKABLE qint64 maxPacketQueueSize() const;
         Q_INVOKABLE bool showLog() const;
+        Q_INVOKABLE int codecThreads() const;
+        Q_INVOKABLE bool lowLatency() const;
+        Q_INVOKABLE int jitterBufferPackets() const;
+        Q_INVOKABLE int stallTimeout() const;
+        Q_INVOKABLE bool opening() const;
+        Q_INVOKABLE QVariantList thumbnails() const;
 
     private:
         MediaSourceFFmpegPrivate *d;
@@ -64,9 +100,15 @@ class MediaSourceFFmpeg: public MediaSource
         void maxPacketQueueSizeChanged(qint64 maxPacketQueue);
         void showLogChanged(bool showLog);
         void loopChanged(bool loop);
+        void codecThreadsChanged(int codecThreads);
+        void lowLatencyChanged(bool lowLatency);
+        void jitterBufferPacketsChanged(int jitterBufferPackets);
+        void stallTimeoutChanged(int stallTimeout);
+        void openingChanged(bool opening);
         void mediasChanged(const QStringList &medias);
         void mediaChanged(const QString &media);
         void streamsChanged(const QList<int> &streams);
+        void thumbnailsChanged(const QVariantList &thumbnails);
 
     public slots:
         void setMedia(const QString &media);
@@ -74,17 +116,27 @@ class MediaSourceFFmpeg: public MediaSource
         void setMaxPacketQueueSize(qint64 maxPacketQueueSize);
         void setShowLog(bool showLog);
         void setLoop(bool loop);
+        void setCodecThreads(int codecThreads);
+        void setLowLatency(bool lowLatency);
+        void setJitterBufferPackets(int jitterBufferPackets);
+        void setStallTimeout(int stallTimeout);
         void resetMedia();
         void resetStreams();
         void resetMaxPacketQueueSize();
         void resetShowLog();
         void resetLoop();
+        void resetCodecThreads();
+        void resetLowLatency();
+        void resetJitterBufferPackets();
+        void resetStallTimeout();
         bool setState(AkElement::ElementState state);
 
     private slots:
         void doLoop();
+        void reconnect();
         void packetConsumed();
         bool initContext();
+        bool openMedia();
         void log();
 };
 
@@ -21,6 +21,7 @@
 #include <akfrac.h>
 #include <akcaps.h>
 #include <akvideocaps.h>
+#include <akbuffer.h>
 #include <akpacket.h>
 #include <akvideopacket.h>
 
@@ -28,6 +29,10 @@ extern "C"
 {
     #include <libavutil/imgutils.h>
     #include <libswscale/swscale.h>
+
+#ifdef HAVE_HWCONTEXT
+    #include <libavutil/hwcontext.h>
+#endif
 }
 
 #include "videostream.h"
@@ -52,17 +57,33 @@ class VideoStreamPrivate
         SwsContext *m_scaleContext;
         qreal m_lastPts;
 
+#ifdef HAVE_HWCONTEXT
+        AVBufferRef *m_hwDeviceContext;
+        AVPixelFormat m_hwPixelFormat;
+#endif
+
         VideoStreamPrivate(VideoStream *self):
             self(self),
             m_scaleContext(nullptr),
             m_lastPts(0.0)
         {
+#ifdef HAVE_HWCONTEXT
+            this->m_hwDeviceContext = nullptr;
+            this->m_hwPixelFormat = AV_PIX_FMT_NONE;
+#endif
         }
 
         inline AkFrac fps() const;
         inline AkPacket convert(AVFrame *iFrame);
         inline int64_t bestEffortTimestamp(const AVFrame *frame) const;
         inline AVFrame *copyFrame(AVFrame *frame) const;
+        inline AVFrame *retrieveFrame(AVFrame *frame) const;
+
+#ifdef HAVE_HWCONTEXT
+        inline void initHardwareDecoding();
+        static AVPixelFormat getHwFormat(AVCodecContext *context,
+                                         const AVPixelFormat *formats);
+#endif
 };
 
 VideoStream::VideoStream(const AVFormatContext *formatContext,
@@ -72,6 +93,11 @@ VideoStream::VideoStream(const AVFormatContext *formatContext,
 {
     this->d = new VideoStreamPrivate(this);
     this->m_maxData = 3;
+
+#ifdef HAVE_HWCONTEXT
+    if (this->isValid() && !noModify)
+        this->d->initHardwareDecoding();
+#endif
 }
 
 VideoStream::~VideoStream()
@@ -79,6 +105,11 @@ VideoStream::~VideoStream()
     if (this->d->m_scaleContext)
         sws_freeContext(this->d->m_scaleContext);
 
+#ifdef HAVE_HWCONTEXT
+    if (this->d->m_hwDeviceContext)
+        av_buffer_unref(&this->d->m_hwDeviceContext);
+#endif
+
     delete this->d;
 }
 
@@ -118,7 +149,9 @@ void VideoStream::processPacket(AVPacket *packet)
 
             if (r >= 0) {
                 iFrame->pts = this->d->bestEffortTimestamp(iFrame);
-                this->dataEnqueue(this->d->copyFrame(iFrame));
+
+                if (auto oFrame = this->d->retrieveFrame(iFrame))
+                    this->dataEnqueue(oFrame);
             }
     #ifdef HAVE_FRAMEALLOC
             av_frame_free(&iFrame);
@@ -140,7 +173,9 @@ void VideoStream::processPacket(AVPacket *packet)
 
         if (gotFrame) {
             iFrame->pts = this->d->bestEffortTimestamp(iFrame);
-            this->dataEnqueue(this->d->copyFrame(iFrame));
+
+            if (auto oFrame = this->d->retrieveFrame(iFrame))
+                this->dataEnqueue(oFrame);
         }
 
     #ifdef HAVE_FRAMEALLOC
@@ -213,6 +248,44 @@ AkPacket VideoStreamPrivate::convert(AVFrame *iFrame)
 {
     AVPixelFormat outPixFormat = AV_PIX_FMT_RGB24;
 
+#ifdef HAVE_FRAMEALLOC
+    /* Packed RGB24 frames without stride padding can enter the
+     * pipeline as is: wrap a new reference to the decoder's buffer and
+     * unref it when the last downstream copy drops. */
+    if (AVPixelFormat(iFrame->format) == outPixFormat
+        && iFrame->buf[0]
+        && iFrame->linesize[0] == 3 * iFrame->width) {
+        if (auto refFrame = av_frame_clone(iFrame)) {
+            auto oBuffer =
+                    AkBuffer::fromRawData(refFrame->data[0],
+                                          size_t(3 * refFrame->width
+                                                   * refFrame->height),
+                                          [refFrame] () {
+                                              auto frame = refFrame;
+                                              av_frame_free(&frame);
+                                          });
+
+            AkVideoCaps caps;
+            caps.isValid() = true;
+            caps.format() = AkVideoCaps::Format_rgb24;
+            caps.bpp() = AkVideoCaps::bitsPerPixel(caps.format());
+            caps.width() = iFrame->width;
+            caps.height() = iFrame->height;
+            caps.fps() = this->fps();
+
+            AkVideoPacket oPacket;
+            oPacket.caps() = caps;
+            oPacket.setFrameBuffer(oBuffer);
+            oPacket.pts() = iFrame->pts;
+            oPacket.timeBase() = self->timeBase();
+            oPacket.index() = int(self->index());
+            oPacket.id() = self->id();
+
+            return oPacket.toPacket();
+        }
+    }
+#endif
+
     // Initialize rescaling context.
     this->m_scaleContext = sws_getCachedContext(this->m_scaleContext,
                                                   iFrame->width,
@@ -308,6 +381,12 @@ int64_t VideoStreamPrivate::bestEffortTimestamp(const AVFrame *frame) const
 AVFrame *VideoStreamPrivate::copyFrame(AVFrame *frame) const
 {
 #ifdef HAVE_FRAMEALLOC
+    /* Decoder output is reference counted, take a new reference to the
+     * decoder's buffers instead of duplicating them. This keeps
+     * FFmpeg's buffer pool and alignment intact. */
+    if (frame->buf[0])
+        return av_frame_clone(frame);
+
     auto oFrame = av_frame_alloc();
 #else
     auto oFrame = avcodec_alloc_frame();
@@ -334,4 +413,77 @@ AVFrame *VideoStreamPrivate::copyFrame(AVFrame *frame) const
     return oFrame;
 }
 
+AVFrame *VideoStreamPrivate::retrieveFrame(AVFrame *frame) const
+{
+#ifdef HAVE_HWCONTEXT
+    // Frames decoded by a hwaccel live in GPU memory, download them into a
+    // software frame before they enter the pipeline.
+    if (this->m_hwPixelFormat != AV_PIX_FMT_NONE
+        && frame->format == this->m_hwPixelFormat) {
+        auto swFrame = av_frame_alloc();
+
+        if (av_hwframe_transfer_data(swFrame, frame, 0) < 0) {
+            av_frame_free(&swFrame);
+
+            return nullptr;
+        }
+
+        swFrame->pts = frame->pts;
+
+        return swFrame;
+    }
+#endif
+
+    return this->copyFrame(frame);
+}
+
+#ifdef HAVE_HWCONTEXT
+void VideoStreamPrivate::initHardwareDecoding()
+{
+    auto codecContext = self->codecContext();
+    auto codec = self->codec();
+
+    for (int i = 0; ; i++) {
+        auto config = avcodec_get_hw_config(codec, i);
+
+        if (!config)
+            break;
+
+        if (!(config->methods & AV_CODEC_HW_CONFIG_METHOD_HW_DEVICE_CTX))
+            continue;
+
+        AVBufferRef *deviceContext = nullptr;
+
+        if (av_hwdevice_ctx_create(&deviceContext,
+                                   config->device_type,
+                                   nullptr,
+                                   nullptr,
+                                   0) < 0)
+            continue;
+
+        this->m_hwDeviceContext = deviceContext;
+        this->m_hwPixelFormat = config->pix_fmt;
+        codecContext->hw_device_ctx = av_buffer_ref(deviceContext);
+        codecContext->opaque = this;
+        codecContext->get_format = VideoStreamPrivate::getHwFormat;
+
+        break;
+    }
+}
+
+AVPixelFormat VideoStreamPrivate::getHwFormat(AVCodecContext *context,
+                                              const AVPixelFormat *formats)
+{
+    auto stream = reinterpret_cast<VideoStreamPrivate *>(context->opaque);
+
+    for (auto format = formats; *format != AV_PIX_FMT_NONE; format++)
+        if (*format == stream->m_hwPixelFormat)
+            return *format;
+
+    // The decoder refused the hwaccel surface format, fall back to the
+    // first software format it offers.
+    return formats[0];
+}
+#endif
+
 #include "moc_videostream.cpp"
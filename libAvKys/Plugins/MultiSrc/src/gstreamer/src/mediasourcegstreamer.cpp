@@ -26,6 +26,7 @@
 #include <gst/audio/audio.h>
 #include <gst/video/video.h>
 #include <ak.h>
+#include <akbuffer.h>
 #include <akaudiopacket.h>
 #include <akvideopacket.h>
 #include <akaudiocaps.h>
@@ -413,21 +414,26 @@ GstFlowReturn MediaSourceGStreamerPrivate::audioBufferCallback(GstElement *audio
     GstMapInfo map;
     gst_buffer_map(buf, &map, GST_MAP_READ);
 
-    QByteArray oBuffer(int(map.size), 0);
-    memcpy(oBuffer.data(), map.data, map.size);
+    /* The sample stays mapped for as long as the packet lives
+     * downstream, the wrapper unmaps and unrefs it when the last
+     * reference is dropped. */
+    auto oBuffer =
+            AkBuffer::fromRawData(map.data,
+                                  map.size,
+                                  [buf, map, sample] () mutable {
+                                      gst_buffer_unmap(buf, &map);
+                                      gst_sample_unref(sample);
+                                  });
 
     packet.caps().samples() = gint(map.size) / audioInfo->bpf;
     gst_audio_info_free(audioInfo);
 
-    packet.buffer() = oBuffer;
+    packet.setFrameBuffer(oBuffer);
     packet.pts() = qint64(GST_BUFFER_PTS(buf));
     packet.timeBase() = AkFrac(1, GST_SECOND);
     packet.index() = int(self->d->m_audioIndex);
     packet.id() = self->d->m_audioId;
 
-    gst_buffer_unmap(buf, &map);
-    gst_sample_unref(sample);
-
     emit self->oStream(packet.toPacket());
 
     return GST_FLOW_OK;
@@ -465,18 +471,20 @@ GstFlowReturn MediaSourceGStreamerPrivate::videoBufferCallback(GstElement *video
     GstMapInfo map;
     gst_buffer_map(buf, &map, GST_MAP_READ);
 
-    QByteArray oBuffer(int(map.size), 0);
-    memcpy(oBuffer.data(), map.data, map.size);
+    auto oBuffer =
+            AkBuffer::fromRawData(map.data,
+                                  map.size,
+                                  [buf, map, sample] () mutable {
+                                      gst_buffer_unmap(buf, &map);
+                                      gst_sample_unref(sample);
+                                  });
 
-    packet.buffer() = oBuffer;
+    packet.setFrameBuffer(oBuffer);
     packet.pts() = qint64(GST_BUFFER_PTS(buf));
     packet.timeBase() = AkFrac(1, GST_SECOND);
     packet.index() = int(self->d->m_videoIndex);
     packet.id() = self->d->m_videoId;
 
-    gst_buffer_unmap(buf, &map);
-    gst_sample_unref(sample);
-
     emit self->oStream(packet.toPacket());
 
     return GST_FLOW_OK;
@@ -509,18 +517,20 @@ GstFlowReturn MediaSourceGStreamerPrivate::subtitlesBufferCallback(GstElement *s
     GstMapInfo map;
     gst_buffer_map(buf, &map, GST_MAP_READ);
 
-    QByteArray oBuffer(int(map.size), 0);
-    memcpy(oBuffer.data(), map.data, map.size);
+    auto oBuffer =
+            AkBuffer::fromRawData(map.data,
+                                  map.size,
+                                  [buf, map, sample] () mutable {
+                                      gst_buffer_unmap(buf, &map);
+                                      gst_sample_unref(sample);
+                                  });
 
-    packet.buffer() = oBuffer;
+    packet.setFrameBuffer(oBuffer);
     packet.pts() = qint64(GST_BUFFER_PTS(buf));
     packet.timeBase() = AkFrac(1, GST_SECOND);
     packet.index() = int(self->d->m_subtitlesIndex);
     packet.id() = self->d->m_subtitlesId;
 
-    gst_buffer_unmap(buf, &map);
-    gst_sample_unref(sample);
-
     emit self->oStream(packet);
 
     return GST_FLOW_OK;
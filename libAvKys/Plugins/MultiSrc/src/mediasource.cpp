@@ -95,6 +95,36 @@ bool MediaSource::showLog() const
     return false;
 }
 
+int MediaSource::codecThreads() const
+{
+    return 0;
+}
+
+bool MediaSource::lowLatency() const
+{
+    return false;
+}
+
+int MediaSource::jitterBufferPackets() const
+{
+    return 0;
+}
+
+int MediaSource::stallTimeout() const
+{
+    return 0;
+}
+
+bool MediaSource::opening() const
+{
+    return false;
+}
+
+QVariantList MediaSource::thumbnails() const
+{
+    return QVariantList();
+}
+
 void MediaSource::setMedia(const QString &media)
 {
     Q_UNUSED(media)
@@ -120,6 +150,26 @@ void MediaSource::setLoop(bool loop)
     Q_UNUSED(loop)
 }
 
+void MediaSource::setCodecThreads(int codecThreads)
+{
+    Q_UNUSED(codecThreads)
+}
+
+void MediaSource::setLowLatency(bool lowLatency)
+{
+    Q_UNUSED(lowLatency)
+}
+
+void MediaSource::setJitterBufferPackets(int jitterBufferPackets)
+{
+    Q_UNUSED(jitterBufferPackets)
+}
+
+void MediaSource::setStallTimeout(int stallTimeout)
+{
+    Q_UNUSED(stallTimeout)
+}
+
 void MediaSource::resetMedia()
 {
 }
@@ -140,6 +190,22 @@ void MediaSource::resetLoop()
 {
 }
 
+void MediaSource::resetCodecThreads()
+{
+}
+
+void MediaSource::resetLowLatency()
+{
+}
+
+void MediaSource::resetJitterBufferPackets()
+{
+}
+
+void MediaSource::resetStallTimeout()
+{
+}
+
 bool MediaSource::setState(AkElement::ElementState state)
 {
     Q_UNUSED(state)
@@ -44,6 +44,17 @@ class MediaSource: public QObject
         Q_INVOKABLE virtual AkCaps caps(int stream);
         Q_INVOKABLE virtual qint64 maxPacketQueueSize() const;
         Q_INVOKABLE virtual bool showLog() const;
+        Q_INVOKABLE virtual int codecThreads() const;
+        Q_INVOKABLE virtual bool lowLatency() const;
+        Q_INVOKABLE virtual int jitterBufferPackets() const;
+        Q_INVOKABLE virtual int stallTimeout() const;
+        Q_INVOKABLE virtual bool opening() const;
+
+        /* Thumbnail index of the current media for scrubbing: one map per
+         * entry with "time" in seconds and "thumbnail", the path of the
+         * cached image. Empty until the backend has generated or loaded
+         * the index, backends without support just stay empty. */
+        Q_INVOKABLE virtual QVariantList thumbnails() const;
 
     public slots:
         virtual void setMedia(const QString &media);
@@ -51,11 +62,19 @@ class MediaSource: public QObject
         virtual void setMaxPacketQueueSize(qint64 maxPacketQueueSize);
         virtual void setShowLog(bool showLog);
         virtual void setLoop(bool loop);
+        virtual void setCodecThreads(int codecThreads);
+        virtual void setLowLatency(bool lowLatency);
+        virtual void setJitterBufferPackets(int jitterBufferPackets);
+        virtual void setStallTimeout(int stallTimeout);
         virtual void resetMedia();
         virtual void resetStreams();
         virtual void resetMaxPacketQueueSize();
         virtual void resetShowLog();
         virtual void resetLoop();
+        virtual void resetCodecThreads();
+        virtual void resetLowLatency();
+        virtual void resetJitterBufferPackets();
+        virtual void resetStallTimeout();
         virtual bool setState(AkElement::ElementState state);
 };
 
@@ -159,6 +159,54 @@ QString MultiSrcElement::codecLib() const
     return globalMultiSrc->codecLib();
 }
 
+int MultiSrcElement::codecThreads() const
+{
+    if (!this->d->m_mediaSource)
+        return 0;
+
+    return this->d->m_mediaSource->codecThreads();
+}
+
+bool MultiSrcElement::lowLatency() const
+{
+    if (!this->d->m_mediaSource)
+        return false;
+
+    return this->d->m_mediaSource->lowLatency();
+}
+
+int MultiSrcElement::jitterBufferPackets() const
+{
+    if (!this->d->m_mediaSource)
+        return 0;
+
+    return this->d->m_mediaSource->jitterBufferPackets();
+}
+
+int MultiSrcElement::stallTimeout() const
+{
+    if (!this->d->m_mediaSource)
+        return 0;
+
+    return this->d->m_mediaSource->stallTimeout();
+}
+
+bool MultiSrcElement::opening() const
+{
+    if (!this->d->m_mediaSource)
+        return false;
+
+    return this->d->m_mediaSource->opening();
+}
+
+QVariantList MultiSrcElement::thumbnails() const
+{
+    if (!this->d->m_mediaSource)
+        return {};
+
+    return this->d->m_mediaSource->thumbnails();
+}
+
 QString MultiSrcElement::controlInterfaceProvide(const QString &controlId) const
 {
     Q_UNUSED(controlId)
@@ -210,6 +258,30 @@ void MultiSrcElement::setCodecLib(const QString &codecLib)
     globalMultiSrc->setCodecLib(codecLib);
 }
 
+void MultiSrcElement::setCodecThreads(int codecThreads)
+{
+    if (this->d->m_mediaSource)
+        this->d->m_mediaSource->setCodecThreads(codecThreads);
+}
+
+void MultiSrcElement::setLowLatency(bool lowLatency)
+{
+    if (this->d->m_mediaSource)
+        this->d->m_mediaSource->setLowLatency(lowLatency);
+}
+
+void MultiSrcElement::setJitterBufferPackets(int jitterBufferPackets)
+{
+    if (this->d->m_mediaSource)
+        this->d->m_mediaSource->setJitterBufferPackets(jitterBufferPackets);
+}
+
+void MultiSrcElement::setStallTimeout(int stallTimeout)
+{
+    if (this->d->m_mediaSource)
+        this->d->m_mediaSource->setStallTimeout(stallTimeout);
+}
+
 void MultiSrcElement::resetMedia()
 {
     if (this->d->m_mediaSource)
@@ -245,6 +317,30 @@ void MultiSrcElement::resetCodecLib()
     globalMultiSrc->resetCodecLib();
 }
 
+void MultiSrcElement::resetCodecThreads()
+{
+    if (this->d->m_mediaSource)
+        this->d->m_mediaSource->resetCodecThreads();
+}
+
+void MultiSrcElement::resetLowLatency()
+{
+    if (this->d->m_mediaSource)
+        this->d->m_mediaSource->resetLowLatency();
+}
+
+void MultiSrcElement::resetJitterBufferPackets()
+{
+    if (this->d->m_mediaSource)
+        this->d->m_mediaSource->resetJitterBufferPackets();
+}
+
+void MultiSrcElement::resetStallTimeout()
+{
+    if (this->d->m_mediaSource)
+        this->d->m_mediaSource->resetStallTimeout();
+}
+
 bool MultiSrcElement::setState(AkElement::ElementState state)
 {
     if (!this->d->m_mediaSource || !this->d->m_mediaSource->setState(state))
@@ -261,11 +357,19 @@ void MultiSrcElement::codecLibUpdated(const QString &codecLib)
     QString media;
     bool loop = false;
     bool showLog = false;
+    int codecThreads = 0;
+    bool lowLatency = false;
+    int jitterBufferPackets = 0;
+    int stallTimeout = 0;
 
     if (this->d->m_mediaSource) {
         media = this->d->m_mediaSource->media();
         loop = this->d->m_mediaSource->loop();
         showLog = this->d->m_mediaSource->showLog();
+        codecThreads = this->d->m_mediaSource->codecThreads();
+        lowLatency = this->d->m_mediaSource->lowLatency();
+        jitterBufferPackets = this->d->m_mediaSource->jitterBufferPackets();
+        stallTimeout = this->d->m_mediaSource->stallTimeout();
     }
 
     this->d->m_mutexLib.lock();
@@ -312,12 +416,40 @@ void MultiSrcElement::codecLibUpdated(const QString &codecLib)
                      SIGNAL(streamsChanged(const QList<int> &)),
                      this,
                      SIGNAL(streamsChanged(const QList<int> &)));
+    QObject::connect(this->d->m_mediaSource.data(),
+                     SIGNAL(codecThreadsChanged(int)),
+                     this,
+                     SIGNAL(codecThreadsChanged(int)));
+    QObject::connect(this->d->m_mediaSource.data(),
+                     SIGNAL(lowLatencyChanged(bool)),
+                     this,
+                     SIGNAL(lowLatencyChanged(bool)));
+    QObject::connect(this->d->m_mediaSource.data(),
+                     SIGNAL(jitterBufferPacketsChanged(int)),
+                     this,
+                     SIGNAL(jitterBufferPacketsChanged(int)));
+    QObject::connect(this->d->m_mediaSource.data(),
+                     SIGNAL(stallTimeoutChanged(int)),
+                     this,
+                     SIGNAL(stallTimeoutChanged(int)));
+    QObject::connect(this->d->m_mediaSource.data(),
+                     SIGNAL(openingChanged(bool)),
+                     this,
+                     SIGNAL(openingChanged(bool)));
+    QObject::connect(this->d->m_mediaSource.data(),
+                     SIGNAL(thumbnailsChanged(const QVariantList &)),
+                     this,
+                     SIGNAL(thumbnailsChanged(const QVariantList &)));
 
     this->d->m_mutexLib.unlock();
 
     this->d->m_mediaSource->setMedia(media);
     this->d->m_mediaSource->setLoop(loop);
     this->d->m_mediaSource->setShowLog(showLog);
+    this->d->m_mediaSource->setCodecThreads(codecThreads);
+    this->d->m_mediaSource->setLowLatency(lowLatency);
+    this->d->m_mediaSource->setJitterBufferPackets(jitterBufferPackets);
+    this->d->m_mediaSource->setStallTimeout(stallTimeout);
 
     emit this->streamsChanged(this->streams());
     emit this->maxPacketQueueSizeChanged(this->maxPacketQueueSize());
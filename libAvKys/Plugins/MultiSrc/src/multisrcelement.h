@@ -60,6 +60,43 @@ class MultiSrcElement: public AkMultimediaSourceElement
                WRITE setCodecLib
                RESET resetCodecLib
                NOTIFY codecLibChanged)
+    // Number of codec worker threads, 0 means auto detect.
+    Q_PROPERTY(int codecThreads
+               READ codecThreads
+               WRITE setCodecThreads
+               RESET resetCodecThreads
+               NOTIFY codecThreadsChanged)
+    // Force slice threading and low delay decoding, for live sources.
+    Q_PROPERTY(bool lowLatency
+               READ lowLatency
+               WRITE setLowLatency
+               RESET resetLowLatency
+               NOTIFY lowLatencyChanged)
+    // RTP reorder window of the demuxer in packets, 0 means library default.
+    Q_PROPERTY(int jitterBufferPackets
+               READ jitterBufferPackets
+               WRITE setJitterBufferPackets
+               RESET resetJitterBufferPackets
+               NOTIFY jitterBufferPacketsChanged)
+    /* Milliseconds a blocked network read is allowed to stall before the
+     * connection is dropped and reopened, 0 disables the watchdog. */
+    Q_PROPERTY(int stallTimeout
+               READ stallTimeout
+               WRITE setStallTimeout
+               RESET resetStallTimeout
+               NOTIFY stallTimeoutChanged)
+    /* True while the input is being opened and probed in the background.
+     * Requesting the Null state during this window cancels the open. */
+    Q_PROPERTY(bool opening
+               READ opening
+               NOTIFY openingChanged)
+    /* Thumbnail index of the current media for scrubbing: one map per
+     * entry with "time" in seconds and "thumbnail", the path of the
+     * cached image. Generated in background on first open, empty until
+     * then and for backends without support. */
+    Q_PROPERTY(QVariantList thumbnails
+               READ thumbnails
+               NOTIFY thumbnailsChanged)
 
     public:
         explicit MultiSrcElement();
@@ -77,6 +114,12 @@ class MultiSrcElement: public AkMultimediaSourceElement
         Q_INVOKABLE qint64 maxPacketQueueSize() const;
         Q_INVOKABLE bool showLog() const;
         Q_INVOKABLE QString codecLib() const;
+        Q_INVOKABLE int codecThreads() const;
+        Q_INVOKABLE bool lowLatency() const;
+        Q_INVOKABLE int jitterBufferPackets() const;
+        Q_INVOKABLE int stallTimeout() const;
+        Q_INVOKABLE bool opening() const;
+        Q_INVOKABLE QVariantList thumbnails() const;
 
     private:
         MultiSrcElementPrivate *d;
@@ -95,6 +138,12 @@ class MultiSrcElement: public AkMultimediaSourceElement
         void maxPacketQueueSizeChanged(qint64 maxPacketQueue);
         void showLogChanged(bool showLog);
         void codecLibChanged(const QString &codecLib);
+        void codecThreadsChanged(int codecThreads);
+        void lowLatencyChanged(bool lowLatency);
+        void jitterBufferPacketsChanged(int jitterBufferPackets);
+        void stallTimeoutChanged(int stallTimeout);
+        void openingChanged(bool opening);
+        void thumbnailsChanged(const QVariantList &thumbnails);
 
     public slots:
         void setMedia(const QString &media);
@@ -103,12 +152,20 @@ class MultiSrcElement: public AkMultimediaSourceElement
         void setMaxPacketQueueSize(qint64 maxPacketQueueSize);
         void setShowLog(bool showLog);
         void setCodecLib(const QString &codecLib);
+        void setCodecThreads(int codecThreads);
+        void setLowLatency(bool lowLatency);
+        void setJitterBufferPackets(int jitterBufferPackets);
+        void setStallTimeout(int stallTimeout);
         void resetMedia();
         void resetStreams();
         void resetLoop();
         void resetMaxPacketQueueSize();
         void resetShowLog();
         void resetCodecLib();
+        void resetCodecThreads();
+        void resetLowLatency();
+        void resetJitterBufferPackets();
+        void resetStallTimeout();
         bool setState(AkElement::ElementState state);
 
     private slots:
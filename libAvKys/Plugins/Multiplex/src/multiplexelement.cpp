@@ -17,25 +17,30 @@
  * Web-Site: http://webcamoid.github.io/
  */
 
-#include <akpacket.h>
-#include <akcaps.h>
+#include <akfrac.h>
 
 #include "multiplexelement.h"
 
+inline qreal packetTime(const AkPacket &packet)
+{
+    return packet.pts() * packet.timeBase().value();
+}
+
 MultiplexElement::MultiplexElement(): AkElement()
 {
-    this->m_inputIndex = -1;
-    this->m_outputIndex = -1;
+    this->m_inputIndex.storeRelease(-1);
+    this->m_outputIndex.storeRelease(-1);
+    this->m_sortBufferSize = 0;
 }
 
 int MultiplexElement::inputIndex() const
 {
-    return this->m_inputIndex;
+    return this->m_inputIndex.loadAcquire();
 }
 
 int MultiplexElement::outputIndex() const
 {
-    return this->m_outputIndex;
+    return this->m_outputIndex.loadAcquire();
 }
 
 QString MultiplexElement::caps() const
@@ -43,19 +48,44 @@ QString MultiplexElement::caps() const
     return this->m_caps;
 }
 
-void MultiplexElement::setInputIndex(int method)
+int MultiplexElement::sortBufferSize() const
 {
-    this->m_inputIndex = method;
+    return this->m_sortBufferSize;
+}
+
+void MultiplexElement::stateChange(AkElement::ElementState from,
+                                   AkElement::ElementState to)
+{
+    Q_UNUSED(from)
+
+    if (to == AkElement::ElementStateNull) {
+        QMutexLocker locker(&this->m_sortMutex);
+        this->m_sortBuffer.clear();
+    }
 }
 
-void MultiplexElement::setOutputIndex(int params)
+void MultiplexElement::setInputIndex(int inputIndex)
 {
-    this->m_outputIndex = params;
+    this->m_inputIndex.storeRelease(inputIndex);
+}
+
+void MultiplexElement::setOutputIndex(int outputIndex)
+{
+    this->m_outputIndex.storeRelease(outputIndex);
 }
 
 void MultiplexElement::setCaps(QString caps)
 {
     this->m_caps = caps;
+
+    // Parsed once here, so the packet path compares against ready made
+    // caps instead of going through the string parser per packet.
+    this->m_capsFilter = caps.isEmpty()? AkCaps(): AkCaps(caps);
+}
+
+void MultiplexElement::setSortBufferSize(int sortBufferSize)
+{
+    this->m_sortBufferSize = sortBufferSize;
 }
 
 void MultiplexElement::resetInputIndex()
@@ -73,22 +103,58 @@ void MultiplexElement::resetCaps()
     this->setCaps("");
 }
 
+void MultiplexElement::resetSortBufferSize()
+{
+    this->setSortBufferSize(0);
+}
+
 AkPacket MultiplexElement::iStream(const AkPacket &packet)
 {
-    if (this->m_inputIndex >= 0
-        && packet.index() != this->m_inputIndex)
+    int inputIndex = this->m_inputIndex.loadAcquire();
+
+    if (inputIndex >= 0
+        && packet.index() != inputIndex)
         return AkPacket();
 
-    if (!this->m_caps.isEmpty()
-        && !packet.caps().isCompatible(this->m_caps))
+    if (this->m_capsFilter.isValid()
+        && !packet.caps().isCompatible(this->m_capsFilter))
         return AkPacket();
 
     AkPacket oPacket(packet);
+    int outputIndex = this->m_outputIndex.loadAcquire();
+
+    if (outputIndex >= 0)
+        oPacket.setIndex(outputIndex);
+
+    if (this->m_sortBufferSize < 1)
+        akSend(oPacket)
+
+    /* Optional timestamp ordered merge for multi input use: packets are
+     * held in a small sorted buffer and released lowest PTS first, so
+     * slightly out of order arrivals from different inputs leave in
+     * presentation order. The bound keeps both latency and the time under
+     * the lock small.
+     */
+    AkPacket readyPacket;
+
+    this->m_sortMutex.lock();
+    qreal time = packetTime(oPacket);
+    int i = this->m_sortBuffer.size();
+
+    while (i > 0 && packetTime(this->m_sortBuffer[i - 1]) > time)
+        i--;
+
+    this->m_sortBuffer.insert(i, oPacket);
+
+    if (this->m_sortBuffer.size() > this->m_sortBufferSize)
+        readyPacket = this->m_sortBuffer.takeFirst();
+
+    this->m_sortMutex.unlock();
 
-    if (this->m_outputIndex >= 0)
-        oPacket.setIndex(this->m_outputIndex);
+    if (readyPacket)
+        akSend(readyPacket)
 
-    akSend(oPacket)
+    return AkPacket();
 }
 
 #include "moc_multiplexelement.cpp"
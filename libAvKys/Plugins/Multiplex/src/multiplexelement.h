@@ -20,7 +20,10 @@
 #ifndef MULTIPLEXELEMENT_H
 #define MULTIPLEXELEMENT_H
 
+#include <QMutex>
 #include <akelement.h>
+#include <akcaps.h>
+#include <akpacket.h>
 
 class MultiplexElement: public AkElement
 {
@@ -28,6 +31,7 @@ class MultiplexElement: public AkElement
     Q_PROPERTY(int inputIndex READ inputIndex WRITE setInputIndex RESET resetInputIndex)
     Q_PROPERTY(int outputIndex READ outputIndex WRITE setOutputIndex RESET resetOutputIndex)
     Q_PROPERTY(QString caps READ caps WRITE setCaps RESET resetCaps)
+    Q_PROPERTY(int sortBufferSize READ sortBufferSize WRITE setSortBufferSize RESET resetSortBufferSize)
 
     public:
         explicit MultiplexElement();
@@ -35,19 +39,33 @@ class MultiplexElement: public AkElement
         Q_INVOKABLE int inputIndex() const;
         Q_INVOKABLE int outputIndex() const;
         Q_INVOKABLE QString caps() const;
+        Q_INVOKABLE int sortBufferSize() const;
 
     private:
-        int m_inputIndex;
-        int m_outputIndex;
+        /* Atomic routing indexes, so the packet path reads them with plain
+         * wait-free loads instead of taking a lock.
+         */
+        QAtomicInt m_inputIndex;
+        QAtomicInt m_outputIndex;
         QString m_caps;
+        AkCaps m_capsFilter;
+        int m_sortBufferSize;
+        QList<AkPacket> m_sortBuffer;
+        QMutex m_sortMutex;
+
+    protected:
+        void stateChange(AkElement::ElementState from,
+                         AkElement::ElementState to);
 
     public slots:
         void setInputIndex(int inputIndex);
         void setOutputIndex(int outputIndex);
         void setCaps(QString caps);
+        void setSortBufferSize(int sortBufferSize);
         void resetInputIndex();
         void resetOutputIndex();
         void resetCaps();
+        void resetSortBufferSize();
 
         AkPacket iStream(const AkPacket &packet);
 };
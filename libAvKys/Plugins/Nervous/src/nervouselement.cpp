@@ -119,7 +119,9 @@ AkPacket NervousElement::iStream(const AkPacket &packet)
         this->d->m_frameSize = src.size();
     }
 
-    this->d->m_frames << src.copy();
+    // packetToImage() already hands out a fresh image per packet and the
+    // history is never written to, so sharing it is safe and copy-free.
+    this->d->m_frames << src;
     int diff = this->d->m_frames.size() - this->d->m_nFrames;
 
     for (int i = 0; i < diff && !this->d->m_frames.isEmpty(); i++)
@@ -18,14 +18,86 @@
  */
 
 #include <QImage>
+#include <QMutex>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akvideofilterrunner.h>
 
 #include "normalizeelement.h"
 #include "pixelstructs.h"
 
 NormalizeElement::NormalizeElement(): AkElement()
 {
+    this->m_sceneThreshold = 0.0;
+}
+
+qreal NormalizeElement::sceneThreshold() const
+{
+    return this->m_sceneThreshold;
+}
+
+QVector<HistogramListItem> NormalizeElement::histogram(const QImage &img,
+                                                       int yStep) const
+{
+    QVector<HistogramListItem> histogram(256, HistogramListItem());
+    QMutex mutex;
+
+    // Each band accumulates into its own partial histogram, merged once at
+    // the end, so the bins are never contended between the threads.
+    AkVideoFilterRunner::globalRunner()->run(img.height(),
+                                             [&] (int yStart, int yEnd) {
+        QVector<HistogramListItem> partial(256, HistogramListItem());
+
+        for (int y = yStart; y < yEnd; y++) {
+            if (y % yStep)
+                continue;
+
+            auto srcLine = reinterpret_cast<const QRgb *>(img.constScanLine(y));
+
+            for (int x = 0; x < img.width(); x++) {
+                QRgb pixel = srcLine[x];
+                partial[qRed(pixel)].red++;
+                partial[qGreen(pixel)].green++;
+                partial[qBlue(pixel)].blue++;
+                partial[qAlpha(pixel)].alpha++;
+            }
+        }
+
+        mutex.lock();
+
+        for (int i = 0; i < 256; i++) {
+            histogram[i].red += partial[i].red;
+            histogram[i].green += partial[i].green;
+            histogram[i].blue += partial[i].blue;
+            histogram[i].alpha += partial[i].alpha;
+        }
+
+        mutex.unlock();
+    });
+
+    if (yStep > 1)
+        for (int i = 0; i < 256; i++) {
+            histogram[i].red *= yStep;
+            histogram[i].green *= yStep;
+            histogram[i].blue *= yStep;
+            histogram[i].alpha *= yStep;
+        }
+
+    return histogram;
+}
+
+void NormalizeElement::setSceneThreshold(qreal sceneThreshold)
+{
+    if (qFuzzyCompare(this->m_sceneThreshold, sceneThreshold))
+        return;
+
+    this->m_sceneThreshold = sceneThreshold;
+    emit this->sceneThresholdChanged(sceneThreshold);
+}
+
+void NormalizeElement::resetSceneThreshold()
+{
+    this->setSceneThreshold(0.0);
 }
 
 AkPacket NormalizeElement::iStream(const AkPacket &packet)
@@ -38,20 +110,49 @@ AkPacket NormalizeElement::iStream(const AkPacket &packet)
     QImage oFrame = src.convertToFormat(QImage::Format_ARGB32);
 
     // form histogram
-    QVector<HistogramListItem> histogram(256, HistogramListItem());
-
-    for (int y = 0; y < oFrame.height(); y++) {
-        const QRgb *dstLine = reinterpret_cast<const QRgb *>(oFrame.constScanLine(y));
+    qreal sceneThreshold = this->m_sceneThreshold;
+    bool reuse = false;
+
+    if (sceneThreshold > 0.0 && this->m_histogram.size() == 256) {
+        /* Temporal mode: a subsampled histogram measures the scene change.
+         * Below the threshold the stored histogram is only updated
+         * incrementally towards the sample, skipping the full-frame pass.
+         */
+        QVector<HistogramListItem> sampled = this->histogram(oFrame, 4);
+        quint64 diff = 0;
+
+        for (int i = 0; i < 256; i++) {
+            diff += quint64(qAbs(qint64(sampled[i].red)
+                                 - qint64(this->m_histogram[i].red)));
+            diff += quint64(qAbs(qint64(sampled[i].green)
+                                 - qint64(this->m_histogram[i].green)));
+            diff += quint64(qAbs(qint64(sampled[i].blue)
+                                 - qint64(this->m_histogram[i].blue)));
+        }
 
-        for (int x = 0; x < oFrame.width(); x++) {
-            QRgb pixel = dstLine[x];
-            histogram[qRed(pixel)].red++;
-            histogram[qGreen(pixel)].green++;
-            histogram[qBlue(pixel)].blue++;
-            histogram[qAlpha(pixel)].alpha++;
+        quint64 total = quint64(oFrame.width()) * quint64(oFrame.height());
+
+        if (total > 0 && qreal(diff) / (6 * total) < sceneThreshold) {
+            for (int i = 0; i < 256; i++) {
+                this->m_histogram[i].red = (3 * this->m_histogram[i].red
+                                            + sampled[i].red) / 4;
+                this->m_histogram[i].green = (3 * this->m_histogram[i].green
+                                              + sampled[i].green) / 4;
+                this->m_histogram[i].blue = (3 * this->m_histogram[i].blue
+                                             + sampled[i].blue) / 4;
+                this->m_histogram[i].alpha = (3 * this->m_histogram[i].alpha
+                                              + sampled[i].alpha) / 4;
+            }
+
+            reuse = true;
         }
     }
 
+    if (!reuse)
+        this->m_histogram = this->histogram(oFrame);
+
+    const QVector<HistogramListItem> &histogram = this->m_histogram;
+
     // find the histogram boundaries by locating the .01 percent levels.
     ShortPixel high, low;
     qint32 thresholdIntensity = qint32(oFrame.width() * oFrame.height() / 1e3);
@@ -145,24 +246,27 @@ AkPacket NormalizeElement::iStream(const AkPacket &packet)
     }
 
     // write
-    for (int y = 0; y < oFrame.height(); y++) {
-        QRgb *oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+    AkVideoFilterRunner::globalRunner()->run(oFrame.height(),
+                                             [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            QRgb *oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
 
-        for (int x = 0; x < oFrame.width(); x++) {
-            QRgb pixel = oLine[x];
+            for (int x = 0; x < oFrame.width(); x++) {
+                QRgb pixel = oLine[x];
 
-            int r = (low.red != high.red)? normalizeMap[qRed(pixel)].red:
-                    qRed(pixel);
+                int r = (low.red != high.red)? normalizeMap[qRed(pixel)].red:
+                        qRed(pixel);
 
-            int g = (low.green != high.green)? normalizeMap[qGreen(pixel)].green:
-                        qGreen(pixel);
+                int g = (low.green != high.green)? normalizeMap[qGreen(pixel)].green:
+                            qGreen(pixel);
 
-            int b = (low.blue != high.blue)?  normalizeMap[qBlue(pixel)].blue:
-                        qBlue(pixel);
+                int b = (low.blue != high.blue)?  normalizeMap[qBlue(pixel)].blue:
+                            qBlue(pixel);
 
-            oLine[x] = qRgba(r, g, b, qAlpha(pixel));
+                oLine[x] = qRgba(r, g, b, qAlpha(pixel));
+            }
         }
-    }
+    });
 
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
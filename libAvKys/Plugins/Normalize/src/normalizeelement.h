@@ -22,14 +22,35 @@
 
 #include <akelement.h>
 
+#include "pixelstructs.h"
+
 class NormalizeElement: public AkElement
 {
     Q_OBJECT
+    Q_PROPERTY(qreal sceneThreshold
+               READ sceneThreshold
+               WRITE setSceneThreshold
+               RESET resetSceneThreshold
+               NOTIFY sceneThresholdChanged)
 
     public:
         explicit NormalizeElement();
 
+        Q_INVOKABLE qreal sceneThreshold() const;
+
+    private:
+        qreal m_sceneThreshold;
+        QVector<HistogramListItem> m_histogram;
+
+        QVector<HistogramListItem> histogram(const QImage &img,
+                                             int yStep=1) const;
+
+    signals:
+        void sceneThresholdChanged(qreal sceneThreshold);
+
     public slots:
+        void setSceneThreshold(qreal sceneThreshold);
+        void resetSceneThreshold();
         AkPacket iStream(const AkPacket &packet);
 };
 
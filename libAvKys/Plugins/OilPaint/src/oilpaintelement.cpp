@@ -19,8 +19,10 @@
 
 #include <QImage>
 #include <QQmlContext>
+#include <QVector>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akvideofilterrunner.h>
 
 #include "oilpaintelement.h"
 
@@ -75,46 +77,85 @@ AkPacket OilPaintElement::iStream(const AkPacket &packet)
 
     int radius = this->m_radius > 0? this->m_radius: 1;
     QImage oFrame(src.size(), src.format());
-    int histogram[256];
+    int width = src.width();
+    int height = src.height();
     int scanBlockLen = (radius << 1) + 1;
-    QVector<const QRgb *> scanBlock(scanBlockLen);
 
-    for (int y = 0; y < src.height(); y++) {
-        QRgb *oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
-
-        for (int j = 0, pos = y - radius; j < scanBlockLen; j++, pos++) {
-            int yp = qBound(0, pos, src.height());
-            scanBlock[j] = reinterpret_cast<const QRgb *>(src.constScanLine(yp));
-        }
-
-        for (int x = 0; x < src.width(); x++) {
-            int minI = x - radius;
-            int maxI = x + radius + 1;
-
-            if (minI < 0)
-                minI = 0;
-
-            if (maxI > src.width())
-                maxI = src.width();
-
-            memset(histogram, 0, 256 * sizeof(int));
-            int max = 0;
-            QRgb oPixel = 0;
-
-            for (int j = 0; j < scanBlockLen; j++)
-                for (int i = minI; i < maxI; i++) {
-                    QRgb pixel = scanBlock[j][i];
-                    int value = ++histogram[qGray(pixel)];
-
-                    if (value > max) {
-                        max = value;
-                        oPixel = pixel;
-                    }
-                }
-
-            oLine[x] = oPixel;
+    /* The histogram slides along the row: only the entering and the leaving
+     * columns update the bins and the per-bin color accumulators, so the
+     * cost per pixel does not depend on the radius. Each band keeps its own
+     * fixed arrays, small enough to stay cache resident.
+     */
+    AkVideoFilterRunner::globalRunner()->run(height, [&] (int yStart, int yEnd) {
+        QVector<const QRgb *> scanBlock(scanBlockLen);
+        int histogram[256];
+        int sumR[256];
+        int sumG[256];
+        int sumB[256];
+        int sumA[256];
+
+        auto addColumn = [&] (int i) {
+            for (int j = 0; j < scanBlockLen; j++) {
+                QRgb pixel = scanBlock[j][i];
+                int gray = qGray(pixel);
+                histogram[gray]++;
+                sumR[gray] += qRed(pixel);
+                sumG[gray] += qGreen(pixel);
+                sumB[gray] += qBlue(pixel);
+                sumA[gray] += qAlpha(pixel);
+            }
+        };
+
+        auto removeColumn = [&] (int i) {
+            for (int j = 0; j < scanBlockLen; j++) {
+                QRgb pixel = scanBlock[j][i];
+                int gray = qGray(pixel);
+                histogram[gray]--;
+                sumR[gray] -= qRed(pixel);
+                sumG[gray] -= qGreen(pixel);
+                sumB[gray] -= qBlue(pixel);
+                sumA[gray] -= qAlpha(pixel);
+            }
+        };
+
+        for (int y = yStart; y < yEnd; y++) {
+            QRgb *oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+
+            for (int j = 0, pos = y - radius; j < scanBlockLen; j++, pos++) {
+                int yp = qBound(0, pos, height - 1);
+                scanBlock[j] = reinterpret_cast<const QRgb *>(src.constScanLine(yp));
+            }
+
+            memset(histogram, 0, sizeof(histogram));
+            memset(sumR, 0, sizeof(sumR));
+            memset(sumG, 0, sizeof(sumG));
+            memset(sumB, 0, sizeof(sumB));
+            memset(sumA, 0, sizeof(sumA));
+
+            for (int i = 0; i <= qMin(radius, width - 1); i++)
+                addColumn(i);
+
+            for (int x = 0; x < width; x++) {
+                int mode = 0;
+
+                for (int i = 1; i < 256; i++)
+                    if (histogram[i] > histogram[mode])
+                        mode = i;
+
+                int count = histogram[mode];
+                oLine[x] = qRgba(sumR[mode] / count,
+                                 sumG[mode] / count,
+                                 sumB[mode] / count,
+                                 sumA[mode] / count);
+
+                if (x + radius + 1 < width)
+                    addColumn(x + radius + 1);
+
+                if (x - radius >= 0)
+                    removeColumn(x - radius);
+            }
         }
-    }
+    });
 
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
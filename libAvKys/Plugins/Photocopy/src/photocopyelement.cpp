@@ -22,6 +22,7 @@
 #include <QtMath>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akvideofilterrunner.h>
 
 #include "photocopyelement.h"
 
@@ -95,27 +96,38 @@ AkPacket PhotocopyElement::iStream(const AkPacket &packet)
     src = src.convertToFormat(QImage::Format_ARGB32);
     QImage oFrame(src.size(), src.format());
 
-    for (int y = 0; y < src.height(); y++) {
-        const QRgb *srcLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
-        QRgb *dstLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+    /* The sigmoidal transfer only depends on the luma, so it compiles to a
+     * 256 entries table and the exponential never runs per pixel.
+     */
+    quint8 sigmoidTable[256];
 
-        for (int x = 0; x < src.width(); x++) {
-            int r = qRed(srcLine[x]);
-            int g = qGreen(srcLine[x]);
-            int b = qBlue(srcLine[x]);
+    for (int i = 0; i < 256; i++) {
+        qreal val = i / 255.0;
+        val = 255.0 / (1 + exp(this->m_contrast * (0.5 - val)));
+        val = val * this->m_brightness;
+        sigmoidTable[i] = quint8(qBound(0.0, val, 255.0));
+    }
+
+    int width = src.width();
 
-            //desaturate
-            int luma = this->rgbToLuma(r, g, b);
+    AkVideoFilterRunner::globalRunner()->run(src.height(),
+                                             [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            const QRgb *srcLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
+            QRgb *dstLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
 
-            //compute sigmoidal transfer
-            qreal val = luma / 255.0;
-            val = 255.0 / (1 + exp(this->m_contrast * (0.5 - val)));
-            val = val * this->m_brightness;
-            luma = int(qBound(0.0, val, 255.0));
+            for (int x = 0; x < width; x++) {
+                int r = qRed(srcLine[x]);
+                int g = qGreen(srcLine[x]);
+                int b = qBlue(srcLine[x]);
 
-            dstLine[x] = qRgba(luma, luma, luma, qAlpha(srcLine[x]));
+                //desaturate
+                int luma = sigmoidTable[this->rgbToLuma(r, g, b)];
+
+                dstLine[x] = qRgba(luma, luma, luma, qAlpha(srcLine[x]));
+            }
         }
-    }
+    });
 
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
@@ -21,6 +21,7 @@
 #include <QQmlContext>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akvideofilterrunner.h>
 
 #include "pixelateelement.h"
 
@@ -92,19 +93,97 @@ AkPacket PixelateElement::iStream(const AkPacket &packet)
     if (src.isNull())
         return AkPacket();
 
-    QImage oFrame = src.convertToFormat(QImage::Format_ARGB32);
+    src = src.convertToFormat(QImage::Format_ARGB32);
+    QImage oFrame(src.size(), src.format());
+
+    int width = src.width();
+    int height = src.height();
+    int stride = 4 * (width + 1);
+
+    /* Summed-area table of the frame, RGBA interleaved with a zeroed
+     * border row and column. Each block average costs four lookups,
+     * whatever the block size.
+     */
+    auto integral =
+            reinterpret_cast<quint32 *>(this->scratchPlane("integral",
+                                                           QSize(width + 1,
+                                                                 height + 1),
+                                                           4 * sizeof(quint32)));
+    memset(integral, 0, size_t(stride) * sizeof(quint32));
+
+    // Horizontal prefix sums, one row per band.
+    AkVideoFilterRunner::globalRunner()->run(height, [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            auto iLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
+            quint32 *sums = integral + (y + 1) * stride;
+            quint32 r = 0;
+            quint32 g = 0;
+            quint32 b = 0;
+            quint32 a = 0;
+            sums[0] = sums[1] = sums[2] = sums[3] = 0;
+
+            for (int x = 0; x < width; x++) {
+                r += quint32(qRed(iLine[x]));
+                g += quint32(qGreen(iLine[x]));
+                b += quint32(qBlue(iLine[x]));
+                a += quint32(qAlpha(iLine[x]));
+
+                quint32 *sum = sums + 4 * (x + 1);
+                sum[0] = r;
+                sum[1] = g;
+                sum[2] = b;
+                sum[3] = a;
+            }
+        }
+    });
 
-    qreal sw = 1.0 / blockSize.width();
-    qreal sh = 1.0 / blockSize.height();
+    // Vertical accumulation, one column band per thread.
+    AkVideoFilterRunner::globalRunner()->run(width + 1,
+                                             [&] (int xStart, int xEnd) {
+        for (int y = 1; y <= height; y++) {
+            quint32 *line = integral + y * stride;
+            const quint32 *up = line - stride;
 
-    oFrame = oFrame.scaled(int(sw * oFrame.width()),
-                           int(sh * oFrame.height()),
-                           Qt::IgnoreAspectRatio,
-                           Qt::FastTransformation)
-                   .scaled(oFrame.width(),
-                           oFrame.height(),
-                           Qt::IgnoreAspectRatio,
-                           Qt::FastTransformation);
+            for (int i = 4 * xStart; i < 4 * xEnd; i++)
+                line[i] += up[i];
+        }
+    });
+
+    int blockWidth = blockSize.width();
+    int blockHeight = blockSize.height();
+
+    AkVideoFilterRunner::globalRunner()->run(height, [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            QRgb *oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+            int y0 = blockHeight * (y / blockHeight);
+            int y1 = qMin(y0 + blockHeight, height);
+            const quint32 *top = integral + y0 * stride;
+            const quint32 *bottom = integral + y1 * stride;
+
+            for (int x0 = 0; x0 < width; x0 += blockWidth) {
+                int x1 = qMin(x0 + blockWidth, width);
+                quint32 area = quint32((x1 - x0) * (y1 - y0));
+                int i0 = 4 * x0;
+                int i1 = 4 * x1;
+
+                quint32 r = bottom[i1] - bottom[i0] - top[i1] + top[i0];
+                quint32 g = bottom[i1 + 1] - bottom[i0 + 1]
+                            - top[i1 + 1] + top[i0 + 1];
+                quint32 b = bottom[i1 + 2] - bottom[i0 + 2]
+                            - top[i1 + 2] + top[i0 + 2];
+                quint32 a = bottom[i1 + 3] - bottom[i0 + 3]
+                            - top[i1 + 3] + top[i0 + 3];
+
+                QRgb color = qRgba(int(r / area),
+                                   int(g / area),
+                                   int(b / area),
+                                   int(a / area));
+
+                for (int x = x0; x < x1; x++)
+                    oLine[x] = color;
+            }
+        }
+    });
 
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
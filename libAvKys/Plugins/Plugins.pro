@@ -26,11 +26,16 @@ SUBDIRS += \
     AudioDevice \
     AudioGen \
     Bin \
+    Compositor \
     DesktopCapture \
+    FpsConvert \
     Multiplex \
     MultiSink \
     MultiSrc \
     Probe \
+    Proxy \
+    RemoteOffload \
+    SceneGate \
     VideoCapture \
     VirtualCamera
 
@@ -76,11 +81,13 @@ isEmpty(NOVIDEOEFFECTS): SUBDIRS += \
     Quark \
     Radioactive \
     Ripple \
+    Scale \
     ScanLines \
     Scroll \
     Shagadelic \
     Swirl \
     Temperature \
+    TemporalDenoise \
     Vignette \
     Warhol \
     Warp \
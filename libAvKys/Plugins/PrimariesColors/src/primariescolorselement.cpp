@@ -21,6 +21,11 @@
 #include <QQmlContext>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akvideofilterrunner.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #include "primariescolorselement.h"
 
@@ -74,6 +79,7 @@ AkPacket PrimariesColorsElement::iStream(const AkPacket &packet)
     src = src.convertToFormat(QImage::Format_ARGB32);
     QImage oFrame(src.size(), src.format());
 
+    int width = src.width();
     int f = this->m_factor + 1;
     int factor127 = (f * f - 3) * 127;
     int factorTot = f * f;
@@ -83,31 +89,89 @@ AkPacket PrimariesColorsElement::iStream(const AkPacket &packet)
         factorTot = 3;
     }
 
-    for (int y = 0; y < src.height(); y++) {
-        const QRgb *srcLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
-        QRgb *destLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
-
-        for (int x = 0; x < src.width(); x++) {
-            QRgb pixel = srcLine[x];
-
-            int ri = qRed(pixel);
-            int gi = qGreen(pixel);
-            int bi = qBlue(pixel);
-
-            int mean;
+    /* The original test was c > (r + g + b + factor127) / factorTot, which
+     * is exactly c * factorTot > r + g + b + factor127, so the per-pixel
+     * division goes away. Above f = 32 the mean saturates at 127; folding
+     * that into the constants keeps a single compare everywhere. */
+    int sumScale = 1;
 
-            if (f > 32)
-                mean = 127;
-            else
-                mean = (ri + gi + bi + factor127) / factorTot;
-
-            int r = ri > mean? 255: 0;
-            int g = gi > mean? 255: 0;
-            int b = bi > mean? 255: 0;
+    if (f > 32) {
+        sumScale = 0;
+        factor127 = 127;
+        factorTot = 1;
+    }
 
-            destLine[x] = qRgba(r, g, b, qAlpha(pixel));
+    AkVideoFilterRunner::globalRunner()->run(src.height(),
+                                             [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            const QRgb *srcLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
+            QRgb *destLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+            int x = 0;
+
+#if defined(__SSE2__)
+            // 4 pixels per iteration, thresholding the channels against
+            // their scaled sum and keeping the alpha byte untouched.
+            __m128i zero = _mm_setzero_si128();
+            __m128i sumCoeff = _mm_set_epi16(0, sumScale, sumScale, sumScale,
+                                             0, sumScale, sumScale, sumScale);
+            __m128i f127 = _mm_set1_epi32(factor127);
+            __m128i fTot = _mm_set1_epi16(qint16(factorTot));
+            __m128i rgbMask = _mm_set1_epi32(0x00ffffff);
+            __m128i alphaMask = _mm_set1_epi32(int(0xff000000));
+
+            auto primariesOf2 = [&] (__m128i half) -> __m128i {
+                // 'half' holds two pixels as 16 bit [B G R A] lanes.
+                __m128i sums = _mm_madd_epi16(half, sumCoeff);
+                sums = _mm_add_epi32(sums, _mm_srli_si128(sums, 4));
+                sums = _mm_add_epi32(sums, f127);
+
+                // Widen channel * factorTot to 32 bits, it can overflow
+                // a 16 bit lane.
+                __m128i prodLo = _mm_mullo_epi16(half, fTot);
+                __m128i prodHi = _mm_mulhi_epu16(half, fTot);
+                __m128i prod0 = _mm_unpacklo_epi16(prodLo, prodHi);
+                __m128i prod1 = _mm_unpackhi_epi16(prodLo, prodHi);
+
+                __m128i m0 =
+                        _mm_cmpgt_epi32(prod0,
+                                        _mm_shuffle_epi32(sums,
+                                                          _MM_SHUFFLE(0, 0, 0, 0)));
+                __m128i m1 =
+                        _mm_cmpgt_epi32(prod1,
+                                        _mm_shuffle_epi32(sums,
+                                                          _MM_SHUFFLE(2, 2, 2, 2)));
+
+                return _mm_packs_epi32(m0, m1);
+            };
+
+            for (; x < width - 3; x += 4) {
+                __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i *>(srcLine + x));
+                __m128i masks =
+                        _mm_packs_epi16(primariesOf2(_mm_unpacklo_epi8(p, zero)),
+                                        primariesOf2(_mm_unpackhi_epi8(p, zero)));
+                __m128i out = _mm_or_si128(_mm_and_si128(masks, rgbMask),
+                                           _mm_and_si128(p, alphaMask));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(destLine + x),
+                                 out);
+            }
+#endif
+
+            for (; x < width; x++) {
+                QRgb pixel = srcLine[x];
+
+                int ri = qRed(pixel);
+                int gi = qGreen(pixel);
+                int bi = qBlue(pixel);
+                int sum = sumScale * (ri + gi + bi) + factor127;
+
+                int r = ri * factorTot > sum? 255: 0;
+                int g = gi * factorTot > sum? 255: 0;
+                int b = bi * factorTot > sum? 255: 0;
+
+                destLine[x] = qRgba(r, g, b, qAlpha(pixel));
+            }
         }
-    }
+    });
 
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
@@ -24,37 +24,70 @@
 
 ProbeElement::ProbeElement(): AkElement()
 {
-    this->m_log = false;
+    this->m_log.storeRelease(false);
+    this->m_sampleInterval.storeRelease(1);
+    this->m_packetIndex.storeRelease(0);
 }
 
 bool ProbeElement::log() const
 {
-    return this->m_log;
+    return this->m_log.loadAcquire();
+}
+
+int ProbeElement::sampleInterval() const
+{
+    return this->m_sampleInterval.loadAcquire();
 }
 
 void ProbeElement::setLog(bool log)
 {
-    if (this->m_log == log)
+    if (this->m_log.fetchAndStoreRelease(log) == int(log))
         return;
 
-    this->m_log = log;
     emit this->logChanged(log);
 }
 
+void ProbeElement::setSampleInterval(int sampleInterval)
+{
+    sampleInterval = qMax(sampleInterval, 1);
+
+    if (this->m_sampleInterval.fetchAndStoreRelease(sampleInterval)
+        == sampleInterval)
+        return;
+
+    emit this->sampleIntervalChanged(sampleInterval);
+}
+
 void ProbeElement::resetLog()
 {
     this->setLog(false);
 }
 
+void ProbeElement::resetSampleInterval()
+{
+    this->setSampleInterval(1);
+}
+
 AkPacket ProbeElement::iStream(const AkPacket &packet)
 {
-    if (this->m_log) {
-        qDebug().nospace() << "\"" << this->objectName().toStdString().c_str() << "\"";
+    // Disabled probes cost one atomic read per packet, nothing else.
+    if (!this->m_log.loadAcquire())
+        akSend(packet);
+
+    int sampleInterval = this->m_sampleInterval.loadAcquire();
+
+    if (sampleInterval > 1
+        && this->m_packetIndex.fetchAndAddRelaxed(1) % sampleInterval)
+        akSend(packet);
+
+    /* toString() only reports the caps and the buffer size, the pixel
+     * data itself is never read, so sampled packets stay untouched in
+     * their buffers. */
+    qDebug().nospace() << "\"" << this->objectName().toStdString().c_str() << "\"";
 
-        for (const QString &line: packet.toString().split('\n'))
-            qDebug().nospace() << "\t"
-                               << line.toStdString().c_str();
-    }
+    for (const QString &line: packet.toString().split('\n'))
+        qDebug().nospace() << "\t"
+                           << line.toStdString().c_str();
 
     akSend(packet);
 }
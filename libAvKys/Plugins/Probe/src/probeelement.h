@@ -20,6 +20,7 @@
 #ifndef PROBEELEMENT_H
 #define PROBEELEMENT_H
 
+#include <QAtomicInt>
 #include <akelement.h>
 
 class ProbeElement: public AkElement
@@ -30,21 +31,38 @@ class ProbeElement: public AkElement
                WRITE setLog
                RESET resetLog
                NOTIFY logChanged)
+    // Inspect one packet out of every sampleInterval. The remaining
+    // packets only pay an atomic counter increment, so a probe can stay
+    // wired in a production pipeline.
+    Q_PROPERTY(int sampleInterval
+               READ sampleInterval
+               WRITE setSampleInterval
+               RESET resetSampleInterval
+               NOTIFY sampleIntervalChanged)
 
     public:
         explicit ProbeElement();
 
         Q_INVOKABLE bool log() const;
+        Q_INVOKABLE int sampleInterval() const;
 
     private:
-        bool m_log;
+        /* Read on every packet from the stream threads and written from
+         * the UI thread, so they are atomics; the packet path never takes
+         * a lock. */
+        QAtomicInt m_log;
+        QAtomicInt m_sampleInterval;
+        QAtomicInt m_packetIndex;
 
     signals:
         void logChanged(bool log);
+        void sampleIntervalChanged(int sampleInterval);
 
     public slots:
         void setLog(bool log);
+        void setSampleInterval(int sampleInterval);
         void resetLog();
+        void resetSampleInterval();
 
         AkPacket iStream(const AkPacket &packet);
 };
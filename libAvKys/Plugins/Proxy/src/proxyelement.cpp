@@ -0,0 +1,167 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QImage>
+#include <akutils.h>
+#include <akpacket.h>
+
+#include "proxyelement.h"
+
+class ProxyElementPrivate
+{
+    public:
+        QString m_description;
+        int m_divisor;
+        AkElementPtr m_bin;
+        AkPacket m_chainPacket;
+
+        ProxyElementPrivate():
+            m_divisor(2)
+        {
+        }
+};
+
+ProxyElement::ProxyElement(): AkElement()
+{
+    this->d = new ProxyElementPrivate;
+    this->d->m_bin = AkElement::create("Bin");
+
+    if (this->d->m_bin)
+        /* The whole chain runs synchronously on the calling thread, so a
+         * direct connection hands the result back before iStream returns. */
+        QObject::connect(this->d->m_bin.data(),
+                         SIGNAL(oStream(const AkPacket &)),
+                         this,
+                         SLOT(chainStream(const AkPacket &)),
+                         Qt::DirectConnection);
+}
+
+ProxyElement::~ProxyElement()
+{
+    delete this->d;
+}
+
+QString ProxyElement::description() const
+{
+    return this->d->m_description;
+}
+
+int ProxyElement::divisor() const
+{
+    return this->d->m_divisor;
+}
+
+void ProxyElement::setDescription(const QString &description)
+{
+    if (this->d->m_description == description)
+        return;
+
+    this->d->m_description = description;
+
+    if (this->d->m_bin)
+        this->d->m_bin->setProperty("description", description);
+
+    emit this->descriptionChanged(description);
+}
+
+void ProxyElement::setDivisor(int divisor)
+{
+    if (this->d->m_divisor == divisor)
+        return;
+
+    this->d->m_divisor = divisor;
+    emit this->divisorChanged(divisor);
+}
+
+void ProxyElement::resetDescription()
+{
+    this->setDescription("");
+}
+
+void ProxyElement::resetDivisor()
+{
+    this->setDivisor(2);
+}
+
+AkPacket ProxyElement::iStream(const AkPacket &packet)
+{
+    if (this->d->m_description.isEmpty() || !this->d->m_bin)
+        akSend(packet)
+
+    QImage src = AkUtils::packetToImage(packet);
+
+    if (src.isNull())
+        return AkPacket();
+
+    int divisor = qMax(this->d->m_divisor, 1);
+    QSize proxySize(qMax(src.width() / divisor, 1),
+                    qMax(src.height() / divisor, 1));
+
+    /* Nearest sampling on the way down; the chain is meant to hold effects
+     * that wipe out fine detail anyway, so a filtered downscale would only
+     * add cost. */
+    QImage proxy = src.scaled(proxySize,
+                              Qt::IgnoreAspectRatio,
+                              Qt::FastTransformation);
+
+    this->d->m_chainPacket = AkPacket();
+    this->d->m_bin->iStream(AkUtils::imageToPacket(proxy, packet));
+
+    // An unconfigured or blocking chain drops the frame, pass it through.
+    if (!this->d->m_chainPacket)
+        akSend(packet)
+
+    QImage processed = AkUtils::packetToImage(this->d->m_chainPacket);
+
+    if (processed.isNull())
+        akSend(packet)
+
+    // Bilinear on the way up hides the proxy grid, and costs a fraction
+    // of the full resolution effects it replaces.
+    QImage oFrame = processed.scaled(src.size(),
+                                     Qt::IgnoreAspectRatio,
+                                     Qt::SmoothTransformation);
+
+    AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
+    akSend(oPacket)
+}
+
+bool ProxyElement::setState(AkElement::ElementState state)
+{
+    bool ok = AkElement::setState(state);
+
+    if (this->d->m_bin) {
+        bool ret = false;
+        QMetaObject::invokeMethod(this->d->m_bin.data(),
+                                  "setState",
+                                  Q_RETURN_ARG(bool, ret),
+                                  Q_ARG(AkElement::ElementState,
+                                        this->state()));
+        ok &= ret;
+    }
+
+    return ok;
+}
+
+void ProxyElement::chainStream(const AkPacket &packet)
+{
+    this->d->m_chainPacket = packet;
+}
+
+#include "moc_proxyelement.cpp"
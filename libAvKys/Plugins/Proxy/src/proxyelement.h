@@ -0,0 +1,77 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef PROXYELEMENT_H
+#define PROXYELEMENT_H
+
+#include <akelement.h>
+
+class ProxyElementPrivate;
+
+/* Runs a child chain at reduced resolution.
+ *
+ * Frames are downscaled by 'divisor' per axis, processed by the Bin
+ * described in 'description', and scaled back up to the source size.
+ * Effects whose output has no fine detail of its own (blurs, glows,
+ * vignette masks) look the same either way, but their per pixel cost
+ * drops with the square of the divisor.
+ */
+class ProxyElement: public AkElement
+{
+    Q_OBJECT
+    // Child chain, in Bin's pipeline description syntax.
+    Q_PROPERTY(QString description
+               READ description
+               WRITE setDescription
+               RESET resetDescription
+               NOTIFY descriptionChanged)
+    Q_PROPERTY(int divisor
+               READ divisor
+               WRITE setDivisor
+               RESET resetDivisor
+               NOTIFY divisorChanged)
+
+    public:
+        explicit ProxyElement();
+        ~ProxyElement();
+
+        Q_INVOKABLE QString description() const;
+        Q_INVOKABLE int divisor() const;
+
+    private:
+        ProxyElementPrivate *d;
+
+    signals:
+        void descriptionChanged(const QString &description);
+        void divisorChanged(int divisor);
+
+    public slots:
+        void setDescription(const QString &description);
+        void setDivisor(int divisor);
+        void resetDescription();
+        void resetDivisor();
+
+        AkPacket iStream(const AkPacket &packet);
+        bool setState(AkElement::ElementState state);
+
+    private slots:
+        void chainStream(const AkPacket &packet);
+};
+
+#endif // PROXYELEMENT_H
@@ -19,8 +19,10 @@
 
 #include <QImage>
 #include <QQmlContext>
+#include <QVector>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akvideofilterrunner.h>
 
 #include "quarkelement.h"
 
@@ -97,20 +99,46 @@ AkPacket QuarkElement::iStream(const AkPacket &packet)
     }
 
     int nFrames = this->d->m_nFrames > 0? this->d->m_nFrames: 1;
-    this->d->m_frames << src.copy();
-    int diff = this->d->m_frames.size() - nFrames;
 
-    for (int i = 0; i < diff; i++)
+    while (this->d->m_frames.size() > nFrames)
         this->d->m_frames.removeFirst();
 
-    for (int y = 0; y < src.height(); y++) {
-        QRgb *dstLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+    if (this->d->m_frames.size() == nFrames) {
+        /* The ring is full, so recycle the oldest frame as storage for
+         * the new one instead of allocating a copy per frame. */
+        QImage frame = this->d->m_frames.takeFirst();
+        memcpy(frame.bits(), src.constBits(), size_t(src.byteCount()));
+        this->d->m_frames << frame;
+    } else {
+        this->d->m_frames << src.copy();
+    }
 
-        for (int x = 0; x < src.width(); x++) {
-            int frame = qrand() % this->d->m_frames.size();
-            dstLine[x] = this->d->m_frames[frame].pixel(x, y);
+    /* Sample the history with direct scanline access; QImage::pixel()
+     * revalidates the coordinates and dispatches on the format for
+     * every call. */
+    int framesCount = this->d->m_frames.size();
+    QVector<const uchar *> frameBits(framesCount);
+
+    for (int i = 0; i < framesCount; i++)
+        frameBits[i] = this->d->m_frames[i].constBits();
+
+    int width = src.width();
+    int bytesPerLine = src.bytesPerLine();
+
+    AkVideoFilterRunner::globalRunner()->run(src.height(),
+                                             [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            auto dstLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+
+            for (int x = 0; x < width; x++) {
+                int frame = qrand() % framesCount;
+                auto srcLine =
+                        reinterpret_cast<const QRgb *>(frameBits[frame]
+                                                       + y * bytesPerLine);
+                dstLine[x] = srcLine[x];
+            }
         }
-    }
+    });
 
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
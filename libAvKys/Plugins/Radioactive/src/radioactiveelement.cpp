@@ -18,10 +18,11 @@
  */
 
 #include <QtMath>
-#include <QPainter>
+#include <QVector>
 #include <QQmlContext>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akvideofilterrunner.h>
 
 #include "radioactiveelement.h"
 
@@ -53,6 +54,7 @@ class RadioactiveElementPrivate
         QSize m_frameSize;
         QImage m_prevFrame;
         QImage m_blurZoomBuffer;
+        QImage m_blurred;
         AkElementPtr m_blurFilter;
 
         RadioactiveElementPrivate():
@@ -64,14 +66,6 @@ class RadioactiveElementPrivate
             m_radColor(qRgb(0, 255, 0))
         {
         }
-
-        inline QImage imageDiff(const QImage &img1,
-                                const QImage &img2,
-                                int threshold,
-                                int lumaThreshold,
-                                QRgb radColor,
-                                RadioactiveElement::RadiationMode mode);
-        inline QImage imageAlphaDiff(const QImage &src, int alphaDiff);
 };
 
 RadioactiveElement::RadioactiveElement(): AkElement()
@@ -126,92 +120,6 @@ QRgb RadioactiveElement::radColor() const
     return this->d->m_radColor;
 }
 
-QImage RadioactiveElementPrivate::imageDiff(const QImage &img1,
-                                            const QImage &img2,
-                                            int threshold,
-                                            int lumaThreshold,
-                                            QRgb radColor,
-                                            RadioactiveElement::RadiationMode mode)
-{
-    int width = qMin(img1.width(), img2.width());
-    int height = qMin(img1.height(), img2.height());
-    QImage diff(width, height, img1.format());
-
-    for (int y = 0; y < height; y++) {
-        const QRgb *iLine1 = reinterpret_cast<const QRgb *>(img1.constScanLine(y));
-        const QRgb *iLine2 = reinterpret_cast<const QRgb *>(img2.constScanLine(y));
-        QRgb *oLine = reinterpret_cast<QRgb *>(diff.scanLine(y));
-
-        for (int x = 0; x < width; x++) {
-            int r1 = qRed(iLine1[x]);
-            int g1 = qGreen(iLine1[x]);
-            int b1 = qBlue(iLine1[x]);
-
-            int r2 = qRed(iLine2[x]);
-            int g2 = qGreen(iLine2[x]);
-            int b2 = qBlue(iLine2[x]);
-
-            int dr = r1 - r2;
-            int dg = g1 - g2;
-            int db = b1 - b2;
-
-            int alpha = dr * dr + dg * dg + db * db;
-            alpha = int(sqrt(alpha / 3));
-
-            if (mode == RadioactiveElement::RadiationModeSoftNormal
-                || mode == RadioactiveElement::RadiationModeSoftColor)
-                alpha = alpha < threshold? 0: alpha;
-            else
-                alpha = alpha < threshold? 0: 255;
-
-            int gray = qGray(iLine2[x]);
-
-            alpha = gray < lumaThreshold? 0: alpha;
-
-            int r;
-            int g;
-            int b;
-
-            if (mode == RadioactiveElement::RadiationModeHardNormal
-                || mode == RadioactiveElement::RadiationModeSoftNormal) {
-                r = r2;
-                g = g2;
-                b = b2;
-            } else {
-                r = qRed(radColor);
-                g = qGreen(radColor);
-                b = qBlue(radColor);
-            }
-
-            oLine[x] = qRgba(r, g, b, alpha);
-        }
-    }
-
-    return diff;
-}
-
-QImage RadioactiveElementPrivate::imageAlphaDiff(const QImage &src,
-                                                 int alphaDiff)
-{
-    QImage dest(src.size(), src.format());
-
-    for (int y = 0; y < src.height(); y++) {
-        const QRgb *srcLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
-        QRgb *dstLine = reinterpret_cast<QRgb *>(dest.scanLine(y));
-
-        for (int x = 0; x < src.width(); x++) {
-            QRgb pixel = srcLine[x];
-            int r = qRed(pixel);
-            int g = qGreen(pixel);
-            int b = qBlue(pixel);
-            int a = qBound(0, qAlpha(pixel) + alphaDiff, 255);
-            dstLine[x] = qRgba(r, g, b, a);
-        }
-    }
-
-    return dest;
-}
-
 QString RadioactiveElement::controlInterfaceProvide(const QString &controlId) const
 {
     Q_UNUSED(controlId)
@@ -337,6 +245,7 @@ AkPacket RadioactiveElement::iStream(const AkPacket &packet)
 
     if (src.size() != this->d->m_frameSize) {
         this->d->m_blurZoomBuffer = QImage();
+        this->d->m_blurred = QImage();
         this->d->m_prevFrame = QImage();
         this->d->m_frameSize = src.size();
     }
@@ -345,49 +254,245 @@ AkPacket RadioactiveElement::iStream(const AkPacket &packet)
         oFrame = src;
         this->d->m_blurZoomBuffer = QImage(src.size(), src.format());
         this->d->m_blurZoomBuffer.fill(qRgba(0, 0, 0, 0));
+        this->d->m_blurred = QImage(src.size(), src.format());
     } else {
-        // Compute the difference between previous and current frame,
-        // and save it to the buffer.
-        QImage diff =
-                this->d->imageDiff(this->d->m_prevFrame,
-                                   src,
-                                   this->d->m_threshold,
-                                   this->d->m_lumaThreshold,
-                                   this->d->m_radColor,
-                                   this->d->m_mode);
-
-        QPainter painter;
-        painter.begin(&this->d->m_blurZoomBuffer);
-        painter.drawImage(0, 0, diff);
-        painter.end();
-
-        // Blur buffer.
-        AkPacket blurZoomPacket = AkUtils::imageToPacket(this->d->m_blurZoomBuffer, packet);
-        AkPacket blurPacket = this->d->m_blurFilter->iStream(blurZoomPacket);
-        QImage blur = AkUtils::packetToImage(blurPacket);
-
-        // Zoom buffer.
-        QImage blurScaled = blur.scaled(this->d->m_zoom * blur.size());
-        QSize diffSize = blur.size() - blurScaled.size();
-        QPoint p(diffSize.width() >> 1,
-                 diffSize.height() >> 1);
-
-        QImage zoom(blur.size(), blur.format());
-        zoom.fill(qRgba(0, 0, 0, 0));
-
-        painter.begin(&zoom);
-        painter.drawImage(p, blurScaled);
-        painter.end();
-
-        // Reduce alpha.
-        QImage alphaDiff = this->d->imageAlphaDiff(zoom, this->d->m_alphaDiff);
-        this->d->m_blurZoomBuffer = alphaDiff;
-
-        // Apply buffer.
-        painter.begin(&oFrame);
-        painter.drawImage(0, 0, src);
-        painter.drawImage(0, 0, this->d->m_blurZoomBuffer);
-        painter.end();
+        int width = src.width();
+        int height = src.height();
+        auto runner = AkVideoFilterRunner::globalRunner();
+        QImage &buffer = this->d->m_blurZoomBuffer;
+        QImage &blurred = this->d->m_blurred;
+
+        /* Compute the difference between previous and current frame,
+         * composed over the persistent buffer in the same pass instead
+         * of through an intermediate diff image and a painter draw. */
+        int threshold = this->d->m_threshold;
+        int lumaThreshold = this->d->m_lumaThreshold;
+        QRgb radColor = this->d->m_radColor;
+        RadiationMode mode = this->d->m_mode;
+        bool soft = mode == RadiationModeSoftNormal
+                    || mode == RadiationModeSoftColor;
+        bool colorize = mode == RadiationModeSoftColor
+                        || mode == RadiationModeHardColor;
+
+        runner->run(height, [&] (int yStart, int yEnd) {
+            for (int y = yStart; y < yEnd; y++) {
+                auto prevLine = reinterpret_cast<const QRgb *>(this->d->m_prevFrame.constScanLine(y));
+                auto srcLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
+                auto bufLine = reinterpret_cast<QRgb *>(buffer.scanLine(y));
+
+                for (int x = 0; x < width; x++) {
+                    int r = qRed(srcLine[x]);
+                    int g = qGreen(srcLine[x]);
+                    int b = qBlue(srcLine[x]);
+
+                    int dr = qRed(prevLine[x]) - r;
+                    int dg = qGreen(prevLine[x]) - g;
+                    int db = qBlue(prevLine[x]) - b;
+
+                    int alpha = dr * dr + dg * dg + db * db;
+                    alpha = int(sqrt(alpha / 3));
+
+                    if (soft)
+                        alpha = alpha < threshold? 0: alpha;
+                    else
+                        alpha = alpha < threshold? 0: 255;
+
+                    if (qGray(srcLine[x]) < lumaThreshold)
+                        alpha = 0;
+
+                    if (colorize) {
+                        r = qRed(radColor);
+                        g = qGreen(radColor);
+                        b = qBlue(radColor);
+                    }
+
+                    // Straight-alpha source-over of the diff pixel.
+                    QRgb bg = bufLine[x];
+                    int ba = qAlpha(bg);
+                    int oa255 = 255 * alpha + ba * (255 - alpha);
+
+                    if (oa255 < 1)
+                        bufLine[x] = qRgba(0, 0, 0, 0);
+                    else
+                        bufLine[x] =
+                            qRgba((255 * r * alpha + qRed(bg) * ba * (255 - alpha)) / oa255,
+                                  (255 * g * alpha + qGreen(bg) * ba * (255 - alpha)) / oa255,
+                                  (255 * b * alpha + qBlue(bg) * ba * (255 - alpha)) / oa255,
+                                  oa255 / 255);
+                }
+            }
+        });
+
+        /* Blur the buffer with the same clamped-window box mean the Blur
+         * element computes, but inline as two separable passes over a
+         * pooled scratch plane instead of a packet round trip through
+         * the child element. The element stays as the holder of the
+         * radius property. */
+        int radius = qMax(this->d->m_blurFilter->property("radius").toInt(), 0);
+        auto hSum = reinterpret_cast<quint32 *>(this->scratchPlane("hSum",
+                                                                  src.size(),
+                                                                  4 * sizeof(quint32)));
+
+        runner->run(height, [&] (int yStart, int yEnd) {
+            for (int y = yStart; y < yEnd; y++) {
+                auto line = reinterpret_cast<const QRgb *>(buffer.constScanLine(y));
+                quint32 *sumLine = hSum + 4 * y * width;
+                quint32 sr = 0;
+                quint32 sg = 0;
+                quint32 sb = 0;
+                quint32 sa = 0;
+
+                for (int x = 0; x <= qMin(radius, width - 1); x++) {
+                    sr += quint32(qRed(line[x]));
+                    sg += quint32(qGreen(line[x]));
+                    sb += quint32(qBlue(line[x]));
+                    sa += quint32(qAlpha(line[x]));
+                }
+
+                for (int x = 0; x < width; x++) {
+                    sumLine[4 * x] = sr;
+                    sumLine[4 * x + 1] = sg;
+                    sumLine[4 * x + 2] = sb;
+                    sumLine[4 * x + 3] = sa;
+
+                    int addX = x + radius + 1;
+
+                    if (addX < width) {
+                        sr += quint32(qRed(line[addX]));
+                        sg += quint32(qGreen(line[addX]));
+                        sb += quint32(qBlue(line[addX]));
+                        sa += quint32(qAlpha(line[addX]));
+                    }
+
+                    int remX = x - radius;
+
+                    if (remX >= 0) {
+                        sr -= quint32(qRed(line[remX]));
+                        sg -= quint32(qGreen(line[remX]));
+                        sb -= quint32(qBlue(line[remX]));
+                        sa -= quint32(qAlpha(line[remX]));
+                    }
+                }
+            }
+        });
+
+        QVector<int> kw(width);
+
+        for (int x = 0; x < width; x++)
+            kw[x] = qMin(x + radius, width - 1) - qMax(x - radius, 0) + 1;
+
+        runner->run(height, [&] (int yStart, int yEnd) {
+            for (int y = yStart; y < yEnd; y++) {
+                int yp = qMax(y - radius, 0);
+                int kh = qMin(y + radius, height - 1) - yp + 1;
+                auto oLine = reinterpret_cast<QRgb *>(blurred.scanLine(y));
+
+                for (int x = 0; x < width; x++) {
+                    quint32 sr = 0;
+                    quint32 sg = 0;
+                    quint32 sb = 0;
+                    quint32 sa = 0;
+
+                    for (int yy = yp; yy < yp + kh; yy++) {
+                        const quint32 *sum = hSum + 4 * (yy * width + x);
+                        sr += sum[0];
+                        sg += sum[1];
+                        sb += sum[2];
+                        sa += sum[3];
+                    }
+
+                    quint32 n = quint32(kw[x] * kh);
+                    oLine[x] = qRgba(int(sr / n),
+                                     int(sg / n),
+                                     int(sb / n),
+                                     int(sa / n));
+                }
+            }
+        });
+
+        /* Zoom the blurred glow back into the buffer as the inverse map
+         * of the centered scaled draw, walked with fixed-point scanline
+         * increments, with the alpha decay folded into the same pass. */
+        static const int fpShift = 16;
+        int alphaDiff = this->d->m_alphaDiff;
+        QSize scaledSize = this->d->m_zoom * src.size();
+        int sw = scaledSize.width();
+        int sh = scaledSize.height();
+        int px = (width - sw) >> 1;
+        int py = (height - sh) >> 1;
+
+        if (sw < 1 || sh < 1) {
+            buffer.fill(qRgba(0, 0, 0, 0));
+        } else {
+            qint64 xStepFp = (qint64(width) << fpShift) / sw;
+            qint64 yStepFp = (qint64(height) << fpShift) / sh;
+            int xStart = qMax(px, 0);
+            int xEnd = qMin(px + sw, width);
+
+            runner->run(height, [&] (int yStart, int yEndBand) {
+                for (int y = yStart; y < yEndBand; y++) {
+                    auto bufLine = reinterpret_cast<QRgb *>(buffer.scanLine(y));
+                    int ys = y - py;
+
+                    if (ys < 0 || ys >= sh) {
+                        for (int x = 0; x < width; x++)
+                            bufLine[x] = qRgba(0, 0, 0, 0);
+
+                        continue;
+                    }
+
+                    int yb = int((qint64(ys) * yStepFp) >> fpShift);
+                    auto blurLine = reinterpret_cast<const QRgb *>(blurred.constScanLine(yb));
+
+                    for (int x = 0; x < xStart; x++)
+                        bufLine[x] = qRgba(0, 0, 0, 0);
+
+                    qint64 sxFp = qint64(xStart - px) * xStepFp;
+
+                    for (int x = xStart; x < xEnd; x++) {
+                        QRgb pixel = blurLine[int(sxFp >> fpShift)];
+                        bufLine[x] = qRgba(qRed(pixel),
+                                           qGreen(pixel),
+                                           qBlue(pixel),
+                                           qBound(0, qAlpha(pixel) + alphaDiff, 255));
+                        sxFp += xStepFp;
+                    }
+
+                    for (int x = xEnd; x < width; x++)
+                        bufLine[x] = qRgba(0, 0, 0, 0);
+                }
+            });
+        }
+
+        /* Apply the buffer over the source, one parallel blend pass
+         * instead of two painter draws. */
+        runner->run(height, [&] (int yStart, int yEnd) {
+            for (int y = yStart; y < yEnd; y++) {
+                auto srcLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
+                auto bufLine = reinterpret_cast<const QRgb *>(buffer.constScanLine(y));
+                auto oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+
+                for (int x = 0; x < width; x++) {
+                    QRgb fg = bufLine[x];
+                    int a = qAlpha(fg);
+
+                    if (a == 255) {
+                        oLine[x] = fg;
+                    } else if (a == 0) {
+                        oLine[x] = srcLine[x];
+                    } else {
+                        QRgb bg = srcLine[x];
+                        int ba = qAlpha(bg);
+                        int oa255 = 255 * a + ba * (255 - a);
+                        oLine[x] =
+                            qRgba((255 * qRed(fg) * a + qRed(bg) * ba * (255 - a)) / oa255,
+                                  (255 * qGreen(fg) * a + qGreen(bg) * ba * (255 - a)) / oa255,
+                                  (255 * qBlue(fg) * a + qBlue(bg) * ba * (255 - a)) / oa255,
+                                  oa255 / 255);
+                    }
+                }
+            }
+        });
     }
 
     this->d->m_prevFrame = src.copy();
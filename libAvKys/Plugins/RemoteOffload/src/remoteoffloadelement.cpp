@@ -0,0 +1,422 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QMutex>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QtEndian>
+#include <akpacket.h>
+#include <akpacketstream.h>
+
+#include "remoteoffloadelement.h"
+
+#define DEFAULT_PORT 40213
+#define DEFAULT_IN_FLIGHT 4
+
+class RemoteOffloadElementPrivate
+{
+    public:
+        QString m_role;
+        QString m_address;
+        int m_port;
+        QStringList m_effects;
+        int m_inFlight;
+        bool m_compression;
+
+        QTcpServer *m_server;
+        QTcpSocket *m_socket;
+        AkPacketStream m_writeStream;
+        AkPacketStream m_readStream;
+        QByteArray m_readBuffer;
+        QMutex m_mutex;
+        QList<AkElementPtr> m_chain;
+        int m_pending;
+        bool m_connected;
+
+        RemoteOffloadElementPrivate():
+            m_role("sender"),
+            m_address("127.0.0.1"),
+            m_port(DEFAULT_PORT),
+            m_inFlight(DEFAULT_IN_FLIGHT),
+            m_compression(false),
+            m_server(nullptr),
+            m_socket(nullptr),
+            m_pending(0),
+            m_connected(false)
+        {
+        }
+};
+
+RemoteOffloadElement::RemoteOffloadElement(): AkElement()
+{
+    this->d = new RemoteOffloadElementPrivate;
+}
+
+RemoteOffloadElement::~RemoteOffloadElement()
+{
+    this->stateChange(this->state(), AkElement::ElementStateNull);
+    delete this->d;
+}
+
+QString RemoteOffloadElement::role() const
+{
+    return this->d->m_role;
+}
+
+QString RemoteOffloadElement::address() const
+{
+    return this->d->m_address;
+}
+
+int RemoteOffloadElement::port() const
+{
+    return this->d->m_port;
+}
+
+QStringList RemoteOffloadElement::effects() const
+{
+    return this->d->m_effects;
+}
+
+int RemoteOffloadElement::inFlight() const
+{
+    return this->d->m_inFlight;
+}
+
+bool RemoteOffloadElement::compression() const
+{
+    return this->d->m_compression;
+}
+
+void RemoteOffloadElement::stateChange(AkElement::ElementState from,
+                                       AkElement::ElementState to)
+{
+    if (from == AkElement::ElementStateNull
+        && to != AkElement::ElementStateNull) {
+        if (this->d->m_role == "receiver") {
+            /* Build the effect chain once, linked directly, so a frame
+             * runs through it synchronously in the socket thread.
+             */
+            AkElementPtr previous;
+
+            for (auto &effect: this->d->m_effects) {
+                auto element = AkElement::create(effect);
+
+                if (!element)
+                    continue;
+
+                element->setState(AkElement::ElementStatePlaying);
+
+                if (previous)
+                    AkElement::link(previous, element, Qt::DirectConnection);
+
+                this->d->m_chain << element;
+                previous = element;
+            }
+
+            if (!this->d->m_chain.isEmpty())
+                QObject::connect(this->d->m_chain.last().data(),
+                                 &AkElement::oStream,
+                                 this,
+                                 [this] (const AkPacket &packet) {
+                                     this->sendMessage(this->packMessage(packet));
+                                 });
+
+            this->d->m_server = new QTcpServer(this);
+            QObject::connect(this->d->m_server,
+                             &QTcpServer::newConnection,
+                             this,
+                             &RemoteOffloadElement::clientConnected);
+            this->d->m_server->listen(QHostAddress::Any,
+                                      quint16(this->d->m_port));
+        } else {
+            this->d->m_socket = new QTcpSocket(this);
+            QObject::connect(this->d->m_socket,
+                             &QTcpSocket::readyRead,
+                             this,
+                             &RemoteOffloadElement::dataReady);
+            QObject::connect(this->d->m_socket,
+                             &QTcpSocket::connected,
+                             this,
+                             [this] () {
+                                 QMutexLocker locker(&this->d->m_mutex);
+                                 this->d->m_writeStream.reset();
+                                 this->d->m_readStream.reset();
+                                 this->d->m_pending = 0;
+                                 this->d->m_connected = true;
+                             });
+            QObject::connect(this->d->m_socket,
+                             &QTcpSocket::disconnected,
+                             this,
+                             [this] () {
+                                 QMutexLocker locker(&this->d->m_mutex);
+                                 this->d->m_pending = 0;
+                                 this->d->m_connected = false;
+                             });
+            this->d->m_socket->connectToHost(this->d->m_address,
+                                             quint16(this->d->m_port));
+        }
+    } else if (to == AkElement::ElementStateNull) {
+        this->d->m_mutex.lock();
+        this->d->m_connected = false;
+        this->d->m_pending = 0;
+        this->d->m_mutex.unlock();
+
+        if (this->d->m_socket) {
+            this->d->m_socket->abort();
+            delete this->d->m_socket;
+            this->d->m_socket = nullptr;
+        }
+
+        if (this->d->m_server) {
+            delete this->d->m_server;
+            this->d->m_server = nullptr;
+        }
+
+        for (auto &element: this->d->m_chain)
+            element->setState(AkElement::ElementStateNull);
+
+        this->d->m_chain.clear();
+        this->d->m_readBuffer.clear();
+    }
+}
+
+void RemoteOffloadElement::setRole(const QString &role)
+{
+    if (this->d->m_role == role)
+        return;
+
+    this->d->m_role = role;
+    emit this->roleChanged(role);
+}
+
+void RemoteOffloadElement::setAddress(const QString &address)
+{
+    if (this->d->m_address == address)
+        return;
+
+    this->d->m_address = address;
+    emit this->addressChanged(address);
+}
+
+void RemoteOffloadElement::setPort(int port)
+{
+    if (this->d->m_port == port)
+        return;
+
+    this->d->m_port = port;
+    emit this->portChanged(port);
+}
+
+void RemoteOffloadElement::setEffects(const QStringList &effects)
+{
+    if (this->d->m_effects == effects)
+        return;
+
+    this->d->m_effects = effects;
+    emit this->effectsChanged(effects);
+}
+
+void RemoteOffloadElement::setInFlight(int inFlight)
+{
+    if (this->d->m_inFlight == inFlight)
+        return;
+
+    this->d->m_inFlight = inFlight;
+    emit this->inFlightChanged(inFlight);
+}
+
+void RemoteOffloadElement::setCompression(bool compression)
+{
+    if (this->d->m_compression == compression)
+        return;
+
+    this->d->m_compression = compression;
+    emit this->compressionChanged(compression);
+}
+
+void RemoteOffloadElement::resetRole()
+{
+    this->setRole("sender");
+}
+
+void RemoteOffloadElement::resetAddress()
+{
+    this->setAddress("127.0.0.1");
+}
+
+void RemoteOffloadElement::resetPort()
+{
+    this->setPort(DEFAULT_PORT);
+}
+
+void RemoteOffloadElement::resetEffects()
+{
+    this->setEffects(QStringList());
+}
+
+void RemoteOffloadElement::resetInFlight()
+{
+    this->setInFlight(DEFAULT_IN_FLIGHT);
+}
+
+void RemoteOffloadElement::resetCompression()
+{
+    this->setCompression(false);
+}
+
+AkPacket RemoteOffloadElement::iStream(const AkPacket &packet)
+{
+    if (this->d->m_role == "receiver")
+        return AkPacket();
+
+    this->d->m_mutex.lock();
+
+    /* When the node is unreachable or the pipelining window is full the
+     * frame passes through unprocessed; losing the remote node degrades
+     * the stream instead of freezing it.
+     */
+    if (!this->d->m_connected
+        || this->d->m_pending >= this->d->m_inFlight) {
+        this->d->m_mutex.unlock();
+
+        akSend(packet)
+    }
+
+    auto message = this->packMessage(packet);
+    this->d->m_pending++;
+    this->d->m_mutex.unlock();
+
+    // The socket lives in the element's thread, hop over to it.
+    QMetaObject::invokeMethod(this,
+                              "sendMessage",
+                              Qt::QueuedConnection,
+                              Q_ARG(QByteArray, message));
+
+    return AkPacket();
+}
+
+QByteArray RemoteOffloadElement::packMessage(const AkPacket &packet)
+{
+    auto blob = this->d->m_writeStream.write(packet);
+
+    /* Fast lossless compression for slow links. Level 1 keeps the CPU
+     * cost low, video frames still shrink substantially.
+     */
+    if (this->d->m_compression)
+        blob = qCompress(blob, 1);
+
+    QByteArray message;
+    message.append(char(this->d->m_compression));
+    message.append(blob);
+
+    return message;
+}
+
+void RemoteOffloadElement::sendMessage(const QByteArray &message)
+{
+    if (!this->d->m_socket
+        || this->d->m_socket->state() != QAbstractSocket::ConnectedState) {
+        if (this->d->m_role != "receiver") {
+            QMutexLocker locker(&this->d->m_mutex);
+
+            if (this->d->m_pending > 0)
+                this->d->m_pending--;
+        }
+
+        return;
+    }
+
+    quint32 size = qToBigEndian<quint32>(quint32(message.size()));
+    this->d->m_socket->write(reinterpret_cast<const char *>(&size),
+                             sizeof(quint32));
+    this->d->m_socket->write(message);
+}
+
+void RemoteOffloadElement::dataReady()
+{
+    this->d->m_readBuffer += this->d->m_socket->readAll();
+
+    forever {
+        if (this->d->m_readBuffer.size() < int(sizeof(quint32)))
+            break;
+
+        quint32 size =
+                qFromBigEndian<quint32>(reinterpret_cast<const uchar *>(this->d->m_readBuffer.constData()));
+
+        if (this->d->m_readBuffer.size() < int(sizeof(quint32) + size))
+            break;
+
+        auto message = this->d->m_readBuffer.mid(int(sizeof(quint32)),
+                                                 int(size));
+        this->d->m_readBuffer.remove(0, int(sizeof(quint32) + size));
+
+        bool compressed = message[0] != 0;
+        auto blob = compressed?
+                        qUncompress(message.mid(1)): message.mid(1);
+
+        this->d->m_mutex.lock();
+        auto packet = this->d->m_readStream.read(blob);
+        this->d->m_mutex.unlock();
+
+        if (this->d->m_role == "receiver") {
+            if (!packet)
+                continue;
+
+            if (this->d->m_chain.isEmpty())
+                // No chain configured, echo the frame back.
+                this->sendMessage(this->packMessage(packet));
+            else
+                this->d->m_chain.first()->iStream(packet);
+        } else {
+            this->d->m_mutex.lock();
+
+            if (this->d->m_pending > 0)
+                this->d->m_pending--;
+
+            this->d->m_mutex.unlock();
+
+            // send() reaches fast-linked sinks too, a raw emit would not.
+            if (packet)
+                this->send(packet);
+        }
+    }
+}
+
+void RemoteOffloadElement::clientConnected()
+{
+    // One sender per receiver, a newer connection replaces the old one.
+    if (this->d->m_socket) {
+        this->d->m_socket->abort();
+        delete this->d->m_socket;
+    }
+
+    this->d->m_socket = this->d->m_server->nextPendingConnection();
+    this->d->m_readBuffer.clear();
+    this->d->m_mutex.lock();
+    this->d->m_writeStream.reset();
+    this->d->m_readStream.reset();
+    this->d->m_mutex.unlock();
+    QObject::connect(this->d->m_socket,
+                     &QTcpSocket::readyRead,
+                     this,
+                     &RemoteOffloadElement::dataReady);
+}
+
+#include "moc_remoteoffloadelement.cpp"
@@ -0,0 +1,126 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef REMOTEOFFLOADELEMENT_H
+#define REMOTEOFFLOADELEMENT_H
+
+#include <akelement.h>
+
+class RemoteOffloadElementPrivate;
+
+/* Remote effect offload.
+ *
+ * One element, two roles, the same way AudioDevice covers capture and
+ * playback. As a sender it ships frames to a remote node over TCP using
+ * the AkPacketStream wire format and emits the processed frames coming
+ * back; as a receiver it listens for a sender, runs the frames through a
+ * configured effect chain and returns the results.
+ *
+ * Up to 'inFlight' frames travel concurrently so the link latency is
+ * hidden by pipelining instead of stalling the capture thread; when the
+ * window is full, or while the remote node is unreachable, frames pass
+ * through unprocessed, so losing the node degrades the stream instead of
+ * freezing it. Payloads can optionally be compressed losslessly for slow
+ * links.
+ */
+class RemoteOffloadElement: public AkElement
+{
+    Q_OBJECT
+    Q_PROPERTY(QString role
+               READ role
+               WRITE setRole
+               RESET resetRole
+               NOTIFY roleChanged)
+    Q_PROPERTY(QString address
+               READ address
+               WRITE setAddress
+               RESET resetAddress
+               NOTIFY addressChanged)
+    Q_PROPERTY(int port
+               READ port
+               WRITE setPort
+               RESET resetPort
+               NOTIFY portChanged)
+    Q_PROPERTY(QStringList effects
+               READ effects
+               WRITE setEffects
+               RESET resetEffects
+               NOTIFY effectsChanged)
+    Q_PROPERTY(int inFlight
+               READ inFlight
+               WRITE setInFlight
+               RESET resetInFlight
+               NOTIFY inFlightChanged)
+    Q_PROPERTY(bool compression
+               READ compression
+               WRITE setCompression
+               RESET resetCompression
+               NOTIFY compressionChanged)
+
+    public:
+        explicit RemoteOffloadElement();
+        ~RemoteOffloadElement();
+
+        Q_INVOKABLE QString role() const;
+        Q_INVOKABLE QString address() const;
+        Q_INVOKABLE int port() const;
+        Q_INVOKABLE QStringList effects() const;
+        Q_INVOKABLE int inFlight() const;
+        Q_INVOKABLE bool compression() const;
+
+    private:
+        RemoteOffloadElementPrivate *d;
+
+        QByteArray packMessage(const AkPacket &packet);
+
+    protected:
+        void stateChange(AkElement::ElementState from,
+                         AkElement::ElementState to);
+
+    signals:
+        void roleChanged(const QString &role);
+        void addressChanged(const QString &address);
+        void portChanged(int port);
+        void effectsChanged(const QStringList &effects);
+        void inFlightChanged(int inFlight);
+        void compressionChanged(bool compression);
+
+    public slots:
+        void setRole(const QString &role);
+        void setAddress(const QString &address);
+        void setPort(int port);
+        void setEffects(const QStringList &effects);
+        void setInFlight(int inFlight);
+        void setCompression(bool compression);
+        void resetRole();
+        void resetAddress();
+        void resetPort();
+        void resetEffects();
+        void resetInFlight();
+        void resetCompression();
+
+        AkPacket iStream(const AkPacket &packet);
+
+    private slots:
+        void sendMessage(const QByteArray &message);
+        void dataReady();
+        void clientConnected();
+};
+
+#endif // REMOTEOFFLOADELEMENT_H
@@ -23,6 +23,7 @@
 #include <akutils.h>
 #include <akcaps.h>
 #include <akpacket.h>
+#include <akvideofilterrunner.h>
 
 #include "rippleelement.h"
 
@@ -50,6 +51,7 @@ class RippleElementPrivate
         int m_lumaThreshold;
         AkCaps m_caps;
         QImage m_prevFrame;
+        QImage m_waveBuffer;
         QVector<QImage> m_rippleBuffer;
         int m_curRippleBuffer;
         int m_period;
@@ -77,15 +79,16 @@ class RippleElementPrivate
         {
         }
 
-        inline QImage imageDiff(const QImage &img1,
-                                const QImage &img2,
-                                int threshold,
-                                int lumaThreshold, int strength);
-        inline void addDrops(const QImage &buffer, const QImage &drops);
+        inline void addMotionDrops(const QImage &img1,
+                                   const QImage &img2,
+                                   int threshold,
+                                   int lumaThreshold, int strength);
         inline void ripple(const QImage &buffer1, const QImage &buffer2, int decay);
-        inline QImage applyWater(const QImage &src, const QImage &buffer);
-        inline QImage rainDrop(int width, int height, int strength);
-        inline QImage drop(int width, int height, int power);
+        inline void applyWater(const QImage &src,
+                               const QImage &buffer,
+                               QImage &dest);
+        inline void rainDrop(int width, int height, int strength);
+        inline void drop(int width, int height, int power);
 };
 
 RippleElement::RippleElement(): AkElement()
@@ -123,178 +126,188 @@ int RippleElement::lumaThreshold() const
     return this->d->m_lumaThreshold;
 }
 
-QImage RippleElementPrivate::imageDiff(const QImage &img1,
-                                       const QImage &img2,
-                                       int threshold,
-                                       int lumaThreshold,
-                                       int strength)
+void RippleElementPrivate::addMotionDrops(const QImage &img1,
+                                          const QImage &img2,
+                                          int threshold,
+                                          int lumaThreshold,
+                                          int strength)
 {
     int width = qMin(img1.width(), img2.width());
     int height = qMin(img1.height(), img2.height());
-    QImage diff(width, height, QImage::Format_ARGB32);
-
-    for (int y = 0; y < height; y++) {
-        const QRgb *img1Line = reinterpret_cast<const QRgb *>(img1.constScanLine(y));
-        const QRgb *img2Line = reinterpret_cast<const QRgb *>(img2.constScanLine(y));
-        int *diffLine = reinterpret_cast<int *>(diff.scanLine(y));
-
-        for (int x = 0; x < width; x++) {
-            QRgb pixel1 = img1Line[x];
-            int r1 = qRed(pixel1);
-            int g1 = qGreen(pixel1);
-            int b1 = qBlue(pixel1);
-
-            QRgb pixel2 = img2Line[x];
-            int r2 = qRed(pixel2);
-            int g2 = qGreen(pixel2);
-            int b2 = qBlue(pixel2);
-
-            int dr = r1 - r2;
-            int dg = g1 - g2;
-            int db = b1 - b2;
-
-            int s = dr * dr + dg * dg + db * db;
-            s = int(sqrt(s / 3));
-            s = s < threshold? 0: s;
-
-            int gray = qGray(img2Line[x]);
-            s = gray < lumaThreshold? 0: s;
-
-            diffLine[x] = (strength * s) >> 8;
+    QImage &buffer1 = this->m_rippleBuffer[0];
+    QImage &buffer2 = this->m_rippleBuffer[1];
+
+    /* The motion drops go straight into both height buffers in the same
+     * pass, instead of through an intermediate diff image scanned once
+     * per buffer. */
+    AkVideoFilterRunner::globalRunner()->run(height,
+                                             [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            auto img1Line = reinterpret_cast<const QRgb *>(img1.constScanLine(y));
+            auto img2Line = reinterpret_cast<const QRgb *>(img2.constScanLine(y));
+            auto buffer1Line = reinterpret_cast<int *>(buffer1.scanLine(y));
+            auto buffer2Line = reinterpret_cast<int *>(buffer2.scanLine(y));
+
+            for (int x = 0; x < width; x++) {
+                QRgb pixel1 = img1Line[x];
+                int r1 = qRed(pixel1);
+                int g1 = qGreen(pixel1);
+                int b1 = qBlue(pixel1);
+
+                QRgb pixel2 = img2Line[x];
+                int r2 = qRed(pixel2);
+                int g2 = qGreen(pixel2);
+                int b2 = qBlue(pixel2);
+
+                int dr = r1 - r2;
+                int dg = g1 - g2;
+                int db = b1 - b2;
+
+                int s = dr * dr + dg * dg + db * db;
+                s = int(sqrt(s / 3));
+                s = s < threshold? 0: s;
+
+                int gray = qGray(img2Line[x]);
+                s = gray < lumaThreshold? 0: s;
+
+                int drop = (strength * s) >> 8;
+                buffer1Line[x] += drop;
+                buffer2Line[x] += drop;
+            }
         }
-    }
-
-    return diff;
-}
-
-void RippleElementPrivate::addDrops(const QImage &buffer, const QImage &drops)
-{
-    for (int y = 0; y < buffer.height(); y++) {
-        const int *dropsLine = reinterpret_cast<const int *>(drops.constScanLine(y));
-        int *bufferLine = const_cast<int *>(reinterpret_cast<const int *>(buffer.scanLine(y)));
-
-        for (int x = 0; x < buffer.width(); x++)
-            bufferLine[x] += dropsLine[x];
-    }
+    });
 }
 
 void RippleElementPrivate::ripple(const QImage &buffer1,
                                   const QImage &buffer2,
                                   int decay)
 {
-    QImage buffer3(buffer1.size(), buffer1.format());
     const int *buffer1Bits = reinterpret_cast<const int *>(buffer1.constBits());
     int *buffer2Bits = const_cast<int *>(reinterpret_cast<const int *>(buffer2.bits()));
-    int *buffer3Bits = const_cast<int *>(reinterpret_cast<const int *>(buffer3.bits()));
-    int widthM1 = buffer1.width() - 1;
-    int widthP1 = buffer1.width() + 1;
+    int *buffer3Bits = reinterpret_cast<int *>(this->m_waveBuffer.bits());
+    int width = buffer1.width();
+    int widthM1 = width - 1;
+    int widthP1 = width + 1;
     int height = buffer1.height() - 1;
 
     memset(buffer2Bits, 0, size_t(buffer1.bytesPerLine()));
-    memset(buffer2Bits + height * buffer1.width(), 0, size_t(buffer1.bytesPerLine()));
+    memset(buffer2Bits + height * width, 0, size_t(buffer1.bytesPerLine()));
     memset(buffer3Bits, 0, size_t(buffer1.bytesPerLine()));
-    memset(buffer3Bits + height * buffer1.width(), 0, size_t(buffer1.bytesPerLine()));
+    memset(buffer3Bits + height * width, 0, size_t(buffer1.bytesPerLine()));
 
     for (int y = 1; y < height; y++) {
-        buffer2Bits[y * buffer1.width()] = 0;
-        buffer2Bits[widthM1 + y * buffer1.width()] = 0;
-        buffer3Bits[y * buffer1.width()] = 0;
-        buffer3Bits[widthM1 + y * buffer1.width()] = 0;
+        buffer2Bits[y * width] = 0;
+        buffer2Bits[widthM1 + y * width] = 0;
+        buffer3Bits[y * width] = 0;
+        buffer3Bits[widthM1 + y * width] = 0;
     }
 
-    // Wave simulation.
-    for (int y = 1; y < height; y++) {
-        int xOfftset = y * buffer1.width();
-
-        for (int x = 1; x < widthM1; x++) {
-            int xp = x + xOfftset;
-            int h = 0;
-
-            h += buffer1Bits[xp - widthP1];
-            h += buffer1Bits[xp - buffer1.width()];
-            h += buffer1Bits[xp - widthM1];
-            h += buffer1Bits[xp - 1];
-            h += buffer1Bits[xp + 1];
-            h += buffer1Bits[xp + widthM1];
-            h += buffer1Bits[xp + buffer1.width()];
-            h += buffer1Bits[xp + widthP1];
-            h -= 9 * buffer1Bits[xp];
-            h >>= 3;
-
-            int v = buffer1Bits[xp] - buffer2Bits[xp];
-            v += h - (v >> decay);
-            buffer3Bits[xp] = v + buffer1Bits[xp];
+    auto runner = AkVideoFilterRunner::globalRunner();
+
+    /* Wave simulation. Each stencil row only reads the previous height
+     * field and writes its own row, so the rows split over the worker
+     * pool; the branch-free inner loop is a plain 9-point stencil the
+     * compiler can vectorize. */
+    runner->run(height - 1, [&] (int yStart, int yEnd) {
+        for (int y = yStart + 1; y < yEnd + 1; y++) {
+            int xOfftset = y * width;
+
+            for (int x = 1; x < widthM1; x++) {
+                int xp = x + xOfftset;
+                int h = 0;
+
+                h += buffer1Bits[xp - widthP1];
+                h += buffer1Bits[xp - width];
+                h += buffer1Bits[xp - widthM1];
+                h += buffer1Bits[xp - 1];
+                h += buffer1Bits[xp + 1];
+                h += buffer1Bits[xp + widthM1];
+                h += buffer1Bits[xp + width];
+                h += buffer1Bits[xp + widthP1];
+                h -= 9 * buffer1Bits[xp];
+                h >>= 3;
+
+                int v = buffer1Bits[xp] - buffer2Bits[xp];
+                v += h - (v >> decay);
+                buffer3Bits[xp] = v + buffer1Bits[xp];
+            }
         }
-    }
+    });
 
     // Low pass filter.
-    for (int y = 1; y < height; y++) {
-        int xOfftset = y * buffer1.width();
+    runner->run(height - 1, [&] (int yStart, int yEnd) {
+        for (int y = yStart + 1; y < yEnd + 1; y++) {
+            int xOfftset = y * width;
 
-        for (int x = 1; x < widthM1; x++) {
-            int xp = x + xOfftset;
+            for (int x = 1; x < widthM1; x++) {
+                int xp = x + xOfftset;
 
-            int h = 0;
+                int h = 0;
 
-            h += buffer3Bits[xp - 1];
-            h += buffer3Bits[xp + 1];
-            h += buffer3Bits[xp - buffer3.width()];
-            h += buffer3Bits[xp + buffer3.width()];
-            h += 60 * buffer3Bits[xp];
+                h += buffer3Bits[xp - 1];
+                h += buffer3Bits[xp + 1];
+                h += buffer3Bits[xp - width];
+                h += buffer3Bits[xp + width];
+                h += 60 * buffer3Bits[xp];
 
-            buffer2Bits[xp] = h >> 6;
+                buffer2Bits[xp] = h >> 6;
+            }
         }
-    }
+    });
 }
 
-QImage RippleElementPrivate::applyWater(const QImage &src, const QImage &buffer)
+void RippleElementPrivate::applyWater(const QImage &src,
+                                      const QImage &buffer,
+                                      QImage &dest)
 {
-    QImage dest(src.size(), src.format());
     const QRgb *srcBits = reinterpret_cast<const QRgb *>(src.constBits());
     const int *bufferBits = reinterpret_cast<const int *>(buffer.bits());
     QRgb *destBits = reinterpret_cast<QRgb *>(dest.bits());
+    int width = src.width();
+    int height = src.height();
 
-    for (int y = 0; y < src.height(); y++) {
-        int xOfftset = y * src.width();
+    AkVideoFilterRunner::globalRunner()->run(height,
+                                             [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            int xOfftset = y * width;
 
-        for (int x = 0; x < src.width(); x++) {
-            int xp = x + xOfftset;
+            for (int x = 0; x < width; x++) {
+                int xp = x + xOfftset;
 
-            int xOff = 0;
+                int xOff = 0;
 
-            if (x > 1
-                && x < src.width() - 1) {
-                xOff += bufferBits[xp - 1];
-                xOff -= bufferBits[xp + 1];
-            }
+                if (x > 1
+                    && x < width - 1) {
+                    xOff += bufferBits[xp - 1];
+                    xOff -= bufferBits[xp + 1];
+                }
 
-            int yOff = 0;
+                int yOff = 0;
 
-            if (y > 1
-                && y < src.height() - 1) {
-                yOff += bufferBits[xp - buffer.width()];
-                yOff -= bufferBits[xp + buffer.width()];
-            }
+                if (y > 1
+                    && y < height - 1) {
+                    yOff += bufferBits[xp - width];
+                    yOff -= bufferBits[xp + width];
+                }
 
-            QColor color;
-            int xq = qBound(0, x + xOff, src.width() - 1);
-            int yq = qBound(0, y + yOff, src.height() - 1);
+                QColor color;
+                int xq = qBound(0, x + xOff, width - 1);
+                int yq = qBound(0, y + yOff, height - 1);
 
-            color.setRgba(srcBits[xq + yq * src.width()]);
+                color.setRgba(srcBits[xq + yq * width]);
 
-            // Shading
-            int lightness = color.lightness() + xOff;
-            lightness = qBound(0, lightness, 255);
-            color.setHsl(color.hue(), color.saturation(), lightness);
+                // Shading
+                int lightness = color.lightness() + xOff;
+                lightness = qBound(0, lightness, 255);
+                color.setHsl(color.hue(), color.saturation(), lightness);
 
-            destBits[xp] = color.rgb();
+                destBits[xp] = color.rgb();
+            }
         }
-    }
-
-    return dest;
+    });
 }
 
-QImage RippleElementPrivate::rainDrop(int width, int height, int strength)
+void RippleElementPrivate::rainDrop(int width, int height, int strength)
 {
     if (this->m_period == 0) {
         if (this->m_rainStat == 0) {
@@ -329,41 +342,27 @@ QImage RippleElementPrivate::rainDrop(int width, int height, int strength)
         }
     }
 
-    QImage rain;
-
     if (this->m_rainStat == 1
         || this->m_rainStat == 5) {
 
         if ((qrand() >> 8) < int(this->m_dropProb))
-            rain = this->drop(width, height, this->m_dropPower);
+            this->drop(width, height, this->m_dropPower);
 
         this->m_dropProb += uint(this->m_dropProbIncrement);
     } else if (this->m_rainStat == 2
                || this->m_rainStat == 3
                || this->m_rainStat == 4) {
         for  (int i = this->m_dropsPerFrame / 16; i > 0; i--)
-            rain = this->drop(width, height, this->m_dropPower);
+            this->drop(width, height, this->m_dropPower);
 
         this->m_dropsPerFrame += this->m_dropProbIncrement;
     }
 
     this->m_period--;
-
-    if (rain.isNull()) {
-        rain = QImage(width, height, QImage::Format_ARGB32);
-        rain.fill(qRgba(0, 0, 0, 0));
-    }
-
-    return rain;
 }
 
-QImage RippleElementPrivate::drop(int width, int height, int power)
+void RippleElementPrivate::drop(int width, int height, int power)
 {
-    QImage drops(width, height, QImage::Format_ARGB32);
-    auto dropsBits = reinterpret_cast<int *>(drops.bits());
-
-    drops.fill(qRgba(0, 0, 0, 0));
-
     int widthM1 = width - 1;
     int widthP1 = width + 1;
 
@@ -372,17 +371,22 @@ QImage RippleElementPrivate::drop(int width, int height, int power)
 
     int offset = x + y * width;
 
-    dropsBits[offset - widthP1] = power >> 2;
-    dropsBits[offset - width] = power >> 1;
-    dropsBits[offset - widthM1] = power >> 2;
-    dropsBits[offset - 1] = power >> 1;
-    dropsBits[offset] = power;
-    dropsBits[offset + 1] = power >> 1;
-    dropsBits[offset + widthM1] = power >> 2;
-    dropsBits[offset + width] = power >> 1;
-    dropsBits[offset + widthP1] = power >> 2;
-
-    return drops;
+    /* A drop is nine taps, so stamp it straight into both height
+     * buffers instead of splatting it on a full transparent frame that
+     * then has to be added pixel by pixel. */
+    for (QImage &buffer: this->m_rippleBuffer) {
+        auto bufferBits = reinterpret_cast<int *>(buffer.bits());
+
+        bufferBits[offset - widthP1] += power >> 2;
+        bufferBits[offset - width] += power >> 1;
+        bufferBits[offset - widthM1] += power >> 2;
+        bufferBits[offset - 1] += power >> 1;
+        bufferBits[offset] += power;
+        bufferBits[offset + 1] += power >> 1;
+        bufferBits[offset + widthM1] += power >> 2;
+        bufferBits[offset + width] += power >> 1;
+        bufferBits[offset + widthP1] += power >> 2;
+    }
 }
 
 QString RippleElement::controlInterfaceProvide(const QString &controlId) const
@@ -502,33 +506,30 @@ AkPacket RippleElement::iStream(const AkPacket &packet)
         this->d->m_rippleBuffer[0].fill(qRgba(0, 0, 0, 0));
         this->d->m_rippleBuffer << QImage(src.size(), src.format());
         this->d->m_rippleBuffer[1].fill(qRgba(0, 0, 0, 0));
+        this->d->m_waveBuffer = QImage(src.size(), src.format());
         this->d->m_curRippleBuffer = 0;
     } else {
-        QImage drops;
-
         if (this->d->m_mode == RippleModeMotionDetect)
-            // Compute the difference between previous and current frame,
-            // and save it to the buffer.
-            drops = this->d->imageDiff(this->d->m_prevFrame,
-                                       src,
-                                       this->d->m_threshold,
-                                       this->d->m_lumaThreshold,
-                                       this->d->m_amplitude);
+            // Add the difference between previous and current frame
+            // to both height buffers.
+            this->d->addMotionDrops(this->d->m_prevFrame,
+                                    src,
+                                    this->d->m_threshold,
+                                    this->d->m_lumaThreshold,
+                                    this->d->m_amplitude);
         else
-            drops = this->d->rainDrop(src.width(),
-                                      src.height(),
-                                      this->d->m_amplitude);
-
-        this->d->addDrops(this->d->m_rippleBuffer[this->d->m_curRippleBuffer], drops);
-        this->d->addDrops(this->d->m_rippleBuffer[1 - this->d->m_curRippleBuffer], drops);
+            this->d->rainDrop(src.width(),
+                              src.height(),
+                              this->d->m_amplitude);
 
         this->d->ripple(this->d->m_rippleBuffer[this->d->m_curRippleBuffer],
                         this->d->m_rippleBuffer[1 - this->d->m_curRippleBuffer],
                         this->d->m_decay);
 
         // Apply buffer.
-        oFrame = this->d->applyWater(src,
-                                     this->d->m_rippleBuffer[this->d->m_curRippleBuffer]);
+        this->d->applyWater(src,
+                            this->d->m_rippleBuffer[this->d->m_curRippleBuffer],
+                            oFrame);
         this->d->m_curRippleBuffer = 1 - this->d->m_curRippleBuffer;
     }
 
@@ -0,0 +1,123 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+import QtQuick 2.7
+import QtQuick.Controls 2.0
+import QtQuick.Layouts 1.3
+
+GridLayout {
+    columns: 2
+
+    function strToSize(str)
+    {
+        if (str.length < 1)
+            return Qt.size()
+
+        var size = str.split("x")
+
+        if (size.length < 2)
+            return Qt.size()
+
+        return Qt.size(size[0], size[1])
+    }
+
+    function modeIndex(model, mode)
+    {
+        var index = -1
+
+        for (var i = 0; i < model.count; i++)
+            if (model.get(i).mode == mode) {
+                index = i
+                break
+            }
+
+        return index
+    }
+
+    Label {
+        text: qsTr("Output size")
+    }
+    TextField {
+        text: Scale.outputSize.width + "x" + Scale.outputSize.height
+        validator: RegExpValidator {
+            regExp: /\d+x\d+/
+        }
+        Layout.fillWidth: true
+
+        onTextChanged: Scale.outputSize = strToSize(text)
+    }
+
+    Label {
+        text: qsTr("Scaling mode")
+    }
+    ComboBox {
+        id: cbxScalingMode
+        textRole: "text"
+        currentIndex: modeIndex(scalingModeModel, Scale.scalingMode)
+        Layout.fillWidth: true
+
+        model: ListModel {
+            id: scalingModeModel
+
+            ListElement {
+                text: qsTr("Nearest")
+                mode: "nearest"
+            }
+            ListElement {
+                text: qsTr("Bilinear")
+                mode: "bilinear"
+            }
+            ListElement {
+                text: qsTr("Bicubic")
+                mode: "bicubic"
+            }
+        }
+
+        onCurrentIndexChanged: Scale.scalingMode = scalingModeModel.get(currentIndex).mode
+    }
+
+    Label {
+        text: qsTr("Aspect mode")
+    }
+    ComboBox {
+        id: cbxAspectMode
+        textRole: "text"
+        currentIndex: modeIndex(aspectModeModel, Scale.aspectMode)
+        Layout.fillWidth: true
+
+        model: ListModel {
+            id: aspectModeModel
+
+            ListElement {
+                text: qsTr("Stretch")
+                mode: "stretch"
+            }
+            ListElement {
+                text: qsTr("Fit")
+                mode: "fit"
+            }
+            ListElement {
+                text: qsTr("Crop")
+                mode: "crop"
+            }
+        }
+
+        onCurrentIndexChanged: Scale.aspectMode = aspectModeModel.get(currentIndex).mode
+    }
+}
@@ -0,0 +1,461 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QImage>
+#include <QQmlContext>
+#include <QtMath>
+#include <akutils.h>
+#include <akpacket.h>
+#include <akvideofilterrunner.h>
+
+#include "scaleelement.h"
+
+enum ScalingMode
+{
+    ScalingNearest,
+    ScalingBilinear,
+    ScalingBicubic
+};
+
+enum AspectMode
+{
+    AspectStretch,
+    AspectFit,
+    AspectCrop
+};
+
+typedef QMap<ScalingMode, QString> ScalingModeMap;
+
+inline ScalingModeMap initScalingModeMap()
+{
+    ScalingModeMap scalingModeToStr = {
+        {ScalingNearest , "nearest" },
+        {ScalingBilinear, "bilinear"},
+        {ScalingBicubic , "bicubic" }
+    };
+
+    return scalingModeToStr;
+}
+
+Q_GLOBAL_STATIC_WITH_ARGS(ScalingModeMap, scalingModeToStr, (initScalingModeMap()))
+
+typedef QMap<AspectMode, QString> AspectModeMap;
+
+inline AspectModeMap initAspectModeMap()
+{
+    AspectModeMap aspectModeToStr = {
+        {AspectStretch, "stretch"},
+        {AspectFit    , "fit"    },
+        {AspectCrop   , "crop"   }
+    };
+
+    return aspectModeToStr;
+}
+
+Q_GLOBAL_STATIC_WITH_ARGS(AspectModeMap, aspectModeToStr, (initAspectModeMap()))
+
+// Linear blend in 8.8 fixed point, 't' in [0, 256].
+inline int lerp8(int a, int b, int t)
+{
+    return a + (((b - a) * t) >> 8);
+}
+
+class ScaleElementPrivate
+{
+    public:
+        QSize m_outputSize;
+        ScalingMode m_scalingMode;
+        AspectMode m_aspectMode;
+
+        /* Filter coefficient cache, valid for one (source rect, output
+         * size, mode) combination. Sources don't change geometry mid
+         * stream, so in the steady state the frame loop only runs the
+         * sampling kernels.
+         */
+        QRect m_cacheSrcRect;
+        QSize m_cacheDstSize;
+        ScalingMode m_cacheMode;
+        QVector<int> m_xIdx;
+        QVector<int> m_yIdx;
+        QVector<int> m_xFrac;
+        QVector<int> m_yFrac;
+        QVector<qint16> m_xWeight;
+        QVector<qint16> m_yWeight;
+
+        ScaleElementPrivate():
+            m_scalingMode(ScalingBilinear),
+            m_aspectMode(AspectFit),
+            m_cacheMode(ScalingBilinear)
+        {
+        }
+
+        void updateCoefficients(const QRect &srcRect,
+                                const QSize &dstSize,
+                                ScalingMode mode);
+        static void axisTables(int srcOffset,
+                               int srcLen,
+                               int dstLen,
+                               ScalingMode mode,
+                               QVector<int> &idx,
+                               QVector<int> &frac,
+                               QVector<qint16> &weight);
+};
+
+void ScaleElementPrivate::updateCoefficients(const QRect &srcRect,
+                                             const QSize &dstSize,
+                                             ScalingMode mode)
+{
+    if (this->m_cacheSrcRect == srcRect
+        && this->m_cacheDstSize == dstSize
+        && this->m_cacheMode == mode)
+        return;
+
+    ScaleElementPrivate::axisTables(srcRect.x(),
+                                    srcRect.width(),
+                                    dstSize.width(),
+                                    mode,
+                                    this->m_xIdx,
+                                    this->m_xFrac,
+                                    this->m_xWeight);
+    ScaleElementPrivate::axisTables(srcRect.y(),
+                                    srcRect.height(),
+                                    dstSize.height(),
+                                    mode,
+                                    this->m_yIdx,
+                                    this->m_yFrac,
+                                    this->m_yWeight);
+
+    this->m_cacheSrcRect = srcRect;
+    this->m_cacheDstSize = dstSize;
+    this->m_cacheMode = mode;
+}
+
+/* Per-axis sampling tables. Every output coordinate maps to its source
+ * taps and weights up front, with the clamping at the borders resolved
+ * here, so the pixel loops are branch free.
+ *
+ * Nearest stores one index per coordinate; bilinear two indices and a
+ * fraction in 8.8 fixed point; bicubic (Catmull-Rom) four indices and
+ * four weights scaled by 128, so a full 2D tap sum fits a 14 bit shift.
+ */
+void ScaleElementPrivate::axisTables(int srcOffset,
+                                     int srcLen,
+                                     int dstLen,
+                                     ScalingMode mode,
+                                     QVector<int> &idx,
+                                     QVector<int> &frac,
+                                     QVector<qint16> &weight)
+{
+    switch (mode) {
+    case ScalingNearest:
+        idx.resize(dstLen);
+        break;
+    case ScalingBilinear:
+        idx.resize(2 * dstLen);
+        frac.resize(dstLen);
+        break;
+    case ScalingBicubic:
+        idx.resize(4 * dstLen);
+        weight.resize(4 * dstLen);
+        break;
+    }
+
+    for (int o = 0; o < dstLen; o++) {
+        qreal pos = (o + 0.5) * srcLen / dstLen - 0.5;
+        int base = qFloor(pos);
+        qreal t = pos - base;
+
+        switch (mode) {
+        case ScalingNearest:
+            idx[o] = srcOffset + qBound(0, qRound(pos), srcLen - 1);
+
+            break;
+        case ScalingBilinear:
+            idx[2 * o] = srcOffset + qBound(0, base, srcLen - 1);
+            idx[2 * o + 1] = srcOffset + qBound(0, base + 1, srcLen - 1);
+            frac[o] = qRound(t * 256);
+
+            break;
+        case ScalingBicubic: {
+            for (int k = 0; k < 4; k++)
+                idx[4 * o + k] = srcOffset
+                               + qBound(0, base + k - 1, srcLen - 1);
+
+            qreal t2 = t * t;
+            qreal t3 = t2 * t;
+            weight[4 * o] = qint16(qRound(64 * (-t3 + 2 * t2 - t)));
+            weight[4 * o + 1] = qint16(qRound(64 * (3 * t3 - 5 * t2 + 2)));
+            weight[4 * o + 2] = qint16(qRound(64 * (-3 * t3 + 4 * t2 + t)));
+            weight[4 * o + 3] = qint16(qRound(64 * (t3 - t2)));
+
+            break;
+        }
+        }
+    }
+}
+
+ScaleElement::ScaleElement(): AkElement()
+{
+    this->d = new ScaleElementPrivate;
+}
+
+ScaleElement::~ScaleElement()
+{
+    delete this->d;
+}
+
+QSize ScaleElement::outputSize() const
+{
+    return this->d->m_outputSize;
+}
+
+QString ScaleElement::scalingMode() const
+{
+    return scalingModeToStr->value(this->d->m_scalingMode);
+}
+
+QString ScaleElement::aspectMode() const
+{
+    return aspectModeToStr->value(this->d->m_aspectMode);
+}
+
+QString ScaleElement::controlInterfaceProvide(const QString &controlId) const
+{
+    Q_UNUSED(controlId)
+
+    return QString("qrc:/Scale/share/qml/main.qml");
+}
+
+void ScaleElement::controlInterfaceConfigure(QQmlContext *context,
+                                             const QString &controlId) const
+{
+    Q_UNUSED(controlId)
+
+    context->setContextProperty("Scale", const_cast<QObject *>(qobject_cast<const QObject *>(this)));
+    context->setContextProperty("controlId", this->objectName());
+}
+
+void ScaleElement::setOutputSize(const QSize &outputSize)
+{
+    if (this->d->m_outputSize == outputSize)
+        return;
+
+    this->d->m_outputSize = outputSize;
+    emit this->outputSizeChanged(outputSize);
+}
+
+void ScaleElement::setScalingMode(const QString &scalingMode)
+{
+    ScalingMode scalingModeEnum = scalingModeToStr->key(scalingMode,
+                                                        ScalingBilinear);
+
+    if (this->d->m_scalingMode == scalingModeEnum)
+        return;
+
+    this->d->m_scalingMode = scalingModeEnum;
+    emit this->scalingModeChanged(scalingMode);
+}
+
+void ScaleElement::setAspectMode(const QString &aspectMode)
+{
+    AspectMode aspectModeEnum = aspectModeToStr->key(aspectMode, AspectFit);
+
+    if (this->d->m_aspectMode == aspectModeEnum)
+        return;
+
+    this->d->m_aspectMode = aspectModeEnum;
+    emit this->aspectModeChanged(aspectMode);
+}
+
+void ScaleElement::resetOutputSize()
+{
+    this->setOutputSize(QSize());
+}
+
+void ScaleElement::resetScalingMode()
+{
+    this->setScalingMode("bilinear");
+}
+
+void ScaleElement::resetAspectMode()
+{
+    this->setAspectMode("fit");
+}
+
+AkPacket ScaleElement::iStream(const AkPacket &packet)
+{
+    QSize outputSize = this->d->m_outputSize;
+    ScalingMode scalingMode = this->d->m_scalingMode;
+    AspectMode aspectMode = this->d->m_aspectMode;
+
+    QImage src = AkUtils::packetToImage(packet);
+
+    if (src.isNull())
+        return AkPacket();
+
+    if (outputSize.isEmpty() || outputSize == src.size())
+        akSend(packet)
+
+    src = src.convertToFormat(QImage::Format_ARGB32);
+
+    // Source rect to sample and destination rect to fill.
+    QRect srcRect(QPoint(0, 0), src.size());
+    QRect dstRect(QPoint(0, 0), outputSize);
+
+    if (aspectMode == AspectFit) {
+        auto scaled = src.size();
+        scaled.scale(outputSize, Qt::KeepAspectRatio);
+        dstRect = QRect(QPoint((outputSize.width() - scaled.width()) / 2,
+                               (outputSize.height() - scaled.height()) / 2),
+                        scaled);
+    } else if (aspectMode == AspectCrop) {
+        auto cropped = outputSize;
+        cropped.scale(src.size(), Qt::KeepAspectRatio);
+        srcRect = QRect(QPoint((src.width() - cropped.width()) / 2,
+                               (src.height() - cropped.height()) / 2),
+                        cropped);
+    }
+
+    QImage oFrame(outputSize, src.format());
+
+    // Letterbox bars.
+    if (dstRect.size() != outputSize)
+        oFrame.fill(qRgb(0, 0, 0));
+
+    this->d->updateCoefficients(srcRect, dstRect.size(), scalingMode);
+
+    int dstWidth = dstRect.width();
+    int dstX = dstRect.x();
+    int dstY = dstRect.y();
+    auto xIdx = this->d->m_xIdx.constData();
+    auto yIdx = this->d->m_yIdx.constData();
+    auto xFrac = this->d->m_xFrac.constData();
+    auto yFrac = this->d->m_yFrac.constData();
+    auto xWeight = this->d->m_xWeight.constData();
+    auto yWeight = this->d->m_yWeight.constData();
+
+    switch (scalingMode) {
+    case ScalingNearest:
+        AkVideoFilterRunner::globalRunner()->run(dstRect.height(),
+                                                 [&] (int yStart, int yEnd) {
+            for (int y = yStart; y < yEnd; y++) {
+                auto iLine = reinterpret_cast<const QRgb *>(src.constScanLine(yIdx[y]));
+                auto oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y + dstY))
+                           + dstX;
+
+                for (int x = 0; x < dstWidth; x++)
+                    oLine[x] = iLine[xIdx[x]];
+            }
+        });
+
+        break;
+    case ScalingBilinear:
+        AkVideoFilterRunner::globalRunner()->run(dstRect.height(),
+                                                 [&] (int yStart, int yEnd) {
+            for (int y = yStart; y < yEnd; y++) {
+                auto line0 = reinterpret_cast<const QRgb *>(src.constScanLine(yIdx[2 * y]));
+                auto line1 = reinterpret_cast<const QRgb *>(src.constScanLine(yIdx[2 * y + 1]));
+                int fy = yFrac[y];
+                auto oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y + dstY))
+                           + dstX;
+
+                for (int x = 0; x < dstWidth; x++) {
+                    QRgb p00 = line0[xIdx[2 * x]];
+                    QRgb p01 = line0[xIdx[2 * x + 1]];
+                    QRgb p10 = line1[xIdx[2 * x]];
+                    QRgb p11 = line1[xIdx[2 * x + 1]];
+                    int fx = xFrac[x];
+
+                    int r = lerp8(lerp8(qRed(p00), qRed(p01), fx),
+                                  lerp8(qRed(p10), qRed(p11), fx),
+                                  fy);
+                    int g = lerp8(lerp8(qGreen(p00), qGreen(p01), fx),
+                                  lerp8(qGreen(p10), qGreen(p11), fx),
+                                  fy);
+                    int b = lerp8(lerp8(qBlue(p00), qBlue(p01), fx),
+                                  lerp8(qBlue(p10), qBlue(p11), fx),
+                                  fy);
+                    int a = lerp8(lerp8(qAlpha(p00), qAlpha(p01), fx),
+                                  lerp8(qAlpha(p10), qAlpha(p11), fx),
+                                  fy);
+
+                    oLine[x] = qRgba(r, g, b, a);
+                }
+            }
+        });
+
+        break;
+    case ScalingBicubic:
+        AkVideoFilterRunner::globalRunner()->run(dstRect.height(),
+                                                 [&] (int yStart, int yEnd) {
+            for (int y = yStart; y < yEnd; y++) {
+                const QRgb *lines[4];
+
+                for (int j = 0; j < 4; j++)
+                    lines[j] = reinterpret_cast<const QRgb *>(src.constScanLine(yIdx[4 * y + j]));
+
+                auto oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y + dstY))
+                           + dstX;
+
+                for (int x = 0; x < dstWidth; x++) {
+                    int r = 0;
+                    int g = 0;
+                    int b = 0;
+                    int a = 0;
+
+                    for (int j = 0; j < 4; j++) {
+                        const QRgb *line = lines[j];
+                        int wy = yWeight[4 * y + j];
+                        int rr = 0;
+                        int gg = 0;
+                        int bb = 0;
+                        int aa = 0;
+
+                        for (int i = 0; i < 4; i++) {
+                            QRgb p = line[xIdx[4 * x + i]];
+                            int wx = xWeight[4 * x + i];
+                            rr += wx * qRed(p);
+                            gg += wx * qGreen(p);
+                            bb += wx * qBlue(p);
+                            aa += wx * qAlpha(p);
+                        }
+
+                        r += wy * rr;
+                        g += wy * gg;
+                        b += wy * bb;
+                        a += wy * aa;
+                    }
+
+                    // Taps are scaled by 64 per axis, round and shift back.
+                    oLine[x] = qRgba(qBound(0, (r + (1 << 11)) >> 12, 255),
+                                     qBound(0, (g + (1 << 11)) >> 12, 255),
+                                     qBound(0, (b + (1 << 11)) >> 12, 255),
+                                     qBound(0, (a + (1 << 11)) >> 12, 255));
+                }
+            }
+        });
+
+        break;
+    }
+
+    AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
+    akSend(oPacket)
+}
+
+#include "moc_scaleelement.cpp"
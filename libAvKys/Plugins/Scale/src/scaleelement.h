@@ -0,0 +1,85 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef SCALEELEMENT_H
+#define SCALEELEMENT_H
+
+#include <akelement.h>
+
+class ScaleElementPrivate;
+
+/* Dedicated scale/crop/letterbox element.
+ *
+ * Placed ahead of the effect chain it brings high resolution sources down
+ * to the pipeline's working size, so the effects don't process pixels that
+ * are thrown away at the sink. The scaling mode is a quality ladder
+ * (nearest, bilinear, bicubic) and the filter coefficients are cached per
+ * geometry pair, so the steady state only runs the sampling loops.
+ */
+class ScaleElement: public AkElement
+{
+    Q_OBJECT
+    Q_PROPERTY(QSize outputSize
+               READ outputSize
+               WRITE setOutputSize
+               RESET resetOutputSize
+               NOTIFY outputSizeChanged)
+    Q_PROPERTY(QString scalingMode
+               READ scalingMode
+               WRITE setScalingMode
+               RESET resetScalingMode
+               NOTIFY scalingModeChanged)
+    Q_PROPERTY(QString aspectMode
+               READ aspectMode
+               WRITE setAspectMode
+               RESET resetAspectMode
+               NOTIFY aspectModeChanged)
+
+    public:
+        explicit ScaleElement();
+        ~ScaleElement();
+
+        Q_INVOKABLE QSize outputSize() const;
+        Q_INVOKABLE QString scalingMode() const;
+        Q_INVOKABLE QString aspectMode() const;
+
+    private:
+        ScaleElementPrivate *d;
+
+    protected:
+        QString controlInterfaceProvide(const QString &controlId) const;
+        void controlInterfaceConfigure(QQmlContext *context,
+                                       const QString &controlId) const;
+
+    signals:
+        void outputSizeChanged(const QSize &outputSize);
+        void scalingModeChanged(const QString &scalingMode);
+        void aspectModeChanged(const QString &aspectMode);
+
+    public slots:
+        void setOutputSize(const QSize &outputSize);
+        void setScalingMode(const QString &scalingMode);
+        void setAspectMode(const QString &aspectMode);
+        void resetOutputSize();
+        void resetScalingMode();
+        void resetAspectMode();
+        AkPacket iStream(const AkPacket &packet);
+};
+
+#endif // SCALEELEMENT_H
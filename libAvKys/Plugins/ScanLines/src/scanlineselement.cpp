@@ -19,8 +19,10 @@
 
 #include <QImage>
 #include <QQmlContext>
+#include <QVector>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akvideofilterrunner.h>
 
 #include "scanlineselement.h"
 
@@ -114,25 +116,30 @@ AkPacket ScanLinesElement::iStream(const AkPacket &packet)
     src = src.convertToFormat(QImage::Format_ARGB32);
     QImage oFrame(src.size(), src.format());
 
-    int showSize = this->m_showSize;
-    int hideSize = this->m_hideSize;
+    int showSize = qMax(this->m_showSize, 0);
+    int hideSize = qMax(this->m_hideSize, 0);
 
     if (showSize < 1 && hideSize < 1)
         akSend(packet)
 
-    for (int y = 0; y < src.height(); y++) {
-        for (int i = 0; i < showSize && y < src.height(); i++, y++)
-            memcpy(oFrame.scanLine(y), src.scanLine(y), size_t(src.bytesPerLine()));
-
-        for (int j = 0; j < hideSize && y < src.height(); j++, y++) {
-            QRgb *line = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
-
-            for (int x = 0; x < src.width(); x++)
-                line[x] = this->m_hideColor;
-        }
-
-        y--;
-    }
+    /* The stripe pattern repeats every showSize + hideSize rows, so a
+     * row is either a straight copy or a fill from the prototype hidden
+     * line built once per frame; no per-pixel work remains and the rows
+     * go to the worker pool. */
+    int period = showSize + hideSize;
+    QVector<QRgb> hideLine(src.width(), this->m_hideColor);
+    size_t lineSize = size_t(src.width()) * sizeof(QRgb);
+
+    AkVideoFilterRunner::globalRunner()->run(src.height(),
+                                             [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++)
+            if (y % period < showSize)
+                memcpy(oFrame.scanLine(y),
+                       src.constScanLine(y),
+                       size_t(src.bytesPerLine()));
+            else
+                memcpy(oFrame.scanLine(y), hideLine.constData(), lineSize);
+    });
 
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
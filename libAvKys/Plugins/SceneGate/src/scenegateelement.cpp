@@ -0,0 +1,266 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QImage>
+#include <akutils.h>
+#include <akpacket.h>
+#include <akbuffer.h>
+#include <akbufferpool.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "scenegateelement.h"
+
+class SceneGateElementPrivate
+{
+    public:
+        QString m_description;
+        int m_threshold;
+        AkElementPtr m_bin;
+        AkPacket m_chainPacket;
+        AkPacket m_lastOutput;
+        AkBuffer m_refLuma; // Downsampled luma of the last processed frame.
+        QSize m_frameSize;
+        size_t m_lumaStride;
+        bool m_hasReference;
+
+        SceneGateElementPrivate():
+            m_threshold(2),
+            m_lumaStride(0),
+            m_hasReference(false)
+        {
+        }
+
+        inline void reset(const QSize &size);
+        inline void downsampleLuma(const QImage &src, AkBuffer &luma) const;
+        inline qint64 frameSad(const AkBuffer &curLuma) const;
+};
+
+SceneGateElement::SceneGateElement(): AkElement()
+{
+    this->d = new SceneGateElementPrivate;
+    this->d->m_bin = AkElement::create("Bin");
+
+    if (this->d->m_bin)
+        // Direct connection, the chain hands the result back synchronously.
+        QObject::connect(this->d->m_bin.data(),
+                         SIGNAL(oStream(const AkPacket &)),
+                         this,
+                         SLOT(chainStream(const AkPacket &)),
+                         Qt::DirectConnection);
+}
+
+SceneGateElement::~SceneGateElement()
+{
+    if (this->d->m_refLuma)
+        AkBufferPool::globalPool()->release(this->d->m_refLuma);
+
+    delete this->d;
+}
+
+QString SceneGateElement::description() const
+{
+    return this->d->m_description;
+}
+
+int SceneGateElement::threshold() const
+{
+    return this->d->m_threshold;
+}
+
+void SceneGateElementPrivate::reset(const QSize &size)
+{
+    auto pool = AkBufferPool::globalPool();
+
+    if (this->m_refLuma)
+        pool->release(this->m_refLuma);
+
+    int lumaWidth = (size.width() + 1) / 2;
+    int lumaHeight = (size.height() + 1) / 2;
+    this->m_lumaStride = AkBuffer::padStride(size_t(lumaWidth));
+    this->m_refLuma = pool->acquire(this->m_lumaStride * size_t(lumaHeight));
+    this->m_frameSize = size;
+    this->m_hasReference = false;
+    this->m_lastOutput = AkPacket();
+}
+
+void SceneGateElementPrivate::downsampleLuma(const QImage &src,
+                                             AkBuffer &luma) const
+{
+    int lumaWidth = (src.width() + 1) / 2;
+    int lumaHeight = (src.height() + 1) / 2;
+
+    for (int y = 0; y < lumaHeight; y++) {
+        auto srcLine =
+                reinterpret_cast<const QRgb *>(src.constScanLine(2 * y));
+        auto lumaLine = luma.writableLine(0, y, this->m_lumaStride);
+
+        for (int x = 0; x < lumaWidth; x++)
+            lumaLine[x] = quint8(qGray(srcLine[2 * x]));
+    }
+}
+
+qint64 SceneGateElementPrivate::frameSad(const AkBuffer &curLuma) const
+{
+    int lumaWidth = (this->m_frameSize.width() + 1) / 2;
+    int lumaHeight = (this->m_frameSize.height() + 1) / 2;
+    qint64 sad = 0;
+
+    for (int y = 0; y < lumaHeight; y++) {
+        auto curLine = curLuma.constLine(0, y, this->m_lumaStride);
+        auto refLine = this->m_refLuma.constLine(0, y, this->m_lumaStride);
+        int x = 0;
+
+#if defined(__SSE2__)
+        // psadbw sums 16 absolute differences per instruction.
+        __m128i acc = _mm_setzero_si128();
+
+        for (; x < lumaWidth - 15; x += 16) {
+            auto cur =
+                    _mm_loadu_si128(reinterpret_cast<const __m128i *>(curLine + x));
+            auto ref =
+                    _mm_loadu_si128(reinterpret_cast<const __m128i *>(refLine + x));
+            acc = _mm_add_epi64(acc, _mm_sad_epu8(cur, ref));
+        }
+
+        sad += _mm_cvtsi128_si32(acc)
+               + _mm_cvtsi128_si32(_mm_srli_si128(acc, 8));
+#endif
+
+        for (; x < lumaWidth; x++)
+            sad += qAbs(int(curLine[x]) - int(refLine[x]));
+    }
+
+    return sad;
+}
+
+void SceneGateElement::setDescription(const QString &description)
+{
+    if (this->d->m_description == description)
+        return;
+
+    this->d->m_description = description;
+    this->d->m_lastOutput = AkPacket();
+    this->d->m_hasReference = false;
+
+    if (this->d->m_bin)
+        this->d->m_bin->setProperty("description", description);
+
+    emit this->descriptionChanged(description);
+}
+
+void SceneGateElement::setThreshold(int threshold)
+{
+    if (this->d->m_threshold == threshold)
+        return;
+
+    this->d->m_threshold = threshold;
+    emit this->thresholdChanged(threshold);
+}
+
+void SceneGateElement::resetDescription()
+{
+    this->setDescription("");
+}
+
+void SceneGateElement::resetThreshold()
+{
+    this->setThreshold(2);
+}
+
+AkPacket SceneGateElement::iStream(const AkPacket &packet)
+{
+    if (this->d->m_description.isEmpty() || !this->d->m_bin)
+        akSend(packet)
+
+    QImage src = AkUtils::packetToImage(packet);
+
+    if (src.isNull())
+        return AkPacket();
+
+    src = src.convertToFormat(QImage::Format_ARGB32);
+
+    if (src.size() != this->d->m_frameSize)
+        this->d->reset(src.size());
+
+    int lumaWidth = (src.width() + 1) / 2;
+    int lumaHeight = (src.height() + 1) / 2;
+    auto pool = AkBufferPool::globalPool();
+    auto curLuma =
+            pool->acquire(this->d->m_lumaStride * size_t(lumaHeight));
+    this->d->downsampleLuma(src, curLuma);
+
+    if (this->d->m_hasReference && this->d->m_lastOutput) {
+        auto sad = this->d->frameSad(curLuma);
+        qint64 pixels = qint64(lumaWidth) * lumaHeight;
+
+        if (sad < qint64(this->d->m_threshold) * pixels) {
+            /* Same scene: re-emit the cached output under the new frame's
+             * timing. The copy shares the pixel buffer by reference, so
+             * the whole chain is skipped for the price of the SAD. */
+            pool->release(curLuma);
+            AkPacket oPacket = this->d->m_lastOutput;
+            oPacket.setPts(packet.pts());
+            oPacket.setTimeBase(packet.timeBase());
+            oPacket.setId(packet.id());
+            oPacket.setIndex(packet.index());
+            akSend(oPacket)
+        }
+    }
+
+    this->d->m_chainPacket = AkPacket();
+    this->d->m_bin->iStream(packet);
+
+    // The frame that got processed becomes the comparison reference.
+    pool->release(this->d->m_refLuma);
+    this->d->m_refLuma = curLuma;
+    this->d->m_hasReference = true;
+
+    // A blocking or unconfigured chain drops the frame, pass it through.
+    AkPacket oPacket = this->d->m_chainPacket?
+                           this->d->m_chainPacket: packet;
+    this->d->m_lastOutput = oPacket;
+    akSend(oPacket)
+}
+
+bool SceneGateElement::setState(AkElement::ElementState state)
+{
+    bool ok = AkElement::setState(state);
+
+    if (this->d->m_bin) {
+        bool ret = false;
+        QMetaObject::invokeMethod(this->d->m_bin.data(),
+                                  "setState",
+                                  Q_RETURN_ARG(bool, ret),
+                                  Q_ARG(AkElement::ElementState,
+                                        this->state()));
+        ok &= ret;
+    }
+
+    return ok;
+}
+
+void SceneGateElement::chainStream(const AkPacket &packet)
+{
+    this->d->m_chainPacket = packet;
+}
+
+#include "moc_scenegateelement.cpp"
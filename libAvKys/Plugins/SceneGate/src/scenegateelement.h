@@ -0,0 +1,80 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef SCENEGATEELEMENT_H
+#define SCENEGATEELEMENT_H
+
+#include <akelement.h>
+
+class SceneGateElementPrivate;
+
+/* Skips processing of frames that didn't change.
+ *
+ * Desktop captures and locked off cameras deliver long runs of identical
+ * frames. The gate compares each frame against the last one that was
+ * actually processed, on downsampled luma; below the threshold it re-emits
+ * the cached chain output with the new frame's timing, which shares the
+ * pixel buffer by reference and costs no downstream work at all. The
+ * reference is only replaced when a frame gets processed, so slow drift
+ * accumulates until it crosses the threshold instead of slipping through.
+ */
+class SceneGateElement: public AkElement
+{
+    Q_OBJECT
+    // Gated chain, in Bin's pipeline description syntax.
+    Q_PROPERTY(QString description
+               READ description
+               WRITE setDescription
+               RESET resetDescription
+               NOTIFY descriptionChanged)
+    // Mean luma difference per sampled pixel that counts as a change.
+    Q_PROPERTY(int threshold
+               READ threshold
+               WRITE setThreshold
+               RESET resetThreshold
+               NOTIFY thresholdChanged)
+
+    public:
+        explicit SceneGateElement();
+        ~SceneGateElement();
+
+        Q_INVOKABLE QString description() const;
+        Q_INVOKABLE int threshold() const;
+
+    private:
+        SceneGateElementPrivate *d;
+
+    signals:
+        void descriptionChanged(const QString &description);
+        void thresholdChanged(int threshold);
+
+    public slots:
+        void setDescription(const QString &description);
+        void setThreshold(int threshold);
+        void resetDescription();
+        void resetThreshold();
+
+        AkPacket iStream(const AkPacket &packet);
+        bool setState(AkElement::ElementState state);
+
+    private slots:
+        void chainStream(const AkPacket &packet);
+};
+
+#endif // SCENEGATEELEMENT_H
@@ -18,7 +18,6 @@
  */
 
 #include <QTime>
-#include <QPainter>
 #include <QQmlContext>
 #include <akutils.h>
 #include <akpacket.h>
@@ -32,6 +31,7 @@ class ScrollElementPrivate
         qreal m_noise;
         qreal m_offset;
         QSize m_curSize;
+        QImage m_oFrame;
 
         ScrollElementPrivate():
             m_speed(0.25),
@@ -63,24 +63,6 @@ qreal ScrollElement::noise() const
     return this->d->m_noise;
 }
 
-QImage ScrollElement::generateNoise(const QSize &size, qreal persent)
-{
-    QImage noise = QImage(size, QImage::Format_ARGB32);
-    noise.fill(0);
-
-    int peper = int(persent * size.width() * size.height());
-
-    for (int i = 0; i < peper; i++) {
-        int gray = qrand() % 256;
-        int alpha = qrand() % 256;
-        int x = qrand() % noise.width();
-        int y = qrand() % noise.height();
-        noise.setPixel(x, y, qRgba(gray, gray, gray, alpha));
-    }
-
-    return noise;
-}
-
 QString ScrollElement::controlInterfaceProvide(const QString &controlId) const
 {
     Q_UNUSED(controlId)
@@ -133,13 +115,18 @@ AkPacket ScrollElement::iStream(const AkPacket &packet)
         return AkPacket();
 
     src = src.convertToFormat(QImage::Format_ARGB32);
-    QImage oFrame = QImage(src.size(), src.format());
 
     if (src.size() != this->d->m_curSize) {
         this->d->m_offset = 0.0;
         this->d->m_curSize = src.size();
+
+        // Pooled output plane, every pixel is rewritten below so stale
+        // content can't leak between frames.
+        this->d->m_oFrame = QImage(src.size(), src.format());
     }
 
+    QImage &oFrame = this->d->m_oFrame;
+
     int offset = int(this->d->m_offset);
 
     memcpy(oFrame.scanLine(0),
@@ -150,11 +137,25 @@ AkPacket ScrollElement::iStream(const AkPacket &packet)
            src.constScanLine(0),
            size_t(src.bytesPerLine() * (src.height() - offset)));
 
-    QPainter painter;
-    painter.begin(&oFrame);
-    QImage noise = this->generateNoise(oFrame.size(), this->d->m_noise);
-    painter.drawImage(0, 0, noise);
-    painter.end();
+    /* Sprinkle the noise pixels straight onto the shifted frame. The old
+     * path filled a full ARGB frame for a handful of random pixels and
+     * then composited all of it with QPainter, which cost more than the
+     * scroll itself. */
+    int peper = int(this->d->m_noise
+                    * oFrame.width() * oFrame.height());
+
+    for (int i = 0; i < peper; i++) {
+        int gray = qrand() % 256;
+        int alpha = qrand() % 256;
+        int x = qrand() % oFrame.width();
+        int y = qrand() % oFrame.height();
+        auto line = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+        QRgb bg = line[x];
+        int r = (gray * alpha + qRed(bg) * (255 - alpha)) / 255;
+        int g = (gray * alpha + qGreen(bg) * (255 - alpha)) / 255;
+        int b = (gray * alpha + qBlue(bg) * (255 - alpha)) / 255;
+        line[x] = qRgba(r, g, b, qAlpha(bg));
+    }
 
     this->d->m_offset += this->d->m_speed * oFrame.height();
 
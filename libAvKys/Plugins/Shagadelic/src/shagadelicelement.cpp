@@ -22,6 +22,7 @@
 #include <QtMath>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akvideofilterrunner.h>
 
 #include "shagadelicelement.h"
 
@@ -173,28 +174,44 @@ AkPacket ShagadelicElement::iStream(const AkPacket &packet)
         this->d->m_curSize = src.size();
     }
 
-    for (int y = 0; y < src.height(); y++) {
-        const QRgb *iLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
-        QRgb *oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
-        const quint8 *rLine = this->d->m_ripple.constScanLine(y + this->d->m_ry);
-        const quint8 *gLine = this->d->m_spiral.constScanLine(y);
-        const quint8 *bLine = this->d->m_ripple.constScanLine(y + this->d->m_by);
-
-        for (int x = 0; x < src.width(); x++) {
-            // Color saturation
-            int r = qRed(iLine[x]) > 127? 255: 0;
-            int g = qGreen(iLine[x]) > 127? 255: 0;
-            int b = qBlue(iLine[x]) > 127? 255: 0;
-            int a = qAlpha(iLine[x]);
-
-            int pr = char(rLine[x + this->d->m_rx] + this->d->m_phase * 2) >> 7;
-            int pg = char(gLine[x] + this->d->m_phase * 3) >> 7;
-            int pb = char(bLine[x + this->d->m_by] - this->d->m_phase) >> 7;
-
-            oLine[x] = qRgba(r, g, b, a) & qRgb(pr, pg, pb)
-                       & (this->d->m_mask | 0xff000000);
+    /* The ripple and spiral tables are precomputed per geometry, the
+     * animation is only the phase added to the table values and the
+     * drifting table origins. Hoist the per-frame constants and run the
+     * rows on the worker pool, each row only reads the tables and the
+     * source line. */
+    int width = src.width();
+    int rx = this->d->m_rx;
+    int ry = this->d->m_ry;
+    int by = this->d->m_by;
+    quint8 rPhase = this->d->m_phase * 2;
+    quint8 gPhase = this->d->m_phase * 3;
+    quint8 bPhase = this->d->m_phase;
+    quint32 mask = this->d->m_mask | 0xff000000;
+
+    AkVideoFilterRunner::globalRunner()->run(src.height(),
+                                             [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            auto iLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
+            auto oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+            const quint8 *rLine = this->d->m_ripple.constScanLine(y + ry) + rx;
+            const quint8 *gLine = this->d->m_spiral.constScanLine(y);
+            const quint8 *bLine = this->d->m_ripple.constScanLine(y + by) + by;
+
+            for (int x = 0; x < width; x++) {
+                // Color saturation
+                int r = qRed(iLine[x]) > 127? 255: 0;
+                int g = qGreen(iLine[x]) > 127? 255: 0;
+                int b = qBlue(iLine[x]) > 127? 255: 0;
+                int a = qAlpha(iLine[x]);
+
+                int pr = char(rLine[x] + rPhase) >> 7;
+                int pg = char(gLine[x] + gPhase) >> 7;
+                int pb = char(bLine[x] - bPhase) >> 7;
+
+                oLine[x] = qRgba(r, g, b, a) & qRgb(pr, pg, pb) & mask;
+            }
         }
-    }
+    });
 
     this->d->m_phase -= 8;
 
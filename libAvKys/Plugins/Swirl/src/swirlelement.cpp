@@ -28,6 +28,7 @@
 SwirlElement::SwirlElement(): AkElement()
 {
     this->m_degrees = 60;
+    this->m_mapDegrees = 0;
 }
 
 qreal SwirlElement::degrees() const
@@ -74,48 +75,52 @@ AkPacket SwirlElement::iStream(const AkPacket &packet)
 
     src = src.convertToFormat(QImage::Format_ARGB32);
     QImage oFrame(src.size(), src.format());
+    qreal degrees = this->m_degrees;
+
+    // The swirl only depends on the angle and the frame geometry.
+    if (!this->m_displacementMap.isValid(src.size())
+        || this->m_mapDegrees != degrees) {
+        qreal xScale = 1.0;
+        qreal yScale = 1.0;
+        qreal xCenter = src.width() >> 1;
+        qreal yCenter = src.height() >> 1;
+        qreal radius = qMax(xCenter, yCenter);
+
+        if (src.width() > src.height())
+            yScale = qreal(src.width() / src.height());
+        else if (src.width() < src.height())
+            xScale = qreal(src.height() / src.width());
+
+        qreal angle = M_PI * degrees / 180.0;
+        QRect rect = src.rect();
+
+        this->m_displacementMap.setMap(src.size(), [&] (int x, int y) {
+            qreal xDistance = xScale * (x - xCenter);
+            qreal yDistance = yScale * (y - yCenter);
+            qreal distance = xDistance * xDistance + yDistance * yDistance;
 
-    qreal xScale = 1.0;
-    qreal yScale = 1.0;
-    qreal xCenter = src.width() >> 1;
-    qreal yCenter = src.height() >> 1;
-    qreal radius = qMax(xCenter, yCenter);
+            if (distance >= radius * radius)
+                return QPoint(x, y);
 
-    if (src.width() > src.height())
-        yScale = qreal(src.width() / src.height());
-    else if (src.width() < src.height())
-        xScale = qreal(src.height() / src.width());
+            qreal factor = 1.0 - sqrt(distance) / radius;
+            qreal sine = sin(angle * factor * factor);
+            qreal cosine = cos(angle * factor * factor);
 
-    qreal degrees = M_PI * this->m_degrees / 180.0;
+            int xp = int((cosine * xDistance - sine * yDistance) / xScale + xCenter);
+            int yp = int((sine * xDistance + cosine * yDistance) / yScale + yCenter);
 
-    for (int y = 0; y < src.height(); y++) {
-        const QRgb *iLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
-        QRgb *oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
-        qreal yDistance = yScale * (y - yCenter);
+            // Pixels swirled in from outside the frame keep their color.
+            if (!rect.contains(xp, yp))
+                return QPoint(x, y);
 
-        for (int x = 0; x < src.width(); x++) {
-            qreal xDistance = xScale * (x - xCenter);
-            qreal distance = xDistance * xDistance + yDistance * yDistance;
+            return QPoint(xp, yp);
+        });
 
-            if (distance >= radius * radius)
-                oLine[x] = iLine[x];
-            else {
-                qreal factor = 1.0 - sqrt(distance) / radius;
-                qreal sine = sin(degrees * factor * factor);
-                qreal cosine = cos(degrees * factor * factor);
-
-                int xp = int((cosine * xDistance - sine * yDistance) / xScale + xCenter);
-                int yp = int((sine * xDistance + cosine * yDistance) / yScale + yCenter);
-
-                if (!oFrame.rect().contains(xp, yp))
-                    continue;
-
-                const QRgb *line = reinterpret_cast<const QRgb *>(src.constScanLine(yp));
-                oLine[x] = line[xp];
-            }
-        }
+        this->m_mapDegrees = degrees;
     }
 
+    this->m_displacementMap.apply(src, oFrame);
+
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
 }
@@ -21,6 +21,7 @@
 #define SWIRLELEMENT_H
 
 #include <akelement.h>
+#include <akdisplacementmap.h>
 
 class SwirlElement: public AkElement
 {
@@ -38,6 +39,8 @@ class SwirlElement: public AkElement
 
     private:
         qreal m_degrees;
+        qreal m_mapDegrees;
+        AkDisplacementMap m_displacementMap;
 
     protected:
         QString controlInterfaceProvide(const QString &controlId) const;
@@ -59,6 +59,7 @@ TemperatureElement::TemperatureElement(): AkElement()
     this->m_temperature = 6500;
     colorFromTemperature(this->m_temperature,
                          &this->m_kr, &this->m_kg, &this->m_kb);
+    this->m_lut.setGains(this->m_kr, this->m_kg, this->m_kb);
 }
 
 qreal TemperatureElement::temperature() const
@@ -90,6 +91,7 @@ void TemperatureElement::setTemperature(qreal temperature)
     this->m_temperature = temperature;
     colorFromTemperature(temperature,
                          &this->m_kr, &this->m_kg, &this->m_kb);
+    this->m_lut.setGains(this->m_kr, this->m_kg, this->m_kb);
     emit this->temperatureChanged(temperature);
 }
 
@@ -108,22 +110,9 @@ AkPacket TemperatureElement::iStream(const AkPacket &packet)
     src = src.convertToFormat(QImage::Format_ARGB32);
     QImage oFrame(src.size(), src.format());
 
-    for (int y = 0; y < src.height(); y++) {
-        const QRgb *srcLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
-        QRgb *destLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
-
-        for (int x = 0; x < src.width(); x++) {
-            int r = int(this->m_kr * qRed(srcLine[x]));
-            int g = int(this->m_kg * qGreen(srcLine[x]));
-            int b = int(this->m_kb * qBlue(srcLine[x]));
-
-            r = qBound(0, r, 255);
-            g = qBound(0, g, 255);
-            b = qBound(0, b, 255);
-
-            destLine[x] = qRgba(r, g, b, qAlpha(srcLine[x]));
-        }
-    }
+    // The gains only change with the temperature, so the frame maps through
+    // the tables compiled in the setter.
+    this->m_lut.apply(src, oFrame);
 
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
@@ -21,6 +21,7 @@
 #define TEMPERATUREELEMENT_H
 
 #include <akelement.h>
+#include <akcolorlut.h>
 
 class TemperatureElement: public AkElement
 {
@@ -41,6 +42,7 @@ class TemperatureElement: public AkElement
         qreal m_kr;
         qreal m_kg;
         qreal m_kb;
+        AkColorLut m_lut;
 
     protected:
         QString controlInterfaceProvide(const QString &controlId) const;
@@ -0,0 +1,83 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+import QtQuick 2.7
+import QtQuick.Controls 2.0
+import QtQuick.Layouts 1.3
+import AkQmlControls 1.0
+
+GridLayout {
+    id: configs
+    columns: 3
+
+    Connections {
+        target: TemporalDenoise
+
+        onStrengthChanged: {
+            sldStrength.value = strength
+            spbStrength.rvalue = strength
+        }
+        onMotionThresholdChanged: {
+            sldMotionThreshold.value = motionThreshold
+            spbMotionThreshold.rvalue = motionThreshold
+        }
+    }
+
+    Label {
+        text: qsTr("Strength")
+    }
+    Slider {
+        id: sldStrength
+        value: TemporalDenoise.strength
+        stepSize: 1
+        to: 31
+        Layout.fillWidth: true
+
+        onValueChanged: TemporalDenoise.strength = value
+    }
+    AkSpinBox {
+        id: spbStrength
+        rvalue: TemporalDenoise.strength
+        maximumValue: sldStrength.to
+        step: sldStrength.stepSize
+
+        onRvalueChanged: TemporalDenoise.strength = rvalue
+    }
+
+    Label {
+        text: qsTr("Motion threshold")
+    }
+    Slider {
+        id: sldMotionThreshold
+        value: TemporalDenoise.motionThreshold
+        stepSize: 1
+        to: 64
+        Layout.fillWidth: true
+
+        onValueChanged: TemporalDenoise.motionThreshold = value
+    }
+    AkSpinBox {
+        id: spbMotionThreshold
+        rvalue: TemporalDenoise.motionThreshold
+        maximumValue: sldMotionThreshold.to
+        step: sldMotionThreshold.stepSize
+
+        onRvalueChanged: TemporalDenoise.motionThreshold = rvalue
+    }
+}
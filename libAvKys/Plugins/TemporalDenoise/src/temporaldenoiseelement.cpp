@@ -0,0 +1,326 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QImage>
+#include <QQmlContext>
+#include <QVector>
+#include <akutils.h>
+#include <akpacket.h>
+#include <akbuffer.h>
+#include <akbufferpool.h>
+#include <akvideofilterrunner.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "temporaldenoiseelement.h"
+
+/* Motion is estimated on luma downsampled by 2 in both axes, over blocks of
+ * this many luma pixels per side, so one block covers 16x16 pixels of the
+ * full resolution frame. */
+#define LUMA_BLOCK 8
+
+class TemporalDenoiseElementPrivate
+{
+    public:
+        int m_strength;
+        int m_motionThreshold;
+        QSize m_frameSize;
+        AkBuffer m_average; // Running temporal accumulator, ARGB32.
+        AkBuffer m_refLuma; // Downsampled luma of the previous frame.
+        size_t m_avgStride;
+        size_t m_lumaStride;
+        bool m_hasReference;
+
+        TemporalDenoiseElementPrivate():
+            m_strength(16),
+            m_motionThreshold(12),
+            m_avgStride(0),
+            m_lumaStride(0),
+            m_hasReference(false)
+        {
+        }
+
+        inline void reset(const QSize &size);
+        inline void downsampleLuma(const QImage &src, AkBuffer &luma) const;
+        inline void detectMotion(const AkBuffer &curLuma,
+                                 QVector<quint8> &moving,
+                                 int blocksX,
+                                 int blocksY) const;
+};
+
+TemporalDenoiseElement::TemporalDenoiseElement(): AkElement()
+{
+    this->d = new TemporalDenoiseElementPrivate;
+}
+
+TemporalDenoiseElement::~TemporalDenoiseElement()
+{
+    if (this->d->m_average)
+        AkBufferPool::globalPool()->release(this->d->m_average);
+
+    if (this->d->m_refLuma)
+        AkBufferPool::globalPool()->release(this->d->m_refLuma);
+
+    delete this->d;
+}
+
+int TemporalDenoiseElement::strength() const
+{
+    return this->d->m_strength;
+}
+
+int TemporalDenoiseElement::motionThreshold() const
+{
+    return this->d->m_motionThreshold;
+}
+
+QString TemporalDenoiseElement::controlInterfaceProvide(const QString &controlId) const
+{
+    Q_UNUSED(controlId)
+
+    return QString("qrc:/TemporalDenoise/share/qml/main.qml");
+}
+
+void TemporalDenoiseElement::controlInterfaceConfigure(QQmlContext *context,
+                                                       const QString &controlId) const
+{
+    Q_UNUSED(controlId)
+
+    context->setContextProperty("TemporalDenoise", const_cast<QObject *>(qobject_cast<const QObject *>(this)));
+    context->setContextProperty("controlId", this->objectName());
+}
+
+void TemporalDenoiseElementPrivate::reset(const QSize &size)
+{
+    auto pool = AkBufferPool::globalPool();
+
+    if (this->m_average)
+        pool->release(this->m_average);
+
+    if (this->m_refLuma)
+        pool->release(this->m_refLuma);
+
+    int lumaWidth = (size.width() + 1) / 2;
+    int lumaHeight = (size.height() + 1) / 2;
+    this->m_avgStride = AkBuffer::padStride(size_t(size.width()) * 4);
+    this->m_lumaStride = AkBuffer::padStride(size_t(lumaWidth));
+    this->m_average = pool->acquire(this->m_avgStride * size_t(size.height()));
+    this->m_refLuma = pool->acquire(this->m_lumaStride * size_t(lumaHeight));
+    this->m_frameSize = size;
+    this->m_hasReference = false;
+}
+
+void TemporalDenoiseElementPrivate::downsampleLuma(const QImage &src,
+                                                   AkBuffer &luma) const
+{
+    int lumaWidth = (src.width() + 1) / 2;
+    int lumaHeight = (src.height() + 1) / 2;
+    auto lumaStride = this->m_lumaStride;
+
+    // Point sampling is enough here, the SAD sums over a whole block so
+    // the skipped pixels don't change which blocks read as moving.
+    AkVideoFilterRunner::globalRunner()->run(lumaHeight,
+                                             [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            auto srcLine =
+                    reinterpret_cast<const QRgb *>(src.constScanLine(2 * y));
+            auto lumaLine = luma.writableLine(0, y, lumaStride);
+
+            for (int x = 0; x < lumaWidth; x++)
+                lumaLine[x] = quint8(qGray(srcLine[2 * x]));
+        }
+    });
+}
+
+void TemporalDenoiseElementPrivate::detectMotion(const AkBuffer &curLuma,
+                                                 QVector<quint8> &moving,
+                                                 int blocksX,
+                                                 int blocksY) const
+{
+    int lumaWidth = (this->m_frameSize.width() + 1) / 2;
+    int lumaHeight = (this->m_frameSize.height() + 1) / 2;
+    auto lumaStride = this->m_lumaStride;
+
+    for (int by = 0; by < blocksY; by++) {
+        int yStart = by * LUMA_BLOCK;
+        int yEnd = qMin(yStart + LUMA_BLOCK, lumaHeight);
+
+        for (int bx = 0; bx < blocksX; bx++) {
+            int xStart = bx * LUMA_BLOCK;
+            int xEnd = qMin(xStart + LUMA_BLOCK, lumaWidth);
+            int sad = 0;
+
+            for (int y = yStart; y < yEnd; y++) {
+                auto curLine = curLuma.constLine(0, y, lumaStride) + xStart;
+                auto refLine =
+                        this->m_refLuma.constLine(0, y, lumaStride) + xStart;
+                int x = 0;
+                int blockWidth = xEnd - xStart;
+
+#if defined(__SSE2__)
+                if (blockWidth == LUMA_BLOCK) {
+                    // psadbw sums the absolute differences of the whole
+                    // 8 byte row in one instruction.
+                    auto cur =
+                            _mm_loadl_epi64(reinterpret_cast<const __m128i *>(curLine));
+                    auto ref =
+                            _mm_loadl_epi64(reinterpret_cast<const __m128i *>(refLine));
+                    sad += _mm_cvtsi128_si32(_mm_sad_epu8(cur, ref));
+                    x = blockWidth;
+                }
+#endif
+
+                for (; x < blockWidth; x++)
+                    sad += qAbs(int(curLine[x]) - int(refLine[x]));
+            }
+
+            int pixels = (xEnd - xStart) * (yEnd - yStart);
+            moving[by * blocksX + bx] =
+                    sad >= this->m_motionThreshold * pixels;
+        }
+    }
+}
+
+void TemporalDenoiseElement::setStrength(int strength)
+{
+    if (this->d->m_strength == strength)
+        return;
+
+    this->d->m_strength = strength;
+    emit this->strengthChanged(strength);
+}
+
+void TemporalDenoiseElement::setMotionThreshold(int motionThreshold)
+{
+    if (this->d->m_motionThreshold == motionThreshold)
+        return;
+
+    this->d->m_motionThreshold = motionThreshold;
+    emit this->motionThresholdChanged(motionThreshold);
+}
+
+void TemporalDenoiseElement::resetStrength()
+{
+    this->setStrength(16);
+}
+
+void TemporalDenoiseElement::resetMotionThreshold()
+{
+    this->setMotionThreshold(12);
+}
+
+AkPacket TemporalDenoiseElement::iStream(const AkPacket &packet)
+{
+    QImage src = AkUtils::packetToImage(packet);
+
+    if (src.isNull())
+        return AkPacket();
+
+    src = src.convertToFormat(QImage::Format_ARGB32);
+    QImage oFrame(src.size(), src.format());
+
+    if (src.size() != this->d->m_frameSize)
+        this->d->reset(src.size());
+
+    int width = src.width();
+    int height = src.height();
+    int lumaWidth = (width + 1) / 2;
+    int lumaHeight = (height + 1) / 2;
+    auto pool = AkBufferPool::globalPool();
+    auto curLuma =
+            pool->acquire(this->d->m_lumaStride * size_t(lumaHeight));
+    this->d->downsampleLuma(src, curLuma);
+
+    int blocksX = (lumaWidth + LUMA_BLOCK - 1) / LUMA_BLOCK;
+    int blocksY = (lumaHeight + LUMA_BLOCK - 1) / LUMA_BLOCK;
+    QVector<quint8> moving(blocksX * blocksY, 1);
+
+    if (this->d->m_hasReference)
+        this->d->detectMotion(curLuma, moving, blocksX, blocksY);
+
+    int strength = qBound(0, this->d->m_strength, 31);
+    bool hasReference = this->d->m_hasReference;
+    auto avgStride = this->d->m_avgStride;
+    auto &average = this->d->m_average;
+
+    AkVideoFilterRunner::globalRunner()->run(height,
+                                             [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            auto srcLine = reinterpret_cast<const QRgb *>(src.constScanLine(y));
+            auto dstLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+            auto avgLine =
+                    reinterpret_cast<QRgb *>(average.writableLine(0,
+                                                                  y,
+                                                                  avgStride));
+            auto movingLine = moving.constData() + (y >> 4) * blocksX;
+
+            for (int x = 0; x < width; x++) {
+                QRgb pixel = srcLine[x];
+
+                if (hasReference && !movingLine[x >> 4]) {
+                    // Static block: lean on the accumulated past. Noise
+                    // averages out over time, real detail is identical in
+                    // both terms and stays sharp.
+                    QRgb avg = avgLine[x];
+                    int w = strength;
+                    int cw = 32 - w;
+                    int r = (w * qRed(avg) + cw * qRed(pixel)) >> 5;
+                    int g = (w * qGreen(avg) + cw * qGreen(pixel)) >> 5;
+                    int b = (w * qBlue(avg) + cw * qBlue(pixel)) >> 5;
+                    pixel = qRgba(r, g, b, qAlpha(pixel));
+                } else if (hasReference) {
+                    // Moving block: the past would ghost, so fall back to
+                    // a cheap spatial smooth. Only these blocks pay for it.
+                    int r = 0;
+                    int g = 0;
+                    int b = 0;
+
+                    for (int j = -1; j < 2; j++) {
+                        auto line =
+                                reinterpret_cast<const QRgb *>(src.constScanLine(qBound(0, y + j, height - 1)));
+
+                        for (int i = -1; i < 2; i++) {
+                            QRgb p = line[qBound(0, x + i, width - 1)];
+                            r += qRed(p);
+                            g += qGreen(p);
+                            b += qBlue(p);
+                        }
+                    }
+
+                    pixel = qRgba(r / 9, g / 9, b / 9, qAlpha(pixel));
+                }
+
+                avgLine[x] = pixel;
+                dstLine[x] = pixel;
+            }
+        }
+    });
+
+    // The current luma becomes the reference for the next frame.
+    pool->release(this->d->m_refLuma);
+    this->d->m_refLuma = curLuma;
+    this->d->m_hasReference = true;
+
+    AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
+    akSend(oPacket)
+}
+
+#include "moc_temporaldenoiseelement.cpp"
@@ -0,0 +1,78 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef TEMPORALDENOISEELEMENT_H
+#define TEMPORALDENOISEELEMENT_H
+
+#include <akelement.h>
+
+class TemporalDenoiseElementPrivate;
+
+/* Motion adaptive temporal denoiser.
+ *
+ * Blocks that match the previous frame are averaged against a running
+ * temporal accumulator, which removes sensor noise without blurring detail.
+ * Blocks with motion can't reuse the past, so only those pay for a spatial
+ * smoothing pass. On mostly static scenes nearly every block takes the
+ * cheap temporal path.
+ */
+class TemporalDenoiseElement: public AkElement
+{
+    Q_OBJECT
+    // Weight of the accumulated past in static blocks, over 32.
+    Q_PROPERTY(int strength
+               READ strength
+               WRITE setStrength
+               RESET resetStrength
+               NOTIFY strengthChanged)
+    // Mean luma difference per block pixel that marks a block as moving.
+    Q_PROPERTY(int motionThreshold
+               READ motionThreshold
+               WRITE setMotionThreshold
+               RESET resetMotionThreshold
+               NOTIFY motionThresholdChanged)
+
+    public:
+        explicit TemporalDenoiseElement();
+        ~TemporalDenoiseElement();
+
+        Q_INVOKABLE int strength() const;
+        Q_INVOKABLE int motionThreshold() const;
+
+    private:
+        TemporalDenoiseElementPrivate *d;
+
+    protected:
+        QString controlInterfaceProvide(const QString &controlId) const;
+        void controlInterfaceConfigure(QQmlContext *context,
+                                       const QString &controlId) const;
+
+    signals:
+        void strengthChanged(int strength);
+        void motionThresholdChanged(int motionThreshold);
+
+    public slots:
+        void setStrength(int strength);
+        void setMotionThreshold(int motionThreshold);
+        void resetStrength();
+        void resetMotionThreshold();
+        AkPacket iStream(const AkPacket &packet);
+};
+
+#endif // TEMPORALDENOISEELEMENT_H
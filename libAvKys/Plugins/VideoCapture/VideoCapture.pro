@@ -27,5 +27,6 @@ CONFIG(config_ffmpeg): SUBDIRS += src/ffmpeg
 CONFIG(config_gstreamer): SUBDIRS += src/gstreamer
 CONFIG(config_libuvc): SUBDIRS += src/libuvc
 CONFIG(config_mediafoundation): SUBDIRS += src/mediafoundation
+CONFIG(config_turbojpeg): SUBDIRS += src/turbojpeg
 CONFIG(config_v4l2): SUBDIRS += src/v4l2sys
 CONFIG(config_v4lutils): SUBDIRS += src/v4lutils
@@ -97,7 +97,7 @@ GridLayout {
                                 value: value}
                     },
                     fps: function (value) {
-                        return {description: Number(Ak.newFrac(value).value.toFixed(2)),
+                        return {description: Number(Ak.fracValue(value).toFixed(2)),
                                 value: value}
                     }}
 
@@ -186,7 +186,7 @@ GridLayout {
         var rawCaps = []
 
         for (var i = 0; i < ncaps; i++)
-            rawCaps.push(Ak.newCaps(VideoCapture.rawCaps(i)).toMap())
+            rawCaps.push(Ak.capsMap(VideoCapture.rawCaps(i)))
 
         caps = rawCaps
     }
@@ -22,6 +22,8 @@
 #include <QWaitCondition>
 #include <QMutex>
 #include <ak.h>
+#include <akbuffer.h>
+#include <akclocksync.h>
 #include <akfrac.h>
 #include <akcaps.h>
 #include <akpacket.h>
@@ -116,6 +118,7 @@ class CaptureAvFoundationPrivate
         AkFrac m_timeBase;
         AkCaps m_caps;
         qint64 m_id;
+        int m_timelineSource;
         QVariantList m_globalImageControls;
         QVariantList m_globalCameraControls;
         QVariantMap m_localImageControls;
@@ -129,7 +132,8 @@ class CaptureAvFoundationPrivate
             m_curFrame(nil),
             m_ioMethod(CaptureAvFoundation::IoMethodUnknown),
             m_nBuffers(32),
-            m_id(-1)
+            m_id(-1),
+            m_timelineSource(-1)
         {
 
         }
@@ -442,24 +446,36 @@ AkPacket CaptureAvFoundation::readFrame()
         }
 
     // Read frame data.
-    QByteArray oBuffer;
+    AkBuffer oBuffer;
 
     CVImageBufferRef imageBuffer = CMSampleBufferGetImageBuffer(this->d->m_curFrame);
     CMBlockBufferRef dataBuffer = CMSampleBufferGetDataBuffer(this->d->m_curFrame);
     QString fourcc;
 
     if (imageBuffer) {
-        size_t dataSize = CVPixelBufferGetDataSize(imageBuffer);
-        oBuffer.resize(int(dataSize));
+        /* Keep a reference to the pixel buffer and hand its mapped
+         * base address downstream. The release callback returns the
+         * buffer to the session's CVPixelBufferPool once the last
+         * reference drops, and the IOSurface backing travels with it,
+         * so a GPU consumer can import the frame without an upload. */
+        CVPixelBufferRetain(imageBuffer);
         CVPixelBufferLockBaseAddress(imageBuffer, 0);
-        void *data = CVPixelBufferGetBaseAddress(imageBuffer);
-        memcpy(oBuffer.data(), data, dataSize);
-        CVPixelBufferUnlockBaseAddress(imageBuffer, 0);
+        auto data = reinterpret_cast<quint8 *>(CVPixelBufferGetBaseAddress(imageBuffer));
+        size_t dataSize = CVPixelBufferGetDataSize(imageBuffer);
+        oBuffer = AkBuffer::fromRawData(data,
+                                        dataSize,
+                                        [imageBuffer] () {
+                                            CVPixelBufferUnlockBaseAddress(imageBuffer, 0);
+                                            CVPixelBufferRelease(imageBuffer);
+                                        });
 
         OSType format = CVPixelBufferGetPixelFormatType(imageBuffer);
         fourcc = pixelFormatToStrMap->value(format,
                                             CaptureAvFoundationPrivate::fourccToStr(format));
     } else if (dataBuffer) {
+        // Compressed frames: the block buffer belongs to the sample,
+        // so the whole sample is retained instead.
+        CMSampleBufferRef sample = this->d->m_curFrame;
         size_t dataSize = 0;
         char *data = NULL;
         CMBlockBufferGetDataPointer(dataBuffer,
@@ -467,14 +483,19 @@ AkPacket CaptureAvFoundation::readFrame()
                                     NULL,
                                     &dataSize,
                                     &data);
-        oBuffer.resize(int(dataSize));
-        memcpy(oBuffer.data(), data, dataSize);
+        CFRetain(sample);
+        oBuffer = AkBuffer::fromRawData(reinterpret_cast<quint8 *>(data),
+                                        dataSize,
+                                        [sample] () {
+                                            CFRelease(sample);
+                                        });
     }
 
     // Read pts.
     CMItemCount count = 0;
     CMSampleTimingInfo timingInfo;
     qint64 pts;
+    qint64 hwTimestamp;
     AkFrac timeBase;
 
     if (CMSampleBufferGetOutputSampleTimingInfoArray(this->d->m_curFrame,
@@ -483,6 +504,15 @@ AkPacket CaptureAvFoundation::readFrame()
                                                      &count) == noErr) {
         pts = timingInfo.presentationTimeStamp.value;
         timeBase = AkFrac(1, timingInfo.presentationTimeStamp.timescale);
+
+        /* The sample carries the host clock capture time, map it onto
+         * the shared timeline so pipelines fed by other devices can
+         * align against it. */
+        hwTimestamp =
+                AkClockSync::map(this->d->m_timelineSource,
+                                 qRound64(1e9
+                                          * timingInfo.presentationTimeStamp.value
+                                          / timingInfo.presentationTimeStamp.timescale));
     } else {
         timeval timestamp;
         gettimeofday(&timestamp, NULL);
@@ -490,6 +520,8 @@ AkPacket CaptureAvFoundation::readFrame()
                       + 1e-6 * timestamp.tv_usec)
                      * this->d->m_timeBase.invert().value());
         timeBase = this->d->m_timeBase;
+        // No timing info on the sample, the dequeue time is the closest.
+        hwTimestamp = AkClockSync::now();
     }
 
     AkCaps caps(this->d->m_caps);
@@ -498,9 +530,11 @@ AkPacket CaptureAvFoundation::readFrame()
         caps.setProperty("fourcc", fourcc);
 
     // Create package.
-    AkPacket packet(caps, oBuffer);
+    AkPacket packet(caps);
+    packet.setFrameBuffer(oBuffer);
     packet.setPts(pts);
     packet.setTimeBase(this->d->m_timeBase);
+    packet.setHardwareTimestamp(hwTimestamp);
     packet.setIndex(0);
     packet.setId(this->d->m_id);
 
@@ -596,7 +630,8 @@ bool CaptureAvFoundation::init()
 
     [this->d->m_session addInput: this->d->m_deviceInput];
 
-    // Add data output unit.
+    // Add data output unit. nil video settings keep the camera's native
+    // pixel format, so the output does no conversion of its own.
     this->d->m_dataOutput = [AVCaptureVideoDataOutput new];
     this->d->m_dataOutput.videoSettings = nil;
     this->d->m_dataOutput.alwaysDiscardsLateVideoFrames = YES;
@@ -649,6 +684,9 @@ bool CaptureAvFoundation::init()
     this->d->m_caps = caps;
     this->d->m_timeBase = fps.invert();
     this->d->m_id = Ak::id();
+    this->d->m_timelineSource =
+            AkClockSync::registerSource("avfoundation:"
+                                        + this->d->m_device.toUtf8());
 
     return true;
 }
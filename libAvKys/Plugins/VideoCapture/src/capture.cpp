@@ -64,6 +64,11 @@ int Capture::nBuffers() const
     return 0;
 }
 
+QRect Capture::cropRegion() const
+{
+    return QRect();
+}
+
 QString Capture::description(const QString &webcam) const
 {
     Q_UNUSED(webcam)
@@ -153,6 +158,11 @@ void Capture::setNBuffers(int nBuffers)
     Q_UNUSED(nBuffers)
 }
 
+void Capture::setCropRegion(const QRect &cropRegion)
+{
+    Q_UNUSED(cropRegion)
+}
+
 void Capture::resetDevice()
 {
 }
@@ -169,6 +179,11 @@ void Capture::resetNBuffers()
 {
 }
 
+void Capture::resetCropRegion()
+{
+    this->setCropRegion(QRect());
+}
+
 void Capture::reset()
 {
 }
@@ -21,6 +21,7 @@
 #define CAPTURE_H
 
 #include <QObject>
+#include <QRect>
 
 class Capture;
 class AkCaps;
@@ -49,6 +50,16 @@ class Capture: public QObject
                WRITE setNBuffers
                RESET resetNBuffers
                NOTIFY nBuffersChanged)
+    /* Region of interest in native frame coordinates, a null rectangle
+     * captures the full frame. Backends push the crop into the driver
+     * where the device supports it, so only the region ever crosses the
+     * bus, and fall back to cropping each frame before delivering the
+     * packet. Takes effect when the stream starts. */
+    Q_PROPERTY(QRect cropRegion
+               READ cropRegion
+               WRITE setCropRegion
+               RESET resetCropRegion
+               NOTIFY cropRegionChanged)
 
     public:
         explicit Capture(QObject *parent=nullptr);
@@ -60,6 +71,7 @@ class Capture: public QObject
         Q_INVOKABLE virtual QList<int> listTracks(const QString &mimeType);
         Q_INVOKABLE virtual QString ioMethod() const;
         Q_INVOKABLE virtual int nBuffers() const;
+        Q_INVOKABLE virtual QRect cropRegion() const;
         Q_INVOKABLE virtual QString description(const QString &webcam) const;
         Q_INVOKABLE virtual QVariantList caps(const QString &webcam) const;
         Q_INVOKABLE virtual QString capsDescription(const AkCaps &caps) const;
@@ -77,6 +89,7 @@ class Capture: public QObject
         void streamsChanged(const QList<int> &streams);
         void ioMethodChanged(const QString &ioMethod);
         void nBuffersChanged(int nBuffers);
+        void cropRegionChanged(const QRect &cropRegion);
         void error(const QString &message);
         void imageControlsChanged(const QVariantMap &imageControls) const;
         void cameraControlsChanged(const QVariantMap &cameraControls) const;
@@ -88,10 +101,12 @@ class Capture: public QObject
         virtual void setStreams(const QList<int> &streams);
         virtual void setIoMethod(const QString &ioMethod);
         virtual void setNBuffers(int nBuffers);
+        virtual void setCropRegion(const QRect &cropRegion);
         virtual void resetDevice();
         virtual void resetStreams();
         virtual void resetIoMethod();
         virtual void resetNBuffers();
+        virtual void resetCropRegion();
         virtual void reset();
 };
 
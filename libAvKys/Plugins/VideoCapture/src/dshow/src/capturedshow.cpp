@@ -28,6 +28,7 @@
 #include <ak.h>
 #include <akfrac.h>
 #include <akcaps.h>
+#include <akclocksync.h>
 #include <akpacket.h>
 #include <dshow.h>
 #include <dbt.h>
@@ -207,6 +208,9 @@ class CaptureDShowPrivate
         SampleGrabberPtr m_grabber;
         FrameGrabber m_frameGrabber;
         QByteArray m_curBuffer;
+        // Graph stream time of the pending sample, in seconds.
+        qreal m_curSampleTime;
+        int m_timelineSource;
         QMutex m_mutex;
         QMutex m_controlsMutex;
         QWaitCondition m_waitCondition;
@@ -218,7 +222,9 @@ class CaptureDShowPrivate
         CaptureDShowPrivate():
             m_id(-1),
             m_ioMethod(CaptureDShow::IoMethodGrabSample),
-            m_graph(nullptr)
+            m_graph(nullptr),
+            m_curSampleTime(-1),
+            m_timelineSource(-1)
         {
         }
 
@@ -554,6 +560,15 @@ AkPacket CaptureDShow::readFrame()
             packet.setTimeBase(this->d->m_timeBase);
             packet.setIndex(0);
             packet.setId(this->d->m_id);
+
+            /* The grabber stamped the sample with the graph's stream
+             * time, map it onto the shared timeline so pipelines fed by
+             * other devices can align against it. */
+            if (this->d->m_curSampleTime >= 0)
+                packet.setHardwareTimestamp(
+                        AkClockSync::map(this->d->m_timelineSource,
+                                         qint64(this->d->m_curSampleTime * 1e9)));
+
             this->d->m_curBuffer.clear();
         }
 
@@ -578,6 +593,8 @@ AkPacket CaptureDShow::readFrame()
         packet.setTimeBase(this->d->m_timeBase);
         packet.setIndex(0);
         packet.setId(this->d->m_id);
+        // GetCurrentBuffer() carries no stamp, the poll time is the closest.
+        packet.setHardwareTimestamp(AkClockSync::now());
     }
 
     return packet;
@@ -1327,6 +1344,16 @@ bool CaptureDShow::init()
     AkCaps caps = this->d->capsFromMediaType(mediaType);
     this->d->m_timeBase = AkFrac(caps.property("fps").toString()).invert();
 
+    /* The graph's stream time restarts from zero on every run, so each
+     * run gets a fresh slot in the offset table instead of resuming a
+     * stale estimate. */
+    this->d->m_curSampleTime = -1;
+    this->d->m_timelineSource =
+            AkClockSync::registerSource("dshow:"
+                                        + this->d->m_device.toUtf8()
+                                        + ":"
+                                        + QByteArray::number(this->d->m_id));
+
     if (FAILED(control->Run())) {
         control->Release();
         this->d->m_graph->Release();
@@ -1469,10 +1496,9 @@ void CaptureDShow::reset()
 
 void CaptureDShow::frameReceived(qreal time, const QByteArray &buffer)
 {
-    Q_UNUSED(time)
-
     this->d->m_mutex.lock();
     this->d->m_curBuffer = buffer;
+    this->d->m_curSampleTime = time;
     this->d->m_waitCondition.wakeAll();
     this->d->m_mutex.unlock();
 }
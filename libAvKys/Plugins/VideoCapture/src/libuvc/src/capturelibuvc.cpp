@@ -18,7 +18,10 @@
  */
 
 #include <QtConcurrent>
+#include <QAtomicInt>
 #include <ak.h>
+#include <akbuffer.h>
+#include <akbufferpool.h>
 #include <akfrac.h>
 #include <akcaps.h>
 #include <akpacket.h>
@@ -31,6 +34,7 @@
 Q_GLOBAL_STATIC(UsbIds, usbIds)
 
 #define TIME_OUT 500
+#define DEFAULT_RING_DEPTH 4
 
 #define PROCESSING_UNIT 0
 #define CAMERA_TERMINAL 1
@@ -171,7 +175,6 @@ class CaptureLibUVCPrivate
         QMap<QString, QVariantList> m_imageControls;
         QMap<QString, QVariantList> m_cameraControls;
         QString m_curDevice;
-        AkPacket m_curPacket;
         uvc_context_t *m_uvcContext;
         uvc_device_handle_t *m_deviceHnd;
         QThreadPool m_threadPool;
@@ -180,10 +183,32 @@ class CaptureLibUVCPrivate
         qint64 m_id;
         AkFrac m_fps;
 
+        /* Single producer, single consumer ring between the USB callback
+         * and readFrame(). The callback only copies the payload into a
+         * pooled buffer and advances the tail, so the isochronous stream
+         * never waits on packet assembly or a slow consumer; everything
+         * else happens on the reader side. One slot stays unused to tell
+         * full from empty. */
+        struct FrameSlot
+        {
+            AkBuffer buffer;
+            size_t dataSize;
+            uvc_frame_format format;
+            quint32 width;
+            quint32 height;
+            qint64 pts;
+        };
+
+        QVector<FrameSlot> m_frameRing;
+        QAtomicInt m_ringHead;
+        QAtomicInt m_ringTail;
+        int m_nBuffers;
+
         CaptureLibUVCPrivate():
             m_uvcContext(nullptr),
             m_deviceHnd(nullptr),
-            m_id(-1)
+            m_id(-1),
+            m_nBuffers(DEFAULT_RING_DEPTH)
         {
         }
 
@@ -273,7 +298,7 @@ QString CaptureLibUVC::ioMethod() const
 
 int CaptureLibUVC::nBuffers() const
 {
-    return 0;
+    return this->d->m_nBuffers;
 }
 
 QString CaptureLibUVC::description(const QString &webcam) const
@@ -488,19 +513,55 @@ bool CaptureLibUVC::resetCameraControls()
 
 AkPacket CaptureLibUVC::readFrame()
 {
-    this->d->m_mutex.lock();
+    if (this->d->m_frameRing.isEmpty())
+        return AkPacket();
+
+    int head = this->d->m_ringHead.load();
+
+    if (head == this->d->m_ringTail.loadAcquire()) {
+        this->d->m_mutex.lock();
+
+        if (head == this->d->m_ringTail.loadAcquire())
+            this->d->m_packetNotReady.wait(&this->d->m_mutex, TIME_OUT);
 
-    if (!this->d->m_curPacket)
-        if (!this->d->m_packetNotReady.wait(&this->d->m_mutex, TIME_OUT)) {
-            this->d->m_mutex.unlock();
+        this->d->m_mutex.unlock();
 
+        if (head == this->d->m_ringTail.loadAcquire())
             return AkPacket();
-        }
+    }
 
-    auto packet = this->d->m_curPacket;
-    this->d->m_curPacket = AkPacket();
+    auto &slot = this->d->m_frameRing[head];
 
-    this->d->m_mutex.unlock();
+    AkCaps caps;
+    caps.setMimeType("video/unknown");
+    caps.setProperty("fourcc", fourccToUvc->key(slot.format));
+    caps.setProperty("width", slot.width);
+    caps.setProperty("height", slot.height);
+    caps.setProperty("fps", this->d->m_fps.toString());
+
+    /* The pooled buffer is bucket sized, so expose exactly the payload
+     * and hand the buffer back to the pool once the last downstream
+     * reference drops. */
+    auto pooled = slot.buffer;
+    auto oBuffer =
+            AkBuffer::fromRawData(pooled.writableData(),
+                                  slot.dataSize,
+                                  [pooled] () {
+                                      AkBufferPool::globalPool()->release(pooled);
+                                  });
+
+    AkPacket packet(caps);
+    packet.setFrameBuffer(oBuffer);
+    packet.setPts(slot.pts);
+    packet.setTimeBase(this->d->m_fps.invert());
+    packet.setIndex(0);
+    packet.setId(this->d->m_id);
+
+    // Free the slot before publishing the new head, the producer may
+    // claim it right after.
+    slot.buffer = AkBuffer();
+    this->d->m_ringHead.storeRelease((head + 1)
+                                     % this->d->m_frameRing.size());
 
     return packet;
 }
@@ -655,31 +716,29 @@ void CaptureLibUVCPrivate::frameCallback(uvc_frame *frame, void *userData)
         return;
 
     auto self = reinterpret_cast<CaptureLibUVC *>(userData);
+    auto d = self->d;
+    int tail = d->m_ringTail.load();
+    int next = (tail + 1) % d->m_frameRing.size();
 
-    self->d->m_mutex.lock();
-
-    AkCaps caps;
-    caps.setMimeType("video/unknown");
-    caps.setProperty("fourcc", fourccToUvc->key(frame->frame_format));
-    caps.setProperty("width", frame->width);
-    caps.setProperty("height", frame->height);
-    caps.setProperty("fps", self->d->m_fps.toString());
-
-    QByteArray buffer(reinterpret_cast<const char *>(frame->data),
-                       int(frame->data_bytes));
-
-    auto pts = qint64(QTime::currentTime().msecsSinceStartOfDay()
-                      * self->d->m_fps.value() / 1e3);
-
-    AkPacket packet(caps, buffer);
-    packet.setPts(pts);
-    packet.setTimeBase(self->d->m_fps.invert());
-    packet.setIndex(0);
-    packet.setId(self->d->m_id);
+    // Ring full: the consumer fell behind, drop the frame instead of
+    // stalling the isochronous stream.
+    if (next == d->m_ringHead.loadAcquire())
+        return;
 
-    self->d->m_curPacket = packet;
-    self->d->m_packetNotReady.wakeAll();
-    self->d->m_mutex.unlock();
+    auto &slot = d->m_frameRing[tail];
+    slot.buffer = AkBufferPool::globalPool()->acquire(frame->data_bytes);
+    memcpy(slot.buffer.writableData(), frame->data, frame->data_bytes);
+    slot.dataSize = frame->data_bytes;
+    slot.format = frame->frame_format;
+    slot.width = frame->width;
+    slot.height = frame->height;
+    slot.pts = qint64(QTime::currentTime().msecsSinceStartOfDay()
+                      * d->m_fps.value() / 1e3);
+    d->m_ringTail.storeRelease(next);
+
+    d->m_mutex.lock();
+    d->m_packetNotReady.wakeAll();
+    d->m_mutex.unlock();
 }
 
 QString CaptureLibUVCPrivate::fourccToStr(const uint8_t *format) const
@@ -748,6 +807,12 @@ bool CaptureLibUVC::init()
         goto init_failed;
     }
 
+    // Size the delivery ring; one extra slot tells full from empty.
+    this->d->m_frameRing =
+            QVector<CaptureLibUVCPrivate::FrameSlot>(qMax(this->d->m_nBuffers, 2) + 1);
+    this->d->m_ringHead.store(0);
+    this->d->m_ringTail.store(0);
+
     error = uvc_start_streaming(this->d->m_deviceHnd,
                                 &streamCtrl,
                                 this->d->frameCallback,
@@ -783,7 +848,7 @@ void CaptureLibUVC::uninit()
         this->d->m_deviceHnd = nullptr;
     }
 
-    this->d->m_curPacket = AkPacket();
+    this->d->m_frameRing.clear();
     this->d->m_curDevice.clear();
     this->d->m_id = -1;
     this->d->m_fps = AkFrac();
@@ -830,7 +895,12 @@ void CaptureLibUVC::setIoMethod(const QString &ioMethod)
 
 void CaptureLibUVC::setNBuffers(int nBuffers)
 {
-    Q_UNUSED(nBuffers)
+    if (nBuffers < 1 || this->d->m_nBuffers == nBuffers)
+        return;
+
+    // Picked up the next time the stream starts.
+    this->d->m_nBuffers = nBuffers;
+    emit this->nBuffersChanged(nBuffers);
 }
 
 void CaptureLibUVC::resetDevice()
@@ -855,6 +925,7 @@ void CaptureLibUVC::resetIoMethod()
 
 void CaptureLibUVC::resetNBuffers()
 {
+    this->setNBuffers(DEFAULT_RING_DEPTH);
 }
 
 void CaptureLibUVC::reset()
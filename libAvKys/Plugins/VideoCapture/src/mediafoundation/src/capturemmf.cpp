@@ -27,6 +27,7 @@
 #include <QMutex>
 #include <QWaitCondition>
 #include <ak.h>
+#include <akbuffer.h>
 #include <akfrac.h>
 #include <akcaps.h>
 #include <akpacket.h>
@@ -190,6 +191,7 @@ class CaptureMMFPrivate
         QStringList m_webcams;
         QString m_device;
         QList<int> m_streams;
+        AkCaps m_caps;
         qint64 m_id;
         DWORD m_streamIndex;
         CaptureMMF::IoMethod m_ioMethod;
@@ -510,40 +512,42 @@ AkPacket CaptureMMF::readFrame()
         return AkPacket();
     }
 
-    // Read stream caps.
-    auto stream = this->d->stream(this->d->m_mediaSource.data(),
-                                  actualStreamIndex);
-    IMFMediaType *mediaType = nullptr;
-    stream->GetCurrentMediaType(&mediaType);
-    AkCaps caps = this->d->capsFromMediaType(mediaType);
-    mediaType->Release();
+    Q_UNUSED(actualStreamIndex);
 
     // Read buffer.
     IMFMediaBuffer *buffer = nullptr;
     sample->GetBufferByIndex(0, &buffer);
 
-    DWORD bufferLength = 0;
-    buffer->GetMaxLength(&bufferLength);
-
-    QByteArray oBuffer(int(bufferLength), 0);
     BYTE  *data = nullptr;
     DWORD maxLength = 0;
     DWORD currentLength = 0;
 
-    buffer->Lock(&data, &maxLength, &currentLength);
-    memcpy(oBuffer.data(),
-           data,
-           size_t(maxLength));
-    buffer->Unlock();
-    buffer->Release();
+    if (FAILED(buffer->Lock(&data, &maxLength, &currentLength))) {
+        buffer->Release();
+        sample->Release();
+
+        return AkPacket();
+    }
 
     // Read pts.
     LONGLONG sampleTime = 0;
     sample->GetSampleTime(&sampleTime);
-    sample->Release();
+
+    /* Hand the locked sample bytes downstream as-is. The release
+     * callback unlocks the buffer and returns the sample to the source
+     * reader's pool once the last reference drops, so frames cross the
+     * pipeline without a copy. */
+    auto oBuffer = AkBuffer::fromRawData(data,
+                                         currentLength,
+                                         [buffer, sample] () {
+                                             buffer->Unlock();
+                                             buffer->Release();
+                                             sample->Release();
+                                         });
 
     // Send packet.
-    AkPacket packet(caps, oBuffer);
+    AkPacket packet(this->d->m_caps);
+    packet.setFrameBuffer(oBuffer);
     packet.setPts(sampleTime);
     packet.setTimeBase(AkFrac(1, TIME_BASE));
     packet.setIndex(0);
@@ -613,6 +617,7 @@ bool CaptureMMF::init()
     DWORD streamIndex = MF_SOURCE_READER_FIRST_VIDEO_STREAM;
     DWORD mediaTypeIndex = 0;
     IMFSourceReader *sourceReader = nullptr;
+    IMFMediaType *currentMediaType = nullptr;
 
     if (FAILED(MFCreateSourceReaderFromMediaSource(mediaSource.data(),
                                                    attributes,
@@ -655,6 +660,15 @@ bool CaptureMMF::init()
         break;
     }
 
+    /* Cache the negotiated caps. Before, every sample rebuilt a
+     * presentation descriptor just to re-read a media type that can't
+     * change while the reader is running. */
+    if (SUCCEEDED(this->d->m_sourceReader->GetCurrentMediaType(streamIndex,
+                                                               &currentMediaType))) {
+        this->d->m_caps = this->d->capsFromMediaType(currentMediaType);
+        currentMediaType->Release();
+    }
+
     this->d->m_mediaSource = mediaSource;
     this->d->m_id = Ak::id();
     this->d->m_streamIndex = streamIndex;
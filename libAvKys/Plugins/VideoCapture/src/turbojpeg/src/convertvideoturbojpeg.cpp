@@ -0,0 +1,307 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <QtConcurrent>
+#include <QQueue>
+#include <QMutex>
+#include <ak.h>
+#include <akfrac.h>
+#include <akcaps.h>
+#include <akvideocaps.h>
+#include <akpacket.h>
+#include <akvideopacket.h>
+#include <akvideoconvert.h>
+
+#include <turbojpeg.h>
+
+#include "convertvideoturbojpeg.h"
+
+#define THREAD_WAIT_LIMIT 500
+
+typedef QMap<QString, AkVideoCaps::PixelFormat> V4l2RawFmtMap;
+
+inline V4l2RawFmtMap initV4l2RawFmtMap()
+{
+    V4l2RawFmtMap rawToAk = {
+        {"YUYV", AkVideoCaps::Format_yuyv422},
+        {"YUY2", AkVideoCaps::Format_yuyv422},
+        {"UYVY", AkVideoCaps::Format_uyvy422},
+        {"NV12", AkVideoCaps::Format_nv12   },
+        {"RGB3", AkVideoCaps::Format_rgb24  },
+        {"GREY", AkVideoCaps::Format_gray   },
+        {"Y800", AkVideoCaps::Format_gray   }
+    };
+
+    return rawToAk;
+}
+
+Q_GLOBAL_STATIC_WITH_ARGS(V4l2RawFmtMap, rawToAk, (initV4l2RawFmtMap()))
+
+class ConvertVideoTurboJPEGPrivate
+{
+    public:
+        ConvertVideoTurboJPEG *self;
+        tjhandle m_decompressor;
+        qint64 m_maxPacketQueueSize;
+        AkVideoCaps::PixelFormat m_rawFormat;
+        bool m_isJpeg;
+        AkFrac m_fps;
+        qint64 m_id;
+        QThreadPool m_threadPool;
+        QMutex m_packetMutex;
+        QWaitCondition m_packetQueueNotEmpty;
+        QWaitCondition m_packetQueueNotFull;
+        QQueue<AkPacket> m_packets;
+        qint64 m_packetQueueSize;
+        bool m_runDecodeLoop;
+        QFuture<void> m_decodeLoopResult;
+
+        ConvertVideoTurboJPEGPrivate(ConvertVideoTurboJPEG *self):
+            self(self),
+            m_decompressor(nullptr),
+            m_maxPacketQueueSize(15 * 1024 * 1024),
+            m_rawFormat(AkVideoCaps::Format_none),
+            m_isJpeg(false),
+            m_id(-1),
+            m_packetQueueSize(0),
+            m_runDecodeLoop(false)
+        {
+        }
+
+        inline static void decodeLoop(ConvertVideoTurboJPEG *stream);
+        inline void processPacket(const AkPacket &packet);
+        inline void decodeJpeg(const AkPacket &packet);
+        inline void convertRaw(const AkPacket &packet);
+};
+
+ConvertVideoTurboJPEG::ConvertVideoTurboJPEG(QObject *parent):
+    ConvertVideo(parent)
+{
+    this->d = new ConvertVideoTurboJPEGPrivate(this);
+
+    if (this->d->m_threadPool.maxThreadCount() < 1)
+        this->d->m_threadPool.setMaxThreadCount(1);
+}
+
+ConvertVideoTurboJPEG::~ConvertVideoTurboJPEG()
+{
+    this->uninit();
+    delete this->d;
+}
+
+qint64 ConvertVideoTurboJPEG::maxPacketQueueSize() const
+{
+    return this->d->m_maxPacketQueueSize;
+}
+
+void ConvertVideoTurboJPEG::packetEnqueue(const AkPacket &packet)
+{
+    this->d->m_packetMutex.lock();
+
+    if (this->d->m_packetQueueSize >= this->d->m_maxPacketQueueSize)
+        this->d->m_packetQueueNotFull.wait(&this->d->m_packetMutex);
+
+    this->d->m_packets.enqueue(packet);
+    this->d->m_packetQueueSize += packet.buffer().size();
+    this->d->m_packetQueueNotEmpty.wakeAll();
+    this->d->m_packetMutex.unlock();
+}
+
+bool ConvertVideoTurboJPEG::init(const AkCaps &caps)
+{
+    QString fourcc = caps.property("fourcc").toString();
+    this->d->m_isJpeg = fourcc == "MJPG" || fourcc == "JPEG";
+    this->d->m_rawFormat = rawToAk->value(fourcc, AkVideoCaps::Format_none);
+
+    if (this->d->m_isJpeg) {
+        // One persistent decompressor per stream keeps the Huffman tables
+        // and SIMD state warm between frames.
+        this->d->m_decompressor = tjInitDecompress();
+
+        if (!this->d->m_decompressor)
+            return false;
+    } else if (this->d->m_rawFormat == AkVideoCaps::Format_none) {
+        return false;
+    } else if (this->d->m_rawFormat != AkVideoCaps::Format_rgb24
+               && !AkVideoConvert::canConvert(this->d->m_rawFormat,
+                                              AkVideoCaps::Format_rgb24)) {
+        return false;
+    }
+
+    this->d->m_fps = caps.property("fps").toString();
+    this->d->m_id = Ak::id();
+    this->d->m_packets.clear();
+    this->d->m_packetQueueSize = 0;
+    this->d->m_runDecodeLoop = true;
+    this->d->m_decodeLoopResult =
+            QtConcurrent::run(&this->d->m_threadPool,
+                              this->d->decodeLoop,
+                              this);
+
+    return true;
+}
+
+void ConvertVideoTurboJPEG::uninit()
+{
+    this->d->m_runDecodeLoop = false;
+    this->d->m_decodeLoopResult.waitForFinished();
+    this->d->m_packets.clear();
+    this->d->m_packetQueueSize = 0;
+
+    if (this->d->m_decompressor) {
+        tjDestroy(this->d->m_decompressor);
+        this->d->m_decompressor = nullptr;
+    }
+}
+
+void ConvertVideoTurboJPEGPrivate::decodeLoop(ConvertVideoTurboJPEG *stream)
+{
+    while (stream->d->m_runDecodeLoop) {
+        stream->d->m_packetMutex.lock();
+
+        if (stream->d->m_packets.isEmpty())
+            stream->d->m_packetQueueNotEmpty.wait(&stream->d->m_packetMutex,
+                                                  THREAD_WAIT_LIMIT);
+
+        AkPacket packet;
+
+        if (!stream->d->m_packets.isEmpty()) {
+            packet = stream->d->m_packets.dequeue();
+            stream->d->m_packetQueueSize -= packet.buffer().size();
+
+            if (stream->d->m_packetQueueSize < stream->d->m_maxPacketQueueSize)
+                stream->d->m_packetQueueNotFull.wakeAll();
+        }
+
+        stream->d->m_packetMutex.unlock();
+
+        if (packet)
+            stream->d->processPacket(packet);
+    }
+}
+
+void ConvertVideoTurboJPEGPrivate::processPacket(const AkPacket &packet)
+{
+    if (this->m_isJpeg)
+        this->decodeJpeg(packet);
+    else
+        this->convertRaw(packet);
+}
+
+void ConvertVideoTurboJPEGPrivate::decodeJpeg(const AkPacket &packet)
+{
+    auto jpegData =
+            reinterpret_cast<const unsigned char *>(packet.buffer().constData());
+    auto jpegSize = ulong(packet.buffer().size());
+    int width = 0;
+    int height = 0;
+    int jpegSubsamp = 0;
+    int jpegColorspace = 0;
+
+    if (tjDecompressHeader3(this->m_decompressor,
+                            jpegData,
+                            jpegSize,
+                            &width,
+                            &height,
+                            &jpegSubsamp,
+                            &jpegColorspace) < 0)
+        return;
+
+    if (width < 1 || height < 1)
+        return;
+
+    QByteArray oBuffer(3 * width * height, 0);
+
+    // libjpeg-turbo does the YUV to RGB conversion with SIMD code while
+    // writing the decoded scanlines, so no extra color conversion pass is
+    // needed afterwards.
+    if (tjDecompress2(this->m_decompressor,
+                      jpegData,
+                      jpegSize,
+                      reinterpret_cast<unsigned char *>(oBuffer.data()),
+                      width,
+                      0,
+                      height,
+                      TJPF_RGB,
+                      TJFLAG_FASTDCT) < 0)
+        return;
+
+    AkVideoCaps caps;
+    caps.isValid() = true;
+    caps.format() = AkVideoCaps::Format_rgb24;
+    caps.bpp() = AkVideoCaps::bitsPerPixel(caps.format());
+    caps.width() = width;
+    caps.height() = height;
+    caps.fps() = this->m_fps;
+
+    AkVideoPacket oPacket;
+    oPacket.caps() = caps;
+    oPacket.buffer() = oBuffer;
+    oPacket.id() = this->m_id;
+    oPacket.pts() = packet.pts();
+    oPacket.timeBase() = caps.fps().invert();
+    oPacket.index() = 0;
+
+    emit self->frameReady(oPacket.toPacket());
+}
+
+void ConvertVideoTurboJPEGPrivate::convertRaw(const AkPacket &packet)
+{
+    AkVideoCaps caps;
+    caps.isValid() = true;
+    caps.format() = this->m_rawFormat;
+    caps.bpp() = AkVideoCaps::bitsPerPixel(caps.format());
+    caps.width() = packet.caps().property("width").toInt();
+    caps.height() = packet.caps().property("height").toInt();
+    caps.fps() = this->m_fps;
+
+    AkVideoPacket oPacket;
+    oPacket.caps() = caps;
+    oPacket.buffer() = packet.buffer();
+    oPacket.id() = this->m_id;
+    oPacket.pts() = packet.pts();
+    oPacket.timeBase() = caps.fps().invert();
+    oPacket.index() = 0;
+
+    if (this->m_rawFormat != AkVideoCaps::Format_rgb24) {
+        oPacket = AkVideoConvert::convert(oPacket,
+                                          AkVideoCaps::Format_rgb24);
+
+        if (!oPacket)
+            return;
+    }
+
+    emit self->frameReady(oPacket.toPacket());
+}
+
+void ConvertVideoTurboJPEG::setMaxPacketQueueSize(qint64 maxPacketQueueSize)
+{
+    if (this->d->m_maxPacketQueueSize == maxPacketQueueSize)
+        return;
+
+    this->d->m_maxPacketQueueSize = maxPacketQueueSize;
+    emit this->maxPacketQueueSizeChanged(maxPacketQueueSize);
+}
+
+void ConvertVideoTurboJPEG::resetMaxPacketQueueSize()
+{
+    this->setMaxPacketQueueSize(15 * 1024 * 1024);
+}
+
+#include "moc_convertvideoturbojpeg.cpp"
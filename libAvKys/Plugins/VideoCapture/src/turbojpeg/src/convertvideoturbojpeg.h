@@ -0,0 +1,59 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef CONVERTVIDEOTURBOJPEG_H
+#define CONVERTVIDEOTURBOJPEG_H
+
+#include "convertvideo.h"
+
+class ConvertVideoTurboJPEGPrivate;
+
+class ConvertVideoTurboJPEG: public ConvertVideo
+{
+    Q_OBJECT
+    Q_PROPERTY(qint64 maxPacketQueueSize
+               READ maxPacketQueueSize
+               WRITE setMaxPacketQueueSize
+               RESET resetMaxPacketQueueSize
+               NOTIFY maxPacketQueueSizeChanged)
+
+    public:
+        explicit ConvertVideoTurboJPEG(QObject *parent=nullptr);
+        ~ConvertVideoTurboJPEG();
+
+        Q_INVOKABLE qint64 maxPacketQueueSize() const;
+
+        Q_INVOKABLE void packetEnqueue(const AkPacket &packet);
+        Q_INVOKABLE bool init(const AkCaps &caps);
+        Q_INVOKABLE void uninit();
+
+    private:
+        ConvertVideoTurboJPEGPrivate *d;
+
+    signals:
+        void maxPacketQueueSizeChanged(qint64 maxPacketQueueSize);
+
+    public slots:
+        void setMaxPacketQueueSize(qint64 maxPacketQueueSize);
+        void resetMaxPacketQueueSize();
+
+        friend class ConvertVideoTurboJPEGPrivate;
+};
+
+#endif // CONVERTVIDEOTURBOJPEG_H
@@ -23,9 +23,14 @@
 #include <QVector>
 #include <QDir>
 #include <QFileSystemWatcher>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QtConcurrent>
 #include <ak.h>
 #include <akfrac.h>
 #include <akcaps.h>
+#include <akbuffer.h>
+#include <akclocksync.h>
 #include <akpacket.h>
 #include <sys/mman.h>
 #include <fcntl.h>
@@ -95,9 +100,67 @@ inline IoMethodMap initIoMethodMap()
 
 Q_GLOBAL_STATIC_WITH_ARGS(IoMethodMap, ioMethodToStr, (initIoMethodMap()))
 
+/* Keeps the memory mapped capture buffers alive while zero-copy frames are
+ * still referenced downstream, and requeues each buffer into the driver when
+ * its last reference drops. The mappings are released once the stream has
+ * stopped and no frame points into them anymore.
+ */
+class CaptureV4L2BufferContext
+{
+    public:
+        QMutex m_mutex;
+        QVector<CaptureBuffer> m_buffers;
+        int m_fd;
+
+        CaptureV4L2BufferContext():
+            m_fd(-1)
+        {
+        }
+
+        ~CaptureV4L2BufferContext()
+        {
+            for (auto &buffer: this->m_buffers)
+                x_munmap(buffer.start, buffer.length);
+        }
+
+        void enqueue(quint32 index)
+        {
+            QMutexLocker locker(&this->m_mutex);
+
+            if (this->m_fd < 0)
+                return;
+
+            v4l2_buffer buffer;
+            memset(&buffer, 0, sizeof(buffer));
+            buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            buffer.memory = V4L2_MEMORY_MMAP;
+            buffer.index = index;
+
+            forever {
+                if (x_ioctl(this->m_fd, VIDIOC_QBUF, &buffer) != -1
+                    || errno != EINTR)
+                    break;
+            }
+        }
+};
+
 class CaptureV4L2Private
 {
     public:
+        // Everything one device scan learns about a single node. The caps
+        // are the expensive part to gather, so they are cached between
+        // scans, the controls are re-read every time because their current
+        // values can change behind our back.
+        struct DeviceProbe
+        {
+            QString fileName;
+            QString cacheKey;
+            QString description;
+            QVariantList caps;
+            QVariantList imageControls;
+            QVariantList cameraControls;
+        };
+
         CaptureV4L2 *self;
         QString m_device;
         QList<int> m_streams;
@@ -108,24 +171,38 @@ class CaptureV4L2Private
         QMap<QString, QVariantList> m_cameraControls;
         CaptureV4L2::IoMethod m_ioMethod;
         int m_nBuffers;
+        QRect m_cropRegion;
+        QRect m_appliedCrop;
+        int m_cropBpp;
+        int m_frameWidth;
+        bool m_softwareCrop;
         QFileSystemWatcher *m_fsWatcher;
         int m_fd;
         AkFrac m_fps;
         AkFrac m_timeBase;
         AkCaps m_caps;
         qint64 m_id;
+        int m_timelineSource;
         QVector<CaptureBuffer> m_buffers;
+        QSharedPointer<CaptureV4L2BufferContext> m_streamContext;
+        QMap<QString, QVariantList> m_capsCache;
 
         CaptureV4L2Private(CaptureV4L2 *self):
             self(self),
             m_ioMethod(CaptureV4L2::IoMethodUnknown),
             m_nBuffers(32),
+            m_cropBpp(0),
+            m_frameWidth(0),
+            m_softwareCrop(false),
             m_fsWatcher(nullptr),
             m_fd(-1),
-            m_id(-1)
+            m_id(-1),
+            m_timelineSource(-1)
         {
         }
 
+        DeviceProbe probeDevice(const QString &fileName,
+                                const QMap<QString, QVariantList> &capsCache) const;
         QVariantList capsFps(int fd,
                              const v4l2_fmtdesc &format,
                              __u32 width,
@@ -141,12 +218,17 @@ class CaptureV4L2Private
         inline bool initUserPointer(quint32 bufferSize);
         inline bool startCapture();
         inline void stopCapture();
+        inline int cropBytesPerPixel(quint32 format) const;
+        inline bool setDriverCropRegion(const QRect &region);
         inline QString fourccToStr(quint32 format) const;
         inline quint32 strToFourCC(const QString &format) const;
         inline int xioctl(int fd, ulong request, void *arg) const;
         inline AkPacket processFrame(const char *buffer,
                                      size_t bufferSize,
                                      qint64 pts) const;
+        inline AkPacket processMappedFrame(quint32 index,
+                                           size_t bufferSize,
+                                           qint64 pts) const;
 };
 
 CaptureV4L2::CaptureV4L2(QObject *parent):
@@ -221,6 +303,11 @@ int CaptureV4L2::nBuffers() const
     return this->d->m_nBuffers;
 }
 
+QRect CaptureV4L2::cropRegion() const
+{
+    return this->d->m_cropRegion;
+}
+
 QString CaptureV4L2::description(const QString &webcam) const
 {
     return this->d->m_descriptions.value(webcam);
@@ -401,9 +488,13 @@ AkPacket CaptureV4L2::readFrame()
                              + 1e-6 * timestamp.tv_usec)
                             * this->d->m_fps.value());
 
-        return this->d->processFrame(this->d->m_buffers[0].start,
-                                     this->d->m_buffers[0].length,
-                                     pts);
+        auto packet = this->d->processFrame(this->d->m_buffers[0].start,
+                                            this->d->m_buffers[0].length,
+                                            pts);
+        // read() has no driver stamp, the return time is the closest.
+        packet.setHardwareTimestamp(AkClockSync::now());
+
+        return packet;
     } else if (this->d->m_ioMethod == IoMethodMemoryMap
                || this->d->m_ioMethod == IoMethodUserPointer) {
         v4l2_buffer buffer;
@@ -425,10 +516,34 @@ AkPacket CaptureV4L2::readFrame()
                              + 1e-6 * buffer.timestamp.tv_usec)
                             * this->d->m_fps.value());
 
+        /* The driver stamped the buffer when the sensor delivered it, map
+         * that onto the shared timeline so pipelines fed by different
+         * devices can align their frames. */
+        qint64 deviceTimeNs = qint64(buffer.timestamp.tv_sec) * 1000000000
+                              + qint64(buffer.timestamp.tv_usec) * 1000;
+        qint64 hwTimestamp =
+                AkClockSync::map(this->d->m_timelineSource, deviceTimeNs);
+
+        /* Zero-copy path: the packet references the mapped memory directly,
+         * the buffer goes back to the driver when the frame is released.
+         * The software crop copies anyway, so it takes the copy path and
+         * requeues the buffer right away. */
+        if (this->d->m_ioMethod == IoMethodMemoryMap
+            && this->d->m_streamContext
+            && !this->d->m_softwareCrop) {
+            auto packet = this->d->processMappedFrame(buffer.index,
+                                                      buffer.bytesused,
+                                                      pts);
+            packet.setHardwareTimestamp(hwTimestamp);
+
+            return packet;
+        }
+
         AkPacket packet =
                 this->d->processFrame(this->d->m_buffers[int(buffer.index)].start,
                                       buffer.bytesused,
                                       pts);
+        packet.setHardwareTimestamp(hwTimestamp);
 
         if (this->d->xioctl(this->d->m_fd, VIDIOC_QBUF, &buffer) < 0)
             return AkPacket();
@@ -829,6 +944,11 @@ bool CaptureV4L2Private::initMemoryMap()
         return false;
     }
 
+    this->m_streamContext =
+            QSharedPointer<CaptureV4L2BufferContext>(new CaptureV4L2BufferContext);
+    this->m_streamContext->m_fd = this->m_fd;
+    this->m_streamContext->m_buffers = this->m_buffers;
+
     return true;
 }
 
@@ -926,6 +1046,13 @@ bool CaptureV4L2Private::startCapture()
 
 void CaptureV4L2Private::stopCapture()
 {
+    // In-flight zero-copy frames must not requeue buffers into a stream
+    // that is shutting down.
+    if (this->m_streamContext) {
+        QMutexLocker locker(&this->m_streamContext->m_mutex);
+        this->m_streamContext->m_fd = -1;
+    }
+
     if (this->m_ioMethod == CaptureV4L2::IoMethodMemoryMap
         || this->m_ioMethod == CaptureV4L2::IoMethodUserPointer) {
         v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
@@ -934,6 +1061,67 @@ void CaptureV4L2Private::stopCapture()
     }
 }
 
+/* Bytes per pixel of the packed formats the software crop can slice by
+ * rows; 0 for planar and compressed streams, which can't be cropped
+ * before decoding. */
+int CaptureV4L2Private::cropBytesPerPixel(quint32 format) const
+{
+    switch (format) {
+    case V4L2_PIX_FMT_GREY:
+        return 1;
+    case V4L2_PIX_FMT_YUYV:
+    case V4L2_PIX_FMT_UYVY:
+    case V4L2_PIX_FMT_RGB565:
+        return 2;
+    case V4L2_PIX_FMT_RGB24:
+    case V4L2_PIX_FMT_BGR24:
+        return 3;
+    case V4L2_PIX_FMT_RGB32:
+    case V4L2_PIX_FMT_BGR32:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+/* Ask the driver to capture only the region, so the cropped pixels never
+ * leave the device. Newer drivers expose the selection API, older ones the
+ * crop ioctls; either way the frame keeps the negotiated size and the
+ * driver pans or scales the region into it. */
+bool CaptureV4L2Private::setDriverCropRegion(const QRect &region)
+{
+    v4l2_rect rect;
+    rect.left = region.left();
+    rect.top = region.top();
+    rect.width = __u32(region.width());
+    rect.height = __u32(region.height());
+
+#ifdef VIDIOC_S_SELECTION
+    v4l2_selection selection;
+    memset(&selection, 0, sizeof(v4l2_selection));
+    selection.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    selection.target = V4L2_SEL_TGT_CROP;
+    selection.r = rect;
+
+    if (this->xioctl(this->m_fd, VIDIOC_S_SELECTION, &selection) >= 0)
+        return true;
+#endif
+
+    v4l2_cropcap cropcap;
+    memset(&cropcap, 0, sizeof(v4l2_cropcap));
+    cropcap.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+
+    if (this->xioctl(this->m_fd, VIDIOC_CROPCAP, &cropcap) < 0)
+        return false;
+
+    v4l2_crop crop;
+    memset(&crop, 0, sizeof(v4l2_crop));
+    crop.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    crop.c = rect;
+
+    return this->xioctl(this->m_fd, VIDIOC_S_CROP, &crop) >= 0;
+}
+
 QString CaptureV4L2Private::fourccToStr(quint32 format) const
 {
     char fourcc[5];
@@ -969,7 +1157,31 @@ AkPacket CaptureV4L2Private::processFrame(const char *buffer,
                                           size_t bufferSize,
                                           qint64 pts) const
 {
-    QByteArray oBuffer(buffer, int(bufferSize));
+    QByteArray oBuffer;
+
+    if (this->m_softwareCrop) {
+        /* Row-sliced copy of the region: every row is one contiguous span,
+         * so each copy runs straight through memory and vectorizes. */
+        int srcStride = this->m_frameWidth * this->m_cropBpp;
+        int dstStride = this->m_appliedCrop.width() * this->m_cropBpp;
+        int left = this->m_appliedCrop.left() * this->m_cropBpp;
+        int rows = this->m_appliedCrop.height();
+        oBuffer.resize(dstStride * rows);
+        auto src = buffer + this->m_appliedCrop.top() * srcStride;
+        auto dst = oBuffer.data();
+
+        for (int y = 0; y < rows; y++) {
+            if (size_t(src - buffer) + size_t(left + dstStride) > bufferSize)
+                break;
+
+            memcpy(dst, src + left, size_t(dstStride));
+            src += srcStride;
+            dst += dstStride;
+        }
+    } else {
+        oBuffer = QByteArray(buffer, int(bufferSize));
+    }
+
     AkPacket oPacket(this->m_caps, oBuffer);
 
     oPacket.setPts(pts);
@@ -980,6 +1192,29 @@ AkPacket CaptureV4L2Private::processFrame(const char *buffer,
     return oPacket;
 }
 
+AkPacket CaptureV4L2Private::processMappedFrame(quint32 index,
+                                                size_t bufferSize,
+                                                qint64 pts) const
+{
+    auto context = this->m_streamContext;
+    auto start =
+            reinterpret_cast<quint8 *>(this->m_buffers[int(index)].start);
+    auto oBuffer = AkBuffer::fromRawData(start,
+                                         bufferSize,
+                                         [context, index] () {
+                                             context->enqueue(index);
+                                         });
+
+    AkPacket oPacket(this->m_caps);
+    oPacket.setFrameBuffer(oBuffer);
+    oPacket.setPts(pts);
+    oPacket.setTimeBase(this->m_timeBase);
+    oPacket.setIndex(0);
+    oPacket.setId(this->m_id);
+
+    return oPacket;
+}
+
 bool CaptureV4L2::init()
 {
     // Frames read must be blocking so we does not waste CPU time.
@@ -1041,9 +1276,49 @@ bool CaptureV4L2::init()
         return false;
     }
 
+    /* Push the region of interest down to the device: with driver support
+     * only the cropped pixels ever leave the sensor, otherwise each frame
+     * is sliced down to the region before the packet is delivered. */
+    this->d->m_softwareCrop = false;
+
+    if (!this->d->m_cropRegion.isNull()) {
+        QRect frame(0, 0,
+                    int(fmt.fmt.pix.width),
+                    int(fmt.fmt.pix.height));
+        auto region = this->d->m_cropRegion.intersected(frame);
+
+        if (!region.isEmpty()
+            && region != frame
+            && !this->d->setDriverCropRegion(region)) {
+            auto bpp = this->d->cropBytesPerPixel(fmt.fmt.pix.pixelformat);
+
+            if (bpp > 0) {
+                // Keep the chroma phase of packed YUV intact.
+                if (fmt.fmt.pix.pixelformat == V4L2_PIX_FMT_YUYV
+                    || fmt.fmt.pix.pixelformat == V4L2_PIX_FMT_UYVY) {
+                    region.setLeft(region.left() & ~1);
+                    region.setWidth(region.width() & ~1);
+                }
+
+                this->d->m_softwareCrop = true;
+                this->d->m_appliedCrop = region;
+                this->d->m_cropBpp = bpp;
+                this->d->m_frameWidth = int(fmt.fmt.pix.width);
+                caps.setProperty("width", region.width());
+                caps.setProperty("height", region.height());
+            } else {
+                qDebug() << "VideoCapture: Can't crop"
+                         << this->d->fourccToStr(fmt.fmt.pix.pixelformat)
+                         << "in software, capturing the full frame.";
+            }
+        }
+    }
+
     this->d->m_caps = caps;
     this->d->m_fps = caps.property("fps").toString();
     this->d->m_timeBase = this->d->m_fps.invert();
+    this->d->m_timelineSource =
+            AkClockSync::registerSource("v4l2:" + this->d->m_device.toUtf8());
 
     if (this->d->m_ioMethod == IoMethodReadWrite
         && capabilities.capabilities & V4L2_CAP_READWRITE
@@ -1087,9 +1362,9 @@ void CaptureV4L2::uninit()
         if (this->d->m_ioMethod == IoMethodReadWrite)
             delete [] this->d->m_buffers[0].start;
         else if (this->d->m_ioMethod == IoMethodMemoryMap)
-            for (qint32 i = 0; i < this->d->m_buffers.size(); i++)
-                x_munmap(this->d->m_buffers[i].start,
-                         this->d->m_buffers[i].length);
+            // The stream context unmaps the buffers once the last zero-copy
+            // frame still in flight has been released.
+            this->d->m_streamContext.clear();
         else if (this->d->m_ioMethod == IoMethodUserPointer)
             for (qint32 i = 0; i < this->d->m_buffers.size(); i++)
                 delete [] this->d->m_buffers[i].start;
@@ -1100,6 +1375,7 @@ void CaptureV4L2::uninit()
     this->d->m_fps = AkFrac();
     this->d->m_timeBase = AkFrac();
     this->d->m_buffers.clear();
+    this->d->m_softwareCrop = false;
 }
 
 void CaptureV4L2::setDevice(const QString &device)
@@ -1159,6 +1435,15 @@ void CaptureV4L2::setNBuffers(int nBuffers)
     emit this->nBuffersChanged(nBuffers);
 }
 
+void CaptureV4L2::setCropRegion(const QRect &cropRegion)
+{
+    if (this->d->m_cropRegion == cropRegion)
+        return;
+
+    this->d->m_cropRegion = cropRegion;
+    emit this->cropRegionChanged(cropRegion);
+}
+
 void CaptureV4L2::resetDevice()
 {
     this->setDevice("");
@@ -1192,6 +1477,117 @@ void CaptureV4L2::reset()
     this->resetCameraControls();
 }
 
+CaptureV4L2Private::DeviceProbe CaptureV4L2Private::probeDevice(const QString &fileName,
+                                                                const QMap<QString, QVariantList> &capsCache) const
+{
+    DeviceProbe probe;
+    int fd = x_open(fileName.toStdString().c_str(), O_RDWR | O_NONBLOCK, 0);
+
+    if (fd < 0)
+        return probe;
+
+    v4l2_capability capability;
+    memset(&capability, 0, sizeof(v4l2_capability));
+
+    // Check if this is a video capture device.
+    if (this->xioctl(fd, VIDIOC_QUERYCAP, &capability) >= 0
+        && capability.capabilities & V4L2_CAP_VIDEO_CAPTURE) {
+        v4l2_format fmt;
+        memset(&fmt, 0, sizeof(v4l2_format));
+        fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+
+        // Check if it has at least a default format.
+        if (this->xioctl(fd, VIDIOC_G_FMT, &fmt) >= 0) {
+            probe.fileName = fileName;
+            probe.description = reinterpret_cast<const char *>(capability.card);
+
+            // The bus info identifies the device even if it comes back
+            // under another node after a replug.
+            probe.cacheKey = QString("%1:%2")
+                             .arg(reinterpret_cast<const char *>(capability.bus_info))
+                             .arg(probe.description);
+
+            if (capsCache.contains(probe.cacheKey)) {
+                probe.caps = capsCache[probe.cacheKey];
+            } else {
+                QList<v4l2_buf_type> bufType = {
+                    V4L2_BUF_TYPE_VIDEO_CAPTURE,
+                    V4L2_BUF_TYPE_VIDEO_OUTPUT,
+                    V4L2_BUF_TYPE_VIDEO_OVERLAY
+                };
+
+#ifndef VIDIOC_ENUM_FRAMESIZES
+                uint width = 0;
+                uint height = 0;
+                v4l2_format curFmt;
+                memset(&curFmt, 0, sizeof(v4l2_format));
+
+                if (this->xioctl(fd, VIDIOC_G_FMT, &curFmt) >= 0) {
+                    width = curFmt.fmt.pix.width;
+                    height = curFmt.fmt.pix.height;
+                }
+#endif
+
+                // Enumerate all supported formats.
+                for (const v4l2_buf_type &type: bufType) {
+                    v4l2_fmtdesc fmt;
+                    memset(&fmt, 0, sizeof(v4l2_fmtdesc));
+                    fmt.type = type;
+
+                    for (fmt.index = 0;
+                         this->xioctl(fd, VIDIOC_ENUM_FMT, &fmt) >= 0;
+                         fmt.index++) {
+#ifdef VIDIOC_ENUM_FRAMESIZES
+                        v4l2_frmsizeenum frmsize;
+                        memset(&frmsize, 0, sizeof(v4l2_frmsizeenum));
+                        frmsize.pixel_format = fmt.pixelformat;
+
+                        // Eenumerate frame sizes.
+                        for (frmsize.index = 0;
+                             this->xioctl(fd, VIDIOC_ENUM_FRAMESIZES, &frmsize) >= 0;
+                             frmsize.index++) {
+                            if (frmsize.type == V4L2_FRMSIZE_TYPE_DISCRETE) {
+                                probe.caps << this->capsFps(fd,
+                                                            fmt,
+                                                            frmsize.discrete.width,
+                                                            frmsize.discrete.height);
+                            } else {/*
+                                for (uint height = frmsize.stepwise.min_height;
+                                     height < frmsize.stepwise.max_height;
+                                     height += frmsize.stepwise.step_height)
+                                    for (uint width = frmsize.stepwise.min_width;
+                                         width < frmsize.stepwise.max_width;
+                                         width += frmsize.stepwise.step_width) {
+                                        probe.caps << this->capsFps(fd,
+                                                                    fmt,
+                                                                    width,
+                                                                    height);
+                                    }*/
+                            }
+                        }
+#else
+                        if (width > 0 && height > 0)
+                            probe.caps << this->capsFps(fd,
+                                                        fmt,
+                                                        width,
+                                                        height);
+#endif
+                    }
+                }
+            }
+
+            probe.imageControls = this->controls(fd, V4L2_CTRL_CLASS_USER);
+#ifdef V4L2_CTRL_CLASS_CAMERA
+            probe.cameraControls = this->controls(fd, V4L2_CTRL_CLASS_CAMERA);
+#endif
+        }
+    }
+
+    x_close(fd);
+
+    return probe;
+}
+
 void CaptureV4L2::updateDevices()
 {
     decltype(this->d->m_devices) devices;
@@ -1200,12 +1596,6 @@ void CaptureV4L2::updateDevices()
     decltype(this->d->m_imageControls) imageControls;
     decltype(this->d->m_cameraControls) cameraControls;
 
-    QList<v4l2_buf_type> bufType = {
-        V4L2_BUF_TYPE_VIDEO_CAPTURE,
-        V4L2_BUF_TYPE_VIDEO_OUTPUT,
-        V4L2_BUF_TYPE_VIDEO_OVERLAY
-    };
-
     QDir devicesDir("/dev");
 
     auto devicesFiles = devicesDir.entryList(QStringList() << "video*",
@@ -1217,100 +1607,34 @@ void CaptureV4L2::updateDevices()
                                              | QDir::CaseSensitive,
                                              QDir::Name);
 
-    v4l2_capability capability;
-    memset(&capability, 0, sizeof(v4l2_capability));
-
-    for (const QString &devicePath: devicesFiles) {
-        auto fileName = devicesDir.absoluteFilePath(devicePath);
-        int fd = x_open(fileName.toStdString().c_str(), O_RDWR | O_NONBLOCK, 0);
-
-        if (fd >= 0) {
-            // Check if this is a video capture device.
-            if (this->d->xioctl(fd, VIDIOC_QUERYCAP, &capability) >= 0
-                && capability.capabilities & V4L2_CAP_VIDEO_CAPTURE) {
-                v4l2_format fmt;
-                memset(&fmt, 0, sizeof(v4l2_format));
-                fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-
-                // Check if it has at least a default format.
-                if (this->d->xioctl(fd, VIDIOC_G_FMT, &fmt) >= 0) {
-                    devices << fileName;
-                    descriptions[fileName] = reinterpret_cast<const char *>(capability.card);
-                    QVariantList caps;
+    // Walking the format, frame size and frame interval tables takes long
+    // on cameras with big mode tables, so probe the devices in parallel
+    // and reuse the caps gathered in previous scans. A hotplug event then
+    // only pays for the devices that actually appeared.
+    auto capsCache = this->d->m_capsCache;
+    QList<QFuture<CaptureV4L2Private::DeviceProbe>> probes;
 
-#ifndef VIDIOC_ENUM_FRAMESIZES
-                    uint width = 0;
-                    uint height = 0;
-                    v4l2_format curFmt;
-                    memset(&curFmt, 0, sizeof(v4l2_format));
-
-                    if (this->xioctl(fd, VIDIOC_G_FMT, &curFmt) >= 0) {
-                        width = curFmt.fmt.pix.width;
-                        height = curFmt.fmt.pix.height;
-                    }
-#endif
-
-                    // Enumerate all supported formats.
-                    for (const v4l2_buf_type &type: bufType) {
-                        v4l2_fmtdesc fmt;
-                        memset(&fmt, 0, sizeof(v4l2_fmtdesc));
-                        fmt.type = type;
+    for (const QString &devicePath: devicesFiles)
+        probes << QtConcurrent::run(this->d,
+                                    &CaptureV4L2Private::probeDevice,
+                                    devicesDir.absoluteFilePath(devicePath),
+                                    capsCache);
 
-                        for (fmt.index = 0;
-                             this->d->xioctl(fd, VIDIOC_ENUM_FMT, &fmt) >= 0;
-                             fmt.index++) {
-#ifdef VIDIOC_ENUM_FRAMESIZES
-                            v4l2_frmsizeenum frmsize;
-                            memset(&frmsize, 0, sizeof(v4l2_frmsizeenum));
-                            frmsize.pixel_format = fmt.pixelformat;
-
-                            // Eenumerate frame sizes.
-                            for (frmsize.index = 0;
-                                 this->d->xioctl(fd, VIDIOC_ENUM_FRAMESIZES, &frmsize) >= 0;
-                                 frmsize.index++) {
-                                if (frmsize.type == V4L2_FRMSIZE_TYPE_DISCRETE) {
-                                    caps << this->d->capsFps(fd,
-                                                             fmt,
-                                                             frmsize.discrete.width,
-                                                             frmsize.discrete.height);
-                                } else {/*
-                                    for (uint height = frmsize.stepwise.min_height;
-                                         height < frmsize.stepwise.max_height;
-                                         height += frmsize.stepwise.step_height)
-                                        for (uint width = frmsize.stepwise.min_width;
-                                             width < frmsize.stepwise.max_width;
-                                             width += frmsize.stepwise.step_width) {
-                                            caps << this->capsFps(fd,
-                                                                  fmt,
-                                                                  width,
-                                                                  height);
-                                        }*/
-                                }
-                            }
-#else
-                            if (width > 0 && height > 0)
-                                caps << this->capsFps(fd,
-                                                      fmt,
-                                                      width,
-                                                      height);
-#endif
-                        }
-                    }
+    for (auto &future: probes) {
+        auto probe = future.result();
 
-                    devicesCaps[fileName] = caps;
-                    imageControls[fileName] =
-                            this->d->controls(fd, V4L2_CTRL_CLASS_USER);
-#ifdef V4L2_CTRL_CLASS_CAMERA
-                    cameraControls[fileName] =
-                            this->d->controls(fd, V4L2_CTRL_CLASS_CAMERA);
-#endif
-                }
-            }
+        if (probe.fileName.isEmpty())
+            continue;
 
-            x_close(fd);
-        }
+        devices << probe.fileName;
+        descriptions[probe.fileName] = probe.description;
+        devicesCaps[probe.fileName] = probe.caps;
+        imageControls[probe.fileName] = probe.imageControls;
+        cameraControls[probe.fileName] = probe.cameraControls;
+        capsCache[probe.cacheKey] = probe.caps;
     }
 
+    this->d->m_capsCache = capsCache;
     this->d->m_descriptions = descriptions;
     this->d->m_devicesCaps = devicesCaps;
     this->d->m_imageControls = imageControls;
@@ -46,6 +46,7 @@ class CaptureV4L2: public Capture
         Q_INVOKABLE QList<int> listTracks(const QString &mimeType);
         Q_INVOKABLE QString ioMethod() const;
         Q_INVOKABLE int nBuffers() const;
+        Q_INVOKABLE QRect cropRegion() const;
         Q_INVOKABLE QString description(const QString &webcam) const;
         Q_INVOKABLE QVariantList caps(const QString &webcam) const;
         Q_INVOKABLE QString capsDescription(const AkCaps &caps) const;
@@ -67,6 +68,7 @@ class CaptureV4L2: public Capture
         void setStreams(const QList<int> &streams);
         void setIoMethod(const QString &ioMethod);
         void setNBuffers(int nBuffers);
+        void setCropRegion(const QRect &cropRegion);
         void resetDevice();
         void resetStreams();
         void resetIoMethod();
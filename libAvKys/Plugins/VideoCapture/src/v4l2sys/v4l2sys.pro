@@ -44,7 +44,7 @@ OTHER_FILES += pspec.json
 
 CONFIG(config_v4l2_extendedcontrols): DEFINES += HAVE_EXTENDEDCONTROLS
 
-QT += qml
+QT += qml concurrent
 
 SOURCES = \
     src/plugin.cpp \
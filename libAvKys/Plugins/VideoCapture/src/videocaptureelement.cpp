@@ -25,10 +25,13 @@
 #include <QThreadPool>
 #include <QFuture>
 #include <QMutex>
+#include <QWaitCondition>
 #include <akutils.h>
 #include <akcaps.h>
 #include <akfrac.h>
 #include <akpacket.h>
+#include <akthreadpriority.h>
+#include <akvideopacket.h>
 
 #include "videocaptureelement.h"
 #include "videocaptureglobals.h"
@@ -61,6 +64,26 @@ Q_GLOBAL_STATIC_WITH_ARGS(QStringList, swapRgbFormats, (initSwapRgbFormats()))
 
 Q_GLOBAL_STATIC(VideoCaptureGlobals, globalVideoCapture)
 
+typedef QMap<QString, AkVideoCaps::PixelFormat> RawFmtToAkFmtMap;
+
+inline RawFmtToAkFmtMap initRawFmtToAkFmt()
+{
+    RawFmtToAkFmtMap rawFmtToAkFmt = {
+        {"YUY2", AkVideoCaps::Format_yuyv422},
+        {"YUYV", AkVideoCaps::Format_yuyv422},
+        {"UYVY", AkVideoCaps::Format_uyvy422},
+        {"NV12", AkVideoCaps::Format_nv12  },
+        {"NV21", AkVideoCaps::Format_nv21  },
+        {"YU12", AkVideoCaps::Format_yuv420p},
+        {"I420", AkVideoCaps::Format_yuv420p},
+        {"GREY", AkVideoCaps::Format_gray  },
+    };
+
+    return rawFmtToAkFmt;
+}
+
+Q_GLOBAL_STATIC_WITH_ARGS(RawFmtToAkFmtMap, rawFmtToAkFmt, (initRawFmtToAkFmt()))
+
 template<typename T>
 inline QSharedPointer<T> ptr_cast(QObject *obj=nullptr)
 {
@@ -81,31 +104,59 @@ inline void waitLoop(const QFuture<T> &loop)
 class VideoCaptureElementPrivate
 {
     public:
+        VideoCaptureElement *self;
         ConvertVideoPtr m_convertVideo;
         CapturePtr m_capture;
         QThreadPool m_threadPool;
         QFuture<void> m_cameraLoopResult;
+        QFuture<void> m_deliveryLoopResult;
         QMutex m_mutexLib;
+        QVariantList m_outputPixelFormats;
+
+        /* Triple buffered hand-off between the capture loop and the
+         * delivery thread: one slot is being written, one holds the
+         * newest complete frame and one may be in flight downstream, so
+         * the capture loop never blocks on a slow consumer and the
+         * driver queue doesn't back up. */
+        AkPacket m_slots[3];
+        int m_readySlot;
+        int m_deliverSlot;
+        QMutex m_slotMutex;
+        QWaitCondition m_frameAvailable;
+        quint64 m_droppedFrames;
         bool m_runCameraLoop;
+        bool m_runDeliveryLoop;
         bool m_pause;
         bool m_mirror;
         bool m_swapRgb;
 
-        VideoCaptureElementPrivate():
+        VideoCaptureElementPrivate(VideoCaptureElement *self):
+            self(self),
+            m_readySlot(-1),
+            m_deliverSlot(-1),
+            m_droppedFrames(0),
             m_runCameraLoop(false),
+            m_runDeliveryLoop(false),
             m_pause(false),
             m_mirror(false),
             m_swapRgb(false)
         {
+            // The capture and the delivery loops run at the same time.
+            if (this->m_threadPool.maxThreadCount() < 2)
+                this->m_threadPool.setMaxThreadCount(2);
         }
 
         inline void cameraLoop();
+        inline void deliveryLoop();
+        inline void publishFrame(const AkPacket &packet);
+        inline void startDeliveryLoop();
+        inline void stopDeliveryLoop();
 };
 
 VideoCaptureElement::VideoCaptureElement():
     AkMultimediaSourceElement()
 {
-    this->d = new VideoCaptureElementPrivate;
+    this->d = new VideoCaptureElementPrivate(this);
 
     QObject::connect(globalVideoCapture,
                      SIGNAL(codecLibChanged(const QString &)),
@@ -244,6 +295,14 @@ int VideoCaptureElement::nBuffers() const
     return this->d->m_capture->nBuffers();
 }
 
+QRect VideoCaptureElement::cropRegion() const
+{
+    if (!this->d->m_capture)
+        return {};
+
+    return this->d->m_capture->cropRegion();
+}
+
 QString VideoCaptureElement::codecLib() const
 {
     return globalVideoCapture->codecLib();
@@ -254,6 +313,11 @@ QString VideoCaptureElement::captureLib() const
     return globalVideoCapture->captureLib();
 }
 
+QVariantList VideoCaptureElement::outputPixelFormats() const
+{
+    return this->d->m_outputPixelFormats;
+}
+
 QVariantList VideoCaptureElement::imageControls() const
 {
     if (!this->d->m_capture)
@@ -302,6 +366,15 @@ bool VideoCaptureElement::resetCameraControls()
     return this->d->m_capture->resetCameraControls();
 }
 
+quint64 VideoCaptureElement::droppedFrames() const
+{
+    this->d->m_slotMutex.lock();
+    quint64 droppedFrames = this->d->m_droppedFrames;
+    this->d->m_slotMutex.unlock();
+
+    return droppedFrames;
+}
+
 void VideoCaptureElementPrivate::cameraLoop()
 {
     if (!this->m_convertVideo || !this->m_capture)
@@ -312,7 +385,13 @@ void VideoCaptureElementPrivate::cameraLoop()
     CoInitializeEx(NULL, COINIT_MULTITHREADED);
 #endif
 
+    // A missed dequeue drops a frame the device already delivered, don't
+    // let the GUI threads preempt this loop.
+    AkThreadPriority::apply(AkThreadPriority::ThreadClassCapture);
+
     bool initConvert = true;
+    bool passthrough = false;
+    AkVideoCaps passthroughCaps;
 
     if (this->m_capture->init()) {
         while (this->m_runCameraLoop) {
@@ -330,22 +409,47 @@ void VideoCaptureElementPrivate::cameraLoop()
             if (initConvert) {
                 AkCaps caps = packet.caps();
 
-#ifdef Q_OS_WIN32
                 QString fourcc = caps.property("fourcc").toString();
+#ifdef Q_OS_WIN32
                 this->m_mirror = mirrorFormats->contains(fourcc);
                 this->m_swapRgb = swapRgbFormats->contains(fourcc);
 #endif
 
-                if (!this->m_convertVideo->init(caps))
+                /* If the camera already delivers one of the formats the
+                 * pipeline owner negotiated downstream, skip the codec
+                 * submodule and retag the raw frames instead of decoding
+                 * them. */
+                auto format = rawFmtToAkFmt->value(fourcc,
+                                                   AkVideoCaps::Format_none);
+                passthrough = format != AkVideoCaps::Format_none
+                              && this->m_outputPixelFormats.contains(int(format));
+
+                if (passthrough) {
+                    passthroughCaps.isValid() = true;
+                    passthroughCaps.format() = format;
+                    passthroughCaps.bpp() = AkVideoCaps::bitsPerPixel(format);
+                    passthroughCaps.width() = caps.property("width").toInt();
+                    passthroughCaps.height() = caps.property("height").toInt();
+                    passthroughCaps.fps() = caps.property("fps").toString();
+                } else if (!this->m_convertVideo->init(caps)) {
                     break;
+                }
 
                 initConvert = false;
             }
 
-            this->m_convertVideo->packetEnqueue(packet);
+            if (passthrough) {
+                AkVideoPacket videoPacket(packet);
+                videoPacket.caps() = passthroughCaps;
+                this->publishFrame(videoPacket.toPacket());
+            } else {
+                this->m_convertVideo->packetEnqueue(packet);
+            }
         }
 
-        this->m_convertVideo->uninit();
+        if (!passthrough)
+            this->m_convertVideo->uninit();
+
         this->m_capture->uninit();
     }
 
@@ -355,6 +459,89 @@ void VideoCaptureElementPrivate::cameraLoop()
 #endif
 }
 
+void VideoCaptureElementPrivate::deliveryLoop()
+{
+    this->m_slotMutex.lock();
+
+    while (this->m_runDeliveryLoop) {
+        if (this->m_readySlot < 0) {
+            this->m_frameAvailable.wait(&this->m_slotMutex);
+
+            continue;
+        }
+
+        /* Claim the newest frame, so the capture loop keeps rotating
+         * the other two slots while the emission blocks downstream. */
+        this->m_deliverSlot = this->m_readySlot;
+        this->m_readySlot = -1;
+        this->m_slotMutex.unlock();
+
+        emit this->self->oStream(this->m_slots[this->m_deliverSlot]);
+
+        this->m_slotMutex.lock();
+        this->m_slots[this->m_deliverSlot] = AkPacket();
+        this->m_deliverSlot = -1;
+    }
+
+    this->m_slotMutex.unlock();
+}
+
+void VideoCaptureElementPrivate::publishFrame(const AkPacket &packet)
+{
+    quint64 dropped = 0;
+
+    this->m_slotMutex.lock();
+
+    // Use the slot that is neither published nor being delivered.
+    int slot = 0;
+
+    while (slot == this->m_readySlot || slot == this->m_deliverSlot)
+        slot++;
+
+    this->m_slots[slot] = packet;
+
+    // Newest wins: an unclaimed frame is overwritten, not queued.
+    if (this->m_readySlot >= 0)
+        dropped = ++this->m_droppedFrames;
+
+    this->m_readySlot = slot;
+    this->m_frameAvailable.wakeAll();
+    this->m_slotMutex.unlock();
+
+    if (dropped > 0)
+        emit this->self->droppedFramesChanged(dropped);
+}
+
+void VideoCaptureElementPrivate::startDeliveryLoop()
+{
+    if (this->m_droppedFrames > 0) {
+        this->m_droppedFrames = 0;
+        emit this->self->droppedFramesChanged(0);
+    }
+
+    this->m_runDeliveryLoop = true;
+    this->m_deliveryLoopResult =
+            QtConcurrent::run(&this->m_threadPool,
+                              this,
+                              &VideoCaptureElementPrivate::deliveryLoop);
+}
+
+void VideoCaptureElementPrivate::stopDeliveryLoop()
+{
+    this->m_slotMutex.lock();
+    this->m_runDeliveryLoop = false;
+    this->m_frameAvailable.wakeAll();
+    this->m_slotMutex.unlock();
+
+    waitLoop(this->m_deliveryLoopResult);
+
+    for (AkPacket &slot: this->m_slots)
+        slot = AkPacket();
+
+    this->m_readySlot = -1;
+    this->m_deliverSlot = -1;
+}
+
 QString VideoCaptureElement::controlInterfaceProvide(const QString &controlId) const
 {
     Q_UNUSED(controlId)
@@ -403,6 +590,12 @@ void VideoCaptureElement::setNBuffers(int nBuffers)
         this->d->m_capture->setNBuffers(nBuffers);
 }
 
+void VideoCaptureElement::setCropRegion(const QRect &cropRegion)
+{
+    if (this->d->m_capture)
+        this->d->m_capture->setCropRegion(cropRegion);
+}
+
 void VideoCaptureElement::setCodecLib(const QString &codecLib)
 {
     globalVideoCapture->setCodecLib(codecLib);
@@ -413,6 +606,22 @@ void VideoCaptureElement::setCaptureLib(const QString &captureLib)
     globalVideoCapture->setCaptureLib(captureLib);
 }
 
+void VideoCaptureElement::setOutputPixelFormats(const QVariantList &outputPixelFormats)
+{
+    if (this->d->m_outputPixelFormats == outputPixelFormats)
+        return;
+
+    // The passthrough decision is latched when the first frame arrives,
+    // so an already running stream must be restarted to pick it up.
+    auto state = this->state();
+    this->setState(AkElement::ElementStateNull);
+
+    this->d->m_outputPixelFormats = outputPixelFormats;
+    emit this->outputPixelFormatsChanged(outputPixelFormats);
+
+    this->setState(state);
+}
+
 void VideoCaptureElement::resetMedia()
 {
     if (this->d->m_capture)
@@ -437,6 +646,12 @@ void VideoCaptureElement::resetNBuffers()
         this->d->m_capture->resetNBuffers();
 }
 
+void VideoCaptureElement::resetCropRegion()
+{
+    if (this->d->m_capture)
+        this->d->m_capture->resetCropRegion();
+}
+
 void VideoCaptureElement::resetCodecLib()
 {
     globalVideoCapture->resetCodecLib();
@@ -447,6 +662,11 @@ void VideoCaptureElement::resetCaptureLib()
     globalVideoCapture->resetCaptureLib();
 }
 
+void VideoCaptureElement::resetOutputPixelFormats()
+{
+    this->setOutputPixelFormats({});
+}
+
 void VideoCaptureElement::reset()
 {
     if (this->d->m_capture)
@@ -466,6 +686,7 @@ bool VideoCaptureElement::setState(AkElement::ElementState state)
         case AkElement::ElementStatePaused: {
             this->d->m_pause = true;
             this->d->m_runCameraLoop = true;
+            this->d->startDeliveryLoop();
             this->d->m_cameraLoopResult =
                     QtConcurrent::run(&this->d->m_threadPool,
                                       this->d,
@@ -476,6 +697,7 @@ bool VideoCaptureElement::setState(AkElement::ElementState state)
         case AkElement::ElementStatePlaying: {
             this->d->m_pause = false;
             this->d->m_runCameraLoop = true;
+            this->d->startDeliveryLoop();
             this->d->m_cameraLoopResult =
                     QtConcurrent::run(&this->d->m_threadPool,
                                       this->d,
@@ -495,6 +717,7 @@ bool VideoCaptureElement::setState(AkElement::ElementState state)
             this->d->m_pause = false;
             this->d->m_runCameraLoop = false;
             waitLoop(this->d->m_cameraLoopResult);
+            this->d->stopDeliveryLoop();
 
             return AkElement::setState(state);
         case AkElement::ElementStatePlaying:
@@ -512,6 +735,7 @@ bool VideoCaptureElement::setState(AkElement::ElementState state)
         case AkElement::ElementStateNull: {
             this->d->m_runCameraLoop = false;
             waitLoop(this->d->m_cameraLoopResult);
+            this->d->stopDeliveryLoop();
 
             return AkElement::setState(state);
         }
@@ -542,10 +766,10 @@ void VideoCaptureElement::frameReady(const AkPacket &packet)
         if (this->d->m_swapRgb)
             oImage = oImage.rgbSwapped();
 
-        emit this->oStream(AkUtils::imageToPacket(oImage, packet));
+        this->d->publishFrame(AkUtils::imageToPacket(oImage, packet));
     } else
 #endif
-        emit this->oStream(packet);
+        this->d->publishFrame(packet);
 }
 
 void VideoCaptureElement::codecLibUpdated(const QString &codecLib)
@@ -609,6 +833,10 @@ void VideoCaptureElement::captureLibUpdated(const QString &captureLib)
                      &Capture::streamsChanged,
                      this,
                      &VideoCaptureElement::streamsChanged);
+    QObject::connect(this->d->m_capture.data(),
+                     &Capture::cropRegionChanged,
+                     this,
+                     &VideoCaptureElement::cropRegionChanged);
 
     emit this->mediasChanged(this->medias());
     emit this->streamsChanged(this->streams());
@@ -20,6 +20,7 @@
 #ifndef VIDEOCAPTUREELEMENT_H
 #define VIDEOCAPTUREELEMENT_H
 
+#include <QRect>
 #include <akmultimediasourceelement.h>
 
 class VideoCaptureElementPrivate;
@@ -53,6 +54,14 @@ class VideoCaptureElement: public AkMultimediaSourceElement
                READ nBuffers
                WRITE setNBuffers
                RESET resetNBuffers)
+    /* Region of interest in native frame coordinates, a null rectangle
+     * captures the full frame. Pushed into the driver where the capture
+     * backend supports it, cropped before delivery otherwise. */
+    Q_PROPERTY(QRect cropRegion
+               READ cropRegion
+               WRITE setCropRegion
+               RESET resetCropRegion
+               NOTIFY cropRegionChanged)
     Q_PROPERTY(QString codecLib
                READ codecLib
                WRITE setCodecLib
@@ -63,6 +72,14 @@ class VideoCaptureElement: public AkMultimediaSourceElement
                WRITE setCaptureLib
                RESET resetCaptureLib
                NOTIFY captureLibChanged)
+    Q_PROPERTY(QVariantList outputPixelFormats
+               READ outputPixelFormats
+               WRITE setOutputPixelFormats
+               RESET resetOutputPixelFormats
+               NOTIFY outputPixelFormatsChanged)
+    Q_PROPERTY(quint64 droppedFrames
+               READ droppedFrames
+               NOTIFY droppedFramesChanged)
 
     public:
         explicit VideoCaptureElement();
@@ -80,8 +97,17 @@ class VideoCaptureElement: public AkMultimediaSourceElement
         Q_INVOKABLE QStringList listCapsDescription() const;
         Q_INVOKABLE QString ioMethod() const;
         Q_INVOKABLE int nBuffers() const;
+        Q_INVOKABLE QRect cropRegion() const;
         Q_INVOKABLE QString codecLib() const;
         Q_INVOKABLE QString captureLib() const;
+
+        /* AkVideoCaps::PixelFormat values, as ints, that the element can
+         * deliver without decoding. When the captured stream matches one
+         * of them the raw frames go straight to oStream() and the codec
+         * submodule stays idle; otherwise frames are decoded to RGB as
+         * usual. Empty by default, so nothing changes unless the owner of
+         * the pipeline negotiated the formats downstream. */
+        Q_INVOKABLE QVariantList outputPixelFormats() const;
         Q_INVOKABLE QVariantList imageControls() const;
         Q_INVOKABLE bool setImageControls(const QVariantMap &imageControls);
         Q_INVOKABLE bool resetImageControls();
@@ -89,6 +115,11 @@ class VideoCaptureElement: public AkMultimediaSourceElement
         Q_INVOKABLE bool setCameraControls(const QVariantMap &cameraControls);
         Q_INVOKABLE bool resetCameraControls();
 
+        /* Frames overwritten in the delivery slots before the delivery
+         * thread could forward them. Grows when the pipeline downstream
+         * is slower than the camera; resets when the stream starts. */
+        Q_INVOKABLE quint64 droppedFrames() const;
+
     private:
         VideoCaptureElementPrivate *d;
 
@@ -107,20 +138,27 @@ class VideoCaptureElement: public AkMultimediaSourceElement
         void captureLibChanged(const QString &captureLib);
         void imageControlsChanged(const QVariantMap &imageControls) const;
         void cameraControlsChanged(const QVariantMap &cameraControls) const;
+        void cropRegionChanged(const QRect &cropRegion);
+        void outputPixelFormatsChanged(const QVariantList &outputPixelFormats);
+        void droppedFramesChanged(quint64 droppedFrames);
 
     public slots:
         void setMedia(const QString &media);
         void setStreams(const QList<int> &streams);
         void setIoMethod(const QString &ioMethod);
         void setNBuffers(int nBuffers);
+        void setCropRegion(const QRect &cropRegion);
         void setCodecLib(const QString &codecLib);
         void setCaptureLib(const QString &captureLib);
+        void setOutputPixelFormats(const QVariantList &outputPixelFormats);
         void resetMedia();
         void resetStreams();
         void resetIoMethod();
         void resetNBuffers();
+        void resetCropRegion();
         void resetCodecLib();
         void resetCaptureLib();
+        void resetOutputPixelFormats();
         void reset();
         bool setState(AkElement::ElementState state);
         void frameReady(const AkPacket &packet);
@@ -24,9 +24,13 @@
 VideoCaptureGlobals::VideoCaptureGlobals(QObject *parent):
     QObject(parent)
 {
+    // FFmpeg and GStreamer stay first because they decode every compressed
+    // format cameras can deliver, turbojpeg only covers MJPEG plus a few
+    // raw formats and is meant to be selected explicitly.
     this->m_preferredFramework = QStringList {
         "ffmpeg",
         "gstreamer",
+        "turbojpeg",
     };
 
     this->m_preferredLibrary = QStringList {
@@ -17,12 +17,13 @@
  * Web-Site: http://webcamoid.github.io/
  */
 
-#include <QPainter>
 #include <QQmlContext>
 #include <QtMath>
 #include <QMutex>
+#include <QVector>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akvideofilterrunner.h>
 
 #include "vignetteelement.h"
 
@@ -34,14 +35,20 @@ class VignetteElementPrivate
         qreal m_scale;
         qreal m_softness;
         QSize m_curSize;
-        QImage m_vignette;
+
+        /* The vignette only needs one byte per pixel: its color is
+         * constant, so the mask stores the per-pixel opacity and the
+         * blend is a multiply against the frame. */
+        QVector<quint8> m_vignetteMask;
+        QRgb m_maskColor;
         QMutex m_mutex;
 
         VignetteElementPrivate():
             m_color(qRgb(0, 0, 0)),
             m_aspect(3.0 / 7.0),
             m_scale(0.5),
-            m_softness(0.5)
+            m_softness(0.5),
+            m_maskColor(qRgb(0, 0, 0))
         {
         }
 
@@ -189,13 +196,43 @@ AkPacket VignetteElement::iStream(const AkPacket &packet)
     }
 
     this->d->m_mutex.lock();
-    QImage vignette = this->d->m_vignette;
+    QVector<quint8> mask = this->d->m_vignetteMask;
+    QRgb color = this->d->m_maskColor;
     this->d->m_mutex.unlock();
 
-    QPainter painter;
-    painter.begin(&oFrame);
-    painter.drawImage(0, 0, vignette);
-    painter.end();
+    int width = src.width();
+    int height = src.height();
+
+    // The rebuild runs queued on the main thread, so right after a
+    // geometry change the mask can lag one frame behind.
+    if (mask.size() != width * height)
+        akSend(packet)
+
+    const quint8 *maskBits = mask.constData();
+    int red = qRed(color);
+    int green = qGreen(color);
+    int blue = qBlue(color);
+
+    AkVideoFilterRunner::globalRunner()->run(height,
+                                             [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            auto line = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+            const quint8 *maskLine = maskBits + y * width;
+
+            for (int x = 0; x < width; x++) {
+                int a = maskLine[x];
+
+                if (a == 0)
+                    continue;
+
+                QRgb pixel = line[x];
+                line[x] = qRgba((red * a + qRed(pixel) * (255 - a)) / 255,
+                                (green * a + qGreen(pixel) * (255 - a)) / 255,
+                                (blue * a + qBlue(pixel) * (255 - a)) / 255,
+                                a + qAlpha(pixel) * (255 - a) / 255);
+            }
+        }
+    });
 
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
@@ -206,11 +243,12 @@ void VignetteElement::updateVignette()
     this->d->m_mutex.lock();
 
     QSize curSize = this->d->m_curSize;
-    QImage vignette(curSize, QImage::Format_ARGB32);
+    int width = curSize.width();
+    int height = curSize.height();
 
     // Center of the ellipse.
-    int xc = vignette.width() / 2;
-    int yc = vignette.height() / 2;
+    int xc = width / 2;
+    int yc = height / 2;
 
     qreal aspect = qBound(0.0, this->d->m_aspect, 1.0);
     qreal rho = qBound(0.01, this->d->m_aspect, 0.99);
@@ -237,10 +275,8 @@ void VignetteElement::updateVignette()
 
     qreal softness = 255.0 * (2.0 * this->d->m_softness - 1.0);
 
-    int red = qRed(this->d->m_color);
-    int green = qGreen(this->d->m_color);
-    int blue = qBlue(this->d->m_color);
-    int alpha = qAlpha(this->d->m_color);
+    QRgb maskColor = this->d->m_color;
+    int alpha = qAlpha(maskColor);
 
     // Get the radius to a corner.
     qreal dwa = xc / a;
@@ -249,13 +285,15 @@ void VignetteElement::updateVignette()
 
     this->d->m_mutex.unlock();
 
-    for (int y = 0; y < vignette.height(); y++) {
-        QRgb *line = reinterpret_cast<QRgb *>(vignette.scanLine(y));
+    QVector<quint8> mask(width * height);
+
+    for (int y = 0; y < height; y++) {
+        quint8 *line = mask.data() + y * width;
         int dy = y - yc;
         qreal qdy = dy * dy;
         qreal dyb = dy / b;
 
-        for (int x = 0; x < vignette.width(); x++) {
+        for (int x = 0; x < width; x++) {
             int dx = x - xc;
             qreal qdx = dx * dx;
             qreal dxa = qreal(dx) / a;
@@ -264,20 +302,20 @@ void VignetteElement::updateVignette()
                 && !qIsNull(a) && !qIsNull(b))
                 // If the point is inside the ellipse,
                 // show the original pixel.
-                line[x] = qRgba(0, 0, 0, 0);
+                line[x] = 0;
             else {
                 // The opacity of the pixel depends on the relation between
                 // it's radius and the corner radius.
                 qreal k = this->d->radius(dxa, dyb) / maxRadius;
                 int opacity = int(k * alpha - softness);
-                opacity = qBound(0, opacity, 255);
-                line[x] = qRgba(red, green, blue, opacity);
+                line[x] = quint8(qBound(0, opacity, 255));
             }
         }
     }
 
     this->d->m_mutex.lock();
-    this->d->m_vignette = vignette;
+    this->d->m_vignetteMask = mask;
+    this->d->m_maskColor = maskColor;
     this->d->m_mutex.unlock();
 }
 
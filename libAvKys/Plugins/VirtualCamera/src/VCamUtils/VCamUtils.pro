@@ -46,6 +46,7 @@ SOURCES += \
     src/resources/rcname.cpp \
     src/resources/rcnode.cpp \
     src/image/videoframe.cpp \
+    src/ipc/sharedframering.cpp \
     src/utils.cpp
 
 HEADERS += \
@@ -60,7 +61,8 @@ HEADERS += \
     src/resources/rcnode.h \
     src/image/videoframe.h \
     src/image/videoformattypes.h \
-    src/image/videoframetypes.h
+    src/image/videoframetypes.h \
+    src/ipc/sharedframering.h
 
 isEmpty(STATIC_BUILD) | isEqual(STATIC_BUILD, 0) {
     win32-g++: QMAKE_LFLAGS = -static -static-libgcc -static-libstdc++
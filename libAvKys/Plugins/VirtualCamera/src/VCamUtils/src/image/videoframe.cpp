@@ -19,6 +19,13 @@
 
 #include <cstring>
 #include <algorithm>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
 
 #include "videoframe.h"
 #include "videoformat.h"
@@ -166,6 +173,31 @@ namespace AkVCam
             inline static uint8_t yuv_g(int y, int u, int v);
             inline static uint8_t yuv_b(int y, int u, int v);
 
+            /* Splits [yStart, yEnd) row bands over the available
+             * hardware threads and waits for all of them. Small frames
+             * run serially in the calling thread. */
+            inline static void parallelizeRows(int height,
+                                               const std::function<void (int, int)> &fn);
+
+            /* The RGB24 layout interleaves the components with a 3 byte
+             * period, which no SSE2 shuffle can pick apart, so each row
+             * is first split into planar 16 bits components and the
+             * colorspace math runs vectorized over those. */
+            inline static void splitRgbRow(const RGB24 *line, int width,
+                                           uint16_t *r, uint16_t *g, uint16_t *b);
+            inline static void rowY(const uint16_t *r,
+                                    const uint16_t *g,
+                                    const uint16_t *b,
+                                    uint8_t *y, int width);
+            inline static void rowU(const uint16_t *r,
+                                    const uint16_t *g,
+                                    const uint16_t *b,
+                                    uint8_t *u, int width);
+            inline static void rowV(const uint16_t *r,
+                                    const uint16_t *g,
+                                    const uint16_t *b,
+                                    uint8_t *v, int width);
+
             // RGB formats
             inline static size_t rgb24_to_rgb32(void *dst, const void *src, int width, int height);
             inline static size_t rgb24_to_rgb16(void *dst, const void *src, int width, int height);
@@ -490,16 +522,19 @@ AkVCam::VideoFrame AkVCam::VideoFrame::scaled(int width,
 
     switch (mode) {
         case ScalingFast:
-            for (int y = yDstMin; y < yDstMax; y++) {
-                auto srcY = (yNum * (y - yDstMin) + ys) / yDen;
-                auto srcLine = dataSrc + srcY * this->d->m_format.width();
-                auto dstLine = dataDst + y * width;
-
-                for (int x = xDstMin; x < xDstMax; x++) {
-                    auto srcX = (xNum * (x - xDstMin) + xs) / xDen;
-                    dstLine[x] = srcLine[srcX];
+            VideoFramePrivate::parallelizeRows(yDstMax - yDstMin,
+                                               [&] (int yStart, int yEnd) {
+                for (int y = yDstMin + yStart; y < yDstMin + yEnd; y++) {
+                    auto srcY = (yNum * (y - yDstMin) + ys) / yDen;
+                    auto srcLine = dataSrc + srcY * this->d->m_format.width();
+                    auto dstLine = dataDst + y * width;
+
+                    for (int x = xDstMin; x < xDstMax; x++) {
+                        auto srcX = (xNum * (x - xDstMin) + xs) / xDen;
+                        dstLine[x] = srcLine[srcX];
+                    }
                 }
-            }
+            });
 
             return VideoFrame(format, data, dataSize);
 
@@ -513,34 +548,37 @@ AkVCam::VideoFrame AkVCam::VideoFrame::scaled(int width,
                         &VideoFramePrivate::extrapolateUp:
                         &VideoFramePrivate::extrapolateDown;
 
-            for (int y = yDstMin; y < yDstMax; y++) {
-                auto dstLine = dataDst + y * width;
-                int yMin;
-                int yMax;
-                int kNumY;
-                int kDenY;
-                extrapolateY(y - yDstMin,
-                             yNum, yDen, ys,
-                             &yMin, &yMax,
-                             &kNumY, &kDenY);
-
-                for (int x = xDstMin; x < xDstMax; x++) {
-                    int xMin;
-                    int xMax;
-                    int kNumX;
-                    int kDenX;
-                    extrapolateX(x - xDstMin,
-                                 xNum, xDen, xs,
-                                 &xMin, &xMax,
-                                 &kNumX, &kDenX);
-
-                    dstLine[x] =
-                            this->d->extrapolateColor(xMin, xMax,
-                                                      kNumX, kDenX,
-                                                      yMin, yMax,
-                                                      kNumY, kDenY);
+            VideoFramePrivate::parallelizeRows(yDstMax - yDstMin,
+                                               [&] (int yStart, int yEnd) {
+                for (int y = yDstMin + yStart; y < yDstMin + yEnd; y++) {
+                    auto dstLine = dataDst + y * width;
+                    int yMin;
+                    int yMax;
+                    int kNumY;
+                    int kDenY;
+                    extrapolateY(y - yDstMin,
+                                 yNum, yDen, ys,
+                                 &yMin, &yMax,
+                                 &kNumY, &kDenY);
+
+                    for (int x = xDstMin; x < xDstMax; x++) {
+                        int xMin;
+                        int xMax;
+                        int kNumX;
+                        int kDenX;
+                        extrapolateX(x - xDstMin,
+                                     xNum, xDen, xs,
+                                     &xMin, &xMax,
+                                     &kNumX, &kDenX);
+
+                        dstLine[x] =
+                                this->d->extrapolateColor(xMin, xMax,
+                                                          kNumX, kDenX,
+                                                          yMin, yMax,
+                                                          kNumY, kDenY);
+                    }
                 }
-            }
+            });
 
             return VideoFrame(format, data, dataSize);
         }
@@ -634,6 +672,141 @@ uint8_t AkVCam::VideoFramePrivate::yuv_b(int y, int u, int v)
     return uint8_t(bound(0, b, 255));
 }
 
+void AkVCam::VideoFramePrivate::parallelizeRows(int height,
+                                                const std::function<void (int, int)> &fn)
+{
+    int threads = int(std::thread::hardware_concurrency());
+
+    if (threads > height)
+        threads = height;
+
+    // The spawn cost dwarfs the work on small frames.
+    if (threads < 2 || height < 16 * threads) {
+        fn(0, height);
+
+        return;
+    }
+
+    std::vector<std::thread> pool;
+
+    for (int i = 0; i < threads; i++)
+        pool.emplace_back(fn,
+                          i * height / threads,
+                          (i + 1) * height / threads);
+
+    for (auto &thread: pool)
+        thread.join();
+}
+
+void AkVCam::VideoFramePrivate::splitRgbRow(const RGB24 *line, int width,
+                                            uint16_t *r, uint16_t *g, uint16_t *b)
+{
+    for (int x = 0; x < width; x++) {
+        r[x] = line[x].r;
+        g[x] = line[x].g;
+        b[x] = line[x].b;
+    }
+}
+
+void AkVCam::VideoFramePrivate::rowY(const uint16_t *r,
+                                     const uint16_t *g,
+                                     const uint16_t *b,
+                                     uint8_t *y, int width)
+{
+    int x = 0;
+
+#if defined(__SSE2__)
+    /* The weighted sum stays below 2^16, so the low halves of the
+     * products are enough and the shift can be logical. */
+    auto kr = _mm_set1_epi16(66);
+    auto kg = _mm_set1_epi16(129);
+    auto kb = _mm_set1_epi16(25);
+    auto round = _mm_set1_epi16(128);
+    auto offset = _mm_set1_epi16(16);
+
+    for (; x + 8 <= width; x += 8) {
+        auto vr = _mm_loadu_si128(reinterpret_cast<const __m128i *>(r + x));
+        auto vg = _mm_loadu_si128(reinterpret_cast<const __m128i *>(g + x));
+        auto vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + x));
+        auto vy = _mm_add_epi16(_mm_mullo_epi16(vr, kr),
+                                _mm_mullo_epi16(vg, kg));
+        vy = _mm_add_epi16(vy, _mm_mullo_epi16(vb, kb));
+        vy = _mm_srli_epi16(_mm_add_epi16(vy, round), 8);
+        vy = _mm_add_epi16(vy, offset);
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(y + x),
+                         _mm_packus_epi16(vy, vy));
+    }
+#endif
+
+    for (; x < width; x++)
+        y[x] = rgb_y(r[x], g[x], b[x]);
+}
+
+void AkVCam::VideoFramePrivate::rowU(const uint16_t *r,
+                                     const uint16_t *g,
+                                     const uint16_t *b,
+                                     uint8_t *u, int width)
+{
+    int x = 0;
+
+#if defined(__SSE2__)
+    // The sum fits a signed 16 bits lane, shift arithmetically.
+    auto kr = _mm_set1_epi16(-38);
+    auto kg = _mm_set1_epi16(-74);
+    auto kb = _mm_set1_epi16(112);
+    auto round = _mm_set1_epi16(128);
+    auto offset = _mm_set1_epi16(128);
+
+    for (; x + 8 <= width; x += 8) {
+        auto vr = _mm_loadu_si128(reinterpret_cast<const __m128i *>(r + x));
+        auto vg = _mm_loadu_si128(reinterpret_cast<const __m128i *>(g + x));
+        auto vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + x));
+        auto vu = _mm_add_epi16(_mm_mullo_epi16(vr, kr),
+                                _mm_mullo_epi16(vg, kg));
+        vu = _mm_add_epi16(vu, _mm_mullo_epi16(vb, kb));
+        vu = _mm_srai_epi16(_mm_add_epi16(vu, round), 8);
+        vu = _mm_add_epi16(vu, offset);
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(u + x),
+                         _mm_packus_epi16(vu, vu));
+    }
+#endif
+
+    for (; x < width; x++)
+        u[x] = rgb_u(r[x], g[x], b[x]);
+}
+
+void AkVCam::VideoFramePrivate::rowV(const uint16_t *r,
+                                     const uint16_t *g,
+                                     const uint16_t *b,
+                                     uint8_t *v, int width)
+{
+    int x = 0;
+
+#if defined(__SSE2__)
+    auto kr = _mm_set1_epi16(112);
+    auto kg = _mm_set1_epi16(-94);
+    auto kb = _mm_set1_epi16(-18);
+    auto round = _mm_set1_epi16(128);
+    auto offset = _mm_set1_epi16(128);
+
+    for (; x + 8 <= width; x += 8) {
+        auto vr = _mm_loadu_si128(reinterpret_cast<const __m128i *>(r + x));
+        auto vg = _mm_loadu_si128(reinterpret_cast<const __m128i *>(g + x));
+        auto vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + x));
+        auto vv = _mm_add_epi16(_mm_mullo_epi16(vr, kr),
+                                _mm_mullo_epi16(vg, kg));
+        vv = _mm_add_epi16(vv, _mm_mullo_epi16(vb, kb));
+        vv = _mm_srai_epi16(_mm_add_epi16(vv, round), 8);
+        vv = _mm_add_epi16(vv, offset);
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(v + x),
+                         _mm_packus_epi16(vv, vv));
+    }
+#endif
+
+    for (; x < width; x++)
+        v[x] = rgb_v(r[x], g[x], b[x]);
+}
+
 size_t AkVCam::VideoFramePrivate::rgb24_to_rgb32(void *dst, const void *src,
                                                  int width, int height)
 {
@@ -646,12 +819,16 @@ size_t AkVCam::VideoFramePrivate::rgb24_to_rgb32(void *dst, const void *src,
     auto _src = reinterpret_cast<const RGB24 *>(src);
     auto _dst = reinterpret_cast<RGB32 *>(dst);
 
-    for (size_t i = 0; i < len; i++) {
-        _dst[i].x = 255;
-        _dst[i].r = _src[i].r;
-        _dst[i].g = _src[i].g;
-        _dst[i].b = _src[i].b;
-    }
+    parallelizeRows(height, [=] (int yStart, int yEnd) {
+        size_t end = size_t(yEnd) * size_t(width);
+
+        for (size_t i = size_t(yStart) * size_t(width); i < end; i++) {
+            _dst[i].x = 255;
+            _dst[i].r = _src[i].r;
+            _dst[i].g = _src[i].g;
+            _dst[i].b = _src[i].b;
+        }
+    });
 
     return osize;
 }
@@ -668,11 +845,15 @@ size_t AkVCam::VideoFramePrivate::rgb24_to_rgb16(void *dst, const void *src,
     auto _src = reinterpret_cast<const RGB24 *>(src);
     auto _dst = reinterpret_cast<RGB16 *>(dst);
 
-    for (size_t i = 0; i < len; i++) {
-        _dst[i].r = _src[i].r >> 3;
-        _dst[i].g = _src[i].g >> 2;
-        _dst[i].b = _src[i].b >> 3;
-    }
+    parallelizeRows(height, [=] (int yStart, int yEnd) {
+        size_t end = size_t(yEnd) * size_t(width);
+
+        for (size_t i = size_t(yStart) * size_t(width); i < end; i++) {
+            _dst[i].r = _src[i].r >> 3;
+            _dst[i].g = _src[i].g >> 2;
+            _dst[i].b = _src[i].b >> 3;
+        }
+    });
 
     return osize;
 }
@@ -689,12 +870,16 @@ size_t AkVCam::VideoFramePrivate::rgb24_to_rgb15(void *dst, const void *src,
     auto _src = reinterpret_cast<const RGB24 *>(src);
     auto _dst = reinterpret_cast<RGB15 *>(dst);
 
-    for (size_t i = 0; i < len; i++) {
-        _dst[i].x = 1;
-        _dst[i].r = _src[i].r >> 3;
-        _dst[i].g = _src[i].g >> 3;
-        _dst[i].b = _src[i].b >> 3;
-    }
+    parallelizeRows(height, [=] (int yStart, int yEnd) {
+        size_t end = size_t(yEnd) * size_t(width);
+
+        for (size_t i = size_t(yStart) * size_t(width); i < end; i++) {
+            _dst[i].x = 1;
+            _dst[i].r = _src[i].r >> 3;
+            _dst[i].g = _src[i].g >> 3;
+            _dst[i].b = _src[i].b >> 3;
+        }
+    });
 
     return osize;
 }
@@ -711,12 +896,16 @@ size_t AkVCam::VideoFramePrivate::rgb24_to_bgr32(void *dst, const void *src,
     auto _src = reinterpret_cast<const RGB24 *>(src);
     auto _dst = reinterpret_cast<BGR32 *>(dst);
 
-    for (size_t i = 0; i < len; i++) {
-        _dst[i].x = 255;
-        _dst[i].r = _src[i].r;
-        _dst[i].g = _src[i].g;
-        _dst[i].b = _src[i].b;
-    }
+    parallelizeRows(height, [=] (int yStart, int yEnd) {
+        size_t end = size_t(yEnd) * size_t(width);
+
+        for (size_t i = size_t(yStart) * size_t(width); i < end; i++) {
+            _dst[i].x = 255;
+            _dst[i].r = _src[i].r;
+            _dst[i].g = _src[i].g;
+            _dst[i].b = _src[i].b;
+        }
+    });
 
     return osize;
 }
@@ -733,11 +922,15 @@ size_t AkVCam::VideoFramePrivate::rgb24_to_bgr24(void *dst, const void *src,
     auto _src = reinterpret_cast<const RGB24 *>(src);
     auto _dst = reinterpret_cast<BGR24 *>(dst);
 
-    for (size_t i = 0; i < len; i++) {
-        _dst[i].r = _src[i].r;
-        _dst[i].g = _src[i].g;
-        _dst[i].b = _src[i].b;
-    }
+    parallelizeRows(height, [=] (int yStart, int yEnd) {
+        size_t end = size_t(yEnd) * size_t(width);
+
+        for (size_t i = size_t(yStart) * size_t(width); i < end; i++) {
+            _dst[i].r = _src[i].r;
+            _dst[i].g = _src[i].g;
+            _dst[i].b = _src[i].b;
+        }
+    });
 
     return osize;
 }
@@ -754,11 +947,15 @@ size_t AkVCam::VideoFramePrivate::rgb24_to_bgr16(void *dst, const void *src,
     auto _src = reinterpret_cast<const RGB24 *>(src);
     auto _dst = reinterpret_cast<BGR16 *>(dst);
 
-    for (size_t i = 0; i < len; i++) {
-        _dst[i].r = _src[i].r >> 3;
-        _dst[i].g = _src[i].g >> 2;
-        _dst[i].b = _src[i].b >> 3;
-    }
+    parallelizeRows(height, [=] (int yStart, int yEnd) {
+        size_t end = size_t(yEnd) * size_t(width);
+
+        for (size_t i = size_t(yStart) * size_t(width); i < end; i++) {
+            _dst[i].r = _src[i].r >> 3;
+            _dst[i].g = _src[i].g >> 2;
+            _dst[i].b = _src[i].b >> 3;
+        }
+    });
 
     return osize;
 }
@@ -775,12 +972,16 @@ size_t AkVCam::VideoFramePrivate::rgb24_to_bgr15(void *dst, const void *src,
     auto _src = reinterpret_cast<const RGB24 *>(src);
     auto _dst = reinterpret_cast<BGR15 *>(dst);
 
-    for (size_t i = 0; i < len; i++) {
-        _dst[i].x = 1;
-        _dst[i].r = _src[i].r >> 3;
-        _dst[i].g = _src[i].g >> 3;
-        _dst[i].b = _src[i].b >> 3;
-    }
+    parallelizeRows(height, [=] (int yStart, int yEnd) {
+        size_t end = size_t(yEnd) * size_t(width);
+
+        for (size_t i = size_t(yStart) * size_t(width); i < end; i++) {
+            _dst[i].x = 1;
+            _dst[i].r = _src[i].r >> 3;
+            _dst[i].g = _src[i].g >> 3;
+            _dst[i].b = _src[i].b >> 3;
+        }
+    });
 
     return osize;
 }
@@ -797,26 +998,42 @@ size_t AkVCam::VideoFramePrivate::rgb24_to_uyvy(void *dst, const void *src,
     auto _src = reinterpret_cast<const RGB24 *>(src);
     auto _dst = reinterpret_cast<UYVY *>(dst);
 
-    size_t olen = len / 2;
-
-    for (size_t i = 0; i < olen; i++) {
-        size_t j = 2 * i;
-
-        uint8_t r0 = _src[j].r;
-        uint8_t g0 = _src[j].g;
-        uint8_t b0 = _src[j].b;
+    int _width = width >> 1;
 
-        j++;
+    parallelizeRows(height, [=] (int yStart, int yEnd) {
+        std::vector<uint16_t> r(width);
+        std::vector<uint16_t> g(width);
+        std::vector<uint16_t> b(width);
+        std::vector<uint16_t> rc(_width);
+        std::vector<uint16_t> gc(_width);
+        std::vector<uint16_t> bc(_width);
+        std::vector<uint8_t> yRow(width);
+        std::vector<uint8_t> uRow(_width);
+        std::vector<uint8_t> vRow(_width);
+
+        for (int y = yStart; y < yEnd; y++) {
+            auto line = _src + y * width;
+            auto dstLine = _dst + y * _width;
+            splitRgbRow(line, width, r.data(), g.data(), b.data());
+
+            for (int x = 0; x < _width; x++) {
+                rc[x] = r[2 * x];
+                gc[x] = g[2 * x];
+                bc[x] = b[2 * x];
+            }
 
-        uint8_t r1 = _src[j].r;
-        uint8_t g1 = _src[j].g;
-        uint8_t b1 = _src[j].b;
+            rowY(r.data(), g.data(), b.data(), yRow.data(), width);
+            rowU(rc.data(), gc.data(), bc.data(), uRow.data(), _width);
+            rowV(rc.data(), gc.data(), bc.data(), vRow.data(), _width);
 
-        _dst[i].u0 = rgb_u(r0, g0, b0);
-        _dst[i].y0 = rgb_y(r0, g0, b0);
-        _dst[i].v0 = rgb_v(r0, g0, b0);
-        _dst[i].y1 = rgb_y(r1, g1, b1);
-    }
+            for (int x = 0; x < _width; x++) {
+                dstLine[x].u0 = uRow[x];
+                dstLine[x].y0 = yRow[2 * x];
+                dstLine[x].v0 = vRow[x];
+                dstLine[x].y1 = yRow[2 * x + 1];
+            }
+        }
+    });
 
     return osize;
 }
@@ -833,26 +1050,42 @@ size_t AkVCam::VideoFramePrivate::rgb24_to_yuy2(void *dst, const void *src,
     auto _src = reinterpret_cast<const RGB24 *>(src);
     auto _dst = reinterpret_cast<YUY2 *>(dst);
 
-    size_t olen = len / 2;
-
-    for (size_t i = 0; i < olen; i++) {
-        size_t j = 2 * i;
-
-        uint8_t r0 = _src[j].r;
-        uint8_t g0 = _src[j].g;
-        uint8_t b0 = _src[j].b;
+    int _width = width >> 1;
 
-        j++;
+    parallelizeRows(height, [=] (int yStart, int yEnd) {
+        std::vector<uint16_t> r(width);
+        std::vector<uint16_t> g(width);
+        std::vector<uint16_t> b(width);
+        std::vector<uint16_t> rc(_width);
+        std::vector<uint16_t> gc(_width);
+        std::vector<uint16_t> bc(_width);
+        std::vector<uint8_t> yRow(width);
+        std::vector<uint8_t> uRow(_width);
+        std::vector<uint8_t> vRow(_width);
+
+        for (int y = yStart; y < yEnd; y++) {
+            auto line = _src + y * width;
+            auto dstLine = _dst + y * _width;
+            splitRgbRow(line, width, r.data(), g.data(), b.data());
+
+            for (int x = 0; x < _width; x++) {
+                rc[x] = r[2 * x];
+                gc[x] = g[2 * x];
+                bc[x] = b[2 * x];
+            }
 
-        uint8_t r1 = _src[j].r;
-        uint8_t g1 = _src[j].g;
-        uint8_t b1 = _src[j].b;
+            rowY(r.data(), g.data(), b.data(), yRow.data(), width);
+            rowU(rc.data(), gc.data(), bc.data(), uRow.data(), _width);
+            rowV(rc.data(), gc.data(), bc.data(), vRow.data(), _width);
 
-        _dst[i].y0 = rgb_y(r0, g0, b0);
-        _dst[i].u0 = rgb_u(r0, g0, b0);
-        _dst[i].y1 = rgb_y(r1, g1, b1);
-        _dst[i].v0 = rgb_v(r0, g0, b0);
-    }
+            for (int x = 0; x < _width; x++) {
+                dstLine[x].y0 = yRow[2 * x];
+                dstLine[x].u0 = uRow[x];
+                dstLine[x].y1 = yRow[2 * x + 1];
+                dstLine[x].v0 = vRow[x];
+            }
+        }
+    });
 
     return osize;
 }
@@ -870,34 +1103,44 @@ size_t AkVCam::VideoFramePrivate::rgb24_to_nv12(void *dst, const void *src,
     auto dst_y = reinterpret_cast<uint8_t *>(dst);
     auto dst_vu = reinterpret_cast<VU *>(dst_y + len);
 
-    // Write Y plane.
-    for (size_t i = 0; i < len; i++) {
-        uint8_t r = _src[i].r;
-        uint8_t g = _src[i].g;
-        uint8_t b = _src[i].b;
-
-        dst_y[i] = rgb_y(r, g, b);
-    }
-
-    // Write VU planes.
     int _width = width >> 1;
     int _height = height >> 1;
 
-    for (int y = 0; y < _height; y++) {
-        auto line = _src + 2 * y * width;
-        auto line_vu = dst_vu + y * _width;
-
-        for (int x = 0; x < _width; x++) {
-            int j = 2 * x;
+    parallelizeRows(height, [=] (int yStart, int yEnd) {
+        std::vector<uint16_t> r(width);
+        std::vector<uint16_t> g(width);
+        std::vector<uint16_t> b(width);
+        std::vector<uint16_t> rc(_width);
+        std::vector<uint16_t> gc(_width);
+        std::vector<uint16_t> bc(_width);
+        std::vector<uint8_t> uRow(_width);
+        std::vector<uint8_t> vRow(_width);
+
+        for (int y = yStart; y < yEnd; y++) {
+            auto line = _src + y * width;
+            splitRgbRow(line, width, r.data(), g.data(), b.data());
+            rowY(r.data(), g.data(), b.data(), dst_y + y * width, width);
+
+            // The chroma plane takes the even rows and columns only.
+            if ((y & 1) || (y >> 1) >= _height)
+                continue;
+
+            for (int x = 0; x < _width; x++) {
+                rc[x] = r[2 * x];
+                gc[x] = g[2 * x];
+                bc[x] = b[2 * x];
+            }
 
-            uint8_t r = line[j].r;
-            uint8_t g = line[j].g;
-            uint8_t b = line[j].b;
+            rowU(rc.data(), gc.data(), bc.data(), uRow.data(), _width);
+            rowV(rc.data(), gc.data(), bc.data(), vRow.data(), _width);
+            auto line_vu = dst_vu + (y >> 1) * _width;
 
-            line_vu[x].v = rgb_v(r, g, b);
-            line_vu[x].u = rgb_u(r, g, b);
+            for (int x = 0; x < _width; x++) {
+                line_vu[x].v = vRow[x];
+                line_vu[x].u = uRow[x];
+            }
         }
-    }
+    });
 
     return osize;
 }
@@ -915,34 +1158,44 @@ size_t AkVCam::VideoFramePrivate::rgb24_to_nv21(void *dst, const void *src,
     auto dst_y = reinterpret_cast<uint8_t *>(dst);
     auto dst_uv = reinterpret_cast<UV *>(dst_y + len);
 
-    // Write Y plane.
-    for (size_t i = 0; i < len; i++) {
-        uint8_t r = _src[i].r;
-        uint8_t g = _src[i].g;
-        uint8_t b = _src[i].b;
-
-        dst_y[i] = rgb_y(r, g, b);
-    }
-
-    // Write VU planes.
     int _width = width >> 1;
     int _height = height >> 1;
 
-    for (int y = 0; y < _height; y++) {
-        auto line = _src + 2 * y * width;
-        auto line_uv = dst_uv + y * _width;
-
-        for (int x = 0; x < _width; x++) {
-            int j = 2 * x;
+    parallelizeRows(height, [=] (int yStart, int yEnd) {
+        std::vector<uint16_t> r(width);
+        std::vector<uint16_t> g(width);
+        std::vector<uint16_t> b(width);
+        std::vector<uint16_t> rc(_width);
+        std::vector<uint16_t> gc(_width);
+        std::vector<uint16_t> bc(_width);
+        std::vector<uint8_t> uRow(_width);
+        std::vector<uint8_t> vRow(_width);
+
+        for (int y = yStart; y < yEnd; y++) {
+            auto line = _src + y * width;
+            splitRgbRow(line, width, r.data(), g.data(), b.data());
+            rowY(r.data(), g.data(), b.data(), dst_y + y * width, width);
+
+            // The chroma plane takes the even rows and columns only.
+            if ((y & 1) || (y >> 1) >= _height)
+                continue;
+
+            for (int x = 0; x < _width; x++) {
+                rc[x] = r[2 * x];
+                gc[x] = g[2 * x];
+                bc[x] = b[2 * x];
+            }
 
-            uint8_t r = line[j].r;
-            uint8_t g = line[j].g;
-            uint8_t b = line[j].b;
+            rowU(rc.data(), gc.data(), bc.data(), uRow.data(), _width);
+            rowV(rc.data(), gc.data(), bc.data(), vRow.data(), _width);
+            auto line_uv = dst_uv + (y >> 1) * _width;
 
-            line_uv[x].u = rgb_u(r, g, b);
-            line_uv[x].v = rgb_v(r, g, b);
+            for (int x = 0; x < _width; x++) {
+                line_uv[x].u = uRow[x];
+                line_uv[x].v = vRow[x];
+            }
         }
-    }
+    });
 
     return osize;
 }
@@ -0,0 +1,436 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <atomic>
+#include <cstring>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include "sharedframering.h"
+
+#define AKVCAM_RING_MAGIC 0x414b4652 // 'AKFR'
+#define AKVCAM_RING_VERSION 1
+
+namespace AkVCam
+{
+    /* Both structures live inside the mapped region, so they must only
+     * hold fixed size scalars and lock-free atomics.
+     */
+    struct SharedFrameRingHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t nFrames;
+        uint32_t frameSize;
+
+        // Total number of frames written, the latest slot is
+        // (writeIndex - 1) % nFrames.
+        std::atomic<uint32_t> writeIndex;
+    };
+
+    struct SharedFrameSlot
+    {
+        // Odd while the writer is filling the slot, readers retry when it
+        // changes under them.
+        std::atomic<uint32_t> sequence;
+
+        uint32_t fourcc;
+        int32_t width;
+        int32_t height;
+        uint32_t dataSize;
+    };
+
+    class SharedFrameRingPrivate
+    {
+        public:
+            std::string m_name;
+            SharedFrameRingHeader *m_header;
+            uint8_t *m_map;
+            size_t m_mapSize;
+            bool m_isWriter;
+
+#ifdef _WIN32
+            HANDLE m_mapping;
+#else
+            int m_fd;
+#endif
+
+            SharedFrameRingPrivate():
+                m_header(nullptr),
+                m_map(nullptr),
+                m_mapSize(0),
+                m_isWriter(false),
+#ifdef _WIN32
+                m_mapping(nullptr)
+#else
+                m_fd(-1)
+#endif
+            {
+            }
+
+            static size_t slotSize(const SharedFrameRingHeader &header)
+            {
+                return sizeof(SharedFrameSlot) + header.frameSize;
+            }
+
+            SharedFrameSlot *slot(uint32_t index) const
+            {
+                auto offset = sizeof(SharedFrameRingHeader)
+                              + (index % this->m_header->nFrames)
+                                * slotSize(*this->m_header);
+
+                return reinterpret_cast<SharedFrameSlot *>(this->m_map
+                                                           + offset);
+            }
+
+            static uint8_t *slotData(SharedFrameSlot *slot)
+            {
+                return reinterpret_cast<uint8_t *>(slot)
+                       + sizeof(SharedFrameSlot);
+            }
+
+            bool map(const std::string &name, size_t size, bool create);
+            void unmap();
+    };
+}
+
+bool AkVCam::SharedFrameRingPrivate::map(const std::string &name,
+                                         size_t size,
+                                         bool create)
+{
+#ifdef _WIN32
+    auto mappingName = "Local\\" + name;
+
+    if (create)
+        this->m_mapping =
+                CreateFileMappingA(INVALID_HANDLE_VALUE,
+                                   nullptr,
+                                   PAGE_READWRITE,
+                                   0,
+                                   DWORD(size),
+                                   mappingName.c_str());
+    else
+        this->m_mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS,
+                                           FALSE,
+                                           mappingName.c_str());
+
+    if (!this->m_mapping)
+        return false;
+
+    // Readers pass the whole mapping, whatever the writer sized it to.
+    this->m_map =
+            reinterpret_cast<uint8_t *>(MapViewOfFile(this->m_mapping,
+                                                      FILE_MAP_ALL_ACCESS,
+                                                      0,
+                                                      0,
+                                                      create? size: 0));
+
+    if (!this->m_map) {
+        CloseHandle(this->m_mapping);
+        this->m_mapping = nullptr;
+
+        return false;
+    }
+
+    if (!create) {
+        MEMORY_BASIC_INFORMATION mapInfo;
+        memset(&mapInfo, 0, sizeof(MEMORY_BASIC_INFORMATION));
+        VirtualQuery(this->m_map, &mapInfo, sizeof(MEMORY_BASIC_INFORMATION));
+        size = size_t(mapInfo.RegionSize);
+    }
+#else
+    auto shmName = "/" + name;
+
+    if (create) {
+        this->m_fd = shm_open(shmName.c_str(),
+                              O_RDWR | O_CREAT,
+                              S_IRUSR | S_IWUSR);
+
+        if (this->m_fd < 0)
+            return false;
+
+        if (ftruncate(this->m_fd, off_t(size)) < 0) {
+            ::close(this->m_fd);
+            this->m_fd = -1;
+            shm_unlink(shmName.c_str());
+
+            return false;
+        }
+    } else {
+        this->m_fd = shm_open(shmName.c_str(), O_RDWR, 0);
+
+        if (this->m_fd < 0)
+            return false;
+
+        struct stat stats;
+
+        if (fstat(this->m_fd, &stats) < 0 || size_t(stats.st_size) < size) {
+            ::close(this->m_fd);
+            this->m_fd = -1;
+
+            return false;
+        }
+
+        // Readers map whatever the writer sized the region to.
+        size = size_t(stats.st_size);
+    }
+
+    auto map = mmap(nullptr,
+                    size,
+                    PROT_READ | PROT_WRITE,
+                    MAP_SHARED,
+                    this->m_fd,
+                    0);
+
+    if (map == MAP_FAILED) {
+        ::close(this->m_fd);
+        this->m_fd = -1;
+
+        if (create)
+            shm_unlink(shmName.c_str());
+
+        return false;
+    }
+
+    this->m_map = reinterpret_cast<uint8_t *>(map);
+#endif
+
+    this->m_name = name;
+    this->m_mapSize = size;
+    this->m_isWriter = create;
+    this->m_header = reinterpret_cast<SharedFrameRingHeader *>(this->m_map);
+
+    return true;
+}
+
+void AkVCam::SharedFrameRingPrivate::unmap()
+{
+    if (!this->m_map)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(this->m_map);
+    CloseHandle(this->m_mapping);
+    this->m_mapping = nullptr;
+#else
+    munmap(this->m_map, this->m_mapSize);
+    ::close(this->m_fd);
+    this->m_fd = -1;
+
+    if (this->m_isWriter)
+        shm_unlink(("/" + this->m_name).c_str());
+#endif
+
+    this->m_map = nullptr;
+    this->m_header = nullptr;
+    this->m_mapSize = 0;
+    this->m_isWriter = false;
+    this->m_name.clear();
+}
+
+AkVCam::SharedFrameRing::SharedFrameRing()
+{
+    this->d = new SharedFrameRingPrivate;
+}
+
+AkVCam::SharedFrameRing::~SharedFrameRing()
+{
+    this->close();
+    delete this->d;
+}
+
+std::string AkVCam::SharedFrameRing::name() const
+{
+    return this->d->m_name;
+}
+
+bool AkVCam::SharedFrameRing::isOpen() const
+{
+    return this->d->m_header != nullptr;
+}
+
+bool AkVCam::SharedFrameRing::create(const std::string &name,
+                                     size_t frameSize,
+                                     uint32_t nFrames)
+{
+    if (this->isOpen() || name.empty() || frameSize < 1 || nFrames < 2)
+        return false;
+
+    SharedFrameRingHeader header;
+    header.nFrames = nFrames;
+    header.frameSize = uint32_t(frameSize);
+    auto size = sizeof(SharedFrameRingHeader)
+                + nFrames * SharedFrameRingPrivate::slotSize(header);
+
+    if (!this->d->map(name, size, true))
+        return false;
+
+    memset(this->d->m_map, 0, size);
+    this->d->m_header->magic = AKVCAM_RING_MAGIC;
+    this->d->m_header->version = AKVCAM_RING_VERSION;
+    this->d->m_header->nFrames = nFrames;
+    this->d->m_header->frameSize = uint32_t(frameSize);
+    this->d->m_header->writeIndex.store(0, std::memory_order_release);
+
+    return true;
+}
+
+bool AkVCam::SharedFrameRing::write(const VideoFormat &format,
+                                    const uint8_t *data,
+                                    size_t dataSize)
+{
+    if (!this->isOpen() || !this->d->m_isWriter || !data)
+        return false;
+
+    if (dataSize > this->d->m_header->frameSize)
+        return false;
+
+    auto index = this->d->m_header->writeIndex.load(std::memory_order_relaxed);
+    auto slot = this->d->slot(index);
+
+    // Mark the slot busy, fill it in place and then publish it. Readers
+    // seeing an odd or changed sequence discard the slot and retry.
+    auto sequence = slot->sequence.load(std::memory_order_relaxed);
+    slot->sequence.store(sequence + 1, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot->fourcc = format.fourcc();
+    slot->width = format.width();
+    slot->height = format.height();
+    slot->dataSize = uint32_t(dataSize);
+    memcpy(SharedFrameRingPrivate::slotData(slot), data, dataSize);
+
+    slot->sequence.store(sequence + 2, std::memory_order_release);
+    this->d->m_header->writeIndex.store(index + 1,
+                                        std::memory_order_release);
+
+    return true;
+}
+
+bool AkVCam::SharedFrameRing::open(const std::string &name)
+{
+    if (this->isOpen() || name.empty())
+        return false;
+
+    if (!this->d->map(name, sizeof(SharedFrameRingHeader), false))
+        return false;
+
+    if (this->d->m_header->magic != AKVCAM_RING_MAGIC
+        || this->d->m_header->version != AKVCAM_RING_VERSION
+        || this->d->m_header->nFrames < 2
+        || this->d->m_header->frameSize < 1) {
+        this->d->unmap();
+
+        return false;
+    }
+
+    auto size = sizeof(SharedFrameRingHeader)
+                + this->d->m_header->nFrames
+                  * SharedFrameRingPrivate::slotSize(*this->d->m_header);
+
+    if (this->d->m_mapSize < size) {
+        this->d->unmap();
+
+        return false;
+    }
+
+    return true;
+}
+
+bool AkVCam::SharedFrameRing::read(VideoFormat &format,
+                                   std::vector<uint8_t> &data,
+                                   uint32_t *index) const
+{
+    if (!this->isOpen())
+        return false;
+
+    auto writeIndex =
+            this->d->m_header->writeIndex.load(std::memory_order_acquire);
+
+    if (writeIndex < 1)
+        return false;
+
+    /* Walk back from the newest slot, if the writer overruns the one
+     * being read just move on to the frame it published meanwhile.
+     */
+    for (int retry = 0; retry < 3; retry++) {
+        auto frameIndex = writeIndex - 1;
+        auto slot = this->d->slot(frameIndex);
+        auto sequence = slot->sequence.load(std::memory_order_acquire);
+
+        if (sequence & 1) {
+            writeIndex =
+                    this->d->m_header->writeIndex
+                            .load(std::memory_order_acquire);
+
+            continue;
+        }
+
+        auto fourcc = slot->fourcc;
+        auto width = slot->width;
+        auto height = slot->height;
+        auto dataSize = slot->dataSize;
+
+        if (dataSize > this->d->m_header->frameSize)
+            return false;
+
+        data.resize(dataSize);
+        memcpy(data.data(),
+               SharedFrameRingPrivate::slotData(slot),
+               dataSize);
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (slot->sequence.load(std::memory_order_acquire) != sequence) {
+            writeIndex =
+                    this->d->m_header->writeIndex
+                            .load(std::memory_order_acquire);
+
+            continue;
+        }
+
+        format = VideoFormat(fourcc, width, height);
+
+        if (index)
+            *index = frameIndex;
+
+        return true;
+    }
+
+    return false;
+}
+
+uint32_t AkVCam::SharedFrameRing::lastIndex() const
+{
+    if (!this->isOpen())
+        return 0;
+
+    return this->d->m_header->writeIndex.load(std::memory_order_acquire);
+}
+
+void AkVCam::SharedFrameRing::close()
+{
+    this->d->unmap();
+}
@@ -0,0 +1,72 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#ifndef AKVCAMUTILS_SHAREDFRAMERING_H
+#define AKVCAMUTILS_SHAREDFRAMERING_H
+
+#include <cstdint>
+#include <string>
+
+#include "../image/videoformat.h"
+
+namespace AkVCam
+{
+    class SharedFrameRingPrivate;
+
+    /* Single writer/multiple readers frame ring living in a named shared
+     * memory region. The writer serializes each frame in place into the
+     * next slot and then publishes it by flipping the ring index, so the
+     * only per-frame work crossing the process boundary is the payload
+     * copy into the mapped region. Readers poll the index and copy out
+     * the latest slot, validating it with the slot sequence number.
+     */
+    class SharedFrameRing
+    {
+        public:
+            SharedFrameRing();
+            SharedFrameRing(const SharedFrameRing &other) = delete;
+            SharedFrameRing &operator =(const SharedFrameRing &other) = delete;
+            ~SharedFrameRing();
+
+            std::string name() const;
+            bool isOpen() const;
+
+            // Writer side.
+            bool create(const std::string &name,
+                        size_t frameSize,
+                        uint32_t nFrames=4);
+            bool write(const VideoFormat &format,
+                       const uint8_t *data,
+                       size_t dataSize);
+
+            // Reader side.
+            bool open(const std::string &name);
+            bool read(VideoFormat &format,
+                      std::vector<uint8_t> &data,
+                      uint32_t *index=nullptr) const;
+            uint32_t lastIndex() const;
+
+            void close();
+
+        private:
+            SharedFrameRingPrivate *d;
+    };
+}
+
+#endif // AKVCAMUTILS_SHAREDFRAMERING_H
@@ -65,6 +65,16 @@ QString CameraOut::description(const QString &webcam) const
     return QString();
 }
 
+QList<AkVideoCaps::PixelFormat> CameraOut::supportedPixelFormats() const
+{
+    return QList<AkVideoCaps::PixelFormat>();
+}
+
+int CameraOut::listeners() const
+{
+    return -1;
+}
+
 void CameraOut::writeFrame(const AkPacket &frame)
 {
     Q_UNUSED(frame)
@@ -21,6 +21,7 @@
 #define CAMERAOUT_H
 
 #include <akcaps.h>
+#include <akvideocaps.h>
 
 class CameraOut;
 class AkPacket;
@@ -75,6 +76,17 @@ class CameraOut: public QObject
         Q_INVOKABLE virtual int streamIndex() const;
         Q_INVOKABLE virtual AkCaps caps() const;
         Q_INVOKABLE virtual QString description(const QString &webcam) const;
+
+        /* Pixel formats the output device accepts as is. An empty list
+         * means the formats are unknown, and the caller must convert to
+         * its preferred format before writing. */
+        Q_INVOKABLE virtual QList<AkVideoCaps::PixelFormat> supportedPixelFormats() const;
+
+        /* Number of programs reading from the virtual camera right now,
+         * or -1 when the backend can't tell. Backends that can tell also
+         * emit listenersChanged() on open/close, so callers can gate the
+         * conversion and write path while nobody is watching. */
+        Q_INVOKABLE virtual int listeners() const;
         Q_INVOKABLE virtual void writeFrame(const AkPacket &frame);
         Q_INVOKABLE virtual int maxCameras() const;
         Q_INVOKABLE virtual bool needRoot() const;
@@ -104,6 +116,7 @@ class CameraOut: public QObject
         void needRootChanged(bool needRoot);
         void passwordTimeoutChanged(int passwordTimeout);
         void rootMethodChanged(const QString &rootMethod);
+        void listenersChanged(int listeners);
         void error(const QString &message);
 
     public slots:
@@ -74,6 +74,15 @@ CameraOutCMIO::CameraOutCMIO(QObject *parent):
 
     if (QFileInfo::exists(daemon))
         this->d->m_ipcBridge.registerPeer(false);
+
+    /* The assistant notifies every client open/close, forward the count
+     * so the element can stop converting and writing frames while
+     * nobody has the camera open. */
+    this->d->m_ipcBridge.setListenersChangedCallback([this] (const std::string &deviceId,
+                                                             int listeners) {
+        if (QString::fromStdString(deviceId) == this->d->m_curDevice)
+            emit this->listenersChanged(listeners);
+    });
 }
 
 CameraOutCMIO::~CameraOutCMIO()
@@ -109,6 +118,14 @@ QString CameraOutCMIO::description(const QString &webcam) const
     return {};
 }
 
+int CameraOutCMIO::listeners() const
+{
+    if (this->d->m_curDevice.isEmpty())
+        return -1;
+
+    return this->d->m_ipcBridge.listeners(this->d->m_curDevice.toStdString());
+}
+
 void CameraOutCMIO::writeFrame(const AkPacket &frame)
 {
     if (this->d->m_curDevice.isEmpty())
@@ -35,6 +35,7 @@ class CameraOutCMIO: public CameraOut
         Q_INVOKABLE QStringList webcams() const;
         Q_INVOKABLE int streamIndex() const;
         Q_INVOKABLE QString description(const QString &webcam) const;
+        Q_INVOKABLE int listeners() const;
         Q_INVOKABLE void writeFrame(const AkPacket &frame);
         Q_INVOKABLE int maxCameras() const;
         Q_INVOKABLE QString createWebcam(const QString &description,
@@ -243,6 +243,13 @@ QString CameraOutV4L2::description(const QString &webcam) const
     return QString();
 }
 
+QList<AkVideoCaps::PixelFormat> CameraOutV4L2::supportedPixelFormats() const
+{
+    // The loopback device takes any format init() can program with
+    // VIDIOC_S_FMT, so every mapped format is fair game.
+    return ffToV4L2->keys();
+}
+
 void CameraOutV4L2::writeFrame(const AkPacket &frame)
 {
     if (!this->d->m_deviceFile.isOpen())
@@ -35,6 +35,7 @@ class CameraOutV4L2: public CameraOut
         Q_INVOKABLE QStringList webcams() const;
         Q_INVOKABLE int streamIndex() const;
         Q_INVOKABLE QString description(const QString &webcam) const;
+        Q_INVOKABLE QList<AkVideoCaps::PixelFormat> supportedPixelFormats() const;
         Q_INVOKABLE void writeFrame(const AkPacket &frame);
         Q_INVOKABLE int maxCameras() const;
         Q_INVOKABLE bool needRoot() const;
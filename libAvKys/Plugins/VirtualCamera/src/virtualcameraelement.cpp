@@ -17,12 +17,20 @@
  * Web-Site: http://webcamoid.github.io/
  */
 
+#include <limits>
 #include <QImage>
 #include <QQmlContext>
 #include <QSharedPointer>
+#include <QtConcurrent>
+#include <QThreadPool>
+#include <QFuture>
 #include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
 #include <akutils.h>
 #include <akcaps.h>
+#include <akfrac.h>
+#include <akmetrics.h>
 #include <akpacket.h>
 
 #include "virtualcameraelement.h"
@@ -78,13 +86,34 @@ class VirtualCameraElementPrivate
         AkCaps m_streamCaps;
         QMutex m_mutex;
         QMutex m_mutexLib;
+        QThreadPool m_threadPool;
+        QFuture<void> m_paceLoopResult;
+        AkPacket m_paceFrame;
+        QMutex m_paceMutex;
+        QWaitCondition m_paceWait;
+        bool m_runPaceLoop;
+        qint64 m_frameInterval;
+        qint64 m_nextFrameTime;
+
+        /* Consumers currently reading from the device, -1 while the
+         * backend can't tell. Kept in an atomic so the streaming paths
+         * read it without taking the element locks. */
+        QAtomicInt m_listeners;
 
         VirtualCameraElementPrivate():
-            m_streamIndex(-1)
+            m_streamIndex(-1),
+            m_runPaceLoop(false),
+            m_frameInterval(0),
+            m_nextFrameTime(0)
         {
+            this->m_listeners.storeRelease(-1);
         }
 
         inline QImage swapChannels(const QImage &image) const;
+        inline void measureLuma(const AkPacket &packet) const;
+        void paceLoop();
+        void startPaceLoop();
+        void stopPaceLoop();
 };
 
 VirtualCameraElement::VirtualCameraElement():
@@ -234,8 +263,16 @@ QVariantMap VirtualCameraElement::addStream(int streamIndex,
         return {};
 
     AkVideoCaps videoCaps(streamCaps);
-    videoCaps.format() = PREFERRED_FORMAT;
-    videoCaps.bpp() = AkVideoCaps::bitsPerPixel(PREFERRED_FORMAT);
+    auto pixelFormats = this->d->m_cameraOut->supportedPixelFormats();
+
+    /* Offer the pipeline's current format to the output first. When the
+     * device takes it, matching frames are written as is and the
+     * conversion in iStream() is skipped altogether. */
+    if (!pixelFormats.contains(videoCaps.format())) {
+        videoCaps.format() = PREFERRED_FORMAT;
+        videoCaps.bpp() = AkVideoCaps::bitsPerPixel(PREFERRED_FORMAT);
+    }
+
     videoCaps.width() = roundTo(videoCaps.width(), PREFERRED_ROUNDING);
     videoCaps.height() = roundTo(videoCaps.height(), PREFERRED_ROUNDING);
 
@@ -291,6 +328,11 @@ bool VirtualCameraElement::removeAllWebcams(const QString &password)
     return this->d->m_cameraOut->removeAllWebcams(password);
 }
 
+QList<AkCaps::CapsType> VirtualCameraElement::acceptedMediaTypes() const
+{
+    return {AkCaps::CapsVideo};
+}
+
 QImage VirtualCameraElementPrivate::swapChannels(const QImage &image) const
 {
     QImage swapped(image.size(), image.format());
@@ -310,6 +352,128 @@ QImage VirtualCameraElementPrivate::swapChannels(const QImage &image) const
     return swapped;
 }
 
+/* Luma metering tap over the frames published to the virtual camera: a
+ * 16 bucket histogram plus the normalized average, over a 1 in 64
+ * subsampled grid. packetToImage() aliases the packet buffer, so the tap
+ * costs a fraction of the pixels the conversion below touches anyway.
+ * Only called with metrics collection enabled.
+ */
+void VirtualCameraElementPrivate::measureLuma(const AkPacket &packet) const
+{
+    auto image = AkUtils::packetToImage(packet);
+
+    if (image.isNull()
+        || (image.format() != QImage::Format_RGB32
+            && image.format() != QImage::Format_ARGB32))
+        return;
+
+    qint64 histogram[16] = {0};
+    qint64 sum = 0;
+    qint64 count = 0;
+
+    for (int y = 0; y < image.height(); y += 8) {
+        auto line = reinterpret_cast<const QRgb *>(image.constScanLine(y));
+
+        for (int x = 0; x < image.width(); x += 8) {
+            int luma = qGray(line[x]);
+            histogram[luma >> 4]++;
+            sum += luma;
+            count++;
+        }
+    }
+
+    if (count < 1)
+        return;
+
+    QVariantList buckets;
+
+    for (auto &bucket: histogram)
+        buckets << bucket;
+
+    AkMetrics::instance()->setLevels("VirtualCamera",
+                                     {{"lumaAvg", qreal(sum) / count / 255.},
+                                      {"lumaHistogram", buckets}});
+}
+
+void VirtualCameraElementPrivate::paceLoop()
+{
+    QElapsedTimer clock;
+
+    forever {
+        clock.restart();
+
+        this->m_paceMutex.lock();
+        AkPacket frame = this->m_paceFrame;
+        this->m_paceMutex.unlock();
+
+        /* When iStream() didn't publish a new frame during the last
+         * interval the previous one is written again, so the device
+         * keeps its frame rate while upstream stalls. The loop only
+         * runs between init() and uninit(), so the output is valid
+         * here without taking the element locks. */
+        if (frame && this->m_listeners.loadAcquire() != 0)
+            this->m_cameraOut->writeFrame(frame);
+
+        this->m_paceMutex.lock();
+
+        if (!this->m_runPaceLoop) {
+            this->m_paceMutex.unlock();
+
+            break;
+        }
+
+        qint64 remaining = this->m_frameInterval - clock.elapsed();
+
+        if (remaining > 0)
+            this->m_paceWait.wait(&this->m_paceMutex, ulong(remaining));
+
+        bool run = this->m_runPaceLoop;
+        this->m_paceMutex.unlock();
+
+        if (!run)
+            break;
+    }
+}
+
+void VirtualCameraElementPrivate::startPaceLoop()
+{
+    AkVideoCaps videoCaps(this->m_streamCaps);
+    this->m_frameInterval = videoCaps.fps().value() > 0?
+                                qRound64(1.e3 / videoCaps.fps().value()): 33;
+
+    this->m_paceMutex.lock();
+    this->m_paceFrame = AkPacket();
+    this->m_nextFrameTime = std::numeric_limits<qint64>::min();
+    this->m_runPaceLoop = true;
+    this->m_paceMutex.unlock();
+
+    this->m_paceLoopResult =
+            QtConcurrent::run(&this->m_threadPool,
+                              this,
+                              &VirtualCameraElementPrivate::paceLoop);
+}
+
+void VirtualCameraElementPrivate::stopPaceLoop()
+{
+    this->m_paceMutex.lock();
+
+    if (!this->m_runPaceLoop) {
+        this->m_paceMutex.unlock();
+
+        return;
+    }
+
+    this->m_runPaceLoop = false;
+    this->m_paceWait.wakeAll();
+    this->m_paceMutex.unlock();
+
+    this->m_paceLoopResult.waitForFinished();
+
+    this->m_paceMutex.lock();
+    this->m_paceFrame = AkPacket();
+    this->m_paceMutex.unlock();
+}
+
 QString VirtualCameraElement::controlInterfaceProvide(const QString &controlId) const
 {
     Q_UNUSED(controlId)
@@ -456,7 +620,9 @@ bool VirtualCameraElement::setState(AkElement::ElementState state)
                 return false;
             }
 
+            this->d->m_listeners.storeRelease(this->d->m_cameraOut->listeners());
             this->d->m_mutex.unlock();
+            this->d->startPaceLoop();
 
             return AkElement::setState(state);
         }
@@ -469,6 +635,7 @@ bool VirtualCameraElement::setState(AkElement::ElementState state)
     case AkElement::ElementStatePaused: {
         switch (state) {
         case AkElement::ElementStateNull:
+            this->d->stopPaceLoop();
             this->d->m_mutex.lock();
             this->d->m_cameraOut->uninit();
             this->d->m_mutex.unlock();
@@ -485,6 +652,7 @@ bool VirtualCameraElement::setState(AkElement::ElementState state)
     case AkElement::ElementStatePlaying: {
         switch (state) {
         case AkElement::ElementStateNull:
+            this->d->stopPaceLoop();
             this->d->m_mutex.lock();
             this->d->m_cameraOut->uninit();
             this->d->m_mutex.unlock();
@@ -508,32 +676,59 @@ AkPacket VirtualCameraElement::iStream(const AkPacket &packet)
     if (!this->d->m_convertVideo || !this->d->m_cameraOut)
         return AkPacket();
 
+    /* Nobody has the virtual camera open, skip the conversion and the
+     * write entirely; the backend will report again when a consumer
+     * connects. */
+    if (this->d->m_listeners.loadAcquire() == 0)
+        return AkPacket();
+
     this->d->m_mutex.lock();
 
     if (this->state() == AkElement::ElementStatePlaying) {
-        QImage image = AkUtils::packetToImage(packet);
-        image = image.convertToFormat(QImage::Format_RGB32);
-        AkPacket oPacket;
+        /* The pace loop re-sends the last published frame at the
+         * negotiated rate, so anything arriving faster than that is
+         * dropped here by timestamp, before paying for a conversion. */
+        qint64 packetTime =
+                qRound64(1.e3 * packet.pts() * packet.timeBase().value());
+
+        if (packet.timeBase().value() <= 0
+            || packetTime >= this->d->m_nextFrameTime) {
+            this->d->m_nextFrameTime = packetTime + this->d->m_frameInterval;
+
+            if (AkMetrics::instance()->enabled())
+                this->d->measureLuma(packet);
+
+            AkPacket oPacket;
+
+            if (packet.caps() == this->d->m_cameraOut->caps()) {
+                // The output accepted the pipeline's format in
+                // addStream(), write the frame untouched.
+                oPacket = packet;
+            } else {
+                QImage image = AkUtils::packetToImage(packet);
+                image = image.convertToFormat(QImage::Format_RGB32);
 
 #ifdef Q_OS_WIN32
-        oPacket = AkUtils::roundSizeTo(AkUtils::imageToPacket(image, packet),
-                                       PREFERRED_ROUNDING);
+                oPacket = AkUtils::roundSizeTo(AkUtils::imageToPacket(image, packet),
+                                               PREFERRED_ROUNDING);
 #elif defined(Q_OS_OSX)
-        image = image.convertToFormat(QImage::Format_RGB888);
-        oPacket = AkUtils::roundSizeTo(AkUtils::imageToPacket(image, packet),
-                                       PREFERRED_ROUNDING);
+                image = image.convertToFormat(QImage::Format_RGB888);
+                oPacket = AkUtils::roundSizeTo(AkUtils::imageToPacket(image, packet),
+                                               PREFERRED_ROUNDING);
 #else
-        image = this->d->swapChannels(image);
+                image = this->d->swapChannels(image);
 
-        this->d->m_mutexLib.lock();
-        oPacket = this->d->m_convertVideo->convert(AkUtils::imageToPacket(image, packet),
-                                                   this->d->m_cameraOut->caps());
-        this->d->m_mutexLib.unlock();
+                this->d->m_mutexLib.lock();
+                oPacket = this->d->m_convertVideo->convert(AkUtils::imageToPacket(image, packet),
+                                                           this->d->m_cameraOut->caps());
+                this->d->m_mutexLib.unlock();
 #endif
+            }
 
-        this->d->m_mutexLib.lock();
-        this->d->m_cameraOut->writeFrame(oPacket);
-        this->d->m_mutexLib.unlock();
+            this->d->m_paceMutex.lock();
+            this->d->m_paceFrame = oPacket;
+            this->d->m_paceMutex.unlock();
+        }
     }
 
     this->d->m_mutex.unlock();
@@ -588,6 +783,12 @@ void VirtualCameraElement::outputLibUpdated(const QString &outputLib)
                      &CameraOut::passwordTimeoutChanged,
                      this,
                      &VirtualCameraElement::passwordTimeoutChanged);
+    QObject::connect(this->d->m_cameraOut.data(),
+                     &CameraOut::listenersChanged,
+                     this,
+                     [this] (int listeners) {
+                         this->d->m_listeners.storeRelease(listeners);
+                     });
 
     this->d->m_mutexLib.unlock();
 
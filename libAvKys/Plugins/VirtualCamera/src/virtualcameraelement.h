@@ -108,6 +108,8 @@ class VirtualCameraElement: public AkElement
                                       const QString &password="");
         Q_INVOKABLE bool removeAllWebcams(const QString &password="");
 
+        QList<AkCaps::CapsType> acceptedMediaTypes() const;
+
     private:
         VirtualCameraElementPrivate *d;
 
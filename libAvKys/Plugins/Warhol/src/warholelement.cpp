@@ -19,8 +19,10 @@
 
 #include <QImage>
 #include <QQmlContext>
+#include <QVector>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akvideofilterrunner.h>
 
 #include "warholelement.h"
 
@@ -96,22 +98,46 @@ AkPacket WarholElement::iStream(const AkPacket &packet)
 
     src = src.convertToFormat(QImage::Format_ARGB32);
     QImage oFrame = QImage(src.size(), src.format());
-    int nFrames = this->d->m_nFrames;
+    int nFrames = qMax(this->d->m_nFrames, 1);
+    int width = src.width();
+    int height = src.height();
+
+    /* The source column, source row and cell palette only depend on the
+     * output coordinate, so resolve the divisions once per column and
+     * per row instead of once per pixel; the scan below then costs one
+     * load, one XOR and one store per output pixel regardless of the
+     * cell count. */
+    QVector<int> srcX(width);
+    QVector<int> srcY(height);
+    QVector<int> cellY(height);
+    QVector<quint32> cellColors(nFrames * width);
+
+    for (int x = 0; x < width; x++)
+        srcX[x] = (x * nFrames) % width;
+
+    for (int y = 0; y < height; y++) {
+        srcY[y] = (y * nFrames) % height;
+        cellY[y] = (y * nFrames) / height;
+    }
 
-    for (int y = 0; y < src.height(); y++) {
-        QRgb *oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+    for (int j = 0; j < nFrames; j++)
+        for (int x = 0; x < width; x++) {
+            int i = qBound(0,
+                           j * nFrames + (x * nFrames) / width,
+                           this->d->m_colorTable.size() - 1);
+            cellColors[j * width + x] = this->d->m_colorTable[i];
+        }
 
-        for (int x = 0; x < src.width(); x++) {
-            int p = (x * nFrames) % src.width();
-            int q = (y * nFrames) % src.height();
-            int i = ((y * nFrames) / src.height()) * nFrames +
-                    ((x * nFrames) / src.width());
+    AkVideoFilterRunner::globalRunner()->run(height, [&] (int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; y++) {
+            auto iLine = reinterpret_cast<const QRgb *>(src.constScanLine(srcY[y]));
+            auto oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+            auto colors = cellColors.constData() + cellY[y] * width;
 
-            i = qBound(0, i, this->d->m_colorTable.size() - 1);
-            const QRgb *iLine = reinterpret_cast<const QRgb *>(src.constScanLine(q));
-            oLine[x] = (iLine[p] ^ this->d->m_colorTable[i]) | 0xff000000;
+            for (int x = 0; x < width; x++)
+                oLine[x] = (iLine[srcX[x]] ^ colors[x]) | 0xff000000;
         }
-    }
+    });
 
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
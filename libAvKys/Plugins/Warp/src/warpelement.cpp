@@ -22,6 +22,7 @@
 #include <QtMath>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akdisplacementmap.h>
 
 #include "warpelement.h"
 
@@ -31,6 +32,7 @@ class WarpElementPrivate
         qreal m_ripples;
         QSize m_frameSize;
         QVector<qreal> m_phiTable;
+        AkDisplacementMap m_displacementMap;
 
         WarpElementPrivate():
             m_ripples(4)
@@ -120,24 +122,25 @@ AkPacket WarpElement::iStream(const AkPacket &packet)
     qreal ripples = this->d->m_ripples * sin((tval - 70) * M_PI / 64);
 
     tval = (tval + 1) & 511;
-    qreal *phiTable = this->d->m_phiTable.data();
+    const qreal *phiTable = this->d->m_phiTable.constData();
+    int width = src.width();
+    int height = src.height();
 
-    for (int y = 0, i = 0; y < src.height(); y++) {
-        auto oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(y));
+    /* The displacement depends on the timestamp, so the map can't be cached
+     * between frames, but building it this way still runs the trigonometry
+     * and the gather in parallel row bands.
+     */
+    this->d->m_displacementMap.setMap(src.size(), [&] (int x, int y) {
+        qreal phi = ripples * phiTable[x + y * width];
 
-        for (int x = 0; x < src.width(); x++, i++) {
-            qreal phi = ripples * phiTable[i];
+        int xOrig = int(dx * cos(phi) + x);
+        int yOrig = int(dy * sin(phi) + y);
 
-            int xOrig = int(dx * cos(phi) + x);
-            int yOrig = int(dy * sin(phi) + y);
+        return QPoint(qBound(0, xOrig, width - 1),
+                      qBound(0, yOrig, height - 1));
+    });
 
-            xOrig = qBound(0, xOrig, src.width());
-            yOrig = qBound(0, yOrig, src.height());
-
-            auto iLine = reinterpret_cast<const QRgb *>(src.constScanLine(yOrig));
-            oLine[x] = iLine[xOrig];
-        }
-    }
+    this->d->m_displacementMap.apply(src, oFrame);
 
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
@@ -23,9 +23,13 @@
 #include <QMutex>
 #include <akutils.h>
 #include <akpacket.h>
+#include <akvideofilterrunner.h>
 
 #include "waveelement.h"
 
+// One period of the wave, quantized. The phase only shifts the index.
+static const int SineTableSize = 4096;
+
 class WaveElementPrivate
 {
     public:
@@ -34,7 +38,8 @@ class WaveElementPrivate
         qreal m_phase;
         QRgb m_background;
         QSize m_frameSize;
-        QVector<int> m_sineMap;
+        QVector<int> m_sineTable;
+        QVector<int> m_baseIndex;
         QMutex m_mutex;
 
         WaveElementPrivate():
@@ -58,14 +63,6 @@ WaveElement::WaveElement(): AkElement()
                      &WaveElement::frequencyChanged,
                      this,
                      &WaveElement::updateSineMap);
-    QObject::connect(this,
-                     &WaveElement::phaseChanged,
-                     this,
-                     &WaveElement::updateSineMap);
-    QObject::connect(this,
-                     &WaveElement::backgroundChanged,
-                     this,
-                     &WaveElement::updateSineMap);
     QObject::connect(this,
                      &WaveElement::frameSizeChanged,
                      this,
@@ -196,33 +193,58 @@ AkPacket WaveElement::iStream(const AkPacket &packet)
     }
 
     this->d->m_mutex.lock();
-    QVector<int> sineMap(this->d->m_sineMap);
+    QVector<int> sineTable(this->d->m_sineTable);
+    QVector<int> baseIndex(this->d->m_baseIndex);
     this->d->m_mutex.unlock();
 
-    if (sineMap.isEmpty())
+    if (sineTable.isEmpty())
         akSend(packet)
 
-    for (int y = 0; y < oFrame.height(); y++) {
-        // Get input line.
-        int yi = int(y / (1.0 - amplitude));
+    int width = src.width();
+    int height = src.height();
 
-        if (yi < 0 || yi >= src.height())
-            continue;
+    // The phase shifts the table index, so animating it costs no trig.
+    int phaseIndex = int(this->d->m_phase * SineTableSize);
+    QVector<int> sineMap(width);
+
+    for (int x = 0; x < width; x++)
+        sineMap[x] = sineTable[(baseIndex[x] + phaseIndex)
+                               & (SineTableSize - 1)];
 
-        auto iLine = reinterpret_cast<const QRgb *>(src.constScanLine(yi));
+    QVector<int> yiMap(height);
 
-        for (int x = 0; x < oFrame.width(); x++) {
-            // Get output line.
-            int yo = y  + sineMap[x];
+    for (int y = 0; y < height; y++)
+        yiMap[y] = int(y / (1.0 - amplitude));
 
-            if (yo < 0
-                || yo >= src.height())
-                continue;
+    /* Every output pixel has exactly one source candidate, so the scatter
+     * over output lines reads back as a gather, parallel over rows.
+     */
+    const int *sine = sineMap.constData();
+    const int *yis = yiMap.constData();
+    const uchar *srcBits = src.constBits();
+    int srcBpl = src.bytesPerLine();
 
+    AkVideoFilterRunner::globalRunner()->run(height, [&] (int yStart, int yEnd) {
+        for (int yo = yStart; yo < yEnd; yo++) {
             QRgb *oLine = reinterpret_cast<QRgb *>(oFrame.scanLine(yo));
-            oLine[x] = iLine[x];
+
+            for (int x = 0; x < width; x++) {
+                int y = yo - sine[x];
+
+                if (y < 0 || y >= height)
+                    continue;
+
+                int yi = yis[y];
+
+                if (yi < 0 || yi >= height)
+                    continue;
+
+                auto iLine = reinterpret_cast<const QRgb *>(srcBits
+                                                            + yi * srcBpl);
+                oLine[x] = iLine[x];
+            }
         }
-    }
+    });
 
     AkPacket oPacket = AkUtils::imageToPacket(oFrame, packet);
     akSend(oPacket)
@@ -235,17 +257,21 @@ void WaveElement::updateSineMap()
 
     int width = this->d->m_frameSize.width();
     int height = this->d->m_frameSize.height();
-    QVector<int> sineMap(width);
-    qreal phase = 2.0 * M_PI * this->d->m_phase;
+    QVector<int> sineTable(SineTableSize);
+
+    for (int i = 0; i < SineTableSize; i++)
+        sineTable[i] = int(0.5 * this->d->m_amplitude * height
+                           * (sin(2.0 * M_PI * i / SineTableSize) + 1.0));
+
+    QVector<int> baseIndex(width);
+    qreal k = this->d->m_frequency * SineTableSize / width;
 
     for (int x = 0; x < width; x++)
-        sineMap[x] = int(0.5 * this->d->m_amplitude * height
-                         * (sin(this->d->m_frequency * 2.0 * M_PI * x / width
-                                + phase)
-                            + 1.0));
+        baseIndex[x] = int(k * x);
 
     this->d->m_mutex.lock();
-    this->d->m_sineMap = sineMap;
+    this->d->m_sineTable = sineTable;
+    this->d->m_baseIndex = baseIndex;
     this->d->m_mutex.unlock();
 }
 
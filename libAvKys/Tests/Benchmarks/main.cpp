@@ -0,0 +1,165 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+/* Frame processing benchmark harness.
+ *
+ * Feeds synthetic frames of standard sizes through the AkUtils/AkVideoConvert
+ * conversion paths and through the iStream of every requested effect
+ * element, reporting ns/frame and MB/s after a warmup phase. Usage:
+ *
+ *     benchmarks [effect1 effect2 ...]
+ *
+ * With no arguments a representative set of effects is measured.
+ */
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QtMath>
+
+#include <ak.h>
+#include <akelement.h>
+#include <akpacket.h>
+#include <akutils.h>
+#include <akvideocaps.h>
+#include <akvideoconvert.h>
+#include <akvideopacket.h>
+
+#define WARMUP_FRAMES 16
+#define MEASURE_FRAMES 128
+
+struct BenchmarkSize
+{
+    int width;
+    int height;
+    const char *name;
+};
+
+static const BenchmarkSize benchmarkSizes[] = {
+    { 640,  360, "360p" },
+    {1280,  720, "720p" },
+    {1920, 1080, "1080p"},
+    {   0,    0, nullptr}
+};
+
+static AkVideoPacket makeFrame(int width,
+                               int height,
+                               AkVideoCaps::PixelFormat format)
+{
+    AkVideoCaps caps;
+    caps.isValid() = true;
+    caps.format() = format;
+    caps.bpp() = AkVideoCaps::bitsPerPixel(format);
+    caps.width() = width;
+    caps.height() = height;
+    caps.fps() = AkFrac(30, 1);
+
+    QByteArray buffer(caps.pictureSize(), 0);
+
+    // A gradient with some per-line variation so branchy kernels do not
+    // get an unrealistically predictable input.
+    for (int i = 0; i < buffer.size(); i++)
+        buffer[i] = char((37 * i + 11 * (i / width)) & 0xff);
+
+    return AkVideoPacket(caps, buffer, 0, AkFrac(1, 30), 0, 0);
+}
+
+template<typename Functor>
+static void benchmark(QTextStream &out,
+                      const QString &name,
+                      const BenchmarkSize &size,
+                      qint64 bytesPerFrame,
+                      Functor functor)
+{
+    for (int i = 0; i < WARMUP_FRAMES; i++)
+        functor();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    for (int i = 0; i < MEASURE_FRAMES; i++)
+        functor();
+
+    qint64 elapsedNs = timer.nsecsElapsed();
+    qint64 nsPerFrame = elapsedNs / MEASURE_FRAMES;
+    double mbPerSec = elapsedNs > 0?
+                          1.0e3 * MEASURE_FRAMES * bytesPerFrame / elapsedNs:
+                          0.0;
+
+    out << qSetFieldWidth(32) << left << name
+        << qSetFieldWidth(8) << size.name
+        << qSetFieldWidth(16) << right << nsPerFrame
+        << qSetFieldWidth(0) << " ns/frame "
+        << qSetFieldWidth(10) << QString::number(mbPerSec, 'f', 1)
+        << qSetFieldWidth(0) << " MB/s" << endl;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    QStringList effects;
+
+    for (int i = 1; i < argc; i++)
+        effects << argv[i];
+
+    if (effects.isEmpty())
+        effects << "Blur"
+                << "Denoise"
+                << "Cartoon"
+                << "Edge"
+                << "GrayScale"
+                << "Invert";
+
+    for (auto size = benchmarkSizes; size->name; size++) {
+        auto yuyvFrame = makeFrame(size->width, size->height,
+                                   AkVideoCaps::Format_yuyv422);
+        auto rgbFrame = makeFrame(size->width, size->height,
+                                  AkVideoCaps::Format_0rgb);
+        qint64 rgbBytes = rgbFrame.caps().pictureSize();
+
+        benchmark(out, "AkVideoConvert yuyv422->0rgb", *size,
+                  yuyvFrame.caps().pictureSize(), [&] () {
+            AkVideoConvert::convert(yuyvFrame, AkVideoCaps::Format_0rgb);
+        });
+
+        benchmark(out, "AkUtils convertVideo ->rgb24", *size,
+                  rgbBytes, [&] () {
+            AkUtils::convertVideo(rgbFrame, AkVideoCaps::Format_rgb24);
+        });
+
+        for (auto &effect: effects) {
+            auto element = AkElement::create(effect);
+
+            if (!element) {
+                out << "SKIP " << effect
+                    << " (plugin not available)" << endl;
+
+                continue;
+            }
+
+            benchmark(out, effect + " iStream", *size, rgbBytes, [&] () {
+                element->iStream(rgbFrame.toPacket());
+            });
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,171 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+/* Deterministic trace replay driver.
+ *
+ * Re-feeds a packet trace captured with AkTrace through any element chain
+ * at maximum speed, reporting per element ns/frame and the aggregate
+ * throughput, so a customer's workload profiles on the bench without
+ * their devices. Usage:
+ *
+ *     replay trace.aktrace [--passes N] [effect1 effect2 ...]
+ *
+ * Payload-less traces get synthetic pixels of the recorded geometry, which
+ * keeps sizes and caps switches exact while the trace stays tiny.
+ */
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QVector>
+
+#include <ak.h>
+#include <akcaps.h>
+#include <akelement.h>
+#include <akpacket.h>
+#include <aktrace.h>
+#include <akvideocaps.h>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    QString traceFile;
+    QStringList effects;
+    int passes = 1;
+
+    for (int i = 1; i < argc; i++) {
+        QString arg(argv[i]);
+
+        if (arg == "--passes" && i + 1 < argc)
+            passes = QString(argv[++i]).toInt();
+        else if (traceFile.isEmpty())
+            traceFile = arg;
+        else
+            effects << arg;
+    }
+
+    if (traceFile.isEmpty() || passes < 1) {
+        out << "Usage: replay trace.aktrace [--passes N] "
+               "[effect1 effect2 ...]" << endl;
+
+        return 2;
+    }
+
+    AkTrace trace;
+
+    if (!trace.open(traceFile)) {
+        out << "Can't open trace " << traceFile << endl;
+
+        return 2;
+    }
+
+    // Preload the whole trace so the replay loop never touches the disk.
+    QVector<AkPacket> packets;
+    qint64 traceNs = 0;
+
+    for (;;) {
+        qint64 timestampNs = 0;
+        auto packet = trace.readPacket(&timestampNs);
+
+        if (!packet)
+            break;
+
+        /* Payload-less records reproduce the caps and sizes but carry no
+         * pixels, synthesize a gradient of the recorded geometry. */
+        if (packet.buffer().isEmpty()
+            && packet.caps().mimeType() == "video/x-raw") {
+            AkVideoCaps caps(packet.caps());
+            QByteArray buffer(caps.pictureSize(), 0);
+
+            for (int i = 0; i < buffer.size(); i++)
+                buffer[i] = char((37 * i) & 0xff);
+
+            packet.setBuffer(buffer);
+        }
+
+        packets << packet;
+        traceNs = timestampNs;
+    }
+
+    trace.close();
+
+    if (packets.isEmpty()) {
+        out << "Empty trace." << endl;
+
+        return 2;
+    }
+
+    out << packets.size() << " packets, "
+        << QString::number(traceNs / 1.0e9, 'f', 1)
+        << "s of capture" << endl;
+
+    QList<AkElementPtr> chain;
+    QStringList chainNames;
+
+    for (auto &effect: effects) {
+        auto element = AkElement::create(effect);
+
+        if (!element) {
+            out << "SKIP " << effect << " (plugin not available)" << endl;
+
+            continue;
+        }
+
+        chain << element;
+        chainNames << effect;
+    }
+
+    QVector<qint64> elementNs(chain.size(), 0);
+    QElapsedTimer runClock;
+    runClock.start();
+    qint64 frames = 0;
+
+    for (int pass = 0; pass < passes; pass++)
+        for (auto &packet: packets) {
+            auto current = packet;
+
+            for (int i = 0; i < chain.size(); i++) {
+                QElapsedTimer frameClock;
+                frameClock.start();
+                auto result = chain[i]->iStream(current);
+                elementNs[i] += frameClock.nsecsElapsed();
+
+                if (result)
+                    current = result;
+            }
+
+            frames++;
+        }
+
+    qint64 elapsedNs = runClock.nsecsElapsed();
+
+    for (int i = 0; i < chain.size(); i++)
+        out << qSetFieldWidth(24) << left << chainNames[i]
+            << qSetFieldWidth(12) << right << elementNs[i] / frames
+            << qSetFieldWidth(0) << " ns/frame" << endl;
+
+    out << frames << " frames in "
+        << QString::number(elapsedNs / 1.0e9, 'f', 2) << "s, "
+        << QString::number(1.0e9 * frames / qMax(elapsedNs, qint64(1)), 'f', 1)
+        << " fps" << endl;
+
+    return 0;
+}
@@ -0,0 +1,304 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+/* Long run soak harness.
+ *
+ * Drives synthetic frames through a representative effect chain for hours,
+ * sampling throughput, RSS, heap size and per element latency at a fixed
+ * interval, and fails on decay trends that short benchmarks can't see: a
+ * leak shows as monotonic RSS growth, fragmentation or handle exhaustion as
+ * slowly sinking frames/sec. Usage:
+ *
+ *     soak [--minutes N] [--interval SEC] [--size 360p|720p|1080p]
+ *          [effect1 effect2 ...]
+ *
+ * Defaults: 120 minutes, 10 second samples, 720p, and a representative
+ * chain including history effects. The verdict compares the first and the
+ * last quarter of the run: more than 5% throughput loss, or RSS growth
+ * above 5% and 32 MB, exits non zero and prints the offending series.
+ */
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+#include <QVector>
+
+#include <ak.h>
+#include <akelement.h>
+#include <akfrac.h>
+#include <akpacket.h>
+#include <akvideocaps.h>
+#include <akvideopacket.h>
+
+#define DEFAULT_MINUTES 120
+#define DEFAULT_INTERVAL 10
+#define FPS_DECAY_LIMIT 0.05
+#define RSS_GROWTH_LIMIT 0.05
+#define RSS_GROWTH_FLOOR (qint64(32) * 1024 * 1024)
+
+struct SoakSample
+{
+    qint64 elapsedMs;
+    double fps;
+    qint64 rssBytes;
+    qint64 heapBytes;
+    QVector<qint64> latencyNs; // One entry per element in the chain.
+};
+
+/* VmRSS and VmData from /proc/self/status. Platforms without procfs report
+ * zero and the memory checks are skipped. */
+static void readMemoryUsage(qint64 *rssBytes, qint64 *heapBytes)
+{
+    *rssBytes = 0;
+    *heapBytes = 0;
+
+    QFile status("/proc/self/status");
+
+    if (!status.open(QIODevice::ReadOnly | QIODevice::Text))
+        return;
+
+    for (;;) {
+        auto line = status.readLine();
+
+        if (line.isEmpty())
+            break;
+
+        qint64 *field = nullptr;
+
+        if (line.startsWith("VmRSS:"))
+            field = rssBytes;
+        else if (line.startsWith("VmData:"))
+            field = heapBytes;
+
+        if (field) {
+            auto parts = line.split(':');
+
+            if (parts.size() > 1)
+                *field = parts[1].trimmed().split(' ')
+                                 .first().toLongLong() * 1024;
+        }
+    }
+}
+
+static AkVideoPacket makeFrame(int width, int height)
+{
+    AkVideoCaps caps;
+    caps.isValid() = true;
+    caps.format() = AkVideoCaps::Format_0rgb;
+    caps.bpp() = AkVideoCaps::bitsPerPixel(caps.format());
+    caps.width() = width;
+    caps.height() = height;
+    caps.fps() = AkFrac(30, 1);
+
+    QByteArray buffer(caps.pictureSize(), 0);
+
+    for (int i = 0; i < buffer.size(); i++)
+        buffer[i] = char((37 * i + 11 * (i / width)) & 0xff);
+
+    return AkVideoPacket(caps, buffer, 0, AkFrac(1, 30), 0, 0);
+}
+
+static double average(const QVector<double> &values, int from, int count)
+{
+    double sum = 0.0;
+
+    for (int i = from; i < from + count; i++)
+        sum += values[i];
+
+    return count > 0? sum / count: 0.0;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    int minutes = DEFAULT_MINUTES;
+    int interval = DEFAULT_INTERVAL;
+    int width = 1280;
+    int height = 720;
+    QStringList effects;
+
+    for (int i = 1; i < argc; i++) {
+        QString arg(argv[i]);
+
+        if (arg == "--minutes" && i + 1 < argc) {
+            minutes = QString(argv[++i]).toInt();
+        } else if (arg == "--interval" && i + 1 < argc) {
+            interval = QString(argv[++i]).toInt();
+        } else if (arg == "--size" && i + 1 < argc) {
+            QString size(argv[++i]);
+
+            if (size == "360p") {
+                width = 640;
+                height = 360;
+            } else if (size == "1080p") {
+                width = 1920;
+                height = 1080;
+            }
+        } else {
+            effects << arg;
+        }
+    }
+
+    if (minutes < 1 || interval < 1) {
+        out << "Invalid duration or interval." << endl;
+
+        return 2;
+    }
+
+    if (effects.isEmpty())
+        // History effects on purpose, they are the heaviest frame holders.
+        effects << "Blur"
+                << "DelayGrab"
+                << "FrameOverlap"
+                << "Cartoon";
+
+    QList<AkElementPtr> chain;
+    QStringList chainNames;
+
+    for (auto &effect: effects) {
+        auto element = AkElement::create(effect);
+
+        if (!element) {
+            out << "SKIP " << effect << " (plugin not available)" << endl;
+
+            continue;
+        }
+
+        chain << element;
+        chainNames << effect;
+    }
+
+    if (chain.isEmpty()) {
+        out << "No effects available, nothing to soak." << endl;
+
+        return 2;
+    }
+
+    auto frame = makeFrame(width, height);
+    auto packet = frame.toPacket();
+
+    out << "Soaking " << chainNames.join(" -> ")
+        << " at " << width << "x" << height
+        << " for " << minutes << " minutes, "
+        << interval << "s samples" << endl;
+
+    QVector<SoakSample> samples;
+    QElapsedTimer runClock;
+    runClock.start();
+    qint64 totalMs = qint64(minutes) * 60 * 1000;
+    qint64 intervalMs = qint64(interval) * 1000;
+
+    while (runClock.elapsed() < totalMs) {
+        QElapsedTimer sampleClock;
+        sampleClock.start();
+        qint64 frames = 0;
+        QVector<qint64> latencyNs(chain.size(), 0);
+
+        while (sampleClock.elapsed() < intervalMs) {
+            auto current = packet;
+
+            for (int i = 0; i < chain.size(); i++) {
+                QElapsedTimer frameClock;
+                frameClock.start();
+                auto result = chain[i]->iStream(current);
+                latencyNs[i] += frameClock.nsecsElapsed();
+
+                if (result)
+                    current = result;
+            }
+
+            frames++;
+        }
+
+        SoakSample sample;
+        sample.elapsedMs = runClock.elapsed();
+        sample.fps = 1000.0 * frames / sampleClock.elapsed();
+        readMemoryUsage(&sample.rssBytes, &sample.heapBytes);
+        sample.latencyNs = latencyNs;
+
+        for (int i = 0; i < sample.latencyNs.size(); i++)
+            sample.latencyNs[i] /= qMax(frames, qint64(1));
+
+        samples << sample;
+
+        out << qSetFieldWidth(8) << right
+            << sample.elapsedMs / 1000
+            << qSetFieldWidth(0) << "s "
+            << QString::number(sample.fps, 'f', 1) << " fps, rss "
+            << sample.rssBytes / (1024 * 1024) << " MB, heap "
+            << sample.heapBytes / (1024 * 1024) << " MB";
+
+        for (int i = 0; i < chain.size(); i++)
+            out << ", " << chainNames[i] << " "
+                << sample.latencyNs[i] / 1000 << " us";
+
+        out << endl;
+    }
+
+    // Verdict: compare the first and the last quarter of the run, which
+    // ignores noise but catches anything that keeps drifting.
+    int quarter = samples.size() / 4;
+
+    if (quarter < 1) {
+        out << "Run too short for a trend verdict." << endl;
+
+        return 0;
+    }
+
+    QVector<double> fpsSeries;
+    QVector<double> rssSeries;
+
+    for (auto &sample: samples) {
+        fpsSeries << sample.fps;
+        rssSeries << double(sample.rssBytes);
+    }
+
+    double fpsFirst = average(fpsSeries, 0, quarter);
+    double fpsLast = average(fpsSeries, samples.size() - quarter, quarter);
+    double rssFirst = average(rssSeries, 0, quarter);
+    double rssLast = average(rssSeries, samples.size() - quarter, quarter);
+
+    int failures = 0;
+
+    if (fpsFirst > 0.0
+        && fpsLast < fpsFirst * (1.0 - FPS_DECAY_LIMIT)) {
+        out << "FAIL: throughput decayed from "
+            << QString::number(fpsFirst, 'f', 1) << " to "
+            << QString::number(fpsLast, 'f', 1) << " fps" << endl;
+        failures++;
+    }
+
+    if (rssFirst > 0.0
+        && rssLast > rssFirst * (1.0 + RSS_GROWTH_LIMIT)
+        && rssLast - rssFirst > RSS_GROWTH_FLOOR) {
+        out << "FAIL: RSS grew from "
+            << qint64(rssFirst) / (1024 * 1024) << " to "
+            << qint64(rssLast) / (1024 * 1024) << " MB" << endl;
+        failures++;
+    }
+
+    if (!failures)
+        out << "PASS: no decay trend over "
+            << samples.size() << " samples" << endl;
+
+    return failures? 1: 0;
+}
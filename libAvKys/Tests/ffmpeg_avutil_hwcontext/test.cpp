@@ -0,0 +1,36 @@
+/* Webcamoid, webcam capture application.
+ * Copyright (C) 2011-2017  Gonzalo Exequiel Pedone
+ *
+ * Webcamoid is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Webcamoid is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Webcamoid. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Web-Site: http://webcamoid.github.io/
+ */
+
+#include <iostream>
+
+extern "C"
+{
+    #include <libavcodec/avcodec.h>
+    #include <libavutil/hwcontext.h>
+}
+
+int main()
+{
+    avcodec_get_hw_config(NULL, 0);
+    av_hwdevice_iterate_types(AV_HWDEVICE_TYPE_NONE);
+    av_hwdevice_ctx_create(NULL, AV_HWDEVICE_TYPE_NONE, NULL, NULL, 0);
+    av_hwframe_transfer_data(NULL, NULL, 0);
+
+    return 0;
+}
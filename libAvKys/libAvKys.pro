@@ -62,6 +62,7 @@ isEmpty(NOFFMPEG) {
     CONFIG(config_ffmpeg): qtCompileTest(ffmpeg_avutil_extraoptions)
     CONFIG(config_ffmpeg): qtCompileTest(ffmpeg_avutil_extrapixformats)
     CONFIG(config_ffmpeg): qtCompileTest(ffmpeg_avutil_framealloc)
+    CONFIG(config_ffmpeg): qtCompileTest(ffmpeg_avutil_hwcontext)
     CONFIG(config_ffmpeg): qtCompileTest(ffmpeg_avutil_sampleformat64)
     CONFIG(config_ffmpeg): qtCompileTest(ffmpeg_avresample)
     CONFIG(config_ffmpeg): qtCompileTest(ffmpeg_swresample)
@@ -85,6 +86,8 @@ isEmpty(NOLIBUVC) {
 
 isEmpty(NOMEDIAFOUNDATION): qtCompileTest(mediafoundation)
 
+isEmpty(NOOPENCL): qtCompileTest(opencl)
+
 isEmpty(NOOSS) {
     cache(INCLUDEDIR)
     qtCompileTest(oss)
@@ -93,6 +96,12 @@ isEmpty(NOOSS) {
 isEmpty(NOPULSEAUDIO): qtCompileTest(pulseaudio)
 isEmpty(NOQTAUDIO): qtCompileTest(qtaudio)
 
+isEmpty(NOTURBOJPEG) {
+    !isEmpty(TURBOJPEGINCLUDES): cache(TURBOJPEGINCLUDES)
+    !isEmpty(TURBOJPEGLIBS): cache(TURBOJPEGLIBS)
+    qtCompileTest(turbojpeg)
+}
+
 isEmpty(NOV4L2) {
     qtCompileTest(v4l2)
     CONFIG(config_v4l2): qtCompileTest(v4l2_extendedcontrols)
@@ -101,6 +110,7 @@ isEmpty(NOV4L2) {
 
 isEmpty(NOVCAMWIN): qtCompileTest(vcamwin)
 isEmpty(NOWASAPI): qtCompileTest(wasapi)
+isEmpty(NOXDAMAGE): qtCompileTest(xdamage)
 
 TEMPLATE = subdirs
 
@@ -111,6 +121,18 @@ SUBDIRS += \
     AkQml \
     Plugins
 
+!isEmpty(BUILDBENCHMARKS):!isEqual(BUILDBENCHMARKS, 0) {
+    SUBDIRS += Tests/Benchmarks
+}
+
+!isEmpty(BUILDSOAK):!isEqual(BUILDSOAK, 0) {
+    SUBDIRS += Tests/Soak
+}
+
+!isEmpty(BUILDREPLAY):!isEqual(BUILDREPLAY, 0) {
+    SUBDIRS += Tests/Replay
+}
+
 # Install rules
 
 INSTALLS += \